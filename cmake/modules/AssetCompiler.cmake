@@ -0,0 +1,78 @@
+# Provides:
+#
+# add_compiled_assets(
+#    target
+#    RESOURCE_ROOT <directory>
+#    OUTPUT_DIR <directory>
+#    ASSETS <spec>...
+# )
+#
+#  Compiles resources into GPU-ready blobs (see src/compiled_texture.h) plus a manifest using the host
+#  utils/asset_compiler tool. Each spec is "<path relative to RESOURCE_ROOT>=<FORMAT>[,mipmap]". The given target
+#  builds the blobs and may be passed to add_xbe's RESOURCE_DEPENDS so that OUTPUT_DIR is synced after compilation.
+
+include(CMakeParseArguments)
+include(ExternalProject)
+
+# The compiler must run on the build machine, so it is built as a separate project that does not inherit the nxdk
+# toolchain.
+set(ASSET_COMPILER_BINARY_DIR "${CMAKE_BINARY_DIR}/asset_compiler")
+set(ASSET_COMPILER_TOOL "${ASSET_COMPILER_BINARY_DIR}/asset_compiler${CMAKE_HOST_EXECUTABLE_SUFFIX}")
+
+ExternalProject_Add(
+        asset_compiler_tool
+        SOURCE_DIR "${CMAKE_SOURCE_DIR}/utils/asset_compiler"
+        BINARY_DIR "${ASSET_COMPILER_BINARY_DIR}"
+        CMAKE_ARGS
+        -DCMAKE_BUILD_TYPE=Release
+        "-DNXDK_PGRAPH_TESTS_SOURCE_DIR=${CMAKE_SOURCE_DIR}"
+        BUILD_ALWAYS ON
+        BUILD_BYPRODUCTS "${ASSET_COMPILER_TOOL}"
+        INSTALL_COMMAND ""
+)
+
+function(add_compiled_assets)
+    cmake_parse_arguments(
+            PARSE_ARGV
+            1
+            "ASSET"
+            ""
+            "RESOURCE_ROOT;OUTPUT_DIR"
+            "ASSETS"
+    )
+
+    set(target "${ARGV0}")
+
+    if (NOT ASSET_RESOURCE_ROOT)
+        message(FATAL_ERROR "Missing required 'RESOURCE_ROOT' parameter.")
+    endif ()
+    if (NOT ASSET_OUTPUT_DIR)
+        message(FATAL_ERROR "Missing required 'OUTPUT_DIR' parameter.")
+    endif ()
+
+    # The compiler leaves unchanged outputs untouched so that the resource sync does not recopy them, so a stamp file
+    # tracks when compilation last ran.
+    set(stamp "${CMAKE_CURRENT_BINARY_DIR}/.${target}_compiled_assets_time")
+    set(sources)
+    set(outputs "${ASSET_OUTPUT_DIR}/manifest.bin")
+    foreach (spec ${ASSET_ASSETS})
+        string(REGEX REPLACE "=.*$" "" asset_path "${spec}")
+        list(APPEND sources "${ASSET_RESOURCE_ROOT}/${asset_path}")
+        list(APPEND outputs "${ASSET_OUTPUT_DIR}/${asset_path}.tex")
+    endforeach ()
+
+    add_custom_command(
+            OUTPUT "${stamp}"
+            BYPRODUCTS ${outputs}
+            COMMAND "${ASSET_COMPILER_TOOL}" "${ASSET_RESOURCE_ROOT}" "${ASSET_OUTPUT_DIR}" ${ASSET_ASSETS}
+            COMMAND "${CMAKE_COMMAND}" -E touch "${stamp}"
+            DEPENDS ${sources} asset_compiler_tool "${ASSET_COMPILER_TOOL}"
+            VERBATIM
+    )
+
+    add_custom_target(
+            "${target}"
+            DEPENDS
+            "${stamp}"
+    )
+endfunction()
@@ -45,14 +45,13 @@ def _copy_if_needed(local_file_path: str, target_file_path: str) -> bool:
     return True
 
 
-def _sync_resource_dir(local_resource_path: str, target_path: str, target_ignore_files: set[str], *, recursive: bool = True) -> set[str]:
+def _sync_resource_dir(
+    local_resource_path: str, target_path: str, target_ignore_files: set[str], matched_files: set[str], *, recursive: bool = True
+) -> set[str]:
     source_files = glob.glob(f"{local_resource_path}/**", recursive=recursive)
-    existing_files = set(glob.glob(f"{target_path}/**", recursive=recursive)) if os.path.isdir(target_path) else set()
 
     os.makedirs(target_path, exist_ok=True)
 
-    matched_files: set[str] = set()
-
     ret: set[str] = set()
     for file in source_files:
         if not os.path.isfile(file):
@@ -67,6 +66,16 @@ def _sync_resource_dir(local_resource_path: str, target_path: str, target_ignore
             stat_results = os.stat(target_file_path)
             ret.add(f"{target_file_path}={stat_results.st_mtime}")
 
+    return ret
+
+
+def _remove_extra_files(target_path: str, matched_files: set[str], target_ignore_files: set[str], *, recursive: bool = True) -> set[str]:
+    """Removes files under target_path that were not provided by any resource dir.
+
+    Pruning happens after every dir has been synced, as resource dirs may nest within one another in the output."""
+    existing_files = set(glob.glob(f"{target_path}/**", recursive=recursive)) if os.path.isdir(target_path) else set()
+
+    ret: set[str] = set()
     extra_files = existing_files - matched_files
     extra_files -= target_ignore_files
     for extra_file in extra_files:
@@ -83,12 +92,21 @@ def perform_sync(output_dir: str, receipt_path: str | None, resource_roots: list
     target_ignore_files = {os.path.join(output_dir, file) for file in ignore_files}
 
     files_modified: set[str] = set()
+    matched_files: set[str] = set()
     for source_path, relative_target in resource_path_to_relative_path.items():
         new_files_modified = _sync_resource_dir(
-            local_resource_path=source_path, target_path=os.path.join(output_dir, relative_target), target_ignore_files=target_ignore_files
+            local_resource_path=source_path,
+            target_path=os.path.join(output_dir, relative_target),
+            target_ignore_files=target_ignore_files,
+            matched_files=matched_files,
         )
         files_modified.update(new_files_modified)
 
+    for relative_target in set(resource_path_to_relative_path.values()):
+        files_modified.update(
+            _remove_extra_files(os.path.join(output_dir, relative_target), matched_files, target_ignore_files)
+        )
+
     if receipt_path:
         if files_modified or not os.path.exists(receipt_path):
             os.makedirs(os.path.dirname(receipt_path), exist_ok=True)
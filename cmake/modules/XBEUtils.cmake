@@ -6,6 +6,7 @@
 #    [TITLE <xbe title>={target}]
 #    RESOURCE_FILES <files>
 #    RESOURCE_DIRS <directories>
+#    RESOURCE_DEPENDS <targets>
 # )
 #
 #  Generates an XBE file from the given executable_file. The given resources will be attached such that add_xiso will
@@ -67,6 +68,8 @@ endfunction()
 # recursively into the XISO staging area. Any directory with a prefix that
 # matches a RESOURCE_ROOTS entry will have the matching part removed during the
 # copy, preserving any path relative to that root.
+# RESOURCE_DEPENDS is a list of targets that generate content within
+# RESOURCE_DIRS and must complete before the directories are synced.
 function(add_xbe)
     cmake_parse_arguments(
             PARSE_ARGV
@@ -74,7 +77,7 @@ function(add_xbe)
             "XBE"
             ""
             "XBENAME;TITLE"
-            "RESOURCE_FILES;RESOURCE_DIRS;RESOURCE_ROOTS"
+            "RESOURCE_FILES;RESOURCE_DIRS;RESOURCE_ROOTS;RESOURCE_DEPENDS"
     )
 
     if (${ARGC} LESS 1)
@@ -187,6 +190,9 @@ function(add_xbe)
                 -i "default.xbe"
                 VERBATIM
         )
+        if (XBE_RESOURCE_DEPENDS)
+            add_dependencies("sync_resource_dirs_${sync_resource_dirs_target_name}" ${XBE_RESOURCE_DEPENDS})
+        endif ()
 
         # This custom command allows other targets to depend on execution of
         # sync_resource_dirs without forcing them to be considered stale as
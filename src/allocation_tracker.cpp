@@ -0,0 +1,68 @@
+#include "allocation_tracker.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static constexpr const char *kKindNames[AllocationTracker::kNumKinds] = {"contiguous", "heap"};
+
+bool AllocationTracker::Report::HasOutstanding() const {
+  return std::any_of(std::begin(usage), std::end(usage), [](const Usage &entry) { return entry.live_bytes > 0; });
+}
+
+std::string AllocationTracker::Report::Describe() const {
+  std::string ret;
+  char buffer[96];
+  for (uint32_t i = 0; i < kNumKinds; ++i) {
+    snprintf(buffer, sizeof(buffer), "%s%s live %d peak %u allocs %u", i ? ", " : "", kKindNames[i],
+             static_cast<int>(usage[i].live_bytes), static_cast<unsigned int>(usage[i].peak_bytes),
+             static_cast<unsigned int>(usage[i].num_allocations));
+    ret += buffer;
+  }
+  return ret;
+}
+
+void AllocationTracker::RecordAllocation(Kind kind, uint32_t bytes) {
+  auto index = static_cast<uint32_t>(kind);
+  auto live_bytes = live_bytes_[index] += bytes;
+  peak_bytes_[index] = std::max(peak_bytes_[index], live_bytes);
+  OnAllocation(suite_, index, live_bytes);
+  OnAllocation(test_, index, live_bytes);
+}
+
+void AllocationTracker::RecordRelease(Kind kind, uint32_t bytes) {
+  auto index = static_cast<uint32_t>(kind);
+  live_bytes_[index] -= std::min(live_bytes_[index], bytes);
+}
+
+void AllocationTracker::BeginScope(Scope &scope) {
+  scope.open = true;
+  for (uint32_t i = 0; i < kNumKinds; ++i) {
+    scope.base_bytes[i] = live_bytes_[i];
+    scope.peak_bytes[i] = live_bytes_[i];
+    scope.num_allocations[i] = 0;
+  }
+}
+
+AllocationTracker::Report AllocationTracker::EndScope(Scope &scope) {
+  Report ret;
+  if (!scope.open) {
+    return ret;
+  }
+
+  scope.open = false;
+  for (uint32_t i = 0; i < kNumKinds; ++i) {
+    auto &usage = ret.usage[i];
+    usage.live_bytes = static_cast<int32_t>(live_bytes_[i] - scope.base_bytes[i]);
+    usage.peak_bytes = scope.peak_bytes[i] - std::min(scope.peak_bytes[i], scope.base_bytes[i]);
+    usage.num_allocations = scope.num_allocations[i];
+  }
+  return ret;
+}
+
+void AllocationTracker::OnAllocation(Scope &scope, uint32_t index, uint32_t live_bytes) {
+  if (!scope.open) {
+    return;
+  }
+  ++scope.num_allocations[index];
+  scope.peak_bytes[index] = std::max(scope.peak_bytes[index], live_bytes);
+}
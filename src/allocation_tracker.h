@@ -0,0 +1,83 @@
+#ifndef NXDK_PGRAPH_TESTS_ALLOCATION_TRACKER_H
+#define NXDK_PGRAPH_TESTS_ALLOCATION_TRACKER_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Counts memory handed out by the harness so that usage can be attributed to individual suites and tests.
+ *
+ * Every operation is a handful of integer updates, so the tracker may be left enabled for full runs. Allocations are
+ * attributed to the suite and test scopes that are open when they are recorded; a scope that ends with live bytes
+ * outstanding has leaked memory into whatever runs next.
+ */
+class AllocationTracker {
+ public:
+  enum class Kind {
+    //! Physically contiguous memory (e.g., the TestHost arena).
+    CONTIGUOUS = 0,
+    //! Ordinary heap memory.
+    HEAP,
+  };
+  static constexpr uint32_t kNumKinds = 2;
+
+  struct Usage {
+    //! Bytes allocated but not released since the scope began. May be negative if the scope released memory that was
+    //! allocated before it began.
+    int32_t live_bytes{0};
+    //! Largest number of bytes outstanding at any point during the scope, relative to its beginning.
+    uint32_t peak_bytes{0};
+    uint32_t num_allocations{0};
+  };
+
+  struct Report {
+    Usage usage[kNumKinds];
+
+    [[nodiscard]] const Usage &Get(Kind kind) const { return usage[static_cast<uint32_t>(kind)]; }
+
+    //! Returns true if any kind of memory was left outstanding.
+    [[nodiscard]] bool HasOutstanding() const;
+
+    //! Returns a single line summary, e.g. "contiguous live 0 peak 4096 allocs 1, heap live 0 peak 0 allocs 0".
+    [[nodiscard]] std::string Describe() const;
+  };
+
+ public:
+  void RecordAllocation(Kind kind, uint32_t bytes);
+  void RecordRelease(Kind kind, uint32_t bytes);
+
+  //! Begins attributing allocations to a new suite, discarding any suite scope that was never ended.
+  void BeginSuite() { BeginScope(suite_); }
+  //! Ends the current suite scope and returns its usage.
+  Report EndSuite() { return EndScope(suite_); }
+
+  //! Begins attributing allocations to a new test.
+  void BeginTest() { BeginScope(test_); }
+  //! Ends the current test scope and returns its usage.
+  Report EndTest() { return EndScope(test_); }
+
+  //! Returns the number of bytes currently outstanding across all scopes.
+  [[nodiscard]] uint32_t GetLiveBytes(Kind kind) const { return live_bytes_[static_cast<uint32_t>(kind)]; }
+  //! Returns the largest value GetLiveBytes has reported since the tracker was created.
+  [[nodiscard]] uint32_t GetPeakBytes(Kind kind) const { return peak_bytes_[static_cast<uint32_t>(kind)]; }
+
+ private:
+  struct Scope {
+    bool open{false};
+    uint32_t base_bytes[kNumKinds]{};
+    uint32_t peak_bytes[kNumKinds]{};
+    uint32_t num_allocations[kNumKinds]{};
+  };
+
+  void BeginScope(Scope &scope);
+  Report EndScope(Scope &scope);
+  static void OnAllocation(Scope &scope, uint32_t index, uint32_t live_bytes);
+
+ private:
+  uint32_t live_bytes_[kNumKinds]{};
+  uint32_t peak_bytes_[kNumKinds]{};
+  Scope suite_;
+  Scope test_;
+};
+
+#endif  // NXDK_PGRAPH_TESTS_ALLOCATION_TRACKER_H
@@ -0,0 +1,57 @@
+#include "atlas_layout.h"
+
+#include <cstring>
+
+AtlasLayout::AtlasLayout(uint32_t surface_width, uint32_t surface_height, uint32_t cell_width, uint32_t cell_height,
+                         uint32_t spacing)
+    : cell_width_(cell_width), cell_height_(cell_height), spacing_(spacing) {
+  if (!cell_width || !cell_height) {
+    return;
+  }
+
+  // Each cell is preceded by `spacing` pixels and the final cell is followed by another `spacing` pixels.
+  auto stride_x = cell_width + spacing;
+  auto stride_y = cell_height + spacing;
+  if (surface_width < stride_x + spacing || surface_height < stride_y + spacing) {
+    return;
+  }
+
+  columns_ = (surface_width - spacing) / stride_x;
+  rows_ = (surface_height - spacing) / stride_y;
+  origin_x_ = (surface_width - (columns_ * stride_x + spacing)) / 2 + spacing;
+  origin_y_ = (surface_height - (rows_ * stride_y + spacing)) / 2 + spacing;
+}
+
+AtlasLayout::Cell AtlasLayout::GetCell(uint32_t slot) const {
+  Cell ret;
+  if (!IsValid()) {
+    return ret;
+  }
+
+  auto column = slot % columns_;
+  auto row = (slot / columns_) % rows_;
+  ret.left = origin_x_ + column * (cell_width_ + spacing_);
+  ret.top = origin_y_ + row * (cell_height_ + spacing_);
+  ret.width = cell_width_;
+  ret.height = cell_height_;
+  return ret;
+}
+
+uint32_t AtlasLayout::GetNumFrames(uint32_t num_cases) const {
+  if (!IsValid()) {
+    return 0;
+  }
+  auto cells_per_frame = GetCellsPerFrame();
+  return (num_cases + cells_per_frame - 1) / cells_per_frame;
+}
+
+void AtlasLayout::ExtractCell(const uint8_t *source, uint32_t source_pitch, uint32_t bytes_per_pixel, const Cell &cell,
+                              uint8_t *dest) {
+  const auto row_bytes = cell.width * bytes_per_pixel;
+  const uint8_t *row = source + cell.top * source_pitch + cell.left * bytes_per_pixel;
+  for (uint32_t y = 0; y < cell.height; ++y) {
+    memcpy(dest, row, row_bytes);
+    dest += row_bytes;
+    row += source_pitch;
+  }
+}
@@ -0,0 +1,72 @@
+#ifndef NXDK_PGRAPH_TESTS_ATLAS_LAYOUT_H
+#define NXDK_PGRAPH_TESTS_ATLAS_LAYOUT_H
+
+#include <cstdint>
+
+/**
+ * Packs fixed size test cases into a grid so that several of them may be rendered into a single frame and captured
+ * together.
+ *
+ * Cells are separated by `spacing` pixels of untouched background, so a case that leaks outside of its clip region (or
+ * is antialiased across its border) does not contaminate its neighbors.
+ */
+class AtlasLayout {
+ public:
+  //! Region of the surface assigned to a single test case.
+  struct Cell {
+    uint32_t left{0};
+    uint32_t top{0};
+    uint32_t width{0};
+    uint32_t height{0};
+
+    [[nodiscard]] uint32_t Right() const { return left + width; }
+    [[nodiscard]] uint32_t Bottom() const { return top + height; }
+  };
+
+  //! Default number of background pixels around each cell.
+  static constexpr uint32_t kDefaultSpacing = 8;
+
+ public:
+  AtlasLayout(uint32_t surface_width, uint32_t surface_height, uint32_t cell_width, uint32_t cell_height,
+              uint32_t spacing = kDefaultSpacing);
+
+  //! Returns false if not even a single cell fits on the surface.
+  [[nodiscard]] bool IsValid() const { return columns_ && rows_; }
+
+  [[nodiscard]] uint32_t GetColumns() const { return columns_; }
+  [[nodiscard]] uint32_t GetRows() const { return rows_; }
+  [[nodiscard]] uint32_t GetCellsPerFrame() const { return columns_ * rows_; }
+  [[nodiscard]] uint32_t GetCellWidth() const { return cell_width_; }
+  [[nodiscard]] uint32_t GetCellHeight() const { return cell_height_; }
+
+  //! Returns the cell for the given slot within a frame, in row-major order. `slot` must be less than
+  //! GetCellsPerFrame().
+  [[nodiscard]] Cell GetCell(uint32_t slot) const;
+
+  //! Returns the number of frames needed to render `num_cases` test cases.
+  [[nodiscard]] uint32_t GetNumFrames(uint32_t num_cases) const;
+
+  /**
+   * Copies the pixels of `cell` out of a surface into a tightly packed buffer.
+   *
+   * @param source - The first pixel of the surface.
+   * @param source_pitch - Number of bytes between rows of the surface.
+   * @param bytes_per_pixel - Size of a single pixel.
+   * @param cell - Region to extract.
+   * @param dest - Receives `cell.width * cell.height * bytes_per_pixel` bytes.
+   */
+  static void ExtractCell(const uint8_t *source, uint32_t source_pitch, uint32_t bytes_per_pixel, const Cell &cell,
+                          uint8_t *dest);
+
+ private:
+  uint32_t cell_width_;
+  uint32_t cell_height_;
+  uint32_t spacing_;
+  uint32_t columns_{0};
+  uint32_t rows_{0};
+  //! Offsets that center the grid on the surface.
+  uint32_t origin_x_{0};
+  uint32_t origin_y_{0};
+};
+
+#endif  // NXDK_PGRAPH_TESTS_ATLAS_LAYOUT_H
@@ -0,0 +1,64 @@
+#include "command_block.h"
+
+#include <pbkit/pbkit.h>
+
+#include "debug_output.h"
+
+#ifdef SUBCH_3D
+static_assert(CommandBlock::kSubchannel3D == SUBCH_3D, "CommandBlock subchannel must match pbkit");
+#endif
+
+void CommandBlock::AppendMethod(uint32_t command, const uint32_t *params, uint32_t num_params) {
+  ASSERT(!sealed_ && "Attempt to modify a sealed CommandBlock");
+  ASSERT(num_params + 1 <= kMaxDwordsPerSubmission && "Method too large for a single submission");
+
+  const auto current_size = static_cast<uint32_t>(words_.size());
+  if (current_size + 1 + num_params - current_submission_start_ > kMaxDwordsPerSubmission) {
+    submission_boundaries_.push_back(current_size);
+    current_submission_start_ = current_size;
+  }
+
+  words_.push_back(EncodeMethod(kSubchannel3D, command, num_params));
+  words_.insert(words_.end(), params, params + num_params);
+}
+
+std::vector<CommandBlock::Method> CommandBlock::Decode() const {
+  std::vector<Method> ret;
+
+  auto it = words_.begin();
+  while (it != words_.end()) {
+    const uint32_t header = *it++;
+    const uint32_t num_params = (header >> 18) & 0x7FF;
+
+    Method method{(header >> 13) & 0x07, header & 0x1FFF, {}};
+    ASSERT(static_cast<uint32_t>(words_.end() - it) >= num_params && "Truncated method in CommandBlock");
+    method.params.assign(it, it + num_params);
+    it += num_params;
+
+    ret.emplace_back(std::move(method));
+  }
+
+  return ret;
+}
+
+void CommandBlock::Submit() const {
+  const uint32_t *src = words_.data();
+  uint32_t chunk_start = 0;
+
+  auto submit_chunk = [&src, &chunk_start](uint32_t chunk_end) {
+    const uint32_t num_words = chunk_end - chunk_start;
+    if (!num_words) {
+      return;
+    }
+
+    auto p = pb_begin();
+    memcpy(p, src + chunk_start, num_words * sizeof(*src));
+    pb_end(p + num_words);
+    chunk_start = chunk_end;
+  };
+
+  for (auto boundary : submission_boundaries_) {
+    submit_chunk(boundary);
+  }
+  submit_chunk(SizeInDwords());
+}
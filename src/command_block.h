@@ -0,0 +1,90 @@
+#ifndef NXDK_PGRAPH_TESTS_COMMAND_BLOCK_H
+#define NXDK_PGRAPH_TESTS_COMMAND_BLOCK_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * A preassembled sequence of nv2a methods that can be submitted to the pushbuffer with a single copy.
+ *
+ * Blocks are built once via the Push/PushF methods (which mirror the Pushbuffer API so that sequences can be emitted
+ * into either) and are immutable after Seal() is called.
+ */
+class CommandBlock {
+ public:
+  //! pbkit subchannel used for the 3D (Kelvin) class. Matches pbkit's SUBCH_3D.
+  static constexpr uint32_t kSubchannel3D = 0;
+
+  //! Maximum number of dwords written between a single pb_begin/pb_end pair.
+  static constexpr uint32_t kMaxDwordsPerSubmission = 128;
+
+  //! A decoded method header and its parameters.
+  struct Method {
+    uint32_t subchannel;
+    uint32_t command;
+    std::vector<uint32_t> params;
+
+    bool operator==(const Method &other) const {
+      return subchannel == other.subchannel && command == other.command && params == other.params;
+    }
+  };
+
+ public:
+  CommandBlock() = default;
+
+  //! Appends a method with the given integer parameters.
+  template <typename... Params>
+  void Push(uint32_t command, Params... params) {
+    static_assert(sizeof...(params) > 0, "Methods must have at least one parameter");
+    const uint32_t values[] = {static_cast<uint32_t>(params)...};
+    AppendMethod(command, values, sizeof...(params));
+  }
+
+  //! Appends a method with the given float parameters.
+  template <typename... Params>
+  void PushF(uint32_t command, Params... params) {
+    static_assert(sizeof...(params) > 0, "Methods must have at least one parameter");
+    const uint32_t values[] = {FloatBits(static_cast<float>(params))...};
+    AppendMethod(command, values, sizeof...(params));
+  }
+
+  //! Finalizes the block, preventing further modification.
+  void Seal() { sealed_ = true; }
+  [[nodiscard]] bool IsSealed() const { return sealed_; }
+
+  //! Returns the raw pushbuffer words in this block.
+  [[nodiscard]] const std::vector<uint32_t> &Words() const { return words_; }
+  [[nodiscard]] uint32_t SizeInDwords() const { return static_cast<uint32_t>(words_.size()); }
+
+  //! Returns the dword offsets at which submission may be split without breaking a method.
+  [[nodiscard]] const std::vector<uint32_t> &SubmissionBoundaries() const { return submission_boundaries_; }
+
+  //! Decodes the words in this block back into individual methods.
+  [[nodiscard]] std::vector<Method> Decode() const;
+
+  //! Copies this block into the active pushbuffer.
+  void Submit() const;
+
+  //! Encodes a method header in the format used by pbkit.
+  static constexpr uint32_t EncodeMethod(uint32_t subchannel, uint32_t command, uint32_t num_params) {
+    return (num_params << 18) | (subchannel << 13) | command;
+  }
+
+ private:
+  static uint32_t FloatBits(float value) {
+    uint32_t ret;
+    memcpy(&ret, &value, sizeof(ret));
+    return ret;
+  }
+
+  void AppendMethod(uint32_t command, const uint32_t *params, uint32_t num_params);
+
+ private:
+  std::vector<uint32_t> words_;
+  std::vector<uint32_t> submission_boundaries_;
+  uint32_t current_submission_start_{0};
+  bool sealed_{false};
+};
+
+#endif  // NXDK_PGRAPH_TESTS_COMMAND_BLOCK_H
@@ -0,0 +1,285 @@
+#include "compiled_texture.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include "resource_prefetcher.h"
+
+#ifdef NXDK
+static constexpr char kPathSeparator = '\\';
+#else
+static constexpr char kPathSeparator = '/';
+#endif
+
+static constexpr char kManifestFilename[] = "manifest.bin";
+static constexpr char kBlobExtension[] = ".tex";
+
+namespace CompiledTexture {
+
+bool GetFormatInfo(uint32_t format, uint32_t &bytes_per_pixel, bool &swizzled, bool &compressed) {
+  swizzled = false;
+  compressed = false;
+  switch (format) {
+    case FORMAT_SZ_A1R5G5B5:
+    case FORMAT_SZ_X1R5G5B5:
+    case FORMAT_SZ_A4R4G4B4:
+    case FORMAT_SZ_R5G6B5:
+      swizzled = true;
+      bytes_per_pixel = 2;
+      return true;
+
+    case FORMAT_LU_IMAGE_A1R5G5B5:
+    case FORMAT_LU_IMAGE_R5G6B5:
+    case FORMAT_LU_IMAGE_A4R4G4B4:
+      bytes_per_pixel = 2;
+      return true;
+
+    case FORMAT_SZ_A8R8G8B8:
+    case FORMAT_SZ_X8R8G8B8:
+      swizzled = true;
+      bytes_per_pixel = 4;
+      return true;
+
+    case FORMAT_LU_IMAGE_A8R8G8B8:
+    case FORMAT_LU_IMAGE_X8R8G8B8:
+      bytes_per_pixel = 4;
+      return true;
+
+    case FORMAT_L_DXT1_A1R5G5B5:
+    case FORMAT_L_DXT23_A8R8G8B8:
+    case FORMAT_L_DXT45_A8R8G8B8:
+      compressed = true;
+      bytes_per_pixel = 0;
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+uint32_t LevelSize(uint32_t format, uint32_t width, uint32_t height) {
+  uint32_t bytes_per_pixel;
+  bool swizzled;
+  bool compressed;
+  if (!GetFormatInfo(format, bytes_per_pixel, swizzled, compressed)) {
+    return 0;
+  }
+
+  if (compressed) {
+    uint32_t block_size = format == FORMAT_L_DXT1_A1R5G5B5 ? 8 : 16;
+    return ((width + 3) / 4) * ((height + 3) / 4) * block_size;
+  }
+  return width * height * bytes_per_pixel;
+}
+
+bool Validate(const uint8_t *blob, uint32_t size, std::string &error) {
+  if (size < sizeof(Header)) {
+    error = "Blob is too small to hold a header";
+    return false;
+  }
+
+  Header header;
+  memcpy(&header, blob, sizeof(header));
+  if (header.magic != kMagic) {
+    error = "Not a compiled texture (bad magic)";
+    return false;
+  }
+  if (header.version != kVersion || header.header_size != sizeof(Header)) {
+    error = "Unsupported compiled texture version " + std::to_string(header.version);
+    return false;
+  }
+  if (header.blob_size != size) {
+    error = "Blob size " + std::to_string(size) + " does not match header " + std::to_string(header.blob_size);
+    return false;
+  }
+
+  uint32_t bytes_per_pixel;
+  bool swizzled;
+  bool compressed;
+  if (!GetFormatInfo(header.format, bytes_per_pixel, swizzled, compressed)) {
+    error = "Unsupported format " + std::to_string(header.format);
+    return false;
+  }
+  if (swizzled != !!(header.flags & FLAG_SWIZZLED) || compressed != !!(header.flags & FLAG_COMPRESSED) ||
+      bytes_per_pixel != header.bytes_per_pixel) {
+    error = "Flags do not match format " + std::to_string(header.format);
+    return false;
+  }
+  if (!header.width || !header.height || !header.num_levels || header.num_levels > kMaxLevels) {
+    error = "Invalid dimensions or level count";
+    return false;
+  }
+
+  uint32_t width = header.width;
+  uint32_t height = header.height;
+  uint32_t end = sizeof(Header);
+  for (uint32_t level = 0; level < header.num_levels; ++level) {
+    uint32_t offset = header.level_offsets[level];
+    uint32_t level_size = header.level_sizes[level];
+    if (offset % kAlignment || offset < end || offset > size || level_size > size - offset) {
+      error = "Level " + std::to_string(level) + " is misaligned or lies outside of the blob";
+      return false;
+    }
+    if (level_size != LevelSize(header.format, width, height)) {
+      error = "Level " + std::to_string(level) + " has an unexpected size";
+      return false;
+    }
+    end = offset + level_size;
+    width = std::max(1U, width >> 1);
+    height = std::max(1U, height >> 1);
+  }
+
+  return true;
+}
+
+}  // namespace CompiledTexture
+
+bool AssetManifest::Build(std::vector<Entry> entries, std::vector<uint8_t> &manifest, std::string &error) {
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) { return strcmp(a.name, b.name) < 0; });
+  for (uint32_t i = 1; i < entries.size(); ++i) {
+    if (!strcmp(entries[i - 1].name, entries[i].name)) {
+      error = std::string("Duplicate asset ") + entries[i].name;
+      return false;
+    }
+  }
+
+  Header header{kMagic, kVersion, sizeof(Entry), static_cast<uint32_t>(entries.size()), 0};
+  manifest.resize(sizeof(header) + entries.size() * sizeof(Entry));
+  memcpy(manifest.data(), &header, sizeof(header));
+  if (!entries.empty()) {
+    memcpy(manifest.data() + sizeof(header), entries.data(), entries.size() * sizeof(Entry));
+  }
+  return true;
+}
+
+bool AssetManifest::Parse(const uint8_t *manifest, uint32_t size, std::string &error) {
+  Header header;
+  if (size < sizeof(header)) {
+    error = "Manifest is too small to hold a header";
+    return false;
+  }
+  memcpy(&header, manifest, sizeof(header));
+  if (header.magic != kMagic || header.version != kVersion || header.entry_size != sizeof(Entry)) {
+    error = "Unsupported manifest";
+    return false;
+  }
+  if (static_cast<uint64_t>(header.num_entries) * sizeof(Entry) != size - sizeof(header)) {
+    error = "Manifest size does not match its entry count";
+    return false;
+  }
+
+  entries_.resize(header.num_entries);
+  if (header.num_entries) {
+    memcpy(entries_.data(), manifest + sizeof(header), header.num_entries * sizeof(Entry));
+  }
+  for (uint32_t i = 0; i < entries_.size(); ++i) {
+    if (!memchr(entries_[i].name, 0, sizeof(entries_[i].name)) ||
+        (i && strcmp(entries_[i - 1].name, entries_[i].name) >= 0)) {
+      entries_.clear();
+      error = "Manifest entries are malformed or not sorted";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool AssetManifest::Load(const std::string &directory, std::string &error) {
+  auto path = ManifestPath(directory);
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (!fp) {
+    error = "Failed to open " + path;
+    return false;
+  }
+  std::unique_ptr<FILE, decltype(&fclose)> closer(fp, &fclose);
+
+  long size = -1;
+  if (!fseek(fp, 0, SEEK_END)) {
+    size = ftell(fp);
+  }
+  if (size < 0 || fseek(fp, 0, SEEK_SET)) {
+    error = "Failed to determine the size of " + path;
+    return false;
+  }
+
+  std::vector<uint8_t> manifest(size);
+  if (size && fread(manifest.data(), size, 1, fp) != 1) {
+    error = "Failed to read " + path;
+    return false;
+  }
+
+  if (!Parse(manifest.data(), manifest.size(), error)) {
+    error = path + ": " + error;
+    return false;
+  }
+  directory_ = directory;
+  return true;
+}
+
+const AssetManifest::Entry *AssetManifest::Find(const std::string &name) const {
+  auto it = std::lower_bound(entries_.begin(), entries_.end(), name, [](const Entry &entry, const std::string &key) {
+    return strcmp(entry.name, key.c_str()) < 0;
+  });
+  if (it == entries_.end() || name != it->name) {
+    return nullptr;
+  }
+  return &*it;
+}
+
+bool AssetManifest::LoadTexture(const std::string &name, const AllocateCallback &allocate, uint8_t *&blob,
+                                std::string &error) const {
+  auto entry = Find(name);
+  if (!entry) {
+    error = "No compiled asset named " + name;
+    return false;
+  }
+
+  auto path = BlobPath(directory_, name);
+  ResourcePrefetcher::Resource prefetched;
+  auto prefetcher = ResourcePrefetcher::Active();
+  bool is_prefetched = prefetcher && prefetcher->Take(path, prefetched);
+
+  std::unique_ptr<FILE, decltype(&fclose)> fp(nullptr, &fclose);
+  if (is_prefetched) {
+    if (prefetched.size != entry->blob_size) {
+      error = path + " does not match the manifest";
+      return false;
+    }
+  } else {
+    fp.reset(fopen(path.c_str(), "rb"));
+    if (!fp) {
+      error = "Failed to open " + path;
+      return false;
+    }
+  }
+
+  blob = allocate(entry->blob_size);
+  if (!blob) {
+    error = "Failed to allocate " + std::to_string(entry->blob_size) + " bytes for " + path;
+    return false;
+  }
+  if (is_prefetched) {
+    memcpy(blob, prefetched.data(), entry->blob_size);
+  } else if (fread(blob, entry->blob_size, 1, fp.get()) != 1) {
+    error = "Failed to read " + path;
+    return false;
+  }
+
+  if (!CompiledTexture::Validate(blob, entry->blob_size, error)) {
+    error = path + ": " + error;
+    return false;
+  }
+  return true;
+}
+
+std::string AssetManifest::ManifestPath(const std::string &directory) {
+  return directory + kPathSeparator + kManifestFilename;
+}
+
+std::string AssetManifest::BlobPath(const std::string &directory, const std::string &name) {
+  std::string ret = directory + kPathSeparator + name + kBlobExtension;
+  std::replace(ret.begin() + directory.size(), ret.end(), '/', kPathSeparator);
+  return ret;
+}
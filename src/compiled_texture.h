@@ -0,0 +1,155 @@
+#ifndef NXDK_PGRAPH_TESTS_COMPILED_TEXTURE_H
+#define NXDK_PGRAPH_TESTS_COMPILED_TEXTURE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * GPU-ready texture blobs produced at build time by utils/asset_compiler.
+ *
+ * A blob is a fixed size Header followed by each mip level in the target texture format (swizzled when requested), with
+ * every level starting on a kAlignment boundary. Loading a blob into page aligned contiguous memory therefore yields
+ * texture data that can be handed to the NV2A directly.
+ *
+ * The compiler also writes an AssetManifest listing the size and layout of every blob, so that the runtime can
+ * allocate the destination up front and load each blob with a single read.
+ */
+namespace CompiledTexture {
+
+static constexpr uint32_t kMagic = 0x58544743;  // "CGTX"
+static constexpr uint16_t kVersion = 1;
+static constexpr uint32_t kAlignment = 64;
+static constexpr uint32_t kMaxLevels = 13;
+
+// Values mirror NV097_SET_TEXTURE_FORMAT_COLOR_*.
+enum Format {
+  FORMAT_SZ_A1R5G5B5 = 0x02,
+  FORMAT_SZ_X1R5G5B5 = 0x03,
+  FORMAT_SZ_A4R4G4B4 = 0x04,
+  FORMAT_SZ_R5G6B5 = 0x05,
+  FORMAT_SZ_A8R8G8B8 = 0x06,
+  FORMAT_SZ_X8R8G8B8 = 0x07,
+  FORMAT_L_DXT1_A1R5G5B5 = 0x0C,
+  FORMAT_L_DXT23_A8R8G8B8 = 0x0E,
+  FORMAT_L_DXT45_A8R8G8B8 = 0x0F,
+  FORMAT_LU_IMAGE_A1R5G5B5 = 0x10,
+  FORMAT_LU_IMAGE_R5G6B5 = 0x11,
+  FORMAT_LU_IMAGE_A8R8G8B8 = 0x12,
+  FORMAT_LU_IMAGE_A4R4G4B4 = 0x1D,
+  FORMAT_LU_IMAGE_X8R8G8B8 = 0x1E,
+};
+
+enum Flags {
+  FLAG_SWIZZLED = 1 << 0,
+  FLAG_COMPRESSED = 1 << 1,
+};
+
+struct Header {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t header_size;
+  //! One of Format.
+  uint32_t format;
+  //! Combination of Flags.
+  uint32_t flags;
+  uint32_t width;
+  uint32_t height;
+  //! Bytes between rows of the first level for linear formats, bytes between rows of blocks for compressed formats.
+  uint32_t pitch;
+  //! Bytes per texel, or 0 for compressed formats.
+  uint32_t bytes_per_pixel;
+  uint32_t num_levels;
+  //! Total size of the blob, including this header.
+  uint32_t blob_size;
+  //! Offset and size of each mip level, from the start of the blob.
+  uint32_t level_offsets[kMaxLevels];
+  uint32_t level_sizes[kMaxLevels];
+  uint32_t reserved[12];
+};
+static_assert(sizeof(Header) == 192, "Header layout is part of the on-disk format and must preserve kAlignment");
+
+//! Returns the information needed to lay out a format, or false if the format is not supported.
+bool GetFormatInfo(uint32_t format, uint32_t &bytes_per_pixel, bool &swizzled, bool &compressed);
+
+//! Returns the number of bytes occupied by a `width` x `height` level of `format`.
+uint32_t LevelSize(uint32_t format, uint32_t width, uint32_t height);
+
+//! Validates the blob held in `blob`. Returns false and populates `error` if it is malformed.
+bool Validate(const uint8_t *blob, uint32_t size, std::string &error);
+
+}  // namespace CompiledTexture
+
+/**
+ * Index of the compiled texture blobs in a directory, sorted by asset name.
+ */
+class AssetManifest {
+ public:
+  static constexpr uint32_t kMagic = 0x4E414D41;  // "AMAN"
+  static constexpr uint16_t kVersion = 1;
+  static constexpr uint32_t kMaxNameLength = 95;
+
+  struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entry_size;
+    uint32_t num_entries;
+    uint32_t reserved;
+  };
+
+  struct Entry {
+    //! Path of the source asset relative to the resource root, using '/' separators, NUL terminated.
+    char name[kMaxNameLength + 1];
+    uint32_t blob_size;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t num_levels;
+    uint32_t flags;
+    uint32_t reserved[2];
+  };
+  static_assert(sizeof(Entry) == 128, "Entry layout is part of the on-disk format");
+
+  //! Returns a buffer of at least `size` bytes to receive a blob, or nullptr to abort the load.
+  typedef std::function<uint8_t *(uint32_t size)> AllocateCallback;
+
+ public:
+  /**
+   * Serializes the given entries, sorting them by name.
+   *
+   * Returns false and populates `error` if any names are duplicated.
+   */
+  static bool Build(std::vector<Entry> entries, std::vector<uint8_t> &manifest, std::string &error);
+
+  //! Validates and adopts a serialized manifest. Returns false and populates `error` if it is malformed.
+  bool Parse(const uint8_t *manifest, uint32_t size, std::string &error);
+
+  //! Reads and parses the manifest in `directory`. Returns false and populates `error` on failure.
+  bool Load(const std::string &directory, std::string &error);
+
+  //! Returns the entry for the given asset name, or nullptr if there is none.
+  [[nodiscard]] const Entry *Find(const std::string &name) const;
+
+  [[nodiscard]] const std::vector<Entry> &entries() const { return entries_; }
+
+  /**
+   * Loads the blob for `name` into a buffer obtained from `allocate` with a single read, or copies it from the active
+   * ResourcePrefetcher if it has already been read.
+   *
+   * `blob` receives the buffer even if the read fails, so that the caller can release it.
+   */
+  bool LoadTexture(const std::string &name, const AllocateCallback &allocate, uint8_t *&blob, std::string &error) const;
+
+  //! Returns the path of the manifest file within `directory`.
+  static std::string ManifestPath(const std::string &directory);
+
+  //! Returns the path of the blob for asset `name` within `directory`.
+  static std::string BlobPath(const std::string &directory, const std::string &name);
+
+ private:
+  std::string directory_;
+  std::vector<Entry> entries_;
+};
+
+#endif  // NXDK_PGRAPH_TESTS_COMPILED_TEXTURE_H
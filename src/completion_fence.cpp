@@ -0,0 +1,21 @@
+#include "completion_fence.h"
+
+uint32_t CompletionFence::Insert() {
+  auto value = last_inserted_ + 1;
+  // Zero is the initial contents of the device buffer, so it is skipped on wraparound to avoid reporting a fence as
+  // complete before the GPU has written anything.
+  if (value == kInvalidFence) {
+    ++value;
+  }
+
+  device_.Signal(value);
+  last_inserted_ = value;
+  return value;
+}
+
+bool CompletionFence::IsComplete(uint32_t fence) const {
+  if (fence == kInvalidFence) {
+    return false;
+  }
+  return static_cast<int32_t>(device_.Read() - fence) >= 0;
+}
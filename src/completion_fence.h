@@ -0,0 +1,99 @@
+#ifndef NXDK_PGRAPH_TESTS_COMPLETION_FENCE_H
+#define NXDK_PGRAPH_TESTS_COMPLETION_FENCE_H
+
+#include <cstdint>
+
+/**
+ * Tracks monotonically increasing fence values that the GPU writes back once it has processed all preceding work.
+ *
+ * The fence does not know how values reach the hardware; a Device implementation enqueues the write (e.g., a
+ * BACK_END_WRITE_SEMAPHORE_RELEASE into a CPU visible DMA buffer) and reads back the most recently completed value.
+ * This keeps the bookkeeping testable against a simulated GPU.
+ */
+class CompletionFence {
+ public:
+  class Device {
+   public:
+    virtual ~Device() = default;
+
+    //! Enqueues a command that causes `value` to be written once all previously submitted work has completed.
+    virtual void Signal(uint32_t value) = 0;
+    //! Returns the most recently written value.
+    [[nodiscard]] virtual uint32_t Read() const = 0;
+  };
+
+  struct Stats {
+    //! Number of calls to Wait.
+    uint32_t waits{0};
+    //! Number of waits for fences that had already completed when Wait was called.
+    uint32_t already_complete{0};
+    //! Total number of times the device was polled by Wait.
+    uint64_t total_polls{0};
+    //! Number of waits that gave up before the fence completed.
+    uint32_t timeouts{0};
+  };
+
+  //! Reserved value that Insert never returns and that never completes, as it matches a freshly cleared device buffer.
+  static constexpr uint32_t kInvalidFence = 0;
+
+ public:
+  //! Creates a fence whose next inserted value follows `last_inserted`, which should match the value the device
+  //! currently reports.
+  explicit CompletionFence(Device &device, uint32_t last_inserted = kInvalidFence)
+      : device_(device), last_inserted_(last_inserted) {}
+
+  //! Signals a new fence value after all previously submitted work and returns it.
+  uint32_t Insert();
+
+  //! Returns true if the GPU has reached the given fence. Values are compared with wraparound, so a fence is considered
+  //! complete once the device reports it or any value inserted after it.
+  [[nodiscard]] bool IsComplete(uint32_t fence) const;
+
+  /**
+   * Polls the device until the given fence completes.
+   *
+   * @param fence - Value returned by Insert.
+   * @param max_polls - Number of times to poll before giving up.
+   * @param on_poll - Optional callback invoked after each unsuccessful poll (e.g., to yield or count iterations).
+   * @return true if the fence completed, false if `max_polls` was exhausted.
+   */
+  template <typename Callback>
+  bool Wait(uint32_t fence, uint32_t max_polls, Callback &&on_poll);
+  bool Wait(uint32_t fence, uint32_t max_polls) {
+    return Wait(fence, max_polls, [] {});
+  }
+
+  //! Returns the value most recently returned by Insert.
+  [[nodiscard]] uint32_t GetLastInserted() const { return last_inserted_; }
+  [[nodiscard]] const Stats &GetStats() const { return stats_; }
+
+ private:
+  Device &device_;
+  uint32_t last_inserted_;
+  Stats stats_;
+};
+
+template <typename Callback>
+bool CompletionFence::Wait(uint32_t fence, uint32_t max_polls, Callback &&on_poll) {
+  ++stats_.waits;
+  if (fence == kInvalidFence) {
+    ++stats_.timeouts;
+    return false;
+  }
+
+  for (uint32_t i = 0; i < max_polls; ++i) {
+    ++stats_.total_polls;
+    if (IsComplete(fence)) {
+      if (!i) {
+        ++stats_.already_complete;
+      }
+      return true;
+    }
+    on_poll();
+  }
+
+  ++stats_.timeouts;
+  return false;
+}
+
+#endif  // NXDK_PGRAPH_TESTS_COMPLETION_FENCE_H
@@ -0,0 +1,49 @@
+#include "contiguous_arena.h"
+
+#include <algorithm>
+
+#include "allocation_tracker.h"
+
+uint8_t *ContiguousArena::Allocate(uint32_t size, uint32_t alignment) {
+  if (!size || !alignment || (alignment & (alignment - 1))) {
+    return nullptr;
+  }
+
+  // Alignment applies to the absolute address, as the region itself may only be page aligned.
+  auto cursor = reinterpret_cast<uintptr_t>(base_) + used_;
+  auto aligned = (cursor + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+  auto offset = aligned - reinterpret_cast<uintptr_t>(base_);
+  if (offset > capacity_ || size > capacity_ - offset) {
+    return nullptr;
+  }
+
+  auto end = static_cast<uint32_t>(offset + size);
+  if (tracker_) {
+    tracker_->RecordAllocation(AllocationTracker::Kind::CONTIGUOUS, end - used_);
+  }
+  used_ = end;
+  high_water_mark_ = std::max(high_water_mark_, used_);
+  ++num_allocations_;
+  return base_ + offset;
+}
+
+void ContiguousArena::Reset() {
+  Rewind(0);
+  num_allocations_ = 0;
+}
+
+void ContiguousArena::Rewind(uint32_t mark) {
+  if (mark >= used_) {
+    return;
+  }
+  if (tracker_) {
+    tracker_->RecordRelease(AllocationTracker::Kind::CONTIGUOUS, used_ - mark);
+  }
+  used_ = mark;
+}
+
+bool ContiguousArena::Contains(const void *address) const {
+  auto value = reinterpret_cast<uintptr_t>(address);
+  auto base = reinterpret_cast<uintptr_t>(base_);
+  return value >= base && value - base < capacity_;
+}
@@ -0,0 +1,78 @@
+#ifndef NXDK_PGRAPH_TESTS_CONTIGUOUS_ARENA_H
+#define NXDK_PGRAPH_TESTS_CONTIGUOUS_ARENA_H
+
+#include <cstdint>
+
+class AllocationTracker;
+
+/**
+ * Bump allocator over a single region of physically contiguous memory.
+ *
+ * Allocations cannot be released individually. Instead the arena is Reset when the owning test suite is torn down, or
+ * rewound to a previous mark (see Scope) to release temporaries made by a single test. Carving suite resources out of
+ * one long lived region avoids fragmenting the contiguous heap over a full run, and the high water mark shows how much
+ * memory the most demanding suite actually needed.
+ */
+class ContiguousArena {
+ public:
+  static constexpr uint32_t kDefaultAlignment = 0x1000;
+
+  //! Rewinds the arena to the position at construction when destroyed, releasing any allocations made in between.
+  class Scope {
+   public:
+    explicit Scope(ContiguousArena &arena) : arena_(arena), mark_(arena.GetMark()) {}
+    ~Scope() { arena_.Rewind(mark_); }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+   private:
+    ContiguousArena &arena_;
+    uint32_t mark_;
+  };
+
+ public:
+  //! Manages the `capacity` bytes at `base`, which must remain valid for the lifetime of the arena.
+  //!
+  //! If `tracker` is provided, it is informed of the bytes consumed (including alignment padding) and released.
+  ContiguousArena(uint8_t *base, uint32_t capacity, AllocationTracker *tracker = nullptr)
+      : base_(base), capacity_(capacity), tracker_(tracker) {}
+
+  /**
+   * Returns `size` bytes whose address is a multiple of `alignment`, which must be a power of two.
+   *
+   * Returns nullptr if `size` is 0, `alignment` is invalid, or the arena does not have enough space remaining.
+   */
+  [[nodiscard]] uint8_t *Allocate(uint32_t size, uint32_t alignment = kDefaultAlignment);
+
+  //! Releases every allocation.
+  void Reset();
+
+  //! Returns a mark that may later be passed to Rewind.
+  [[nodiscard]] uint32_t GetMark() const { return used_; }
+
+  //! Releases every allocation made since `mark` was obtained.
+  void Rewind(uint32_t mark);
+
+  //! Returns true if `address` lies within the arena's region.
+  [[nodiscard]] bool Contains(const void *address) const;
+
+  [[nodiscard]] uint8_t *GetBase() const { return base_; }
+  [[nodiscard]] uint32_t GetCapacity() const { return capacity_; }
+  //! Returns the number of bytes currently consumed, including alignment padding.
+  [[nodiscard]] uint32_t GetUsed() const { return used_; }
+  //! Returns the largest value GetUsed has reported since the arena was created.
+  [[nodiscard]] uint32_t GetHighWaterMark() const { return high_water_mark_; }
+  //! Returns the number of allocations made since the last Reset.
+  [[nodiscard]] uint32_t GetNumAllocations() const { return num_allocations_; }
+
+ private:
+  uint8_t *base_;
+  uint32_t capacity_;
+  AllocationTracker *tracker_;
+  uint32_t used_{0};
+  uint32_t high_water_mark_{0};
+  uint32_t num_allocations_{0};
+};
+
+#endif  // NXDK_PGRAPH_TESTS_CONTIGUOUS_ARENA_H
@@ -0,0 +1,32 @@
+#include "default_state.h"
+
+#include <memory>
+
+namespace DefaultState {
+
+Blocks Build(uint32_t framebuffer_width, uint32_t framebuffer_height) {
+  Blocks ret{framebuffer_width, framebuffer_height};
+
+  EmitSurfaceAndLighting(ret.surface_and_lighting, framebuffer_width, framebuffer_height);
+  ret.surface_and_lighting.Seal();
+
+  EmitTextureAndRaster(ret.texture_and_raster);
+  ret.texture_and_raster.Seal();
+
+  return ret;
+}
+
+const Blocks &Get(uint32_t framebuffer_width, uint32_t framebuffer_height) {
+  // The framebuffer size is fixed for the lifetime of the program in practice, so only the most recently requested
+  // configuration is retained.
+  static std::unique_ptr<Blocks> cached;
+
+  if (!cached || cached->framebuffer_width != framebuffer_width ||
+      cached->framebuffer_height != framebuffer_height) {
+    cached = std::make_unique<Blocks>(Build(framebuffer_width, framebuffer_height));
+  }
+
+  return *cached;
+}
+
+}  // namespace DefaultState
@@ -0,0 +1,144 @@
+#ifndef NXDK_PGRAPH_TESTS_DEFAULT_STATE_H
+#define NXDK_PGRAPH_TESTS_DEFAULT_STATE_H
+
+#include <pbkit/pbkit.h>
+
+#include <cstdint>
+
+#include "command_block.h"
+#include "nxdk_ext.h"
+#include "pbkit_ext.h"
+
+/**
+ * Raw register portion of the baseline state applied by TestSuite::Initialize.
+ *
+ * Each Emit* function takes any type providing `Push(command, uint32_t...)` and `PushF(command, float...)` so that the
+ * same sequence can be recorded into a CommandBlock or replayed imperatively. State that is mirrored by TestHost (e.g.,
+ * combiners, texture stages) is intentionally not included, as it must flow through the TestHost setters to keep the
+ * cached state coherent.
+ */
+namespace DefaultState {
+
+//! Emits surface, lighting, and primitive assembly defaults. Must be sent after the surface format is set.
+template <typename Emitter>
+void EmitSurfaceAndLighting(Emitter &pb, uint32_t framebuffer_width, uint32_t framebuffer_height) {
+  const uint32_t kFramebufferPitch = framebuffer_width * 4;
+
+  pb.PushF(NV097_SET_EYE_POSITION, 0.0f, 0.0f, 0.0f, 1.0f);
+  pb.Push(NV097_SET_ZMIN_MAX_CONTROL, NV097_SET_ZMIN_MAX_CONTROL_CULL_NEAR_FAR_EN_TRUE |
+                                          NV097_SET_ZMIN_MAX_CONTROL_ZCLAMP_EN_CULL |
+                                          NV097_SET_ZMIN_MAX_CONTROL_CULL_IGNORE_W_FALSE);
+  pb.Push(NV097_SET_SURFACE_PITCH,
+          MASK(NV097_SET_SURFACE_PITCH_COLOR, kFramebufferPitch) | MASK(NV097_SET_SURFACE_PITCH_ZETA, kFramebufferPitch));
+  pb.Push(NV097_SET_SURFACE_CLIP_HORIZONTAL, framebuffer_width << 16);
+  pb.Push(NV097_SET_SURFACE_CLIP_VERTICAL, framebuffer_height << 16);
+
+  pb.Push(NV097_SET_LIGHTING_ENABLE, false);
+  pb.Push(NV097_SET_SPECULAR_ENABLE, false);
+  pb.Push(NV097_SET_LIGHT_CONTROL,
+          NV097_SET_LIGHT_CONTROL_V_ALPHA_FROM_MATERIAL_SPECULAR | NV097_SET_LIGHT_CONTROL_V_SEPARATE_SPECULAR);
+  pb.Push(NV097_SET_LIGHT_ENABLE_MASK, NV097_SET_LIGHT_ENABLE_MASK_LIGHT0_OFF);
+  pb.Push(NV097_SET_COLOR_MATERIAL, NV097_SET_COLOR_MATERIAL_ALL_FROM_MATERIAL);
+  pb.Push(NV097_SET_SCENE_AMBIENT_COLOR, 0x0, 0x0, 0x0);
+  pb.Push(NV097_SET_MATERIAL_EMISSION, 0x0, 0x0, 0x0);
+  pb.PushF(NV097_SET_MATERIAL_ALPHA, 1.0f);
+  pb.PushF(NV097_SET_BACK_MATERIAL_ALPHA, 1.f);
+
+  pb.Push(NV097_SET_LIGHT_TWO_SIDE_ENABLE, false);
+  pb.Push(NV097_SET_FRONT_POLYGON_MODE, NV097_SET_FRONT_POLYGON_MODE_V_FILL);
+  pb.Push(NV097_SET_BACK_POLYGON_MODE, NV097_SET_FRONT_POLYGON_MODE_V_FILL);
+
+  pb.Push(NV097_SET_POINT_PARAMS_ENABLE, false);
+  pb.Push(NV097_SET_POINT_SMOOTH_ENABLE, false);
+  pb.Push(NV097_SET_POINT_SIZE, 8);
+  pb.Push(NV097_SET_LINE_WIDTH, 8);
+
+  pb.Push(NV097_SET_DOT_RGBMAPPING, 0);
+
+  pb.Push(NV097_SET_SHADE_MODEL, NV097_SET_SHADE_MODEL_SMOOTH);
+  pb.Push(NV097_SET_FLAT_SHADE_OP, NV097_SET_FLAT_SHADE_OP_VERTEX_LAST);
+}
+
+//! Emits texture unit, fog, rasterizer, depth/stencil, and vertex attribute defaults.
+template <typename Emitter>
+void EmitTextureAndRaster(Emitter &pb) {
+  // TODO: Set up with TextureStage instances in host_.
+  uint32_t address = NV097_SET_TEXTURE_ADDRESS;
+  uint32_t control = NV097_SET_TEXTURE_CONTROL0;
+  uint32_t filter = NV097_SET_TEXTURE_FILTER;
+  for (auto i = 0; i < 4; ++i) {
+    pb.Push(address, 0x10101);
+    pb.Push(control, 0x3ffc0);
+    pb.Push(filter, 0x1012000);
+
+    address += 0x40;
+    control += 0x40;
+    filter += 0x40;
+  }
+
+  pb.Push(NV097_SET_FOG_ENABLE, false);
+  pb.PushF(NV097_SET_FOG_PLANE, 0.f, 0.f, 1.f, 0.f);
+  pb.Push(NV097_SET_FOG_GEN_MODE, NV097_SET_FOG_GEN_MODE_V_PLANAR);
+  pb.Push(NV097_SET_FOG_MODE, NV097_SET_FOG_MODE_V_LINEAR);
+  pb.Push(NV097_SET_FOG_COLOR, 0xFFFFFFFF);
+
+  pb.Push(NV097_SET_TEXTURE_MATRIX_ENABLE, 0, 0, 0, 0);
+
+  pb.Push(NV097_SET_FRONT_FACE, NV097_SET_FRONT_FACE_V_CW);
+  pb.Push(NV097_SET_CULL_FACE, NV097_SET_CULL_FACE_V_BACK);
+  pb.Push(NV097_SET_CULL_FACE_ENABLE, true);
+
+  pb.Push(NV097_SET_COLOR_MASK, NV097_SET_COLOR_MASK_BLUE_WRITE_ENABLE | NV097_SET_COLOR_MASK_GREEN_WRITE_ENABLE |
+                                    NV097_SET_COLOR_MASK_RED_WRITE_ENABLE | NV097_SET_COLOR_MASK_ALPHA_WRITE_ENABLE);
+
+  pb.Push(NV097_SET_DEPTH_TEST_ENABLE, false);
+  pb.Push(NV097_SET_DEPTH_MASK, true);
+  pb.Push(NV097_SET_DEPTH_FUNC, NV097_SET_DEPTH_FUNC_V_LESS);
+  pb.Push(NV097_SET_STENCIL_TEST_ENABLE, false);
+  pb.Push(NV097_SET_STENCIL_MASK, 0xFF);
+  // If the stencil comparison fails, leave the value in the stencil buffer alone.
+  pb.Push(NV097_SET_STENCIL_OP_FAIL, NV097_SET_STENCIL_OP_V_KEEP);
+  // If the stencil comparison passes but the depth comparison fails, leave the stencil buffer alone.
+  pb.Push(NV097_SET_STENCIL_OP_ZFAIL, NV097_SET_STENCIL_OP_V_KEEP);
+  // If the stencil comparison passes and the depth comparison passes, leave the stencil buffer alone.
+  pb.Push(NV097_SET_STENCIL_OP_ZPASS, NV097_SET_STENCIL_OP_V_KEEP);
+  pb.Push(NV097_SET_STENCIL_FUNC_REF, 0x7F);
+
+  pb.Push(NV097_SET_NORMALIZATION_ENABLE, false);
+
+  pb.PushF(NV097_SET_WEIGHT4F, 0.f, 0.f, 0.f, 0.f);
+  pb.PushF(NV097_SET_NORMAL3F, 0.f, 0.f, 0.f);
+  pb.Push(NV097_SET_DIFFUSE_COLOR4I, 0x00000000);
+  pb.Push(NV097_SET_SPECULAR_COLOR4I, 0x00000000);
+  pb.PushF(NV097_SET_TEXCOORD0_4F, 0.f, 0.f, 0.f, 0.f);
+  pb.PushF(NV097_SET_TEXCOORD1_4F, 0.f, 0.f, 0.f, 0.f);
+  pb.PushF(NV097_SET_TEXCOORD2_4F, 0.f, 0.f, 0.f, 0.f);
+  pb.PushF(NV097_SET_TEXCOORD3_4F, 0.f, 0.f, 0.f, 0.f);
+  pb.Push(NV097_SET_VERTEX_DATA4UB + (4 * NV2A_VERTEX_ATTR_BACK_DIFFUSE), 0xFFFFFFFF);
+  pb.Push(NV097_SET_VERTEX_DATA4UB + (4 * NV2A_VERTEX_ATTR_BACK_SPECULAR), 0);
+
+  // Pow 16
+  const float specular_params[]{-0.803673, -2.7813, 2.97762, -0.64766, -2.36199, 2.71433};
+  for (uint32_t i = 0, offset = 0; i < 6; ++i, offset += 4) {
+    pb.PushF(NV097_SET_SPECULAR_PARAMS + offset, specular_params[i]);
+    pb.PushF(NV097_SET_SPECULAR_PARAMS_BACK + offset, 0);
+  }
+}
+
+//! Precompiled versions of the Emit* sequences for a particular framebuffer size.
+struct Blocks {
+  uint32_t framebuffer_width;
+  uint32_t framebuffer_height;
+  CommandBlock surface_and_lighting;
+  CommandBlock texture_and_raster;
+};
+
+//! Builds a new set of sealed blocks for the given framebuffer size.
+Blocks Build(uint32_t framebuffer_width, uint32_t framebuffer_height);
+
+//! Returns the cached blocks for the given framebuffer size, building them on first use.
+const Blocks &Get(uint32_t framebuffer_width, uint32_t framebuffer_height);
+
+}  // namespace DefaultState
+
+#endif  // NXDK_PGRAPH_TESTS_DEFAULT_STATE_H
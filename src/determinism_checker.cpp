@@ -0,0 +1,197 @@
+#include "determinism_checker.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static DeterminismChecker *active_checker = nullptr;
+
+static constexpr uint32_t kFNVOffsetBasis = 2166136261U;
+static constexpr uint32_t kFNVPrime = 16777619U;
+
+// FNV-1a applied to whole 32-bit words rather than bytes, so that a 32bpp pixel costs a single multiply. Both steps
+// are bijective, so changing any one word always changes the result.
+static uint32_t HashSpan(uint32_t hash, const uint8_t *data, uint32_t num_bytes) {
+  auto num_words = num_bytes / 4;
+  auto words = reinterpret_cast<const uint32_t *>(data);
+  for (uint32_t i = 0; i < num_words; ++i) {
+    hash = (hash ^ words[i]) * kFNVPrime;
+  }
+  for (uint32_t i = num_words * 4; i < num_bytes; ++i) {
+    hash = (hash ^ data[i]) * kFNVPrime;
+  }
+  return hash;
+}
+
+bool DeterminismChecker::FrameSignature::FindFirstDifference(const FrameSignature &other,
+                                                             AtlasLayout::Cell &region) const {
+  if (width != other.width || height != other.height || tile_size != other.tile_size) {
+    region = {0, 0, std::max(width, other.width), std::max(height, other.height)};
+    return true;
+  }
+  if (hash == other.hash) {
+    return false;
+  }
+
+  auto mismatch = std::mismatch(tile_hashes.begin(), tile_hashes.end(), other.tile_hashes.begin());
+  if (mismatch.first == tile_hashes.end()) {
+    return false;
+  }
+
+  auto tile = static_cast<uint32_t>(mismatch.first - tile_hashes.begin());
+  auto tiles_per_row = GetTilesPerRow();
+  region.left = (tile % tiles_per_row) * tile_size;
+  region.top = (tile / tiles_per_row) * tile_size;
+  region.width = std::min(tile_size, width - region.left);
+  region.height = std::min(tile_size, height - region.top);
+  return true;
+}
+
+std::string DeterminismChecker::Divergence::Describe() const {
+  char buffer[128];
+  if (frame_count_mismatch) {
+    snprintf(buffer, sizeof(buffer), " iteration %u presented %u frames instead of %u",
+             static_cast<unsigned int>(iteration), static_cast<unsigned int>(num_frames),
+             static_cast<unsigned int>(frame));
+  } else {
+    snprintf(buffer, sizeof(buffer), " frame %u iteration %u differs in %ux%u region at %u,%u",
+             static_cast<unsigned int>(frame), static_cast<unsigned int>(iteration),
+             static_cast<unsigned int>(region.width), static_cast<unsigned int>(region.height),
+             static_cast<unsigned int>(region.left), static_cast<unsigned int>(region.top));
+  }
+  return test_name + buffer;
+}
+
+DeterminismChecker::DeterminismChecker(uint32_t iterations) : iterations_(std::max<uint32_t>(iterations, 2)) {}
+
+DeterminismChecker::FrameSignature DeterminismChecker::ComputeSignature(const uint8_t *surface, uint32_t pitch,
+                                                                        uint32_t width, uint32_t height,
+                                                                        uint32_t bytes_per_pixel,
+                                                                        uint32_t tile_size) {
+  FrameSignature ret;
+  ret.width = width;
+  ret.height = height;
+  ret.tile_size = tile_size;
+  ret.hash = kFNVOffsetBasis;
+  if (!width || !height || !tile_size) {
+    return ret;
+  }
+
+  auto tiles_per_row = ret.GetTilesPerRow();
+  auto tile_rows = (height + tile_size - 1) / tile_size;
+  ret.tile_hashes.assign(tiles_per_row * tile_rows, kFNVOffsetBasis);
+
+  // Rows are visited in memory order, continuing the hash of each tile that the row passes through.
+  const auto tile_row_bytes = tile_size * bytes_per_pixel;
+  const auto row_bytes = width * bytes_per_pixel;
+  for (uint32_t y = 0; y < height; ++y) {
+    const uint8_t *row = surface + y * pitch;
+    auto tile_hash = &ret.tile_hashes[(y / tile_size) * tiles_per_row];
+    for (uint32_t offset = 0; offset < row_bytes; offset += tile_row_bytes, ++tile_hash) {
+      *tile_hash = HashSpan(*tile_hash, row + offset, std::min(tile_row_bytes, row_bytes - offset));
+    }
+  }
+
+  ret.hash = HashSpan(ret.hash, reinterpret_cast<const uint8_t *>(ret.tile_hashes.data()),
+                      ret.tile_hashes.size() * sizeof(ret.tile_hashes[0]));
+  return ret;
+}
+
+void DeterminismChecker::BeginTest(const std::string &name) {
+  in_test_ = true;
+  test_name_ = name;
+  iteration_ = 0;
+  iterations_started_ = 0;
+  frame_ = 0;
+  reference_frames_.clear();
+  diverged_frames_.clear();
+  divergences_.clear();
+}
+
+void DeterminismChecker::BeginIteration() {
+  if (!in_test_) {
+    return;
+  }
+  if (iterations_started_) {
+    FinishIteration();
+  }
+  iteration_ = iterations_started_++;
+  frame_ = 0;
+}
+
+void DeterminismChecker::RecordFrame(FrameSignature signature) {
+  if (!in_test_ || !iterations_started_) {
+    return;
+  }
+
+  auto frame = frame_++;
+  if (!iteration_) {
+    reference_frames_.emplace_back(std::move(signature));
+    diverged_frames_.push_back(false);
+    return;
+  }
+
+  // Extra frames are reported by FinishIteration.
+  if (frame >= reference_frames_.size() || diverged_frames_[frame]) {
+    return;
+  }
+
+  Divergence divergence;
+  if (!reference_frames_[frame].FindFirstDifference(signature, divergence.region)) {
+    return;
+  }
+  diverged_frames_[frame] = true;
+  divergence.test_name = test_name_;
+  divergence.frame = frame;
+  divergence.iteration = iteration_;
+  divergences_.emplace_back(std::move(divergence));
+}
+
+void DeterminismChecker::FinishIteration() {
+  if (!iteration_ || frame_ == reference_frames_.size()) {
+    return;
+  }
+
+  Divergence divergence;
+  divergence.test_name = test_name_;
+  divergence.frame = static_cast<uint32_t>(reference_frames_.size());
+  divergence.iteration = iteration_;
+  divergence.frame_count_mismatch = true;
+  divergence.num_frames = frame_;
+  divergences_.emplace_back(std::move(divergence));
+}
+
+const std::vector<DeterminismChecker::Divergence> &DeterminismChecker::EndTest() {
+  if (!in_test_) {
+    return divergences_;
+  }
+  if (iterations_started_) {
+    FinishIteration();
+  }
+  in_test_ = false;
+  reference_frames_.clear();
+  diverged_frames_.clear();
+
+  ++num_tests_checked_;
+  if (!divergences_.empty()) {
+    unstable_tests_.push_back(divergences_.front());
+  }
+  return divergences_;
+}
+
+std::vector<std::string> DeterminismChecker::Summarize() const {
+  std::vector<std::string> ret;
+  char buffer[96];
+  snprintf(buffer, sizeof(buffer), "Determinism: %u of %u tests unstable across %u iterations",
+           static_cast<unsigned int>(unstable_tests_.size()), static_cast<unsigned int>(num_tests_checked_),
+           static_cast<unsigned int>(iterations_));
+  ret.emplace_back(buffer);
+
+  for (const auto &divergence : unstable_tests_) {
+    ret.emplace_back("  UNSTABLE: " + divergence.Describe());
+  }
+  return ret;
+}
+
+void DeterminismChecker::SetActive(DeterminismChecker *checker) { active_checker = checker; }
+
+DeterminismChecker *DeterminismChecker::Active() { return active_checker; }
@@ -0,0 +1,112 @@
+#ifndef NXDK_PGRAPH_TESTS_DETERMINISM_CHECKER_H
+#define NXDK_PGRAPH_TESTS_DETERMINISM_CHECKER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "atlas_layout.h"
+
+/**
+ * Identifies tests whose output is not stable from one run to the next, so that flaky goldens can be told apart from
+ * real regressions.
+ *
+ * While a checker is active, each test is run several times without saving artifacts. Every frame passed to
+ * TestHost::FinishDraw is reduced to a FrameSignature and the frames of later iterations are compared against those of
+ * the first one.
+ */
+class DeterminismChecker {
+ public:
+  //! Default edge length, in pixels, of the square tiles that are hashed independently.
+  static constexpr uint32_t kDefaultTileSize = 32;
+
+  //! Hashes of a single frame. A hash is kept per tile so that a mismatch can be localized without retaining pixels.
+  struct FrameSignature {
+    uint32_t width{0};
+    uint32_t height{0};
+    uint32_t tile_size{0};
+    //! Hash of the whole frame, derived from the tile hashes.
+    uint32_t hash{0};
+    //! Hash of each tile, in row-major order. Tiles on the right and bottom edges may be partial.
+    std::vector<uint32_t> tile_hashes;
+
+    [[nodiscard]] uint32_t GetTilesPerRow() const { return tile_size ? (width + tile_size - 1) / tile_size : 0; }
+
+    //! Returns true if the frames differ, setting `region` to the first differing tile (or the entire frame if the
+    //! frames are not the same size).
+    bool FindFirstDifference(const FrameSignature &other, AtlasLayout::Cell &region) const;
+  };
+
+  //! Describes a frame that did not match the first iteration of its test.
+  struct Divergence {
+    std::string test_name;
+    //! Index of the frame within the test.
+    uint32_t frame{0};
+    //! The iteration that produced the mismatching frame. Iteration 0 is the reference.
+    uint32_t iteration{0};
+    //! The first tile that differs from the reference. Empty if the iteration produced a different number of frames.
+    AtlasLayout::Cell region;
+    //! Set if the iteration presented `num_frames` frames rather than the `frame` produced by the reference.
+    bool frame_count_mismatch{false};
+    uint32_t num_frames{0};
+
+    [[nodiscard]] std::string Describe() const;
+  };
+
+ public:
+  //! @param iterations - Number of times each test is run. Values below 2 are raised to 2.
+  explicit DeterminismChecker(uint32_t iterations);
+
+  [[nodiscard]] uint32_t GetIterations() const { return iterations_; }
+
+  //! Hashes a surface of `bytes_per_pixel` sized pixels, `pitch` bytes apart per row.
+  static FrameSignature ComputeSignature(const uint8_t *surface, uint32_t pitch, uint32_t width, uint32_t height,
+                                         uint32_t bytes_per_pixel, uint32_t tile_size = kDefaultTileSize);
+
+  //! Begins checking the named test.
+  void BeginTest(const std::string &name);
+
+  //! Begins the next run of the current test. Must be called before each run, including the first.
+  void BeginIteration();
+
+  //! Records a frame produced by the current run. Frames recorded outside of a test are ignored.
+  void RecordFrame(FrameSignature signature);
+
+  [[nodiscard]] bool InTest() const { return in_test_; }
+
+  //! Ends the current test and returns its divergences, which remain valid until the next BeginTest.
+  const std::vector<Divergence> &EndTest();
+
+  [[nodiscard]] uint32_t GetNumTestsChecked() const { return num_tests_checked_; }
+
+  //! Returns the first divergence of each unstable test, in the order the tests were run.
+  [[nodiscard]] const std::vector<Divergence> &GetUnstableTests() const { return unstable_tests_; }
+
+  //! Returns a line counting the unstable tests, followed by one line per unstable test.
+  [[nodiscard]] std::vector<std::string> Summarize() const;
+
+  //! Sets the checker consulted by TestSuite::Run and TestHost::FinishDraw. May be nullptr to disable checking.
+  static void SetActive(DeterminismChecker *checker);
+  static DeterminismChecker *Active();
+
+ private:
+  void FinishIteration();
+
+ private:
+  uint32_t iterations_;
+
+  bool in_test_{false};
+  std::string test_name_;
+  uint32_t iteration_{0};
+  uint32_t iterations_started_{0};
+  uint32_t frame_{0};
+  std::vector<FrameSignature> reference_frames_;
+  //! Whether a divergence has already been reported for each reference frame.
+  std::vector<bool> diverged_frames_;
+  std::vector<Divergence> divergences_;
+
+  uint32_t num_tests_checked_{0};
+  std::vector<Divergence> unstable_tests_;
+};
+
+#endif  // NXDK_PGRAPH_TESTS_DETERMINISM_CHECKER_H
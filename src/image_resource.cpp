@@ -2,18 +2,39 @@
 
 #include <SDL.h>
 #include <SDL_image.h>
-#include <pbkit/pbkit_dma.h>
 
+#include "contiguous_arena.h"
 #include "debug_output.h"
-#include "xbox-swizzle/swizzle.h"
+#include "texture_cache.h"
+#include "texture_swizzle.h"
 
-ImageResource::~ImageResource() {
-  if (data) {
-    MmFreeContiguousMemory(data);
+static std::unique_ptr<TextureCache> cache;
+
+void ImageResource::EnableCache(const std::string& directory) { cache = std::make_unique<TextureCache>(directory); }
+
+void ImageResource::LoadPNG(const std::string& source_path, ContiguousArena& arena, bool swizzle) {
+  // A failed cache load may leave a partially filled buffer behind, which is released by rewinding the arena.
+  auto mark = arena.GetMark();
+  auto allocate = [&arena](uint32_t size) { return arena.Allocate(size); };
+  data = nullptr;
+
+  TextureCache::Key key;
+  bool cacheable = cache && TextureCache::BuildKey(source_path, SDL_PIXELFORMAT_BGRA32, swizzle, key);
+  if (cacheable) {
+    TextureCache::Image image;
+    if (cache->Load(key, image, allocate, data)) {
+      width = image.width;
+      height = image.height;
+      pitch = image.pitch;
+      bytes_per_pixel = image.bytes_per_pixel;
+      swizzled = swizzle;
+      return;
+    }
+
+    arena.Rewind(mark);
+    data = nullptr;
   }
-}
 
-void ImageResource::LoadPNG(const std::string& source_path) {
   SDL_Surface* temp = IMG_Load(source_path.c_str());
   ASSERT(temp && "IMG_Load failed");
   SDL_Surface* test_image = SDL_ConvertSurfaceFormat(temp, SDL_PIXELFORMAT_BGRA32, 0);
@@ -23,17 +44,35 @@ void ImageResource::LoadPNG(const std::string& source_path) {
   height = test_image->h;
   width = test_image->w;
   bytes_per_pixel = test_image->format->BytesPerPixel;
+  swizzled = swizzle;
 
   uint32_t size = pitch * height;
-  data =
-      static_cast<uint8_t*>(MmAllocateContiguousMemoryEx(size, 0, MAXRAM, 0x1000, PAGE_WRITECOMBINE | PAGE_READWRITE));
+  data = allocate(size);
+  ASSERT(data && "Failed to allocate image memory");
 
-  memcpy(data, test_image->pixels, size);
+  if (swizzle) {
+    TextureSwizzle::SwizzleRect(static_cast<const uint8_t*>(test_image->pixels), width, height, data, pitch,
+                                bytes_per_pixel);
+  } else {
+    memcpy(data, test_image->pixels, size);
+  }
+
+  if (cacheable) {
+    // Prefer the surface over `data` where possible, since reading back write-combined memory is slow.
+    auto cached = swizzle ? data : static_cast<const uint8_t*>(test_image->pixels);
+    if (!cache->Store(key, {width, height, pitch, bytes_per_pixel}, cached)) {
+      PrintMsg("Failed to cache decoded image %s\n", source_path.c_str());
+    }
+  }
   SDL_FreeSurface(test_image);
 }
 
 void ImageResource::CopyTo(uint8_t* target) const { memcpy(target, data, pitch * height); }
 
 void ImageResource::SwizzleTo(uint8_t* target) const {
-  swizzle_rect(data, width, height, target, pitch, bytes_per_pixel);
+  if (swizzled) {
+    CopyTo(target);
+    return;
+  }
+  TextureSwizzle::SwizzleRect(data, width, height, target, pitch, bytes_per_pixel);
 }
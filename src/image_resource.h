@@ -3,6 +3,9 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
+
+class ContiguousArena;
 
 struct ImageResource {
   uint8_t *data{nullptr};
@@ -10,23 +13,28 @@ struct ImageResource {
   uint32_t height{0};
   uint32_t pitch{0};
   uint32_t bytes_per_pixel{0};
+  //! Whether `data` holds swizzled rather than linear texels.
+  bool swizzled{false};
 
   ImageResource() = default;
 
-  explicit ImageResource(const std::string &source_path) { LoadPNG(source_path); }
+  virtual ~ImageResource() = default;
 
-  virtual ~ImageResource();
+  //! Enables the persistent cache of decoded images, storing entries in the given existing directory.
+  static void EnableCache(const std::string &directory);
 
-  //! Loads a PNG file from the filesystem.
+  //! Loads a PNG file from the filesystem, or from the decoded image cache if it holds an up to date copy.
   //!
   //! source_path - Windows style path to the PNG file to load (e.g., "D:\\image_blit\\TestImage.png")
-  void LoadPNG(const std::string &source_path);
+  //! arena - Arena from which `data` is allocated. `data` is invalidated when the arena is reset.
+  //! swizzle - Whether `data` should be stored swizzled, ready to be copied directly into texture memory.
+  void LoadPNG(const std::string &source_path, ContiguousArena &arena, bool swizzle = false);
 
-  //! Copies the image data to the given target, which must be allocated and sufficiently large.
+  //! Copies the image data, as stored, to the given target, which must be allocated and sufficiently large.
   void CopyTo(uint8_t *target) const;
 
   //! Copies the image data to the given target, which must be allocated and sufficiently large, and performs texture
-  //! swizzling.
+  //! swizzling if the data is not already swizzled.
   void SwizzleTo(uint8_t *target) const;
 };
 
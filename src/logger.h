@@ -10,6 +10,9 @@ class Logger {
 
   static std::ofstream Log();
 
+  //! Returns true if Initialize has been called.
+  static bool IsInitialized() { return singleton_ != nullptr; }
+
  private:
   explicit Logger(const std::string &path, bool truncate_log = false);
 
@@ -15,6 +15,7 @@
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wmacro-redefined"
 #include <windows.h>
+#include <xboxkrnl/xboxkrnl.h>
 #pragma clang diagnostic pop
 #include <lwip/inet.h>
 #include <lwip/netif.h>
@@ -25,116 +26,21 @@
 #include <fstream>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "configure.h"
 #include "debug_output.h"
+#include "image_resource.h"
 #include "logger.h"
 #include "pushbuffer.h"
 #include "runtime_config.h"
 #include "test_driver.h"
 #include "test_host.h"
-#include "tests/alpha_func_tests.h"
-#include "tests/antialiasing_tests.h"
-#include "tests/attribute_carryover_tests.h"
-#include "tests/attribute_explicit_setter_tests.h"
-#include "tests/attribute_float_tests.h"
-#include "tests/blend_surface_tests.h"
-#include "tests/blend_tests.h"
-#include "tests/bump_env_lum_tests.h"
-#include "tests/bump_map_tests.h"
-#include "tests/clear_tests.h"
-#include "tests/clipping_precision_tests.h"
-#include "tests/color_key_tests.h"
-#include "tests/color_mask_blend_tests.h"
-#include "tests/color_zeta_disable_tests.h"
-#include "tests/color_zeta_overlap_tests.h"
-#include "tests/combiner_tests.h"
-#include "tests/context_switch_tests.h"
-#include "tests/degenerate_begin_end_tests.h"
-#include "tests/depth_clamp_tests.h"
-#include "tests/depth_format_fixed_function_tests.h"
-#include "tests/depth_format_tests.h"
-#include "tests/depth_function_tests.h"
-#include "tests/dma_corruption_around_surface_tests.h"
-#include "tests/edge_flag_tests.h"
-#include "tests/fog_carryover_tests.h"
-#include "tests/fog_exceptional_value_tests.h"
-#include "tests/fog_gen_tests.h"
-#include "tests/fog_param_tests.h"
-#include "tests/fog_tests.h"
-#include "tests/front_face_tests.h"
-#include "tests/high_vertex_count_tests.h"
-#include "tests/image_blit_tests.h"
-#include "tests/inline_array_size_mismatch.h"
-#include "tests/lighting_accumulation_tests.h"
-#include "tests/lighting_control_tests.h"
-#include "tests/lighting_normal_tests.h"
-#include "tests/lighting_range_tests.h"
-#include "tests/lighting_spotlight_tests.h"
-#include "tests/lighting_two_sided_tests.h"
-#include "tests/line_width_tests.h"
-#include "tests/material_alpha_tests.h"
-#include "tests/material_color_source_tests.h"
-#include "tests/material_color_tests.h"
-#include "tests/null_surface_tests.h"
-#include "tests/overlapping_draw_modes_tests.h"
-#include "tests/pixel_shader_tests.h"
-#include "tests/point_params_tests.h"
-#include "tests/point_size_tests.h"
-#include "tests/point_sprite_tests.h"
-#include "tests/pvideo_tests.h"
-#include "tests/set_vertex_data_tests.h"
-#include "tests/shade_model_tests.h"
-#include "tests/smoothing_tests.h"
-#include "tests/specular_back_tests.h"
-#include "tests/specular_tests.h"
-#include "tests/stencil_func_tests.h"
-#include "tests/stencil_tests.h"
-#include "tests/stipple_tests.h"
-#include "tests/surface_clip_tests.h"
-#include "tests/surface_format_tests.h"
-#include "tests/surface_pitch_tests.h"
-#include "tests/swath_width_tests.h"
-#include "tests/texgen_matrix_tests.h"
-#include "tests/texgen_tests.h"
-#include "tests/texture_2d_as_cubemap_tests.h"
-#include "tests/texture_3d_as_2d_tests.h"
-#include "tests/texture_anisotropy_tests.h"
-#include "tests/texture_border_color_tests.h"
-#include "tests/texture_border_tests.h"
-#include "tests/texture_brdf_tests.h"
-#include "tests/texture_cpu_update_tests.h"
-#include "tests/texture_cubemap_tests.h"
-#include "tests/texture_format_dxt_tests.h"
-#include "tests/texture_format_tests.h"
-#include "tests/texture_framebuffer_blit_tests.h"
-#include "tests/texture_lod_bias_tests.h"
-#include "tests/texture_matrix_tests.h"
-#include "tests/texture_palette_tests.h"
-#include "tests/texture_perspective_enable_tests.h"
-#include "tests/texture_perspective_tests.h"
-#include "tests/texture_render_target_tests.h"
-#include "tests/texture_render_update_in_place_tests.h"
-#include "tests/texture_shadow_comparator_tests.h"
-#include "tests/texture_signed_component_tests.h"
-#include "tests/texture_wrap_mode_tests.h"
-#include "tests/three_d_primitive_tests.h"
-#include "tests/two_d_line_tests.h"
-#include "tests/vertex_shader_independence_tests.h"
-#include "tests/vertex_shader_rounding_tests.h"
-#include "tests/vertex_shader_swizzle_tests.h"
-#include "tests/viewport_tests.h"
-#include "tests/volume_texture_tests.h"
-#include "tests/w_param_tests.h"
-#include "tests/wbuf_tests.h"
-#include "tests/weight_setter_tests.h"
-#include "tests/window_clip_tests.h"
-#include "tests/z_min_max_control_tests.h"
-#include "tests/zero_stride_tests.h"
-#include "tests/zpass_pixel_count_tests.h"
+#include "test_suite_registry.h"
+#include "watchdog.h"
 
 static constexpr int kDelayOnFailureMilliseconds = 4000;
 
@@ -143,8 +49,13 @@ static constexpr int kFramebufferHeight = 480;
 static constexpr int kTextureWidth = 256;
 static constexpr int kTextureHeight = 256;
 
+static constexpr const char* kTextureCacheDirectory = "z:\\texture_cache";
+
 #ifndef DUMP_CONFIG_FILE
 static constexpr const char* kLogFileName = "pgraph_progress_log.txt";
+static constexpr const char* kTimingHistoryFileName = "test_timings.txt";
+static constexpr const char* kWatchdogCheckpointFileName = "watchdog_checkpoint.txt";
+static constexpr uint32_t kWatchdogPollIntervalMilliseconds = 1000;
 #endif
 
 const UCHAR kSMCSlaveAddress = 0x20;
@@ -152,14 +63,13 @@ const UCHAR kSMCRegisterPower = 0x02;
 const UCHAR kSMCPowerShutdown = 0x80;
 
 static bool EnsureDriveMounted(char drive_letter, bool format = false);
+static bool MountCacheDrive();
 #ifdef DUMP_CONFIG_FILE
 static void DumpConfig(RuntimeConfig& config, std::vector<std::shared_ptr<TestSuite>>& test_suites);
 #else
 static bool LoadConfig(RuntimeConfig& config, std::vector<std::string>& errors);
 static void RunTests(RuntimeConfig& config, TestHost& host, std::vector<std::shared_ptr<TestSuite>>& test_suites);
 #endif
-static void RegisterSuites(TestHost& host, RuntimeConfig& config, std::vector<std::shared_ptr<TestSuite>>& test_suites,
-                           const std::string& output_directory, std::shared_ptr<FTPLogger> ftp_logger);
 static void Shutdown();
 
 extern "C" __cdecl int automount_d_drive(void);
@@ -222,13 +132,14 @@ int main() {
     return 1;
   };
 
-  if (!EnsureDriveMounted('Z', true)) {
+  if (!MountCacheDrive()) {
     debugPrint("Failed to mount cache dir.\n");
     pb_show_debug_screen();
     Sleep(kDelayOnFailureMilliseconds);
     pb_kill();
     return 1;
   }
+  ImageResource::EnableCache(kTextureCacheDirectory);
 
   TestHost::EnsureFolderExists(config.output_directory_path());
 
@@ -274,6 +185,7 @@ int main() {
 #endif  // #ifndef DUMP_CONFIG_FILE
 
   TestHost host(ftp_logger, kFramebufferWidth, kFramebufferHeight, kTextureWidth, kTextureHeight);
+  host.SetUseCaptureFence(config.enable_capture_fence());
   RegisterSuites(host, config, test_suites, config.output_directory_path(), ftp_logger);
 
   if (config.shard_count() > 0) {
@@ -341,6 +253,22 @@ static bool EnsureDriveMounted(char drive_letter, bool format) {
   return nxMountDrive(drive_letter, device_path);
 }
 
+//! Mounts Z:, only formatting it if it does not already hold a usable filesystem so that cached assets persist.
+static bool MountCacheDrive() {
+  auto ensure_cache_directory = []() {
+    return CreateDirectory(kTextureCacheDirectory, nullptr) || GetLastError() == ERROR_ALREADY_EXISTS;
+  };
+
+  if (EnsureDriveMounted('Z')) {
+    if (ensure_cache_directory()) {
+      return true;
+    }
+    nxUnmountDrive('Z');
+  }
+
+  return EnsureDriveMounted('Z', true) && ensure_cache_directory();
+}
+
 #ifdef DUMP_CONFIG_FILE
 static void DumpConfig(RuntimeConfig& config, std::vector<std::shared_ptr<TestSuite>>& test_suites) {
   std::string output_path = config.output_directory_path() + "\\sample-config.json";
@@ -376,19 +304,88 @@ static bool LoadConfig(RuntimeConfig& config, std::vector<std::string>& errors)
   return config.LoadConfig("d:\\nxdk_pgraph_tests_config.json", errors);
 }
 
+//! Skips every test that already ran before the watchdog rebooted the console.
+static void ResumeAfterHang(const WatchdogCheckpoint& checkpoint,
+                            std::vector<std::shared_ptr<TestSuite>>& test_suites) {
+  std::vector<std::string> ordered_test_names;
+  for (auto& suite : test_suites) {
+    for (auto& test_name : suite->TestNames()) {
+      ordered_test_names.emplace_back(suite->Name() + "::" + test_name);
+    }
+  }
+
+  auto skipped = checkpoint.SelectSkippedTests(ordered_test_names);
+  for (auto& suite : test_suites) {
+    std::set<std::string> tests_to_skip;
+    auto prefix = suite->Name() + "::";
+    for (auto& test_name : suite->TestNames()) {
+      if (skipped.count(prefix + test_name)) {
+        tests_to_skip.insert(test_name);
+      }
+    }
+    suite->DisableTests(tests_to_skip);
+  }
+  test_suites.erase(std::remove_if(test_suites.begin(), test_suites.end(),
+                                   [](const std::shared_ptr<TestSuite>& suite) { return !suite->HasEnabledTests(); }),
+                    test_suites.end());
+
+  PrintMsg("Resuming after hung test %s, skipping %u tests\n", checkpoint.GetHungTests().back().c_str(),
+           static_cast<uint32_t>(skipped.size()));
+}
+
 static void RunTests(RuntimeConfig& config, TestHost& host, std::vector<std::shared_ptr<TestSuite>>& test_suites) {
+  WatchdogCheckpoint checkpoint(config.output_directory_path() + "\\" + kWatchdogCheckpointFileName);
+  // A checkpoint is only meaningful if the run that wrote it will be continued automatically.
+  bool resuming = !config.disable_autorun() && checkpoint.Load();
+  if (resuming) {
+    ResumeAfterHang(checkpoint, test_suites);
+  } else {
+    checkpoint.Clear();
+  }
+
   if (config.enable_progress_log()) {
     std::string log_file = config.output_directory_path() + "\\" + kLogFileName;
 
-    DeleteFile(log_file.c_str());
+    // The log of the interrupted run is kept so that the resumed run's results are appended to it.
+    if (!resuming) {
+      DeleteFile(log_file.c_str());
+    }
 
-    Logger::Initialize(log_file, true);
+    Logger::Initialize(log_file, !resuming);
+    if (resuming) {
+      Logger::Log() << "WATCHDOG: Resuming after hung test " << checkpoint.GetHungTests().back() << std::endl;
+    }
+  }
+
+  TimingHistory history(config.output_directory_path() + "\\" + kTimingHistoryFileName);
+  history.Load();
+
+  TestWatchdog::SteadyClock clock;
+  TestWatchdog watchdog(clock, config.watchdog_budget_milliseconds(), &history,
+                        [&checkpoint](const std::string& test_name, uint32_t budget_milliseconds) {
+                          PrintMsg("Watchdog: %s did not complete within %u ms, rebooting\n", test_name.c_str(),
+                                   budget_milliseconds);
+                          if (Logger::IsInitialized()) {
+                            Logger::Log() << "WATCHDOG: " << test_name << " did not complete within "
+                                          << budget_milliseconds << " ms" << std::endl;
+                          }
+                          checkpoint.RecordHang(test_name);
+                          HalReturnToFirmware(HalRebootRoutine);
+                        });
+  if (watchdog.IsEnabled()) {
+    TestWatchdog::SetActive(&watchdog);
+    watchdog.Start(kWatchdogPollIntervalMilliseconds);
   }
 
   TestDriver driver(host, test_suites, kFramebufferWidth, kFramebufferHeight, false, config.disable_autorun(),
                     config.enable_autorun_immediately());
+  driver.SetDeterminismCheckIterations(config.determinism_check_iterations());
   driver.Run();
 
+  watchdog.Stop();
+  TestWatchdog::SetActive(nullptr);
+  checkpoint.Clear();
+
   PrintMsg("Test loop completed normally\n");
   if (config.enable_progress_log() && Logger::Log().is_open()) {
     Logger::Log() << "Testing completed normally, closing log." << std::endl;
@@ -428,128 +425,3 @@ static void Shutdown() {
     Sleep(30000);
   }
 }
-
-static void RegisterSuites(TestHost& host, RuntimeConfig& runtime_config,
-                           std::vector<std::shared_ptr<TestSuite>>& test_suites, const std::string& output_directory,
-                           std::shared_ptr<FTPLogger> ftp_logger) {
-  auto config = TestSuite::Config{runtime_config.enable_progress_log(), runtime_config.enable_pgraph_region_diff(),
-                                  runtime_config.delay_milliseconds_between_tests(), std::move(ftp_logger)};
-
-#define REG_TEST(CLASS_NAME)                                                   \
-  {                                                                            \
-    auto suite = std::make_shared<CLASS_NAME>(host, output_directory, config); \
-    test_suites.push_back(suite);                                              \
-  }
-
-  // LightingNormalTests must be the first suite run for valid results. The first test in the suite depends on having a
-  // clean initial state.
-  REG_TEST(LightingNormalTests)
-
-  // Remaining tests should be alphabetized.
-  // -- Begin REG_TEST --
-
-  REG_TEST(AlphaFuncTests)
-  REG_TEST(AntialiasingTests)
-  REG_TEST(AttributeCarryoverTests)
-  REG_TEST(AttributeExplicitSetterTests)
-  REG_TEST(AttributeFloatTests)
-  REG_TEST(BlendSurfaceTests)
-  REG_TEST(BlendTests)
-  REG_TEST(BumpEnvLumTests)
-  REG_TEST(BumpMapTests)
-  REG_TEST(ClearTests)
-  REG_TEST(ClippingPrecisionTests)
-  REG_TEST(ColorKeyTests)
-  REG_TEST(ColorMaskBlendTests)
-  REG_TEST(ColorZetaDisableTests)
-  REG_TEST(ColorZetaOverlapTests)
-  REG_TEST(CombinerTests)
-  REG_TEST(ContextSwitchTests)
-  REG_TEST(DegenerateBeginEndTests)
-  REG_TEST(DepthClampTests)
-  REG_TEST(DepthFormatFixedFunctionTests)
-  REG_TEST(DepthFormatTests)
-  REG_TEST(DepthFunctionTests)
-  REG_TEST(DMACorruptionAroundSurfaceTests)
-  REG_TEST(EdgeFlagTests)
-  REG_TEST(FogCarryoverTests)
-  REG_TEST(FogCustomShaderTests)
-  REG_TEST(FogExceptionalValueTests)
-  REG_TEST(FogGenTests)
-  REG_TEST(FogInfiniteFogCoordinateTests)
-  REG_TEST(FogParamTests)
-  REG_TEST(FogTests)
-  REG_TEST(FogVec4CoordTests)
-  REG_TEST(FrontFaceTests)
-  REG_TEST(HighVertexCountTests)
-  REG_TEST(ImageBlitTests)
-  REG_TEST(InlineArraySizeMismatchTests)
-  REG_TEST(LightingAccumulationTests)
-  REG_TEST(LightingControlTests)
-  REG_TEST(LightingRangeTests)
-  REG_TEST(LightingSpotlightTests)
-  REG_TEST(LightingTwoSidedTests)
-  REG_TEST(LineWidthTests)
-  REG_TEST(MaterialAlphaTests)
-  REG_TEST(MaterialColorSourceTests)
-  REG_TEST(MaterialColorTests)
-  REG_TEST(NullSurfaceTests)
-  REG_TEST(OverlappingDrawModesTests)
-  REG_TEST(PixelShaderTests)
-  REG_TEST(PointParamsTests)
-  REG_TEST(PointSizeTests)
-  REG_TEST(PointSpriteTests)
-  REG_TEST(PvideoTests)
-  REG_TEST(SetVertexDataTests)
-  REG_TEST(ShadeModelTests)
-  REG_TEST(SmoothingTests)
-  REG_TEST(SpecularBackTests)
-  REG_TEST(SpecularTests)
-  REG_TEST(StencilFuncTests)
-  REG_TEST(StencilTests)
-  REG_TEST(StippleTests)
-  REG_TEST(SurfaceClipTests)
-  REG_TEST(SurfaceFormatTests)
-  REG_TEST(SurfacePitchTests)
-  REG_TEST(SwathWidthTests)
-  REG_TEST(TexgenMatrixTests)
-  REG_TEST(TexgenTests)
-  REG_TEST(Texture2DAsCubemapTests)
-  REG_TEST(Texture3DAs2DTests)
-  REG_TEST(TextureAnisotropyTests)
-  REG_TEST(TextureBorderColorTests)
-  REG_TEST(TextureBorderTests)
-  REG_TEST(TextureBRDFTests)
-  REG_TEST(TextureCPUUpdateTests)
-  REG_TEST(TextureCubemapTests)
-  REG_TEST(TextureFormatDXTTests)
-  REG_TEST(TextureFormatTests)
-  REG_TEST(TextureFramebufferBlitTests)
-  REG_TEST(TextureLodBiasTests)
-  REG_TEST(TextureMatrixTests)
-  REG_TEST(TexturePaletteTests)
-  REG_TEST(TexturePerspectiveEnableTests)
-  REG_TEST(TexturePerspectiveTests)
-  REG_TEST(TextureRenderTargetTests)
-  REG_TEST(TextureRenderUpdateInPlaceTests)
-  REG_TEST(TextureShadowComparatorTests)
-  REG_TEST(TextureSignedComponentTests)
-  REG_TEST(TextureWrapModeTests)
-  REG_TEST(ThreeDPrimitiveTests)
-  REG_TEST(TwoDLineTests)
-  REG_TEST(VertexShaderIndependenceTests)
-  REG_TEST(VertexShaderRoundingTests)
-  REG_TEST(VertexShaderSwizzleTests)
-  REG_TEST(ViewportTests)
-  REG_TEST(VolumeTextureTests)
-  REG_TEST(WBufTests)
-  REG_TEST(WeightSetterTests)
-  REG_TEST(WindowClipTests)
-  REG_TEST(WParamTests)
-  REG_TEST(ZeroStrideTests)
-  REG_TEST(ZMinMaxControlTests)
-  REG_TEST(ZPassPixelCountTests)
-  // -- End REG_TEST --
-
-#undef REG_TEST
-}
@@ -2,7 +2,6 @@
 
 #include <pbkit/pbkit.h>
 
-#include <chrono>
 #include <memory>
 #include <utility>
 
@@ -53,18 +52,7 @@ void MenuItem::Draw() {
   const char *cursor_suffix = " <";
   const char *normal_suffix = "";
 
-  uint32_t i = 0;
-  if (cursor_position > kNumItemsPerHalfPage) {
-    i = cursor_position - kNumItemsPerHalfPage;
-    if (i + kNumItemsPerPage > submenu.size()) {
-      if (submenu.size() < kNumItemsPerPage) {
-        i = 0;
-      } else {
-        i = submenu.size() - kNumItemsPerPage;
-      }
-    }
-  }
-
+  uint32_t i = MenuCursor::GetFirstVisible(cursor_position, submenu.size(), kNumItemsPerPage);
   if (i) {
     pb_print("...\n");
   }
@@ -84,6 +72,13 @@ void MenuItem::Draw() {
   Swap();
 }
 
+MenuClock::time_point MenuItem::GetNextRedraw(MenuClock::time_point now) const {
+  if (active_submenu) {
+    return active_submenu->GetNextRedraw(now);
+  }
+  return kMenuNeverRedraw;
+}
+
 void MenuItem::OnEnter() {}
 
 void MenuItem::Activate() {
@@ -128,11 +123,7 @@ void MenuItem::CursorUp(bool is_repeat) {
     return;
   }
 
-  if (cursor_position > 0) {
-    --cursor_position;
-  } else {
-    cursor_position = submenu.size() - 1;
-  }
+  cursor_position = MenuCursor::Previous(cursor_position, submenu.size());
 }
 
 void MenuItem::CursorDown(bool is_repeat) {
@@ -141,11 +132,7 @@ void MenuItem::CursorDown(bool is_repeat) {
     return;
   }
 
-  if (cursor_position < submenu.size() - 1) {
-    ++cursor_position;
-  } else {
-    cursor_position = 0;
-  }
+  cursor_position = MenuCursor::Next(cursor_position, submenu.size());
 }
 
 void MenuItem::CursorLeft(bool is_repeat) {
@@ -154,11 +141,7 @@ void MenuItem::CursorLeft(bool is_repeat) {
     return;
   }
 
-  if (cursor_position > kNumItemsPerHalfPage) {
-    cursor_position -= kNumItemsPerHalfPage;
-  } else {
-    cursor_position = 0;
-  }
+  cursor_position = MenuCursor::PageBack(cursor_position, kNumItemsPerHalfPage);
 }
 
 void MenuItem::CursorRight(bool is_repeat) {
@@ -167,10 +150,7 @@ void MenuItem::CursorRight(bool is_repeat) {
     return;
   }
 
-  cursor_position += kNumItemsPerHalfPage;
-  if (cursor_position >= submenu.size()) {
-    cursor_position = submenu.size() - 1;
-  }
+  cursor_position = MenuCursor::PageForward(cursor_position, kNumItemsPerHalfPage, submenu.size());
 }
 
 void MenuItem::CursorUpAndActivate() {
@@ -200,13 +180,17 @@ MenuItemTest::MenuItemTest(std::shared_ptr<TestSuite> suite, std::string name, u
     : MenuItem(std::move(name), width, height), suite(std::move(suite)) {}
 
 void MenuItemTest::Draw() {
-  if (one_shot_mode_ && has_run_once_) {
+  if (!view_state_.ShouldRender(one_shot_mode_)) {
     return;
   }
 
   suite->Run(name);
   suite->SetSavingAllowed(false);
-  has_run_once_ = true;
+  view_state_.OnRendered();
+}
+
+MenuClock::time_point MenuItemTest::GetNextRedraw(MenuClock::time_point now) const {
+  return view_state_.ShouldRender(one_shot_mode_) ? now : kMenuNeverRedraw;
 }
 
 void MenuItemTest::OnEnter() {
@@ -215,17 +199,18 @@ void MenuItemTest::OnEnter() {
   pb_print("Running %s", name.c_str());
   Swap();
 
-  if (has_run_once_) {
+  if (view_state_.Enter()) {
     suite->Deinitialize();
+    suite->ReportAllocations();
   }
   suite->Initialize();
   suite->SetSavingAllowed(true);
-  has_run_once_ = false;
 }
 
 bool MenuItemTest::Deactivate() {
   suite->Deinitialize();
-  has_run_once_ = false;
+  suite->ReportAllocations();
+  view_state_.Leave();
   return MenuItem::Deactivate();
 }
 
@@ -258,6 +243,7 @@ void MenuItemSuite::ActivateCurrentSuite() {
   suite->SetSavingAllowed(true);
   suite->RunAll(false);
   suite->Deinitialize();
+  suite->ReportAllocations();
   MenuItem::Deactivate();
 }
 
@@ -267,6 +253,7 @@ MenuItemRoot::MenuItemRoot(const std::vector<std::shared_ptr<TestSuite>> &suites
     : MenuItem("<<root>>", width, height),
       on_run_all(std::move(on_run_all)),
       on_exit(std::move(on_exit)),
+      countdown(kAutoTestAllTimeoutMilliseconds),
       disable_autorun_(disable_autorun),
       autorun_immediately_(autorun_immediately) {
   if (!disable_autorun) {
@@ -285,28 +272,23 @@ MenuItemRoot::MenuItemRoot(const std::vector<std::shared_ptr<TestSuite>> &suites
 }
 
 void MenuItemRoot::ActivateCurrentSuite() {
-  timer_cancelled = true;
+  countdown.Cancel();
   MenuItem::ActivateCurrentSuite();
 }
 
 void MenuItemRoot::Draw() {
-  if (!timer_valid) {
-    start_time = std::chrono::steady_clock::now();
-    timer_valid = true;
-  }
+  auto now = MenuClock::now();
+  countdown.Start(now);
 
   if (!disable_autorun_) {
-    if (!timer_cancelled) {
-      auto now = std::chrono::steady_clock::now();
-      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time).count();
-
-      if (autorun_immediately_ || elapsed > kAutoTestAllTimeoutMilliseconds) {
+    if (!countdown.IsCancelled()) {
+      if (autorun_immediately_ || countdown.IsExpired(now)) {
         on_run_all();
         return;
       }
 
       char run_all[128] = {0};
-      snprintf(run_all, 127, "Run all and exit (automatic in %d ms)", kAutoTestAllTimeoutMilliseconds - elapsed);
+      snprintf(run_all, 127, "Run all and exit (automatic in %u ms)", countdown.GetDisplayedMilliseconds(now));
       submenu[0]->name = run_all;
     } else {
       submenu[0]->name = "Run all and exit";
@@ -316,13 +298,20 @@ void MenuItemRoot::Draw() {
   MenuItem::Draw();
 }
 
+MenuClock::time_point MenuItemRoot::GetNextRedraw(MenuClock::time_point now) const {
+  if (active_submenu) {
+    return active_submenu->GetNextRedraw(now);
+  }
+  return disable_autorun_ ? kMenuNeverRedraw : countdown.GetNextUpdate(now);
+}
+
 void MenuItemRoot::Activate() {
-  timer_cancelled = true;
+  countdown.Cancel();
   MenuItem::Activate();
 }
 
 bool MenuItemRoot::Deactivate() {
-  timer_cancelled = true;
+  countdown.Cancel();
   if (!active_submenu) {
     on_exit();
     return false;
@@ -332,22 +321,22 @@ bool MenuItemRoot::Deactivate() {
 }
 
 void MenuItemRoot::CursorUp(bool is_repeat) {
-  timer_cancelled = true;
+  countdown.Cancel();
   MenuItem::CursorUp(is_repeat);
 }
 
 void MenuItemRoot::CursorDown(bool is_repeat) {
-  timer_cancelled = true;
+  countdown.Cancel();
   MenuItem::CursorDown(is_repeat);
 }
 
 void MenuItemRoot::CursorLeft(bool is_repeat) {
-  timer_cancelled = true;
+  countdown.Cancel();
   MenuItem::CursorLeft(is_repeat);
 }
 
 void MenuItemRoot::CursorRight(bool is_repeat) {
-  timer_cancelled = true;
+  countdown.Cancel();
   MenuItem::CursorRight(is_repeat);
 }
 
@@ -393,27 +382,25 @@ void MenuItemOption::CursorRight(bool is_repeat) { Activate(); }
 
 MenuItemOptions::MenuItemOptions(const std::vector<std::shared_ptr<TestSuite>> &suites, std::function<void()> on_exit,
                                  uint32_t width, uint32_t height)
-    : MenuItem("<<options>>", width, height), on_exit(std::move(on_exit)) {
+    : MenuItem("<<options>>", width, height),
+      on_exit(std::move(on_exit)),
+      countdown(kAutoTestAllTimeoutMilliseconds) {
   submenu.push_back(
       std::make_shared<MenuItemOption>("Accept", [this](const MenuItemOption &_ignored) { this->on_exit(); }));
 }
 
 void MenuItemOptions::Draw() {
-  if (!timer_valid) {
-    start_time = std::chrono::steady_clock::now();
-    timer_valid = true;
-  }
-  if (!timer_cancelled) {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time).count();
-    if (elapsed > kAutoTestAllTimeoutMilliseconds) {
+  auto now = MenuClock::now();
+  countdown.Start(now);
+  if (!countdown.IsCancelled()) {
+    if (countdown.IsExpired(now)) {
       cursor_position = 0;
       Activate();
       return;
     }
 
     char run_all[128] = {0};
-    snprintf(run_all, 127, "Accept (automatic in %d ms)", kAutoTestAllTimeoutMilliseconds - elapsed);
+    snprintf(run_all, 127, "Accept (automatic in %u ms)", countdown.GetDisplayedMilliseconds(now));
     submenu[0]->name = run_all;
   } else {
     submenu[0]->name = "Accept";
@@ -422,8 +409,15 @@ void MenuItemOptions::Draw() {
   MenuItem::Draw();
 }
 
+MenuClock::time_point MenuItemOptions::GetNextRedraw(MenuClock::time_point now) const {
+  if (active_submenu) {
+    return active_submenu->GetNextRedraw(now);
+  }
+  return countdown.GetNextUpdate(now);
+}
+
 void MenuItemOptions::Activate() {
-  timer_cancelled = true;
+  countdown.Cancel();
   if (cursor_position == 0) {
     for (auto i = 1; i < submenu.size(); ++i) {
       const auto &item = *(reinterpret_cast<MenuItemOption *>(submenu[i].get()));
@@ -435,35 +429,35 @@ void MenuItemOptions::Activate() {
   MenuItem::Activate();
 }
 void MenuItemOptions::ActivateCurrentSuite() {
-  timer_cancelled = true;
+  countdown.Cancel();
   MenuItem::ActivateCurrentSuite();
 }
 
 bool MenuItemOptions::Deactivate() {
-  timer_cancelled = true;
+  countdown.Cancel();
   on_exit();
   return false;
 }
 
 void MenuItemOptions::CursorUp(bool is_repeat) {
-  timer_cancelled = true;
+  countdown.Cancel();
   MenuItem::CursorUp(is_repeat);
 }
 
 void MenuItemOptions::CursorDown(bool is_repeat) {
-  timer_cancelled = true;
+  countdown.Cancel();
   MenuItem::CursorDown(is_repeat);
 }
 
 void MenuItemOptions::CursorLeft(bool is_repeat) {
-  timer_cancelled = true;
+  countdown.Cancel();
   if (cursor_position > 0) {
     submenu[cursor_position]->CursorLeft(is_repeat);
   }
 }
 
 void MenuItemOptions::CursorRight(bool is_repeat) {
-  timer_cancelled = true;
+  countdown.Cancel();
   if (cursor_position > 0) {
     submenu[cursor_position]->CursorRight(is_repeat);
   }
@@ -1,13 +1,14 @@
 #ifndef NXDK_PGRAPH_TESTS_MENU_ITEM_H
 #define NXDK_PGRAPH_TESTS_MENU_ITEM_H
 
-#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "menu_state.h"
+
 class TestSuite;
 
 struct MenuItem {
@@ -22,6 +23,10 @@ struct MenuItem {
 
   virtual void Draw();
 
+  // Returns the time at which this MenuItem must next be drawn in the absence of input, kMenuNeverRedraw if it only
+  // changes in response to input.
+  [[nodiscard]] virtual MenuClock::time_point GetNextRedraw(MenuClock::time_point now) const;
+
   // Invoked when this MenuItem becomes the active drawable.
   virtual void OnEnter();
 
@@ -77,6 +82,7 @@ struct MenuItemTest : public MenuItem {
   [[nodiscard]] bool IsEnterable() const override { return true; }
 
   void Draw() override;
+  [[nodiscard]] MenuClock::time_point GetNextRedraw(MenuClock::time_point now) const override;
   void OnEnter() override;
   void Activate() override { OnEnter(); }
   bool Deactivate() override;
@@ -87,7 +93,7 @@ struct MenuItemTest : public MenuItem {
   void CursorRight(bool is_repeat) override {}
 
   std::shared_ptr<TestSuite> suite;
-  bool has_run_once_{false};
+  TestViewState view_state_;
 };
 
 struct MenuItemSuite : public MenuItem {
@@ -103,6 +109,7 @@ struct MenuItemRoot : public MenuItem {
                         bool autorun_immediately);
 
   void Draw() override;
+  [[nodiscard]] MenuClock::time_point GetNextRedraw(MenuClock::time_point now) const override;
   void Activate() override;
   void ActivateCurrentSuite() override;
   bool Deactivate() override;
@@ -113,9 +120,7 @@ struct MenuItemRoot : public MenuItem {
 
   std::function<void()> on_run_all;
   std::function<void()> on_exit;
-  std::chrono::steady_clock::time_point start_time;
-  bool timer_valid{false};
-  bool timer_cancelled{false};
+  AutorunCountdown countdown;
 
  private:
   bool disable_autorun_;
@@ -127,6 +132,7 @@ struct MenuItemOptions : public MenuItem {
                   uint32_t height);
 
   void Draw() override;
+  [[nodiscard]] MenuClock::time_point GetNextRedraw(MenuClock::time_point now) const override;
   void Activate() override;
   void ActivateCurrentSuite() override;
   bool Deactivate() override;
@@ -136,9 +142,7 @@ struct MenuItemOptions : public MenuItem {
   void CursorRight(bool is_repeat) override;
 
   std::function<void()> on_exit;
-  std::chrono::steady_clock::time_point start_time;
-  bool timer_valid{false};
-  bool timer_cancelled{false};
+  AutorunCountdown countdown;
 };
 
 #endif  // NXDK_PGRAPH_TESTS_MENU_ITEM_H
@@ -0,0 +1,103 @@
+#include "menu_state.h"
+
+#include <algorithm>
+
+uint32_t MenuCursor::Previous(uint32_t position, uint32_t count) {
+  if (!count) {
+    return 0;
+  }
+  return position > 0 ? position - 1 : count - 1;
+}
+
+uint32_t MenuCursor::Next(uint32_t position, uint32_t count) { return position + 1 < count ? position + 1 : 0; }
+
+uint32_t MenuCursor::PageBack(uint32_t position, uint32_t step) { return position > step ? position - step : 0; }
+
+uint32_t MenuCursor::PageForward(uint32_t position, uint32_t step, uint32_t count) {
+  if (!count) {
+    return 0;
+  }
+  return std::min(position + step, count - 1);
+}
+
+uint32_t MenuCursor::GetFirstVisible(uint32_t position, uint32_t count, uint32_t page_size) {
+  // Keep the cursor in the middle of the page where possible.
+  auto half_page = page_size >> 1;
+  if (position <= half_page) {
+    return 0;
+  }
+
+  auto ret = position - half_page;
+  if (ret + page_size > count) {
+    ret = count < page_size ? 0 : count - page_size;
+  }
+  return ret;
+}
+
+void AutorunCountdown::Start(MenuClock::time_point now) {
+  if (started_) {
+    return;
+  }
+  start_time_ = now;
+  started_ = true;
+}
+
+uint32_t AutorunCountdown::GetElapsedMilliseconds(MenuClock::time_point now) const {
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time_).count();
+  return static_cast<uint32_t>(std::clamp<int64_t>(elapsed, 0, duration_milliseconds_));
+}
+
+bool AutorunCountdown::IsExpired(MenuClock::time_point now) const {
+  return IsActive() && GetElapsedMilliseconds(now) >= duration_milliseconds_;
+}
+
+uint32_t AutorunCountdown::GetDisplayedMilliseconds(MenuClock::time_point now) const {
+  auto remaining = duration_milliseconds_ - (started_ ? GetElapsedMilliseconds(now) : 0);
+  if (!update_interval_milliseconds_) {
+    return remaining;
+  }
+  return (remaining + update_interval_milliseconds_ - 1) / update_interval_milliseconds_ *
+         update_interval_milliseconds_;
+}
+
+MenuClock::time_point AutorunCountdown::GetNextUpdate(MenuClock::time_point now) const {
+  if (!IsActive()) {
+    return kMenuNeverRedraw;
+  }
+
+  // The displayed value drops by one interval when the remaining time reaches the next lower multiple; the last step
+  // coincides with expiry.
+  auto displayed = GetDisplayedMilliseconds(now);
+  auto step = std::min(update_interval_milliseconds_, displayed);
+  return start_time_ + std::chrono::milliseconds(duration_milliseconds_ - displayed + step);
+}
+
+bool TestViewState::Enter() {
+  bool ret = has_run_once_;
+  has_run_once_ = false;
+  return ret;
+}
+
+uint32_t MenuRedrawScheduler::GetWaitMilliseconds(MenuClock::time_point now, MenuClock::time_point wake_time) const {
+  wake_time = std::min(wake_time, next_redraw_);
+  if (dirty_ || wake_time <= now) {
+    return 0;
+  }
+  if (wake_time == kMenuNeverRedraw) {
+    return max_wait_milliseconds_;
+  }
+
+  // Round up so that the loop does not wake a fraction of a millisecond early and spin until the deadline.
+  auto remaining = std::chrono::ceil<std::chrono::milliseconds>(wake_time - now).count();
+  return static_cast<uint32_t>(std::min<int64_t>(remaining, max_wait_milliseconds_));
+}
+
+bool MenuRedrawScheduler::ConsumeRedraw(MenuClock::time_point now) {
+  if (!dirty_ && next_redraw_ > now) {
+    return false;
+  }
+  dirty_ = false;
+  next_redraw_ = kMenuNeverRedraw;
+  ++num_redraws_;
+  return true;
+}
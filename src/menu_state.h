@@ -0,0 +1,128 @@
+#ifndef NXDK_PGRAPH_TESTS_MENU_STATE_H
+#define NXDK_PGRAPH_TESTS_MENU_STATE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Rendering independent portions of the interactive menu, kept separate from MenuItem so that they can be exercised on
+ * the host with synthetic input and a synthetic clock.
+ */
+
+using MenuClock = std::chrono::steady_clock;
+
+//! Returned by MenuItem::GetNextRedraw when nothing will change until the user provides input.
+constexpr MenuClock::time_point kMenuNeverRedraw = MenuClock::time_point::max();
+
+//! Cursor movement within a list of `count` menu entries.
+struct MenuCursor {
+  //! Moves up one entry, wrapping to the last entry.
+  static uint32_t Previous(uint32_t position, uint32_t count);
+  //! Moves down one entry, wrapping to the first entry.
+  static uint32_t Next(uint32_t position, uint32_t count);
+  //! Moves up by `step` entries, stopping at the first entry.
+  static uint32_t PageBack(uint32_t position, uint32_t step);
+  //! Moves down by `step` entries, stopping at the last entry.
+  static uint32_t PageForward(uint32_t position, uint32_t step, uint32_t count);
+
+  //! Returns the index of the first entry to display such that `position` is visible on a page of `page_size` entries.
+  static uint32_t GetFirstVisible(uint32_t position, uint32_t count, uint32_t page_size);
+};
+
+/**
+ * Counts down to an automatic action, such as running all tests, that is abandoned as soon as the user interacts with
+ * the menu.
+ *
+ * The remaining time is displayed in steps of `update_interval_milliseconds` so that the menu only needs to be redrawn
+ * when the displayed value changes.
+ */
+class AutorunCountdown {
+ public:
+  explicit AutorunCountdown(uint32_t duration_milliseconds, uint32_t update_interval_milliseconds = 100)
+      : duration_milliseconds_(duration_milliseconds), update_interval_milliseconds_(update_interval_milliseconds) {}
+
+  //! Begins the countdown. Has no effect if it has already been started.
+  void Start(MenuClock::time_point now);
+  void Cancel() { cancelled_ = true; }
+
+  [[nodiscard]] bool IsCancelled() const { return cancelled_; }
+  [[nodiscard]] bool IsActive() const { return started_ && !cancelled_; }
+  [[nodiscard]] bool IsExpired(MenuClock::time_point now) const;
+
+  //! Returns the remaining time rounded up to the update interval.
+  [[nodiscard]] uint32_t GetDisplayedMilliseconds(MenuClock::time_point now) const;
+
+  //! Returns the time at which the displayed value next changes (or the countdown expires), or kMenuNeverRedraw.
+  [[nodiscard]] MenuClock::time_point GetNextUpdate(MenuClock::time_point now) const;
+
+ private:
+  [[nodiscard]] uint32_t GetElapsedMilliseconds(MenuClock::time_point now) const;
+
+ private:
+  uint32_t duration_milliseconds_;
+  uint32_t update_interval_milliseconds_;
+  MenuClock::time_point start_time_;
+  bool started_{false};
+  bool cancelled_{false};
+};
+
+/**
+ * Tracks whether a test opened from the menu should be rendered again.
+ *
+ * In one shot mode a test is rendered once each time it is entered so that its artifacts are saved exactly once;
+ * otherwise it is rendered continuously.
+ */
+class TestViewState {
+ public:
+  //! Resets the state when the test is entered. Returns true if a previous run must be torn down first.
+  bool Enter();
+  void Leave() { has_run_once_ = false; }
+
+  [[nodiscard]] bool ShouldRender(bool one_shot_mode) const { return !one_shot_mode || !has_run_once_; }
+  void OnRendered() { has_run_once_ = true; }
+
+  [[nodiscard]] bool HasRunOnce() const { return has_run_once_; }
+
+ private:
+  bool has_run_once_{false};
+};
+
+/**
+ * Decides when the menu must be redrawn and how long the input loop may block in the meantime.
+ *
+ * The menu is redrawn when it has been invalidated (by input or a change of active menu) or when the deadline scheduled
+ * after the previous draw has been reached, rather than on every iteration of the input loop. The deadline is captured
+ * right after drawing because a menu's GetNextRedraw moves on to the following update once the current one is due.
+ */
+class MenuRedrawScheduler {
+ public:
+  //! `max_wait_milliseconds` bounds how long the input loop blocks even when no redraw is pending.
+  explicit MenuRedrawScheduler(uint32_t max_wait_milliseconds) : max_wait_milliseconds_(max_wait_milliseconds) {}
+
+  //! Forces a redraw on the next call to ConsumeRedraw.
+  void Invalidate() { dirty_ = true; }
+  [[nodiscard]] bool IsDirty() const { return dirty_; }
+
+  //! Requests a redraw at `time`, typically the value of MenuItem::GetNextRedraw immediately after drawing.
+  void ScheduleRedraw(MenuClock::time_point time) { next_redraw_ = std::min(next_redraw_, time); }
+
+  //! Returns how long the input loop may wait for events before a redraw is due or something else needs attention at
+  //! `wake_time`.
+  [[nodiscard]] uint32_t GetWaitMilliseconds(MenuClock::time_point now,
+                                             MenuClock::time_point wake_time = kMenuNeverRedraw) const;
+
+  //! Returns true if the menu should be drawn now, clearing the dirty flag and the scheduled redraw.
+  bool ConsumeRedraw(MenuClock::time_point now);
+
+  [[nodiscard]] uint32_t GetNumRedraws() const { return num_redraws_; }
+
+ private:
+  uint32_t max_wait_milliseconds_;
+  // The menu has never been drawn, so the first call to ConsumeRedraw always draws.
+  bool dirty_{true};
+  MenuClock::time_point next_redraw_{kMenuNeverRedraw};
+  uint32_t num_redraws_{0};
+};
+
+#endif  // NXDK_PGRAPH_TESTS_MENU_STATE_H
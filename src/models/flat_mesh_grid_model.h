@@ -14,27 +14,11 @@ class FlatMeshGridModel : public PBKitPlusPlus::SolidColorModelBuilder {
 
   [[nodiscard]] uint32_t GetVertexCount() const override;
 
+  [[nodiscard]] static const char *GetMeshFilePath();
+
  protected:
   [[nodiscard]] const float *GetVertexPositions() override;
   [[nodiscard]] const float *GetVertexNormals() override;
-  void ReleaseData() override {
-    if (vertices_) {
-      delete[] vertices_;
-      vertices_ = nullptr;
-    }
-    if (normals_) {
-      delete[] normals_;
-      normals_ = nullptr;
-    }
-    if (texcoords_) {
-      delete[] texcoords_;
-      texcoords_ = nullptr;
-    }
-  }
-
-  float *vertices_{nullptr};
-  float *normals_{nullptr};
-  float *texcoords_{nullptr};
 };
 
 #endif  // _FLAT_MESH_GRID_MODEL_H_
@@ -0,0 +1,172 @@
+#include "mesh_file.h"
+
+#include <cstdio>
+#include <unordered_map>
+
+#include "resource_prefetcher.h"
+
+static std::unordered_map<std::string, std::shared_ptr<const MeshFile>> cache;
+
+static bool ValidateBlock(const char *name, uint32_t offset, uint32_t length, uint32_t size, std::string &error) {
+  if (offset % MeshFile::kBlockAlignment) {
+    error = std::string(name) + " block is misaligned";
+    return false;
+  }
+  if (offset < sizeof(MeshFile::Header) || offset > size || length > size - offset) {
+    error = std::string(name) + " block lies outside of the file";
+    return false;
+  }
+  return true;
+}
+
+bool MeshFile::Parse(std::vector<uint32_t> &&image, uint32_t size, std::string &error) {
+  if (size < sizeof(Header) || image.size() * sizeof(uint32_t) < size) {
+    error = "File is too small to hold a mesh header";
+    return false;
+  }
+
+  const auto &header = *reinterpret_cast<const Header *>(image.data());
+  if (header.magic != kMagic) {
+    error = "Not a mesh container (bad magic)";
+    return false;
+  }
+  if (header.version != kVersion) {
+    error = "Unsupported mesh container version " + std::to_string(header.version);
+    return false;
+  }
+  if (header.header_size != sizeof(Header)) {
+    error = "Unexpected header size " + std::to_string(header.header_size);
+    return false;
+  }
+  if (header.file_size != size) {
+    error = "File size " + std::to_string(size) + " does not match header " + std::to_string(header.file_size);
+    return false;
+  }
+
+  static constexpr const char *kAttributeNames[ATTR_MAX] = {"Position", "Normal", "Texcoord"};
+  static constexpr uint32_t kMaxComponents = 4;
+  const auto num_vertices = static_cast<uint64_t>(header.num_vertices);
+
+  uint32_t interleaved_components = 0;
+  for (uint32_t i = 0; i < ATTR_MAX; ++i) {
+    const auto &block = header.attributes[i];
+    if (block.components > kMaxComponents) {
+      error = std::string(kAttributeNames[i]) + " block has " + std::to_string(block.components) + " components";
+      return false;
+    }
+    interleaved_components += block.components;
+    if (!block.offset) {
+      continue;
+    }
+
+    uint64_t length = num_vertices * block.components * sizeof(float);
+    if (!block.components || length > size) {
+      error = std::string(kAttributeNames[i]) + " block has an invalid length";
+      return false;
+    }
+    if (!ValidateBlock(kAttributeNames[i], block.offset, static_cast<uint32_t>(length), size, error)) {
+      return false;
+    }
+  }
+
+  if (header.interleaved_offset) {
+    if (header.interleaved_stride < interleaved_components * sizeof(float) || header.interleaved_stride % 4) {
+      error = "Interleaved stride " + std::to_string(header.interleaved_stride) + " is invalid";
+      return false;
+    }
+    uint64_t length = num_vertices * header.interleaved_stride;
+    if (length > size) {
+      error = "Interleaved block has an invalid length";
+      return false;
+    }
+    if (!ValidateBlock("Interleaved", header.interleaved_offset, static_cast<uint32_t>(length), size, error)) {
+      return false;
+    }
+  }
+
+  image_ = std::move(image);
+  return true;
+}
+
+std::shared_ptr<const MeshFile> MeshFile::Load(const std::string &path, std::string &error) {
+  ResourcePrefetcher::Resource prefetched;
+  auto prefetcher = ResourcePrefetcher::Active();
+  if (prefetcher && prefetcher->Take(path, prefetched)) {
+    auto ret = std::make_shared<MeshFile>();
+    if (!ret->Parse(std::move(prefetched.storage), prefetched.size, error)) {
+      error = path + ": " + error;
+      return nullptr;
+    }
+    return ret;
+  }
+
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (!fp) {
+    error = "Failed to open " + path;
+    return nullptr;
+  }
+
+  long size = -1;
+  if (!fseek(fp, 0, SEEK_END)) {
+    size = ftell(fp);
+  }
+  if (size < 0 || fseek(fp, 0, SEEK_SET)) {
+    fclose(fp);
+    error = "Failed to determine the size of " + path;
+    return nullptr;
+  }
+
+  std::vector<uint32_t> image((static_cast<size_t>(size) + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+  size_t bytes_read = size ? fread(image.data(), 1, size, fp) : 0;
+  fclose(fp);
+  if (bytes_read != static_cast<size_t>(size)) {
+    error = "Failed to read " + path;
+    return nullptr;
+  }
+
+  auto ret = std::make_shared<MeshFile>();
+  if (!ret->Parse(std::move(image), static_cast<uint32_t>(size), error)) {
+    error = path + ": " + error;
+    return nullptr;
+  }
+  return ret;
+}
+
+std::shared_ptr<const MeshFile> MeshFile::LoadCached(const std::string &path, std::string &error) {
+  auto it = cache.find(path);
+  if (it != cache.end()) {
+    return it->second;
+  }
+
+  auto ret = Load(path, error);
+  if (ret) {
+    cache.emplace(path, ret);
+  }
+  return ret;
+}
+
+std::vector<std::string> MeshFile::UncachedPaths(const std::vector<std::string> &paths) {
+  std::vector<std::string> ret;
+  for (const auto &path : paths) {
+    if (cache.find(path) == cache.end()) {
+      ret.push_back(path);
+    }
+  }
+  return ret;
+}
+
+void MeshFile::ClearCache() { cache.clear(); }
+
+const float *MeshFile::GetAttribute(Attribute attribute) const {
+  auto offset = header().attributes[attribute].offset;
+  return offset ? At(offset) : nullptr;
+}
+
+const float *MeshFile::GetInterleaved(uint32_t &stride) const {
+  if (!header().interleaved_offset) {
+    stride = 0;
+    return nullptr;
+  }
+  stride = header().interleaved_stride;
+  return At(header().interleaved_offset);
+}
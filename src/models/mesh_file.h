@@ -0,0 +1,98 @@
+#ifndef NXDK_PGRAPH_TESTS_MODELS_MESH_FILE_H
+#define NXDK_PGRAPH_TESTS_MODELS_MESH_FILE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Versioned container for the vertex data of a generated model, as written by collada_converter.py.
+ *
+ * The file begins with a fixed size Header giving the vertex count and the location of each attribute block. Blocks
+ * are little endian float arrays that start on kBlockAlignment boundaries, so the whole file can be read with a single
+ * bulk read and the attribute pointers handed out directly without any per-attribute copying.
+ *
+ * Loaded meshes are kept in a process wide cache keyed by path so that every suite that draws the same model shares a
+ * single copy. The cache is not synchronized and must only be used from the thread that runs the suites.
+ */
+class MeshFile {
+ public:
+  static constexpr uint32_t kMagic = 0x4853454D;  // "MESH"
+  static constexpr uint16_t kVersion = 1;
+  static constexpr uint32_t kBlockAlignment = 16;
+
+  enum Attribute {
+    ATTR_POSITION = 0,
+    ATTR_NORMAL,
+    ATTR_TEXCOORD,
+    ATTR_MAX,
+  };
+
+  struct Block {
+    //! Offset of the block from the start of the file, or 0 if the attribute is absent.
+    uint32_t offset;
+    //! Number of floats per vertex.
+    uint32_t components;
+  };
+
+  struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t num_vertices;
+    uint32_t file_size;
+    Block attributes[ATTR_MAX];
+    //! Optional draw-ready block holding every attribute of each vertex, `interleaved_stride` bytes apart.
+    uint32_t interleaved_offset;
+    uint32_t interleaved_stride;
+  };
+  static_assert(sizeof(Header) == 48, "Header layout must match collada_converter.py");
+
+ public:
+  /**
+   * Validates and adopts the given file image, which must be `size` bytes long.
+   *
+   * Returns false and populates `error` if the container is malformed.
+   */
+  bool Parse(std::vector<uint32_t> &&image, uint32_t size, std::string &error);
+
+  //! Reads and parses the file at `path` with a single bulk read, adopting the contents from the active
+  //! ResourcePrefetcher if it has already read them. Returns nullptr and populates `error` on failure.
+  static std::shared_ptr<const MeshFile> Load(const std::string &path, std::string &error);
+
+  //! Returns the cached mesh for `path`, loading it on first use. Returns nullptr and populates `error` on failure.
+  static std::shared_ptr<const MeshFile> LoadCached(const std::string &path, std::string &error);
+
+  //! Returns the subset of `paths` that are not yet cached, i.e., those worth prefetching.
+  static std::vector<std::string> UncachedPaths(const std::vector<std::string> &paths);
+
+  //! Drops every cached mesh. Meshes still referenced by a caller remain valid until released.
+  static void ClearCache();
+
+  [[nodiscard]] uint32_t GetVertexCount() const { return header().num_vertices; }
+
+  //! Returns the number of floats per vertex of the given attribute, or 0 if the mesh does not provide it.
+  [[nodiscard]] uint32_t GetComponents(Attribute attribute) const { return header().attributes[attribute].components; }
+
+  //! Returns the tightly packed values of the given attribute, or nullptr if it is absent.
+  [[nodiscard]] const float *GetAttribute(Attribute attribute) const;
+
+  [[nodiscard]] const float *GetPositions() const { return GetAttribute(ATTR_POSITION); }
+  [[nodiscard]] const float *GetNormals() const { return GetAttribute(ATTR_NORMAL); }
+  [[nodiscard]] const float *GetTexcoords() const { return GetAttribute(ATTR_TEXCOORD); }
+
+  //! Returns the interleaved vertex block and sets `stride` to its size in bytes, or returns nullptr if it is absent.
+  [[nodiscard]] const float *GetInterleaved(uint32_t &stride) const;
+
+ private:
+  [[nodiscard]] const Header &header() const { return *reinterpret_cast<const Header *>(image_.data()); }
+  [[nodiscard]] const float *At(uint32_t offset) const {
+    return reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(image_.data()) + offset);
+  }
+
+  //! The complete file, held as words so that every block is at least float aligned.
+  std::vector<uint32_t> image_;
+};
+
+#endif  // NXDK_PGRAPH_TESTS_MODELS_MESH_FILE_H
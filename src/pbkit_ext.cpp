@@ -2,6 +2,8 @@
 
 #include <pbkit/pbkit.h>
 
+#include <cstdarg>
+
 #include "debug_output.h"
 
 uint16_t float_to_z16(float val) {
@@ -103,16 +105,3 @@ void pb_fetch_pgraph_registers(uint8_t *registers) {
     last_empty = dst;
   }
 }
-
-void pb_diff_registers(const uint8_t *a, const uint8_t *b, std::list<uint32_t> &modified_registers) {
-  modified_registers.clear();
-
-  auto old_val = reinterpret_cast<const uint32_t *>(a);
-  auto new_val = reinterpret_cast<const uint32_t *>(b);
-
-  for (auto i = 0; i < PGRAPH_REGISTER_ARRAY_SIZE / 4; ++i, ++old_val, ++new_val) {
-    if (*old_val != *new_val) {
-      modified_registers.push_back(PGRAPH_REGISTER_BASE + i * 4);
-    }
-  }
-}
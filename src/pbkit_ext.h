@@ -2,9 +2,9 @@
 #define NXDK_PGRAPH_TESTS_PBKIT_EXT_H
 
 #include <cstdint>
-#include <list>
 
 #define MASK(mask, val) (((val) << (__builtin_ffs(mask) - 1)) & (mask))
+#define UNMASK(mask, val) (((val) & (mask)) >> (__builtin_ffs(mask) - 1))
 
 constexpr float kF16Max = 511.9375f;
 constexpr float kF24Max = 3.4027977E38;
@@ -28,8 +28,6 @@ float z24_to_float(uint32_t val);
 // `registers` must be an array of at least size PGRAPH_REGISTER_ARRAY_SIZE bytes.
 void pb_fetch_pgraph_registers(uint8_t* registers);
 
-void pb_diff_registers(const uint8_t* a, const uint8_t* b, std::list<uint32_t>& modified_registers);
-
 #if defined(__cplusplus)
 extern "C" {
 #endif
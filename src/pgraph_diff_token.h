@@ -1,15 +1,25 @@
 #ifndef NXDK_PGRAPH_TESTS_PGRAPH_DIFF_TOKEN_H
 #define NXDK_PGRAPH_TESTS_PGRAPH_DIFF_TOKEN_H
 
+#include <string>
+
 #include "pbkit_ext.h"
 
 struct PGRAPHDiffToken {
-  uint8_t registers[PGRAPH_REGISTER_ARRAY_SIZE];
+  alignas(16) uint8_t registers[PGRAPH_REGISTER_ARRAY_SIZE];
+  //! Snapshot fetched by the most recent DumpDiff, reused to avoid an 8K allocation on every call.
+  alignas(16) uint8_t fetched_registers[PGRAPH_REGISTER_ARRAY_SIZE];
   bool enable_progress_log;
 
   explicit PGRAPHDiffToken(bool initialize = true, bool enable_progress_log = false);
   void Capture();
-  void DumpDiff() const;
+
+  //! Prints every non-blacklisted register that has changed since the last Capture, preceded by `label` if any
+  //! registers changed. Returns the number of changed registers.
+  uint32_t DumpDiff(const std::string& label = "");
+
+  //! Returns the PGRAPH_REGISTER_ARRAY_SIZE snapshot fetched by the most recent DumpDiff on this token.
+  [[nodiscard]] const uint8_t* GetRegisters() const { return fetched_registers; }
 };
 
 #endif  // NXDK_PGRAPH_TESTS_PGRAPH_DIFF_TOKEN_H
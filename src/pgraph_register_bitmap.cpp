@@ -0,0 +1,97 @@
+#include "pgraph_register_bitmap.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// This list was compiled by comparing the raw diff across a NV097_SET_SHADOW_COMPARE_FUNC to a diff across a
+// NV097_SET_MATERIAL_ALPHA. Addresses that were modified in both are assumed to be utility registers without any
+// particularly interesting meaning.
+static constexpr uint32_t kDiffBlacklistAddresses[] = {
+    0xFD40000C, 0xFD40010C, 0xFD400704, 0xFD400708, 0xFD40070C, 0xFD40072C, 0xFD400740, 0xFD400744,
+    0xFD400748, 0xFD40074C,
+    0xFD400750,  // Value changes even when no pgraph commands are set
+    0xFD400760, 0xFD400764, 0xFD400768, 0xFD40076C, 0xFD400788, 0xFD4007A0, 0xFD4007A4, 0xFD4007A8,
+    0xFD4007AC, 0xFD4007B0, 0xFD4007B4, 0xFD4007B8, 0xFD4007BC, 0xFD4007E0, 0xFD4007E4, 0xFD4007E8,
+    0xFD4007EC, 0xFD4007F0, 0xFD4007F4, 0xFD4007F8, 0xFD4007FC, 0xFD40110C, 0xFD401704, 0xFD401708,
+    0xFD40170C, 0xFD40172C, 0xFD401740, 0xFD401744, 0xFD401748, 0xFD40174C,
+    0xFD401750,  // Value changes even when no pgraph commands are set
+    0xFD401760, 0xFD401764, 0xFD401768, 0xFD40176C, 0xFD401788, 0xFD4017A0, 0xFD4017A4, 0xFD4017A8,
+    0xFD4017AC, 0xFD4017B0, 0xFD4017B4, 0xFD4017B8, 0xFD4017BC, 0xFD4017E0, 0xFD4017E4, 0xFD4017E8,
+    0xFD4017EC, 0xFD4017F0, 0xFD4017F4, 0xFD4017F8, 0xFD4017FC,
+};
+
+static constexpr PGRAPHRegisterBitmap kBlacklistBitmap = PGRAPHRegisterBitmap::FromAddresses(kDiffBlacklistAddresses);
+const PGRAPHRegisterBitmap kPGRAPHDiffBlacklist = kBlacklistBitmap;
+
+uint32_t PGRAPHRegisterBitmap::Count() const {
+  uint32_t ret = 0;
+  for (auto word : words) {
+    ret += __builtin_popcount(word);
+  }
+  return ret;
+}
+
+bool PGRAPHRegisterBitmap::Empty() const {
+  uint32_t any = 0;
+  for (auto word : words) {
+    any |= word;
+  }
+  return !any;
+}
+
+bool pb_diff_registers_scalar(const uint8_t *a, const uint8_t *b, const PGRAPHRegisterBitmap &ignore,
+                              PGRAPHRegisterBitmap &changed) {
+  auto old_val = reinterpret_cast<const uint32_t *>(a);
+  auto new_val = reinterpret_cast<const uint32_t *>(b);
+
+  uint32_t any = 0;
+  for (uint32_t word = 0; word < PGRAPHRegisterBitmap::kNumWords; ++word, old_val += 32, new_val += 32) {
+    // Most blocks are unchanged between snapshots, so check the whole block before building its bitmap word.
+    uint32_t differences = 0;
+    for (uint32_t i = 0; i < 32; ++i) {
+      differences |= old_val[i] ^ new_val[i];
+    }
+
+    uint32_t bits = 0;
+    if (differences) {
+      for (uint32_t i = 0; i < 32; ++i) {
+        bits |= static_cast<uint32_t>(old_val[i] != new_val[i]) << i;
+      }
+      bits &= ~ignore.words[word];
+    }
+    changed.words[word] = bits;
+    any |= bits;
+  }
+
+  return any != 0;
+}
+
+#ifdef __SSE2__
+bool pb_diff_registers(const uint8_t *a, const uint8_t *b, const PGRAPHRegisterBitmap &ignore,
+                       PGRAPHRegisterBitmap &changed) {
+  auto old_val = reinterpret_cast<const __m128i *>(a);
+  auto new_val = reinterpret_cast<const __m128i *>(b);
+
+  uint32_t any = 0;
+  for (uint32_t word = 0; word < PGRAPHRegisterBitmap::kNumWords; ++word, old_val += 8, new_val += 8) {
+    // Each 128-bit compare covers 4 registers, movemask packs the per-lane equality into 4 bits.
+    uint32_t equal = 0;
+    for (uint32_t i = 0; i < 8; ++i) {
+      auto eq = _mm_cmpeq_epi32(_mm_load_si128(old_val + i), _mm_load_si128(new_val + i));
+      equal |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(eq))) << (i * 4);
+    }
+    const uint32_t bits = ~equal & ~ignore.words[word];
+    changed.words[word] = bits;
+    any |= bits;
+  }
+
+  return any != 0;
+}
+#else
+// The Xbox CPU only supports SSE1, which lacks packed integer comparisons.
+bool pb_diff_registers(const uint8_t *a, const uint8_t *b, const PGRAPHRegisterBitmap &ignore,
+                       PGRAPHRegisterBitmap &changed) {
+  return pb_diff_registers_scalar(a, b, ignore, changed);
+}
+#endif
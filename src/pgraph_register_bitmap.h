@@ -0,0 +1,63 @@
+#ifndef NXDK_PGRAPH_TESTS_PGRAPH_REGISTER_BITMAP_H
+#define NXDK_PGRAPH_TESTS_PGRAPH_REGISTER_BITMAP_H
+
+#include <cstdint>
+
+#include "pbkit_ext.h"
+
+constexpr uint32_t kPGRAPHRegisterCount = PGRAPH_REGISTER_ARRAY_SIZE / 4;
+
+//! One bit per 32-bit register in the PGRAPH_REGISTER_ARRAY_SIZE snapshot, indexed by (address - base) / 4.
+struct PGRAPHRegisterBitmap {
+  static constexpr uint32_t kNumWords = kPGRAPHRegisterCount / 32;
+
+  uint32_t words[kNumWords]{};
+
+  //! Builds a bitmap with the given absolute register addresses set.
+  template <uint32_t N>
+  static constexpr PGRAPHRegisterBitmap FromAddresses(const uint32_t (&addresses)[N]) {
+    PGRAPHRegisterBitmap ret;
+    for (auto address : addresses) {
+      ret.Set((address - PGRAPH_REGISTER_BASE) / 4);
+    }
+    return ret;
+  }
+
+  constexpr void Set(uint32_t index) { words[index >> 5] |= 1U << (index & 31); }
+  [[nodiscard]] constexpr bool Test(uint32_t index) const { return words[index >> 5] & (1U << (index & 31)); }
+
+  [[nodiscard]] uint32_t Count() const;
+  [[nodiscard]] bool Empty() const;
+
+  //! Invokes `callback(uint32_t index)` for each set bit, in ascending order.
+  template <typename Callback>
+  void ForEach(Callback &&callback) const {
+    for (uint32_t word = 0; word < kNumWords; ++word) {
+      uint32_t bits = words[word];
+      while (bits) {
+        callback(word * 32 + __builtin_ctz(bits));
+        bits &= bits - 1;
+      }
+    }
+  }
+};
+
+//! Registers that change regardless of the commands being sent, which would otherwise drown out meaningful changes.
+extern const PGRAPHRegisterBitmap kPGRAPHDiffBlacklist;
+
+/**
+ * Compares two PGRAPH_REGISTER_ARRAY_SIZE register snapshots, setting a bit in `changed` for each register that differs
+ * and is not set in `ignore`.
+ *
+ * Both snapshots must be 16-byte aligned.
+ *
+ * @return true if any non-ignored register changed.
+ */
+bool pb_diff_registers(const uint8_t *a, const uint8_t *b, const PGRAPHRegisterBitmap &ignore,
+                       PGRAPHRegisterBitmap &changed);
+
+//! Portable implementation of pb_diff_registers, used on targets without SSE2 (including the Xbox itself).
+bool pb_diff_registers_scalar(const uint8_t *a, const uint8_t *b, const PGRAPHRegisterBitmap &ignore,
+                              PGRAPHRegisterBitmap &changed);
+
+#endif  // NXDK_PGRAPH_TESTS_PGRAPH_REGISTER_BITMAP_H
@@ -0,0 +1,239 @@
+#include "pgraph_snapshot_history.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+static constexpr char kMagic[4] = {'P', 'G', 'S', 'H'};
+static constexpr uint32_t kHeaderSize = sizeof(kMagic) + 2 * sizeof(uint32_t);
+
+static void PutU32(std::vector<uint8_t> &out, uint32_t value) {
+  for (auto i = 0; i < 4; ++i) {
+    out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+  }
+}
+
+static void PutVarint(std::vector<uint8_t> &out, uint32_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+PGRAPHHistoryWriter::PGRAPHHistoryWriter(std::string path) : path_(std::move(path)) {
+  if (path_.empty()) {
+    return;
+  }
+
+  auto header = EncodeHeader();
+  std::ofstream out(path_, std::ios_base::binary | std::ios_base::trunc);
+  out.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+}
+
+std::vector<uint8_t> PGRAPHHistoryWriter::EncodeHeader() {
+  std::vector<uint8_t> ret(std::begin(kMagic), std::end(kMagic));
+  PutU32(ret, kVersion);
+  PutU32(ret, kRegisterCount);
+  return ret;
+}
+
+std::vector<uint8_t> PGRAPHHistoryWriter::EncodeRecord(const std::string &name, const uint8_t *registers) {
+  auto current = reinterpret_cast<const uint32_t *>(registers);
+
+  std::vector<uint8_t> deltas;
+  uint32_t num_changed = 0;
+  uint32_t next_index = 0;
+  for (uint32_t i = 0; i < kRegisterCount; ++i) {
+    const uint32_t difference = current[i] ^ previous_[i];
+    if (!difference) {
+      continue;
+    }
+
+    PutVarint(deltas, i - next_index);
+    PutVarint(deltas, difference);
+    next_index = i + 1;
+    previous_[i] = current[i];
+    ++num_changed;
+  }
+
+  std::vector<uint8_t> ret;
+  ret.reserve(name.size() + deltas.size() + 10);
+  PutVarint(ret, static_cast<uint32_t>(name.size()));
+  ret.insert(ret.end(), name.begin(), name.end());
+  PutVarint(ret, num_changed);
+  ret.insert(ret.end(), deltas.begin(), deltas.end());
+  return ret;
+}
+
+bool PGRAPHHistoryWriter::Append(const std::string &name, const uint8_t *registers) {
+  auto record = EncodeRecord(name, registers);
+  if (path_.empty()) {
+    return true;
+  }
+
+  // Reopened for each record, as with Logger, so that the history survives a hang or crash in a later test.
+  std::ofstream out(path_, std::ios_base::binary | std::ios_base::app);
+  out.write(reinterpret_cast<const char *>(record.data()), static_cast<std::streamsize>(record.size()));
+  out.flush();
+  return out.good();
+}
+
+namespace {
+
+class ByteReader {
+ public:
+  ByteReader(const uint8_t *data, size_t size) : data_(data), end_(data + size) {}
+
+  [[nodiscard]] bool AtEnd() const { return data_ == end_; }
+  [[nodiscard]] size_t Remaining() const { return end_ - data_; }
+
+  bool U32(uint32_t &value) {
+    if (Remaining() < 4) {
+      return false;
+    }
+    value = data_[0] | (data_[1] << 8) | (data_[2] << 16) | (static_cast<uint32_t>(data_[3]) << 24);
+    data_ += 4;
+    return true;
+  }
+
+  bool Varint(uint32_t &value) {
+    value = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7) {
+      if (AtEnd()) {
+        return false;
+      }
+      const uint8_t byte = *data_++;
+      value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool Bytes(size_t count, std::string &out) {
+    if (Remaining() < count) {
+      return false;
+    }
+    out.assign(reinterpret_cast<const char *>(data_), count);
+    data_ += count;
+    return true;
+  }
+
+  bool Skip(size_t count) {
+    if (Remaining() < count) {
+      return false;
+    }
+    data_ += count;
+    return true;
+  }
+
+ private:
+  const uint8_t *data_;
+  const uint8_t *end_;
+};
+
+}  // namespace
+
+bool PGRAPHHistoryIndex::Load(const std::string &path, std::vector<std::string> &errors) {
+  std::ifstream in(path, std::ios_base::binary);
+  if (!in) {
+    errors.push_back("Failed to open " + path);
+    return false;
+  }
+
+  std::vector<uint8_t> content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  return Parse(content.data(), content.size(), errors);
+}
+
+bool PGRAPHHistoryIndex::Parse(const uint8_t *data, size_t size, std::vector<std::string> &errors) {
+  record_names_.clear();
+  record_lookup_.clear();
+  record_registers_.clear();
+  changes_.assign(PGRAPHHistoryWriter::kRegisterCount, {});
+
+  if (size < kHeaderSize || memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+    errors.emplace_back("Not a PGRAPH history file");
+    return false;
+  }
+
+  ByteReader reader(data, size);
+  reader.Skip(sizeof(kMagic));
+  uint32_t version;
+  uint32_t register_count;
+  reader.U32(version);
+  reader.U32(register_count);
+  if (version != PGRAPHHistoryWriter::kVersion) {
+    errors.push_back("Unsupported PGRAPH history version " + std::to_string(version));
+    return false;
+  }
+  if (register_count != PGRAPHHistoryWriter::kRegisterCount) {
+    errors.push_back("Unexpected register count " + std::to_string(register_count));
+    return false;
+  }
+
+  std::vector<uint32_t> current(register_count, 0);
+  std::vector<uint32_t> changed;
+  while (!reader.AtEnd()) {
+    const auto record = static_cast<uint32_t>(record_names_.size());
+    auto fail = [&errors, record](const char *message) {
+      errors.push_back("Record " + std::to_string(record) + ": " + message);
+      return false;
+    };
+
+    uint32_t name_length;
+    std::string name;
+    uint32_t num_changed;
+    if (!reader.Varint(name_length) || !reader.Bytes(name_length, name) || !reader.Varint(num_changed)) {
+      return fail("truncated header");
+    }
+
+    changed.clear();
+    uint32_t next_index = 0;
+    for (uint32_t i = 0; i < num_changed; ++i) {
+      uint32_t index_delta;
+      uint32_t difference;
+      if (!reader.Varint(index_delta) || !reader.Varint(difference)) {
+        return fail("truncated register delta");
+      }
+      const uint32_t index = next_index + index_delta;
+      if (index >= register_count || index < next_index) {
+        return fail("register index out of range");
+      }
+      changed.push_back(index);
+      current[index] ^= difference;
+      next_index = index + 1;
+    }
+
+    // Only commit the record once it has been fully decoded so that a partial trailing record is ignored entirely.
+    for (auto index : changed) {
+      changes_[index].push_back({record, current[index]});
+    }
+    record_registers_.push_back(changed);
+    record_lookup_.emplace(name, record);
+    record_names_.push_back(std::move(name));
+  }
+
+  return true;
+}
+
+bool PGRAPHHistoryIndex::FindRecord(const std::string &name, uint32_t &record) const {
+  auto it = record_lookup_.find(name);
+  if (it == record_lookup_.end()) {
+    return false;
+  }
+  record = it->second;
+  return true;
+}
+
+uint32_t PGRAPHHistoryIndex::ValueAt(uint32_t register_index, uint32_t record) const {
+  const auto &changes = changes_[register_index];
+  auto it = std::upper_bound(changes.begin(), changes.end(), record,
+                             [](uint32_t target, const Change &change) { return target < change.record; });
+  if (it == changes.begin()) {
+    return 0;
+  }
+  return std::prev(it)->value;
+}
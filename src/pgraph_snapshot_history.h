@@ -0,0 +1,90 @@
+#ifndef NXDK_PGRAPH_TESTS_PGRAPH_SNAPSHOT_HISTORY_H
+#define NXDK_PGRAPH_TESTS_PGRAPH_SNAPSHOT_HISTORY_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "pbkit_ext.h"
+
+/**
+ * Persists a sequence of named PGRAPH register snapshots (as returned by pb_fetch_pgraph_registers) to a compact binary
+ * file.
+ *
+ * File format (all integers little endian):
+ *   "PGSH" magic, uint32 version, uint32 register count
+ *   Records, each of which is:
+ *     varint name length, name bytes
+ *     varint number of changed registers
+ *     For each changed register, in ascending order:
+ *       varint (register index - previous changed index - 1), or the index itself for the first entry
+ *       varint (new value XOR previous value)
+ *
+ * Each record is delta encoded against the previous one. The first record is encoded against an all-zero snapshot.
+ * Varints are unsigned LEB128.
+ */
+class PGRAPHHistoryWriter {
+ public:
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint32_t kRegisterCount = PGRAPH_REGISTER_ARRAY_SIZE / 4;
+
+ public:
+  //! Creates (or truncates) the history file at `path`. An empty path produces an in-memory only writer.
+  explicit PGRAPHHistoryWriter(std::string path);
+
+  //! Appends a snapshot of PGRAPH_REGISTER_ARRAY_SIZE bytes, flushing it to the file immediately.
+  bool Append(const std::string &name, const uint8_t *registers);
+
+  //! Encodes a snapshot into a record without writing it, updating the delta base.
+  std::vector<uint8_t> EncodeRecord(const std::string &name, const uint8_t *registers);
+
+  //! Returns the file header.
+  static std::vector<uint8_t> EncodeHeader();
+
+ private:
+  std::string path_;
+  uint32_t previous_[kRegisterCount]{};
+};
+
+//! Decodes a history file and indexes it by register so that queries do not need to replay the history.
+class PGRAPHHistoryIndex {
+ public:
+  struct Change {
+    //! Index of the record at which the register changed.
+    uint32_t record;
+    //! The register's value after that record.
+    uint32_t value;
+  };
+
+ public:
+  bool Load(const std::string &path, std::vector<std::string> &errors);
+
+  //! Parses a history file. On a truncated or malformed record, the records preceding it remain available.
+  bool Parse(const uint8_t *data, size_t size, std::vector<std::string> &errors);
+
+  [[nodiscard]] uint32_t NumRecords() const { return static_cast<uint32_t>(record_names_.size()); }
+  [[nodiscard]] const std::string &RecordName(uint32_t record) const { return record_names_[record]; }
+
+  //! Looks up the first record with the given name.
+  bool FindRecord(const std::string &name, uint32_t &record) const;
+
+  //! Returns every change to the given register index, ordered by record.
+  [[nodiscard]] const std::vector<Change> &Changes(uint32_t register_index) const { return changes_[register_index]; }
+
+  //! Returns the register indices changed by the given record, in ascending order.
+  [[nodiscard]] const std::vector<uint32_t> &RegistersChangedBy(uint32_t record) const {
+    return record_registers_[record];
+  }
+
+  //! Returns the value of the given register immediately after `record`.
+  [[nodiscard]] uint32_t ValueAt(uint32_t register_index, uint32_t record) const;
+
+ private:
+  std::vector<std::string> record_names_;
+  std::unordered_map<std::string, uint32_t> record_lookup_;
+  std::vector<std::vector<Change>> changes_;
+  std::vector<std::vector<uint32_t>> record_registers_;
+};
+
+#endif  // NXDK_PGRAPH_TESTS_PGRAPH_SNAPSHOT_HISTORY_H
@@ -0,0 +1,216 @@
+#include "resource_prefetcher.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static ResourcePrefetcher *active_prefetcher = nullptr;
+
+bool ResourcePrefetcher::DiskFileSource::GetSize(const std::string &path, uint32_t &size) {
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (!fp) {
+    return false;
+  }
+
+  long length = -1;
+  if (!fseek(fp, 0, SEEK_END)) {
+    length = ftell(fp);
+  }
+  fclose(fp);
+  if (length < 0) {
+    return false;
+  }
+  size = static_cast<uint32_t>(length);
+  return true;
+}
+
+bool ResourcePrefetcher::DiskFileSource::Read(const std::string &path, uint8_t *buffer, uint32_t size) {
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (!fp) {
+    return false;
+  }
+  bool ok = !size || fread(buffer, size, 1, fp) == 1;
+  fclose(fp);
+  return ok;
+}
+
+ResourcePrefetcher::ResourcePrefetcher(uint32_t budget_bytes, std::unique_ptr<FileSource> source)
+    : budget_bytes_(budget_bytes), source_(std::move(source)) {
+  worker_ = std::thread(&ResourcePrefetcher::WorkerMain, this);
+}
+
+ResourcePrefetcher::~ResourcePrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_all();
+  state_changed_.notify_all();
+  worker_.join();
+
+  if (active_prefetcher == this) {
+    active_prefetcher = nullptr;
+  }
+}
+
+void ResourcePrefetcher::Schedule(const std::vector<std::string> &paths) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    queue_.clear();
+
+    // In-flight reads keep their budget until the worker notices that they belong to an older generation.
+    for (auto &entry : entries_) {
+      if (entry.second.state == State::READY) {
+        ++stats_.discarded;
+        Release(entry.second.resource.size);
+      }
+    }
+    entries_.clear();
+
+    for (const auto &path : paths) {
+      if (entries_.emplace(path, Entry{}).second) {
+        queue_.push_back(path);
+      }
+    }
+  }
+  work_available_.notify_all();
+  state_changed_.notify_all();
+}
+
+bool ResourcePrefetcher::Take(const std::string &path, Resource &resource) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto it = entries_.find(path);
+  if (it == entries_.end()) {
+    ++stats_.misses;
+    return false;
+  }
+
+  auto generation = generation_;
+  state_changed_.wait(lock, [this, &path, generation]() {
+    auto it = entries_.find(path);
+    return generation != generation_ || it == entries_.end() || it->second.state != State::READING;
+  });
+
+  it = entries_.find(path);
+  if (generation != generation_ || it == entries_.end()) {
+    ++stats_.misses;
+    return false;
+  }
+
+  // A QUEUED entry has not been started (or is waiting for budget); erasing it cancels the read so the caller does not
+  // block behind unrelated files.
+  bool ready = it->second.state == State::READY;
+  if (ready) {
+    resource = std::move(it->second.resource);
+    Release(resource.size);
+    ++stats_.hits;
+  } else {
+    ++stats_.misses;
+  }
+  entries_.erase(it);
+  lock.unlock();
+
+  state_changed_.notify_all();
+  return ready;
+}
+
+ResourcePrefetcher::Stats ResourcePrefetcher::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+uint32_t ResourcePrefetcher::BytesHeld() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_held_;
+}
+
+void ResourcePrefetcher::SetActive(ResourcePrefetcher *prefetcher) { active_prefetcher = prefetcher; }
+
+ResourcePrefetcher *ResourcePrefetcher::Active() { return active_prefetcher; }
+
+ResourcePrefetcher::Entry *ResourcePrefetcher::FindCurrent(const std::string &path, uint32_t generation,
+                                                           State state) {
+  if (generation != generation_) {
+    return nullptr;
+  }
+  auto it = entries_.find(path);
+  if (it == entries_.end() || it->second.state != state) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+void ResourcePrefetcher::Release(uint32_t size) { bytes_held_ -= size; }
+
+void ResourcePrefetcher::WorkerMain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    work_available_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    if (stop_) {
+      return;
+    }
+
+    std::string path = std::move(queue_.front());
+    queue_.pop_front();
+    auto generation = generation_;
+    if (!FindCurrent(path, generation, State::QUEUED)) {
+      continue;
+    }
+
+    lock.unlock();
+    uint32_t size = 0;
+    bool ok = source_->GetSize(path, size);
+    lock.lock();
+
+    auto entry = FindCurrent(path, generation, State::QUEUED);
+    if (!entry) {
+      continue;
+    }
+    if (!ok || size > budget_bytes_) {
+      entry->state = State::FAILED;
+      state_changed_.notify_all();
+      continue;
+    }
+
+    state_changed_.wait(lock, [this, &path, generation, size]() {
+      return stop_ || !FindCurrent(path, generation, State::QUEUED) || bytes_held_ + size <= budget_bytes_;
+    });
+    if (stop_) {
+      return;
+    }
+    entry = FindCurrent(path, generation, State::QUEUED);
+    if (!entry) {
+      continue;
+    }
+
+    entry->state = State::READING;
+    bytes_held_ += size;
+    stats_.peak_bytes_held = std::max(stats_.peak_bytes_held, bytes_held_);
+    lock.unlock();
+
+    Resource resource;
+    resource.storage.resize((size + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+    resource.size = size;
+    ok = source_->Read(path, reinterpret_cast<uint8_t *>(resource.storage.data()), size);
+
+    lock.lock();
+    stats_.bytes_read += ok ? size : 0;
+    entry = FindCurrent(path, generation, State::READING);
+    if (!entry) {
+      // Discarded by Schedule while the read was in flight.
+      if (ok) {
+        ++stats_.discarded;
+      }
+      Release(size);
+    } else if (!ok) {
+      entry->state = State::FAILED;
+      Release(size);
+    } else {
+      entry->state = State::READY;
+      entry->resource = std::move(resource);
+    }
+    state_changed_.notify_all();
+  }
+}
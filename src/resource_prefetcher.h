@@ -0,0 +1,125 @@
+#ifndef NXDK_PGRAPH_TESTS_RESOURCE_PREFETCHER_H
+#define NXDK_PGRAPH_TESTS_RESOURCE_PREFETCHER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Reads resource files into memory on a background thread so that a suite's Initialize does not stall on the DVD/HDD.
+ *
+ * The TestDriver schedules the files declared by the next suite while the current one renders. Loaders then claim the
+ * contents via Take, which transfers ownership of the buffer to the caller. Memory held by files that have been read
+ * but not yet claimed is bounded by the budget given at construction; the worker waits for buffers to be claimed or
+ * discarded before reading further, and files that can never fit are left to the loader to read directly.
+ */
+class ResourcePrefetcher {
+ public:
+  //! Abstracts file access so that the scheduling can be exercised without a real filesystem.
+  class FileSource {
+   public:
+    virtual ~FileSource() = default;
+
+    //! Populates `size` with the size of the file at `path`. Returns false if the file cannot be accessed.
+    virtual bool GetSize(const std::string &path, uint32_t &size) = 0;
+
+    //! Reads exactly `size` bytes from the start of the file at `path` into `buffer`.
+    virtual bool Read(const std::string &path, uint8_t *buffer, uint32_t size) = 0;
+  };
+
+  //! FileSource backed by stdio.
+  class DiskFileSource : public FileSource {
+   public:
+    bool GetSize(const std::string &path, uint32_t &size) override;
+    bool Read(const std::string &path, uint8_t *buffer, uint32_t size) override;
+  };
+
+  //! The contents of a prefetched file. Storage is word aligned so that it may be adopted by loaders that parse in
+  //! place (e.g., MeshFile).
+  struct Resource {
+    std::vector<uint32_t> storage;
+    uint32_t size{0};
+
+    [[nodiscard]] const uint8_t *data() const { return reinterpret_cast<const uint8_t *>(storage.data()); }
+  };
+
+  struct Stats {
+    //! Number of Take calls that received prefetched contents.
+    uint32_t hits{0};
+    //! Number of Take calls that found nothing usable and must fall back to reading the file.
+    uint32_t misses{0};
+    //! Number of files that were read but discarded by Schedule before being claimed.
+    uint32_t discarded{0};
+    uint32_t bytes_read{0};
+    //! The maximum number of bytes held by unclaimed buffers at any time.
+    uint32_t peak_bytes_held{0};
+  };
+
+ public:
+  ResourcePrefetcher(uint32_t budget_bytes, std::unique_ptr<FileSource> source);
+  ~ResourcePrefetcher();
+
+  //! Replaces any pending work with `paths`, discarding files prefetched by a previous call that were never claimed.
+  void Schedule(const std::vector<std::string> &paths);
+
+  /**
+   * Hands off the prefetched contents of `path`, waiting if the worker is currently reading it.
+   *
+   * Returns false if `path` was not scheduled, has not been started yet, could not be read, or exceeds the budget. In
+   * all of these cases the caller should read the file itself; a pending read of `path` is cancelled.
+   */
+  bool Take(const std::string &path, Resource &resource);
+
+  [[nodiscard]] Stats GetStats() const;
+  [[nodiscard]] uint32_t BytesHeld() const;
+
+  //! Sets the prefetcher consulted by resource loaders. May be nullptr to disable prefetching.
+  static void SetActive(ResourcePrefetcher *prefetcher);
+  [[nodiscard]] static ResourcePrefetcher *Active();
+
+ private:
+  enum class State {
+    QUEUED,
+    READING,
+    READY,
+    FAILED,
+  };
+
+  struct Entry {
+    State state{State::QUEUED};
+    Resource resource;
+  };
+
+  void WorkerMain();
+  //! Returns the entry for `path` if it belongs to `generation` and is still in the given state.
+  Entry *FindCurrent(const std::string &path, uint32_t generation, State state);
+  void Release(uint32_t size);
+
+ private:
+  const uint32_t budget_bytes_;
+  std::unique_ptr<FileSource> source_;
+
+  mutable std::mutex mutex_;
+  //! Signalled when work is queued or the prefetcher is stopping.
+  std::condition_variable work_available_;
+  //! Signalled whenever an entry changes state or budget is released.
+  std::condition_variable state_changed_;
+
+  bool stop_{false};
+  //! Incremented by every Schedule so that the worker can detect that an in-flight read is no longer wanted.
+  uint32_t generation_{0};
+  std::deque<std::string> queue_;
+  std::unordered_map<std::string, Entry> entries_;
+  uint32_t bytes_held_{0};
+  Stats stats_;
+
+  std::thread worker_;
+};
+
+#endif  // NXDK_PGRAPH_TESTS_RESOURCE_PREFETCHER_H
@@ -1,5 +1,6 @@
 #include "runtime_config.h"
 
+#include <cstring>
 #include <fstream>
 #ifdef NXDK
 #pragma clang diagnostic push
@@ -17,14 +18,17 @@
 
 static bool ParseTestSuites(
     json_t const* test_suites, std::vector<std::string>& errors,
-    std::map<std::string, RuntimeConfig::SkipConfiguration>& skipped_test_suites,
-    std::map<std::string, std::map<std::string, RuntimeConfig::SkipConfiguration>>& skipped_test_cases);
+    RuntimeConfig::SkipConfigurationMap& skipped_test_suites,
+    std::unordered_map<std::string, RuntimeConfig::SkipConfigurationMap>& skipped_test_cases,
+    TestNameMatcher& test_patterns, std::vector<RuntimeConfig::SkipConfiguration>& test_pattern_configs);
 
 //! C++ wrapper around Tiny-JSON jsonPool_t
 class JSONParser : jsonPool_t {
  public:
   JSONParser() : jsonPool_t{&Alloc, &Alloc} {}
   explicit JSONParser(const char* str) : jsonPool_t{&Alloc, &Alloc}, json_string_{str} {
+    // All nodes are carved out of a single allocation rather than one heap allocation per node.
+    objects_.reserve(EstimateNodeCount(json_string_));
     root_node_ = json_createWithPool(json_string_.data(), this);
   }
 
@@ -36,13 +40,28 @@ class JSONParser : jsonPool_t {
   [[nodiscard]] json_t const* root() const { return root_node_; }
 
  private:
+  //! Returns an upper bound on the number of nodes Tiny-JSON will create for the given text. Every value other than the
+  //! root is either the first member of an object or array, or follows a comma.
+  static size_t EstimateNodeCount(const std::string& json) {
+    size_t ret = 1;
+    for (auto c : json) {
+      ret += c == ',' || c == '{' || c == '[';
+    }
+    return ret;
+  }
+
   static json_t* Alloc(jsonPool_t* pool) {
-    const auto list_pool = static_cast<JSONParser*>(pool);
-    list_pool->object_list_.emplace_back();
-    return &list_pool->object_list_.back();
+    const auto parser = static_cast<JSONParser*>(pool);
+    // Growing the vector would invalidate the nodes that have already been handed out, so running out of reserved
+    // space fails the parse. This cannot happen unless EstimateNodeCount is wrong.
+    if (parser->objects_.size() == parser->objects_.capacity()) {
+      return nullptr;
+    }
+    parser->objects_.emplace_back();
+    return &parser->objects_.back();
   }
 
-  std::list<json_t> object_list_{};
+  std::vector<json_t> objects_{};
   std::string json_string_{};
   json_t const* root_node_{};
 };
@@ -125,8 +144,6 @@ static bool LoadUint32(json_t const* object, const char* key, uint32_t& out) {
 };
 
 bool RuntimeConfig::LoadConfigBuffer(const std::string& config_content, std::vector<std::string>& errors) {
-  std::map<std::string, std::vector<std::string>> test_config;
-
   const JSONParser parser{config_content.c_str()};
 
   auto root = parser.root();
@@ -175,6 +192,11 @@ bool RuntimeConfig::LoadConfigBuffer(const std::string& config_content, std::vec
     return false;
   }
 
+  if (!LoadBool(settings, "enable_capture_fence", enable_capture_fence_)) {
+    errors.emplace_back("settings[enable_capture_fence] must be a boolean");
+    return false;
+  }
+
   if (!LoadUint32(settings, "delay_milliseconds_between_tests", delay_milliseconds_between_tests_)) {
     errors.emplace_back("settings[delay_milliseconds_between_tests] must be a non-negative integer");
     return false;
@@ -185,6 +207,16 @@ bool RuntimeConfig::LoadConfigBuffer(const std::string& config_content, std::vec
     return false;
   }
 
+  if (!LoadUint32(settings, "watchdog_budget_milliseconds", watchdog_budget_milliseconds_)) {
+    errors.emplace_back("settings[watchdog_budget_milliseconds] must be a non-negative integer");
+    return false;
+  }
+
+  if (!LoadUint32(settings, "determinism_check_iterations", determinism_check_iterations_)) {
+    errors.emplace_back("settings[determinism_check_iterations] must be a non-negative integer");
+    return false;
+  }
+
   if (!LoadString(settings, "output_directory_path", output_directory_path_)) {
     errors.emplace_back("settings[output_directory_path] must be a string");
     return false;
@@ -209,7 +241,8 @@ bool RuntimeConfig::LoadConfigBuffer(const std::string& config_content, std::vec
     return false;
   }
 
-  return ParseTestSuites(test_suites, errors, configured_test_suites_, configured_test_cases_);
+  return ParseTestSuites(test_suites, errors, configured_test_suites_, configured_test_cases_, test_patterns_,
+                         test_pattern_configs_);
 }
 
 bool RuntimeConfig::ProcessNetworkSettings(const void* parent, std::vector<std::string>& errors) {
@@ -347,22 +380,25 @@ static RuntimeConfig::SkipConfiguration MakeSkipConfiguration(bool is_skipped) {
   return RuntimeConfig::SkipConfiguration::UNSKIPPED;
 }
 
-static bool ParseTestCase(json_t const* test_case, const std::string& suite_name, const std::string& test_name,
-                          std::vector<std::string>& errors, RuntimeConfig::SkipConfiguration& config_value,
-                          const std::string& test_case_error_message_prefix) {
+static bool ParseTestCase(json_t const* test_case, const std::string& test_name, std::vector<std::string>& errors,
+                          RuntimeConfig::SkipConfiguration& config_value,
+                          const std::string& suite_error_message_prefix) {
+  // The error prefix is only built when needed, as configs may contain tens of thousands of test cases.
+  auto test_case_error_message_prefix = [&]() { return suite_error_message_prefix + "[" + test_name + "]"; };
+
   for (auto element = json_getChild(test_case); element; element = json_getSibling(element)) {
-    std::string name = json_getName(element);
+    auto name = json_getName(element);
     auto type = json_getType(element);
 
-    if (name != "skipped") {
-      errors.emplace_back(test_case_error_message_prefix + "[" + name + "] unsupported. Ignoring");
+    if (strcmp(name, "skipped") != 0) {
+      errors.emplace_back(test_case_error_message_prefix() + "[" + name + "] unsupported. Ignoring");
       continue;
     }
 
     if (type == JSON_BOOLEAN) {
       config_value = MakeSkipConfiguration(json_getBoolean(element));
     } else {
-      errors.emplace_back(test_case_error_message_prefix + "[skipped] must be a boolean");
+      errors.emplace_back(test_case_error_message_prefix() + "[skipped] must be a boolean");
       return false;
     }
   }
@@ -370,12 +406,11 @@ static bool ParseTestCase(json_t const* test_case, const std::string& suite_name
   return true;
 }
 
-static bool ParseTestCases(
-    json_t const* test_suite, const std::string& suite_name, std::vector<std::string>& errors,
-    std::map<std::string, RuntimeConfig::SkipConfiguration>& configured_suites,
-    std::map<std::string, std::map<std::string, RuntimeConfig::SkipConfiguration>>& configured_cases,
-    const std::string& suite_error_message_prefix) {
-  std::map<std::string, RuntimeConfig::SkipConfiguration> case_settings;
+static bool ParseTestCases(json_t const* test_suite, const std::string& suite_name, std::vector<std::string>& errors,
+                           RuntimeConfig::SkipConfigurationMap& configured_suites,
+                           std::unordered_map<std::string, RuntimeConfig::SkipConfigurationMap>& configured_cases,
+                           const std::string& suite_error_message_prefix) {
+  RuntimeConfig::SkipConfigurationMap case_settings;
 
   for (auto test_or_skipped = json_getChild(test_suite); test_or_skipped;
        test_or_skipped = json_getSibling(test_or_skipped)) {
@@ -394,12 +429,11 @@ static bool ParseTestCases(
 
     if (type == JSON_OBJ) {
       auto config_value = RuntimeConfig::SkipConfiguration::DEFAULT;
-      if (!ParseTestCase(test_or_skipped, suite_name, test_name, errors, config_value,
-                         suite_error_message_prefix + "[" + test_name + "]")) {
+      if (!ParseTestCase(test_or_skipped, test_name, errors, config_value, suite_error_message_prefix)) {
         return false;
       }
       if (config_value != RuntimeConfig::SkipConfiguration::DEFAULT) {
-        case_settings[test_name] = config_value;
+        case_settings[std::move(test_name)] = config_value;
       }
     } else {
       errors.emplace_back(suite_error_message_prefix + "[" + test_name + "] must be an object. Ignoring");
@@ -408,16 +442,37 @@ static bool ParseTestCases(
   }
 
   if (!case_settings.empty()) {
-    configured_cases[suite_name] = case_settings;
+    configured_cases[suite_name] = std::move(case_settings);
   }
 
   return true;
 }
 
+static bool ParseTestPattern(json_t const* pattern_config, const std::string& pattern, std::vector<std::string>& errors,
+                             TestNameMatcher& test_patterns,
+                             std::vector<RuntimeConfig::SkipConfiguration>& test_pattern_configs) {
+  auto config_value = RuntimeConfig::SkipConfiguration::DEFAULT;
+  if (!ParseTestCase(pattern_config, pattern, errors, config_value, "test_suites")) {
+    return false;
+  }
+  if (config_value == RuntimeConfig::SkipConfiguration::DEFAULT) {
+    return true;
+  }
+
+  std::string error;
+  if (!test_patterns.AddPattern(pattern, error)) {
+    errors.emplace_back("test_suites[" + pattern + "] is not a valid pattern: " + error);
+    return false;
+  }
+  test_pattern_configs.push_back(config_value);
+  return true;
+}
+
 static bool ParseTestSuites(
     json_t const* test_suites, std::vector<std::string>& errors,
-    std::map<std::string, RuntimeConfig::SkipConfiguration>& skipped_test_suites,
-    std::map<std::string, std::map<std::string, RuntimeConfig::SkipConfiguration>>& skipped_test_cases) {
+    RuntimeConfig::SkipConfigurationMap& skipped_test_suites,
+    std::unordered_map<std::string, RuntimeConfig::SkipConfigurationMap>& skipped_test_cases,
+    TestNameMatcher& test_patterns, std::vector<RuntimeConfig::SkipConfiguration>& test_pattern_configs) {
   std::string test_suites_error_message_prefix("test_suites[");
   for (auto suite = json_getChild(test_suites); suite; suite = json_getSibling(suite)) {
     std::string suite_name = json_getName(suite);
@@ -428,6 +483,13 @@ static bool ParseTestSuites(
       continue;
     }
 
+    if (TestNameMatcher::IsPattern(suite_name)) {
+      if (!ParseTestPattern(suite, suite_name, errors, test_patterns, test_pattern_configs)) {
+        return false;
+      }
+      continue;
+    }
+
     if (!ParseTestCases(suite, suite_name, errors, skipped_test_suites, skipped_test_cases,
                         suite_error_message_prefix)) {
       return false;
@@ -460,10 +522,19 @@ bool RuntimeConfig::ApplyConfig(std::vector<std::shared_ptr<TestSuite>>& test_su
 
     auto test_case_config = configured_test_cases_.find(suite->Name());
     std::set<std::string> skipped_test_cases;
+    std::string qualified_name;
 
     for (auto& test_case : suite->TestNames()) {
       bool skip_test_case = default_skip_test_case;
 
+      if (!test_patterns_.IsEmpty()) {
+        qualified_name.assign(suite->Name()).append("::").append(test_case);
+        auto pattern = test_patterns_.FindLastMatch(qualified_name);
+        if (pattern != TestNameMatcher::kNoMatch) {
+          skip_test_case = test_pattern_configs_[pattern] == SkipConfiguration::SKIPPED;
+        }
+      }
+
       if (test_case_config != configured_test_cases_.end()) {
         auto explicit_config = test_case_config->second.find(test_case);
         if (explicit_config != test_case_config->second.end()) {
@@ -529,6 +600,16 @@ bool RuntimeConfig::DumpConfigToStream(std::ostream& config_file,
     add_test_suite_comma = true;
   }
 
+  // Patterns are written in their original order, as later patterns take precedence over earlier ones.
+  for (uint32_t i = 0; i < test_patterns_.GetNumPatterns(); ++i) {
+    if (add_test_suite_comma) {
+      config_file << "," << std::endl;
+    }
+
+    WriteTestPattern(config_file, test_patterns_.GetPattern(i), test_pattern_configs_[i]);
+    add_test_suite_comma = true;
+  }
+
   config_file << std::endl;
   config_file << "  }" << std::endl;  // test_suites
 
@@ -548,10 +629,13 @@ void RuntimeConfig::WriteSettings(std::ostream& output) const {
   BOOL_OPT(enable_shutdown_on_completion) << "," << std::endl;
   BOOL_OPT(enable_pgraph_region_diff) << "," << std::endl;
   BOOL_OPT(skip_tests_by_default) << "," << std::endl;
+  BOOL_OPT(enable_capture_fence) << "," << std::endl;
 #undef BOOL_OPT
 
   output << R"(    "delay_milliseconds_between_tests": )" << delay_milliseconds_between_tests_ << "," << std::endl;
   output << R"(    "delay_milliseconds_before_exit": )" << delay_milliseconds_before_exit_ << "," << std::endl;
+  output << R"(    "watchdog_budget_milliseconds": )" << watchdog_budget_milliseconds_ << "," << std::endl;
+  output << R"(    "determinism_check_iterations": )" << determinism_check_iterations_ << "," << std::endl;
 
   if (shard_count_ > 0) {
     output << R"(    "sharding": {)" << std::endl;
@@ -632,6 +716,12 @@ void RuntimeConfig::WriteTestSuite(std::ostream& output, const std::shared_ptr<T
   output << "    }";
 }
 
+void RuntimeConfig::WriteTestPattern(std::ostream& output, const std::string& pattern, SkipConfiguration config) {
+  output << "    \"" << pattern << "\": {" << std::endl;
+  output << "      \"skipped\": " << (config == SkipConfiguration::SKIPPED ? "true" : "false") << std::endl;
+  output << "    }";
+}
+
 void RuntimeConfig::WriteTestCase(std::ostream& output, const std::string& suite_name,
                                   const std::string& test_name) const {
   output << "      \"" << test_name << "\": {" << std::endl;
@@ -2,9 +2,11 @@
 #define NXDK_PGRAPH_TESTS_RUNTIME_CONFIG_H
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "configure.h"
+#include "test_name_matcher.h"
 #include "tests/test_suite.h"
 
 class RuntimeConfig {
@@ -22,6 +24,10 @@ class RuntimeConfig {
     STATIC,
   };
 
+  //! Map of test suite (or test case) name to skip config. Hashed, as generated configs may list tens of thousands of
+  //! test cases that are each looked up by ApplyConfig.
+  using SkipConfigurationMap = std::unordered_map<std::string, SkipConfiguration>;
+
  public:
   RuntimeConfig() = default;
   explicit RuntimeConfig(const RuntimeConfig&) = delete;
@@ -65,8 +71,11 @@ class RuntimeConfig {
   [[nodiscard]] bool enable_shutdown_on_completion() const { return enable_shutdown_on_completion_; }
   [[nodiscard]] bool enable_pgraph_region_diff() const { return enable_pgraph_region_diff_; }
   [[nodiscard]] bool skip_tests_by_default() const { return skip_tests_by_default_; }
+  [[nodiscard]] bool enable_capture_fence() const { return enable_capture_fence_; }
   [[nodiscard]] uint32_t delay_milliseconds_between_tests() const { return delay_milliseconds_between_tests_; }
   [[nodiscard]] uint32_t delay_milliseconds_before_exit() const { return delay_milliseconds_before_exit_; }
+  [[nodiscard]] uint32_t watchdog_budget_milliseconds() const { return watchdog_budget_milliseconds_; }
+  [[nodiscard]] uint32_t determinism_check_iterations() const { return determinism_check_iterations_; }
 
   [[nodiscard]] uint32_t shard_index() const { return shard_index_; }
   [[nodiscard]] uint32_t shard_count() const { return shard_count_; }
@@ -95,6 +104,7 @@ class RuntimeConfig {
   void WriteSettings(std::ostream& output) const;
   void WriteTestSuite(std::ostream& output, const std::shared_ptr<TestSuite>& suite) const;
   void WriteTestCase(std::ostream& output, const std::string& suite_name, const std::string& test_name) const;
+  static void WriteTestPattern(std::ostream& output, const std::string& pattern, SkipConfiguration config);
 #endif  // DUMP_CONFIG_FILE
 
   bool ProcessNetworkSettings(const void* parent, std::vector<std::string>& errors);
@@ -106,11 +116,17 @@ class RuntimeConfig {
   //! crash an emulator; giving more time for the log to be flushed to the filesystem.
   uint32_t delay_milliseconds_between_tests_{0};
   uint32_t delay_milliseconds_before_exit_{DEFAULT_DELAY_MILLISECONDS_BEFORE_EXIT};
+  //! Time a test without timing history may run before the watchdog assumes that it has hung. 0 disables the watchdog.
+  uint32_t watchdog_budget_milliseconds_{DEFAULT_WATCHDOG_BUDGET_MILLISECONDS};
+  //! Number of times to run each test when checking for nondeterministic output. 0 disables the check.
+  uint32_t determinism_check_iterations_{0};
   bool disable_autorun_ = DEFAULT_DISABLE_AUTORUN;
   bool enable_autorun_immediately_ = DEFAULT_AUTORUN_IMMEDIATELY;
   bool enable_shutdown_on_completion_ = DEFAULT_ENABLE_SHUTDOWN;
   bool enable_pgraph_region_diff_ = DEFAULT_ENABLE_PGRAPH_REGION_DIFF;
   bool skip_tests_by_default_ = DEFAULT_SKIP_TESTS_BY_DEFAULT;
+  //! Wait for a GPU completion fence rather than the next vblank before capturing artifacts.
+  bool enable_capture_fence_ = DEFAULT_ENABLE_CAPTURE_FENCE;
 
   uint32_t shard_index_{0};
   uint32_t shard_count_{0};
@@ -131,9 +147,12 @@ class RuntimeConfig {
   std::string output_directory_path_ = SanitizePath(DEFAULT_OUTPUT_DIRECTORY_PATH);
 
   //! Map of test suite name to skip config.
-  std::map<std::string, SkipConfiguration> configured_test_suites_;
+  SkipConfigurationMap configured_test_suites_;
   //! Map of test suite name to a map of test case to skip config.
-  std::map<std::string, std::map<std::string, SkipConfiguration>> configured_test_cases_;
+  std::unordered_map<std::string, SkipConfigurationMap> configured_test_cases_;
+  //! Glob patterns over "<suite>::<test>" names, along with the skip config of each pattern (by pattern index).
+  TestNameMatcher test_patterns_;
+  std::vector<SkipConfiguration> test_pattern_configs_;
 };
 
 #endif  // NXDK_PGRAPH_TESTS_RUNTIME_CONFIG_H
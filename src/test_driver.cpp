@@ -12,14 +12,30 @@
 #include <windows.h>
 #pragma clang diagnostic pop
 
+#include <algorithm>
+
+#include "debug_output.h"
+#include "determinism_checker.h"
+#include "logger.h"
 #include "menu_item.h"
+#include "resource_prefetcher.h"
+#include "wait_profiler.h"
 
 static constexpr auto kButtonRepeatMilliseconds = 150;
 
+// Upper bound on how long the menu loop blocks waiting for input when nothing is scheduled to change.
+static constexpr uint32_t kMaxMenuWaitMilliseconds = 1000;
+
+// Upper bound on memory held by resources that have been prefetched for the next suite but not yet claimed.
+static constexpr uint32_t kPrefetchBudgetBytes = 8 * 1024 * 1024;
+
+// Number of tests listed in the wait profile summary at the end of a full run.
+static constexpr uint32_t kWaitProfileSummaryRows = 20;
+
 TestDriver::TestDriver(TestHost &host, const std::vector<std::shared_ptr<TestSuite>> &test_suites,
                        uint32_t framebuffer_width, uint32_t framebuffer_height, bool show_options_menu,
                        bool disable_autorun, bool autorun_immediately)
-    : test_suites_(test_suites), test_host_(host) {
+    : test_suites_(test_suites), test_host_(host), redraw_scheduler_(kMaxMenuWaitMilliseconds) {
   auto on_run_all = [this]() { RunAllTestsNonInteractive(); };
   auto on_exit = [this]() { running_ = false; };
   root_menu_ = std::make_shared<MenuItemRoot>(test_suites, on_run_all, on_exit, framebuffer_width, framebuffer_height,
@@ -44,45 +60,63 @@ TestDriver::~TestDriver() {
 }
 
 void TestDriver::Run() {
-  std::map<SDL_GameControllerButton, std::chrono::time_point<std::chrono::steady_clock>> button_repeat_map;
+  std::map<SDL_GameControllerButton, MenuClock::time_point> button_repeat_map;
+  std::shared_ptr<MenuItem> drawn_menu;
 
   while (running_) {
-    SDL_Event event;
-
-    while (SDL_PollEvent(&event)) {
-      switch (event.type) {
-        case SDL_CONTROLLERDEVICEADDED:
-          OnControllerAdded(event.cdevice);
-          break;
-
-        case SDL_CONTROLLERDEVICEREMOVED:
-          OnControllerRemoved(event.cdevice);
-          break;
-
-        case SDL_CONTROLLERBUTTONDOWN: {
-          auto now = std::chrono::steady_clock::now();
-          button_repeat_map[static_cast<SDL_GameControllerButton>(event.cbutton.button)] = now;
-        } break;
-
-        case SDL_CONTROLLERBUTTONUP:
-          button_repeat_map.erase(static_cast<SDL_GameControllerButton>(event.cbutton.button));
-          OnControllerButtonEvent(event.cbutton);
-          break;
+    auto now = MenuClock::now();
+    auto wake_time = kMenuNeverRedraw;
+    for (const auto &pair : button_repeat_map) {
+      wake_time = std::min(wake_time, pair.second + std::chrono::milliseconds(kButtonRepeatMilliseconds));
+    }
 
-        default:
-          break;
-      }
+    // Sleep until there is input or the menu has something new to show, rather than redrawing it continuously.
+    SDL_Event event;
+    if (SDL_WaitEventTimeout(&event, static_cast<int>(redraw_scheduler_.GetWaitMilliseconds(now, wake_time)))) {
+      do {
+        switch (event.type) {
+          case SDL_CONTROLLERDEVICEADDED:
+            OnControllerAdded(event.cdevice);
+            break;
+
+          case SDL_CONTROLLERDEVICEREMOVED:
+            OnControllerRemoved(event.cdevice);
+            break;
+
+          case SDL_CONTROLLERBUTTONDOWN:
+            button_repeat_map[static_cast<SDL_GameControllerButton>(event.cbutton.button)] = MenuClock::now();
+            break;
+
+          case SDL_CONTROLLERBUTTONUP:
+            button_repeat_map.erase(static_cast<SDL_GameControllerButton>(event.cbutton.button));
+            OnControllerButtonEvent(event.cbutton);
+            break;
+
+          default:
+            break;
+        }
+      } while (SDL_PollEvent(&event));
     }
 
-    auto now = std::chrono::steady_clock::now();
-    for (const auto &pair : button_repeat_map) {
+    now = MenuClock::now();
+    for (auto &pair : button_repeat_map) {
       auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - pair.second).count();
-      if (elapsed > kButtonRepeatMilliseconds) {
+      if (elapsed >= kButtonRepeatMilliseconds) {
         OnButtonActivated(pair.first, true);
-        button_repeat_map[pair.first] = std::chrono::steady_clock::now();
+        pair.second = MenuClock::now();
       }
     }
 
+    if (active_menu_ != drawn_menu) {
+      drawn_menu = active_menu_;
+      redraw_scheduler_.Invalidate();
+    }
+
+    now = MenuClock::now();
+    if (!redraw_scheduler_.ConsumeRedraw(now)) {
+      continue;
+    }
+
     if (!test_host_.GetSaveResults()) {
       active_menu_->SetBackgroundColor(0xFF3E1E1E);
     } else {
@@ -90,20 +124,74 @@ void TestDriver::Run() {
     }
 
     active_menu_->Draw();
-
-    Sleep(10);
+    redraw_scheduler_.ScheduleRedraw(active_menu_->GetNextRedraw(MenuClock::now()));
   }
 }
 
 void TestDriver::RunAllTestsNonInteractive() {
+  std::vector<std::shared_ptr<TestSuite>> suites;
   for (auto &suite : test_suites_) {
-    if (suite->IsInteractiveOnly()) {
-      continue;
+    if (!suite->IsInteractiveOnly()) {
+      suites.push_back(suite);
     }
+  }
 
+  ResourcePrefetcher prefetcher(kPrefetchBudgetBytes, std::make_unique<ResourcePrefetcher::DiskFileSource>());
+  ResourcePrefetcher::SetActive(&prefetcher);
+  WaitProfiler wait_profiler;
+  WaitProfiler::SetActive(&wait_profiler);
+  std::unique_ptr<DeterminismChecker> determinism_checker;
+  if (determinism_check_iterations_) {
+    determinism_checker = std::make_unique<DeterminismChecker>(determinism_check_iterations_);
+    DeterminismChecker::SetActive(determinism_checker.get());
+  }
+  if (!suites.empty()) {
+    prefetcher.Schedule(suites.front()->PrefetchResources());
+  }
+
+  for (auto it = suites.begin(); it != suites.end(); ++it) {
+    auto &suite = *it;
     suite->Initialize();
+
+    // Anything the suite needed during Initialize has been claimed, so the next suite's resources can be read while
+    // this one renders.
+    auto next = std::next(it);
+    prefetcher.Schedule(next != suites.end() ? (*next)->PrefetchResources() : std::vector<std::string>());
+
     suite->RunAll(false);
     suite->Deinitialize();
+    suite->ReportAllocations();
+  }
+
+  ResourcePrefetcher::SetActive(nullptr);
+  auto stats = prefetcher.GetStats();
+  PrintMsg("Resource prefetch: %u hits, %u misses, %u discarded, %u bytes read, peak %u bytes held\n", stats.hits,
+           stats.misses, stats.discarded, stats.bytes_read, stats.peak_bytes_held);
+  PrintMsg("Presented %u frames\n", test_host_.GetNumFramesPresented());
+  auto &arena = test_host_.GetContiguousArena();
+  PrintMsg("Contiguous arena: peak %u of %u bytes\n", arena.GetHighWaterMark(), arena.GetCapacity());
+  if (auto fence = test_host_.GetCaptureFence()) {
+    auto &fence_stats = fence->GetStats();
+    PrintMsg("Capture fence: %u waits, %u already complete, %u timeouts\n", fence_stats.waits,
+             fence_stats.already_complete, fence_stats.timeouts);
+  }
+
+  WaitProfiler::SetActive(nullptr);
+  for (const auto &line : wait_profiler.Summarize(kWaitProfileSummaryRows)) {
+    PrintMsg("%s\n", line.c_str());
+    if (Logger::IsInitialized()) {
+      Logger::Log() << line << std::endl;
+    }
+  }
+
+  if (determinism_checker) {
+    DeterminismChecker::SetActive(nullptr);
+    for (const auto &line : determinism_checker->Summarize()) {
+      PrintMsg("%s\n", line.c_str());
+      if (Logger::IsInitialized()) {
+        Logger::Log() << line << std::endl;
+      }
+    }
   }
   running_ = false;
 }
@@ -158,6 +246,9 @@ void TestDriver::OnControllerButtonEvent(const SDL_ControllerButtonEvent &event)
 }
 
 void TestDriver::OnButtonActivated(SDL_GameControllerButton button, bool is_repeat) {
+  // Any button may change the menu or the save results indicator.
+  redraw_scheduler_.Invalidate();
+
   switch (button) {
     case SDL_CONTROLLER_BUTTON_BACK:
       OnBack(is_repeat);
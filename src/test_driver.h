@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 
+#include "menu_state.h"
 #include "test_host.h"
 #include "tests/test_suite.h"
 
@@ -33,6 +34,10 @@ class TestDriver {
   //! Runs all tests automatically without reacting to any user input.
   void RunAllTestsNonInteractive();
 
+  //! Causes RunAllTestsNonInteractive to run each test `iterations` times without saving artifacts, reporting tests
+  //! whose frames differ between runs. 0 disables the check.
+  void SetDeterminismCheckIterations(uint32_t iterations) { determinism_check_iterations_ = iterations; }
+
  private:
   void OnControllerAdded(const SDL_ControllerDeviceEvent &event);
   void OnControllerRemoved(const SDL_ControllerDeviceEvent &event);
@@ -64,6 +69,9 @@ class TestDriver {
   std::shared_ptr<MenuItem> active_menu_;
   std::shared_ptr<MenuItem> root_menu_;
   std::shared_ptr<MenuItem> options_menu_;
+  MenuRedrawScheduler redraw_scheduler_;
+
+  uint32_t determinism_check_iterations_{0};
 };
 
 #endif  // NXDK_PGRAPH_TESTS_TEST_DRIVER_H
@@ -18,12 +18,15 @@
 #include <algorithm>
 #include <utility>
 
+#include "completion_fence.h"
 #include "debug_output.h"
+#include "determinism_checker.h"
 #include "nxdk_ext.h"
 #include "pbkit_ext.h"
 #include "pushbuffer.h"
 #include "shaders/vertex_shader_program.h"
 #include "vertex_buffer.h"
+#include "wait_profiler.h"
 #include "xbox_math_d3d.h"
 #include "xbox_math_matrix.h"
 #include "xbox_math_types.h"
@@ -36,10 +39,120 @@ using namespace XboxMath;
 #define MAX_FILE_PATH_SIZE 248
 #define MAX_FILENAME_SIZE 42
 
+//! Size of the region backing AllocateContiguous, which must hold everything the most demanding suite allocates.
+static constexpr uint32_t kContiguousArenaSize = 8 * 1024 * 1024;
+
+#ifndef NV097_SET_SEMAPHORE_OFFSET
+#define NV097_SET_SEMAPHORE_OFFSET 0x00001D6C
+#endif
+
+// PBKit initializes channel 8 as the DMA_SEMAPHORE context object.
+// https://github.com/XboxDev/nxdk/blob/4171d5bfe5260c0dd2d42f4efeb9ec1d44788867/lib/pbkit/pbkit.c#L2827
+static constexpr uint32_t kDefaultSemaphoreContextChannel = 8;
+
+//! Number of times FinishDraw polls the capture fence before assuming it was lost and falling back to the vblank wait.
+static constexpr uint32_t kCaptureFenceMaxPolls = 1 << 24;
+
+/**
+ * Signals a CompletionFence by having the NV2A back end write each fence value into CPU readable memory once all
+ * preceding rendering has been retired.
+ */
+class NV2ASemaphoreFenceDevice : public CompletionFence::Device {
+ public:
+  explicit NV2ASemaphoreFenceDevice(TestHost &host) : host_(host) {
+    semaphore_ = static_cast<volatile uint32_t *>(host_.AllocateDedicatedContiguous(kSemaphoreSize, PAGE_READWRITE));
+    *semaphore_ = CompletionFence::kInvalidFence;
+    pb_create_dma_ctx(TestHost::kCaptureFenceContextChannel, DMA_CLASS_3D, reinterpret_cast<uint32_t>(semaphore_),
+                      kSemaphoreSize, &dma_ctx_);
+    pb_bind_channel(&dma_ctx_);
+  }
+
+  ~NV2ASemaphoreFenceDevice() override { host_.FreeDedicatedContiguous(const_cast<uint32_t *>(semaphore_)); }
+
+  void Signal(uint32_t value) override {
+    Pushbuffer::Begin();
+    Pushbuffer::Push(NV097_SET_CONTEXT_DMA_SEMAPHORE, dma_ctx_.ChannelID);
+    Pushbuffer::Push(NV097_SET_SEMAPHORE_OFFSET, 0);
+    Pushbuffer::Push(NV097_BACK_END_WRITE_SEMAPHORE_RELEASE, value);
+    Pushbuffer::Push(NV097_SET_CONTEXT_DMA_SEMAPHORE, kDefaultSemaphoreContextChannel);
+    Pushbuffer::End();
+  }
+
+  [[nodiscard]] uint32_t Read() const override { return *semaphore_; }
+
+ private:
+  static constexpr uint32_t kSemaphoreSize = 32;
+
+  TestHost &host_;
+  volatile uint32_t *semaphore_{nullptr};
+  struct s_CtxDma dma_ctx_ {};
+};
+
 TestHost::TestHost(std::shared_ptr<FTPLogger> ftp_logger, uint32_t framebuffer_width, uint32_t framebuffer_height,
                    uint32_t max_texture_width, uint32_t max_texture_height, uint32_t max_texture_depth)
     : NV2AState(framebuffer_width, framebuffer_height, max_texture_width, max_texture_height, max_texture_depth),
-      ftp_logger_{std::move(ftp_logger)} {}
+      ftp_logger_{std::move(ftp_logger)} {
+  contiguous_region_ = static_cast<uint8_t *>(
+      MmAllocateContiguousMemoryEx(kContiguousArenaSize, 0, MAXRAM, 0x4000, PAGE_WRITECOMBINE | PAGE_READWRITE));
+  ASSERT(contiguous_region_ && "Failed to allocate contiguous arena.");
+  contiguous_arena_ =
+      std::make_unique<ContiguousArena>(contiguous_region_, kContiguousArenaSize, &allocation_tracker_);
+}
+
+TestHost::~TestHost() {
+  SetUseCaptureFence(false);
+  contiguous_arena_.reset();
+  if (contiguous_region_) {
+    MmFreeContiguousMemory(contiguous_region_);
+  }
+}
+
+uint8_t *TestHost::AllocateContiguous(uint32_t size, uint32_t alignment) {
+  auto ret = contiguous_arena_->Allocate(size, alignment);
+  if (!ret) {
+    PrintMsg("Contiguous arena exhausted allocating %u bytes (%u of %u in use)\n", size, contiguous_arena_->GetUsed(),
+             contiguous_arena_->GetCapacity());
+    ASSERT(!"Contiguous arena exhausted.");
+  }
+  return ret;
+}
+
+void *TestHost::AllocateDedicatedContiguous(uint32_t size, uint32_t protect) {
+  auto ret = MmAllocateContiguousMemoryEx(size, 0, MAXRAM, 0, protect);
+  ASSERT(ret && "Failed to allocate dedicated contiguous memory.");
+  dedicated_allocations_[ret] = size;
+  allocation_tracker_.RecordAllocation(AllocationTracker::Kind::CONTIGUOUS, size);
+  return ret;
+}
+
+void TestHost::FreeDedicatedContiguous(void *address) {
+  auto it = dedicated_allocations_.find(address);
+  ASSERT(it != dedicated_allocations_.end() && "Attempt to free unknown dedicated contiguous memory.");
+  allocation_tracker_.RecordRelease(AllocationTracker::Kind::CONTIGUOUS, it->second);
+  dedicated_allocations_.erase(it);
+  MmFreeContiguousMemory(address);
+}
+
+// Heap allocations are prefixed with their size so that FreeHeap can account for them without a lookup. The prefix is
+// 8 bytes to preserve malloc's alignment guarantee.
+static constexpr uint32_t kHeapHeaderSize = 8;
+
+void *TestHost::AllocateHeap(uint32_t size) {
+  auto block = static_cast<uint8_t *>(malloc(size + kHeapHeaderSize));
+  ASSERT(block && "Failed to allocate heap memory.");
+  *reinterpret_cast<uint32_t *>(block) = size;
+  allocation_tracker_.RecordAllocation(AllocationTracker::Kind::HEAP, size);
+  return block + kHeapHeaderSize;
+}
+
+void TestHost::FreeHeap(void *address) {
+  if (!address) {
+    return;
+  }
+  auto block = static_cast<uint8_t *>(address) - kHeapHeaderSize;
+  allocation_tracker_.RecordRelease(AllocationTracker::Kind::HEAP, *reinterpret_cast<uint32_t *>(block));
+  free(block);
+}
 
 void TestHost::EnsureFolderExists(const std::string &folder_path) {
   if (folder_path.length() > MAX_FILE_PATH_SIZE) {
@@ -90,22 +203,33 @@ std::string TestHost::PrepareSaveFile(std::string output_directory, const std::s
 }
 
 std::string TestHost::SaveBackBuffer(const std::string &output_directory, const std::string &name) {
+  AtlasLayout::Cell region;
+  region.width = pb_back_buffer_width();
+  region.height = pb_back_buffer_height();
+  return SaveBackBufferRegion(output_directory, name, region);
+}
+
+std::string TestHost::SaveBackBufferRegion(const std::string &output_directory, const std::string &name,
+                                           const AtlasLayout::Cell &region) {
   auto target_file = PrepareSaveFile(output_directory, name);
 
-  auto buffer = pb_agp_access(pb_back_buffer());
-  auto width = static_cast<int>(pb_back_buffer_width());
-  auto height = static_cast<int>(pb_back_buffer_height());
-  auto pitch = static_cast<int>(pb_back_buffer_pitch());
+  auto buffer = static_cast<const uint8_t *>(pb_agp_access(pb_back_buffer()));
+  auto pitch = pb_back_buffer_pitch();
 
   // FIXME: Support 16bpp surfaces
-  ASSERT((pitch == width * 4) && "Expected packed 32bpp surface");
+  ASSERT((pitch == pb_back_buffer_width() * 4) && "Expected packed 32bpp surface");
+  ASSERT(region.Right() <= pb_back_buffer_width() && region.Bottom() <= pb_back_buffer_height() &&
+         "Region exceeds back buffer");
 
-  // Swizzle color channels ARGB -> ABGR
+  auto width = static_cast<int>(region.width);
+  auto height = static_cast<int>(region.height);
   unsigned int num_pixels = width * height;
-  uint32_t *pre_enc_buf = (uint32_t *)malloc(num_pixels * 4);
-  ASSERT(pre_enc_buf && "Failed to allocate pre-encode buffer");
+  auto pre_enc_buf = static_cast<uint32_t *>(AllocateHeap(num_pixels * 4));
+  AtlasLayout::ExtractCell(buffer, pitch, 4, region, reinterpret_cast<uint8_t *>(pre_enc_buf));
+
+  // Swizzle color channels ARGB -> ABGR
   for (unsigned int i = 0; i < num_pixels; i++) {
-    uint32_t c = static_cast<uint32_t *>(buffer)[i];
+    uint32_t c = pre_enc_buf[i];
     pre_enc_buf[i] = (c & 0xff00ff00) | ((c >> 16) & 0xff) | ((c & 0xff) << 16);
   }
 
@@ -113,7 +237,7 @@ std::string TestHost::SaveBackBuffer(const std::string &output_directory, const
   if (!fpng::fpng_encode_image_to_memory((void *)pre_enc_buf, width, height, 4, out_buf)) {
     ASSERT(!"Failed to encode PNG image");
   }
-  free(pre_enc_buf);
+  FreeHeap(pre_enc_buf);
 
   FILE *pFile = fopen(target_file.c_str(), "wb");
   ASSERT(pFile && "Failed to open output PNG image");
@@ -197,43 +321,122 @@ std::string TestHost::SaveRawTexture(const std::string &output_directory, const
   return target_file;
 }
 
-void TestHost::FinishDraw(bool allow_saving, const std::string &output_directory, const std::string &suite_name,
-                          const std::string &name, bool save_zbuffer) {
+void TestHost::PBKitBusyWait() {
+  WaitProfiler::ScopedWait wait(WaitProfiler::WaitPoint::PBKIT_BUSY_WAIT);
+  NV2AState::PBKitBusyWait();
+}
+
+void TestHost::WaitForPGRAPHIdle() {
+  WaitProfiler::ScopedWait wait(WaitProfiler::WaitPoint::PGRAPH_IDLE);
+  while (pb_busy()) {
+    wait.Iterate();
+  }
+}
+
+void TestHost::SleepMilliseconds(uint32_t milliseconds) {
+  WaitProfiler::ScopedWait wait(WaitProfiler::WaitPoint::SLEEP);
+  Sleep(milliseconds);
+}
+
+void TestHost::SetUseCaptureFence(bool enable) {
+  if (!enable) {
+    capture_fence_.reset();
+    capture_fence_device_.reset();
+    return;
+  }
+
+  if (!capture_fence_) {
+    capture_fence_device_ = std::make_unique<NV2ASemaphoreFenceDevice>(*this);
+    capture_fence_ = std::make_unique<CompletionFence>(*capture_fence_device_);
+  }
+}
+
+void TestHost::WaitForCaptureReady() {
+  if (capture_fence_) {
+    auto fence = capture_fence_->Insert();
+    WaitProfiler::ScopedWait wait(WaitProfiler::WaitPoint::CAPTURE_FENCE);
+    if (capture_fence_->Wait(fence, kCaptureFenceMaxPolls, [&wait]() { wait.Iterate(); })) {
+      return;
+    }
+    PrintMsg("Capture fence 0x%X timed out (last completed 0x%X), falling back to busy wait.\n", fence,
+             capture_fence_device_->Read());
+  }
+
+  PBKitBusyWait();
+
+  // TODO: See why waiting for tiles to be non-busy results in the screen not updating anymore.
+  // In theory this should wait for all tiles to be rendered before capturing.
+  WaitProfiler::ScopedWait wait(WaitProfiler::WaitPoint::VBLANK);
+  pb_wait_for_vbl();
+}
+
+bool TestHost::BeginFinishDraw(bool allow_saving) {
   bool perform_save = allow_saving && save_results_;
   if (!perform_save) {
     pb_printat(0, 55, (char *)"ns");
     pb_draw_text_screen();
   }
 
-  PBKitBusyWait();
+  auto determinism_checker = DeterminismChecker::Active();
+  bool record_signature = determinism_checker && determinism_checker->InTest();
+  if (perform_save || record_signature) {
+    WaitForCaptureReady();
+  } else {
+    PBKitBusyWait();
+  }
 
-  if (perform_save) {
-    // TODO: See why waiting for tiles to be non-busy results in the screen not updating anymore.
-    // In theory this should wait for all tiles to be rendered before capturing.
-    pb_wait_for_vbl();
+  if (record_signature) {
+    // FIXME: Support 16bpp surfaces
+    auto buffer = static_cast<const uint8_t *>(pb_agp_access(pb_back_buffer()));
+    determinism_checker->RecordFrame(DeterminismChecker::ComputeSignature(
+        buffer, pb_back_buffer_pitch(), pb_back_buffer_width(), pb_back_buffer_height(), 4));
+  }
+  return perform_save;
+}
 
-    auto output_path = SaveBackBuffer(output_directory, name);
+void TestHost::QueueArtifactUpload(const std::string &output_directory, const std::string &suite_name,
+                                   const std::string &output_path) {
+  if (ftp_logger_) {
+    auto remote_filename = suite_name + "::" + output_path.substr(output_directory.length() + 1);
+    ftp_logger_->QueuePutFile(output_path, remote_filename);
+  }
+}
 
-    if (ftp_logger_) {
-      auto remote_filename = suite_name + "::" + output_path.substr(output_directory.length() + 1);
-      ftp_logger_->QueuePutFile(output_path, remote_filename);
-    }
+void TestHost::PresentFrame() {
+  ++num_frames_presented_;
+
+  /* Swap buffers (if we can) */
+  WaitProfiler::ScopedWait wait(WaitProfiler::WaitPoint::FINISHED);
+  while (pb_finished()) {
+    /* Not ready to swap yet */
+    wait.Iterate();
+  }
+}
+
+void TestHost::FinishDraw(bool allow_saving, const std::string &output_directory, const std::string &suite_name,
+                          const std::string &name, bool save_zbuffer) {
+  if (BeginFinishDraw(allow_saving)) {
+    QueueArtifactUpload(output_directory, suite_name, SaveBackBuffer(output_directory, name));
 
     if (save_zbuffer) {
       std::string z_buffer_name = name + "_ZB";
-      auto z_buffer_output_path = SaveZBuffer(output_directory, z_buffer_name);
-
-      if (ftp_logger_) {
-        auto remote_filename = suite_name + "::" + z_buffer_output_path.substr(output_directory.length() + 1);
-        ftp_logger_->QueuePutFile(z_buffer_output_path, remote_filename);
-      }
+      QueueArtifactUpload(output_directory, suite_name, SaveZBuffer(output_directory, z_buffer_name));
     }
   }
 
-  /* Swap buffers (if we can) */
-  while (pb_finished()) {
-    /* Not ready to swap yet */
+  PresentFrame();
+}
+
+void TestHost::FinishDrawAtlas(bool allow_saving, const std::string &output_directory, const std::string &suite_name,
+                               const std::vector<AtlasCapture> &captures) {
+  if (BeginFinishDraw(allow_saving)) {
+    for (const auto &capture : captures) {
+      QueueArtifactUpload(output_directory, suite_name,
+                          SaveBackBufferRegion(output_directory, capture.name, capture.cell));
+    }
   }
+
+  PresentFrame();
 }
 
 std::string TestHost::GetDrawPrimitiveName(DrawPrimitive primitive) {
@@ -7,8 +7,14 @@
 #include <printf/printf.h>
 
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <vector>
 
+#include "allocation_tracker.h"
+#include "atlas_layout.h"
+#include "completion_fence.h"
+#include "contiguous_arena.h"
 #include "nv2astate.h"
 #include "nxdk_ext.h"
 #include "pushbuffer.h"
@@ -31,19 +37,84 @@ class VertexBuffer;
  * Provides utility methods for use by TestSuite subclasses.
  */
 class TestHost : public NV2AState {
+ public:
+  //! Names the artifact to be saved from a single cell of an atlas frame.
+  struct AtlasCapture {
+    std::string name;
+    AtlasLayout::Cell cell;
+  };
+
+ public:
+  //! Context channel reserved for the capture fence. Test suites that create their own context objects allocate them
+  //! upwards from kNextContextChannel and must stay below this channel.
+  static constexpr uint32_t kCaptureFenceContextChannel = kNextContextChannel + 16;
+
  public:
   TestHost(std::shared_ptr<FTPLogger> ftp_logger, uint32_t framebuffer_width, uint32_t framebuffer_height,
            uint32_t max_texture_width, uint32_t max_texture_height, uint32_t max_texture_depth = 4);
+  ~TestHost();
+
+  //! Waits for the pushbuffer to be fully processed. Hides NV2AState::PBKitBusyWait so that time spent waiting is
+  //! recorded by the active WaitProfiler.
+  static void PBKitBusyWait();
+  //! Spins until PGRAPH reports that it is idle.
+  static void WaitForPGRAPHIdle();
+  //! Blocks the calling thread for the given number of milliseconds.
+  static void SleepMilliseconds(uint32_t milliseconds);
 
   //! Marks drawing as completed, potentially causing artifacts (framebuffer, z/stencil-buffer) to be saved to disk.
   void FinishDraw(bool allow_saving, const std::string &output_directory, const std::string &suite_name,
                   const std::string &name, bool save_zbuffer = false);
 
+  //! Marks drawing of an atlas frame as completed, saving each of the given cells as a separate artifact before
+  //! presenting the frame.
+  void FinishDrawAtlas(bool allow_saving, const std::string &output_directory, const std::string &suite_name,
+                       const std::vector<AtlasCapture> &captures);
+
+  //! Returns the number of frames presented by FinishDraw and FinishDrawAtlas.
+  [[nodiscard]] uint32_t GetNumFramesPresented() const { return num_frames_presented_; }
+
   //! Returns the current override flag to allow/prevent artifact saving.
   [[nodiscard]] bool GetSaveResults() const { return save_results_; }
   //! Sets the override flag to prevent artifact saving during FinishDraw.
   void SetSaveResults(bool enable = true) { save_results_ = enable; }
 
+  /**
+   * Selects how FinishDraw waits for rendering to complete before saving artifacts.
+   *
+   * When enabled, a semaphore release is appended to the pushbuffer and polled until the GPU writes it back, so capture
+   * begins as soon as rendering has been retired. Otherwise (or if the fence times out) FinishDraw waits for the next
+   * vblank. PBKit must be initialized before enabling the fence.
+   */
+  void SetUseCaptureFence(bool enable = true);
+  [[nodiscard]] bool GetUseCaptureFence() const { return capture_fence_ != nullptr; }
+  //! Returns the capture fence, or nullptr if FinishDraw is using the vblank wait.
+  [[nodiscard]] const CompletionFence *GetCaptureFence() const { return capture_fence_.get(); }
+
+  /**
+   * Returns `size` bytes of write-combined, physically contiguous memory aligned to `alignment`.
+   *
+   * The memory is carved out of an arena that is reset when the current TestSuite is deinitialized, so it must not be
+   * retained across suites. Use ContiguousArena::Scope to release temporaries that are only needed by a single test.
+   */
+  uint8_t *AllocateContiguous(uint32_t size, uint32_t alignment = ContiguousArena::kDefaultAlignment);
+  //! Releases every allocation made via AllocateContiguous.
+  void ResetContiguousArena() { contiguous_arena_->Reset(); }
+  [[nodiscard]] ContiguousArena &GetContiguousArena() { return *contiguous_arena_; }
+
+  //! Allocates contiguous memory outside of the arena, for buffers that need page protection other than
+  //! write-combined (e.g., PAGE_READWRITE memory that the CPU reads back). Must be released via
+  //! FreeDedicatedContiguous.
+  void *AllocateDedicatedContiguous(uint32_t size, uint32_t protect);
+  void FreeDedicatedContiguous(void *address);
+
+  //! Allocates heap memory whose usage is attributed to the running suite. Must be released via FreeHeap.
+  void *AllocateHeap(uint32_t size);
+  void FreeHeap(void *address);
+
+  //! Returns the tracker that accounts for memory obtained through this host.
+  [[nodiscard]] AllocationTracker &GetAllocationTracker() { return allocation_tracker_; }
+
   //! Saves the given texture to the filesystem as a PNG file.
   static std::string SaveTexture(const std::string &output_directory, const std::string &name, const uint8_t *texture,
                                  uint32_t width, uint32_t height, uint32_t pitch, uint32_t bits_per_pixel,
@@ -83,12 +154,33 @@ class TestHost : public NV2AState {
  private:
   static std::string PrepareSaveFile(std::string output_directory, const std::string &filename,
                                      const std::string &ext = ".png");
-  static std::string SaveBackBuffer(const std::string &output_directory, const std::string &name);
+  std::string SaveBackBuffer(const std::string &output_directory, const std::string &name);
+  std::string SaveBackBufferRegion(const std::string &output_directory, const std::string &name,
+                                   const AtlasLayout::Cell &region);
+  //! Draws the no-save marker if needed, waits for rendering to complete, records the frame into the active
+  //! DeterminismChecker (if any), and returns true if artifacts should be saved.
+  bool BeginFinishDraw(bool allow_saving);
+  void QueueArtifactUpload(const std::string &output_directory, const std::string &suite_name,
+                           const std::string &output_path);
+  void PresentFrame();
+  //! Blocks until previously submitted rendering may be captured. Uses the capture fence in place of a full pushbuffer
+  //! drain when enabled.
+  void WaitForCaptureReady();
 
  private:
   bool save_results_{true};
+  uint32_t num_frames_presented_{0};
 
   std::shared_ptr<FTPLogger> ftp_logger_;
+
+  AllocationTracker allocation_tracker_;
+  uint8_t *contiguous_region_{nullptr};
+  std::unique_ptr<ContiguousArena> contiguous_arena_;
+  //! Size of each live AllocateDedicatedContiguous allocation, keyed by address.
+  std::map<void *, uint32_t> dedicated_allocations_;
+
+  std::unique_ptr<CompletionFence::Device> capture_fence_device_;
+  std::unique_ptr<CompletionFence> capture_fence_;
 };
 
 #endif  // NXDK_PGRAPH_TESTS_TEST_HOST_H
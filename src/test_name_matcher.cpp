@@ -0,0 +1,167 @@
+#include "test_name_matcher.h"
+
+static constexpr char kSuiteSeparator[] = "::";
+static constexpr char kWildcards[] = "*?[";
+static constexpr uint32_t kNoChild = 0;
+
+// Returns the index just past the ']' closing the character class that opens at `start`, or std::string::npos if the
+// class is unterminated. A ']' immediately following the '[' (or "[!") is taken literally.
+static size_t FindClassEnd(const std::string &pattern, size_t start) {
+  auto i = start + 1;
+  if (i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^')) {
+    ++i;
+  }
+  if (i < pattern.size() && pattern[i] == ']') {
+    ++i;
+  }
+  auto end = pattern.find(']', i);
+  return end == std::string::npos ? end : end + 1;
+}
+
+// Evaluates the character class beginning just after its '[' against `c`, advancing `pattern` past the closing ']'.
+static bool MatchClass(const char *&pattern, char c) {
+  bool negate = *pattern == '!' || *pattern == '^';
+  if (negate) {
+    ++pattern;
+  }
+
+  bool matched = false;
+  bool first = true;
+  while (*pattern && (*pattern != ']' || first)) {
+    first = false;
+    if (pattern[1] == '-' && pattern[2] && pattern[2] != ']') {
+      matched |= c >= pattern[0] && c <= pattern[2];
+      pattern += 3;
+    } else {
+      matched |= c == *pattern;
+      ++pattern;
+    }
+  }
+  if (*pattern) {
+    ++pattern;
+  }
+  return matched != negate;
+}
+
+bool TestNameMatcher::IsPattern(const std::string &text) {
+  return text.find_first_of(kWildcards) != std::string::npos || text.find(kSuiteSeparator) != std::string::npos;
+}
+
+bool TestNameMatcher::GlobMatch(const char *pattern, const char *name) {
+  // Backtracking is limited to the most recent '*', which is sufficient for globs and keeps matching linear in
+  // practice.
+  const char *star_pattern = nullptr;
+  const char *star_name = nullptr;
+
+  while (*name) {
+    if (*pattern == '*') {
+      star_pattern = ++pattern;
+      star_name = name;
+      continue;
+    }
+
+    if (*pattern == '?') {
+      ++pattern;
+      ++name;
+      continue;
+    }
+
+    if (*pattern == '[') {
+      const char *next = pattern + 1;
+      if (MatchClass(next, *name)) {
+        pattern = next;
+        ++name;
+        continue;
+      }
+    } else if (*pattern && *pattern == *name) {
+      ++pattern;
+      ++name;
+      continue;
+    }
+
+    if (!star_pattern) {
+      return false;
+    }
+    pattern = star_pattern;
+    name = ++star_name;
+  }
+
+  while (*pattern == '*') {
+    ++pattern;
+  }
+  return !*pattern;
+}
+
+bool TestNameMatcher::AddPattern(const std::string &pattern, std::string &error) {
+  if (pattern.empty()) {
+    error = "pattern is empty";
+    return false;
+  }
+
+  for (auto i = pattern.find('['); i != std::string::npos; i = pattern.find('[', i)) {
+    i = FindClassEnd(pattern, i);
+    if (i == std::string::npos) {
+      error = "unterminated character class";
+      return false;
+    }
+  }
+
+  auto normalized = pattern;
+  if (normalized.find(kSuiteSeparator) == std::string::npos) {
+    normalized += "::*";
+  }
+
+  auto prefix_length = normalized.find_first_of(kWildcards);
+  if (prefix_length == std::string::npos) {
+    prefix_length = normalized.size();
+  }
+
+  uint32_t node = 0;
+  for (size_t i = 0; i < prefix_length; ++i) {
+    auto child = FindChild(node, normalized[i]);
+    if (child == kNoChild) {
+      child = static_cast<uint32_t>(trie_.size());
+      trie_[node].children.emplace_back(normalized[i], child);
+      trie_.emplace_back();
+    }
+    node = child;
+  }
+
+  trie_[node].patterns.push_back(GetNumPatterns());
+  patterns_.push_back(pattern);
+  suffixes_.emplace_back(normalized.substr(prefix_length));
+  return true;
+}
+
+uint32_t TestNameMatcher::FindChild(uint32_t node, char c) const {
+  for (const auto &child : trie_[node].children) {
+    if (child.first == c) {
+      return child.second;
+    }
+  }
+  return kNoChild;
+}
+
+int32_t TestNameMatcher::FindLastMatch(const std::string &name) const {
+  int32_t ret = kNoMatch;
+  uint32_t node = 0;
+  for (size_t i = 0;; ++i) {
+    // Only patterns added after the best match so far can take precedence over it.
+    const auto &candidates = trie_[node].patterns;
+    for (auto it = candidates.rbegin(); it != candidates.rend() && static_cast<int32_t>(*it) > ret; ++it) {
+      if (GlobMatch(suffixes_[*it].c_str(), name.c_str() + i)) {
+        ret = static_cast<int32_t>(*it);
+        break;
+      }
+    }
+
+    if (i == name.size()) {
+      break;
+    }
+    node = FindChild(node, name[i]);
+    if (node == kNoChild) {
+      break;
+    }
+  }
+  return ret;
+}
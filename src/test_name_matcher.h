@@ -0,0 +1,67 @@
+#ifndef NXDK_PGRAPH_TESTS_TEST_NAME_MATCHER_H
+#define NXDK_PGRAPH_TESTS_TEST_NAME_MATCHER_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Matches fully qualified test names ("<suite>::<test>") against an ordered list of glob patterns.
+ *
+ * Patterns support `*` (any run of characters, including none), `?` (any single character), and `[...]` character
+ * classes such as `[a-z]` or `[!0-9]`. A pattern without a "::" separator selects entire suites, as if it were followed
+ * by "::*".
+ *
+ * Patterns are compiled once as they are added. The literal prefix of each pattern (everything before its first
+ * wildcard) is inserted into a trie, so matching a name walks the trie once and only evaluates the wildcard portion of
+ * the patterns whose prefix the name begins with.
+ */
+class TestNameMatcher {
+ public:
+  //! Returned by FindLastMatch when no pattern matches.
+  static constexpr int32_t kNoMatch = -1;
+
+  //! Returns true if the given config key should be treated as a pattern rather than the exact name of a suite.
+  static bool IsPattern(const std::string &text);
+
+  //! Returns true if `name` matches the glob `pattern` in its entirety. `pattern` must be well formed.
+  static bool GlobMatch(const char *pattern, const char *name);
+
+  /**
+   * Compiles and appends a pattern, which receives the next index (starting at 0).
+   *
+   * @param pattern - The glob to add.
+   * @param error - Set to a description of the problem if the pattern is malformed.
+   * @return true on success, false on failure
+   */
+  bool AddPattern(const std::string &pattern, std::string &error);
+
+  //! Returns the index of the most recently added pattern that matches `name`, or kNoMatch.
+  [[nodiscard]] int32_t FindLastMatch(const std::string &name) const;
+
+  [[nodiscard]] bool IsEmpty() const { return suffixes_.empty(); }
+  [[nodiscard]] uint32_t GetNumPatterns() const { return static_cast<uint32_t>(suffixes_.size()); }
+  //! Returns the pattern with the given index as it was passed to AddPattern.
+  [[nodiscard]] const std::string &GetPattern(uint32_t index) const { return patterns_[index]; }
+
+ private:
+  struct TrieNode {
+    //! Pairs of (character, index of child node).
+    std::vector<std::pair<char, uint32_t>> children;
+    //! Patterns whose literal prefix ends at this node, in ascending order.
+    std::vector<uint32_t> patterns;
+  };
+
+  [[nodiscard]] uint32_t FindChild(uint32_t node, char c) const;
+
+ private:
+  //! The patterns as given to AddPattern, retained so that configs can be written back out.
+  std::vector<std::string> patterns_;
+  //! The wildcard portion of each pattern, beginning at its first wildcard.
+  std::vector<std::string> suffixes_;
+  //! Node 0 is the root, matching the empty prefix.
+  std::vector<TrieNode> trie_ = std::vector<TrieNode>(1);
+};
+
+#endif  // NXDK_PGRAPH_TESTS_TEST_NAME_MATCHER_H
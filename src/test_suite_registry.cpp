@@ -0,0 +1,237 @@
+#include "test_suite_registry.h"
+
+#include <utility>
+
+#include "runtime_config.h"
+#include "test_host.h"
+#include "tests/alpha_func_tests.h"
+#include "tests/antialiasing_tests.h"
+#include "tests/attribute_carryover_tests.h"
+#include "tests/attribute_explicit_setter_tests.h"
+#include "tests/attribute_float_tests.h"
+#include "tests/blend_surface_tests.h"
+#include "tests/blend_tests.h"
+#include "tests/bump_env_lum_tests.h"
+#include "tests/bump_map_tests.h"
+#include "tests/clear_tests.h"
+#include "tests/clipping_precision_tests.h"
+#include "tests/color_key_tests.h"
+#include "tests/color_mask_blend_tests.h"
+#include "tests/color_zeta_disable_tests.h"
+#include "tests/color_zeta_overlap_tests.h"
+#include "tests/combiner_tests.h"
+#include "tests/context_switch_tests.h"
+#include "tests/degenerate_begin_end_tests.h"
+#include "tests/depth_clamp_tests.h"
+#include "tests/depth_format_fixed_function_tests.h"
+#include "tests/depth_format_tests.h"
+#include "tests/depth_function_tests.h"
+#include "tests/dma_corruption_around_surface_tests.h"
+#include "tests/edge_flag_tests.h"
+#include "tests/fog_carryover_tests.h"
+#include "tests/fog_exceptional_value_tests.h"
+#include "tests/fog_gen_tests.h"
+#include "tests/fog_param_tests.h"
+#include "tests/fog_tests.h"
+#include "tests/front_face_tests.h"
+#include "tests/high_vertex_count_tests.h"
+#include "tests/image_blit_tests.h"
+#include "tests/inline_array_size_mismatch.h"
+#include "tests/lighting_accumulation_tests.h"
+#include "tests/lighting_control_tests.h"
+#include "tests/lighting_normal_tests.h"
+#include "tests/lighting_range_tests.h"
+#include "tests/lighting_spotlight_tests.h"
+#include "tests/lighting_two_sided_tests.h"
+#include "tests/line_width_tests.h"
+#include "tests/material_alpha_tests.h"
+#include "tests/material_color_source_tests.h"
+#include "tests/material_color_tests.h"
+#include "tests/null_surface_tests.h"
+#include "tests/overlapping_draw_modes_tests.h"
+#include "tests/pixel_shader_tests.h"
+#include "tests/point_params_tests.h"
+#include "tests/point_size_tests.h"
+#include "tests/point_sprite_tests.h"
+#include "tests/pvideo_tests.h"
+#include "tests/set_vertex_data_tests.h"
+#include "tests/shade_model_tests.h"
+#include "tests/smoothing_tests.h"
+#include "tests/specular_back_tests.h"
+#include "tests/specular_tests.h"
+#include "tests/stencil_func_tests.h"
+#include "tests/stencil_tests.h"
+#include "tests/stipple_tests.h"
+#include "tests/surface_clip_tests.h"
+#include "tests/surface_format_tests.h"
+#include "tests/surface_pitch_tests.h"
+#include "tests/swath_width_tests.h"
+#include "tests/texgen_matrix_tests.h"
+#include "tests/texgen_tests.h"
+#include "tests/texture_2d_as_cubemap_tests.h"
+#include "tests/texture_3d_as_2d_tests.h"
+#include "tests/texture_anisotropy_tests.h"
+#include "tests/texture_border_color_tests.h"
+#include "tests/texture_border_tests.h"
+#include "tests/texture_brdf_tests.h"
+#include "tests/texture_cpu_update_tests.h"
+#include "tests/texture_cubemap_tests.h"
+#include "tests/texture_format_dxt_tests.h"
+#include "tests/texture_format_tests.h"
+#include "tests/texture_framebuffer_blit_tests.h"
+#include "tests/texture_lod_bias_tests.h"
+#include "tests/texture_matrix_tests.h"
+#include "tests/texture_palette_tests.h"
+#include "tests/texture_perspective_enable_tests.h"
+#include "tests/texture_perspective_tests.h"
+#include "tests/texture_render_target_tests.h"
+#include "tests/texture_render_update_in_place_tests.h"
+#include "tests/texture_shadow_comparator_tests.h"
+#include "tests/texture_signed_component_tests.h"
+#include "tests/texture_wrap_mode_tests.h"
+#include "tests/three_d_primitive_tests.h"
+#include "tests/two_d_line_tests.h"
+#include "tests/vertex_shader_independence_tests.h"
+#include "tests/vertex_shader_rounding_tests.h"
+#include "tests/vertex_shader_swizzle_tests.h"
+#include "tests/viewport_tests.h"
+#include "tests/volume_texture_tests.h"
+#include "tests/w_param_tests.h"
+#include "tests/wbuf_tests.h"
+#include "tests/weight_setter_tests.h"
+#include "tests/window_clip_tests.h"
+#include "tests/z_min_max_control_tests.h"
+#include "tests/zero_stride_tests.h"
+#include "tests/zpass_pixel_count_tests.h"
+
+static constexpr const char* kPGRAPHHistoryFilename = "pgraph_history.bin";
+
+void RegisterSuites(TestHost& host, RuntimeConfig& runtime_config, std::vector<std::shared_ptr<TestSuite>>& test_suites,
+                    const std::string& output_directory, std::shared_ptr<FTPLogger> ftp_logger) {
+  std::shared_ptr<PGRAPHHistoryWriter> pgraph_history;
+  if (runtime_config.enable_pgraph_region_diff()) {
+    pgraph_history = std::make_shared<PGRAPHHistoryWriter>(output_directory + "\\" + kPGRAPHHistoryFilename);
+  }
+
+  auto config = TestSuite::Config{runtime_config.enable_progress_log(), runtime_config.enable_pgraph_region_diff(),
+                                  runtime_config.delay_milliseconds_between_tests(), std::move(ftp_logger),
+                                  std::move(pgraph_history)};
+
+#define REG_TEST(CLASS_NAME)                                                   \
+  {                                                                            \
+    auto suite = std::make_shared<CLASS_NAME>(host, output_directory, config); \
+    test_suites.push_back(suite);                                              \
+  }
+
+  // LightingNormalTests must be the first suite run for valid results. The first test in the suite depends on having a
+  // clean initial state.
+  REG_TEST(LightingNormalTests)
+
+  // Remaining tests should be alphabetized.
+  // -- Begin REG_TEST --
+
+  REG_TEST(AlphaFuncTests)
+  REG_TEST(AntialiasingTests)
+  REG_TEST(AttributeCarryoverTests)
+  REG_TEST(AttributeExplicitSetterTests)
+  REG_TEST(AttributeFloatTests)
+  REG_TEST(BlendSurfaceTests)
+  REG_TEST(BlendTests)
+  REG_TEST(BumpEnvLumTests)
+  REG_TEST(BumpMapTests)
+  REG_TEST(ClearTests)
+  REG_TEST(ClippingPrecisionTests)
+  REG_TEST(ColorKeyTests)
+  REG_TEST(ColorMaskBlendTests)
+  REG_TEST(ColorZetaDisableTests)
+  REG_TEST(ColorZetaOverlapTests)
+  REG_TEST(CombinerTests)
+  REG_TEST(ContextSwitchTests)
+  REG_TEST(DegenerateBeginEndTests)
+  REG_TEST(DepthClampTests)
+  REG_TEST(DepthFormatFixedFunctionTests)
+  REG_TEST(DepthFormatTests)
+  REG_TEST(DepthFunctionTests)
+  REG_TEST(DMACorruptionAroundSurfaceTests)
+  REG_TEST(EdgeFlagTests)
+  REG_TEST(FogCarryoverTests)
+  REG_TEST(FogCustomShaderTests)
+  REG_TEST(FogExceptionalValueTests)
+  REG_TEST(FogGenTests)
+  REG_TEST(FogInfiniteFogCoordinateTests)
+  REG_TEST(FogParamTests)
+  REG_TEST(FogTests)
+  REG_TEST(FogVec4CoordTests)
+  REG_TEST(FrontFaceTests)
+  REG_TEST(HighVertexCountTests)
+  REG_TEST(ImageBlitTests)
+  REG_TEST(InlineArraySizeMismatchTests)
+  REG_TEST(LightingAccumulationTests)
+  REG_TEST(LightingControlTests)
+  REG_TEST(LightingRangeTests)
+  REG_TEST(LightingSpotlightTests)
+  REG_TEST(LightingTwoSidedTests)
+  REG_TEST(LineWidthTests)
+  REG_TEST(MaterialAlphaTests)
+  REG_TEST(MaterialColorSourceTests)
+  REG_TEST(MaterialColorTests)
+  REG_TEST(NullSurfaceTests)
+  REG_TEST(OverlappingDrawModesTests)
+  REG_TEST(PixelShaderTests)
+  REG_TEST(PointParamsTests)
+  REG_TEST(PointSizeTests)
+  REG_TEST(PointSpriteTests)
+  REG_TEST(PvideoTests)
+  REG_TEST(SetVertexDataTests)
+  REG_TEST(ShadeModelTests)
+  REG_TEST(SmoothingTests)
+  REG_TEST(SpecularBackTests)
+  REG_TEST(SpecularTests)
+  REG_TEST(StencilFuncTests)
+  REG_TEST(StencilTests)
+  REG_TEST(StippleTests)
+  REG_TEST(SurfaceClipTests)
+  REG_TEST(SurfaceFormatTests)
+  REG_TEST(SurfacePitchTests)
+  REG_TEST(SwathWidthTests)
+  REG_TEST(TexgenMatrixTests)
+  REG_TEST(TexgenTests)
+  REG_TEST(Texture2DAsCubemapTests)
+  REG_TEST(Texture3DAs2DTests)
+  REG_TEST(TextureAnisotropyTests)
+  REG_TEST(TextureBorderColorTests)
+  REG_TEST(TextureBorderTests)
+  REG_TEST(TextureBRDFTests)
+  REG_TEST(TextureCPUUpdateTests)
+  REG_TEST(TextureCubemapTests)
+  REG_TEST(TextureFormatDXTTests)
+  REG_TEST(TextureFormatTests)
+  REG_TEST(TextureFramebufferBlitTests)
+  REG_TEST(TextureLodBiasTests)
+  REG_TEST(TextureMatrixTests)
+  REG_TEST(TexturePaletteTests)
+  REG_TEST(TexturePerspectiveEnableTests)
+  REG_TEST(TexturePerspectiveTests)
+  REG_TEST(TextureRenderTargetTests)
+  REG_TEST(TextureRenderUpdateInPlaceTests)
+  REG_TEST(TextureShadowComparatorTests)
+  REG_TEST(TextureSignedComponentTests)
+  REG_TEST(TextureWrapModeTests)
+  REG_TEST(ThreeDPrimitiveTests)
+  REG_TEST(TwoDLineTests)
+  REG_TEST(VertexShaderIndependenceTests)
+  REG_TEST(VertexShaderRoundingTests)
+  REG_TEST(VertexShaderSwizzleTests)
+  REG_TEST(ViewportTests)
+  REG_TEST(VolumeTextureTests)
+  REG_TEST(WBufTests)
+  REG_TEST(WeightSetterTests)
+  REG_TEST(WindowClipTests)
+  REG_TEST(WParamTests)
+  REG_TEST(ZeroStrideTests)
+  REG_TEST(ZMinMaxControlTests)
+  REG_TEST(ZPassPixelCountTests)
+  // -- End REG_TEST --
+
+#undef REG_TEST
+}
@@ -0,0 +1,22 @@
+#ifndef NXDK_PGRAPH_TESTS_TEST_SUITE_REGISTRY_H
+#define NXDK_PGRAPH_TESTS_TEST_SUITE_REGISTRY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class FTPLogger;
+class RuntimeConfig;
+class TestHost;
+class TestSuite;
+
+/**
+ * Instantiates every known TestSuite, in execution order, and appends it to `test_suites`.
+ *
+ * This is shared between the Xbox executable and the host recording runner so that both always see the same set of
+ * suites.
+ */
+void RegisterSuites(TestHost& host, RuntimeConfig& runtime_config, std::vector<std::shared_ptr<TestSuite>>& test_suites,
+                    const std::string& output_directory, std::shared_ptr<FTPLogger> ftp_logger);
+
+#endif  // NXDK_PGRAPH_TESTS_TEST_SUITE_REGISTRY_H
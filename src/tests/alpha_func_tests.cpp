@@ -4,6 +4,13 @@
 
 #include "shaders/passthrough_vertex_shader.h"
 
+#ifdef ENABLE_ATLAS_BATCHING
+// Each batched case draws four 16 pixel tall bands, allowing all of the cases to fit within a single frame.
+static constexpr uint32_t kBatchedCellWidth = 128;
+static constexpr uint32_t kBatchedCellHeight = 64;
+static constexpr float kBatchedBandHeight = 16.f;
+#endif
+
 struct TestConfig {
   const char* name;
   uint32_t alpha_func;
@@ -77,17 +84,21 @@ static const TestConfig testConfigs[]{
  */
 AlphaFuncTests::AlphaFuncTests(TestHost& host, std::string output_dir, const Config& config)
     : TestSuite(host, std::move(output_dir), "Alpha func", config) {
-  for (auto testConfig : testConfigs) {
-    {
-      std::string test_name = testConfig.name;
-      test_name += "_Enabled";
-      tests_[test_name] = [this, testConfig, test_name]() { Test(test_name, testConfig.alpha_func, true); };
-    }
+#ifdef ENABLE_ATLAS_BATCHING
+  EnableAtlasBatching(kBatchedCellWidth, kBatchedCellHeight, 0xFF222322);
+#endif
 
-    {
+  for (auto testConfig : testConfigs) {
+    for (auto enable : {true, false}) {
       std::string test_name = testConfig.name;
-      test_name += "_Disabled";
-      tests_[test_name] = [this, testConfig, test_name]() { Test(test_name, testConfig.alpha_func, false); };
+      test_name += enable ? "_Enabled" : "_Disabled";
+#ifdef ENABLE_ATLAS_BATCHING
+      AddBatchedTest(test_name, [this, testConfig, enable](const AtlasLayout::Cell& cell) {
+        TestBatched(cell, testConfig.alpha_func, enable);
+      });
+#else
+      tests_[test_name] = [this, testConfig, test_name, enable]() { Test(test_name, testConfig.alpha_func, enable); };
+#endif
     }
   }
 }
@@ -107,8 +118,11 @@ void AlphaFuncTests::Initialize() {
 }
 
 void AlphaFuncTests::Test(const std::string& name, uint32_t alpha_func, bool enable) {
+  const auto kFBWidth = host_.GetFramebufferWidthF();
   const auto kFBHeight = host_.GetFramebufferHeightF();
   const auto kTop = (kFBHeight - 256.f) / 3.f * 2.f;
+  const auto kLeft = (kFBWidth - 512.f) / 2.f;
+  const auto kRight = kLeft + 512.f;
 
   host_.PrepareDraw(0xFF222322);
 
@@ -116,18 +130,17 @@ void AlphaFuncTests::Test(const std::string& name, uint32_t alpha_func, bool ena
   host_.SetAlphaFunc(enable, alpha_func);
   auto top = kTop;
   auto bottom = top + 64.f;
-  Draw(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, top, bottom);
+  Draw(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, kLeft, top, kRight, bottom);
   top = bottom;
   bottom += 64.f;
-  Draw(0.0f, 0.0f, 1.0f, 1.0f, 0.0f, top, bottom);
+  Draw(0.0f, 0.0f, 1.0f, 1.0f, 0.0f, kLeft, top, kRight, bottom);
   top = bottom;
   bottom += 64.f;
-  Draw(0.0f, 1.0f, 0.0f, 0.495f, 0.505f, top, bottom);
+  Draw(0.0f, 1.0f, 0.0f, 0.495f, 0.505f, kLeft, top, kRight, bottom);
 
   top = bottom;
   bottom += 32.f;
   {
-    const auto kFBWidth = host_.GetFramebufferWidthF();
     host_.Begin(TestHost::PRIMITIVE_QUADS);
     host_.SetDiffuse(0x7FFFFFFF);
     host_.SetVertex(0.f, top, 0.1f, 1.0f);
@@ -151,21 +164,47 @@ void AlphaFuncTests::Test(const std::string& name, uint32_t alpha_func, bool ena
   FinishDraw(name);
 }
 
-void AlphaFuncTests::Draw(float red, float green, float blue, float left_alpha, float right_alpha, float top,
-                          float bottom) const {
-  const auto kFBWidth = host_.GetFramebufferWidthF();
+#ifdef ENABLE_ATLAS_BATCHING
+void AlphaFuncTests::TestBatched(const AtlasLayout::Cell& cell, uint32_t alpha_func, bool enable) {
+  const auto kLeft = static_cast<float>(cell.left);
+  const auto kRight = static_cast<float>(cell.Right());
 
-  const auto kLeft = (kFBWidth - 512.f) / 2.f;
-  const auto kRight = kLeft + 512.f;
+  host_.SetAlphaReference(0x7F);
+  host_.SetAlphaFunc(enable, alpha_func);
+  auto top = static_cast<float>(cell.top);
+  auto bottom = top + kBatchedBandHeight;
+  Draw(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, kLeft, top, kRight, bottom);
+  top = bottom;
+  bottom += kBatchedBandHeight;
+  Draw(0.0f, 0.0f, 1.0f, 1.0f, 0.0f, kLeft, top, kRight, bottom);
+  top = bottom;
+  bottom += kBatchedBandHeight;
+  Draw(0.0f, 1.0f, 0.0f, 0.495f, 0.505f, kLeft, top, kRight, bottom);
+  top = bottom;
+  bottom += kBatchedBandHeight;
+  host_.Begin(TestHost::PRIMITIVE_QUADS);
+  host_.SetDiffuse(0x7FFFFFFF);
+  host_.SetVertex(kLeft, top, 0.1f, 1.0f);
+  host_.SetVertex(kRight, top, 0.1f, 1.0f);
+  host_.SetVertex(kRight, bottom, 0.1f, 1.0f);
+  host_.SetVertex(kLeft, bottom, 0.1f, 1.0f);
+  host_.End();
 
+  // Match Test, which leaves alpha testing disabled for whatever is drawn next.
+  host_.SetAlphaFunc(false);
+}
+#endif
+
+void AlphaFuncTests::Draw(float red, float green, float blue, float left_alpha, float right_alpha, float left,
+                          float top, float right, float bottom) const {
   host_.Begin(TestHost::PRIMITIVE_QUADS);
   host_.SetDiffuse(red, green, blue, left_alpha);
-  host_.SetVertex(kLeft, top, 0.1f, 1.0f);
+  host_.SetVertex(left, top, 0.1f, 1.0f);
   host_.SetDiffuse(red, green, blue, right_alpha);
-  host_.SetVertex(kRight, top, 0.1f, 1.0f);
+  host_.SetVertex(right, top, 0.1f, 1.0f);
   host_.SetDiffuse(red, green, blue, right_alpha);
-  host_.SetVertex(kRight, bottom, 0.1f, 1.0f);
+  host_.SetVertex(right, bottom, 0.1f, 1.0f);
   host_.SetDiffuse(red, green, blue, left_alpha);
-  host_.SetVertex(kLeft, bottom, 0.1f, 1.0f);
+  host_.SetVertex(left, bottom, 0.1f, 1.0f);
   host_.End();
 }
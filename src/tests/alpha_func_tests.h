@@ -3,6 +3,7 @@
 
 #include <string>
 
+#include "configure.h"
 #include "test_host.h"
 #include "test_suite.h"
 
@@ -17,8 +18,13 @@ class AlphaFuncTests : public TestSuite {
 
  private:
   void Test(const std::string &name, uint32_t alpha_func, bool enable);
+#ifdef ENABLE_ATLAS_BATCHING
+  //! Renders a reduced version of Test into a single atlas cell, without the text overlay.
+  void TestBatched(const AtlasLayout::Cell &cell, uint32_t alpha_func, bool enable);
+#endif
 
-  void Draw(float red, float green, float blue, float left_alpha, float right_alpha, float top, float bottom) const;
+  void Draw(float red, float green, float blue, float left_alpha, float right_alpha, float left, float top,
+            float right, float bottom) const;
 };
 
 #endif  // ALPHAFUNCTESTS_H
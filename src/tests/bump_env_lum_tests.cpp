@@ -145,9 +145,7 @@ void BumpEnvLumTests::Test(const TextureFormatInfo &texture_format, bool cross_o
     host_.SetVertex(left, bottom, 1.0f);
     host_.End();
 
-    while (pb_busy()) {
-      /* Wait for completion... */
-    }
+    TestHost::WaitForPGRAPHIdle();
   };
 
   int w = host_.GetFramebufferWidth();
@@ -151,9 +151,7 @@ void BumpMapTests::Test(const TextureFormatInfo &texture_format, bool cross_on_b
     host_.SetVertex(left, bottom, 1.0f);
     host_.End();
 
-    while (pb_busy()) {
-      /* Wait for completion... */
-    }
+    TestHost::WaitForPGRAPHIdle();
   };
 
   DrawRectangles(texture_format, 'B', 'G', cross_on_blue, rotate90, draw);
@@ -290,9 +288,7 @@ void BumpMapTests::Test16bit(const TextureFormatInfo &texture_format, bool cross
     host_.SetVertex(left, bottom, 1.0f);
     host_.End();
 
-    while (pb_busy()) {
-      /* Wait for completion... */
-    }
+    TestHost::WaitForPGRAPHIdle();
   };
 
   DrawRectangles(texture_format, 'G', 'A', cross_on_blue, false, draw);
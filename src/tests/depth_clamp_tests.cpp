@@ -139,9 +139,7 @@ void DepthClampTests::Test(bool w_buffered, bool clamp, bool zbias, bool full_ra
     host_.End();
   }
 
-  while (pb_busy()) {
-    /* Wait for completion... */
-  }
+  TestHost::WaitForPGRAPHIdle();
 
   float zbias_value = zbias ? (w_buffered ? kWBufferZBias : kZBias) : 0.0f;
 
@@ -264,9 +262,7 @@ void DepthClampTests::TestEqualDepth(bool w_buffered, float ofs) {
     host_.End();
   }
 
-  while (pb_busy()) {
-    /* Wait for completion... */
-  }
+  TestHost::WaitForPGRAPHIdle();
 
   {
     Pushbuffer::Begin();
@@ -154,10 +154,11 @@ static void ReadRawRGBAIntoBuffer(const char *filename, void *buffer, uint32_t l
                       buffer,         // Buffer
                       length,         // Length
                       &byte_offset);
-  ASSERT(status == STATUS_PENDING);
+  // The read may be queued (STATUS_PENDING) or complete synchronously; either way the status block is polled below.
+  ASSERT(NT_SUCCESS(status));
 
   while (status_block.Status == STATUS_PENDING) {
-    Sleep(1);
+    TestHost::SleepMilliseconds(1);
   }
 
   NtClose(handle);
@@ -1,9 +1,9 @@
 #include "image_blit_tests.h"
 
-#include <SDL_image.h>
 #include <pbkit/pbkit.h>
 #include <texture_generator.h>
 
+#include "compiled_texture.h"
 #include "debug_output.h"
 #include "nxdk_ext.h"
 #include "pbkit_ext.h"
@@ -27,6 +27,10 @@ static constexpr uint32_t SUBCH_CLASS_12 = SUBCH_CLASS_19 + 1;
 // Subchannel reserved for interaction with the class 72 channel.
 static constexpr uint32_t SUBCH_CLASS_72 = SUBCH_CLASS_12 + 1;
 
+// Produced from resources/image_blit/TestImage.png by the compiled_assets target in src/CMakeLists.txt.
+static constexpr char kCompiledAssetsDirectory[] = "D:\\compiled_assets";
+static constexpr char kTestImageAsset[] = "image_blit/TestImage.png";
+
 static constexpr char kDirtyOverlappedDestSurfaceTest[] = "DirtyOverlappedDestSurf";
 static constexpr char kBlitRenderBlitTest[] = "BlitRenderBlit";
 #ifdef ENABLE_OVERLAP_FIFO_TEST
@@ -246,20 +250,21 @@ void ImageBlitTests::Initialize() {
   host_.SetXDKDefaultViewportAndFixedFunctionMatrices();
   SetDefaultTextureFormat();
 
-  SDL_Surface* temp = IMG_Load("D:\\image_blit\\TestImage.png");
-  ASSERT(temp);
-  SDL_Surface* test_image = SDL_ConvertSurfaceFormat(temp, SDL_PIXELFORMAT_BGRA32, 0);
-  SDL_FreeSurface(temp);
-
-  image_pitch_ = test_image->pitch;
-  image_width_ = test_image->w;
-  image_height_ = test_image->h;
-  uint32_t image_bytes = image_pitch_ * image_height_;
+  // The compiled blob already holds linear A8R8G8B8 texels, so it is read directly into the DMA source buffer.
+  AssetManifest manifest;
+  std::string error;
+  if (!manifest.Load(kCompiledAssetsDirectory, error) ||
+      !manifest.LoadTexture(
+          kTestImageAsset, [this](uint32_t size) { return host_.AllocateContiguous(size); }, compiled_blob_, error)) {
+    PrintMsg("Failed to load %s: %s\n", kTestImageAsset, error.c_str());
+    ASSERT(!"Failed to load compiled test image");
+  }
 
-  source_image_ = static_cast<uint8_t*>(
-      MmAllocateContiguousMemoryEx(image_bytes, 0, MAXRAM, 0x1000, PAGE_WRITECOMBINE | PAGE_READWRITE));
-  memcpy(source_image_, test_image->pixels, image_bytes);
-  SDL_FreeSurface(test_image);
+  auto header = reinterpret_cast<const CompiledTexture::Header*>(compiled_blob_);
+  image_pitch_ = header->pitch;
+  image_width_ = header->width;
+  image_height_ = header->height;
+  source_image_ = compiled_blob_ + header->level_offsets[0];
 
   // TODO: Provide a mechanism to find the next unused channel.
   auto channel = kNextContextChannel;
@@ -285,16 +290,19 @@ void ImageBlitTests::Initialize() {
 
   pb_create_dma_ctx(channel++, DMA_CLASS_3D, 0, MAXRAM, &render_target_dma_ctx_);
   pb_bind_channel(&render_target_dma_ctx_);
+  ASSERT(channel <= TestHost::kCaptureFenceContextChannel && "Context channel collides with the capture fence.");
 }
 
 void ImageBlitTests::Deinitialize() {
-  if (source_image_) {
-    MmFreeContiguousMemory(source_image_);
-    source_image_ = nullptr;
-  }
+  compiled_blob_ = nullptr;
+  source_image_ = nullptr;
   TestSuite::Deinitialize();
 }
 
+std::vector<std::string> ImageBlitTests::PrefetchResources() const {
+  return {AssetManifest::BlobPath(kCompiledAssetsDirectory, kTestImageAsset)};
+}
+
 void ImageBlitTests::ImageBlitWithinPushBlock(uint32_t operation, uint32_t beta, uint32_t source_channel,
                                               uint32_t destination_channel, uint32_t surface_format,
                                               uint32_t source_pitch, uint32_t destination_pitch, uint32_t source_offset,
@@ -496,9 +504,8 @@ void ImageBlitTests::TestBlitPastWidth(const std::string& name) {
   static constexpr auto kBlitTargetTotalSize = kBlitTargetSize + kBlitTargetGuardSize;
   static constexpr auto kBlitTargetAlignedSize = (kBlitTargetTotalSize + 0x3FFF) & 0xFFFFC000;
 
-  auto target_buffer =
-      static_cast<uint8_t*>(MmAllocateContiguousMemoryEx(kBlitTargetAlignedSize, 0, 0x03FFB000, 0x4000, 0x404));
-  assert(target_buffer);
+  ContiguousArena::Scope scope(host_.GetContiguousArena());
+  auto target_buffer = host_.AllocateContiguous(kBlitTargetAlignedSize, 0x4000);
   pb_set_dma_address(&render_target_dma_ctx_, nullptr, MAXRAM);
   pb_assign_tile(0, VRAM_ADDR(target_buffer), kBlitTargetSize, kBlitTargetPitch, 0, 0, 1);
 
@@ -579,8 +586,6 @@ void ImageBlitTests::TestBlitPastWidth(const std::string& name) {
 
   host_.PBKitBusyWait();
   set_crash_register(0x880, old_crash_register_value);
-
-  MmFreeContiguousMemory(target_buffer);
 }
 
 void ImageBlitTests::TestDirtyOverlappedDestinationSurface() {
@@ -25,6 +25,7 @@ class ImageBlitTests : public TestSuite {
 
   void Initialize() override;
   void Deinitialize() override;
+  [[nodiscard]] std::vector<std::string> PrefetchResources() const override;
 
  private:
   void Test(const BlitTest& test);
@@ -56,6 +57,9 @@ class ImageBlitTests : public TestSuite {
   uint32_t image_pitch_{0};
   uint32_t image_width_{0};
   uint32_t image_height_{0};
+  //! Compiled TestImage blob, including its CompiledTexture::Header.
+  uint8_t* compiled_blob_{nullptr};
+  //! Level 0 texels within `compiled_blob_`.
   uint8_t* source_image_{nullptr};
 
   struct s_CtxDma null_ctx_{};
@@ -27,6 +27,7 @@ class LightingAccumulationTests : public TestSuite {
 
   void Deinitialize() override;
   void Initialize() override;
+  [[nodiscard]] std::vector<std::string> PrefetchResources() const override;
 
  private:
   //! Tests the behavior of multiple lights on a mesh.
@@ -10,6 +10,7 @@
 #include "models/light_control_test_mesh_sphere_model.h"
 #include "models/light_control_test_mesh_suzanne_model.h"
 #include "models/light_control_test_mesh_torus_model.h"
+#include "models/mesh_file.h"
 #include "pbkit_ext.h"
 #include "shaders/fixed_function_approximation_shader.h"
 #include "shaders/passthrough_vertex_shader.h"
@@ -189,6 +190,16 @@ void LightingControlTests::Deinitialize() {
   vertex_buffer_torus_.reset();
 }
 
+std::vector<std::string> LightingControlTests::PrefetchResources() const {
+  return MeshFile::UncachedPaths({
+      LightControlTestMeshConeModel::GetMeshFilePath(),
+      LightControlTestMeshCylinderModel::GetMeshFilePath(),
+      LightControlTestMeshSphereModel::GetMeshFilePath(),
+      LightControlTestMeshSuzanneModel::GetMeshFilePath(),
+      LightControlTestMeshTorusModel::GetMeshFilePath(),
+  });
+}
+
 void LightingControlTests::CreateGeometry() {
   // SET_COLOR_MATERIAL below causes per-vertex diffuse color to be ignored entirely.
   vector_t diffuse{0.f, 0.f, 0.0f, 0.75f};
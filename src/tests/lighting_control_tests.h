@@ -61,6 +61,7 @@ class LightingControlTests : public TestSuite {
 
   void Deinitialize() override;
   void Initialize() override;
+  [[nodiscard]] std::vector<std::string> PrefetchResources() const override;
 
  private:
   //! Tests the behavior of SET_LIGHT_CONTROL.
@@ -5,6 +5,7 @@
 
 #include "debug_output.h"
 #include "models/flat_mesh_grid_model.h"
+#include "models/mesh_file.h"
 #include "pbkit_ext.h"
 #include "shaders/passthrough_vertex_shader.h"
 #include "test_host.h"
@@ -84,6 +85,10 @@ LightingRangeTests::LightingRangeTests(TestHost& host, std::string output_dir, c
 
 void LightingRangeTests::Deinitialize() { vertex_buffer_mesh_.reset(); }
 
+std::vector<std::string> LightingRangeTests::PrefetchResources() const {
+  return MeshFile::UncachedPaths({FlatMeshGridModel::GetMeshFilePath()});
+}
+
 void LightingRangeTests::CreateGeometry() {
   // SET_COLOR_MATERIAL below causes per-vertex diffuse color to be ignored entirely.
   vector_t diffuse{0.f, 0.f, 0.0f, 0.f};
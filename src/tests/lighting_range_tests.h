@@ -30,6 +30,7 @@ class LightingRangeTests : public TestSuite {
 
   void Deinitialize() override;
   void Initialize() override;
+  [[nodiscard]] std::vector<std::string> PrefetchResources() const override;
 
  private:
   //! Tests the behavior of NV097_SET_LIGHT_LOCAL_RANGE.
@@ -5,6 +5,7 @@
 #include "debug_output.h"
 #include "models/flat_mesh_grid_model.h"
 #include "models/light_control_test_mesh_cylinder_model.h"
+#include "models/mesh_file.h"
 #include "pbkit_ext.h"
 #include "test_host.h"
 #include "texture_generator.h"
@@ -170,6 +171,13 @@ void LightingSpotlightTests::Deinitialize() {
   TestSuite::Deinitialize();
 }
 
+std::vector<std::string> LightingSpotlightTests::PrefetchResources() const {
+  return MeshFile::UncachedPaths({
+      FlatMeshGridModel::GetMeshFilePath(),
+      LightControlTestMeshCylinderModel::GetMeshFilePath(),
+  });
+}
+
 void LightingSpotlightTests::CreateGeometry() {
   // SET_COLOR_MATERIAL below causes per-vertex diffuse color to be ignored entirely.
   vector_t diffuse{1.f, 0.f, 1.f, 1.f};
@@ -69,6 +69,7 @@ class LightingSpotlightTests : public TestSuite {
 
   void Initialize() override;
   void Deinitialize() override;
+  [[nodiscard]] std::vector<std::string> PrefetchResources() const override;
 
  private:
   void Test(const std::string& name, const Spotlight& light);
@@ -82,8 +82,8 @@ void PixelShaderTests::Initialize() {
 
   host_.SetXDKDefaultViewportAndFixedFunctionMatrices();
 
-  water_bump_map_.LoadPNG("D:\\pixel_shader\\water_bump_map.png");
-  bump_map_test_image_.LoadPNG("D:\\pixel_shader\\bump_map_test_image.png");
+  water_bump_map_.LoadPNG("D:\\pixel_shader\\water_bump_map.png", host_.GetContiguousArena());
+  bump_map_test_image_.LoadPNG("D:\\pixel_shader\\bump_map_test_image.png", host_.GetContiguousArena());
 }
 
 void PixelShaderTests::TestPassthrough() {
@@ -87,23 +87,17 @@ void PvideoTests::Initialize() {
 
   // Twice the actual space needed is allocated to facilitate tests with pitch > compact.
   const uint32_t size = host_.GetFramebufferWidth() * 4 * host_.GetFramebufferHeight();
-  video_ = (uint8_t *)MmAllocateContiguousMemory(size);
+  video_ = host_.AllocateContiguous(size);
   memset(video_, 0x7F, size);
 
-  video2_ = (uint8_t *)MmAllocateContiguousMemory(size);
+  video2_ = host_.AllocateContiguous(size);
   memset(video2_, 0x7F, size);
 }
 
 void PvideoTests::Deinitialize() {
   TestSuite::Deinitialize();
-  if (video_) {
-    MmFreeContiguousMemory(video_);
-    video_ = nullptr;
-  }
-  if (video2_) {
-    MmFreeContiguousMemory(video2_);
-    video2_ = nullptr;
-  }
+  video_ = nullptr;
+  video2_ = nullptr;
 }
 
 static void SetVideoFrameCR8YB8CB8YA8(uint8_t *dest, const void *pixels, uint32_t width, uint32_t height) {
@@ -229,7 +223,7 @@ void PvideoTests::TestStopBehavior() {
 
   for (uint32_t i = 0; i < 30; ++i) {
     DrawFullscreenOverlay();
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -292,7 +286,7 @@ void PvideoTests::TestAlternateStopBehavior() {
 
   FinishDrawNoSave(kStopBehaviorTest);
 
-  Sleep(2000);
+  TestHost::SleepMilliseconds(2000);
 
   PvideoTeardown();
 }
@@ -308,7 +302,7 @@ void PvideoTests::TestSizeInMaxUnityDeltas() {
                                         host_.GetFramebufferHeight());
   for (uint32_t i = 0; i < 30; ++i) {
     DrawFullscreenOverlay();
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Setting size_in to 0xFFFFFFFF, out_size to fullscreen, dI/dO unity...\n");
@@ -329,7 +323,7 @@ void PvideoTests::TestSizeInMaxUnityDeltas() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -351,7 +345,7 @@ void PvideoTests::TestSizeInMaxLargeDelta() {
                                         host_.GetFramebufferHeight());
   for (uint32_t i = 0; i < 30; ++i) {
     DrawFullscreenOverlay();
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Setting size_in to 0xFFFFFFFF, out_size to fullscreen, dI/dO implies larger...\n");
@@ -372,7 +366,7 @@ void PvideoTests::TestSizeInMaxLargeDelta() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -394,7 +388,7 @@ void PvideoTests::TestSizeInMaxSmallDelta() {
                                         host_.GetFramebufferHeight());
   for (uint32_t i = 0; i < 30; ++i) {
     DrawFullscreenOverlay();
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Setting size_in to 0xFFFFFFFF, out_size to fullscreen, dI/dO implies smaller...\n");
@@ -415,7 +409,7 @@ void PvideoTests::TestSizeInMaxSmallDelta() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -450,7 +444,7 @@ void PvideoTests::TestSizeMaxOutSmallUnityDeltas() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -485,7 +479,7 @@ void PvideoTests::TestSizeMaxOutSmallCorrectDeltas() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -519,7 +513,7 @@ void PvideoTests::TestSizeInLargerThanSizeOutUnityDeltas() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -553,7 +547,7 @@ void PvideoTests::TestSizeInLargerThanSizeOutCorrectDeltas() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -586,7 +580,7 @@ void PvideoTests::TestPALIntoNTSC() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -620,7 +614,7 @@ void PvideoTests::TestSizeInSmallerThanSizeOutUnityDeltas() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -654,7 +648,7 @@ void PvideoTests::TestSizeInSmallerThanSizeOutCorrectDeltas() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -688,7 +682,7 @@ void PvideoTests::TestPitchLessThanCompact() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -720,7 +714,7 @@ void PvideoTests::TestPitchLargerThanCompact() {
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -772,7 +766,7 @@ void PvideoTests::TestPitch() {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
 
-    Sleep(250);
+    TestHost::SleepMilliseconds(250);
   }
 
   DbgPrint("Stopping video overlay\n");
@@ -899,7 +893,7 @@ void PvideoTests::TestColorKey() {
         SetPvideoInterruptEnabled(true, false);
         SetPvideoBuffer(true, false);
 
-        Sleep(33);
+        TestHost::SleepMilliseconds(33);
       }
 
       DbgPrint("Stopping video overlay\n");
@@ -954,7 +948,7 @@ void PvideoTests::TestSimpleFullscreenOverlay0() {
 
   SetPvideoBuffer(true, false);
 
-  Sleep(33 * 30);
+  TestHost::SleepMilliseconds(33 * 30);
 
   DbgPrint("Stopping video overlay\n");
   PvideoTeardown();
@@ -995,9 +989,9 @@ void PvideoTests::TestOverlay1() {
 
   SetPvideoInterruptEnabled(false, true);
   SetPvideoBuffer(false, true);
-  Sleep(3000);
+  TestHost::SleepMilliseconds(3000);
 
-  Sleep(33 * 30);
+  TestHost::SleepMilliseconds(33 * 30);
 
   DbgPrint("Stopping video overlay\n");
   PvideoTeardown();
@@ -1047,7 +1041,7 @@ void PvideoTests::TestOverlappedOverlays() {
 
   for (uint32_t i = 0; i < 30; ++i) {
     SetPvideoBuffer(true, true);
-    Sleep(33);
+    TestHost::SleepMilliseconds(33);
   }
 
   SetPvideoInterruptEnabled(false, false);
@@ -1093,9 +1087,9 @@ void PvideoTests::TestInPoint() {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
 
-    Sleep(10);
+    TestHost::SleepMilliseconds(10);
   }
-  Sleep(1500);
+  TestHost::SleepMilliseconds(1500);
 
   for (auto t = 0; t < (kBoxSize * 2 << 3); ++t) {
     host_.PrepareDraw(kBackgroundColor);
@@ -1110,9 +1104,9 @@ void PvideoTests::TestInPoint() {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
 
-    Sleep(10);
+    TestHost::SleepMilliseconds(10);
   }
-  Sleep(1500);
+  TestHost::SleepMilliseconds(1500);
 
   DbgPrint("Stopping video overlay\n");
   PvideoTeardown();
@@ -1185,10 +1179,10 @@ void PvideoTests::TestInSize() {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
 
-    Sleep(250);
+    TestHost::SleepMilliseconds(250);
   }
 
-  Sleep(1500);
+  TestHost::SleepMilliseconds(1500);
 
   for (auto h = 1; h <= kTestWidthTexels; ++h) {
     host_.PrepareDraw(kBackgroundColor);
@@ -1204,10 +1198,10 @@ void PvideoTests::TestInSize() {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
 
-    Sleep(250);
+    TestHost::SleepMilliseconds(250);
   }
 
-  Sleep(1500);
+  TestHost::SleepMilliseconds(1500);
 
   DbgPrint("Stopping video overlay\n");
   PvideoTeardown();
@@ -1277,9 +1271,9 @@ void PvideoTests::TestOutPoint() {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
 
-    Sleep(10);
+    TestHost::SleepMilliseconds(10);
   }
-  Sleep(1500);
+  TestHost::SleepMilliseconds(1500);
 
   for (auto y = 0; y < kMaxDelta; ++y) {
     host_.PrepareDraw(kBackgroundColor);
@@ -1294,9 +1288,9 @@ void PvideoTests::TestOutPoint() {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
 
-    Sleep(10);
+    TestHost::SleepMilliseconds(10);
   }
-  Sleep(1500);
+  TestHost::SleepMilliseconds(1500);
 
   DbgPrint("Stopping video overlay\n");
   PvideoTeardown();
@@ -1365,9 +1359,9 @@ void PvideoTests::TestOutSize() {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
 
-    Sleep(10);
+    TestHost::SleepMilliseconds(10);
   }
-  Sleep(1500);
+  TestHost::SleepMilliseconds(1500);
 
   for (auto h = 0; h < kMaxDelta; ++h) {
     host_.PrepareDraw(kBackgroundColor);
@@ -1382,9 +1376,9 @@ void PvideoTests::TestOutSize() {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
 
-    Sleep(10);
+    TestHost::SleepMilliseconds(10);
   }
-  Sleep(1500);
+  TestHost::SleepMilliseconds(1500);
 
   DbgPrint("Stopping video overlay\n");
   PvideoTeardown();
@@ -1437,7 +1431,7 @@ void PvideoTests::TestRatios() {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
 
-    Sleep(200);
+    TestHost::SleepMilliseconds(200);
   }
 
   SetSquareDsDxDtDy(0);
@@ -1455,7 +1449,7 @@ void PvideoTests::TestRatios() {
     SetPvideoInterruptEnabled(true, false);
     SetPvideoBuffer(true, false);
 
-    Sleep(200);
+    TestHost::SleepMilliseconds(200);
   }
 
   DbgPrint("Stopping video overlay\n");
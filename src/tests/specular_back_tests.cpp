@@ -12,6 +12,7 @@
 #include <xbox_math_vector.h>
 
 #include "debug_output.h"
+#include "models/mesh_file.h"
 #include "shaders/passthrough_vertex_shader.h"
 #include "shaders/perspective_vertex_shader_no_lighting.h"
 #include "test_host.h"
@@ -339,6 +340,16 @@ void SpecularBackTests::Deinitialize() {
   vertex_buffer_torus_.reset();
 }
 
+std::vector<std::string> SpecularBackTests::PrefetchResources() const {
+  return MeshFile::UncachedPaths({
+      LightControlTestMeshConeModel::GetMeshFilePath(),
+      LightControlTestMeshCylinderModel::GetMeshFilePath(),
+      LightControlTestMeshSphereModel::GetMeshFilePath(),
+      LightControlTestMeshSuzanneModel::GetMeshFilePath(),
+      LightControlTestMeshTorusModel::GetMeshFilePath(),
+  });
+}
+
 static std::shared_ptr<PerspectiveVertexShader> SetupVertexShader(TestHost& host) {
   // Use a custom shader that approximates the interesting lighting portions of the fixed function pipeline.
   float depth_buffer_max_value = host.GetMaxDepthBufferValue();
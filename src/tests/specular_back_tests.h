@@ -20,6 +20,7 @@ class SpecularBackTests : public TestSuite {
 
   void Initialize() override;
   void Deinitialize() override;
+  [[nodiscard]] std::vector<std::string> PrefetchResources() const override;
 
  private:
   //! Tests handling of LIGHTING_ENABLE, SPECULAR_ENABLE, and SEPARATE_SPECULAR.
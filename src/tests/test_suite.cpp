@@ -6,6 +6,8 @@
 
 #include "configure.h"
 #include "debug_output.h"
+#include "default_state.h"
+#include "determinism_checker.h"
 #include "logger.h"
 #include "nxdk_ext.h"
 #include "pbkit_ext.h"
@@ -13,6 +15,8 @@
 #include "shaders/pixel_shader_program.h"
 #include "test_host.h"
 #include "texture_format.h"
+#include "wait_profiler.h"
+#include "watchdog.h"
 #include "xbox_math_matrix.h"
 #include "xbox_math_types.h"
 
@@ -20,8 +24,6 @@ using namespace XboxMath;
 
 static constexpr char kFTPLogProgressFilename[] = "nxdk_pgraph_tests_progress.log";
 
-#define SET_MASK(mask, val) (((val) << (__builtin_ffs(mask) - 1)) & (mask))
-
 TestSuite::TestSuite(TestHost& host, std::string output_dir, std::string suite_name, const Config& config,
                      bool interactive_only)
     : host_(host),
@@ -32,7 +34,8 @@ TestSuite::TestSuite(TestHost& host, std::string output_dir, std::string suite_n
       enable_progress_log_{config.enable_progress_log},
       enable_pgraph_region_diff_{config.enable_pgraph_region_diff},
       delay_milliseconds_between_tests_{config.delay_milliseconds_between_tests},
-      ftp_logger_{config.ftp_logger} {
+      ftp_logger_{config.ftp_logger},
+      pgraph_history_{config.pgraph_history} {
   output_dir_ += "\\";
   output_dir_ += suite_name_;
   std::replace(output_dir_.begin(), output_dir_.end(), ' ', '_');
@@ -60,37 +63,64 @@ void TestSuite::Run(const std::string& test_name) {
     ASSERT(!"Invalid test name");
   }
 
+  if (enable_pgraph_region_diff_) {
+    pgraph_diff_.Capture();
+  }
+
+  auto& allocation_tracker = host_.GetAllocationTracker();
+  allocation_tracker.BeginTest();
+  auto wait_profiler = WaitProfiler::Active();
+  if (wait_profiler) {
+    wait_profiler->BeginTest(suite_name_ + "::" + test_name);
+  }
+  auto watchdog = TestWatchdog::Active();
+  if (watchdog) {
+    watchdog->Arm(suite_name_ + "::" + test_name);
+  }
+  auto determinism_checker = DeterminismChecker::Active();
   SetupTest();
   auto start_time = LogTestStart(test_name);
-  it->second();
+  if (determinism_checker) {
+    RunDeterminismCheck(*determinism_checker, test_name, it->second);
+  } else {
+    it->second();
+  }
   auto duration = LogTestEnd(test_name, start_time);
   TearDownTest();
+  if (watchdog) {
+    watchdog->Disarm();
+  }
+  auto allocations = allocation_tracker.EndTest();
+  if (enable_progress_log_ && allow_saving_) {
+    Logger::Log() << "    Memory: " << allocations.Describe() << std::endl;
+  }
+  if (wait_profiler) {
+    const auto& waits = wait_profiler->EndTest();
+    if (enable_progress_log_ && allow_saving_) {
+      for (const auto& line : waits.Describe()) {
+        Logger::Log() << "    Wait " << line << std::endl;
+      }
+    }
+  }
+
+  if (enable_pgraph_region_diff_) {
+    const auto label = suite_name_ + "::" + test_name;
+    pgraph_diff_.DumpDiff(label);
+    if (pgraph_history_ && !pgraph_history_->Append(label, pgraph_diff_.GetRegisters())) {
+      PrintMsg("Failed to append PGRAPH history for %s\n", label.c_str());
+    }
+  }
 
   if (ftp_logger_) {
     if (!ftp_logger_->Connect()) {
       PrintMsg("FTP connect failed, aborting\n");
     } else {
       PrintMsg("Saving progress to FTP server...\n");
-
-      if (allow_saving_) {
-        for (auto& put_operation : ftp_logger_->send_file_queue()) {
-          std::stringstream message;
-          if (!ftp_logger_->PutFile(put_operation.first, put_operation.second)) {
-            message << "- MISSING: \"" << put_operation.second << "\"\n";
-          } else {
-            message << "- OUTPUT: \"" << put_operation.second << "\"\n";
-          }
-
-          if (!ftp_logger_->AppendFile(kFTPLogProgressFilename, message.str())) {
-            PrintMsg("Failed to store progress log to FTP server with artifact info!\n");
-          }
-          message.clear();
-        }
-      }
-      ftp_logger_->ClearSendQueue();
+      UploadQueuedArtifacts();
 
       std::stringstream message;
       message << "END: \"" << suite_name_ << "::" << test_name << "\" IN " << duration << " MS\n";
+      message << "MEMORY: \"" << suite_name_ << "::" << test_name << "\" " << allocations.Describe() << "\n";
       if (!ftp_logger_->AppendFile(kFTPLogProgressFilename, message.str())) {
         PrintMsg("Failed to store progress log to FTP server!\n");
       }
@@ -98,12 +128,144 @@ void TestSuite::Run(const std::string& test_name) {
   }
 }
 
+void TestSuite::RunDeterminismCheck(DeterminismChecker& checker, const std::string& test_name,
+                                    const std::function<void()>& test) {
+  // Nothing is captured while checking, so each additional iteration costs only the rendering and a hash per frame.
+  auto save_results = host_.GetSaveResults();
+  host_.SetSaveResults(false);
+
+  const auto qualified_name = suite_name_ + "::" + test_name;
+  auto watchdog = TestWatchdog::Active();
+  checker.BeginTest(qualified_name);
+  for (uint32_t i = 0; i < checker.GetIterations(); ++i) {
+    if (i) {
+      TearDownTest();
+      // The watchdog budget and timing history describe a single run of the test, so each iteration is timed
+      // separately. Run arms the first iteration and disarms the last.
+      if (watchdog) {
+        watchdog->Disarm();
+        watchdog->Arm(qualified_name);
+      }
+      SetupTest();
+    }
+    checker.BeginIteration();
+    test();
+  }
+  const auto& divergences = checker.EndTest();
+  host_.SetSaveResults(save_results);
+
+  for (const auto& divergence : divergences) {
+    PrintMsg("UNSTABLE: %s\n", divergence.Describe().c_str());
+    if (enable_progress_log_) {
+      Logger::Log() << "    Unstable: " << divergence.Describe() << std::endl;
+    }
+  }
+}
+
+void TestSuite::UploadQueuedArtifacts() {
+  if (allow_saving_) {
+    for (auto& put_operation : ftp_logger_->send_file_queue()) {
+      std::stringstream message;
+      if (!ftp_logger_->PutFile(put_operation.first, put_operation.second)) {
+        message << "- MISSING: \"" << put_operation.second << "\"\n";
+      } else {
+        message << "- OUTPUT: \"" << put_operation.second << "\"\n";
+      }
+
+      if (!ftp_logger_->AppendFile(kFTPLogProgressFilename, message.str())) {
+        PrintMsg("Failed to store progress log to FTP server with artifact info!\n");
+      }
+      message.clear();
+    }
+  }
+  ftp_logger_->ClearSendQueue();
+}
+
 void TestSuite::RunAll(bool include_interactive) {
   auto names = TestNames();
   for (const auto& test_name : names) {
-    if (include_interactive || interactive_only_tests_.find(test_name) == interactive_only_tests_.end()) {
+    if (!include_interactive && IsInteractiveOnlyTest(test_name)) {
+      continue;
+    }
+
+    // Determinism checks compare the frames of each test in isolation, so batched tests are rendered alone.
+    if (!IsBatchedTest(test_name) || DeterminismChecker::Active()) {
+      FinishAtlasFrame();
       Run(test_name);
+      continue;
     }
+
+    if (!atlas_frame_open_) {
+      BeginAtlasFrame();
+    }
+    Run(test_name);
+    if (atlas_frame_.size() == atlas_layout_->GetCellsPerFrame()) {
+      FinishAtlasFrame();
+    }
+  }
+  FinishAtlasFrame();
+}
+
+void TestSuite::EnableAtlasBatching(uint32_t cell_width, uint32_t cell_height, uint32_t clear_color) {
+  atlas_layout_ = std::make_unique<AtlasLayout>(host_.GetFramebufferWidth(), host_.GetFramebufferHeight(),
+                                                cell_width, cell_height);
+  ASSERT(atlas_layout_->IsValid() && "Atlas cell does not fit within the framebuffer.");
+  atlas_clear_color_ = clear_color;
+}
+
+void TestSuite::AddBatchedTest(const std::string& name, std::function<void(const AtlasLayout::Cell&)> draw) {
+  ASSERT(atlas_layout_ && "EnableAtlasBatching must be called before adding batched tests.");
+  batched_tests_.insert(name);
+  tests_[name] = [this, name, draw = std::move(draw)]() { RunBatchedTest(name, draw); };
+}
+
+void TestSuite::RunBatchedTest(const std::string& test_name,
+                               const std::function<void(const AtlasLayout::Cell&)>& draw) {
+  bool standalone = !atlas_frame_open_;
+  if (standalone) {
+    BeginAtlasFrame();
+  }
+
+  auto cell = atlas_layout_->GetCell(atlas_frame_.size());
+  host_.SetWindowClip(cell.Right() - 1, cell.Bottom() - 1, cell.left, cell.top);
+  draw(cell);
+  atlas_frame_.push_back({test_name, cell});
+
+  if (standalone) {
+    FinishAtlasFrame(false);
+  }
+}
+
+void TestSuite::BeginAtlasFrame() {
+  host_.SetWindowClip(host_.GetFramebufferWidth(), host_.GetFramebufferHeight());
+  host_.PrepareDraw(atlas_clear_color_);
+  atlas_frame_.clear();
+  atlas_frame_open_ = true;
+}
+
+void TestSuite::FinishAtlasFrame(bool arm_watchdog) {
+  if (!atlas_frame_open_) {
+    return;
+  }
+  atlas_frame_open_ = false;
+
+  // When batching, the GPU drain and capture for the whole frame happen after the Run calls for its tests have disarmed
+  // the watchdog, so the frame is guarded as a unit of its own. It is armed under the last test in the frame so that a
+  // hang is checkpointed against a real test name, and a resumed run skips every test in the frame.
+  auto watchdog = arm_watchdog && !atlas_frame_.empty() ? TestWatchdog::Active() : nullptr;
+  if (watchdog) {
+    watchdog->Arm(suite_name_ + "::" + atlas_frame_.back().name);
+  }
+  host_.SetWindowClip(host_.GetFramebufferWidth(), host_.GetFramebufferHeight());
+  host_.FinishDrawAtlas(allow_saving_, output_dir_, suite_name_, atlas_frame_);
+  if (watchdog) {
+    watchdog->Disarm();
+  }
+  atlas_frame_.clear();
+
+  // Artifacts are only written once the frame is captured, after the Run calls for its tests have completed.
+  if (ftp_logger_ && ftp_logger_->Connect()) {
+    UploadQueuedArtifacts();
   }
 }
 
@@ -120,47 +282,13 @@ void TestSuite::SetDefaultTextureFormat() const {
 }
 
 void TestSuite::Initialize() {
-  const uint32_t kFramebufferPitch = host_.GetFramebufferWidth() * 4;
+  host_.GetAllocationTracker().BeginSuite();
+
+  const auto& default_state = DefaultState::Get(host_.GetFramebufferWidth(), host_.GetFramebufferHeight());
+
   host_.SetSurfaceFormat(TestHost::SCF_A8R8G8B8, TestHost::SZF_Z16, host_.GetFramebufferWidth(),
                          host_.GetFramebufferHeight());
-
-  {
-    Pushbuffer::Begin();
-    Pushbuffer::PushF(NV097_SET_EYE_POSITION, 0.0f, 0.0f, 0.0f, 1.0f);
-    Pushbuffer::Push(NV097_SET_ZMIN_MAX_CONTROL, NV097_SET_ZMIN_MAX_CONTROL_CULL_NEAR_FAR_EN_TRUE |
-                                                     NV097_SET_ZMIN_MAX_CONTROL_ZCLAMP_EN_CULL |
-                                                     NV097_SET_ZMIN_MAX_CONTROL_CULL_IGNORE_W_FALSE);
-    Pushbuffer::Push(NV097_SET_SURFACE_PITCH, SET_MASK(NV097_SET_SURFACE_PITCH_COLOR, kFramebufferPitch) |
-                                                  SET_MASK(NV097_SET_SURFACE_PITCH_ZETA, kFramebufferPitch));
-    Pushbuffer::Push(NV097_SET_SURFACE_CLIP_HORIZONTAL, host_.GetFramebufferWidth() << 16);
-    Pushbuffer::Push(NV097_SET_SURFACE_CLIP_VERTICAL, host_.GetFramebufferHeight() << 16);
-
-    Pushbuffer::Push(NV097_SET_LIGHTING_ENABLE, false);
-    Pushbuffer::Push(NV097_SET_SPECULAR_ENABLE, false);
-    Pushbuffer::Push(NV097_SET_LIGHT_CONTROL, NV097_SET_LIGHT_CONTROL_V_ALPHA_FROM_MATERIAL_SPECULAR |
-                                                  NV097_SET_LIGHT_CONTROL_V_SEPARATE_SPECULAR);
-    Pushbuffer::Push(NV097_SET_LIGHT_ENABLE_MASK, NV097_SET_LIGHT_ENABLE_MASK_LIGHT0_OFF);
-    Pushbuffer::Push(NV097_SET_COLOR_MATERIAL, NV097_SET_COLOR_MATERIAL_ALL_FROM_MATERIAL);
-    Pushbuffer::Push(NV097_SET_SCENE_AMBIENT_COLOR, 0x0, 0x0, 0x0);
-    Pushbuffer::Push(NV097_SET_MATERIAL_EMISSION, 0x0, 0x0, 0x0);
-    Pushbuffer::PushF(NV097_SET_MATERIAL_ALPHA, 1.0f);
-    Pushbuffer::PushF(NV097_SET_BACK_MATERIAL_ALPHA, 1.f);
-
-    Pushbuffer::Push(NV097_SET_LIGHT_TWO_SIDE_ENABLE, false);
-    Pushbuffer::Push(NV097_SET_FRONT_POLYGON_MODE, NV097_SET_FRONT_POLYGON_MODE_V_FILL);
-    Pushbuffer::Push(NV097_SET_BACK_POLYGON_MODE, NV097_SET_FRONT_POLYGON_MODE_V_FILL);
-
-    Pushbuffer::Push(NV097_SET_POINT_PARAMS_ENABLE, false);
-    Pushbuffer::Push(NV097_SET_POINT_SMOOTH_ENABLE, false);
-    Pushbuffer::Push(NV097_SET_POINT_SIZE, 8);
-    Pushbuffer::Push(NV097_SET_LINE_WIDTH, 8);
-
-    Pushbuffer::Push(NV097_SET_DOT_RGBMAPPING, 0);
-
-    Pushbuffer::Push(NV097_SET_SHADE_MODEL, NV097_SET_SHADE_MODEL_SMOOTH);
-    Pushbuffer::Push(NV097_SET_FLAT_SHADE_OP, NV097_SET_FLAT_SHADE_OP_VERTEX_LAST);
-    Pushbuffer::End();
-  }
+  default_state.surface_and_lighting.Submit();
 
   host_.SetWindowClipExclusive(false);
   // Note, setting the first clip region will cause the hardware to also set all subsequent regions.
@@ -188,9 +316,7 @@ void TestSuite::Initialize() {
                           false, /*specular_add_invert_r0*/ false, /* specular_add_invert_v1*/ false,
                           /* specular_clamp */ true);
 
-  while (pb_busy()) {
-    /* Wait for completion... */
-  }
+  TestHost::WaitForPGRAPHIdle();
 
   matrix4_t identity_matrix;
   MatrixSetIdentity(identity_matrix);
@@ -218,87 +344,7 @@ void TestSuite::Initialize() {
     stage.SetTexgenQ(TextureStage::TG_DISABLE);
   }
 
-  // TODO: Set up with TextureStage instances in host_.
-  {
-    Pushbuffer::Begin();
-    uint32_t address = NV097_SET_TEXTURE_ADDRESS;
-    uint32_t control = NV097_SET_TEXTURE_CONTROL0;
-    uint32_t filter = NV097_SET_TEXTURE_FILTER;
-    Pushbuffer::Push(address, 0x10101);
-    Pushbuffer::Push(control, 0x3ffc0);
-    Pushbuffer::Push(filter, 0x1012000);
-
-    address += 0x40;
-    control += 0x40;
-    filter += 0x40;
-    Pushbuffer::Push(address, 0x10101);
-    Pushbuffer::Push(control, 0x3ffc0);
-    Pushbuffer::Push(filter, 0x1012000);
-
-    address += 0x40;
-    control += 0x40;
-    filter += 0x40;
-    Pushbuffer::Push(address, 0x10101);
-    Pushbuffer::Push(control, 0x3ffc0);
-    Pushbuffer::Push(filter, 0x1012000);
-
-    address += 0x40;
-    control += 0x40;
-    filter += 0x40;
-    Pushbuffer::Push(address, 0x10101);
-    Pushbuffer::Push(control, 0x3ffc0);
-    Pushbuffer::Push(filter, 0x1012000);
-
-    Pushbuffer::Push(NV097_SET_FOG_ENABLE, false);
-    Pushbuffer::PushF(NV097_SET_FOG_PLANE, 0.f, 0.f, 1.f, 0.f);
-    Pushbuffer::Push(NV097_SET_FOG_GEN_MODE, NV097_SET_FOG_GEN_MODE_V_PLANAR);
-    Pushbuffer::Push(NV097_SET_FOG_MODE, NV097_SET_FOG_MODE_V_LINEAR);
-    Pushbuffer::Push(NV097_SET_FOG_COLOR, 0xFFFFFFFF);
-
-    Pushbuffer::Push(NV097_SET_TEXTURE_MATRIX_ENABLE, 0, 0, 0, 0);
-
-    Pushbuffer::Push(NV097_SET_FRONT_FACE, NV097_SET_FRONT_FACE_V_CW);
-    Pushbuffer::Push(NV097_SET_CULL_FACE, NV097_SET_CULL_FACE_V_BACK);
-    Pushbuffer::Push(NV097_SET_CULL_FACE_ENABLE, true);
-
-    Pushbuffer::Push(NV097_SET_COLOR_MASK,
-                     NV097_SET_COLOR_MASK_BLUE_WRITE_ENABLE | NV097_SET_COLOR_MASK_GREEN_WRITE_ENABLE |
-                         NV097_SET_COLOR_MASK_RED_WRITE_ENABLE | NV097_SET_COLOR_MASK_ALPHA_WRITE_ENABLE);
-
-    Pushbuffer::Push(NV097_SET_DEPTH_TEST_ENABLE, false);
-    Pushbuffer::Push(NV097_SET_DEPTH_MASK, true);
-    Pushbuffer::Push(NV097_SET_DEPTH_FUNC, NV097_SET_DEPTH_FUNC_V_LESS);
-    Pushbuffer::Push(NV097_SET_STENCIL_TEST_ENABLE, false);
-    Pushbuffer::Push(NV097_SET_STENCIL_MASK, 0xFF);
-    // If the stencil comparison fails, leave the value in the stencil buffer alone.
-    Pushbuffer::Push(NV097_SET_STENCIL_OP_FAIL, NV097_SET_STENCIL_OP_V_KEEP);
-    // If the stencil comparison passes but the depth comparison fails, leave the stencil buffer alone.
-    Pushbuffer::Push(NV097_SET_STENCIL_OP_ZFAIL, NV097_SET_STENCIL_OP_V_KEEP);
-    // If the stencil comparison passes and the depth comparison passes, leave the stencil buffer alone.
-    Pushbuffer::Push(NV097_SET_STENCIL_OP_ZPASS, NV097_SET_STENCIL_OP_V_KEEP);
-    Pushbuffer::Push(NV097_SET_STENCIL_FUNC_REF, 0x7F);
-
-    Pushbuffer::Push(NV097_SET_NORMALIZATION_ENABLE, false);
-
-    Pushbuffer::PushF(NV097_SET_WEIGHT4F, 0.f, 0.f, 0.f, 0.f);
-    Pushbuffer::PushF(NV097_SET_NORMAL3F, 0.f, 0.f, 0.f);
-    Pushbuffer::Push(NV097_SET_DIFFUSE_COLOR4I, 0x00000000);
-    Pushbuffer::Push(NV097_SET_SPECULAR_COLOR4I, 0x00000000);
-    Pushbuffer::PushF(NV097_SET_TEXCOORD0_4F, 0.f, 0.f, 0.f, 0.f);
-    Pushbuffer::PushF(NV097_SET_TEXCOORD1_4F, 0.f, 0.f, 0.f, 0.f);
-    Pushbuffer::PushF(NV097_SET_TEXCOORD2_4F, 0.f, 0.f, 0.f, 0.f);
-    Pushbuffer::PushF(NV097_SET_TEXCOORD3_4F, 0.f, 0.f, 0.f, 0.f);
-    Pushbuffer::Push(NV097_SET_VERTEX_DATA4UB + (4 * NV2A_VERTEX_ATTR_BACK_DIFFUSE), 0xFFFFFFFF);
-    Pushbuffer::Push(NV097_SET_VERTEX_DATA4UB + (4 * NV2A_VERTEX_ATTR_BACK_SPECULAR), 0);
-
-    // Pow 16
-    const float specular_params[]{-0.803673, -2.7813, 2.97762, -0.64766, -2.36199, 2.71433};
-    for (uint32_t i = 0, offset = 0; i < 6; ++i, offset += 4) {
-      Pushbuffer::PushF(NV097_SET_SPECULAR_PARAMS + offset, specular_params[i]);
-      Pushbuffer::PushF(NV097_SET_SPECULAR_PARAMS_BACK + offset, 0);
-    }
-    Pushbuffer::End();
-  }
+  default_state.texture_and_raster.Submit();
 
   host_.SetDefaultViewportAndFixedFunctionMatrices();
   host_.SetDepthBufferFloatMode(false);
@@ -317,10 +363,6 @@ void TestSuite::Initialize() {
 
   host_.ClearAllVertexAttributeStrideOverrides();
 
-  if (enable_pgraph_region_diff_) {
-    pgraph_diff_.Capture();
-  }
-
   // Perform some nops to tag the end of the default initialization sequence for log processing.
   TagNV2ATrace(2);
   {
@@ -341,9 +383,28 @@ void TestSuite::TagNV2ATrace(uint32_t num_nops) {
   Pushbuffer::End();
 }
 
-void TestSuite::Deinitialize() {
-  if (enable_pgraph_region_diff_) {
-    pgraph_diff_.DumpDiff();
+void TestSuite::Deinitialize() { host_.ResetContiguousArena(); }
+
+void TestSuite::ReportAllocations() {
+  auto report = host_.GetAllocationTracker().EndSuite();
+  auto summary = report.Describe();
+  bool leaked = report.HasOutstanding();
+  if (leaked) {
+    PrintMsg("LEAK: %s left memory outstanding after Deinitialize: %s\n", suite_name_.c_str(), summary.c_str());
+  } else {
+    PrintMsg("%s memory: %s\n", suite_name_.c_str(), summary.c_str());
+  }
+
+  if (enable_progress_log_ && allow_saving_) {
+    Logger::Log() << (leaked ? "LEAK: " : "") << suite_name_ << " memory: " << summary << std::endl;
+  }
+
+  if (ftp_logger_ && ftp_logger_->Connect()) {
+    std::stringstream message;
+    message << (leaked ? "SUITE_LEAK: \"" : "SUITE_MEMORY: \"") << suite_name_ << "\" " << summary << "\n";
+    if (!ftp_logger_->AppendFile(kFTPLogProgressFilename, message.str())) {
+      PrintMsg("Failed to store progress log to FTP server!\n");
+    }
   }
 }
 
@@ -374,7 +435,7 @@ std::chrono::steady_clock::time_point TestSuite::LogTestStart(const std::string&
   }
 
   if (delay_milliseconds_between_tests_) {
-    Sleep(delay_milliseconds_between_tests_);
+    TestHost::SleepMilliseconds(delay_milliseconds_between_tests_);
   }
 
   return std::chrono::steady_clock::now();
@@ -7,12 +7,16 @@
 #include <chrono>
 #include <functional>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "atlas_layout.h"
 #include "pgraph_diff_token.h"
+#include "pgraph_snapshot_history.h"
 
+class DeterminismChecker;
 class TestHost;
 
 /**
@@ -33,6 +37,10 @@ class TestSuite {
 
     // Optional FTPLogger used to transfer test artifacts to a remote host.
     std::shared_ptr<FTPLogger> ftp_logger;
+
+    //! Optional history into which the PGRAPH registers are recorded after each test when enable_pgraph_region_diff
+    //! is set.
+    std::shared_ptr<PGRAPHHistoryWriter> pgraph_history;
   };
 
  public:
@@ -46,9 +54,18 @@ class TestSuite {
   //! Called to initialize the test suite.
   virtual void Initialize();
 
-  //! Called to tear down the test suite.
+  //! Called to tear down the test suite. Releases any memory obtained from TestHost::AllocateContiguous, so overrides
+  //! that allocate from the host must call the base implementation.
   virtual void Deinitialize();
 
+  //! Reports the memory this suite obtained through the host, logging any that was left outstanding. Must be called
+  //! after Deinitialize.
+  void ReportAllocations();
+
+  //! Returns the paths of resource files that this suite will load, so that they may be read in the background while
+  //! the preceding suite runs. Contents are claimed through ResourcePrefetcher::Take by the resource loaders.
+  [[nodiscard]] virtual std::vector<std::string> PrefetchResources() const { return {}; }
+
   //! Called before running an individual test within this suite.
   virtual void SetupTest();
 
@@ -64,11 +81,20 @@ class TestSuite {
 
   /**
    * Runs all registered tests in this suite.
+   *
+   * If the suite has enabled atlas batching, consecutive batched tests are rendered together, as many per frame as the
+   * layout allows.
+   *
    * @param inclue_interactive Whether tests that do not save artifacts should be run as well.
    */
   void RunAll(bool inclue_interactive);
 
   [[nodiscard]] bool IsInteractiveOnly() const { return interactive_only_; }
+
+  //! Returns true if the given test should only be run when directly invoked by the user.
+  [[nodiscard]] bool IsInteractiveOnlyTest(const std::string &test_name) const {
+    return interactive_only_tests_.find(test_name) != interactive_only_tests_.end();
+  }
   void SetSavingAllowed(bool enable = true) { allow_saving_ = enable; }
 
   //! Inserts a pattern of NV097_NO_OPERATION's into the pushbuffer to allow identification when viewing nv2a traces.
@@ -87,10 +113,50 @@ class TestSuite {
     host_.FinishDraw(false, output_dir_, suite_name_, name, save_zbuffer);
   }
 
+  /**
+   * Opts this suite into atlas batching, in which tests registered via AddBatchedTest are packed into a grid of
+   * `cell_width` x `cell_height` cells and rendered together. Each frame is cleared to `clear_color` once, and each
+   * cell is saved as a separate artifact named after its test.
+   *
+   * Must be called from the constructor, before any batched tests are added.
+   */
+  void EnableAtlasBatching(uint32_t cell_width, uint32_t cell_height, uint32_t clear_color = 0xFF000000);
+
+  /**
+   * Registers a test that renders only within the given cell. The window clip is restricted to the cell while `draw`
+   * runs; the test must not clear the surface, print text, or call FinishDraw.
+   *
+   * When run individually (e.g., from the menu) the test is rendered alone, producing the same artifact as when it is
+   * batched.
+   */
+  void AddBatchedTest(const std::string &name, std::function<void(const AtlasLayout::Cell &)> draw);
+
+  [[nodiscard]] bool IsBatchedTest(const std::string &test_name) const {
+    return batched_tests_.find(test_name) != batched_tests_.end();
+  }
+
  private:
   std::chrono::steady_clock::time_point LogTestStart(const std::string &test_name);
   long LogTestEnd(const std::string &test_name, const std::chrono::steady_clock::time_point &start_time) const;
 
+  //! Uploads any artifacts queued in ftp_logger_ and logs them to the FTP progress log.
+  void UploadQueuedArtifacts();
+
+  //! Runs the test repeatedly without saving artifacts, reporting any frames that differ between runs.
+  void RunDeterminismCheck(DeterminismChecker &checker, const std::string &test_name,
+                           const std::function<void()> &test);
+
+  void RunBatchedTest(const std::string &test_name, const std::function<void(const AtlasLayout::Cell &)> &draw);
+  //! Clears the surface and begins a new atlas frame.
+  void BeginAtlasFrame();
+  /**
+   * Captures and presents the current atlas frame, if one is open.
+   *
+   * @param arm_watchdog - Guard the capture with the watchdog. Must be false when called from within Run, which has
+   *                       already armed it for the running test.
+   */
+  void FinishAtlasFrame(bool arm_watchdog = true);
+
  protected:
   TestHost &host_;
   std::string output_dir_;
@@ -113,6 +179,16 @@ class TestSuite {
   uint32_t delay_milliseconds_between_tests_;
 
   std::shared_ptr<FTPLogger> ftp_logger_;
+  std::shared_ptr<PGRAPHHistoryWriter> pgraph_history_;
+
+ private:
+  //! Set by EnableAtlasBatching.
+  std::unique_ptr<AtlasLayout> atlas_layout_;
+  uint32_t atlas_clear_color_{0};
+  std::set<std::string> batched_tests_;
+  //! Cells rendered into the current atlas frame.
+  std::vector<TestHost::AtlasCapture> atlas_frame_;
+  bool atlas_frame_open_{false};
 };
 
 #endif  // NXDK_PGRAPH_TESTS_TEST_SUITE_H
@@ -12,8 +12,8 @@
 #include "test_host.h"
 #include "texture_format.h"
 #include "texture_generator.h"
+#include "texture_swizzle.h"
 #include "vertex_buffer.h"
-#include "xbox-swizzle/swizzle.h"
 #include "xbox_math_matrix.h"
 
 using namespace XboxMath;
@@ -801,7 +801,7 @@ static void GenerateBordered2DSurface(uint8_t *texture_memory, uint32_t width, u
   GenerateColoredCheckerboard(buffer, 4, 4, width, height, full_pitch, kColors, kNumColors, 2);
 
   if (swizzle) {
-    swizzle_rect(buffer, bordered_width, bordered_height, texture_memory, full_pitch, 4);
+    TextureSwizzle::SwizzleRect(buffer, bordered_width, bordered_height, texture_memory, full_pitch, 4);
     delete[] buffer;
   }
 }
@@ -849,8 +849,8 @@ void TextureBorderTests::GenerateBordered3DSurface(uint8_t *texture_memory, uint
   }
 
   if (swizzle) {
-    swizzle_box(buffer, bordered_width, bordered_height, bordered_depth, texture_memory, full_pitch, full_layer_pitch,
-                4);
+    TextureSwizzle::SwizzleBox(buffer, bordered_width, bordered_height, bordered_depth, texture_memory, full_pitch,
+                               full_layer_pitch, 4);
     delete[] buffer;
   }
 }
@@ -883,7 +883,7 @@ void TextureBorderTests::GenerateBorderedCubemapSurface(uint8_t *texture_memory,
     GenerateRGBACheckerboard(dest, 4, 4, width, height, full_pitch, high, low, 1);
 
     if (swizzle) {
-      swizzle_rect(dest, bordered_width, bordered_height, target, full_pitch, 4);
+      TextureSwizzle::SwizzleRect(dest, bordered_width, bordered_height, target, full_pitch, 4);
     }
   }
 
@@ -9,7 +9,7 @@
 #include "shaders/perspective_vertex_shader.h"
 #include "test_host.h"
 #include "texture_format.h"
-#include "xbox-swizzle/swizzle.h"
+#include "texture_swizzle.h"
 #include "xbox_math_matrix.h"
 #include "xbox_math_types.h"
 
@@ -258,7 +258,7 @@ static void GenerateSphericalCoordMap(uint8_t *buffer) {
       }
     }
 
-    swizzle_rect(temp_buffer, kTextureWidth, kTextureHeight, buffer, kTexturePitch, 4);
+    TextureSwizzle::SwizzleRect(temp_buffer, kTextureWidth, kTextureHeight, buffer, kTexturePitch, 4);
     buffer += kSliceSize;
   }
 
@@ -280,8 +280,8 @@ static void GenerateBRDFFunc(uint8_t *buffer) {
     }
   }
 
-  swizzle_box(temp_buffer, kTextureWidth, kTextureHeight, kTextureDepth, buffer, kTexturePitch,
-              kTexturePitch * kTextureHeight, 4);
+  TextureSwizzle::SwizzleBox(temp_buffer, kTextureWidth, kTextureHeight, kTextureDepth, buffer, kTexturePitch,
+                             kTexturePitch * kTextureHeight, 4);
   delete[] temp_buffer;
 }
 
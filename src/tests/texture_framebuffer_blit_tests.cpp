@@ -81,6 +81,7 @@ void TextureFramebufferBlitTests::Initialize() {
   pb_create_gr_ctx(channel++, GR_CLASS_72, &beta4_ctx_);
   pb_bind_channel(&beta4_ctx_);
   pb_bind_subchannel(SUBCH_CLASS_72, &beta4_ctx_);
+  ASSERT(channel <= TestHost::kCaptureFenceContextChannel && "Context channel collides with the capture fence.");
 
   host_.SetSurfaceFormat(host_.GetColorBufferFormat(), TestHost::SZF_Z24S8, host_.GetFramebufferWidth(),
                          host_.GetFramebufferHeight());
@@ -226,9 +227,8 @@ void TextureFramebufferBlitTests::CreateGeometry() {
 void TextureFramebufferBlitTests::TestRenderTarget(const char* test_name) {
   const auto pitch = host_.GetFramebufferWidth() * 4;
   const uint32_t texture_size = pitch * host_.GetFramebufferHeight();
-  auto target =
-      (uint8_t*)MmAllocateContiguousMemoryEx(texture_size, 0, MAXRAM, 0x1000, PAGE_WRITECOMBINE | PAGE_READWRITE);
-  ASSERT(target && "Failed to allocate target surface.");
+  ContiguousArena::Scope scope(host_.GetContiguousArena());
+  auto target = host_.AllocateContiguous(texture_size);
 
   Pushbuffer::Begin();
   Pushbuffer::Push(NV097_SET_SURFACE_PITCH,
@@ -255,8 +255,6 @@ void TextureFramebufferBlitTests::TestRenderTarget(const char* test_name) {
   Pushbuffer::End();
 
   Test(reinterpret_cast<uint32_t>(target), test_name);
-
-  MmFreeContiguousMemory(target);
 }
 
 void TextureFramebufferBlitTests::Test(uint32_t texture_destination, const char* test_name) {
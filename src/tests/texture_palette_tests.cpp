@@ -3,7 +3,7 @@
 #include <array>
 
 #include "test_host.h"
-#include "xbox-swizzle/swizzle.h"
+#include "texture_swizzle.h"
 
 static constexpr char kPaletteSwappingTest[] = "PaletteSwapping";
 static constexpr char kXemu2646Test[] = "XemuHighPaletteBug";
@@ -359,7 +359,7 @@ void GenerateSwizzledPalettizedGradientSurface(uint8_t *gradient_surface, int wi
       *pixels = (static_cast<uint8_t>(max_value * (1.f - distance / max_distance)) * scale) & 0xFF;
     }
   }
-  swizzle_rect(temp_buffer.data(), width, height, gradient_surface, width, 1);
+  TextureSwizzle::SwizzleRect(temp_buffer.data(), width, height, gradient_surface, width, 1);
 }
 
 void GeneratePalette(uint32_t *palette, uint32_t palette_size, uint32_t mask) {
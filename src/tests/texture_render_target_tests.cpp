@@ -73,11 +73,10 @@ void TextureRenderTargetTests::Initialize() {
   auto channel = kNextContextChannel;
   pb_create_dma_ctx(channel++, DMA_CLASS_3D, 0, MAXRAM, &texture_target_ctx_);
   pb_bind_channel(&texture_target_ctx_);
+  ASSERT(channel <= TestHost::kCaptureFenceContextChannel && "Context channel collides with the capture fence.");
 
   const uint32_t texture_size = kTexturePitch * kTextureHeight;
-  render_target_ =
-      (uint8_t *)MmAllocateContiguousMemoryEx(texture_size, 0, MAXRAM, 0x1000, PAGE_WRITECOMBINE | PAGE_READWRITE);
-  ASSERT(render_target_ && "Failed to allocate target surface.");
+  render_target_ = host_.AllocateContiguous(texture_size);
   pb_set_dma_address(&texture_target_ctx_, render_target_, texture_size - 1);
 
   host_.SetCombinerControl(1, true, true);
@@ -90,9 +89,7 @@ void TextureRenderTargetTests::Initialize() {
 
 void TextureRenderTargetTests::Deinitialize() {
   TestSuite::Deinitialize();
-  if (render_target_) {
-    MmFreeContiguousMemory(render_target_);
-  }
+  render_target_ = nullptr;
 }
 
 void TextureRenderTargetTests::CreateGeometry() {
@@ -37,11 +37,10 @@ void TextureRenderUpdateInPlaceTests::Initialize() {
   auto channel = kNextContextChannel;
   pb_create_dma_ctx(channel++, DMA_CLASS_3D, 0, MAXRAM, &texture_target_ctx_);
   pb_bind_channel(&texture_target_ctx_);
+  ASSERT(channel <= TestHost::kCaptureFenceContextChannel && "Context channel collides with the capture fence.");
 
   const uint32_t texture_size = host_.GetMaxTextureWidth() * 4 * host_.GetMaxTextureHeight();
-  render_target_ =
-      (uint8_t *)MmAllocateContiguousMemoryEx(texture_size, 0, MAXRAM, 0x1000, PAGE_WRITECOMBINE | PAGE_READWRITE);
-  ASSERT(render_target_ && "Failed to allocate target surface.");
+  render_target_ = host_.AllocateContiguous(texture_size);
 
   host_.SetCombinerControl(1, true, true);
 
@@ -50,9 +49,7 @@ void TextureRenderUpdateInPlaceTests::Initialize() {
 
 void TextureRenderUpdateInPlaceTests::Deinitialize() {
   TestSuite::Deinitialize();
-  if (render_target_) {
-    MmFreeContiguousMemory(render_target_);
-  }
+  render_target_ = nullptr;
 
   Pushbuffer::Begin();
   Pushbuffer::Push(NV097_SET_CONTEXT_DMA_A, kDefaultDMAChannelA);
@@ -247,6 +247,7 @@ void TextureShadowComparatorTests::Initialize() {
   auto channel = kNextContextChannel;
   pb_create_dma_ctx(channel++, DMA_CLASS_3D, 0, MAXRAM, &texture_target_ctx_);
   pb_bind_channel(&texture_target_ctx_);
+  ASSERT(channel <= TestHost::kCaptureFenceContextChannel && "Context channel collides with the capture fence.");
 
   raw_value_shader_ = std::make_shared<PassthroughVertexShader>();
   host_.SetXDKDefaultViewportAndFixedFunctionMatrices();
@@ -76,6 +76,7 @@ void TwoDLineTests::Initialize() {
   pb_create_gr_ctx(channel++, NV04_CONTEXT_SURFACES_2D, &surface_destination_ctx_);
   pb_bind_channel(&surface_destination_ctx_);
   pb_bind_subchannel(SUBCH_CLASS_42, &surface_destination_ctx_);
+  ASSERT(channel <= TestHost::kCaptureFenceContextChannel && "Context channel collides with the capture fence.");
 
   host_.SetVertexShaderProgram(nullptr);
 }
@@ -80,16 +80,12 @@ void VertexShaderRoundingTests::Initialize() {
   CreateGeometry();
 
   const uint32_t texture_size = kTexturePitch * kTextureHeight;
-  render_target_ =
-      (uint8_t *)MmAllocateContiguousMemoryEx(texture_size, 0, MAXRAM, 0x1000, PAGE_WRITECOMBINE | PAGE_READWRITE);
-  ASSERT(render_target_ && "Failed to allocate target surface.");
+  render_target_ = host_.AllocateContiguous(texture_size);
 }
 
 void VertexShaderRoundingTests::Deinitialize() {
   TestSuite::Deinitialize();
-  if (render_target_) {
-    MmFreeContiguousMemory(render_target_);
-  }
+  render_target_ = nullptr;
 }
 
 void VertexShaderRoundingTests::CreateGeometry() {
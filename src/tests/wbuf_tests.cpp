@@ -487,9 +487,7 @@ void WBufTests::Test(int depthf, bool zbias, bool zslope, bool vsh, const char *
 
   auto sample_coords = draw_prim();
 
-  while (pb_busy()) {
-    /* Wait for completion... */
-  }
+  TestHost::WaitForPGRAPHIdle();
 
   {
     unsigned int depth_pitch = pb_depth_stencil_pitch();
@@ -70,31 +70,32 @@ void ZPassPixelCountTests::Initialize() {
 
   static constexpr auto semaphore_object_size = 32;
   semaphore_context_object_ =
-      static_cast<uint32_t *>(MmAllocateContiguousMemoryEx(semaphore_object_size, 0, MAXRAM, 0, PAGE_READWRITE));
+      static_cast<uint32_t *>(host_.AllocateDedicatedContiguous(semaphore_object_size, PAGE_READWRITE));
   memset(semaphore_context_object_, 0, semaphore_object_size);
   pb_create_dma_ctx(channel++, DMA_CLASS_3D, (DWORD)semaphore_context_object_, 0x20, &semaphore_dma_ctx_);
   pb_bind_channel(&semaphore_dma_ctx_);
 
   static constexpr auto kReportContextArraySize = sizeof(*report_context_object_) * 4;
   report_context_object_ =
-      static_cast<ZPassReport *>(MmAllocateContiguousMemoryEx(kReportContextArraySize, 0, MAXRAM, 0, PAGE_READWRITE));
+      static_cast<ZPassReport *>(host_.AllocateDedicatedContiguous(kReportContextArraySize, PAGE_READWRITE));
   memset(report_context_object_, 0, kReportContextArraySize);
 
   pb_create_dma_ctx(channel++, DMA_CLASS_3D, reinterpret_cast<uint32_t>(report_context_object_),
                     kReportContextArraySize, &report_dma_ctx_);
   pb_bind_channel(&report_dma_ctx_);
+  ASSERT(channel <= TestHost::kCaptureFenceContextChannel && "Context channel collides with the capture fence.");
 }
 
 void ZPassPixelCountTests::Deinitialize() {
   TestSuite::Deinitialize();
 
   if (semaphore_context_object_) {
-    MmFreeContiguousMemory(semaphore_context_object_);
+    host_.FreeDedicatedContiguous(semaphore_context_object_);
     semaphore_context_object_ = nullptr;
   }
 
   if (report_context_object_) {
-    MmFreeContiguousMemory(report_context_object_);
+    host_.FreeDedicatedContiguous(report_context_object_);
     report_context_object_ = nullptr;
   }
 }
@@ -177,7 +178,7 @@ void ZPassPixelCountTests::Test() {
   host_.WaitForGPU();
   // TODO: See if there is a better mechanism to delay until the report is fetched without spin locking.
   for (auto i = 0; i < 32 && *semaphore_context_object_ != kSemaphoreReleaseValue; ++i) {
-    Sleep(1);
+    TestHost::SleepMilliseconds(1);
   }
 
   pb_print("%s\n", kTestName);
@@ -279,7 +280,7 @@ void ZPassPixelCountTests::TestPointSize(uint32_t point_size) {
   host_.WaitForGPU();
   // TODO: See if there is a better mechanism to delay until the report is fetched without spin locking.
   for (auto i = 0; i < 32 && *semaphore_context_object_ != kSemaphoreReleaseValue; ++i) {
-    Sleep(1);
+    TestHost::SleepMilliseconds(1);
   }
 
   const std::string test_name = MakePointSizeTestName(point_size);
@@ -392,7 +393,7 @@ void ZPassPixelCountTests::TestPointSizeProgrammable(uint32_t point_size) {
   host_.WaitForGPU();
   // TODO: See if there is a better mechanism to delay until the report is fetched without spin locking.
   for (auto i = 0; i < 32 && *semaphore_context_object_ != kSemaphoreReleaseValue; ++i) {
-    Sleep(1);
+    TestHost::SleepMilliseconds(1);
   }
 
   const std::string test_name = MakePointSizeTestName(point_size, true);
@@ -495,7 +496,7 @@ void ZPassPixelCountTests::TestLineWidth(uint32_t line_width) {
   host_.WaitForGPU();
   // TODO: See if there is a better mechanism to delay until the report is fetched without spin locking.
   for (auto i = 0; i < 32 && *semaphore_context_object_ != kSemaphoreReleaseValue; ++i) {
-    Sleep(1);
+    TestHost::SleepMilliseconds(1);
   }
 
   const std::string test_name = MakeLineWidthTestName(line_width);
@@ -0,0 +1,152 @@
+#include "texture_cache.h"
+
+#include <cstdio>
+#include <memory>
+
+#ifdef NXDK
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wmacro-redefined"
+#include <windows.h>
+#pragma clang diagnostic pop
+static constexpr char kPathSeparator = '\\';
+#else
+#include <sys/stat.h>
+static constexpr char kPathSeparator = '/';
+#endif
+
+//! Arbitrary cap to reject corrupt headers before allocating.
+static constexpr uint32_t kMaxDataSize = 64 * 1024 * 1024;
+
+static uint32_t HashKey(const TextureCache::Key &key) {
+  // FNV-1a over the source path and the target layout.
+  uint32_t hash = 2166136261U;
+  auto mix = [&hash](uint8_t value) {
+    hash ^= value;
+    hash *= 16777619U;
+  };
+  for (auto c : key.source_path) {
+    mix(static_cast<uint8_t>(c));
+  }
+  for (uint32_t i = 0; i < 4; ++i) {
+    mix(static_cast<uint8_t>(key.format >> (i * 8)));
+  }
+  mix(key.swizzled ? 1 : 0);
+  return hash;
+}
+
+bool TextureCache::BuildKey(const std::string &source_path, uint32_t format, bool swizzled, Key &key) {
+#ifdef NXDK
+  WIN32_FILE_ATTRIBUTE_DATA attributes;
+  if (!GetFileAttributesExA(source_path.c_str(), GetFileExInfoStandard, &attributes)) {
+    return false;
+  }
+  key.source_size = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+  key.source_write_time = (static_cast<uint64_t>(attributes.ftLastWriteTime.dwHighDateTime) << 32) |
+                          attributes.ftLastWriteTime.dwLowDateTime;
+#else
+  struct stat info {};
+  if (stat(source_path.c_str(), &info)) {
+    return false;
+  }
+  key.source_size = static_cast<uint64_t>(info.st_size);
+  key.source_write_time = static_cast<uint64_t>(info.st_mtime);
+#endif
+
+  key.source_path = source_path;
+  key.format = format;
+  key.swizzled = swizzled;
+  return true;
+}
+
+std::string TextureCache::EntryPath(const Key &key) const {
+  char filename[16];
+  snprintf(filename, sizeof(filename), "%08x.tex", HashKey(key));
+  return directory_ + kPathSeparator + filename;
+}
+
+bool TextureCache::Load(const Key &key, Image &image, const AllocateCallback &allocate, uint8_t *&data) const {
+  FILE *fp = fopen(EntryPath(key).c_str(), "rb");
+  if (!fp) {
+    return false;
+  }
+  std::unique_ptr<FILE, decltype(&fclose)> closer(fp, &fclose);
+
+  Header header{};
+  if (fread(&header, sizeof(header), 1, fp) != 1) {
+    return false;
+  }
+  if (header.magic != kMagic || header.version != kVersion || header.source_size != key.source_size ||
+      header.source_write_time != key.source_write_time || header.format != key.format ||
+      header.swizzled != (key.swizzled ? 1U : 0U) || header.path_length != key.source_path.size()) {
+    return false;
+  }
+  if (header.data_size > kMaxDataSize || static_cast<uint64_t>(header.pitch) * header.height != header.data_size) {
+    return false;
+  }
+
+  std::string path(header.path_length, '\0');
+  if (header.path_length && fread(&path[0], header.path_length, 1, fp) != 1) {
+    return false;
+  }
+  if (path != key.source_path) {
+    return false;
+  }
+
+  // Reject truncated entries before allocating.
+  long data_start = ftell(fp);
+  if (data_start < 0 || fseek(fp, 0, SEEK_END)) {
+    return false;
+  }
+  long entry_end = ftell(fp);
+  if (entry_end < data_start || static_cast<uint64_t>(entry_end - data_start) != header.data_size ||
+      fseek(fp, data_start, SEEK_SET)) {
+    return false;
+  }
+
+  data = allocate(header.data_size);
+  if (!data) {
+    return false;
+  }
+  if (header.data_size && fread(data, header.data_size, 1, fp) != 1) {
+    return false;
+  }
+
+  image.width = header.width;
+  image.height = header.height;
+  image.pitch = header.pitch;
+  image.bytes_per_pixel = header.bytes_per_pixel;
+  return true;
+}
+
+bool TextureCache::Store(const Key &key, const Image &image, const uint8_t *data) const {
+  Header header{};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.source_size = key.source_size;
+  header.source_write_time = key.source_write_time;
+  header.format = key.format;
+  header.swizzled = key.swizzled ? 1 : 0;
+  header.width = image.width;
+  header.height = image.height;
+  header.pitch = image.pitch;
+  header.bytes_per_pixel = image.bytes_per_pixel;
+  header.path_length = key.source_path.size();
+  header.data_size = image.pitch * image.height;
+
+  auto entry_path = EntryPath(key);
+  FILE *fp = fopen(entry_path.c_str(), "wb");
+  if (!fp) {
+    return false;
+  }
+
+  bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+  ok = ok && (key.source_path.empty() || fwrite(key.source_path.data(), key.source_path.size(), 1, fp) == 1);
+  ok = ok && (!header.data_size || fwrite(data, header.data_size, 1, fp) == 1);
+  ok = !fclose(fp) && ok;
+
+  if (!ok) {
+    // A partial entry would be rejected by Load anyway, but there is no reason to leave it taking up space.
+    remove(entry_path.c_str());
+  }
+  return ok;
+}
@@ -0,0 +1,89 @@
+#ifndef NXDK_PGRAPH_TESTS_TEXTURE_CACHE_H
+#define NXDK_PGRAPH_TESTS_TEXTURE_CACHE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * Persistent cache of decoded texture images, stored on a scratch partition (typically Z:).
+ *
+ * Each entry holds the pixel data of one source image in a specific pixel format, optionally pre-swizzled, and is
+ * keyed on the source file's path, size and last write time so that a modified source is decoded again. An entry is a
+ * fixed size Header followed by the source path and the pixel data, so it can be loaded with a single sequential pass
+ * directly into the caller's buffer.
+ */
+class TextureCache {
+ public:
+  static constexpr uint32_t kMagic = 0x58455443;  // "CTEX"
+  static constexpr uint32_t kVersion = 1;
+
+  //! Identifies a decoded image by its source file and the layout it was decoded into.
+  struct Key {
+    std::string source_path;
+    uint64_t source_size{0};
+    uint64_t source_write_time{0};
+    //! The SDL_PixelFormatEnum the image was converted to.
+    uint32_t format{0};
+    bool swizzled{false};
+  };
+
+  struct Image {
+    uint32_t width{0};
+    uint32_t height{0};
+    uint32_t pitch{0};
+    uint32_t bytes_per_pixel{0};
+  };
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t source_size;
+    uint64_t source_write_time;
+    uint32_t format;
+    uint32_t swizzled;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t bytes_per_pixel;
+    //! Length of the source path that immediately follows the header.
+    uint32_t path_length;
+    //! Size of the pixel data that follows the source path.
+    uint32_t data_size;
+  };
+  static_assert(sizeof(Header) == 56, "Header layout is part of the on-disk format");
+
+  //! Returns a buffer of at least `size` bytes to receive cached pixel data, or nullptr to abort the load.
+  typedef std::function<uint8_t *(uint32_t size)> AllocateCallback;
+
+ public:
+  //! `directory` must exist before Store is called.
+  explicit TextureCache(std::string directory) : directory_(std::move(directory)) {}
+
+  /**
+   * Populates `key` for the given source file, querying its size and last write time.
+   *
+   * Returns false if the file cannot be queried.
+   */
+  static bool BuildKey(const std::string &source_path, uint32_t format, bool swizzled, Key &key);
+
+  //! Returns the path of the entry for the given key.
+  [[nodiscard]] std::string EntryPath(const Key &key) const;
+
+  /**
+   * Loads the entry matching `key` into a buffer obtained from `allocate`.
+   *
+   * Returns false if there is no entry or it is stale, truncated, or was written for a different key. `allocate` is
+   * only invoked once the entry has been validated; `data` receives its result even if the read then fails, so that the
+   * caller can release it.
+   */
+  bool Load(const Key &key, Image &image, const AllocateCallback &allocate, uint8_t *&data) const;
+
+  //! Writes an entry holding `data` (`image.pitch * image.height` bytes) for the given key, replacing any existing one.
+  bool Store(const Key &key, const Image &image, const uint8_t *data) const;
+
+ private:
+  std::string directory_;
+};
+
+#endif  // NXDK_PGRAPH_TESTS_TEXTURE_CACHE_H
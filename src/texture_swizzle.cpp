@@ -0,0 +1,269 @@
+#include "texture_swizzle.h"
+
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace TextureSwizzle {
+namespace {
+
+//! Builds the bitmasks selecting the bits of a swizzled offset that belong to each axis. Bits are assigned from the
+//! least significant end, alternating between the axes that still have room to grow.
+void GenerateMasks(uint32_t width, uint32_t height, uint32_t depth, uint32_t &mask_x, uint32_t &mask_y,
+                   uint32_t &mask_z) {
+  mask_x = mask_y = mask_z = 0;
+  uint32_t mask_bit = 1;
+  for (uint32_t bit = 1; bit < width || bit < height || bit < depth; bit <<= 1) {
+    if (bit < width) {
+      mask_x |= mask_bit;
+      mask_bit <<= 1;
+    }
+    if (bit < height) {
+      mask_y |= mask_bit;
+      mask_bit <<= 1;
+    }
+    if (bit < depth) {
+      mask_z |= mask_bit;
+      mask_bit <<= 1;
+    }
+  }
+}
+
+//! Returns the swizzled byte offset of each of `count` coordinates along the axis described by `mask`.
+std::vector<uint32_t> BuildOffsets(uint32_t mask, uint32_t count, uint32_t bytes_per_pixel) {
+  std::vector<uint32_t> ret(count);
+  uint32_t offset = 0;
+  for (auto &entry : ret) {
+    entry = offset * bytes_per_pixel;
+    // Increments only the bits within the mask, carrying across the bits that belong to other axes.
+    offset = (offset - mask) & mask;
+  }
+  return ret;
+}
+
+bool IsPowerOfTwo(uint32_t value) { return value && !(value & (value - 1)); }
+
+//! Moves `kBytes` between the linear and swizzled images in the direction selected by `kToSwizzled`.
+template <uint32_t kBytes, bool kToSwizzled>
+inline void Transfer(uint8_t *linear, uint8_t *swizzled) {
+  if constexpr (kToSwizzled) {
+    memcpy(swizzled, linear, kBytes);
+  } else {
+    memcpy(linear, swizzled, kBytes);
+  }
+}
+
+/**
+ * Moves a 4x4 texel tile whose upper left texel is at `linear`.
+ *
+ * In the swizzled layout the tile is 16 contiguous texels made up of four 2x2 blocks in Z order, each of which holds
+ * two texels from the upper row followed by two from the lower row.
+ */
+template <uint32_t kBPP, bool kToSwizzled>
+inline void TransferTile4x4(uint8_t *linear, uint32_t pitch, uint8_t *swizzled) {
+#ifdef __SSE2__
+  uint8_t *row0 = linear;
+  uint8_t *row1 = linear + pitch;
+  uint8_t *row2 = row1 + pitch;
+  uint8_t *row3 = row2 + pitch;
+  auto out = reinterpret_cast<__m128i *>(swizzled);
+
+  if constexpr (kBPP == 4) {
+    if constexpr (kToSwizzled) {
+      const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0));
+      const __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1));
+      const __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row2));
+      const __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row3));
+      _mm_storeu_si128(out + 0, _mm_unpacklo_epi64(r0, r1));
+      _mm_storeu_si128(out + 1, _mm_unpackhi_epi64(r0, r1));
+      _mm_storeu_si128(out + 2, _mm_unpacklo_epi64(r2, r3));
+      _mm_storeu_si128(out + 3, _mm_unpackhi_epi64(r2, r3));
+    } else {
+      const __m128i b0 = _mm_loadu_si128(out + 0);
+      const __m128i b1 = _mm_loadu_si128(out + 1);
+      const __m128i b2 = _mm_loadu_si128(out + 2);
+      const __m128i b3 = _mm_loadu_si128(out + 3);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(row0), _mm_unpacklo_epi64(b0, b1));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(row1), _mm_unpackhi_epi64(b0, b1));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(row2), _mm_unpacklo_epi64(b2, b3));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(row3), _mm_unpackhi_epi64(b2, b3));
+    }
+    return;
+  } else if constexpr (kBPP == 2) {
+    if constexpr (kToSwizzled) {
+      const __m128i r0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row0));
+      const __m128i r1 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row1));
+      const __m128i r2 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row2));
+      const __m128i r3 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row3));
+      _mm_storeu_si128(out + 0, _mm_unpacklo_epi32(r0, r1));
+      _mm_storeu_si128(out + 1, _mm_unpacklo_epi32(r2, r3));
+    } else {
+      // Each 32-bit lane holds a texel pair, ordered (row0, row1, row0, row1).
+      const __m128i upper = _mm_shuffle_epi32(_mm_loadu_si128(out + 0), _MM_SHUFFLE(3, 1, 2, 0));
+      const __m128i lower = _mm_shuffle_epi32(_mm_loadu_si128(out + 1), _MM_SHUFFLE(3, 1, 2, 0));
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(row0), upper);
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(row1), _mm_unpackhi_epi64(upper, upper));
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(row2), lower);
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(row3), _mm_unpackhi_epi64(lower, lower));
+    }
+    return;
+  } else if constexpr (kBPP == 1) {
+    if constexpr (kToSwizzled) {
+      uint32_t rows[4];
+      memcpy(&rows[0], row0, 4);
+      memcpy(&rows[1], row1, 4);
+      memcpy(&rows[2], row2, 4);
+      memcpy(&rows[3], row3, 4);
+      const __m128i upper = _mm_unpacklo_epi16(_mm_cvtsi32_si128(static_cast<int>(rows[0])),
+                                               _mm_cvtsi32_si128(static_cast<int>(rows[1])));
+      const __m128i lower = _mm_unpacklo_epi16(_mm_cvtsi32_si128(static_cast<int>(rows[2])),
+                                               _mm_cvtsi32_si128(static_cast<int>(rows[3])));
+      _mm_storeu_si128(out, _mm_unpacklo_epi64(upper, lower));
+    } else {
+      // Each 16-bit lane holds a texel pair, ordered (row0, row1, row0, row1, row2, row3, row2, row3).
+      __m128i tile = _mm_loadu_si128(out);
+      tile = _mm_shufflelo_epi16(tile, _MM_SHUFFLE(3, 1, 2, 0));
+      tile = _mm_shufflehi_epi16(tile, _MM_SHUFFLE(3, 1, 2, 0));
+      alignas(16) uint32_t rows[4];
+      _mm_store_si128(reinterpret_cast<__m128i *>(rows), tile);
+      memcpy(row0, &rows[0], 4);
+      memcpy(row1, &rows[1], 4);
+      memcpy(row2, &rows[2], 4);
+      memcpy(row3, &rows[3], 4);
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t block = 0; block < 4; ++block) {
+    uint8_t *upper = linear + (block >> 1) * 2 * pitch + (block & 1) * 2 * kBPP;
+    uint8_t *out = swizzled + block * 4 * kBPP;
+    Transfer<2 * kBPP, kToSwizzled>(upper, out);
+    Transfer<2 * kBPP, kToSwizzled>(upper + pitch, out + 2 * kBPP);
+  }
+}
+
+/**
+ * Moves every texel of a volume between its linear and swizzled representations.
+ *
+ * `kBPP` of 0 selects a per-texel copy of `bytes_per_pixel` bytes for sizes without a specialized kernel.
+ */
+template <uint32_t kBPP, bool kToSwizzled>
+void TransferBox(uint8_t *linear, uint8_t *swizzled, uint32_t width, uint32_t height, uint32_t depth,
+                 uint32_t row_pitch, uint32_t slice_pitch, uint32_t bytes_per_pixel) {
+  uint32_t mask_x, mask_y, mask_z;
+  GenerateMasks(width, height, depth, mask_x, mask_y, mask_z);
+  const auto offsets_x = BuildOffsets(mask_x, width, bytes_per_pixel);
+  const auto offsets_y = BuildOffsets(mask_y, height, bytes_per_pixel);
+  const auto offsets_z = BuildOffsets(mask_z, depth, bytes_per_pixel);
+
+  if constexpr (kBPP != 0) {
+    const bool power_of_two = IsPowerOfTwo(width) && IsPowerOfTwo(height) && IsPowerOfTwo(depth);
+
+    // With at least 4 texels along both axes of a 2D image, the low 4 bits of the swizzled index alternate x, y, x, y.
+    if (power_of_two && depth == 1 && width >= 4 && height >= 4) {
+      for (uint32_t y = 0; y < height; y += 4) {
+        uint8_t *row = linear + y * row_pitch;
+        for (uint32_t x = 0; x < width; x += 4) {
+          TransferTile4x4<kBPP, kToSwizzled>(row + x * kBPP, row_pitch, swizzled + offsets_x[x] + offsets_y[y]);
+        }
+      }
+      return;
+    }
+
+    // Likewise the low 3 bits of a volume alternate x, y, z, making each 2x2x2 block contiguous.
+    if (power_of_two && depth > 1 && width >= 2 && height >= 2) {
+      for (uint32_t z = 0; z < depth; z += 2) {
+        for (uint32_t y = 0; y < height; y += 2) {
+          uint8_t *row = linear + z * slice_pitch + y * row_pitch;
+          const uint32_t offset_yz = offsets_y[y] + offsets_z[z];
+          for (uint32_t x = 0; x < width; x += 2) {
+            uint8_t *texel = row + x * kBPP;
+            uint8_t *out = swizzled + offsets_x[x] + offset_yz;
+            Transfer<2 * kBPP, kToSwizzled>(texel, out);
+            Transfer<2 * kBPP, kToSwizzled>(texel + row_pitch, out + 2 * kBPP);
+            Transfer<2 * kBPP, kToSwizzled>(texel + slice_pitch, out + 4 * kBPP);
+            Transfer<2 * kBPP, kToSwizzled>(texel + slice_pitch + row_pitch, out + 6 * kBPP);
+          }
+        }
+      }
+      return;
+    }
+  }
+
+  for (uint32_t z = 0; z < depth; ++z) {
+    for (uint32_t y = 0; y < height; ++y) {
+      uint8_t *row = linear + z * slice_pitch + y * row_pitch;
+      uint8_t *out = swizzled + offsets_y[y] + offsets_z[z];
+      for (uint32_t x = 0; x < width; ++x) {
+        if constexpr (kBPP != 0) {
+          Transfer<kBPP, kToSwizzled>(row + x * kBPP, out + offsets_x[x]);
+        } else if constexpr (kToSwizzled) {
+          memcpy(out + offsets_x[x], row + x * bytes_per_pixel, bytes_per_pixel);
+        } else {
+          memcpy(row + x * bytes_per_pixel, out + offsets_x[x], bytes_per_pixel);
+        }
+      }
+    }
+  }
+}
+
+using BoxKernel = void (*)(uint8_t *linear, uint8_t *swizzled, uint32_t width, uint32_t height, uint32_t depth,
+                           uint32_t row_pitch, uint32_t slice_pitch, uint32_t bytes_per_pixel);
+
+//! Kernels indexed by bytes per pixel.
+constexpr BoxKernel kSwizzleKernels[] = {nullptr, TransferBox<1, true>, TransferBox<2, true>, nullptr,
+                                         TransferBox<4, true>};
+constexpr BoxKernel kUnswizzleKernels[] = {nullptr, TransferBox<1, false>, TransferBox<2, false>, nullptr,
+                                           TransferBox<4, false>};
+
+BoxKernel SelectKernel(uint32_t bytes_per_pixel, bool to_swizzled) {
+  BoxKernel ret = nullptr;
+  if (bytes_per_pixel < sizeof(kSwizzleKernels) / sizeof(kSwizzleKernels[0])) {
+    ret = to_swizzled ? kSwizzleKernels[bytes_per_pixel] : kUnswizzleKernels[bytes_per_pixel];
+  }
+  if (!ret) {
+    ret = to_swizzled ? TransferBox<0, true> : TransferBox<0, false>;
+  }
+  return ret;
+}
+
+}  // namespace
+
+// The kernels are shared between both directions and take mutable pointers to both images; only the destination is
+// ever written.
+
+void SwizzleRect(const uint8_t *src, uint32_t width, uint32_t height, uint8_t *dst, uint32_t pitch,
+                 uint32_t bytes_per_pixel) {
+  SelectKernel(bytes_per_pixel, true)(const_cast<uint8_t *>(src), dst, width, height, 1, pitch, 0, bytes_per_pixel);
+}
+
+void UnswizzleRect(const uint8_t *src, uint32_t width, uint32_t height, uint8_t *dst, uint32_t pitch,
+                   uint32_t bytes_per_pixel) {
+  SelectKernel(bytes_per_pixel, false)(dst, const_cast<uint8_t *>(src), width, height, 1, pitch, 0, bytes_per_pixel);
+}
+
+void SwizzleBox(const uint8_t *src, uint32_t width, uint32_t height, uint32_t depth, uint8_t *dst, uint32_t row_pitch,
+                uint32_t slice_pitch, uint32_t bytes_per_pixel) {
+  SelectKernel(bytes_per_pixel, true)(const_cast<uint8_t *>(src), dst, width, height, depth, row_pitch, slice_pitch,
+                                      bytes_per_pixel);
+}
+
+void UnswizzleBox(const uint8_t *src, uint32_t width, uint32_t height, uint32_t depth, uint8_t *dst, uint32_t row_pitch,
+                  uint32_t slice_pitch, uint32_t bytes_per_pixel) {
+  SelectKernel(bytes_per_pixel, false)(dst, const_cast<uint8_t *>(src), width, height, depth, row_pitch, slice_pitch,
+                                       bytes_per_pixel);
+}
+
+const char *KernelName() {
+#ifdef __SSE2__
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
+
+}  // namespace TextureSwizzle
@@ -0,0 +1,38 @@
+#ifndef NXDK_PGRAPH_TESTS_TEXTURE_SWIZZLE_H
+#define NXDK_PGRAPH_TESTS_TEXTURE_SWIZZLE_H
+
+#include <cstdint>
+
+/**
+ * Table driven replacements for the xbox-swizzle `swizzle_rect`, `unswizzle_rect`, `swizzle_box`, and `unswizzle_box`
+ * functions. Arguments and output are identical to the xbox-swizzle equivalents.
+ *
+ * The swizzled offset of each column, row, and slice is computed once per call. When every dimension of the image is a
+ * power of two and at least 4 texels (2 for volumes), each 4x4 (2x2x2) group of texels is contiguous in the swizzled
+ * layout and is moved as a single tile. 1, 2, and 4 byte texels use specialized tile kernels (SSE2 when available),
+ * other sizes and small or non-power-of-two images fall back to a per-texel copy.
+ */
+namespace TextureSwizzle {
+
+//! Swizzles the linear `width` x `height` image at `src` (whose rows are `pitch` bytes apart) into `dst`.
+void SwizzleRect(const uint8_t *src, uint32_t width, uint32_t height, uint8_t *dst, uint32_t pitch,
+                 uint32_t bytes_per_pixel);
+
+//! Unswizzles the `width` x `height` image at `src` into `dst`, whose rows are `pitch` bytes apart.
+void UnswizzleRect(const uint8_t *src, uint32_t width, uint32_t height, uint8_t *dst, uint32_t pitch,
+                   uint32_t bytes_per_pixel);
+
+//! Swizzles the linear volume at `src` (with rows `row_pitch` and slices `slice_pitch` bytes apart) into `dst`.
+void SwizzleBox(const uint8_t *src, uint32_t width, uint32_t height, uint32_t depth, uint8_t *dst, uint32_t row_pitch,
+                uint32_t slice_pitch, uint32_t bytes_per_pixel);
+
+//! Unswizzles the volume at `src` into `dst`, whose rows are `row_pitch` and slices `slice_pitch` bytes apart.
+void UnswizzleBox(const uint8_t *src, uint32_t width, uint32_t height, uint32_t depth, uint8_t *dst, uint32_t row_pitch,
+                  uint32_t slice_pitch, uint32_t bytes_per_pixel);
+
+//! Returns a short description of the tile kernels selected at build time (e.g., "sse2").
+const char *KernelName();
+
+}  // namespace TextureSwizzle
+
+#endif  // NXDK_PGRAPH_TESTS_TEXTURE_SWIZZLE_H
@@ -0,0 +1,183 @@
+#include "wait_profiler.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+static WaitProfiler *active_profiler = nullptr;
+
+static constexpr const char *kWaitPointNames[WaitProfiler::kNumWaitPoints] = {
+    "pbkit_busy_wait", "pgraph_idle", "vblank", "finished", "sleep", "capture_fence",
+};
+
+static constexpr char kBetweenTestsName[] = "<between tests>";
+
+void WaitProfiler::Histogram::Merge(const Histogram &other) {
+  for (uint32_t i = 0; i < kNumBuckets; ++i) {
+    buckets[i] += other.buckets[i];
+  }
+}
+
+std::string WaitProfiler::Histogram::Describe() const {
+  std::string ret;
+  char buffer[32];
+  for (uint32_t i = 0; i < kNumBuckets; ++i) {
+    if (!buckets[i]) {
+      continue;
+    }
+    snprintf(buffer, sizeof(buffer), "%s[2^%u]=%u", ret.empty() ? "" : " ", static_cast<unsigned int>(i),
+             static_cast<unsigned int>(buckets[i]));
+    ret += buffer;
+  }
+  return ret;
+}
+
+uint32_t WaitProfiler::Histogram::BucketIndex(uint32_t value) {
+  uint32_t index = 0;
+  while (value > 1) {
+    value >>= 1;
+    ++index;
+  }
+  return index;
+}
+
+void WaitProfiler::WaitStats::Add(uint32_t elapsed_microseconds, uint32_t num_iterations) {
+  ++count;
+  total_microseconds += elapsed_microseconds;
+  max_microseconds = std::max(max_microseconds, elapsed_microseconds);
+  total_iterations += num_iterations;
+  microseconds.Add(elapsed_microseconds);
+  iterations.Add(num_iterations);
+}
+
+void WaitProfiler::WaitStats::Merge(const WaitStats &other) {
+  count += other.count;
+  total_microseconds += other.total_microseconds;
+  max_microseconds = std::max(max_microseconds, other.max_microseconds);
+  total_iterations += other.total_iterations;
+  microseconds.Merge(other.microseconds);
+  iterations.Merge(other.iterations);
+}
+
+uint64_t WaitProfiler::TestProfile::TotalMicroseconds() const {
+  uint64_t ret = 0;
+  for (const auto &wait : waits) {
+    ret += wait.total_microseconds;
+  }
+  return ret;
+}
+
+std::vector<std::string> WaitProfiler::TestProfile::Describe() const {
+  std::vector<std::string> ret;
+  char buffer[128];
+  for (uint32_t i = 0; i < kNumWaitPoints; ++i) {
+    const auto &wait = waits[i];
+    if (!wait.count) {
+      continue;
+    }
+    snprintf(buffer, sizeof(buffer), "%s: %u waits, %" PRIu64 "us total, %uus max, %" PRIu64 " iterations",
+             kWaitPointNames[i], static_cast<unsigned int>(wait.count), wait.total_microseconds,
+             static_cast<unsigned int>(wait.max_microseconds), wait.total_iterations);
+    ret.emplace_back(std::string(buffer) + "; us " + wait.microseconds.Describe() + "; iterations " +
+                     wait.iterations.Describe());
+  }
+  return ret;
+}
+
+WaitProfiler::ScopedWait::~ScopedWait() {
+  auto profiler = WaitProfiler::Active();
+  if (!profiler) {
+    return;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_);
+  profiler->Record(point_, static_cast<uint32_t>(std::min<int64_t>(elapsed.count(), UINT32_MAX)), iterations_);
+}
+
+void WaitProfiler::BeginTest(const std::string &name) {
+  current_ = TestProfile{};
+  current_.name = name;
+  in_test_ = true;
+}
+
+const WaitProfiler::TestProfile &WaitProfiler::EndTest() {
+  if (in_test_) {
+    in_test_ = false;
+    Retain(current_);
+  }
+  return current_;
+}
+
+void WaitProfiler::Record(WaitPoint point, uint32_t elapsed_microseconds, uint32_t num_iterations) {
+  auto index = static_cast<uint32_t>(point);
+  auto &profile = in_test_ ? current_ : between_tests_;
+  profile.waits[index].Add(elapsed_microseconds, num_iterations);
+  totals_[index].Add(elapsed_microseconds, num_iterations);
+}
+
+std::vector<std::string> WaitProfiler::Summarize(uint32_t max_rows) const {
+  std::vector<TestSummary> rows(tests_);
+  if (between_tests_.TotalMicroseconds()) {
+    TestSummary summary{kBetweenTestsName, {}};
+    for (uint32_t i = 0; i < kNumWaitPoints; ++i) {
+      summary.total_microseconds[i] = between_tests_.waits[i].total_microseconds;
+    }
+    rows.push_back(summary);
+  }
+
+  std::stable_sort(rows.begin(), rows.end(),
+                   [](const TestSummary &a, const TestSummary &b) { return a.Total() > b.Total(); });
+  if (rows.size() > max_rows) {
+    rows.resize(max_rows);
+  }
+
+  std::vector<std::string> ret;
+  char buffer[160];
+  snprintf(buffer, sizeof(buffer), "Wait profile: %u tests with the longest waits (milliseconds)",
+           static_cast<unsigned int>(rows.size()));
+  ret.emplace_back(buffer);
+  snprintf(buffer, sizeof(buffer), "%10s %10s %10s %10s %10s %10s %10s  %s", "total", "busy_wait", "pgraph", "vblank",
+           "finished", "sleep", "fence", "test");
+  ret.emplace_back(buffer);
+  for (const auto &row : rows) {
+    auto ms = [](uint64_t microseconds) { return static_cast<unsigned int>(microseconds / 1000); };
+    snprintf(buffer, sizeof(buffer), "%10u %10u %10u %10u %10u %10u %10u  ", ms(row.Total()),
+             ms(row.total_microseconds[0]), ms(row.total_microseconds[1]), ms(row.total_microseconds[2]),
+             ms(row.total_microseconds[3]), ms(row.total_microseconds[4]), ms(row.total_microseconds[5]));
+    ret.emplace_back(buffer + row.name);
+  }
+
+  for (uint32_t i = 0; i < kNumWaitPoints; ++i) {
+    const auto &wait = totals_[i];
+    if (!wait.count) {
+      continue;
+    }
+    snprintf(buffer, sizeof(buffer), "%s: %u waits, %" PRIu64 "us total, %uus max; us ", kWaitPointNames[i],
+             static_cast<unsigned int>(wait.count), wait.total_microseconds,
+             static_cast<unsigned int>(wait.max_microseconds));
+    ret.emplace_back(buffer + wait.microseconds.Describe());
+  }
+
+  return ret;
+}
+
+const char *WaitProfiler::WaitPointName(WaitPoint point) { return kWaitPointNames[static_cast<uint32_t>(point)]; }
+
+void WaitProfiler::SetActive(WaitProfiler *profiler) { active_profiler = profiler; }
+
+WaitProfiler *WaitProfiler::Active() { return active_profiler; }
+
+uint64_t WaitProfiler::TestSummary::Total() const {
+  uint64_t ret = 0;
+  for (auto value : total_microseconds) {
+    ret += value;
+  }
+  return ret;
+}
+
+void WaitProfiler::Retain(const TestProfile &profile) {
+  TestSummary summary{profile.name, {}};
+  for (uint32_t i = 0; i < kNumWaitPoints; ++i) {
+    summary.total_microseconds[i] = profile.waits[i].total_microseconds;
+  }
+  tests_.push_back(std::move(summary));
+}
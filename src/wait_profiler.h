@@ -0,0 +1,130 @@
+#ifndef NXDK_PGRAPH_TESTS_WAIT_PROFILER_H
+#define NXDK_PGRAPH_TESTS_WAIT_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Records how long the harness spends blocked at each kind of wait point, to tell GPU-bound runs from ones that are
+ * dominated by fixed delays.
+ *
+ * Full histograms are kept only for the test that is currently running and are handed back by EndTest for logging.
+ * Across the run, only per-test totals and a merged histogram per wait point are retained, so memory use stays small
+ * regardless of the number of tests.
+ */
+class WaitProfiler {
+ public:
+  enum class WaitPoint {
+    //! TestHost::PBKitBusyWait, waiting for the pushbuffer to drain.
+    PBKIT_BUSY_WAIT = 0,
+    //! Spinning on pb_busy() until PGRAPH is idle.
+    PGRAPH_IDLE,
+    //! pb_wait_for_vbl.
+    VBLANK,
+    //! Spinning on pb_finished() until the buffer swap is accepted.
+    FINISHED,
+    //! Fixed delays (e.g., Sleep).
+    SLEEP,
+    //! Polling a CompletionFence before capturing artifacts.
+    CAPTURE_FENCE,
+  };
+  static constexpr uint32_t kNumWaitPoints = 6;
+
+  //! Number of power of two buckets. Bucket 0 counts values of 0 or 1, bucket N counts values in [2^N, 2^(N+1)).
+  static constexpr uint32_t kNumBuckets = 32;
+
+  struct Histogram {
+    uint32_t buckets[kNumBuckets]{};
+
+    void Add(uint32_t value) { ++buckets[BucketIndex(value)]; }
+    void Merge(const Histogram &other);
+
+    //! Returns the non-empty buckets, e.g. "[2^3]=4 [2^10]=1".
+    [[nodiscard]] std::string Describe() const;
+
+    static uint32_t BucketIndex(uint32_t value);
+  };
+
+  struct WaitStats {
+    uint32_t count{0};
+    uint64_t total_microseconds{0};
+    uint32_t max_microseconds{0};
+    uint64_t total_iterations{0};
+    Histogram microseconds;
+    Histogram iterations;
+
+    void Add(uint32_t elapsed_microseconds, uint32_t num_iterations);
+    void Merge(const WaitStats &other);
+  };
+
+  struct TestProfile {
+    std::string name;
+    WaitStats waits[kNumWaitPoints];
+
+    [[nodiscard]] const WaitStats &Get(WaitPoint point) const { return waits[static_cast<uint32_t>(point)]; }
+    [[nodiscard]] uint64_t TotalMicroseconds() const;
+
+    //! Returns one line per wait point that was hit, describing its totals and histograms.
+    [[nodiscard]] std::vector<std::string> Describe() const;
+  };
+
+  //! Times a single wait, recording it into the active profiler (if any) when destroyed.
+  class ScopedWait {
+   public:
+    explicit ScopedWait(WaitPoint point) : point_(point), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedWait();
+
+    ScopedWait(const ScopedWait &) = delete;
+    ScopedWait &operator=(const ScopedWait &) = delete;
+
+    //! Counts one pass through a polling loop.
+    void Iterate() { ++iterations_; }
+
+   private:
+    WaitPoint point_;
+    std::chrono::steady_clock::time_point start_;
+    uint32_t iterations_{0};
+  };
+
+ public:
+  //! Begins attributing waits to the named test.
+  void BeginTest(const std::string &name);
+
+  //! Ends the current test and returns its profile, which remains valid until the next BeginTest.
+  const TestProfile &EndTest();
+
+  //! Records a single wait. Waits made outside of a test are attributed to "<between tests>".
+  void Record(WaitPoint point, uint32_t elapsed_microseconds, uint32_t num_iterations);
+
+  //! Returns the run-wide statistics for the given wait point.
+  [[nodiscard]] const WaitStats &GetTotals(WaitPoint point) const { return totals_[static_cast<uint32_t>(point)]; }
+
+  //! Returns a table of the `max_rows` tests that spent the longest waiting, followed by run-wide histograms.
+  [[nodiscard]] std::vector<std::string> Summarize(uint32_t max_rows) const;
+
+  static const char *WaitPointName(WaitPoint point);
+
+  //! Sets the profiler used by ScopedWait. May be nullptr to disable profiling.
+  static void SetActive(WaitProfiler *profiler);
+  static WaitProfiler *Active();
+
+ private:
+  struct TestSummary {
+    std::string name;
+    uint64_t total_microseconds[kNumWaitPoints];
+    uint64_t Total() const;
+  };
+
+  void Retain(const TestProfile &profile);
+
+ private:
+  bool in_test_{false};
+  TestProfile current_;
+  TestProfile between_tests_;
+  WaitStats totals_[kNumWaitPoints];
+  std::vector<TestSummary> tests_;
+};
+
+#endif  // NXDK_PGRAPH_TESTS_WAIT_PROFILER_H
@@ -0,0 +1,240 @@
+#include "watchdog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+static TestWatchdog *active_watchdog = nullptr;
+
+static constexpr char kHungPrefix[] = "HUNG ";
+
+bool TimingHistory::Load() {
+  durations_.clear();
+  if (path_.empty()) {
+    return true;
+  }
+
+  {
+    std::ifstream in(path_);
+    if (!in) {
+      return false;
+    }
+
+    std::string line;
+    while (std::getline(in, line)) {
+      auto separator = line.rfind('\t');
+      if (separator == std::string::npos || !separator || separator + 1 == line.size()) {
+        continue;
+      }
+      char *end = nullptr;
+      auto value = strtoul(line.c_str() + separator + 1, &end, 10);
+      if (*end) {
+        continue;
+      }
+      durations_[line.substr(0, separator)] = static_cast<uint32_t>(value);
+    }
+  }
+
+  // Collapse repeated entries so that the file does not grow without bound across runs.
+  std::ofstream out(path_, std::ios_base::trunc);
+  for (const auto &entry : durations_) {
+    out << entry.first << '\t' << entry.second << '\n';
+  }
+  out.flush();
+  return out.good();
+}
+
+bool TimingHistory::Find(const std::string &test_name, uint32_t &milliseconds) const {
+  auto it = durations_.find(test_name);
+  if (it == durations_.end()) {
+    return false;
+  }
+  milliseconds = it->second;
+  return true;
+}
+
+bool TimingHistory::Record(const std::string &test_name, uint32_t milliseconds) {
+  durations_[test_name] = milliseconds;
+  if (path_.empty()) {
+    return true;
+  }
+
+  // Reopened for each record, as with Logger, so that the history survives a hang or crash in a later test.
+  std::ofstream out(path_, std::ios_base::app);
+  out << test_name << '\t' << milliseconds << '\n';
+  out.flush();
+  return out.good();
+}
+
+bool WatchdogCheckpoint::Load() {
+  hung_tests_.clear();
+  std::ifstream in(path_);
+  if (!in) {
+    return false;
+  }
+
+  static constexpr auto kPrefixLength = sizeof(kHungPrefix) - 1;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.size() > kPrefixLength && !line.compare(0, kPrefixLength, kHungPrefix)) {
+      hung_tests_.emplace_back(line.substr(kPrefixLength));
+    }
+  }
+  return HasHangs();
+}
+
+bool WatchdogCheckpoint::RecordHang(const std::string &test_name) {
+  hung_tests_.push_back(test_name);
+
+  std::ofstream out(path_, std::ios_base::app);
+  out << kHungPrefix << test_name << '\n';
+  out.flush();
+  return out.good();
+}
+
+void WatchdogCheckpoint::Clear() {
+  hung_tests_.clear();
+  remove(path_.c_str());
+}
+
+std::set<std::string> WatchdogCheckpoint::SelectSkippedTests(const std::vector<std::string> &ordered_test_names) const {
+  std::set<std::string> ret(hung_tests_.begin(), hung_tests_.end());
+  if (hung_tests_.empty()) {
+    return ret;
+  }
+
+  // If the most recent hang is no longer in the run (e.g., the config changed), nothing is known to have completed.
+  auto resume_point = std::find(ordered_test_names.begin(), ordered_test_names.end(), hung_tests_.back());
+  if (resume_point != ordered_test_names.end()) {
+    ret.insert(ordered_test_names.begin(), std::next(resume_point));
+  }
+  return ret;
+}
+
+uint64_t TestWatchdog::SteadyClock::NowMilliseconds() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+TestWatchdog::TestWatchdog(const Clock &clock, uint32_t default_budget_milliseconds, TimingHistory *history,
+                           ExpiryHandler on_expired)
+    : clock_(clock),
+      default_budget_milliseconds_(default_budget_milliseconds),
+      history_(history),
+      on_expired_(std::move(on_expired)) {}
+
+TestWatchdog::~TestWatchdog() { Stop(); }
+
+uint32_t TestWatchdog::GetBudget(const std::string &test_name) const {
+  uint32_t previous;
+  if (!history_ || !history_->Find(test_name, previous)) {
+    return default_budget_milliseconds_;
+  }
+
+  auto scaled = static_cast<uint64_t>(previous) * kHistoryBudgetMultiplier;
+  return static_cast<uint32_t>(
+      std::min<uint64_t>(UINT32_MAX, std::max<uint64_t>(scaled, kMinimumHistoryBudgetMilliseconds)));
+}
+
+void TestWatchdog::Arm(const std::string &test_name) { Arm(test_name, GetBudget(test_name)); }
+
+void TestWatchdog::Arm(const std::string &test_name, uint32_t budget_milliseconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (state_ == State::EXPIRED || !IsEnabled()) {
+    return;
+  }
+  state_ = State::ARMED;
+  test_name_ = test_name;
+  budget_milliseconds_ = budget_milliseconds;
+  armed_at_ = clock_.NowMilliseconds();
+}
+
+uint32_t TestWatchdog::Disarm() {
+  std::string test_name;
+  uint32_t elapsed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != State::ARMED) {
+      return 0;
+    }
+    state_ = State::IDLE;
+    elapsed = static_cast<uint32_t>(std::min<uint64_t>(UINT32_MAX, clock_.NowMilliseconds() - armed_at_));
+    test_name.swap(test_name_);
+  }
+
+  if (history_) {
+    history_->Record(test_name, elapsed);
+  }
+  return elapsed;
+}
+
+bool TestWatchdog::Poll() {
+  std::string test_name;
+  uint32_t budget;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != State::ARMED) {
+      return state_ == State::EXPIRED;
+    }
+    if (clock_.NowMilliseconds() - armed_at_ < budget_milliseconds_) {
+      return false;
+    }
+    state_ = State::EXPIRED;
+    test_name = test_name_;
+    budget = budget_milliseconds_;
+  }
+
+  // The handler is invoked without holding the lock, as it typically does not return (e.g., it reboots).
+  if (on_expired_) {
+    on_expired_(test_name, budget);
+  }
+  return true;
+}
+
+TestWatchdog::State TestWatchdog::GetState() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return state_;
+}
+
+void TestWatchdog::Start(uint32_t poll_interval_milliseconds) {
+  Stop();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_requested_ = false;
+  }
+  thread_ = std::thread(&TestWatchdog::ThreadMain, this, poll_interval_milliseconds);
+}
+
+void TestWatchdog::Stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_requested_ = true;
+  }
+  stop_signal_.notify_all();
+  thread_.join();
+}
+
+void TestWatchdog::ThreadMain(uint32_t poll_interval_milliseconds) {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (stop_signal_.wait_for(lock, std::chrono::milliseconds(poll_interval_milliseconds),
+                                [this]() { return stop_requested_; })) {
+        return;
+      }
+    }
+
+    if (Poll()) {
+      return;
+    }
+  }
+}
+
+void TestWatchdog::SetActive(TestWatchdog *watchdog) { active_watchdog = watchdog; }
+
+TestWatchdog *TestWatchdog::Active() { return active_watchdog; }
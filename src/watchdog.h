@@ -0,0 +1,173 @@
+#ifndef NXDK_PGRAPH_TESTS_WATCHDOG_H
+#define NXDK_PGRAPH_TESTS_WATCHDOG_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Remembers how long each test took in previous runs so that the watchdog can give slow tests a proportionally larger
+ * budget.
+ *
+ * The history is a text file with one "<suite>::<test>\t<milliseconds>" line per completed test. Lines are appended as
+ * tests complete so that timings survive a hang later in the run; when a test appears more than once the last entry
+ * wins.
+ */
+class TimingHistory {
+ public:
+  //! Creates a history backed by the file at `path`. An empty path produces an in-memory only history.
+  explicit TimingHistory(std::string path) : path_(std::move(path)) {}
+
+  //! Reads the history file, if it exists, and rewrites it with a single entry per test. Malformed lines are ignored.
+  bool Load();
+
+  //! Looks up the most recent duration recorded for the given test.
+  bool Find(const std::string &test_name, uint32_t &milliseconds) const;
+
+  //! Records the duration of a completed test, appending it to the history file immediately.
+  bool Record(const std::string &test_name, uint32_t milliseconds);
+
+  [[nodiscard]] size_t Size() const { return durations_.size(); }
+
+ private:
+  std::string path_;
+  std::map<std::string, uint32_t> durations_;
+};
+
+/**
+ * Persists the tests that caused the watchdog to fire, so that a run restarted after the resulting reboot can skip past
+ * them.
+ *
+ * The checkpoint is a text file with one "HUNG <suite>::<test>" line per hang. It is removed once a run completes
+ * normally.
+ */
+class WatchdogCheckpoint {
+ public:
+  explicit WatchdogCheckpoint(std::string path) : path_(std::move(path)) {}
+
+  //! Reads the checkpoint file. Returns false if it does not exist or records no hangs.
+  bool Load();
+
+  //! Appends a hung test to the checkpoint file, flushing it immediately.
+  bool RecordHang(const std::string &test_name);
+
+  //! Deletes the checkpoint file and forgets any hangs.
+  void Clear();
+
+  [[nodiscard]] bool HasHangs() const { return !hung_tests_.empty(); }
+  //! Returns the hung tests in the order they were recorded.
+  [[nodiscard]] const std::vector<std::string> &GetHungTests() const { return hung_tests_; }
+
+  /**
+   * Selects the tests that a resumed run should skip: every test that has hung, along with every test up to and
+   * including the most recent hang (which already ran before the reboot).
+   *
+   * @param ordered_test_names - Fully qualified names of every test, in the order they would be run.
+   */
+  [[nodiscard]] std::set<std::string> SelectSkippedTests(const std::vector<std::string> &ordered_test_names) const;
+
+ private:
+  std::string path_;
+  std::vector<std::string> hung_tests_;
+};
+
+/**
+ * Detects tests that fail to complete within a time budget (e.g., because the GPU hung inside a pb_busy spin) and
+ * invokes a handler from a background thread so that the hang can be recorded and the run aborted.
+ *
+ * The watchdog is a small state machine driven by Poll, which reads time from an injectable Clock:
+ *   IDLE -Arm-> ARMED -Disarm-> IDLE
+ *                     -Poll, deadline passed-> EXPIRED (terminal; the handler is invoked exactly once)
+ */
+class TestWatchdog {
+ public:
+  class Clock {
+   public:
+    virtual ~Clock() = default;
+    [[nodiscard]] virtual uint64_t NowMilliseconds() const = 0;
+  };
+
+  class SteadyClock : public Clock {
+   public:
+    [[nodiscard]] uint64_t NowMilliseconds() const override;
+  };
+
+  enum class State {
+    IDLE = 0,
+    ARMED,
+    EXPIRED,
+  };
+
+  //! Called when a test exceeds its budget.
+  using ExpiryHandler = std::function<void(const std::string &test_name, uint32_t budget_milliseconds)>;
+
+  //! Tests with a timing history are given this multiple of their previous duration.
+  static constexpr uint32_t kHistoryBudgetMultiplier = 4;
+  //! Lower bound for budgets derived from the timing history, so that very fast tests tolerate ordinary jitter.
+  static constexpr uint32_t kMinimumHistoryBudgetMilliseconds = 10000;
+
+ public:
+  /**
+   * @param clock - Source of time for deadlines.
+   * @param default_budget_milliseconds - Budget for tests without a timing history. 0 disables the watchdog.
+   * @param history - Optional timing history, which is also updated by Disarm.
+   * @param on_expired - Invoked once, from whichever thread calls Poll, when the armed test exceeds its budget.
+   */
+  TestWatchdog(const Clock &clock, uint32_t default_budget_milliseconds, TimingHistory *history,
+               ExpiryHandler on_expired);
+  ~TestWatchdog();
+
+  [[nodiscard]] bool IsEnabled() const { return default_budget_milliseconds_ != 0; }
+
+  //! Returns the budget for the given test, derived from the timing history if possible.
+  [[nodiscard]] uint32_t GetBudget(const std::string &test_name) const;
+
+  //! Starts timing the given test.
+  void Arm(const std::string &test_name);
+  void Arm(const std::string &test_name, uint32_t budget_milliseconds);
+
+  //! Stops timing the current test, recording its duration into the timing history. Returns the elapsed time.
+  uint32_t Disarm();
+
+  //! Checks the deadline of the armed test, invoking the expiry handler if it has passed. Returns true if the watchdog
+  //! has expired.
+  bool Poll();
+
+  [[nodiscard]] State GetState() const;
+
+  //! Starts a thread that calls Poll every `poll_interval_milliseconds` of real time.
+  void Start(uint32_t poll_interval_milliseconds);
+  //! Stops the polling thread, if it is running.
+  void Stop();
+
+  //! Sets the watchdog used by TestSuite::Run. May be nullptr to disable it.
+  static void SetActive(TestWatchdog *watchdog);
+  static TestWatchdog *Active();
+
+ private:
+  void ThreadMain(uint32_t poll_interval_milliseconds);
+
+ private:
+  const Clock &clock_;
+  uint32_t default_budget_milliseconds_;
+  TimingHistory *history_;
+  ExpiryHandler on_expired_;
+
+  mutable std::mutex mutex_;
+  State state_{State::IDLE};
+  std::string test_name_;
+  uint32_t budget_milliseconds_{0};
+  uint64_t armed_at_{0};
+
+  std::thread thread_;
+  std::condition_variable stop_signal_;
+  bool stop_requested_{false};
+};
+
+#endif  // NXDK_PGRAPH_TESTS_WATCHDOG_H
@@ -0,0 +1,16 @@
+#ifndef NXDK_PGRAPH_TESTS_RECORDING_HAL_DEBUG_H
+#define NXDK_PGRAPH_TESTS_RECORDING_HAL_DEBUG_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//! Forwards to DbgPrint; there is no debug screen on the host.
+void debugPrint(const char *format, ...);
+void debugClearScreen(void);
+
+#if defined(__cplusplus)
+}  // extern "C"
+#endif
+
+#endif  // NXDK_PGRAPH_TESTS_RECORDING_HAL_DEBUG_H
@@ -0,0 +1,19 @@
+#ifndef NXDK_PGRAPH_TESTS_RECORDING_HAL_VIDEO_H
+#define NXDK_PGRAPH_TESTS_RECORDING_HAL_VIDEO_H
+
+#include "xboxkrnl/xboxkrnl.h"
+
+#define REFRESH_DEFAULT 0
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//! Sets the dimensions of the framebuffers that are allocated by pb_init().
+BOOL XVideoSetMode(int width, int height, int bpp, int refresh);
+
+#if defined(__cplusplus)
+}  // extern "C"
+#endif
+
+#endif  // NXDK_PGRAPH_TESTS_RECORDING_HAL_VIDEO_H
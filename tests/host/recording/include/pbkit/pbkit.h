@@ -0,0 +1,117 @@
+#ifndef NXDK_PGRAPH_TESTS_RECORDING_PBKIT_H
+#define NXDK_PGRAPH_TESTS_RECORDING_PBKIT_H
+
+// Host replacement for nxdk's pbkit.h. Register and method definitions come from the real nxdk headers; the functions
+// declared here are implemented by the recording backend, which captures every pushbuffer word instead of sending it to
+// hardware.
+
+#include <pbkit/nv_objects.h>
+#include <pbkit/nv_regs.h>
+
+#include "hal/video.h"
+#include "xboxkrnl/xboxkrnl.h"
+
+#define SUBCH_3D 0
+#define SUBCH_2 1
+#define SUBCH_3 2
+#define SUBCH_4 3
+
+// Default channel assignments, matching pbkit.c.
+#define DMA_A 3
+#define DMA_B 4
+#define DMA_CHANNEL_3D_3 6
+#define DMA_CHANNEL_PIXEL_RENDERER 7
+#define DMA_CHANNEL_BITBLT_IMAGES 8
+#define DMA_COLOR 9
+#define DMA_ZETA 10
+#define DMA_VERTEX_A 11
+#define DMA_VERTEX_B 12
+#define DMA_SEMAPHORE 13
+#define DMA_REPORT 14
+
+#define DMA_CLASS_2 2
+#define DMA_CLASS_3 3
+#define DMA_CLASS_3D 0x3D
+
+#define GR_CLASS_12 0x12
+#define GR_CLASS_19 0x19
+#define GR_CLASS_30 0x30
+#define GR_CLASS_39 0x39
+#define GR_CLASS_62 0x62
+#define GR_CLASS_72 0x72
+#define GR_CLASS_97 0x97
+#define GR_CLASS_9F 0x9F
+
+//! Base of the nv2a register window, mapped to ordinary memory by the recording backend.
+#define VIDEO_BASE 0xFD000000
+#define VIDEOREG(x) (*(volatile DWORD *)(VIDEO_BASE + (x)))
+
+#define VRAM_ADDR(x) (((DWORD)(x)) & 0x03FFFFFF)
+
+struct s_CtxDma {
+  DWORD ChannelID;
+  DWORD Inst;
+  DWORD Class;
+  DWORD isGr;
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+void pb_set_fb_size_multiplier(unsigned int multiplier);
+int pb_init(void);
+void pb_kill(void);
+
+DWORD *pb_begin(void);
+void pb_end(DWORD *pEnd);
+void pb_push_to(DWORD subchannel, DWORD *p, DWORD command, DWORD nparam);
+void pb_push(DWORD *p, DWORD command, DWORD nparam);
+DWORD *pb_push1_to(DWORD subchannel, DWORD *p, DWORD command, DWORD param1);
+DWORD *pb_push1(DWORD *p, DWORD command, DWORD param1);
+DWORD *pb_push2(DWORD *p, DWORD command, DWORD param1, DWORD param2);
+DWORD *pb_push3(DWORD *p, DWORD command, DWORD param1, DWORD param2, DWORD param3);
+DWORD *pb_push4(DWORD *p, DWORD command, DWORD param1, DWORD param2, DWORD param3, DWORD param4);
+DWORD *pb_push1f(DWORD *p, DWORD command, float param1);
+DWORD *pb_push2f(DWORD *p, DWORD command, float param1, float param2);
+DWORD *pb_push3f(DWORD *p, DWORD command, float param1, float param2, float param3);
+DWORD *pb_push4f(DWORD *p, DWORD command, float param1, float param2, float param3, float param4);
+
+int pb_busy(void);
+int pb_finished(void);
+void pb_wait_for_vbl(void);
+
+DWORD *pb_back_buffer(void);
+DWORD pb_back_buffer_width(void);
+DWORD pb_back_buffer_height(void);
+DWORD pb_back_buffer_pitch(void);
+DWORD *pb_depth_stencil_buffer(void);
+DWORD pb_depth_stencil_pitch(void);
+DWORD pb_depth_stencil_size(void);
+void pb_target_back_buffer(void);
+void *pb_agp_access(void *fb_memory_pointer);
+void pb_fill(int x, int y, int w, int h, DWORD color);
+
+void pb_create_dma_ctx(DWORD ChannelID, DWORD Class, DWORD Base, DWORD Limit, struct s_CtxDma *pDmaObject);
+void pb_create_gr_ctx(int ChannelID, int Class, struct s_CtxDma *pGrObject);
+void pb_bind_channel(struct s_CtxDma *pCtxDmaObject);
+void pb_bind_subchannel(int subchannel, const struct s_CtxDma *context);
+void pb_set_dma_address(const struct s_CtxDma *context, const void *address, DWORD limit);
+
+void pb_assign_tile(int tile_index, DWORD tile_addr, DWORD tile_size, DWORD tile_pitch, DWORD tile_z_start_tag,
+                    DWORD tile_z_offset, DWORD tile_flags);
+void pb_get_framebuffer_tile_info(DWORD *base, DWORD *size, DWORD *pitch);
+
+void pb_print(const char *format, ...);
+void pb_printat(int row, int col, const char *format, ...);
+void pb_print_char(char c);
+void pb_erase_text_screen(void);
+void pb_draw_text_screen(void);
+void pb_show_front_screen(void);
+void pb_show_debug_screen(void);
+
+#if defined(__cplusplus)
+}  // extern "C"
+#endif
+
+#endif  // NXDK_PGRAPH_TESTS_RECORDING_PBKIT_H
@@ -0,0 +1,6 @@
+#ifndef NXDK_PGRAPH_TESTS_RECORDING_PBKIT_DMA_H
+#define NXDK_PGRAPH_TESTS_RECORDING_PBKIT_DMA_H
+
+#include "pbkit/pbkit.h"
+
+#endif  // NXDK_PGRAPH_TESTS_RECORDING_PBKIT_DMA_H
@@ -0,0 +1,57 @@
+#ifndef NXDK_PGRAPH_TESTS_RECORDING_WINDOWS_H
+#define NXDK_PGRAPH_TESTS_RECORDING_WINDOWS_H
+
+// Subset of the nxdk winapi used by the test harness, implemented on the host by the recording backend.
+
+#include "xboxkrnl/xboxkrnl.h"
+
+#define MAX_PATH 260
+#define ERROR_SUCCESS 0L
+#define ERROR_FILE_NOT_FOUND 2L
+#define ERROR_ALREADY_EXISTS 183L
+
+#define FILE_ATTRIBUTE_DIRECTORY 0x00000010
+
+typedef struct _SECURITY_ATTRIBUTES *LPSECURITY_ATTRIBUTES;
+
+typedef struct _FILETIME {
+  DWORD dwLowDateTime;
+  DWORD dwHighDateTime;
+} FILETIME, *PFILETIME, *LPFILETIME;
+
+typedef enum _GET_FILEEX_INFO_LEVELS { GetFileExInfoStandard, GetFileExMaxInfoLevel } GET_FILEEX_INFO_LEVELS;
+
+typedef struct _WIN32_FILE_ATTRIBUTE_DATA {
+  DWORD dwFileAttributes;
+  FILETIME ftCreationTime;
+  FILETIME ftLastAccessTime;
+  FILETIME ftLastWriteTime;
+  DWORD nFileSizeHigh;
+  DWORD nFileSizeLow;
+} WIN32_FILE_ATTRIBUTE_DATA, *LPWIN32_FILE_ATTRIBUTE_DATA;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//! Returns immediately, but advances GetTickCount by `dwMilliseconds` so that elapsed time measurements still observe
+//! the sleep.
+void Sleep(DWORD dwMilliseconds);
+//! Returns the milliseconds of wall clock time since startup plus the total duration passed to Sleep.
+DWORD GetTickCount(void);
+DWORD GetLastError(void);
+
+BOOL CreateDirectoryA(LPCSTR lpPathName, LPSECURITY_ATTRIBUTES lpSecurityAttributes);
+BOOL GetFileAttributesExA(LPCSTR lpFileName, GET_FILEEX_INFO_LEVELS fInfoLevelId, LPVOID lpFileInformation);
+BOOL DeleteFileA(LPCSTR lpFileName);
+BOOL CopyFileA(LPCSTR lpExistingFileName, LPCSTR lpNewFileName, BOOL bFailIfExists);
+
+#if defined(__cplusplus)
+}  // extern "C"
+#endif
+
+#define CreateDirectory CreateDirectoryA
+#define DeleteFile DeleteFileA
+#define GetFileAttributesEx GetFileAttributesExA
+
+#endif  // NXDK_PGRAPH_TESTS_RECORDING_WINDOWS_H
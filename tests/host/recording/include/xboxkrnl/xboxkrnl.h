@@ -0,0 +1,127 @@
+#ifndef NXDK_PGRAPH_TESTS_RECORDING_XBOXKRNL_H
+#define NXDK_PGRAPH_TESTS_RECORDING_XBOXKRNL_H
+
+// Minimal subset of the nxdk xboxkrnl.h API that is used by the test suites, implemented on the host by the recording
+// backend. Only 32-bit builds are supported as the suites routinely treat pointers as 32-bit physical addresses.
+
+#include <cstddef>
+#include <cstdint>
+
+static_assert(sizeof(void *) == 4, "The recording backend must be built as a 32-bit (-m32) binary");
+
+typedef int BOOL;
+typedef uint8_t BYTE, UCHAR, BOOLEAN;
+typedef char CHAR, *PCHAR;
+typedef uint16_t USHORT, WORD;
+typedef uint32_t DWORD, ULONG, *PULONG, ULONG_PTR, SIZE_T, *PSIZE_T, ACCESS_MASK;
+typedef int32_t LONG, NTSTATUS;
+typedef int64_t LONGLONG;
+typedef void *PVOID, *LPVOID, *HANDLE, **PHANDLE;
+typedef const void *LPCVOID;
+typedef const char *LPCSTR;
+typedef char *LPSTR;
+typedef uintptr_t PHYSICAL_ADDRESS;
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#define STATUS_SUCCESS ((NTSTATUS)0x00000000L)
+#define STATUS_PENDING ((NTSTATUS)0x00000103L)
+#define STATUS_UNSUCCESSFUL ((NTSTATUS)0xC0000001L)
+#define STATUS_OBJECT_NAME_NOT_FOUND ((NTSTATUS)0xC0000034L)
+#define NT_SUCCESS(status) ((NTSTATUS)(status) >= 0)
+
+#define MAXRAM 0x03FFAFFF
+
+#define PAGE_READWRITE 0x04
+#define PAGE_NOCACHE 0x200
+#define PAGE_WRITECOMBINE 0x400
+
+#define GENERIC_READ 0x80000000
+#define GENERIC_WRITE 0x40000000
+#define SYNCHRONIZE 0x00100000
+#define FILE_READ_ATTRIBUTES 0x0080
+
+#define FILE_SHARE_READ 0x00000001
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+
+#define FILE_OPEN 0x00000001
+#define FILE_NON_DIRECTORY_FILE 0x00000040
+#define FILE_RANDOM_ACCESS 0x00000800
+#define FILE_NO_INTERMEDIATE_BUFFERING 0x00000008
+
+#define OBJ_CASE_INSENSITIVE 0x00000040
+
+typedef union _LARGE_INTEGER {
+  struct {
+    DWORD LowPart;
+    LONG HighPart;
+  };
+  struct {
+    DWORD LowPart;
+    LONG HighPart;
+  } u;
+  LONGLONG QuadPart;
+} LARGE_INTEGER, *PLARGE_INTEGER;
+
+typedef struct _STRING {
+  USHORT Length;
+  USHORT MaximumLength;
+  PCHAR Buffer;
+} STRING, *PSTRING, ANSI_STRING, *PANSI_STRING, OBJECT_STRING, *POBJECT_STRING;
+
+typedef struct _OBJECT_ATTRIBUTES {
+  HANDLE RootDirectory;
+  PSTRING ObjectName;
+  ULONG Attributes;
+} OBJECT_ATTRIBUTES, *POBJECT_ATTRIBUTES;
+
+#define InitializeObjectAttributes(p, n, a, r, s) \
+  {                                               \
+    (p)->RootDirectory = r;                       \
+    (p)->Attributes = a;                          \
+    (p)->ObjectName = n;                          \
+  }
+
+#define ObDosDevicesDirectory() ((HANDLE)-3)
+
+typedef struct _IO_STATUS_BLOCK {
+  union {
+    NTSTATUS Status;
+    PVOID Pointer;
+  };
+  ULONG_PTR Information;
+} IO_STATUS_BLOCK, *PIO_STATUS_BLOCK;
+
+typedef void (*PIO_APC_ROUTINE)(PVOID ApcContext, PIO_STATUS_BLOCK IoStatusBlock, ULONG Reserved);
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+ULONG DbgPrint(const char *format, ...);
+
+PVOID MmAllocateContiguousMemory(SIZE_T NumberOfBytes);
+PVOID MmAllocateContiguousMemoryEx(SIZE_T NumberOfBytes, ULONG_PTR LowestAcceptableAddress,
+                                   ULONG_PTR HighestAcceptableAddress, ULONG_PTR Alignment, ULONG Protect);
+void MmFreeContiguousMemory(PVOID BaseAddress);
+PHYSICAL_ADDRESS MmGetPhysicalAddress(PVOID BaseAddress);
+
+void RtlInitAnsiString(PANSI_STRING DestinationString, const char *SourceString);
+
+NTSTATUS NtCreateFile(PHANDLE FileHandle, ACCESS_MASK DesiredAccess, POBJECT_ATTRIBUTES ObjectAttributes,
+                      PIO_STATUS_BLOCK IoStatusBlock, PLARGE_INTEGER AllocationSize, ULONG FileAttributes,
+                      ULONG ShareAccess, ULONG CreateDisposition, ULONG CreateOptions);
+NTSTATUS NtReadFile(HANDLE FileHandle, HANDLE Event, PIO_APC_ROUTINE ApcRoutine, PVOID ApcContext,
+                    PIO_STATUS_BLOCK IoStatusBlock, PVOID Buffer, ULONG Length, PLARGE_INTEGER ByteOffset);
+NTSTATUS NtClose(HANDLE Handle);
+
+#if defined(__cplusplus)
+}  // extern "C"
+#endif
+
+#endif  // NXDK_PGRAPH_TESTS_RECORDING_XBOXKRNL_H
@@ -0,0 +1,266 @@
+#include "pushbuffer_trace.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace PushbufferTrace {
+
+static constexpr uint32_t kNonIncreasingFlag = 0x40000000;
+//! Bits that must be clear for a word to be a (non-jump, non-call) method header.
+static constexpr uint32_t kReservedHeaderMask = 0xA0030003;
+
+bool Load(const std::string &path, std::vector<uint32_t> &words) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) {
+    return false;
+  }
+
+  auto size = static_cast<size_t>(in.tellg());
+  if (size % sizeof(uint32_t)) {
+    return false;
+  }
+
+  words.resize(size / sizeof(uint32_t));
+  in.seekg(0);
+  in.read(reinterpret_cast<char *>(words.data()), static_cast<std::streamsize>(size));
+  return in.good() || (in.eof() && !size);
+}
+
+std::vector<MethodWrite> Normalize(const std::vector<uint32_t> &words) {
+  std::vector<MethodWrite> ret;
+  ret.reserve(words.size());
+
+  size_t i = 0;
+  while (i < words.size()) {
+    const uint32_t header = words[i++];
+    const uint32_t num_params = (header >> 18) & 0x7FF;
+
+    if ((header & kReservedHeaderMask) || num_params > words.size() - i) {
+      ret.push_back({kInvalidSubchannel, 0, header});
+      continue;
+    }
+
+    const uint32_t subchannel = (header >> 13) & 0x07;
+    const uint32_t method = header & 0x1FFC;
+    const uint32_t stride = (header & kNonIncreasingFlag) ? 0 : 4;
+    for (uint32_t param = 0; param < num_params; ++param) {
+      ret.push_back({subchannel, method + param * stride, words[i++]});
+    }
+  }
+
+  return ret;
+}
+
+static constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t RotateLeft(uint64_t value, uint32_t bits) { return (value << bits) | (value >> (64 - bits)); }
+
+static inline uint64_t Read64(const uint8_t *p) {
+  uint64_t ret;
+  memcpy(&ret, p, sizeof(ret));
+  return ret;
+}
+
+static inline uint32_t Read32(const uint8_t *p) {
+  uint32_t ret;
+  memcpy(&ret, p, sizeof(ret));
+  return ret;
+}
+
+static inline uint64_t Round(uint64_t accumulator, uint64_t input) {
+  accumulator += input * kPrime2;
+  accumulator = RotateLeft(accumulator, 31);
+  return accumulator * kPrime1;
+}
+
+static inline uint64_t MergeRound(uint64_t accumulator, uint64_t value) {
+  accumulator ^= Round(0, value);
+  return accumulator * kPrime1 + kPrime4;
+}
+
+uint64_t XXH64(const void *data, size_t length, uint64_t seed) {
+  auto p = static_cast<const uint8_t *>(data);
+  const uint8_t *end = p + length;
+  uint64_t hash;
+
+  if (length >= 32) {
+    const uint8_t *limit = end - 32;
+    uint64_t v1 = seed + kPrime1 + kPrime2;
+    uint64_t v2 = seed + kPrime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - kPrime1;
+
+    do {
+      v1 = Round(v1, Read64(p));
+      v2 = Round(v2, Read64(p + 8));
+      v3 = Round(v3, Read64(p + 16));
+      v4 = Round(v4, Read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+    hash = MergeRound(hash, v1);
+    hash = MergeRound(hash, v2);
+    hash = MergeRound(hash, v3);
+    hash = MergeRound(hash, v4);
+  } else {
+    hash = seed + kPrime5;
+  }
+
+  hash += static_cast<uint64_t>(length);
+
+  while (p + 8 <= end) {
+    hash ^= Round(0, Read64(p));
+    hash = RotateLeft(hash, 27) * kPrime1 + kPrime4;
+    p += 8;
+  }
+
+  if (p + 4 <= end) {
+    hash ^= static_cast<uint64_t>(Read32(p)) * kPrime1;
+    hash = RotateLeft(hash, 23) * kPrime2 + kPrime3;
+    p += 4;
+  }
+
+  while (p < end) {
+    hash ^= (*p++) * kPrime5;
+    hash = RotateLeft(hash, 11) * kPrime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= kPrime2;
+  hash ^= hash >> 29;
+  hash *= kPrime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+uint64_t Hash(const std::vector<MethodWrite> &writes) {
+  static_assert(sizeof(MethodWrite) == 3 * sizeof(uint32_t), "MethodWrite must be tightly packed");
+  return XXH64(writes.data(), writes.size() * sizeof(MethodWrite));
+}
+
+std::string Describe(const MethodWrite &write) {
+  char buf[64];
+  if (write.subchannel == kInvalidSubchannel) {
+    snprintf(buf, sizeof(buf), "<raw> 0x%08X", write.value);
+  } else {
+    snprintf(buf, sizeof(buf), "%u:0x%04X = 0x%08X", write.subchannel, write.method, write.value);
+  }
+  return buf;
+}
+
+std::string Diff(const std::vector<MethodWrite> &expected, const std::vector<MethodWrite> &actual, uint32_t context,
+                 uint32_t max_lines) {
+  size_t prefix = 0;
+  const size_t shortest = std::min(expected.size(), actual.size());
+  while (prefix < shortest && expected[prefix] == actual[prefix]) {
+    ++prefix;
+  }
+
+  size_t suffix = 0;
+  while (suffix < shortest - prefix &&
+         expected[expected.size() - 1 - suffix] == actual[actual.size() - 1 - suffix]) {
+    ++suffix;
+  }
+
+  if (prefix == expected.size() && prefix == actual.size()) {
+    return "";
+  }
+
+  std::stringstream out;
+  uint32_t lines = 0;
+  auto emit = [&out, &lines, max_lines](char marker, size_t index, const MethodWrite &write) {
+    if (lines++ < max_lines) {
+      out << marker << " [" << index << "] " << Describe(write) << "\n";
+    }
+  };
+
+  const size_t context_start = prefix > context ? prefix - context : 0;
+  out << "@@ first difference at write " << prefix << " (expected " << expected.size() << " writes, actual "
+      << actual.size() << " writes) @@\n";
+  for (size_t i = context_start; i < prefix; ++i) {
+    emit(' ', i, expected[i]);
+  }
+  for (size_t i = prefix; i < expected.size() - suffix; ++i) {
+    emit('-', i, expected[i]);
+  }
+  for (size_t i = prefix; i < actual.size() - suffix; ++i) {
+    emit('+', i, actual[i]);
+  }
+  const size_t trailing_end = std::min(actual.size(), actual.size() - suffix + context);
+  for (size_t i = actual.size() - suffix; i < trailing_end; ++i) {
+    emit(' ', i, actual[i]);
+  }
+
+  if (lines > max_lines) {
+    out << "... " << (lines - max_lines) << " more lines\n";
+  }
+
+  return out.str();
+}
+
+bool Manifest::Load(const std::string &path, std::vector<std::string> &errors) {
+  std::ifstream in(path);
+  if (!in) {
+    errors.push_back("Failed to open manifest " + path);
+    return false;
+  }
+
+  std::stringstream content;
+  content << in.rdbuf();
+  return Parse(content.str(), errors);
+}
+
+bool Manifest::Parse(const std::string &content, std::vector<std::string> &errors) {
+  entries_.clear();
+
+  std::istringstream in(content);
+  std::string line;
+  uint32_t line_number = 0;
+  while (std::getline(in, line)) {
+    ++line_number;
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    char key[512];
+    uint64_t hash;
+    uint32_t num_writes;
+    if (sscanf(line.c_str(), "%511s %" SCNx64 " %" SCNu32, key, &hash, &num_writes) != 3) {
+      errors.push_back("Malformed manifest line " + std::to_string(line_number) + ": " + line);
+      continue;
+    }
+
+    entries_[key] = {hash, num_writes};
+  }
+
+  return errors.empty();
+}
+
+std::string Manifest::Serialize() const {
+  std::stringstream out;
+  out << "# <suite>/<test> <xxh64 of normalized trace> <normalized write count>\n";
+  out << "# Regenerate with `trace_golden_check --update`.\n";
+  for (const auto &entry : entries_) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), " %016" PRIx64 " %" PRIu32 "\n", entry.second.hash, entry.second.num_writes);
+    out << entry.first << buf;
+  }
+  return out.str();
+}
+
+bool Manifest::Save(const std::string &path) const {
+  std::ofstream out(path, std::ios::trunc);
+  out << Serialize();
+  return out.good();
+}
+
+}  // namespace PushbufferTrace
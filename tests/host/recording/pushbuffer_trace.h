@@ -0,0 +1,89 @@
+#ifndef NXDK_PGRAPH_TESTS_PUSHBUFFER_TRACE_H
+#define NXDK_PGRAPH_TESTS_PUSHBUFFER_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Utilities for working with the pushbuffer traces written by nxdk_pgraph_tests_recorder.
+ *
+ * A trace is the raw sequence of little-endian words submitted by a single test. Traces are compared in normalized
+ * form: every method header is expanded into one (subchannel, method, value) write per parameter, so the way in which
+ * consecutive methods happened to be batched into headers does not affect the result.
+ */
+namespace PushbufferTrace {
+
+//! A single register write.
+struct MethodWrite {
+  uint32_t subchannel;
+  uint32_t method;
+  uint32_t value;
+
+  bool operator==(const MethodWrite &other) const {
+    return subchannel == other.subchannel && method == other.method && value == other.value;
+  }
+  bool operator!=(const MethodWrite &other) const { return !(*this == other); }
+};
+
+//! Reads a trace file. Returns false if the file cannot be read or is not a whole number of words.
+bool Load(const std::string &path, std::vector<uint32_t> &words);
+
+/**
+ * Expands raw pushbuffer words into individual method writes.
+ *
+ * Words that do not form a valid method header (e.g., jumps or a truncated final method) are emitted with
+ * subchannel kInvalidSubchannel and the raw word as the value so that they still contribute to hashes and diffs.
+ */
+std::vector<MethodWrite> Normalize(const std::vector<uint32_t> &words);
+constexpr uint32_t kInvalidSubchannel = 0xFFFFFFFF;
+
+//! Returns the 64-bit xxHash of the given buffer.
+uint64_t XXH64(const void *data, size_t length, uint64_t seed = 0);
+
+//! Hashes a normalized command stream.
+uint64_t Hash(const std::vector<MethodWrite> &writes);
+
+//! Formats a single write as "<subchannel>:<method> = <value>".
+std::string Describe(const MethodWrite &write);
+
+/**
+ * Produces a human readable diff between two normalized traces.
+ *
+ * Only the region between the longest common prefix and suffix is shown (with `context` unchanged lines on either
+ * side), truncated to at most `max_lines` lines.
+ */
+std::string Diff(const std::vector<MethodWrite> &expected, const std::vector<MethodWrite> &actual,
+                 uint32_t context = 3, uint32_t max_lines = 200);
+
+//! Mapping of "<suite>/<test>" to the expected hash and normalized write count of its trace.
+class Manifest {
+ public:
+  struct Entry {
+    uint64_t hash;
+    uint32_t num_writes;
+
+    bool operator==(const Entry &other) const { return hash == other.hash && num_writes == other.num_writes; }
+  };
+
+ public:
+  //! Parses a manifest. Blank lines and lines beginning with '#' are ignored.
+  bool Load(const std::string &path, std::vector<std::string> &errors);
+  bool Parse(const std::string &content, std::vector<std::string> &errors);
+
+  //! Writes the manifest, sorted by key, such that it may be committed and diffed.
+  bool Save(const std::string &path) const;
+  [[nodiscard]] std::string Serialize() const;
+
+  void Set(const std::string &key, const Entry &entry) { entries_[key] = entry; }
+  [[nodiscard]] const std::map<std::string, Entry> &entries() const { return entries_; }
+
+ private:
+  std::map<std::string, Entry> entries_;
+};
+
+}  // namespace PushbufferTrace
+
+#endif  // NXDK_PGRAPH_TESTS_PUSHBUFFER_TRACE_H
@@ -0,0 +1,145 @@
+#include "recording_backend.h"
+
+#include <strings.h>
+#include <sys/mman.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+static bool MapFixed(uint32_t address, uint32_t size, std::string &error) {
+  auto requested = reinterpret_cast<void *>(address);
+  auto result =
+      mmap(requested, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+  if (result == MAP_FAILED || result != requested) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "Failed to map 0x%X bytes at 0x%08X: %s", size, address, strerror(errno));
+    error = buf;
+    return false;
+  }
+  return true;
+}
+
+RecordingBackend &RecordingBackend::Get() {
+  static RecordingBackend singleton;
+  return singleton;
+}
+
+bool RecordingBackend::Initialize(std::string &error) {
+  if (initialized_) {
+    return true;
+  }
+
+  if (!MapFixed(kContiguousMemoryBase, kContiguousMemorySize, error)) {
+    return false;
+  }
+  if (!MapFixed(kRegisterBase, kRegisterSize, error)) {
+    return false;
+  }
+
+  staging_.resize(kMaxSubmissionDwords);
+  initialized_ = true;
+  return true;
+}
+
+uint32_t *RecordingBackend::BeginSubmission() { return staging_.data(); }
+
+void RecordingBackend::EndSubmission(const uint32_t *end) {
+  const auto num_words = static_cast<uint32_t>(end - staging_.data());
+  if (num_words > kMaxSubmissionDwords) {
+    fprintf(stderr, "Pushbuffer submission of %u words overflowed the %u word staging buffer\n", num_words,
+            kMaxSubmissionDwords);
+    abort();
+  }
+  const uint32_t *begin = staging_.data();
+  trace_.insert(trace_.end(), begin, end);
+  if (submission_observer_) {
+    submission_observer_(begin, num_words);
+  }
+}
+
+void *RecordingBackend::AllocateContiguous(uint32_t size, uint32_t alignment) {
+  if (!alignment) {
+    alignment = 4096;
+  }
+  size = (size + 4095) & ~4095;
+
+  // First fit, scanning upwards from the bottom of the window so that allocation addresses are stable across runs.
+  uint32_t candidate = 0;
+  for (const auto &allocation : contiguous_allocations_) {
+    if (allocation.first >= candidate + size) {
+      break;
+    }
+    candidate = (allocation.first + allocation.second + alignment - 1) & ~(alignment - 1);
+  }
+
+  if (candidate + size > kContiguousMemorySize) {
+    return nullptr;
+  }
+
+  contiguous_allocations_[candidate] = size;
+  auto ret = reinterpret_cast<void *>(kContiguousMemoryBase + candidate);
+  memset(ret, 0, size);
+  return ret;
+}
+
+void RecordingBackend::FreeContiguous(void *address) {
+  auto offset = reinterpret_cast<uint32_t>(address) - kContiguousMemoryBase;
+  contiguous_allocations_.erase(offset);
+}
+
+void RecordingBackend::MapDrive(char drive_letter, const std::string &host_directory) {
+  drive_roots_[static_cast<char>(toupper(drive_letter))] = host_directory;
+}
+
+//! Resolves each component of `relative` beneath `root`, ignoring case as FATX does.
+static fs::path ResolveCaseInsensitive(const fs::path &root, const std::string &relative) {
+  fs::path resolved = root;
+  size_t start = 0;
+  while (start < relative.size()) {
+    auto end = relative.find('\\', start);
+    if (end == std::string::npos) {
+      end = relative.size();
+    }
+    auto component = relative.substr(start, end - start);
+    start = end + 1;
+    if (component.empty()) {
+      continue;
+    }
+
+    auto exact = resolved / component;
+    if (fs::exists(exact) || !fs::is_directory(resolved)) {
+      resolved = exact;
+      continue;
+    }
+
+    bool found = false;
+    for (const auto &entry : fs::directory_iterator(resolved)) {
+      if (!strcasecmp(entry.path().filename().c_str(), component.c_str())) {
+        resolved = entry.path();
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      resolved = exact;
+    }
+  }
+  return resolved;
+}
+
+std::string RecordingBackend::TranslatePath(const char *xbox_path) const {
+  if (!xbox_path || strlen(xbox_path) < 2 || xbox_path[1] != ':') {
+    return xbox_path ? xbox_path : "";
+  }
+
+  auto root = drive_roots_.find(static_cast<char>(toupper(xbox_path[0])));
+  if (root == drive_roots_.end()) {
+    return xbox_path;
+  }
+
+  return ResolveCaseInsensitive(root->second, xbox_path + 2).string();
+}
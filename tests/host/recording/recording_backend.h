@@ -0,0 +1,82 @@
+#ifndef NXDK_PGRAPH_TESTS_RECORDING_BACKEND_H
+#define NXDK_PGRAPH_TESTS_RECORDING_BACKEND_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Host-side stand-in for the nv2a and the parts of the Xbox kernel used by the test suites.
+ *
+ * Every word submitted via pb_begin/pb_end is appended to an in-memory trace instead of being sent to hardware. The
+ * Xbox address layout is reproduced by mapping anonymous memory at the same fixed virtual addresses used on the Xbox:
+ * contiguous allocations are served from the kernel's physical memory window (so `ptr & 0x03FFFFFF` yields a stable
+ * "physical" address) and the nv2a register block is backed by ordinary memory (so VIDEOREG and PGRAPH reads work).
+ * This requires a 32-bit build.
+ */
+class RecordingBackend {
+ public:
+  //! Virtual address at which the Xbox kernel maps physical memory.
+  static constexpr uint32_t kContiguousMemoryBase = 0x80000000;
+  static constexpr uint32_t kContiguousMemorySize = 64 * 1024 * 1024;
+
+  //! Virtual address of the nv2a register block.
+  static constexpr uint32_t kRegisterBase = 0xFD000000;
+  static constexpr uint32_t kRegisterSize = 16 * 1024 * 1024;
+
+  //! Maximum number of words that may be written between a single pb_begin/pb_end pair.
+  static constexpr uint32_t kMaxSubmissionDwords = 256 * 1024;
+
+ public:
+  static RecordingBackend &Get();
+
+  //! Maps the fixed address windows. Must be called before any other pbkit or kernel function is used.
+  bool Initialize(std::string &error);
+
+  //! Returns a staging buffer into which a single pushbuffer submission may be written.
+  uint32_t *BeginSubmission();
+  //! Appends the words written to the staging buffer (up to, but not including, `end`) to the trace.
+  void EndSubmission(const uint32_t *end);
+
+  //! Invoked with the words of each submission as it is appended to the trace.
+  using SubmissionObserver = std::function<void(const uint32_t *words, uint32_t num_words)>;
+  void SetSubmissionObserver(SubmissionObserver observer) { submission_observer_ = std::move(observer); }
+
+  //! Discards the current trace.
+  void ResetTrace() { trace_.clear(); }
+  [[nodiscard]] const std::vector<uint32_t> &trace() const { return trace_; }
+
+  //! Allocates memory within the contiguous memory window. Returns nullptr if the window is exhausted.
+  void *AllocateContiguous(uint32_t size, uint32_t alignment);
+  void FreeContiguous(void *address);
+  //! Releases all contiguous allocations.
+  void ResetContiguous() { contiguous_allocations_.clear(); }
+
+  //! Maps an Xbox drive letter (e.g., 'D') to a host directory.
+  void MapDrive(char drive_letter, const std::string &host_directory);
+  //! Converts an Xbox path (e.g., "d:\\foo\\bar.png") to a host path. Paths without a drive prefix are returned as-is.
+  [[nodiscard]] std::string TranslatePath(const char *xbox_path) const;
+
+  void SetVerbose(bool enable = true) { verbose_ = enable; }
+  [[nodiscard]] bool IsVerbose() const { return verbose_; }
+
+ private:
+  RecordingBackend() = default;
+
+ private:
+  bool initialized_{false};
+  bool verbose_{false};
+
+  std::vector<uint32_t> staging_;
+  std::vector<uint32_t> trace_;
+  SubmissionObserver submission_observer_;
+
+  //! Map of offset within the contiguous window to allocation size.
+  std::map<uint32_t, uint32_t> contiguous_allocations_;
+
+  std::map<char, std::string> drive_roots_;
+};
+
+#endif  // NXDK_PGRAPH_TESTS_RECORDING_BACKEND_H
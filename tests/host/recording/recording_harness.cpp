@@ -0,0 +1,27 @@
+// Host replacements for harness components that depend on Xbox-only services (networking, the debug screen).
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "debug_output.h"
+#include "ftp_logger.h"
+
+extern "C" {
+void _putchar(char character) { putchar(character); }
+}
+
+[[noreturn]] void PrintAssertAndWaitForever(const char *assert_code, const char *filename, uint32_t line) {
+  // There is nobody to reboot the host, so fail the run instead of halting.
+  fprintf(stderr, "ASSERT FAILED: '%s' at %s:%d\n", assert_code, filename, line);
+  abort();
+}
+
+// The recording runner never configures an FTP server, so every transfer fails immediately.
+bool FTPLogger::IsConnected() const { return false; }
+bool FTPLogger::Connect() { return false; }
+bool FTPLogger::Disconnect() { return true; }
+void FTPLogger::ClearLog() { error_log_.clear(); }
+void FTPLogger::LogError(std::string message) { error_log_.emplace_back(std::move(message)); }
+bool FTPLogger::WriteFile(const std::string &filename, const std::string &content) { return false; }
+bool FTPLogger::AppendFile(const std::string &filename, const std::string &content) { return false; }
+bool FTPLogger::PutFile(const std::string &local_filename, const std::string &remote_filename) { return false; }
@@ -0,0 +1,191 @@
+// Host implementations of the Xbox kernel, winapi, and HAL functions used by the test harness.
+
+#include <dlfcn.h>
+#include <hal/debug.h>
+#include <sys/stat.h>
+#include <windows.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "file_util.h"
+#include "recording_backend.h"
+
+static DWORD last_error = ERROR_SUCCESS;
+
+static const auto start_time = std::chrono::steady_clock::now();
+//! Total duration passed to Sleep, which is reported by GetTickCount without actually waiting.
+static std::atomic<uint64_t> slept_milliseconds{0};
+
+//! Number of 100 ns intervals between the FILETIME epoch (1601-01-01) and the Unix epoch.
+static constexpr uint64_t kUnixEpochAsFileTime = 116444736000000000ULL;
+
+static FILETIME ToFileTime(time_t unix_time) {
+  auto value = kUnixEpochAsFileTime + static_cast<uint64_t>(unix_time) * 10000000ULL;
+  return {static_cast<DWORD>(value), static_cast<DWORD>(value >> 32)};
+}
+
+//! Opens a host file, bypassing the path translating fopen defined below.
+static FILE *OpenHostFile(const std::string &path, const char *mode) {
+  using FOpenFunc = FILE *(*)(const char *, const char *);
+  static auto real_fopen = reinterpret_cast<FOpenFunc>(dlsym(RTLD_NEXT, "fopen"));
+  return real_fopen(path.c_str(), mode);
+}
+
+extern "C" {
+
+// Suites and libraries (SDL_image, libstdc++) open files using Xbox paths. Defining fopen in the executable interposes
+// the libc implementation for all of them so that drive letters can be redirected to host directories.
+FILE *fopen(const char *__restrict filename, const char *__restrict modes) {
+  return OpenHostFile(RecordingBackend::Get().TranslatePath(filename), modes);
+}
+
+FILE *fopen64(const char *__restrict filename, const char *__restrict modes) {
+  return OpenHostFile(RecordingBackend::Get().TranslatePath(filename), modes);
+}
+
+ULONG DbgPrint(const char *format, ...) {
+  if (!RecordingBackend::Get().IsVerbose()) {
+    return 0;
+  }
+
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  return 0;
+}
+
+void debugPrint(const char *format, ...) {
+  if (!RecordingBackend::Get().IsVerbose()) {
+    return;
+  }
+
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+}
+
+void debugClearScreen(void) {}
+
+PVOID MmAllocateContiguousMemory(SIZE_T NumberOfBytes) {
+  return RecordingBackend::Get().AllocateContiguous(NumberOfBytes, 0x1000);
+}
+
+PVOID MmAllocateContiguousMemoryEx(SIZE_T NumberOfBytes, ULONG_PTR LowestAcceptableAddress,
+                                   ULONG_PTR HighestAcceptableAddress, ULONG_PTR Alignment, ULONG Protect) {
+  return RecordingBackend::Get().AllocateContiguous(NumberOfBytes, Alignment);
+}
+
+void MmFreeContiguousMemory(PVOID BaseAddress) { RecordingBackend::Get().FreeContiguous(BaseAddress); }
+
+PHYSICAL_ADDRESS MmGetPhysicalAddress(PVOID BaseAddress) { return reinterpret_cast<uintptr_t>(BaseAddress) & 0x03FFFFFF; }
+
+void RtlInitAnsiString(PANSI_STRING DestinationString, const char *SourceString) {
+  auto length = SourceString ? strlen(SourceString) : 0;
+  DestinationString->Buffer = const_cast<PCHAR>(SourceString);
+  DestinationString->Length = static_cast<USHORT>(length);
+  DestinationString->MaximumLength = static_cast<USHORT>(length + 1);
+}
+
+NTSTATUS NtCreateFile(PHANDLE FileHandle, ACCESS_MASK DesiredAccess, POBJECT_ATTRIBUTES ObjectAttributes,
+                      PIO_STATUS_BLOCK IoStatusBlock, PLARGE_INTEGER AllocationSize, ULONG FileAttributes,
+                      ULONG ShareAccess, ULONG CreateDisposition, ULONG CreateOptions) {
+  std::string xbox_path(ObjectAttributes->ObjectName->Buffer, ObjectAttributes->ObjectName->Length);
+  auto file = OpenHostFile(RecordingBackend::Get().TranslatePath(xbox_path.c_str()),
+                           (DesiredAccess & GENERIC_WRITE) ? "r+b" : "rb");
+  if (!file) {
+    IoStatusBlock->Status = STATUS_OBJECT_NAME_NOT_FOUND;
+    return STATUS_OBJECT_NAME_NOT_FOUND;
+  }
+
+  *FileHandle = file;
+  IoStatusBlock->Status = STATUS_SUCCESS;
+  return STATUS_SUCCESS;
+}
+
+NTSTATUS NtReadFile(HANDLE FileHandle, HANDLE Event, PIO_APC_ROUTINE ApcRoutine, PVOID ApcContext,
+                    PIO_STATUS_BLOCK IoStatusBlock, PVOID Buffer, ULONG Length, PLARGE_INTEGER ByteOffset) {
+  auto file = static_cast<FILE *>(FileHandle);
+  if (ByteOffset) {
+    fseek(file, static_cast<long>(ByteOffset->QuadPart), SEEK_SET);
+  }
+
+  // Reads always complete synchronously, so the status block is final by the time this returns.
+  IoStatusBlock->Information = fread(Buffer, 1, Length, file);
+  IoStatusBlock->Status = STATUS_SUCCESS;
+  return STATUS_SUCCESS;
+}
+
+NTSTATUS NtClose(HANDLE Handle) {
+  fclose(static_cast<FILE *>(Handle));
+  return STATUS_SUCCESS;
+}
+
+void Sleep(DWORD dwMilliseconds) { slept_milliseconds += dwMilliseconds; }
+
+DWORD GetTickCount(void) {
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+  return static_cast<DWORD>(static_cast<uint64_t>(elapsed.count()) + slept_milliseconds);
+}
+
+DWORD GetLastError(void) { return last_error; }
+
+BOOL CreateDirectoryA(LPCSTR lpPathName, LPSECURITY_ATTRIBUTES lpSecurityAttributes) {
+  auto path = RecordingBackend::Get().TranslatePath(lpPathName);
+  if (!mkdir(path.c_str(), 0755)) {
+    last_error = ERROR_SUCCESS;
+    return TRUE;
+  }
+
+  last_error = errno == EEXIST ? ERROR_ALREADY_EXISTS : ERROR_FILE_NOT_FOUND;
+  return FALSE;
+}
+
+BOOL GetFileAttributesExA(LPCSTR lpFileName, GET_FILEEX_INFO_LEVELS fInfoLevelId, LPVOID lpFileInformation) {
+  auto path = RecordingBackend::Get().TranslatePath(lpFileName);
+  struct stat info {};
+  if (fInfoLevelId != GetFileExInfoStandard || stat(path.c_str(), &info)) {
+    last_error = ERROR_FILE_NOT_FOUND;
+    return FALSE;
+  }
+
+  auto data = static_cast<LPWIN32_FILE_ATTRIBUTE_DATA>(lpFileInformation);
+  data->dwFileAttributes = S_ISDIR(info.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+  data->ftCreationTime = ToFileTime(info.st_ctime);
+  data->ftLastAccessTime = ToFileTime(info.st_atime);
+  data->ftLastWriteTime = ToFileTime(info.st_mtime);
+  auto size = static_cast<uint64_t>(info.st_size);
+  data->nFileSizeHigh = static_cast<DWORD>(size >> 32);
+  data->nFileSizeLow = static_cast<DWORD>(size);
+  last_error = ERROR_SUCCESS;
+  return TRUE;
+}
+
+BOOL DeleteFileA(LPCSTR lpFileName) {
+  std::error_code error;
+  return std::filesystem::remove(RecordingBackend::Get().TranslatePath(lpFileName), error) ? TRUE : FALSE;
+}
+
+BOOL CopyFileA(LPCSTR lpExistingFileName, LPCSTR lpNewFileName, BOOL bFailIfExists) {
+  auto &backend = RecordingBackend::Get();
+  auto options = bFailIfExists ? std::filesystem::copy_options::none
+                               : std::filesystem::copy_options::overwrite_existing;
+  std::error_code error;
+  return std::filesystem::copy_file(backend.TranslatePath(lpExistingFileName), backend.TranslatePath(lpNewFileName),
+                                    options, error)
+             ? TRUE
+             : FALSE;
+}
+
+}  // extern "C"
+
+BOOL InstallCacheFile(LPCSTR lpExistingFileName, LPCSTR lpNewFileName, BOOL bFailIfExists) {
+  return CopyFileA(lpExistingFileName, lpNewFileName, bFailIfExists);
+}
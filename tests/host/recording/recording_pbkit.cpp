@@ -0,0 +1,201 @@
+// Host implementation of the pbkit API that records pushbuffer contents via RecordingBackend.
+
+#include <pbkit/pbkit.h>
+
+#include <cstring>
+
+#include "recording_backend.h"
+
+namespace {
+
+//! Mirrors the subset of pbkit's framebuffer bookkeeping that is observable by the test suites.
+struct FramebufferState {
+  uint32_t width{640};
+  uint32_t height{480};
+  uint32_t size_multiplier{1};
+  DWORD *color[2]{};
+  DWORD *depth_stencil{};
+  uint32_t back_buffer_index{0};
+  uint32_t next_dma_instance{0x1000};
+};
+
+FramebufferState state;
+
+//! Method 0 of every object class binds an object to the subchannel.
+constexpr DWORD kSetObject = 0x0000;
+
+constexpr DWORD EncodeMethod(DWORD subchannel, DWORD command, DWORD num_params) {
+  return (num_params << 18) | (subchannel << 13) | command;
+}
+
+DWORD FloatBits(float value) {
+  DWORD ret;
+  memcpy(&ret, &value, sizeof(ret));
+  return ret;
+}
+
+uint32_t BufferSize() { return state.width * state.height * 4 * state.size_multiplier; }
+
+}  // namespace
+
+extern "C" {
+
+BOOL XVideoSetMode(int width, int height, int bpp, int refresh) {
+  state.width = width;
+  state.height = height;
+  return TRUE;
+}
+
+void pb_set_fb_size_multiplier(unsigned int multiplier) { state.size_multiplier = multiplier; }
+
+int pb_init(void) {
+  auto &backend = RecordingBackend::Get();
+  for (auto &buffer : state.color) {
+    buffer = static_cast<DWORD *>(backend.AllocateContiguous(BufferSize(), 0x1000));
+  }
+  state.depth_stencil = static_cast<DWORD *>(backend.AllocateContiguous(BufferSize(), 0x1000));
+  return state.color[0] && state.color[1] && state.depth_stencil ? 0 : -1;
+}
+
+void pb_kill(void) {
+  auto &backend = RecordingBackend::Get();
+  for (auto &buffer : state.color) {
+    backend.FreeContiguous(buffer);
+    buffer = nullptr;
+  }
+  backend.FreeContiguous(state.depth_stencil);
+  state.depth_stencil = nullptr;
+}
+
+DWORD *pb_begin(void) { return reinterpret_cast<DWORD *>(RecordingBackend::Get().BeginSubmission()); }
+
+void pb_end(DWORD *pEnd) { RecordingBackend::Get().EndSubmission(reinterpret_cast<const uint32_t *>(pEnd)); }
+
+void pb_push_to(DWORD subchannel, DWORD *p, DWORD command, DWORD nparam) {
+  *p = EncodeMethod(subchannel, command, nparam);
+}
+
+void pb_push(DWORD *p, DWORD command, DWORD nparam) { pb_push_to(SUBCH_3D, p, command, nparam); }
+
+DWORD *pb_push1_to(DWORD subchannel, DWORD *p, DWORD command, DWORD param1) {
+  pb_push_to(subchannel, p, command, 1);
+  p[1] = param1;
+  return p + 2;
+}
+
+DWORD *pb_push1(DWORD *p, DWORD command, DWORD param1) { return pb_push1_to(SUBCH_3D, p, command, param1); }
+
+DWORD *pb_push2(DWORD *p, DWORD command, DWORD param1, DWORD param2) {
+  pb_push(p, command, 2);
+  p[1] = param1;
+  p[2] = param2;
+  return p + 3;
+}
+
+DWORD *pb_push3(DWORD *p, DWORD command, DWORD param1, DWORD param2, DWORD param3) {
+  pb_push(p, command, 3);
+  p[1] = param1;
+  p[2] = param2;
+  p[3] = param3;
+  return p + 4;
+}
+
+DWORD *pb_push4(DWORD *p, DWORD command, DWORD param1, DWORD param2, DWORD param3, DWORD param4) {
+  pb_push(p, command, 4);
+  p[1] = param1;
+  p[2] = param2;
+  p[3] = param3;
+  p[4] = param4;
+  return p + 5;
+}
+
+DWORD *pb_push1f(DWORD *p, DWORD command, float param1) { return pb_push1(p, command, FloatBits(param1)); }
+
+DWORD *pb_push2f(DWORD *p, DWORD command, float param1, float param2) {
+  return pb_push2(p, command, FloatBits(param1), FloatBits(param2));
+}
+
+DWORD *pb_push3f(DWORD *p, DWORD command, float param1, float param2, float param3) {
+  return pb_push3(p, command, FloatBits(param1), FloatBits(param2), FloatBits(param3));
+}
+
+DWORD *pb_push4f(DWORD *p, DWORD command, float param1, float param2, float param3, float param4) {
+  return pb_push4(p, command, FloatBits(param1), FloatBits(param2), FloatBits(param3), FloatBits(param4));
+}
+
+// The recorded GPU completes all work instantly.
+int pb_busy(void) { return 0; }
+int pb_finished(void) {
+  state.back_buffer_index ^= 1;
+  return 0;
+}
+void pb_wait_for_vbl(void) {}
+
+DWORD *pb_back_buffer(void) { return state.color[state.back_buffer_index]; }
+DWORD pb_back_buffer_width(void) { return state.width; }
+DWORD pb_back_buffer_height(void) { return state.height; }
+DWORD pb_back_buffer_pitch(void) { return state.width * 4; }
+DWORD *pb_depth_stencil_buffer(void) { return state.depth_stencil; }
+DWORD pb_depth_stencil_pitch(void) { return state.width * 4; }
+DWORD pb_depth_stencil_size(void) { return BufferSize(); }
+
+void pb_target_back_buffer(void) {
+  auto p = pb_begin();
+  p = pb_push1(p, NV097_SET_SURFACE_COLOR_OFFSET, VRAM_ADDR(pb_back_buffer()));
+  pb_end(p);
+}
+
+void *pb_agp_access(void *fb_memory_pointer) { return fb_memory_pointer; }
+
+void pb_fill(int x, int y, int w, int h, DWORD color) {
+  auto p = pb_begin();
+  p = pb_push1(p, NV097_SET_CLEAR_RECT_HORIZONTAL, ((x + w - 1) << 16) | x);
+  p = pb_push1(p, NV097_SET_CLEAR_RECT_VERTICAL, ((y + h - 1) << 16) | y);
+  p = pb_push1(p, NV097_SET_COLOR_CLEAR_VALUE, color);
+  p = pb_push1(p, NV097_CLEAR_SURFACE, NV097_CLEAR_SURFACE_COLOR);
+  pb_end(p);
+}
+
+void pb_create_dma_ctx(DWORD ChannelID, DWORD Class, DWORD Base, DWORD Limit, struct s_CtxDma *pDmaObject) {
+  pDmaObject->ChannelID = ChannelID;
+  pDmaObject->Inst = state.next_dma_instance++;
+  pDmaObject->Class = Class;
+  pDmaObject->isGr = 0;
+}
+
+void pb_create_gr_ctx(int ChannelID, int Class, struct s_CtxDma *pGrObject) {
+  pGrObject->ChannelID = ChannelID;
+  pGrObject->Inst = state.next_dma_instance++;
+  pGrObject->Class = Class;
+  pGrObject->isGr = 1;
+}
+
+void pb_bind_channel(struct s_CtxDma *pCtxDmaObject) {}
+
+void pb_bind_subchannel(int subchannel, const struct s_CtxDma *context) {
+  auto p = pb_begin();
+  p = pb_push1_to(subchannel, p, kSetObject, context->ChannelID);
+  pb_end(p);
+}
+
+void pb_set_dma_address(const struct s_CtxDma *context, const void *address, DWORD limit) {}
+
+void pb_assign_tile(int tile_index, DWORD tile_addr, DWORD tile_size, DWORD tile_pitch, DWORD tile_z_start_tag,
+                    DWORD tile_z_offset, DWORD tile_flags) {}
+
+void pb_get_framebuffer_tile_info(DWORD *base, DWORD *size, DWORD *pitch) {
+  *base = reinterpret_cast<DWORD>(state.color[0]);
+  *size = BufferSize();
+  *pitch = pb_back_buffer_pitch();
+}
+
+// Text rendering is not part of the recorded trace.
+void pb_print(const char *format, ...) {}
+void pb_printat(int row, int col, const char *format, ...) {}
+void pb_print_char(char c) {}
+void pb_erase_text_screen(void) {}
+void pb_draw_text_screen(void) {}
+void pb_show_front_screen(void) {}
+void pb_show_debug_screen(void) {}
+
+}  // extern "C"
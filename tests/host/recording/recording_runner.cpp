@@ -0,0 +1,272 @@
+// Executes every registered test suite against the recording backend and writes a pushbuffer trace for each test.
+
+#include <SDL.h>
+#include <SDL_image.h>
+#include <fpng/src/fpng.h>
+#include <hal/video.h>
+#include <pbkit/pbkit.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "draw_extractor.h"
+#include "pushbuffer.h"
+#include "pushbuffer_trace.h"
+#include "recording_backend.h"
+#include "runtime_config.h"
+#include "software_rasterizer.h"
+#include "test_host.h"
+#include "test_suite_registry.h"
+#include "tests/test_suite.h"
+
+namespace fs = std::filesystem;
+
+static constexpr int kFramebufferWidth = 640;
+static constexpr int kFramebufferHeight = 480;
+static constexpr int kTextureWidth = 256;
+static constexpr int kTextureHeight = 256;
+
+struct Options {
+  std::string resource_directory;
+  std::string output_directory;
+  uint32_t shard_index{0};
+  uint32_t shard_count{0};
+  std::set<std::string> suites;
+  bool verbose{false};
+  bool reference_images{false};
+};
+
+static void PrintUsage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s --resources <dir> --output <dir> [--shard <index>/<count>] [--suite <name>]... [--reference-images]\n"
+          "          [--verbose]\n"
+          "\n"
+          "  --resources  Directory containing the XBE resources, mapped to D:\n"
+          "  --output     Directory into which traces are written\n"
+          "  --shard      Only run suites whose registration index %% count == index\n"
+          "  --suite      Only run the named suite. May be repeated\n"
+          "  --reference-images\n"
+          "               Rasterize each test's draws in software and write the result to <output>/reference\n"
+          "  --verbose    Forward debug output to stderr\n",
+          program);
+}
+
+static bool ParseArgs(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+    if (!strcmp(arg, "--verbose")) {
+      options.verbose = true;
+      continue;
+    }
+    if (!strcmp(arg, "--reference-images")) {
+      options.reference_images = true;
+      continue;
+    }
+
+    if (!value) {
+      return false;
+    }
+    ++i;
+
+    if (!strcmp(arg, "--resources")) {
+      options.resource_directory = value;
+    } else if (!strcmp(arg, "--output")) {
+      options.output_directory = value;
+    } else if (!strcmp(arg, "--shard")) {
+      if (sscanf(value, "%u/%u", &options.shard_index, &options.shard_count) != 2 || !options.shard_count ||
+          options.shard_index >= options.shard_count) {
+        return false;
+      }
+    } else if (!strcmp(arg, "--suite")) {
+      options.suites.insert(value);
+    } else {
+      return false;
+    }
+  }
+
+  return !options.resource_directory.empty() && !options.output_directory.empty();
+}
+
+//! Converts a suite or test name into something usable as a host filename.
+static std::string SanitizeFilename(const std::string &name) {
+  std::string ret = name;
+  for (auto &c : ret) {
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-' && c != '.') {
+      c = '_';
+    }
+  }
+  return ret;
+}
+
+static bool WriteTrace(const fs::path &path, const std::vector<uint32_t> &trace) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char *>(trace.data()), static_cast<std::streamsize>(trace.size() * sizeof(trace[0])));
+  return out.good();
+}
+
+//! Writes the contents of the given rasterizer as an RGBA PNG.
+static bool WriteReferenceImage(const fs::path &path, const SoftwareRasterizer &rasterizer) {
+  std::vector<uint8_t> rgba;
+  rgba.reserve(rasterizer.pixels().size() * 4);
+  for (auto pixel : rasterizer.pixels()) {
+    rgba.push_back((pixel >> 16) & 0xFF);
+    rgba.push_back((pixel >> 8) & 0xFF);
+    rgba.push_back(pixel & 0xFF);
+    rgba.push_back(pixel >> 24);
+  }
+  return fpng::fpng_encode_image_to_file(path.string().c_str(), rgba.data(), rasterizer.width(), rasterizer.height(),
+                                         4);
+}
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!ParseArgs(argc, argv, options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  auto &backend = RecordingBackend::Get();
+  backend.SetVerbose(options.verbose);
+  {
+    std::string error;
+    if (!backend.Initialize(error)) {
+      fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+    }
+  }
+
+  const fs::path output_root = fs::absolute(options.output_directory);
+  const fs::path trace_root = output_root / "traces";
+  fs::create_directories(trace_root);
+  for (auto drive : {'E', 'Z'}) {
+    auto drive_root = output_root / std::string(1, static_cast<char>(tolower(drive)));
+    fs::create_directories(drive_root);
+    backend.MapDrive(drive, drive_root.string());
+  }
+  backend.MapDrive('D', fs::absolute(options.resource_directory).string());
+
+  // The reference rasterizer consumes each submission as it is made so that vertex arrays are read before the test has
+  // a chance to overwrite them.
+  std::unique_ptr<SoftwareRasterizer> rasterizer;
+  std::unique_ptr<DrawExtractor> extractor;
+  const fs::path reference_root = output_root / "reference";
+  if (options.reference_images) {
+    fs::create_directories(reference_root);
+    rasterizer = std::make_unique<SoftwareRasterizer>(kFramebufferWidth, kFramebufferHeight);
+    extractor = std::make_unique<DrawExtractor>(*rasterizer, [](uint32_t address, uint32_t size) -> const uint8_t * {
+      if (address >= RecordingBackend::kContiguousMemorySize ||
+          size > RecordingBackend::kContiguousMemorySize - address) {
+        return nullptr;
+      }
+      return reinterpret_cast<const uint8_t *>(RecordingBackend::kContiguousMemoryBase + address);
+    });
+    backend.SetSubmissionObserver([&extractor](const uint32_t *words, uint32_t num_words) {
+      for (const auto &write : PushbufferTrace::Normalize(std::vector<uint32_t>(words, words + num_words))) {
+        if (!write.subchannel) {
+          extractor->Process(write.method, write.value);
+        }
+      }
+    });
+  }
+
+  XVideoSetMode(kFramebufferWidth, kFramebufferHeight, 32, REFRESH_DEFAULT);
+  pb_set_fb_size_multiplier(4);
+  if (pb_init()) {
+    fprintf(stderr, "pb_init failed\n");
+    return 1;
+  }
+
+  if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+    fprintf(stderr, "Failed to initialize SDL_image PNG mode: %s\n", SDL_GetError());
+    return 1;
+  }
+
+  Pushbuffer::Initialize();
+
+  RuntimeConfig config;
+  TestHost::EnsureFolderExists(config.output_directory_path());
+
+  // There is no framebuffer content to save, only the commands that would have produced it.
+  TestHost host(nullptr, kFramebufferWidth, kFramebufferHeight, kTextureWidth, kTextureHeight);
+  host.SetSaveResults(false);
+
+  std::vector<std::shared_ptr<TestSuite>> test_suites;
+  RegisterSuites(host, config, test_suites, config.output_directory_path(), nullptr);
+
+  const auto start = std::chrono::steady_clock::now();
+  uint32_t num_suites = 0;
+  uint32_t num_tests = 0;
+  uint64_t num_words = 0;
+
+  for (uint32_t i = 0; i < test_suites.size(); ++i) {
+    auto &suite = test_suites[i];
+    if (options.shard_count && i % options.shard_count != options.shard_index) {
+      continue;
+    }
+    if (!options.suites.empty() && !options.suites.count(suite->Name())) {
+      continue;
+    }
+    if (suite->IsInteractiveOnly()) {
+      continue;
+    }
+
+    const auto suite_dir = trace_root / SanitizeFilename(suite->Name());
+    fs::create_directories(suite_dir);
+    const auto reference_dir = reference_root / SanitizeFilename(suite->Name());
+    if (rasterizer) {
+      fs::create_directories(reference_dir);
+    }
+    ++num_suites;
+
+    // Commands issued by Initialize are attributed to the first test, as they would be on hardware.
+    backend.ResetTrace();
+    suite->Initialize();
+    for (const auto &test_name : suite->TestNames()) {
+      if (suite->IsInteractiveOnlyTest(test_name)) {
+        continue;
+      }
+
+      suite->Run(test_name);
+      Pushbuffer::Flush();
+
+      num_words += backend.trace().size();
+      if (!WriteTrace(suite_dir / (SanitizeFilename(test_name) + ".nv2a"), backend.trace())) {
+        fprintf(stderr, "Failed to write trace for %s::%s\n", suite->Name().c_str(), test_name.c_str());
+        return 1;
+      }
+      backend.ResetTrace();
+      ++num_tests;
+
+      if (rasterizer) {
+        rasterizer->Flush();
+        if (!WriteReferenceImage(reference_dir / (SanitizeFilename(test_name) + ".png"), *rasterizer)) {
+          fprintf(stderr, "Failed to write reference image for %s::%s\n", suite->Name().c_str(), test_name.c_str());
+          return 1;
+        }
+      }
+    }
+    suite->Deinitialize();
+  }
+
+  const auto elapsed =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  printf("Recorded %u tests in %u suites (%llu words) in %lld ms\n", num_tests, num_suites,
+         static_cast<unsigned long long>(num_words), static_cast<long long>(elapsed));
+  if (extractor) {
+    printf("Reference images: %u triangles rasterized, %u draws could not be reproduced\n",
+           extractor->num_triangles(), extractor->unsupported_draws());
+  }
+
+  pb_kill();
+  return 0;
+}
@@ -0,0 +1,254 @@
+// Compares the traces written by nxdk_pgraph_tests_recorder against a committed manifest of expected hashes.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pushbuffer_trace.h"
+
+namespace fs = std::filesystem;
+
+struct Options {
+  std::string trace_directory;
+  std::string manifest_path;
+  std::string reference_directory;
+  std::string diff_directory;
+  uint32_t jobs{0};
+  bool update{false};
+};
+
+struct TraceResult {
+  std::string key;
+  fs::path path;
+  bool loaded{false};
+  PushbufferTrace::Manifest::Entry entry{};
+};
+
+static void PrintUsage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s --traces <dir> --manifest <file> [--reference <dir>] [--diff-output <dir>] [--jobs <n>] "
+          "[--update]\n"
+          "\n"
+          "  --traces       The `traces` directory written by nxdk_pgraph_tests_recorder\n"
+          "  --manifest     The golden hash manifest\n"
+          "  --reference    A `traces` directory recorded from a known good revision, used to produce decoded diffs\n"
+          "  --diff-output  Directory into which diffs (or decoded traces if no reference is given) are written\n"
+          "  --jobs         Number of hashing threads. Defaults to the number of hardware threads\n"
+          "  --update       Rewrite the manifest from the given traces instead of comparing\n",
+          program);
+}
+
+static bool ParseArgs(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+    if (!strcmp(arg, "--update")) {
+      options.update = true;
+      continue;
+    }
+
+    if (!value) {
+      return false;
+    }
+    ++i;
+
+    if (!strcmp(arg, "--traces")) {
+      options.trace_directory = value;
+    } else if (!strcmp(arg, "--manifest")) {
+      options.manifest_path = value;
+    } else if (!strcmp(arg, "--reference")) {
+      options.reference_directory = value;
+    } else if (!strcmp(arg, "--diff-output")) {
+      options.diff_directory = value;
+    } else if (!strcmp(arg, "--jobs")) {
+      options.jobs = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+    } else {
+      return false;
+    }
+  }
+
+  return !options.trace_directory.empty() && !options.manifest_path.empty();
+}
+
+static std::vector<TraceResult> FindTraces(const fs::path &root) {
+  std::vector<TraceResult> ret;
+  for (const auto &entry : fs::recursive_directory_iterator(root)) {
+    if (!entry.is_regular_file() || entry.path().extension() != ".nv2a") {
+      continue;
+    }
+
+    auto key = fs::relative(entry.path(), root).replace_extension().generic_string();
+    ret.push_back({key, entry.path()});
+  }
+
+  // Sort so that output is stable regardless of directory iteration order.
+  std::sort(ret.begin(), ret.end(), [](const TraceResult &a, const TraceResult &b) { return a.key < b.key; });
+  return ret;
+}
+
+//! Loads, normalizes, and hashes every trace, distributing the work across `jobs` threads.
+static void HashTraces(std::vector<TraceResult> &traces, uint32_t jobs) {
+  std::atomic<size_t> next_index{0};
+  auto worker = [&traces, &next_index]() {
+    std::vector<uint32_t> words;
+    for (size_t i = next_index++; i < traces.size(); i = next_index++) {
+      auto &trace = traces[i];
+      if (!PushbufferTrace::Load(trace.path.string(), words)) {
+        continue;
+      }
+      auto writes = PushbufferTrace::Normalize(words);
+      trace.entry = {PushbufferTrace::Hash(writes), static_cast<uint32_t>(writes.size())};
+      trace.loaded = true;
+    }
+  };
+
+  jobs = std::max(1U, std::min<uint32_t>(jobs, traces.size()));
+  std::vector<std::thread> threads;
+  threads.reserve(jobs - 1);
+  for (uint32_t i = 1; i < jobs; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+static std::vector<PushbufferTrace::MethodWrite> LoadNormalized(const fs::path &path) {
+  std::vector<uint32_t> words;
+  if (!PushbufferTrace::Load(path.string(), words)) {
+    return {};
+  }
+  return PushbufferTrace::Normalize(words);
+}
+
+//! Writes (and prints the head of) a decoded diff for a mismatched trace.
+static void ReportMismatch(const Options &options, const TraceResult &trace) {
+  const auto actual = LoadNormalized(trace.path);
+  std::string report;
+
+  fs::path reference_path;
+  if (!options.reference_directory.empty()) {
+    reference_path = fs::path(options.reference_directory) / (trace.key + ".nv2a");
+  }
+
+  if (!reference_path.empty() && fs::exists(reference_path)) {
+    report = PushbufferTrace::Diff(LoadNormalized(reference_path), actual);
+  } else {
+    for (const auto &write : actual) {
+      report += PushbufferTrace::Describe(write) + "\n";
+    }
+  }
+
+  if (!options.diff_directory.empty()) {
+    auto output_path = fs::path(options.diff_directory) / (trace.key + ".txt");
+    fs::create_directories(output_path.parent_path());
+    std::ofstream(output_path, std::ios::trunc) << report;
+    fprintf(stderr, "  decoded output written to %s\n", output_path.string().c_str());
+  }
+
+  if (!reference_path.empty() && fs::exists(reference_path)) {
+    // Diffs are already bounded by PushbufferTrace::Diff, so they're small enough to print inline.
+    fprintf(stderr, "%s", report.c_str());
+  }
+}
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!ParseArgs(argc, argv, options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  auto traces = FindTraces(options.trace_directory);
+  if (traces.empty()) {
+    fprintf(stderr, "No traces found in %s\n", options.trace_directory.c_str());
+    return 1;
+  }
+
+  HashTraces(traces, options.jobs ? options.jobs : std::thread::hardware_concurrency());
+
+  if (options.update) {
+    PushbufferTrace::Manifest manifest;
+    for (const auto &trace : traces) {
+      if (trace.loaded) {
+        manifest.Set(trace.key, trace.entry);
+      }
+    }
+    if (!manifest.Save(options.manifest_path)) {
+      fprintf(stderr, "Failed to write manifest %s\n", options.manifest_path.c_str());
+      return 1;
+    }
+    printf("Wrote %zu entries to %s\n", manifest.entries().size(), options.manifest_path.c_str());
+    return 0;
+  }
+
+  PushbufferTrace::Manifest manifest;
+  std::vector<std::string> errors;
+  if (!manifest.Load(options.manifest_path, errors)) {
+    for (const auto &error : errors) {
+      fprintf(stderr, "%s\n", error.c_str());
+    }
+    return 1;
+  }
+
+  // An empty manifest would otherwise report every trace as missing without comparing anything meaningful.
+  if (manifest.entries().empty()) {
+    fprintf(stderr, "FAIL: %s has no entries; seed it with --update from a known good build\n",
+            options.manifest_path.c_str());
+    return 1;
+  }
+
+  uint32_t failures = 0;
+  std::vector<std::string> seen;
+  seen.reserve(traces.size());
+  for (const auto &trace : traces) {
+    seen.push_back(trace.key);
+    if (!trace.loaded) {
+      fprintf(stderr, "FAIL %s: unreadable trace %s\n", trace.key.c_str(), trace.path.string().c_str());
+      ++failures;
+      continue;
+    }
+
+    auto expected = manifest.entries().find(trace.key);
+    if (expected == manifest.entries().end()) {
+      fprintf(stderr, "FAIL %s: not present in manifest (run with --update to accept)\n", trace.key.c_str());
+      ++failures;
+      continue;
+    }
+
+    if (expected->second == trace.entry) {
+      continue;
+    }
+
+    fprintf(stderr, "FAIL %s: expected %016" PRIx64 " (%u writes), got %016" PRIx64 " (%u writes)\n",
+            trace.key.c_str(), expected->second.hash, expected->second.num_writes, trace.entry.hash,
+            trace.entry.num_writes);
+    ReportMismatch(options, trace);
+    ++failures;
+  }
+
+  // Tests that vanished are regressions too, since they're no longer being exercised.
+  for (const auto &entry : manifest.entries()) {
+    if (!std::binary_search(seen.begin(), seen.end(), entry.first)) {
+      fprintf(stderr, "FAIL %s: present in manifest but no trace was recorded\n", entry.first.c_str());
+      ++failures;
+    }
+  }
+
+  const auto elapsed =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  printf("Checked %zu traces in %lld ms, %u failures\n", traces.size(), static_cast<long long>(elapsed), failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,787 @@
+#include "combiner_model.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//! Number of pixels evaluated together. Sized so that the register file of a batch fits comfortably in L1.
+static constexpr uint32_t kBatchSize = 64;
+
+//! Images with fewer pixels than this are evaluated on the calling thread, as spawning workers would dominate.
+static constexpr uint32_t kMinParallelPixels = 64 * 1024;
+
+//! Number of batches claimed by a worker at a time.
+static constexpr uint32_t kBatchesPerClaim = 32;
+
+// Values are held in units of 1/255 so that register contents are whole numbers and every intermediate up to the
+// rounding step (including the halves produced by the half bias mappings) is exact in single precision. This keeps
+// ties deterministic and the vectorized and scalar kernels bit identical.
+static constexpr float kOne = 255.f;
+
+// Registers are indexed by CombinerSource. The final combiner's SRC_SPEC_R0_SUM and SRC_EF_PROD are stored in the
+// last two slots.
+static constexpr uint32_t kNumRegisters = 16;
+
+namespace {
+
+struct alignas(16) Plane {
+  float v[kBatchSize];
+};
+
+struct RegisterFile {
+  Plane regs[kNumRegisters][4];
+};
+
+//! Input mappings expressed as scale * (clamp_negative ? max(0, x) : x) + bias.
+struct MappingParams {
+  bool clamp_negative;
+  float scale;
+  float bias;
+};
+
+constexpr MappingParams kMappings[] = {
+    {true, 1.f, 0.f},           // MAP_UNSIGNED_IDENTITY
+    {true, -1.f, kOne},         // MAP_UNSIGNED_INVERT
+    {true, 2.f, -kOne},         // MAP_EXPAND_NORMAL
+    {true, -2.f, kOne},         // MAP_EXPAND_NEGATE
+    {true, 1.f, -kOne * 0.5f},  // MAP_HALFBIAS_NORMAL
+    {true, -1.f, kOne * 0.5f},  // MAP_HALFBIAS_NEGATE
+    {false, 1.f, 0.f},          // MAP_SIGNED_IDENTITY
+    {false, -1.f, 0.f},         // MAP_SIGNED_NEGATE
+};
+
+//! Output operations expressed as (x + bias) * scale.
+struct OutputParams {
+  float bias;
+  float scale;
+};
+
+OutputParams GetOutputParams(CombinerModel::CombinerOutOp op) {
+  switch (op) {
+    case CombinerModel::OP_IDENTITY:
+    default:
+      return {0.f, 1.f};
+    case CombinerModel::OP_BIAS:
+      return {-kOne * 0.5f, 1.f};
+    case CombinerModel::OP_SHIFT_LEFT_1:
+      return {0.f, 2.f};
+    case CombinerModel::OP_SHIFT_LEFT_1_BIAS:
+      return {-kOne * 0.5f, 2.f};
+    case CombinerModel::OP_SHIFT_LEFT_2:
+      return {0.f, 4.f};
+    case CombinerModel::OP_SHIFT_RIGHT_1:
+      return {0.f, 0.5f};
+  }
+}
+
+void Fill(Plane &out, float value) { std::fill(std::begin(out.v), std::end(out.v), value); }
+
+//! Converts 0xAARRGGBB pixels into R, G, B, A planes.
+template <bool kVectorized>
+void Unpack(const uint32_t *argb, uint32_t count, Plane *out) {
+  if (!argb) {
+    for (uint32_t channel = 0; channel < 4; ++channel) {
+      Fill(out[channel], 0.f);
+    }
+    return;
+  }
+
+  alignas(16) uint32_t pixels[kBatchSize];
+  memcpy(pixels, argb, count * sizeof(uint32_t));
+  memset(pixels + count, 0, (kBatchSize - count) * sizeof(uint32_t));
+
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      const __m128i value = _mm_load_si128(reinterpret_cast<const __m128i *>(pixels + i));
+      _mm_store_ps(out[0].v + i, _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(value, 16), mask)));
+      _mm_store_ps(out[1].v + i, _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(value, 8), mask)));
+      _mm_store_ps(out[2].v + i, _mm_cvtepi32_ps(_mm_and_si128(value, mask)));
+      _mm_store_ps(out[3].v + i, _mm_cvtepi32_ps(_mm_srli_epi32(value, 24)));
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    const uint32_t value = pixels[i];
+    out[0].v[i] = static_cast<float>((value >> 16) & 0xFF);
+    out[1].v[i] = static_cast<float>((value >> 8) & 0xFF);
+    out[2].v[i] = static_cast<float>(value & 0xFF);
+    out[3].v[i] = static_cast<float>(value >> 24);
+  }
+}
+
+//! Clamps R, G, B, A planes to [0, 255] and rounds them into 0xAARRGGBB pixels.
+template <bool kVectorized>
+void Pack(const Plane *in, uint32_t count, uint32_t *argb) {
+  alignas(16) uint32_t pixels[kBatchSize];
+
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(kOne);
+    auto convert = [&](const Plane &plane, uint32_t i) {
+      return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_load_ps(plane.v + i), zero), one));
+    };
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      __m128i value = _mm_slli_epi32(convert(in[3], i), 24);
+      value = _mm_or_si128(value, _mm_slli_epi32(convert(in[0], i), 16));
+      value = _mm_or_si128(value, _mm_slli_epi32(convert(in[1], i), 8));
+      value = _mm_or_si128(value, convert(in[2], i));
+      _mm_store_si128(reinterpret_cast<__m128i *>(pixels + i), value);
+    }
+    memcpy(argb, pixels, count * sizeof(uint32_t));
+    return;
+  }
+#endif
+
+  auto convert = [](float value) {
+    return static_cast<uint32_t>(std::nearbyint(std::min(std::max(value, 0.f), kOne)));
+  };
+  for (uint32_t i = 0; i < count; ++i) {
+    pixels[i] = (convert(in[3].v[i]) << 24) | (convert(in[0].v[i]) << 16) | (convert(in[1].v[i]) << 8) |
+                convert(in[2].v[i]);
+  }
+  memcpy(argb, pixels, count * sizeof(uint32_t));
+}
+
+template <bool kVectorized>
+void Map(const Plane &in, const MappingParams &params, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128 scale = _mm_set1_ps(params.scale);
+    const __m128 bias = _mm_set1_ps(params.bias);
+    const __m128 floor = _mm_set1_ps(params.clamp_negative ? 0.f : -INFINITY);
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      const __m128 value = _mm_max_ps(_mm_load_ps(in.v + i), floor);
+      _mm_store_ps(out.v + i, _mm_add_ps(_mm_mul_ps(value, scale), bias));
+    }
+    return;
+  }
+#endif
+
+  const float floor = params.clamp_negative ? 0.f : -INFINITY;
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    out.v[i] = std::max(in.v[i], floor) * params.scale + params.bias;
+  }
+}
+
+//! Computes a * b + c * d.
+template <bool kVectorized>
+void MultiplyAdd(const Plane &a, const Plane &b, const Plane &c, const Plane &d, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      const __m128 ab = _mm_mul_ps(_mm_load_ps(a.v + i), _mm_load_ps(b.v + i));
+      const __m128 cd = _mm_mul_ps(_mm_load_ps(c.v + i), _mm_load_ps(d.v + i));
+      _mm_store_ps(out.v + i, _mm_add_ps(ab, cd));
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    out.v[i] = a.v[i] * b.v[i] + c.v[i] * d.v[i];
+  }
+}
+
+template <bool kVectorized>
+void Multiply(const Plane &a, const Plane &b, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      _mm_store_ps(out.v + i, _mm_mul_ps(_mm_load_ps(a.v + i), _mm_load_ps(b.v + i)));
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    out.v[i] = a.v[i] * b.v[i];
+  }
+}
+
+template <bool kVectorized>
+void Add(const Plane &a, const Plane &b, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      _mm_store_ps(out.v + i, _mm_add_ps(_mm_load_ps(a.v + i), _mm_load_ps(b.v + i)));
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    out.v[i] = a.v[i] + b.v[i];
+  }
+}
+
+//! Computes the RGB dot product of `a` and `b`.
+template <bool kVectorized>
+void Dot3(const Plane *const *a, const Plane *const *b, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      __m128 sum = _mm_mul_ps(_mm_load_ps(a[0]->v + i), _mm_load_ps(b[0]->v + i));
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(a[1]->v + i), _mm_load_ps(b[1]->v + i)));
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(a[2]->v + i), _mm_load_ps(b[2]->v + i)));
+      _mm_store_ps(out.v + i, sum);
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    out.v[i] = a[0]->v[i] * b[0]->v[i] + a[1]->v[i] * b[1]->v[i] + a[2]->v[i] * b[2]->v[i];
+  }
+}
+
+//! Selects `cd` where `selector_bit` is set in the 9-bit representation of `r0_alpha`, `ab` elsewhere.
+template <bool kVectorized>
+void Mux(const Plane &ab, const Plane &cd, const Plane &r0_alpha, uint32_t selector_bit, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128i bit = _mm_set1_epi32(static_cast<int>(selector_bit));
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      const __m128i value = _mm_cvtps_epi32(_mm_load_ps(r0_alpha.v + i));
+      const __m128 use_ab = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(value, bit), _mm_setzero_si128()));
+      const __m128 result =
+          _mm_or_ps(_mm_and_ps(use_ab, _mm_load_ps(ab.v + i)), _mm_andnot_ps(use_ab, _mm_load_ps(cd.v + i)));
+      _mm_store_ps(out.v + i, result);
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    const auto value = static_cast<int32_t>(std::nearbyint(r0_alpha.v[i]));
+    out.v[i] = (static_cast<uint32_t>(value) & selector_bit) ? cd.v[i] : ab.v[i];
+  }
+}
+
+/**
+ * Converts a product (in units of 1/255^2) to a register value: the output operation is applied, then the result is
+ * clamped to [-1, 1] and rounded to the nearest 9-bit signed value.
+ */
+template <bool kVectorized>
+void Output(const Plane &in, const OutputParams &params, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128 one = _mm_set1_ps(kOne);
+    const __m128 bias = _mm_set1_ps(params.bias);
+    const __m128 scale = _mm_set1_ps(params.scale);
+    const __m128 min = _mm_set1_ps(-kOne);
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      __m128 value = _mm_mul_ps(_mm_add_ps(_mm_div_ps(_mm_load_ps(in.v + i), one), bias), scale);
+      value = _mm_min_ps(_mm_max_ps(value, min), one);
+      _mm_store_ps(out.v + i, _mm_cvtepi32_ps(_mm_cvtps_epi32(value)));
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    const float value = (in.v[i] / kOne + params.bias) * params.scale;
+    out.v[i] = std::nearbyint(std::min(std::max(value, -kOne), kOne));
+  }
+}
+
+template <bool kVectorized>
+void ClampMax(Plane &inout, float max_value) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128 max = _mm_set1_ps(max_value);
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      _mm_store_ps(inout.v + i, _mm_min_ps(_mm_load_ps(inout.v + i), max));
+    }
+    return;
+  }
+#endif
+
+  for (auto &value : inout.v) {
+    value = std::min(value, max_value);
+  }
+}
+
+//! Computes the final combiner's E * F.
+template <bool kVectorized>
+void FinalProduct(const Plane &e, const Plane &f, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128 one = _mm_set1_ps(kOne);
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      _mm_store_ps(out.v + i, _mm_div_ps(_mm_mul_ps(_mm_load_ps(e.v + i), _mm_load_ps(f.v + i)), one));
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    out.v[i] = e.v[i] * f.v[i] / kOne;
+  }
+}
+
+//! Computes A * B + (1 - A) * C + D.
+template <bool kVectorized>
+void FinalLerp(const Plane &a, const Plane &b, const Plane &c, const Plane &d, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128 one = _mm_set1_ps(kOne);
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      const __m128 a_value = _mm_load_ps(a.v + i);
+      __m128 result = _mm_mul_ps(a_value, _mm_load_ps(b.v + i));
+      result = _mm_add_ps(result, _mm_mul_ps(_mm_sub_ps(one, a_value), _mm_load_ps(c.v + i)));
+      result = _mm_add_ps(_mm_div_ps(result, one), _mm_load_ps(d.v + i));
+      _mm_store_ps(out.v + i, result);
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    out.v[i] = (a.v[i] * b.v[i] + (kOne - a.v[i]) * c.v[i]) / kOne + d.v[i];
+  }
+}
+
+//! SRC_ZERO under each input mapping, which covers ZeroInput, OneInput and NegativeOneInput without any work.
+struct ConstantPlanes {
+  ConstantPlanes() {
+    for (uint32_t i = 0; i < std::size(kMappings); ++i) {
+      Fill(mapped_zero[i], kMappings[i].bias);
+    }
+  }
+
+  Plane mapped_zero[std::size(kMappings)];
+};
+
+//! Which results of a combiner portion are written to a register.
+struct PortionOutputs {
+  bool ab;
+  bool cd;
+  bool sum;
+
+  [[nodiscard]] bool any() const { return ab || cd || sum; }
+};
+
+/**
+ * Evaluates one half (RGB or alpha) of a general combiner stage into `ab`, `cd` and `sum` register values. Results
+ * that are not written are left unevaluated.
+ */
+template <bool kVectorized>
+void EvaluatePortion(const RegisterFile &file, const ConstantPlanes &constants,
+                     const CombinerModel::CombinerInput *input_config, bool alpha_portion, bool ab_dot_product,
+                     bool cd_dot_product, bool mux, uint32_t mux_bit, CombinerModel::CombinerOutOp op,
+                     const PortionOutputs &outputs, Plane (&ab)[3], Plane (&cd)[3], Plane (&sum)[3]) {
+  const uint32_t num_channels = alpha_portion ? 1 : 3;
+
+  // Resolves each input to a mapped plane per channel. Alpha portions read blue unless alpha is selected.
+  Plane mapped[4][3];
+  const Plane *inputs[4][3];
+  for (uint32_t input = 0; input < 4; ++input) {
+    const auto &config = input_config[input];
+    if (config.source == CombinerModel::SRC_ZERO) {
+      for (uint32_t channel = 0; channel < num_channels; ++channel) {
+        inputs[input][channel] = &constants.mapped_zero[config.mapping];
+      }
+      continue;
+    }
+
+    const auto &reg = file.regs[config.source];
+    for (uint32_t channel = 0; channel < num_channels; ++channel) {
+      const Plane &source = reg[config.alpha ? 3 : (alpha_portion ? 2 : channel)];
+      if (config.mapping == CombinerModel::MAP_SIGNED_IDENTITY) {
+        inputs[input][channel] = &source;
+        continue;
+      }
+      Map<kVectorized>(source, kMappings[config.mapping], mapped[input][channel]);
+      inputs[input][channel] = &mapped[input][channel];
+    }
+  }
+
+  const auto params = GetOutputParams(op);
+  ab_dot_product = ab_dot_product && !alpha_portion;
+  cd_dot_product = cd_dot_product && !alpha_portion;
+
+  // The common case of a plain sum of products is formed in a single pass.
+  if (!mux && !ab_dot_product && !cd_dot_product && !outputs.ab && !outputs.cd) {
+    for (uint32_t channel = 0; channel < num_channels; ++channel) {
+      MultiplyAdd<kVectorized>(*inputs[0][channel], *inputs[1][channel], *inputs[2][channel], *inputs[3][channel],
+                               sum[channel]);
+      Output<kVectorized>(sum[channel], params, sum[channel]);
+    }
+    return;
+  }
+
+  auto product = [&](const Plane *const *a, const Plane *const *b, bool dot_product, Plane(&out)[3]) {
+    if (dot_product) {
+      Dot3<kVectorized>(a, b, out[0]);
+      out[1] = out[0];
+      out[2] = out[0];
+      return;
+    }
+    for (uint32_t channel = 0; channel < num_channels; ++channel) {
+      Multiply<kVectorized>(*a[channel], *b[channel], out[channel]);
+    }
+  };
+  product(inputs[0], inputs[1], ab_dot_product, ab);
+  product(inputs[2], inputs[3], cd_dot_product, cd);
+
+  const auto &r0_alpha = file.regs[CombinerModel::SRC_R0][3];
+  for (uint32_t channel = 0; channel < num_channels; ++channel) {
+    if (outputs.sum) {
+      if (mux) {
+        Mux<kVectorized>(ab[channel], cd[channel], r0_alpha, mux_bit, sum[channel]);
+      } else {
+        Add<kVectorized>(ab[channel], cd[channel], sum[channel]);
+      }
+      Output<kVectorized>(sum[channel], params, sum[channel]);
+    }
+    if (outputs.ab) {
+      Output<kVectorized>(ab[channel], params, ab[channel]);
+    }
+    if (outputs.cd) {
+      Output<kVectorized>(cd[channel], params, cd[channel]);
+    }
+  }
+}
+
+}  // namespace
+
+CombinerModel::CombinerModel() {
+  SetFinalCombiner0Just(SRC_DIFFUSE);
+  SetFinalCombiner1Just(SRC_DIFFUSE, true);
+}
+
+void CombinerModel::SetCombinerControl(int num_combiners, bool same_factor0, bool same_factor1, bool mux_bit_msb) {
+  config_.num_combiners = std::clamp(num_combiners, 1, static_cast<int>(kMaxCombiners));
+  config_.same_factor0 = same_factor0;
+  config_.same_factor1 = same_factor1;
+  config_.mux_bit_msb = mux_bit_msb;
+}
+
+void CombinerModel::SetInputColorCombiner(int combiner, CombinerInput a, CombinerInput b, CombinerInput c,
+                                          CombinerInput d) {
+  auto &inputs = config_.stages[combiner].color_inputs;
+  inputs[0] = a;
+  inputs[1] = b;
+  inputs[2] = c;
+  inputs[3] = d;
+}
+
+void CombinerModel::SetInputAlphaCombiner(int combiner, CombinerInput a, CombinerInput b, CombinerInput c,
+                                          CombinerInput d) {
+  auto &inputs = config_.stages[combiner].alpha_inputs;
+  inputs[0] = a;
+  inputs[1] = b;
+  inputs[2] = c;
+  inputs[3] = d;
+}
+
+void CombinerModel::SetOutputColorCombiner(int combiner, CombinerDest ab_dst, CombinerDest cd_dst,
+                                           CombinerDest sum_dst, bool ab_dot_product, bool cd_dot_product,
+                                           CombinerSumMuxMode sum_or_mux, CombinerOutOp op, bool alpha_from_ab_blue,
+                                           bool alpha_from_cd_blue) {
+  config_.stages[combiner].color_output = {ab_dst,     cd_dst, sum_dst,           ab_dot_product,    cd_dot_product,
+                                           sum_or_mux, op,     alpha_from_ab_blue, alpha_from_cd_blue};
+}
+
+void CombinerModel::SetOutputAlphaCombiner(int combiner, CombinerDest ab_dst, CombinerDest cd_dst,
+                                           CombinerDest sum_dst, bool, bool, CombinerSumMuxMode sum_or_mux,
+                                           CombinerOutOp op) {
+  config_.stages[combiner].alpha_output = {ab_dst, cd_dst, sum_dst, false, false, sum_or_mux, op, false, false};
+}
+
+static void SetFactor(float *factor, uint32_t value) {
+  factor[0] = static_cast<float>((value >> 16) & 0xFF);
+  factor[1] = static_cast<float>((value >> 8) & 0xFF);
+  factor[2] = static_cast<float>(value & 0xFF);
+  factor[3] = static_cast<float>(value >> 24);
+}
+
+//! Factors are stored in 8-bit unsigned registers, so float components are rounded as they are packed.
+static void SetFactor(float *factor, float red, float green, float blue, float alpha) {
+  auto to_byte = [](float value) {
+    return static_cast<uint32_t>(std::nearbyint(std::min(std::max(value, 0.f), 1.f) * kOne));
+  };
+  SetFactor(factor, (to_byte(alpha) << 24) | (to_byte(red) << 16) | (to_byte(green) << 8) | to_byte(blue));
+}
+
+void CombinerModel::SetCombinerFactorC0(int combiner, uint32_t value) {
+  SetFactor(config_.stages[combiner].c0, value);
+}
+
+void CombinerModel::SetCombinerFactorC0(int combiner, float red, float green, float blue, float alpha) {
+  SetFactor(config_.stages[combiner].c0, red, green, blue, alpha);
+}
+
+void CombinerModel::SetCombinerFactorC1(int combiner, uint32_t value) {
+  SetFactor(config_.stages[combiner].c1, value);
+}
+
+void CombinerModel::SetCombinerFactorC1(int combiner, float red, float green, float blue, float alpha) {
+  SetFactor(config_.stages[combiner].c1, red, green, blue, alpha);
+}
+
+void CombinerModel::SetFinalCombinerFactorC0(uint32_t value) { SetFactor(config_.final_c0, value); }
+
+void CombinerModel::SetFinalCombinerFactorC0(float red, float green, float blue, float alpha) {
+  SetFactor(config_.final_c0, red, green, blue, alpha);
+}
+
+void CombinerModel::SetFinalCombinerFactorC1(uint32_t value) { SetFactor(config_.final_c1, value); }
+
+void CombinerModel::SetFinalCombinerFactorC1(float red, float green, float blue, float alpha) {
+  SetFactor(config_.final_c1, red, green, blue, alpha);
+}
+
+void CombinerModel::SetFinalCombiner0(CombinerSource a_source, bool a_alpha, bool a_invert, CombinerSource b_source,
+                                      bool b_alpha, bool b_invert, CombinerSource c_source, bool c_alpha,
+                                      bool c_invert, CombinerSource d_source, bool d_alpha, bool d_invert) {
+  config_.final_inputs[0] = {a_source, a_alpha, a_invert};
+  config_.final_inputs[1] = {b_source, b_alpha, b_invert};
+  config_.final_inputs[2] = {c_source, c_alpha, c_invert};
+  config_.final_inputs[3] = {d_source, d_alpha, d_invert};
+}
+
+void CombinerModel::SetFinalCombiner1(CombinerSource e_source, bool e_alpha, bool e_invert, CombinerSource f_source,
+                                      bool f_alpha, bool f_invert, CombinerSource g_source, bool g_alpha,
+                                      bool g_invert, bool specular_add_invert_r0, bool specular_add_invert_v1,
+                                      bool specular_clamp) {
+  config_.final_inputs[4] = {e_source, e_alpha, e_invert};
+  config_.final_inputs[5] = {f_source, f_alpha, f_invert};
+  config_.final_inputs[6] = {g_source, g_alpha, g_invert};
+  config_.specular_add_invert_r0 = specular_add_invert_r0;
+  config_.specular_add_invert_v1 = specular_add_invert_v1;
+  config_.specular_clamp = specular_clamp;
+}
+
+template <bool kVectorized>
+void CombinerModel::EvaluateRange(const Inputs &inputs, uint32_t *argb, uint32_t begin, uint32_t end) const {
+  static const ConstantPlanes constants;
+  RegisterFile file;
+  for (auto &plane : file.regs[SRC_ZERO]) {
+    Fill(plane, 0.f);
+  }
+
+  const uint32_t mux_bit = config_.mux_bit_msb ? 0x80 : 0x01;
+  const auto &unsigned_identity = kMappings[MAP_UNSIGNED_IDENTITY];
+  const auto &unsigned_invert = kMappings[MAP_UNSIGNED_INVERT];
+
+  auto final_uses_source = [this](CombinerSource source) {
+    return std::any_of(std::begin(config_.final_inputs), std::end(config_.final_inputs),
+                       [source](const FinalInput &input) { return input.source == source; });
+  };
+  const bool uses_spec_r0_sum = final_uses_source(SRC_SPEC_R0_SUM);
+  const bool uses_ef_product = final_uses_source(SRC_EF_PROD);
+
+  // Input planes are only unpacked if something may read them. Registers that are written before being read are
+  // conservatively included.
+  uint32_t used_sources = (1 << SRC_TEX0) | (uses_spec_r0_sum ? (1 << SRC_SPECULAR) : 0);
+  for (uint32_t index = 0; index < config_.num_combiners; ++index) {
+    for (const auto &input : config_.stages[index].color_inputs) {
+      used_sources |= 1 << input.source;
+    }
+    for (const auto &input : config_.stages[index].alpha_inputs) {
+      used_sources |= 1 << input.source;
+    }
+  }
+  for (const auto &input : config_.final_inputs) {
+    used_sources |= 1 << input.source;
+  }
+
+  for (uint32_t offset = begin; offset < end; offset += kBatchSize) {
+    const uint32_t count = std::min(kBatchSize, end - offset);
+    auto plane_pointer = [offset](const uint32_t *plane) { return plane ? plane + offset : nullptr; };
+
+    auto unpack = [&](CombinerSource source, const uint32_t *plane) {
+      if (used_sources & (1 << source)) {
+        Unpack<kVectorized>(plane_pointer(plane), count, file.regs[source]);
+      }
+    };
+    unpack(SRC_FOG, inputs.fog);
+    unpack(SRC_DIFFUSE, inputs.diffuse);
+    unpack(SRC_SPECULAR, inputs.specular);
+    for (uint32_t i = 0; i < 4; ++i) {
+      unpack(static_cast<CombinerSource>(SRC_TEX0 + i), inputs.texture[i]);
+    }
+    for (auto reg : {SRC_6, SRC_7, SRC_R0, SRC_R1}) {
+      for (auto &plane : file.regs[reg]) {
+        Fill(plane, 0.f);
+      }
+    }
+    // R0.a is initialized with the alpha of texture 0.
+    file.regs[SRC_R0][3] = file.regs[SRC_TEX0][3];
+
+    for (uint32_t index = 0; index < config_.num_combiners; ++index) {
+      const auto &stage = config_.stages[index];
+      const float *c0 = config_.same_factor0 ? config_.stages[0].c0 : stage.c0;
+      const float *c1 = config_.same_factor1 ? config_.stages[0].c1 : stage.c1;
+      for (uint32_t channel = 0; channel < 4; ++channel) {
+        Fill(file.regs[SRC_C0][channel], c0[channel]);
+        Fill(file.regs[SRC_C1][channel], c1[channel]);
+      }
+
+      // Both portions read the register values from the start of the stage, so writes are deferred.
+      const auto &color_output = stage.color_output;
+      const PortionOutputs color_outputs{color_output.ab_dst != DST_DISCARD, color_output.cd_dst != DST_DISCARD,
+                                         color_output.sum_dst != DST_DISCARD};
+      Plane color_ab[3], color_cd[3], color_sum[3];
+      if (color_outputs.any()) {
+        EvaluatePortion<kVectorized>(file, constants, stage.color_inputs, false, color_output.ab_dot_product,
+                                     color_output.cd_dot_product, color_output.sum_or_mux == SM_MUX, mux_bit,
+                                     color_output.op, color_outputs, color_ab, color_cd, color_sum);
+      }
+
+      const auto &alpha_output = stage.alpha_output;
+      const PortionOutputs alpha_outputs{alpha_output.ab_dst != DST_DISCARD, alpha_output.cd_dst != DST_DISCARD,
+                                         alpha_output.sum_dst != DST_DISCARD};
+      Plane alpha_ab[3], alpha_cd[3], alpha_sum[3];
+      if (alpha_outputs.any()) {
+        EvaluatePortion<kVectorized>(file, constants, stage.alpha_inputs, true, false, false,
+                                     alpha_output.sum_or_mux == SM_MUX, mux_bit, alpha_output.op, alpha_outputs,
+                                     alpha_ab, alpha_cd, alpha_sum);
+      }
+
+      auto write_color = [&file](CombinerDest dst, const Plane(&value)[3]) {
+        if (dst != DST_DISCARD) {
+          std::copy(std::begin(value), std::end(value), file.regs[dst]);
+        }
+      };
+      write_color(color_output.ab_dst, color_ab);
+      write_color(color_output.cd_dst, color_cd);
+      write_color(color_output.sum_dst, color_sum);
+
+      auto write_alpha = [&file](CombinerDest dst, const Plane &value) {
+        if (dst != DST_DISCARD) {
+          file.regs[dst][3] = value;
+        }
+      };
+      write_alpha(alpha_output.ab_dst, alpha_ab[0]);
+      write_alpha(alpha_output.cd_dst, alpha_cd[0]);
+      write_alpha(alpha_output.sum_dst, alpha_sum[0]);
+
+      // The blue to alpha flags take precedence over the alpha portion of the stage.
+      if (color_output.alpha_from_ab_blue) {
+        write_alpha(color_output.ab_dst, color_ab[2]);
+      }
+      if (color_output.alpha_from_cd_blue) {
+        write_alpha(color_output.cd_dst, color_cd[2]);
+      }
+    }
+
+    // Final combiner. Inputs are unsigned and may only be inverted.
+    for (uint32_t channel = 0; channel < 4; ++channel) {
+      Fill(file.regs[SRC_C0][channel], config_.final_c0[channel]);
+      Fill(file.regs[SRC_C1][channel], config_.final_c1[channel]);
+    }
+
+    // The sum is not clamped unless requested, so it may exceed 1.
+    if (uses_spec_r0_sum) {
+      Plane r0, v1;
+      auto &spec_r0_sum = file.regs[SRC_SPEC_R0_SUM];
+      for (uint32_t channel = 0; channel < 4; ++channel) {
+        Map<kVectorized>(file.regs[SRC_R0][channel],
+                         config_.specular_add_invert_r0 ? unsigned_invert : unsigned_identity, r0);
+        Map<kVectorized>(file.regs[SRC_SPECULAR][channel],
+                         config_.specular_add_invert_v1 ? unsigned_invert : unsigned_identity, v1);
+        Add<kVectorized>(r0, v1, spec_r0_sum[channel]);
+        if (config_.specular_clamp) {
+          ClampMax<kVectorized>(spec_r0_sum[channel], kOne);
+        }
+      }
+    }
+
+    auto map_final_input = [&](const FinalInput &input, uint32_t channel, Plane &out) {
+      const auto &reg = file.regs[input.source];
+      const Plane &source = input.alpha ? reg[3] : reg[channel];
+      Map<kVectorized>(source, input.invert ? unsigned_invert : unsigned_identity, out);
+    };
+
+    if (uses_ef_product) {
+      Plane e, f;
+      for (uint32_t channel = 0; channel < 4; ++channel) {
+        map_final_input(config_.final_inputs[4], channel, e);
+        map_final_input(config_.final_inputs[5], channel, f);
+        FinalProduct<kVectorized>(e, f, file.regs[SRC_EF_PROD][channel]);
+      }
+    }
+
+    Plane output[4];
+    {
+      Plane a, b, c, d;
+      for (uint32_t channel = 0; channel < 3; ++channel) {
+        map_final_input(config_.final_inputs[0], channel, a);
+        map_final_input(config_.final_inputs[1], channel, b);
+        map_final_input(config_.final_inputs[2], channel, c);
+        map_final_input(config_.final_inputs[3], channel, d);
+        FinalLerp<kVectorized>(a, b, c, d, output[channel]);
+      }
+    }
+    // G is an alpha input and reads the blue channel unless alpha is selected.
+    map_final_input(config_.final_inputs[6], 2, output[3]);
+
+    Pack<kVectorized>(output, count, argb + offset);
+  }
+}
+
+void CombinerModel::Evaluate(const Inputs &inputs, std::vector<uint32_t> &argb, uint32_t num_threads) const {
+#ifdef __SSE2__
+  static constexpr bool kVectorized = true;
+#else
+  static constexpr bool kVectorized = false;
+#endif
+
+  const uint32_t num_pixels = inputs.width * inputs.height;
+  argb.resize(num_pixels);
+
+  static constexpr uint32_t kClaimSize = kBatchSize * kBatchesPerClaim;
+  const uint32_t num_claims = (num_pixels + kClaimSize - 1) / kClaimSize;
+
+  if (!num_threads) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  if (num_pixels < kMinParallelPixels) {
+    num_threads = 1;
+  }
+  num_threads = std::max(1U, std::min(num_threads, num_claims));
+
+  std::atomic<uint32_t> next_claim{0};
+  auto worker = [&]() {
+    for (uint32_t claim = next_claim++; claim < num_claims; claim = next_claim++) {
+      const uint32_t begin = claim * kClaimSize;
+      EvaluateRange<kVectorized>(inputs, argb.data(), begin, std::min(begin + kClaimSize, num_pixels));
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+void CombinerModel::EvaluateScalar(const Inputs &inputs, std::vector<uint32_t> &argb) const {
+  const uint32_t num_pixels = inputs.width * inputs.height;
+  argb.resize(num_pixels);
+  EvaluateRange<false>(inputs, argb.data(), 0, num_pixels);
+}
+
+const char *CombinerModel::KernelName() {
+#ifdef __SSE2__
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
@@ -0,0 +1,250 @@
+#ifndef NXDK_PGRAPH_TESTS_COMBINER_MODEL_H
+#define NXDK_PGRAPH_TESTS_COMBINER_MODEL_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Host side model of the NV2A register combiners.
+ *
+ * The configuration methods mirror the TestHost calls used by the on-device tests (SetInputColorCombiner,
+ * SetOutputColorCombiner, SetFinalCombiner0, ...) so that a test's setup can be replayed here verbatim to produce its
+ * expected output.
+ *
+ * Combiner registers hold 9-bit signed values, i.e., multiples of 1/255 in the range [-1, 1]. Input mappings, products,
+ * sums and output scale/bias are evaluated in single precision and the result is clamped and rounded to the nearest
+ * representable value when it is written to a register. The final combiner operates on unsigned values and its output
+ * is rounded to 8 bits per channel.
+ *
+ * Evaluation is performed on batches of pixels in structure-of-arrays form so that every step of a stage is applied to
+ * a whole batch at once.
+ */
+class CombinerModel {
+ public:
+  static constexpr uint32_t kMaxCombiners = 8;
+
+  enum CombinerSource {
+    SRC_ZERO = 0,
+    SRC_C0,
+    SRC_C1,
+    SRC_FOG,
+    SRC_DIFFUSE,
+    SRC_SPECULAR,
+    SRC_6,
+    SRC_7,
+    SRC_TEX0,
+    SRC_TEX1,
+    SRC_TEX2,
+    SRC_TEX3,
+    SRC_R0,
+    SRC_R1,
+    // Only valid in the final combiner.
+    SRC_SPEC_R0_SUM,
+    SRC_EF_PROD,
+  };
+
+  enum CombinerDest {
+    DST_DISCARD = 0,
+    DST_C0,
+    DST_C1,
+    DST_FOG,
+    DST_DIFFUSE,
+    DST_SPECULAR,
+    DST_6,
+    DST_7,
+    DST_TEX0,
+    DST_TEX1,
+    DST_TEX2,
+    DST_TEX3,
+    DST_R0,
+    DST_R1,
+  };
+
+  enum CombinerSumMuxMode {
+    SM_SUM = 0,
+    SM_MUX = 1,
+  };
+
+  enum CombinerOutOp {
+    OP_IDENTITY = 0,
+    OP_BIAS = 1,
+    OP_SHIFT_LEFT_1 = 2,
+    OP_SHIFT_LEFT_1_BIAS = 3,
+    OP_SHIFT_LEFT_2 = 4,
+    OP_SHIFT_RIGHT_1 = 6,
+  };
+
+  enum CombinerMapping {
+    MAP_UNSIGNED_IDENTITY,  // max(0,x)         OK for final combiner
+    MAP_UNSIGNED_INVERT,    // 1 - max(0,x)     OK for final combiner
+    MAP_EXPAND_NORMAL,      // 2*max(0,x) - 1   invalid for final combiner
+    MAP_EXPAND_NEGATE,      // 1 - 2*max(0,x)   invalid for final combiner
+    MAP_HALFBIAS_NORMAL,    // max(0,x) - 1/2   invalid for final combiner
+    MAP_HALFBIAS_NEGATE,    // 1/2 - max(0,x)   invalid for final combiner
+    MAP_SIGNED_IDENTITY,    // x                invalid for final combiner
+    MAP_SIGNED_NEGATE,      // -x               invalid for final combiner
+  };
+
+  struct CombinerInput {
+    CombinerSource source{SRC_ZERO};
+    //! Selects the alpha channel of the source. When unset, alpha combiners read the blue channel.
+    bool alpha{false};
+    CombinerMapping mapping{MAP_UNSIGNED_IDENTITY};
+  };
+
+  //! Per pixel combiner inputs, each a row major `width` x `height` plane of 0xAARRGGBB values.
+  struct Inputs {
+    uint32_t width{0};
+    uint32_t height{0};
+
+    // Unset planes read as transparent black.
+    const uint32_t *diffuse{nullptr};
+    const uint32_t *specular{nullptr};
+    //! Fog color in RGB and the interpolated fog factor in alpha.
+    const uint32_t *fog{nullptr};
+    const uint32_t *texture[4]{nullptr, nullptr, nullptr, nullptr};
+  };
+
+ public:
+  //! Creates a model with a single combiner stage that discards its results and a final combiner that outputs diffuse.
+  CombinerModel();
+
+  static CombinerInput ColorInput(CombinerSource source, CombinerMapping mapping = MAP_UNSIGNED_IDENTITY) {
+    return {source, false, mapping};
+  }
+  static CombinerInput AlphaInput(CombinerSource source, CombinerMapping mapping = MAP_UNSIGNED_IDENTITY) {
+    return {source, true, mapping};
+  }
+  static CombinerInput ZeroInput() { return {SRC_ZERO, false, MAP_UNSIGNED_IDENTITY}; }
+  static CombinerInput OneInput() { return {SRC_ZERO, false, MAP_UNSIGNED_INVERT}; }
+  static CombinerInput NegativeOneInput() { return {SRC_ZERO, false, MAP_EXPAND_NORMAL}; }
+
+  /**
+   * Sets the number of active combiner stages.
+   *
+   * @param same_factor0 - If true, every stage uses stage 0's C0 factor.
+   * @param same_factor1 - If true, every stage uses stage 0's C1 factor.
+   * @param mux_bit_msb - If true, SM_MUX selects on the most significant bit of R0.a, otherwise the least significant.
+   */
+  void SetCombinerControl(int num_combiners = 1, bool same_factor0 = false, bool same_factor1 = false,
+                          bool mux_bit_msb = false);
+
+  void SetInputColorCombiner(int combiner, CombinerInput a = ZeroInput(), CombinerInput b = ZeroInput(),
+                             CombinerInput c = ZeroInput(), CombinerInput d = ZeroInput());
+  void SetInputAlphaCombiner(int combiner, CombinerInput a = ZeroInput(), CombinerInput b = ZeroInput(),
+                             CombinerInput c = ZeroInput(), CombinerInput d = ZeroInput());
+
+  void SetOutputColorCombiner(int combiner, CombinerDest ab_dst = DST_DISCARD, CombinerDest cd_dst = DST_DISCARD,
+                              CombinerDest sum_dst = DST_DISCARD, bool ab_dot_product = false,
+                              bool cd_dot_product = false, CombinerSumMuxMode sum_or_mux = SM_SUM,
+                              CombinerOutOp op = OP_IDENTITY, bool alpha_from_ab_blue = false,
+                              bool alpha_from_cd_blue = false);
+  //! Dot products are not defined for the alpha portion of a stage; the flags are accepted for parity and ignored.
+  void SetOutputAlphaCombiner(int combiner, CombinerDest ab_dst = DST_DISCARD, CombinerDest cd_dst = DST_DISCARD,
+                              CombinerDest sum_dst = DST_DISCARD, bool ab_dot_product = false,
+                              bool cd_dot_product = false, CombinerSumMuxMode sum_or_mux = SM_SUM,
+                              CombinerOutOp op = OP_IDENTITY);
+
+  void SetCombinerFactorC0(int combiner, uint32_t value);
+  void SetCombinerFactorC0(int combiner, float red, float green, float blue, float alpha);
+  void SetCombinerFactorC1(int combiner, uint32_t value);
+  void SetCombinerFactorC1(int combiner, float red, float green, float blue, float alpha);
+
+  void SetFinalCombinerFactorC0(uint32_t value);
+  void SetFinalCombinerFactorC0(float red, float green, float blue, float alpha);
+  void SetFinalCombinerFactorC1(uint32_t value);
+  void SetFinalCombinerFactorC1(float red, float green, float blue, float alpha);
+
+  //! Sets the final combiner's RGB output to A * B + (1 - A) * C + D.
+  void SetFinalCombiner0(CombinerSource a_source = SRC_ZERO, bool a_alpha = false, bool a_invert = false,
+                         CombinerSource b_source = SRC_ZERO, bool b_alpha = false, bool b_invert = false,
+                         CombinerSource c_source = SRC_ZERO, bool c_alpha = false, bool c_invert = false,
+                         CombinerSource d_source = SRC_ZERO, bool d_alpha = false, bool d_invert = false);
+  //! Sets the final RGB output to the given source.
+  void SetFinalCombiner0Just(CombinerSource d_source, bool d_alpha = false, bool d_invert = false) {
+    SetFinalCombiner0(SRC_ZERO, false, false, SRC_ZERO, false, false, SRC_ZERO, false, false, d_source, d_alpha,
+                      d_invert);
+  }
+
+  /**
+   * Sets the E and F inputs of the SRC_EF_PROD source and the G input that provides the final alpha.
+   *
+   * @param specular_add_invert_r0 - Use 1 - R0 in SRC_SPEC_R0_SUM.
+   * @param specular_add_invert_v1 - Use 1 - specular in SRC_SPEC_R0_SUM.
+   * @param specular_clamp - Clamp SRC_SPEC_R0_SUM to 1.
+   */
+  void SetFinalCombiner1(CombinerSource e_source = SRC_ZERO, bool e_alpha = false, bool e_invert = false,
+                         CombinerSource f_source = SRC_ZERO, bool f_alpha = false, bool f_invert = false,
+                         CombinerSource g_source = SRC_ZERO, bool g_alpha = false, bool g_invert = false,
+                         bool specular_add_invert_r0 = false, bool specular_add_invert_v1 = false,
+                         bool specular_clamp = false);
+  //! Sets the final alpha output to the given source.
+  void SetFinalCombiner1Just(CombinerSource g_source, bool g_alpha = false, bool g_invert = false) {
+    SetFinalCombiner1(SRC_ZERO, false, false, SRC_ZERO, false, false, g_source, g_alpha, g_invert);
+  }
+
+  /**
+   * Evaluates the configured combiners for every pixel of `inputs`, producing 0xAARRGGBB output pixels.
+   *
+   * Batches are split across `num_threads` threads (0 selects std::thread::hardware_concurrency). Small images are
+   * always evaluated on the calling thread.
+   */
+  void Evaluate(const Inputs &inputs, std::vector<uint32_t> &argb, uint32_t num_threads = 0) const;
+
+  //! Portable implementation of Evaluate, retained to validate the vectorized version.
+  void EvaluateScalar(const Inputs &inputs, std::vector<uint32_t> &argb) const;
+
+  //! Returns the name of the kernel set used by Evaluate.
+  static const char *KernelName();
+
+ private:
+  struct OutputConfig {
+    CombinerDest ab_dst{DST_DISCARD};
+    CombinerDest cd_dst{DST_DISCARD};
+    CombinerDest sum_dst{DST_DISCARD};
+    bool ab_dot_product{false};
+    bool cd_dot_product{false};
+    CombinerSumMuxMode sum_or_mux{SM_SUM};
+    CombinerOutOp op{OP_IDENTITY};
+    bool alpha_from_ab_blue{false};
+    bool alpha_from_cd_blue{false};
+  };
+
+  struct Stage {
+    CombinerInput color_inputs[4];
+    CombinerInput alpha_inputs[4];
+    OutputConfig color_output;
+    OutputConfig alpha_output;
+    float c0[4]{0.f, 0.f, 0.f, 0.f};
+    float c1[4]{0.f, 0.f, 0.f, 0.f};
+  };
+
+  struct FinalInput {
+    CombinerSource source{SRC_ZERO};
+    bool alpha{false};
+    bool invert{false};
+  };
+
+  struct Config {
+    uint32_t num_combiners{1};
+    bool same_factor0{false};
+    bool same_factor1{false};
+    bool mux_bit_msb{false};
+    Stage stages[kMaxCombiners];
+
+    // A, B, C, D, E, F, G.
+    FinalInput final_inputs[7];
+    bool specular_add_invert_r0{false};
+    bool specular_add_invert_v1{false};
+    bool specular_clamp{false};
+    float final_c0[4]{0.f, 0.f, 0.f, 0.f};
+    float final_c1[4]{0.f, 0.f, 0.f, 0.f};
+  };
+
+  template <bool kVectorized>
+  void EvaluateRange(const Inputs &inputs, uint32_t *argb, uint32_t begin, uint32_t end) const;
+
+  Config config_;
+};
+
+#endif  // NXDK_PGRAPH_TESTS_COMBINER_MODEL_H
@@ -0,0 +1,522 @@
+#include "draw_extractor.h"
+
+#include <pbkit/nv_regs.h>
+
+#include <cstring>
+
+#include "pbkit_ext.h"
+
+static constexpr uint32_t kNumTextureStages = 4;
+static constexpr uint32_t kTextureStageStride = 0x40;
+
+DrawExtractor::DrawExtractor(SoftwareRasterizer &rasterizer, MemoryReader memory_reader)
+    : rasterizer_(rasterizer), memory_reader_(std::move(memory_reader)) {
+  for (auto &attribute : current_.values) {
+    attribute[0] = attribute[1] = attribute[2] = 0.0f;
+    attribute[3] = 1.0f;
+  }
+  // The hardware defaults the diffuse color to opaque white.
+  for (auto &component : current_.values[kDiffuseAttribute]) {
+    component = 1.0f;
+  }
+}
+
+static float AsFloat(uint32_t value) {
+  float ret;
+  memcpy(&ret, &value, sizeof(ret));
+  return ret;
+}
+
+static bool ToCompareFunc(uint32_t value, SoftwareRasterizer::CompareFunc &func) {
+  using CompareFunc = SoftwareRasterizer::CompareFunc;
+  switch (value) {
+    case NV097_SET_ALPHA_FUNC_V_NEVER:
+      func = CompareFunc::NEVER;
+      return true;
+    case NV097_SET_ALPHA_FUNC_V_LESS:
+      func = CompareFunc::LESS;
+      return true;
+    case NV097_SET_ALPHA_FUNC_V_EQUAL:
+      func = CompareFunc::EQUAL;
+      return true;
+    case NV097_SET_ALPHA_FUNC_V_LEQUAL:
+      func = CompareFunc::LEQUAL;
+      return true;
+    case NV097_SET_ALPHA_FUNC_V_GREATER:
+      func = CompareFunc::GREATER;
+      return true;
+    case NV097_SET_ALPHA_FUNC_V_NOTEQUAL:
+      func = CompareFunc::NOTEQUAL;
+      return true;
+    case NV097_SET_ALPHA_FUNC_V_GEQUAL:
+      func = CompareFunc::GEQUAL;
+      return true;
+    case NV097_SET_ALPHA_FUNC_V_ALWAYS:
+      func = CompareFunc::ALWAYS;
+      return true;
+    default:
+      return false;
+  }
+}
+
+//! Translates an NV097_SET_BLEND_FUNC_SFACTOR or _DFACTOR value. Both methods accept the same set of GL enums.
+static bool ToBlendFactor(uint32_t value, SoftwareRasterizer::BlendFactor &factor) {
+  using BlendFactor = SoftwareRasterizer::BlendFactor;
+  switch (value) {
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_ZERO:
+      factor = BlendFactor::ZERO;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_ONE:
+      factor = BlendFactor::ONE;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_SRC_COLOR:
+      factor = BlendFactor::SRC_COLOR;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_ONE_MINUS_SRC_COLOR:
+      factor = BlendFactor::ONE_MINUS_SRC_COLOR;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_SRC_ALPHA:
+      factor = BlendFactor::SRC_ALPHA;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_ONE_MINUS_SRC_ALPHA:
+      factor = BlendFactor::ONE_MINUS_SRC_ALPHA;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_DST_ALPHA:
+      factor = BlendFactor::DST_ALPHA;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_ONE_MINUS_DST_ALPHA:
+      factor = BlendFactor::ONE_MINUS_DST_ALPHA;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_DST_COLOR:
+      factor = BlendFactor::DST_COLOR;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_ONE_MINUS_DST_COLOR:
+      factor = BlendFactor::ONE_MINUS_DST_COLOR;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_SRC_ALPHA_SATURATE:
+      factor = BlendFactor::SRC_ALPHA_SATURATE;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_CONSTANT_COLOR:
+      factor = BlendFactor::CONSTANT_COLOR;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_ONE_MINUS_CONSTANT_COLOR:
+      factor = BlendFactor::ONE_MINUS_CONSTANT_COLOR;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_CONSTANT_ALPHA:
+      factor = BlendFactor::CONSTANT_ALPHA;
+      return true;
+    case NV097_SET_BLEND_FUNC_SFACTOR_V_ONE_MINUS_CONSTANT_ALPHA:
+      factor = BlendFactor::ONE_MINUS_CONSTANT_ALPHA;
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool ToBlendEquation(uint32_t value, SoftwareRasterizer::BlendEquation &equation) {
+  using BlendEquation = SoftwareRasterizer::BlendEquation;
+  switch (value) {
+    case NV097_SET_BLEND_EQUATION_V_FUNC_ADD:
+      equation = BlendEquation::ADD;
+      return true;
+    case NV097_SET_BLEND_EQUATION_V_FUNC_SUBTRACT:
+      equation = BlendEquation::SUBTRACT;
+      return true;
+    case NV097_SET_BLEND_EQUATION_V_FUNC_REVERSE_SUBTRACT:
+      equation = BlendEquation::REVERSE_SUBTRACT;
+      return true;
+    case NV097_SET_BLEND_EQUATION_V_MIN:
+      equation = BlendEquation::MIN;
+      return true;
+    case NV097_SET_BLEND_EQUATION_V_MAX:
+      equation = BlendEquation::MAX;
+      return true;
+    default:
+      // The signed variants are not modeled.
+      return false;
+  }
+}
+
+//! Clears `bit` in `unmodeled_state` if a register value was translated, otherwise sets it.
+static void TrackModeled(bool modeled, uint32_t bit, uint32_t &unmodeled_state) {
+  if (modeled) {
+    unmodeled_state &= ~bit;
+  } else {
+    unmodeled_state |= bit;
+  }
+}
+
+void DrawExtractor::Process(uint32_t method, uint32_t value) {
+  if (method == NV097_SET_BEGIN_END) {
+    if (value == NV097_SET_BEGIN_END_OP_END) {
+      End();
+    } else {
+      Begin(value);
+    }
+    return;
+  }
+
+  if (method >= NV097_SET_VERTEX4F && method < NV097_SET_VERTEX4F + 16) {
+    SetAttribute(kPositionAttribute, (method - NV097_SET_VERTEX4F) / 4, AsFloat(value));
+    return;
+  }
+
+  if (method >= NV097_SET_VERTEX_DATA4F_M && method < NV097_SET_VERTEX_DATA4F_M + kNumAttributes * 16) {
+    const uint32_t offset = method - NV097_SET_VERTEX_DATA4F_M;
+    SetAttribute(offset / 16, (offset % 16) / 4, AsFloat(value));
+    return;
+  }
+
+  if (method >= NV097_SET_VERTEX_DATA2F_M && method < NV097_SET_VERTEX_DATA2F_M + kNumAttributes * 8) {
+    const uint32_t offset = method - NV097_SET_VERTEX_DATA2F_M;
+    const uint32_t slot = offset / 8;
+    const uint32_t component = (offset % 8) / 4;
+    if (!component) {
+      current_.values[slot][2] = 0.0f;
+      current_.values[slot][3] = 1.0f;
+    }
+    // Writing the final component of the position provokes a vertex, so the defaults must be in place first.
+    SetAttribute(slot, component, AsFloat(value));
+    if (slot == kPositionAttribute && component == 1) {
+      EmitVertex(current_);
+    }
+    return;
+  }
+
+  if (method >= NV097_SET_VERTEX_DATA4UB && method < NV097_SET_VERTEX_DATA4UB + kNumAttributes * 4) {
+    const uint32_t slot = (method - NV097_SET_VERTEX_DATA4UB) / 4;
+    for (uint32_t i = 0; i < 4; ++i) {
+      current_.values[slot][i] = static_cast<float>((value >> (i * 8)) & 0xFF) / 255.0f;
+    }
+    if (slot == kPositionAttribute) {
+      EmitVertex(current_);
+    }
+    return;
+  }
+
+  if (method >= NV097_SET_VERTEX_DATA_ARRAY_OFFSET && method < NV097_SET_VERTEX_DATA_ARRAY_OFFSET + kNumAttributes * 4) {
+    array_offsets_[(method - NV097_SET_VERTEX_DATA_ARRAY_OFFSET) / 4] = value;
+    return;
+  }
+
+  if (method >= NV097_SET_VERTEX_DATA_ARRAY_FORMAT && method < NV097_SET_VERTEX_DATA_ARRAY_FORMAT + kNumAttributes * 4) {
+    array_formats_[(method - NV097_SET_VERTEX_DATA_ARRAY_FORMAT) / 4] = value;
+    return;
+  }
+
+  if (method >= NV097_SET_TEXTURE_CONTROL0 &&
+      method < NV097_SET_TEXTURE_CONTROL0 + kNumTextureStages * kTextureStageStride &&
+      !((method - NV097_SET_TEXTURE_CONTROL0) % kTextureStageStride)) {
+    const uint32_t stage_bit = 1 << ((method - NV097_SET_TEXTURE_CONTROL0) / kTextureStageStride);
+    if (value & NV097_SET_TEXTURE_CONTROL0_ENABLE) {
+      enabled_texture_stages_ |= stage_bit;
+    } else {
+      enabled_texture_stages_ &= ~stage_bit;
+    }
+    return;
+  }
+
+  switch (method) {
+    case NV097_INLINE_ARRAY:
+      inline_array_.push_back(value);
+      break;
+
+    case NV097_DRAW_ARRAYS: {
+      const uint32_t start = UNMASK(NV097_DRAW_ARRAYS_START_INDEX, value);
+      const uint32_t count = UNMASK(NV097_DRAW_ARRAYS_COUNT, value) + 1;
+      for (uint32_t i = 0; i < count && !primitive_failed_; ++i) {
+        primitive_failed_ = !ReadArrayVertex(start + i);
+      }
+    } break;
+
+    case NV097_ARRAY_ELEMENT16:
+      primitive_failed_ = primitive_failed_ || !ReadArrayVertex(value & 0xFFFF) || !ReadArrayVertex(value >> 16);
+      break;
+
+    case NV097_ARRAY_ELEMENT32:
+      primitive_failed_ = primitive_failed_ || !ReadArrayVertex(value);
+      break;
+
+    case NV097_SET_ALPHA_TEST_ENABLE:
+      fragment_state_.alpha_test = value != 0;
+      break;
+
+    case NV097_SET_ALPHA_FUNC:
+      TrackModeled(ToCompareFunc(value, fragment_state_.alpha_func), UNMODELED_ALPHA_FUNC, unmodeled_state_);
+      break;
+
+    case NV097_SET_ALPHA_REF:
+      fragment_state_.alpha_ref = static_cast<uint8_t>(value & 0xFF);
+      break;
+
+    case NV097_SET_BLEND_ENABLE:
+      fragment_state_.blend = value != 0;
+      break;
+
+    case NV097_SET_BLEND_FUNC_SFACTOR:
+      TrackModeled(ToBlendFactor(value, fragment_state_.src_factor), UNMODELED_SRC_FACTOR, unmodeled_state_);
+      break;
+
+    case NV097_SET_BLEND_FUNC_DFACTOR:
+      TrackModeled(ToBlendFactor(value, fragment_state_.dst_factor), UNMODELED_DST_FACTOR, unmodeled_state_);
+      break;
+
+    case NV097_SET_BLEND_EQUATION:
+      TrackModeled(ToBlendEquation(value, fragment_state_.equation), UNMODELED_BLEND_EQUATION, unmodeled_state_);
+      break;
+
+    case NV097_SET_BLEND_COLOR:
+      fragment_state_.blend_color = value;
+      break;
+
+    case NV097_SET_DEPTH_TEST_ENABLE:
+      depth_test_enabled_ = value != 0;
+      break;
+
+    case NV097_SET_STENCIL_TEST_ENABLE:
+      stencil_test_enabled_ = value != 0;
+      break;
+
+    case NV097_SET_COLOR_CLEAR_VALUE:
+      clear_color_ = value;
+      break;
+
+    case NV097_SET_CLEAR_RECT_HORIZONTAL:
+      clear_rect_horizontal_ = value;
+      break;
+
+    case NV097_SET_CLEAR_RECT_VERTICAL:
+      clear_rect_vertical_ = value;
+      break;
+
+    case NV097_CLEAR_SURFACE:
+      if (value & NV097_CLEAR_SURFACE_COLOR) {
+        rasterizer_.Clear(clear_color_, static_cast<int32_t>(clear_rect_horizontal_ & 0xFFFF),
+                          static_cast<int32_t>(clear_rect_vertical_ & 0xFFFF),
+                          static_cast<int32_t>(clear_rect_horizontal_ >> 16),
+                          static_cast<int32_t>(clear_rect_vertical_ >> 16));
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+void DrawExtractor::SetAttribute(uint32_t slot, uint32_t component, float value) {
+  current_.values[slot][component] = value;
+  if (slot == kPositionAttribute && component == 3) {
+    EmitVertex(current_);
+  }
+}
+
+void DrawExtractor::EmitVertex(const Attributes &attributes) {
+  const auto &position = attributes.values[kPositionAttribute];
+  const auto &diffuse = attributes.values[kDiffuseAttribute];
+  vertices_.push_back({position[0], position[1], position[2], position[3], {diffuse[2], diffuse[1], diffuse[0], diffuse[3]}});
+}
+
+void DrawExtractor::Begin(uint32_t primitive) {
+  primitive_ = primitive;
+  vertices_.clear();
+  inline_array_.clear();
+  primitive_failed_ = false;
+}
+
+void DrawExtractor::End() {
+  if (!inline_array_.empty()) {
+    DecodeInlineArray();
+  }
+
+  if (primitive_failed_ || UsesUnmodeledState()) {
+    ++unsupported_draws_;
+    return;
+  }
+  rasterizer_.SetFragmentState(fragment_state_);
+
+  const auto &v = vertices_;
+  const auto count = static_cast<uint32_t>(v.size());
+  auto emit = [this](const SoftwareRasterizer::Vertex &a, const SoftwareRasterizer::Vertex &b,
+                     const SoftwareRasterizer::Vertex &c) {
+    rasterizer_.DrawTriangle(a, b, c);
+    ++num_triangles_;
+  };
+
+  switch (primitive_) {
+    case NV097_SET_BEGIN_END_OP_TRIANGLES:
+      for (uint32_t i = 0; i + 2 < count; i += 3) {
+        emit(v[i], v[i + 1], v[i + 2]);
+      }
+      break;
+
+    case NV097_SET_BEGIN_END_OP_TRIANGLE_STRIP:
+      for (uint32_t i = 0; i + 2 < count; ++i) {
+        if (i & 1) {
+          emit(v[i + 1], v[i], v[i + 2]);
+        } else {
+          emit(v[i], v[i + 1], v[i + 2]);
+        }
+      }
+      break;
+
+    case NV097_SET_BEGIN_END_OP_TRIANGLE_FAN:
+    case NV097_SET_BEGIN_END_OP_POLYGON:
+      for (uint32_t i = 1; i + 1 < count; ++i) {
+        emit(v[0], v[i], v[i + 1]);
+      }
+      break;
+
+    case NV097_SET_BEGIN_END_OP_QUADS:
+      for (uint32_t i = 0; i + 3 < count; i += 4) {
+        emit(v[i], v[i + 1], v[i + 2]);
+        emit(v[i], v[i + 2], v[i + 3]);
+      }
+      break;
+
+    case NV097_SET_BEGIN_END_OP_QUAD_STRIP:
+      for (uint32_t i = 0; i + 3 < count; i += 2) {
+        emit(v[i], v[i + 1], v[i + 3]);
+        emit(v[i], v[i + 3], v[i + 2]);
+      }
+      break;
+
+    default:
+      // Points and lines are not modeled.
+      ++unsupported_draws_;
+      break;
+  }
+
+  vertices_.clear();
+}
+
+bool DrawExtractor::UsesUnmodeledState() const {
+  if (depth_test_enabled_ || stencil_test_enabled_ || enabled_texture_stages_) {
+    return true;
+  }
+  if (fragment_state_.alpha_test && (unmodeled_state_ & UNMODELED_ALPHA_FUNC)) {
+    return true;
+  }
+  return fragment_state_.blend &&
+         (unmodeled_state_ & (UNMODELED_SRC_FACTOR | UNMODELED_DST_FACTOR | UNMODELED_BLEND_EQUATION));
+}
+
+//! Returns the size in bytes of a single element of the given array format, or 0 if the attribute is disabled.
+static uint32_t ElementSize(uint32_t format) {
+  const uint32_t size = UNMASK(NV097_SET_VERTEX_DATA_ARRAY_FORMAT_SIZE, format);
+  if (!size) {
+    return 0;
+  }
+
+  switch (UNMASK(NV097_SET_VERTEX_DATA_ARRAY_FORMAT_TYPE, format)) {
+    case DrawExtractor::TYPE_F:
+      return size * 4;
+    case DrawExtractor::TYPE_S1:
+    case DrawExtractor::TYPE_S32K:
+      return size * 2;
+    case DrawExtractor::TYPE_CMP:
+      return 4;
+    default:
+      return size;
+  }
+}
+
+bool DrawExtractor::DecodeVertex(const uint8_t *data, uint32_t slot, float *out) const {
+  const uint32_t format = array_formats_[slot];
+  const uint32_t size = UNMASK(NV097_SET_VERTEX_DATA_ARRAY_FORMAT_SIZE, format);
+  out[0] = out[1] = out[2] = 0.0f;
+  out[3] = 1.0f;
+
+  switch (UNMASK(NV097_SET_VERTEX_DATA_ARRAY_FORMAT_TYPE, format)) {
+    case TYPE_F:
+      memcpy(out, data, size * sizeof(float));
+      return true;
+
+    case TYPE_UB_D3D:
+      for (uint32_t i = 0; i < size; ++i) {
+        out[i] = static_cast<float>(data[i]) / 255.0f;
+      }
+      return true;
+
+    case TYPE_UB_OGL: {
+      // R, G, B, A in memory, which is swapped into the (B, G, R, A) attribute order.
+      static constexpr uint32_t kSwizzle[4] = {2, 1, 0, 3};
+      for (uint32_t i = 0; i < size; ++i) {
+        out[kSwizzle[i]] = static_cast<float>(data[i]) / 255.0f;
+      }
+      return true;
+    }
+
+    case TYPE_S1:
+    case TYPE_S32K:
+      for (uint32_t i = 0; i < size; ++i) {
+        int16_t component;
+        memcpy(&component, data + i * 2, sizeof(component));
+        out[i] = static_cast<float>(component);
+        if (UNMASK(NV097_SET_VERTEX_DATA_ARRAY_FORMAT_TYPE, format) == TYPE_S1) {
+          out[i] /= 32767.0f;
+        }
+      }
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+bool DrawExtractor::ReadArrayVertex(uint32_t index) {
+  if (!memory_reader_) {
+    return false;
+  }
+
+  Attributes attributes = current_;
+  for (uint32_t slot = 0; slot < kNumAttributes; ++slot) {
+    const uint32_t element_size = ElementSize(array_formats_[slot]);
+    if (!element_size) {
+      continue;
+    }
+
+    const uint32_t stride = UNMASK(NV097_SET_VERTEX_DATA_ARRAY_FORMAT_STRIDE, array_formats_[slot]);
+    // Bit 31 of the offset selects the DMA context; both address physical memory from 0.
+    const uint32_t address = (array_offsets_[slot] & 0x7FFFFFFF) + index * stride;
+    auto data = memory_reader_(address, element_size);
+    if (!data || !DecodeVertex(data, slot, attributes.values[slot])) {
+      return false;
+    }
+  }
+
+  EmitVertex(attributes);
+  return true;
+}
+
+void DrawExtractor::DecodeInlineArray() {
+  // Inline arrays pack each enabled attribute, in slot order, with no padding between them.
+  uint32_t vertex_size = 0;
+  for (auto format : array_formats_) {
+    vertex_size += ElementSize(format);
+  }
+  const auto inline_bytes = reinterpret_cast<const uint8_t *>(inline_array_.data());
+  const auto total_bytes = static_cast<uint32_t>(inline_array_.size() * sizeof(uint32_t));
+  if (!vertex_size) {
+    primitive_failed_ = true;
+    return;
+  }
+
+  for (uint32_t offset = 0; offset + vertex_size <= total_bytes; offset += vertex_size) {
+    Attributes attributes = current_;
+    uint32_t attribute_offset = offset;
+    for (uint32_t slot = 0; slot < kNumAttributes; ++slot) {
+      const uint32_t element_size = ElementSize(array_formats_[slot]);
+      if (!element_size) {
+        continue;
+      }
+      if (!DecodeVertex(inline_bytes + attribute_offset, slot, attributes.values[slot])) {
+        primitive_failed_ = true;
+        return;
+      }
+      attribute_offset += element_size;
+    }
+    EmitVertex(attributes);
+  }
+
+  inline_array_.clear();
+}
@@ -0,0 +1,105 @@
+#ifndef NXDK_PGRAPH_TESTS_DRAW_EXTRACTOR_H
+#define NXDK_PGRAPH_TESTS_DRAW_EXTRACTOR_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "software_rasterizer.h"
+
+/**
+ * Replays NV097 (Kelvin) methods into a SoftwareRasterizer.
+ *
+ * Only the subset of state used by passthrough-shader tests is modeled: immediate mode vertices
+ * (NV097_SET_VERTEX4F/NV097_SET_VERTEX_DATA*), NV097_INLINE_ARRAY, NV097_DRAW_ARRAYS, NV097_ARRAY_ELEMENT16/32, color
+ * clears, the alpha test, and unsigned blending. Positions are used as screen space coordinates and the diffuse
+ * attribute provides the color. Attribute components are treated as (B, G, R, A), matching the byte order of
+ * NV097_SET_VERTEX_DATA4UB and D3D vertex colors.
+ *
+ * The register combiners are assumed to route the diffuse color to the output, as TestSuite::Initialize configures
+ * them. Draws made with depth or stencil testing, an enabled texture stage, or an alpha func or blend mode that is not
+ * modeled are counted as unsupported rather than rendered incorrectly.
+ */
+class DrawExtractor {
+ public:
+  //! Returns a pointer to `size` bytes of memory at the given GPU address, or nullptr if it is not accessible.
+  using MemoryReader = std::function<const uint8_t *(uint32_t address, uint32_t size)>;
+
+  static constexpr uint32_t kNumAttributes = 16;
+  static constexpr uint32_t kPositionAttribute = 0;
+  static constexpr uint32_t kDiffuseAttribute = 3;
+
+  //! NV097_SET_VERTEX_DATA_ARRAY_FORMAT_TYPE values.
+  enum VertexFormatType : uint32_t {
+    TYPE_UB_D3D = 0,
+    TYPE_S1 = 1,
+    TYPE_F = 2,
+    TYPE_UB_OGL = 4,
+    TYPE_S32K = 5,
+    TYPE_CMP = 6,
+  };
+
+ public:
+  explicit DrawExtractor(SoftwareRasterizer &rasterizer, MemoryReader memory_reader = nullptr);
+
+  //! Processes a single method write on the 3D subchannel.
+  void Process(uint32_t method, uint32_t value);
+
+  //! Number of primitives that could not be reproduced (e.g., unsupported types or unreadable vertex arrays).
+  [[nodiscard]] uint32_t unsupported_draws() const { return unsupported_draws_; }
+  //! Number of triangles emitted to the rasterizer.
+  [[nodiscard]] uint32_t num_triangles() const { return num_triangles_; }
+
+ private:
+  struct Attributes {
+    float values[kNumAttributes][4];
+  };
+
+  void SetAttribute(uint32_t slot, uint32_t component, float value);
+  void EmitVertex(const Attributes &attributes);
+  void Begin(uint32_t primitive);
+  void End();
+  bool DecodeVertex(const uint8_t *data, uint32_t slot, float *out) const;
+  bool ReadArrayVertex(uint32_t index);
+  void DecodeInlineArray();
+  //! Returns true if the current state affects rendering in a way that the rasterizer does not model.
+  [[nodiscard]] bool UsesUnmodeledState() const;
+
+ private:
+  SoftwareRasterizer &rasterizer_;
+  MemoryReader memory_reader_;
+
+  uint32_t array_formats_[kNumAttributes]{};
+  uint32_t array_offsets_[kNumAttributes]{};
+
+  Attributes current_{};
+
+  uint32_t primitive_{0};
+  std::vector<SoftwareRasterizer::Vertex> vertices_;
+  std::vector<uint32_t> inline_array_;
+  bool primitive_failed_{false};
+
+  //! Bits identifying fragment state values that were set to something the rasterizer does not model.
+  enum UnmodeledState : uint32_t {
+    UNMODELED_ALPHA_FUNC = 1 << 0,
+    UNMODELED_SRC_FACTOR = 1 << 1,
+    UNMODELED_DST_FACTOR = 1 << 2,
+    UNMODELED_BLEND_EQUATION = 1 << 3,
+  };
+
+  SoftwareRasterizer::FragmentState fragment_state_;
+  uint32_t unmodeled_state_{0};
+  bool depth_test_enabled_{false};
+  bool stencil_test_enabled_{false};
+  //! Bitmask of texture stages with NV097_SET_TEXTURE_CONTROL0_ENABLE set.
+  uint32_t enabled_texture_stages_{0};
+
+  uint32_t clear_color_{0};
+  uint32_t clear_rect_horizontal_{0};
+  uint32_t clear_rect_vertical_{0};
+
+  uint32_t unsupported_draws_{0};
+  uint32_t num_triangles_{0};
+};
+
+#endif  // NXDK_PGRAPH_TESTS_DRAW_EXTRACTOR_H
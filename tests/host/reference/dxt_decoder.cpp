@@ -0,0 +1,282 @@
+#include "dxt_decoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace DXTDecoder {
+namespace {
+
+//! Images with fewer blocks than this are decoded on the calling thread, as spawning workers would dominate.
+constexpr uint32_t kMinParallelBlocks = 4096;
+
+constexpr uint32_t kDDSHeaderSize = 128;
+constexpr uint32_t kDDSFlagMipMapCount = 0x20000;
+constexpr uint32_t kDDSPixelFormatFourCC = 0x4;
+
+uint32_t ReadU32(const uint8_t *data) {
+  return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+uint32_t PackRGBA(uint32_t r, uint32_t g, uint32_t b, uint32_t a) { return r | (g << 8) | (b << 16) | (a << 24); }
+
+//! Builds the 4 entry RGBA palette of a color block. DXT1 blocks whose first endpoint is not greater than the second
+//! use 3 colors and transparent black.
+void BuildColorPalette(const uint8_t *color_block, bool allow_transparent, uint32_t *palette) {
+  const uint32_t c0 = color_block[0] | (color_block[1] << 8);
+  const uint32_t c1 = color_block[2] | (color_block[3] << 8);
+
+  auto expand = [](uint32_t color, uint32_t *rgb) {
+    const uint32_t r = (color >> 11) & 0x1F;
+    const uint32_t g = (color >> 5) & 0x3F;
+    const uint32_t b = color & 0x1F;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+  };
+
+  uint32_t e0[3];
+  uint32_t e1[3];
+  expand(c0, e0);
+  expand(c1, e1);
+
+  palette[0] = PackRGBA(e0[0], e0[1], e0[2], 0xFF);
+  palette[1] = PackRGBA(e1[0], e1[1], e1[2], 0xFF);
+  if (c0 > c1 || !allow_transparent) {
+    palette[2] = PackRGBA((2 * e0[0] + e1[0]) / 3, (2 * e0[1] + e1[1]) / 3, (2 * e0[2] + e1[2]) / 3, 0xFF);
+    palette[3] = PackRGBA((e0[0] + 2 * e1[0]) / 3, (e0[1] + 2 * e1[1]) / 3, (e0[2] + 2 * e1[2]) / 3, 0xFF);
+  } else {
+    palette[2] = PackRGBA((e0[0] + e1[0]) / 2, (e0[1] + e1[1]) / 2, (e0[2] + e1[2]) / 2, 0xFF);
+    palette[3] = 0;
+  }
+}
+
+//! Decodes the 16 alpha values of a DXT3 or DXT5 block.
+void DecodeAlpha(Format format, const uint8_t *alpha_block, uint8_t *alpha) {
+  if (format == Format::DXT3) {
+    for (uint32_t i = 0; i < 16; ++i) {
+      alpha[i] = static_cast<uint8_t>(((alpha_block[i >> 1] >> ((i & 1) * 4)) & 0x0F) * 17);
+    }
+    return;
+  }
+
+  const uint32_t a0 = alpha_block[0];
+  const uint32_t a1 = alpha_block[1];
+  uint8_t palette[8];
+  palette[0] = static_cast<uint8_t>(a0);
+  palette[1] = static_cast<uint8_t>(a1);
+  if (a0 > a1) {
+    for (uint32_t i = 1; i < 7; ++i) {
+      palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1) / 7);
+    }
+  } else {
+    for (uint32_t i = 1; i < 5; ++i) {
+      palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1) / 5);
+    }
+    palette[6] = 0;
+    palette[7] = 0xFF;
+  }
+
+  uint64_t indices = 0;
+  for (uint32_t i = 0; i < 6; ++i) {
+    indices |= static_cast<uint64_t>(alpha_block[2 + i]) << (i * 8);
+  }
+  for (uint32_t i = 0; i < 16; ++i) {
+    alpha[i] = palette[(indices >> (i * 3)) & 0x07];
+  }
+}
+
+void DecodeBlockRow(Format format, const uint8_t *data, uint32_t block_row, uint32_t width, uint32_t height,
+                    uint8_t *rgba) {
+  const uint32_t blocks_wide = std::max(1U, (width + 3) / 4);
+  const uint32_t block_size = BlockSize(format);
+  const uint8_t *block = data + block_row * blocks_wide * block_size;
+  const uint32_t rows = std::min(4U, height - block_row * 4);
+
+  uint8_t texels[64];
+  for (uint32_t block_x = 0; block_x < blocks_wide; ++block_x, block += block_size) {
+    DecodeBlock(format, block, texels);
+    const uint32_t columns = std::min(4U, width - block_x * 4);
+    for (uint32_t y = 0; y < rows; ++y) {
+      memcpy(rgba + ((block_row * 4 + y) * width + block_x * 4) * 4, texels + y * 16, columns * 4);
+    }
+  }
+}
+
+}  // namespace
+
+uint32_t ImageSize(Format format, uint32_t width, uint32_t height) {
+  return std::max(1U, (width + 3) / 4) * std::max(1U, (height + 3) / 4) * BlockSize(format);
+}
+
+void DecodeBlockScalar(Format format, const uint8_t *block, uint8_t *rgba) {
+  const uint8_t *color_block = format == Format::DXT1 ? block : block + 8;
+  uint32_t palette[4];
+  BuildColorPalette(color_block, format == Format::DXT1, palette);
+
+  uint8_t alpha[16];
+  if (format != Format::DXT1) {
+    DecodeAlpha(format, block, alpha);
+  }
+
+  const uint32_t indices = ReadU32(color_block + 4);
+  for (uint32_t i = 0; i < 16; ++i, rgba += 4) {
+    const uint32_t color = palette[(indices >> (i * 2)) & 0x03];
+    rgba[0] = color & 0xFF;
+    rgba[1] = (color >> 8) & 0xFF;
+    rgba[2] = (color >> 16) & 0xFF;
+    rgba[3] = format == Format::DXT1 ? color >> 24 : alpha[i];
+  }
+}
+
+#ifdef __SSE2__
+void DecodeBlock(Format format, const uint8_t *block, uint8_t *rgba) {
+  const uint8_t *color_block = format == Format::DXT1 ? block : block + 8;
+  uint32_t palette[4];
+  BuildColorPalette(color_block, format == Format::DXT1, palette);
+
+  uint8_t alpha[16];
+  if (format != Format::DXT1) {
+    DecodeAlpha(format, block, alpha);
+  }
+
+  // Each row of 4 texels is one byte of the index word. Broadcasting that byte and masking out a different 2 bit
+  // field per lane lets every lane select its palette entry with a compare against that entry's index, shifted into
+  // the lane's field.
+  const __m128i field_mask = _mm_setr_epi32(0x03, 0x0C, 0x30, 0xC0);
+  const __m128i field_scale = _mm_setr_epi32(1, 4, 16, 64);
+  const __m128i index1 = field_scale;
+  const __m128i index2 = _mm_add_epi32(field_scale, field_scale);
+  const __m128i index3 = _mm_add_epi32(index2, field_scale);
+  const __m128i color0 = _mm_set1_epi32(static_cast<int>(palette[0]));
+  const __m128i color1 = _mm_set1_epi32(static_cast<int>(palette[1]));
+  const __m128i color2 = _mm_set1_epi32(static_cast<int>(palette[2]));
+  const __m128i color3 = _mm_set1_epi32(static_cast<int>(palette[3]));
+  const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+  const __m128i zero = _mm_setzero_si128();
+
+  const uint32_t indices = ReadU32(color_block + 4);
+  for (uint32_t row = 0; row < 4; ++row) {
+    const __m128i fields =
+        _mm_and_si128(_mm_set1_epi32(static_cast<int>((indices >> (row * 8)) & 0xFF)), field_mask);
+
+    const __m128i is1 = _mm_cmpeq_epi32(fields, index1);
+    const __m128i is2 = _mm_cmpeq_epi32(fields, index2);
+    const __m128i is3 = _mm_cmpeq_epi32(fields, index3);
+    const __m128i is0 = _mm_cmpeq_epi32(fields, zero);
+    __m128i texels = _mm_or_si128(_mm_or_si128(_mm_and_si128(is0, color0), _mm_and_si128(is1, color1)),
+                                  _mm_or_si128(_mm_and_si128(is2, color2), _mm_and_si128(is3, color3)));
+
+    if (format != Format::DXT1) {
+      int32_t row_alpha;
+      memcpy(&row_alpha, alpha + row * 4, sizeof(row_alpha));
+      __m128i alpha_lanes = _mm_cvtsi32_si128(row_alpha);
+      alpha_lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(alpha_lanes, zero), zero);
+      texels = _mm_or_si128(_mm_and_si128(texels, rgb_mask), _mm_slli_epi32(alpha_lanes, 24));
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(rgba + row * 16), texels);
+  }
+}
+#else
+void DecodeBlock(Format format, const uint8_t *block, uint8_t *rgba) { DecodeBlockScalar(format, block, rgba); }
+#endif
+
+void DecodeImage(Format format, const uint8_t *data, uint32_t width, uint32_t height, std::vector<uint8_t> &rgba,
+                 uint32_t num_threads) {
+  rgba.resize(static_cast<size_t>(width) * height * 4);
+  const uint32_t blocks_high = std::max(1U, (height + 3) / 4);
+  const uint32_t num_blocks = ImageSize(format, width, height) / BlockSize(format);
+
+  if (!num_threads) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  if (num_blocks < kMinParallelBlocks) {
+    num_threads = 1;
+  }
+  num_threads = std::min(num_threads, blocks_high);
+
+  std::atomic<uint32_t> next_row{0};
+  auto worker = [&]() {
+    for (uint32_t row = next_row++; row < blocks_high; row = next_row++) {
+      DecodeBlockRow(format, data, row, width, height, rgba.data());
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+bool ParseDDS(const uint8_t *data, size_t size, DDSFile &output, std::string &error, uint32_t num_threads) {
+  if (size < kDDSHeaderSize || memcmp(data, "DDS ", 4) != 0 || ReadU32(data + 4) != 124) {
+    error = "Not a DDS file";
+    return false;
+  }
+
+  const uint32_t flags = ReadU32(data + 8);
+  uint32_t height = ReadU32(data + 12);
+  uint32_t width = ReadU32(data + 16);
+  const uint32_t num_mipmaps = (flags & kDDSFlagMipMapCount) ? std::max(1U, ReadU32(data + 28)) : 1;
+
+  if (!(ReadU32(data + 80) & kDDSPixelFormatFourCC)) {
+    error = "Uncompressed DDS files are not supported";
+    return false;
+  }
+  if (!memcmp(data + 84, "DXT1", 4)) {
+    output.format = Format::DXT1;
+  } else if (!memcmp(data + 84, "DXT3", 4)) {
+    output.format = Format::DXT3;
+  } else if (!memcmp(data + 84, "DXT5", 4)) {
+    output.format = Format::DXT5;
+  } else {
+    error = "Unsupported FourCC '" + std::string(reinterpret_cast<const char *>(data + 84), 4) + "'";
+    return false;
+  }
+
+  output.mipmaps.clear();
+  size_t offset = kDDSHeaderSize;
+  for (uint32_t level = 0; level < num_mipmaps; ++level) {
+    const uint32_t level_size = ImageSize(output.format, width, height);
+    if (offset + level_size > size) {
+      error = "Truncated mipmap level " + std::to_string(level);
+      return false;
+    }
+
+    Image image;
+    image.width = width;
+    image.height = height;
+    DecodeImage(output.format, data + offset, width, height, image.rgba, num_threads);
+    output.mipmaps.push_back(std::move(image));
+
+    offset += level_size;
+    width = std::max(1U, width / 2);
+    height = std::max(1U, height / 2);
+  }
+
+  return true;
+}
+
+bool LoadDDS(const std::string &path, DDSFile &output, std::string &error, uint32_t num_threads) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    error = "Failed to open " + path;
+    return false;
+  }
+  std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  return ParseDDS(content.data(), content.size(), output, error, num_threads);
+}
+
+}  // namespace DXTDecoder
@@ -0,0 +1,61 @@
+#ifndef NXDK_PGRAPH_TESTS_DXT_DECODER_H
+#define NXDK_PGRAPH_TESTS_DXT_DECODER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Host side decoder for the DXT1/3/5 (BC1/2/3) compressed textures used by TextureFormatDXTTests.
+ *
+ * Output texels are 8-bit RGBA in memory order. Interpolated colors use the 1/3 and 2/3 weights of the D3D
+ * specification with truncating division; hardware is permitted to differ from this by a small amount.
+ */
+namespace DXTDecoder {
+
+enum class Format {
+  DXT1,
+  DXT3,
+  DXT5,
+};
+
+//! Size in bytes of a single 4x4 block of the given format.
+constexpr uint32_t BlockSize(Format format) { return format == Format::DXT1 ? 8 : 16; }
+
+//! Size in bytes of a `width` x `height` image of the given format.
+uint32_t ImageSize(Format format, uint32_t width, uint32_t height);
+
+//! Decodes a single block into 16 RGBA texels (64 bytes, row major).
+void DecodeBlock(Format format, const uint8_t *block, uint8_t *rgba);
+
+//! Portable implementation of DecodeBlock, retained to validate the vectorized version.
+void DecodeBlockScalar(Format format, const uint8_t *block, uint8_t *rgba);
+
+/**
+ * Decodes a compressed image into tightly packed RGBA texels.
+ *
+ * Rows of blocks are split across `num_threads` threads (0 selects std::thread::hardware_concurrency). Small images
+ * are always decoded on the calling thread.
+ */
+void DecodeImage(Format format, const uint8_t *data, uint32_t width, uint32_t height, std::vector<uint8_t> &rgba,
+                 uint32_t num_threads = 0);
+
+struct Image {
+  uint32_t width{0};
+  uint32_t height{0};
+  std::vector<uint8_t> rgba;
+};
+
+//! The decoded contents of a DDS file, ordered from the largest mipmap level to the smallest.
+struct DDSFile {
+  Format format{Format::DXT1};
+  std::vector<Image> mipmaps;
+};
+
+//! Parses and decodes a DXT1/3/5 DDS file with an optional mipmap chain.
+bool ParseDDS(const uint8_t *data, size_t size, DDSFile &output, std::string &error, uint32_t num_threads = 0);
+bool LoadDDS(const std::string &path, DDSFile &output, std::string &error, uint32_t num_threads = 0);
+
+}  // namespace DXTDecoder
+
+#endif  // NXDK_PGRAPH_TESTS_DXT_DECODER_H
@@ -0,0 +1,328 @@
+#include "fog_model.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//! Number of vertices evaluated together.
+static constexpr uint32_t kBatchSize = 64;
+
+// Exponents passed to Exp2 are clamped to this range. Results that would be subnormal (exponents that round to -127)
+// are flushed to zero along with everything below them.
+static constexpr float kExp2Min = -127.f;
+static constexpr float kExp2Max = 127.f;
+
+namespace {
+
+struct alignas(16) Plane {
+  float v[kBatchSize];
+};
+
+//! Copies up to kBatchSize values of `source` (or zeros if it is null) into `out`, zero filling the remainder.
+void Load(const float *source, uint32_t count, Plane &out) {
+  if (source) {
+    memcpy(out.v, source, count * sizeof(float));
+  } else {
+    count = 0;
+  }
+  std::fill(out.v + count, std::end(out.v), 0.f);
+}
+
+inline float Multiply(float a, float b) { return (a != 0.f && b != 0.f) ? a * b : 0.f; }
+
+//! Clamps to [low, high], mapping NaN to `low`. Matches the operand order semantics of maxps/minps.
+inline float Clamp(float value, float low, float high) {
+  const float ret = value > low ? value : low;
+  return ret < high ? ret : high;
+}
+
+//! 2^x via a degree 6 polynomial on the fractional part, accurate to a few ulp for x in [kExp2Min, kExp2Max].
+inline float Exp2(float x) {
+  x = Clamp(x, kExp2Min, kExp2Max);
+  const float whole = std::floor(x + 0.5f);
+  const float f = x - whole;
+  float p = 1.535336188319500e-4f;
+  p = p * f + 1.339887440266574e-3f;
+  p = p * f + 9.618437357674640e-3f;
+  p = p * f + 5.550332471162809e-2f;
+  p = p * f + 2.402264791363012e-1f;
+  p = p * f + 6.931472028550421e-1f;
+  p = p * f + 1.f;
+
+  const uint32_t scale_bits = static_cast<uint32_t>(static_cast<int32_t>(whole) + 127) << 23;
+  float scale;
+  memcpy(&scale, &scale_bits, sizeof(scale));
+  return p * scale;
+}
+
+#ifdef __SSE2__
+inline __m128 Multiply(__m128 a, __m128 b) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 nonzero = _mm_and_ps(_mm_cmpneq_ps(a, zero), _mm_cmpneq_ps(b, zero));
+  return _mm_and_ps(nonzero, _mm_mul_ps(a, b));
+}
+
+inline __m128 Clamp(__m128 value, __m128 low, __m128 high) { return _mm_min_ps(_mm_max_ps(value, low), high); }
+
+inline __m128 Abs(__m128 value) { return _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF))); }
+
+inline __m128 Exp2(__m128 x) {
+  x = Clamp(x, _mm_set1_ps(kExp2Min), _mm_set1_ps(kExp2Max));
+
+  // floor(x + 0.5) without SSE4.1: truncate, then step down where truncation rounded a negative value up.
+  const __m128 biased = _mm_add_ps(x, _mm_set1_ps(0.5f));
+  __m128i whole_int = _mm_cvttps_epi32(biased);
+  const __m128 truncated = _mm_cvtepi32_ps(whole_int);
+  whole_int = _mm_add_epi32(whole_int, _mm_castps_si128(_mm_cmpgt_ps(truncated, biased)));
+  const __m128 whole = _mm_cvtepi32_ps(whole_int);
+  const __m128 f = _mm_sub_ps(x, whole);
+
+  __m128 p = _mm_set1_ps(1.535336188319500e-4f);
+  p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.339887440266574e-3f));
+  p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(9.618437357674640e-3f));
+  p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(5.550332471162809e-2f));
+  p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(2.402264791363012e-1f));
+  p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(6.931472028550421e-1f));
+  p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.f));
+
+  const __m128i scale = _mm_slli_epi32(_mm_add_epi32(whole_int, _mm_set1_epi32(127)), 23);
+  return _mm_mul_ps(p, _mm_castsi128_ps(scale));
+}
+#endif
+
+//! Parameters of a fog mode, expressed as an optional absolute value of bias + F(d) - offset.
+struct ModeParams {
+  bool exponential;
+  bool squared;
+  bool absolute;
+  bool zero_infinite_distance;
+  float offset;
+};
+
+ModeParams GetModeParams(FogModel::FogMode mode) {
+  switch (mode) {
+    case FogModel::FOG_LINEAR:
+    default:
+      return {false, false, false, true, 1.f};
+    case FogModel::FOG_LINEAR_ABS:
+      return {false, false, true, true, 1.f};
+    case FogModel::FOG_EXP:
+      return {true, false, false, true, 1.5f};
+    case FogModel::FOG_EXP_ABS:
+      return {true, false, true, false, 1.5f};
+    case FogModel::FOG_EXP2:
+      return {true, true, false, false, 1.5f};
+    case FogModel::FOG_EXP2_ABS:
+      return {true, true, true, false, 1.5f};
+  }
+}
+
+//! Computes the fog distance for a batch from the generation mode.
+template <bool kVectorized>
+void GenerateDistance(FogModel::FogGenMode mode, const float *plane, const Plane &x, const Plane &y, const Plane &z,
+                      const Plane &specular_alpha, const Plane &fog_coord, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 plane_a = _mm_set1_ps(plane[0]);
+    const __m128 plane_b = _mm_set1_ps(plane[1]);
+    const __m128 plane_c = _mm_set1_ps(plane[2]);
+    const __m128 plane_d = _mm_set1_ps(plane[3]);
+    const __m128 min_normal = _mm_set1_ps(FLT_MIN);
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      __m128 distance;
+      switch (mode) {
+        case FogModel::FOG_GEN_SPEC_ALPHA:
+          distance = Clamp(_mm_load_ps(specular_alpha.v + i), zero, one);
+          break;
+        case FogModel::FOG_GEN_RADIAL: {
+          const __m128 x_value = _mm_load_ps(x.v + i);
+          const __m128 y_value = _mm_load_ps(y.v + i);
+          const __m128 z_value = _mm_load_ps(z.v + i);
+          __m128 sum = _mm_mul_ps(x_value, x_value);
+          sum = _mm_add_ps(sum, _mm_mul_ps(y_value, y_value));
+          sum = _mm_add_ps(sum, _mm_mul_ps(z_value, z_value));
+          distance = _mm_sqrt_ps(sum);
+        } break;
+        case FogModel::FOG_GEN_PLANAR:
+        case FogModel::FOG_GEN_ABS_PLANAR:
+          distance = Multiply(plane_a, _mm_load_ps(x.v + i));
+          distance = _mm_add_ps(distance, Multiply(plane_b, _mm_load_ps(y.v + i)));
+          distance = _mm_add_ps(distance, Multiply(plane_c, _mm_load_ps(z.v + i)));
+          distance = _mm_add_ps(distance, plane_d);
+          if (mode == FogModel::FOG_GEN_ABS_PLANAR) {
+            distance = Abs(distance);
+          }
+          break;
+        case FogModel::FOG_GEN_FOG_X:
+        default:
+          distance = _mm_load_ps(fog_coord.v + i);
+          break;
+      }
+
+      // Subnormals are flushed to zero; NaN compares false and is preserved.
+      const __m128 subnormal = _mm_cmplt_ps(Abs(distance), min_normal);
+      _mm_store_ps(out.v + i, _mm_andnot_ps(subnormal, distance));
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    float distance;
+    switch (mode) {
+      case FogModel::FOG_GEN_SPEC_ALPHA:
+        distance = Clamp(specular_alpha.v[i], 0.f, 1.f);
+        break;
+      case FogModel::FOG_GEN_RADIAL: {
+        float sum = x.v[i] * x.v[i];
+        sum += y.v[i] * y.v[i];
+        sum += z.v[i] * z.v[i];
+        distance = std::sqrt(sum);
+      } break;
+      case FogModel::FOG_GEN_PLANAR:
+      case FogModel::FOG_GEN_ABS_PLANAR:
+        distance = Multiply(plane[0], x.v[i]);
+        distance += Multiply(plane[1], y.v[i]);
+        distance += Multiply(plane[2], z.v[i]);
+        distance += plane[3];
+        if (mode == FogModel::FOG_GEN_ABS_PLANAR) {
+          distance = std::fabs(distance);
+        }
+        break;
+      case FogModel::FOG_GEN_FOG_X:
+      default:
+        distance = fog_coord.v[i];
+        break;
+    }
+
+    out.v[i] = std::fabs(distance) < FLT_MIN ? 0.f : distance;
+  }
+}
+
+//! Converts a batch of fog distances into clamped fog factors.
+template <bool kVectorized>
+void ComputeFactor(const ModeParams &params, float bias, float multiplier, const Plane &distance, Plane &out) {
+  // Scaling by a power of two is exact, so folding the constants into the multiplier does not change the result.
+  const float scale = params.squared ? multiplier * multiplier * 32.f : multiplier * (params.exponential ? 16.f : 1.f);
+  const float offset = bias - params.offset;
+
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128 scale_value = _mm_set1_ps(scale);
+    const __m128 offset_value = _mm_set1_ps(offset);
+    const __m128 infinity = _mm_set1_ps(INFINITY);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      __m128 d = _mm_load_ps(distance.v + i);
+      if (params.zero_infinite_distance) {
+        d = _mm_andnot_ps(_mm_cmpeq_ps(Abs(d), infinity), d);
+      }
+
+      __m128 factor;
+      if (!params.exponential) {
+        factor = Multiply(d, scale_value);
+      } else if (!params.squared) {
+        factor = Exp2(Multiply(d, scale_value));
+      } else {
+        const __m128 exponent = Multiply(Multiply(d, d), scale_value);
+        factor = Exp2(_mm_xor_ps(exponent, _mm_set1_ps(-0.f)));
+      }
+      factor = _mm_add_ps(offset_value, factor);
+      if (params.absolute) {
+        factor = Abs(factor);
+      }
+      _mm_store_ps(out.v + i, Clamp(factor, zero, one));
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    float d = distance.v[i];
+    if (params.zero_infinite_distance && std::isinf(d)) {
+      d = 0.f;
+    }
+
+    float factor;
+    if (!params.exponential) {
+      factor = Multiply(d, scale);
+    } else if (!params.squared) {
+      factor = Exp2(Multiply(d, scale));
+    } else {
+      factor = Exp2(-Multiply(Multiply(d, d), scale));
+    }
+    factor = offset + factor;
+    if (params.absolute) {
+      factor = std::fabs(factor);
+    }
+    out.v[i] = Clamp(factor, 0.f, 1.f);
+  }
+}
+
+}  // namespace
+
+template <bool kVectorized>
+void FogModel::EvaluateRange(const Inputs &inputs, float *factors, uint32_t begin, uint32_t end) const {
+  const ModeParams params = GetModeParams(fog_mode_);
+  const FogGenMode gen_mode = vertex_program_active_ ? FOG_GEN_FOG_X : fog_gen_mode_;
+  const bool reads_position =
+      gen_mode == FOG_GEN_RADIAL || gen_mode == FOG_GEN_PLANAR || gen_mode == FOG_GEN_ABS_PLANAR;
+
+  Plane x, y, z, specular_alpha, fog_coord, distance, factor;
+  for (uint32_t offset = begin; offset < end; offset += kBatchSize) {
+    const uint32_t count = std::min(kBatchSize, end - offset);
+    auto load = [offset, count](const float *source, Plane &out) {
+      Load(source ? source + offset : nullptr, count, out);
+    };
+
+    if (reads_position) {
+      load(inputs.eye_x, x);
+      load(inputs.eye_y, y);
+      load(inputs.eye_z, z);
+    }
+    if (gen_mode == FOG_GEN_SPEC_ALPHA) {
+      load(inputs.specular_alpha, specular_alpha);
+    }
+    if (gen_mode == FOG_GEN_FOG_X) {
+      load(inputs.fog_coord, fog_coord);
+    }
+
+    GenerateDistance<kVectorized>(gen_mode, plane_, x, y, z, specular_alpha, fog_coord, distance);
+    ComputeFactor<kVectorized>(params, bias_, multiplier_, distance, factor);
+    memcpy(factors + offset, factor.v, count * sizeof(float));
+  }
+}
+
+void FogModel::Evaluate(const Inputs &inputs, std::vector<float> &factors) const {
+  factors.resize(inputs.count);
+#ifdef __SSE2__
+  EvaluateRange<true>(inputs, factors.data(), 0, inputs.count);
+#else
+  EvaluateRange<false>(inputs, factors.data(), 0, inputs.count);
+#endif
+}
+
+void FogModel::EvaluateScalar(const Inputs &inputs, std::vector<float> &factors) const {
+  factors.resize(inputs.count);
+  EvaluateRange<false>(inputs, factors.data(), 0, inputs.count);
+}
+
+const char *FogModel::KernelName() {
+#ifdef __SSE2__
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
+
+uint8_t FogModel::ToFogAlpha(float factor) {
+  return static_cast<uint8_t>(std::lround(Clamp(factor, 0.f, 1.f) * 255.f));
+}
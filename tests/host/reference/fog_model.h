@@ -0,0 +1,106 @@
+#ifndef NXDK_PGRAPH_TESTS_FOG_MODEL_H
+#define NXDK_PGRAPH_TESTS_FOG_MODEL_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Host side model of the NV2A fixed function fog factor computation.
+ *
+ * A fog distance is produced per vertex by the configured generation mode (or taken from oFog.x when a vertex program
+ * is active) and converted into a fog factor in [0, 1] by the fog mode, using the NV097_SET_FOG_PARAMS bias (B) and
+ * multiplier (M):
+ *
+ *   LINEAR: B + d * M - 1
+ *   EXP:    B + 2^(d * M * 16) - 1.5
+ *   EXP2:   B + 2^(-(d * d) * (M * M) * 32) - 1.5
+ *
+ * The _ABS variants take the absolute value of the result. With the parameters used by the suites these are the usual
+ * (end - d) / (end - start), e^-(density * d) and e^-(density * d)^2 D3D fog functions.
+ *
+ * Exceptional values follow the NV2A's float rules: subnormal distances are flushed to zero, multiplication yields 0 if
+ * either operand is 0 (even if the other is infinite or NaN), infinite distances are treated as 0 in the LINEAR,
+ * LINEAR_ABS and EXP modes, and a factor that is NaN is clamped to 0.
+ *
+ * Vertices are evaluated in batches in structure-of-arrays form so that every step is applied to a whole batch at once.
+ */
+class FogModel {
+ public:
+  // Values mirror NV097_SET_FOG_MODE_V_*.
+  enum FogMode {
+    FOG_LINEAR = 0x2601,
+    FOG_EXP = 0x800,
+    FOG_EXP2 = 0x801,
+    FOG_EXP_ABS = 0x802,
+    FOG_EXP2_ABS = 0x803,
+    FOG_LINEAR_ABS = 0x804,
+  };
+
+  // Values mirror NV097_SET_FOG_GEN_MODE_V_*.
+  enum FogGenMode {
+    FOG_GEN_SPEC_ALPHA = 0,
+    FOG_GEN_RADIAL = 1,
+    FOG_GEN_PLANAR = 2,
+    FOG_GEN_ABS_PLANAR = 3,
+    FOG_GEN_FOG_X = 6,
+  };
+
+  //! Per vertex inputs, each an array of `count` values. Unset arrays read as 0.
+  struct Inputs {
+    uint32_t count{0};
+
+    //! Eye space position, used by the radial and planar generation modes.
+    const float *eye_x{nullptr};
+    const float *eye_y{nullptr};
+    const float *eye_z{nullptr};
+    const float *specular_alpha{nullptr};
+    //! The fog coordinate for FOG_GEN_FOG_X, or oFog.x when a vertex program is active.
+    const float *fog_coord{nullptr};
+  };
+
+ public:
+  void SetFogMode(FogMode mode) { fog_mode_ = mode; }
+  void SetFogGenMode(FogGenMode mode) { fog_gen_mode_ = mode; }
+
+  //! Mirrors NV097_SET_FOG_PARAMS. The third parameter has no known effect and is not modeled.
+  void SetFogParams(float bias, float multiplier) {
+    bias_ = bias;
+    multiplier_ = multiplier;
+  }
+
+  //! Mirrors NV097_SET_FOG_PLANE, used by the planar generation modes as dot(plane.xyz, eye) + plane.w.
+  void SetFogPlane(float a, float b, float c, float d) {
+    plane_[0] = a;
+    plane_[1] = b;
+    plane_[2] = c;
+    plane_[3] = d;
+  }
+
+  //! When set, the generation mode is ignored and the distance is taken from `fog_coord` (oFog.x).
+  void SetVertexProgramActive(bool active) { vertex_program_active_ = active; }
+
+  //! Computes the fog factor for every vertex of `inputs`.
+  void Evaluate(const Inputs &inputs, std::vector<float> &factors) const;
+
+  //! Portable implementation of Evaluate, retained to validate the vectorized version.
+  void EvaluateScalar(const Inputs &inputs, std::vector<float> &factors) const;
+
+  //! Returns the name of the kernel set used by Evaluate.
+  static const char *KernelName();
+
+  //! Converts a fog factor to the 8-bit fog alpha read by the combiners as SRC_FOG.a.
+  static uint8_t ToFogAlpha(float factor);
+
+ private:
+  template <bool kVectorized>
+  void EvaluateRange(const Inputs &inputs, float *factors, uint32_t begin, uint32_t end) const;
+
+  FogMode fog_mode_{FOG_LINEAR};
+  FogGenMode fog_gen_mode_{FOG_GEN_SPEC_ALPHA};
+  float bias_{0.f};
+  float multiplier_{0.f};
+  float plane_[4]{0.f, 0.f, 1.f, 0.f};
+  bool vertex_program_active_{false};
+};
+
+#endif  // NXDK_PGRAPH_TESTS_FOG_MODEL_H
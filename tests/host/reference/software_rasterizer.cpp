@@ -0,0 +1,383 @@
+#include "software_rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+SoftwareRasterizer::SoftwareRasterizer(uint32_t width, uint32_t height, uint32_t num_threads, uint32_t tile_size)
+    : width_(width),
+      height_(height),
+      tile_size_(tile_size),
+      tiles_x_((width + tile_size - 1) / tile_size),
+      tiles_y_((height + tile_size - 1) / tile_size),
+      pixels_(width * height, 0),
+      tile_bins_(tiles_x_ * tiles_y_) {
+  if (!num_threads) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+
+  // The thread calling Flush also rasterizes, so only num_threads - 1 workers are needed.
+  for (uint32_t i = 1; i < num_threads; ++i) {
+    workers_.emplace_back(&SoftwareRasterizer::WorkerMain, this);
+  }
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  work_ready_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+int32_t SoftwareRasterizer::SnapToSubpixel(float value) {
+  return static_cast<int32_t>(std::lrintf(value * static_cast<float>(kSubpixelScale)));
+}
+
+void SoftwareRasterizer::Clear(uint32_t argb, int32_t left, int32_t top, int32_t right, int32_t bottom) {
+  Command command{};
+  command.is_clear = true;
+  command.clear_color = argb;
+  command.min_x = std::max(0, left);
+  command.min_y = std::max(0, top);
+  command.max_x = std::min(static_cast<int32_t>(width_) - 1, right);
+  command.max_y = std::min(static_cast<int32_t>(height_) - 1, bottom);
+  if (command.min_x > command.max_x || command.min_y > command.max_y) {
+    return;
+  }
+  commands_.push_back(command);
+}
+
+void SoftwareRasterizer::DrawTriangle(const Vertex &a, const Vertex &b, const Vertex &c) {
+  Command command{};
+  const Vertex *vertices[3] = {&a, &b, &c};
+  for (auto i = 0; i < 3; ++i) {
+    const auto &v = *vertices[i];
+    const float inv_w = (v.w != 0.0f) ? 1.0f / v.w : 1.0f;
+    command.x[i] = SnapToSubpixel(v.x * inv_w);
+    command.y[i] = SnapToSubpixel(v.y * inv_w);
+    std::copy(std::begin(v.color), std::end(v.color), command.color[i]);
+  }
+  command.fragment_state = fragment_state_;
+
+  command.area = static_cast<int64_t>(command.x[1] - command.x[0]) * (command.y[2] - command.y[0]) -
+                 static_cast<int64_t>(command.y[1] - command.y[0]) * (command.x[2] - command.x[0]);
+  if (!command.area) {
+    return;
+  }
+
+  // Culling is not modeled, so normalize the winding such that the interior is where all edge functions are positive.
+  if (command.area < 0) {
+    std::swap(command.x[1], command.x[2]);
+    std::swap(command.y[1], command.y[2]);
+    std::swap(command.color[1], command.color[2]);
+    command.area = -command.area;
+  }
+
+  // Pixel (px, py) is sampled at subpixel (px * 16 + 8, py * 16 + 8).
+  auto to_pixel_min = [](int32_t value) { return (value - kSubpixelScale / 2 + kSubpixelScale - 1) >> kSubpixelBits; };
+  auto to_pixel_max = [](int32_t value) { return (value - kSubpixelScale / 2) >> kSubpixelBits; };
+  command.min_x = std::max(0, to_pixel_min(std::min({command.x[0], command.x[1], command.x[2]})));
+  command.min_y = std::max(0, to_pixel_min(std::min({command.y[0], command.y[1], command.y[2]})));
+  command.max_x =
+      std::min(static_cast<int32_t>(width_) - 1, to_pixel_max(std::max({command.x[0], command.x[1], command.x[2]})));
+  command.max_y =
+      std::min(static_cast<int32_t>(height_) - 1, to_pixel_max(std::max({command.y[0], command.y[1], command.y[2]})));
+  if (command.min_x > command.max_x || command.min_y > command.max_y) {
+    return;
+  }
+
+  commands_.push_back(command);
+}
+
+void SoftwareRasterizer::Flush() {
+  if (commands_.empty()) {
+    return;
+  }
+
+  for (auto &bin : tile_bins_) {
+    bin.clear();
+  }
+  for (uint32_t i = 0; i < commands_.size(); ++i) {
+    const auto &command = commands_[i];
+    const uint32_t tile_left = command.min_x / tile_size_;
+    const uint32_t tile_right = command.max_x / tile_size_;
+    const uint32_t tile_top = command.min_y / tile_size_;
+    const uint32_t tile_bottom = command.max_y / tile_size_;
+    for (uint32_t ty = tile_top; ty <= tile_bottom; ++ty) {
+      for (uint32_t tx = tile_left; tx <= tile_right; ++tx) {
+        tile_bins_[ty * tiles_x_ + tx].push_back(i);
+      }
+    }
+  }
+
+  next_tile_ = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    active_workers_ = static_cast<uint32_t>(workers_.size());
+  }
+  work_ready_.notify_all();
+
+  const auto num_tiles = static_cast<uint32_t>(tile_bins_.size());
+  for (uint32_t tile = next_tile_++; tile < num_tiles; tile = next_tile_++) {
+    RasterizeTile(tile);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    work_done_.wait(lock, [this] { return !active_workers_; });
+  }
+
+  commands_.clear();
+}
+
+void SoftwareRasterizer::WorkerMain() {
+  uint64_t seen_generation = 0;
+  const auto num_tiles = static_cast<uint32_t>(tile_bins_.size());
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_ready_.wait(lock, [this, seen_generation] { return shutdown_ || generation_ != seen_generation; });
+      if (shutdown_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+
+    for (uint32_t tile = next_tile_++; tile < num_tiles; tile = next_tile_++) {
+      RasterizeTile(tile);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!--active_workers_) {
+        work_done_.notify_one();
+      }
+    }
+  }
+}
+
+void SoftwareRasterizer::RasterizeTile(uint32_t tile_index) {
+  const auto tile_x = static_cast<int32_t>((tile_index % tiles_x_) * tile_size_);
+  const auto tile_y = static_cast<int32_t>((tile_index / tiles_x_) * tile_size_);
+  const int32_t tile_right = std::min(tile_x + static_cast<int32_t>(tile_size_), static_cast<int32_t>(width_)) - 1;
+  const int32_t tile_bottom = std::min(tile_y + static_cast<int32_t>(tile_size_), static_cast<int32_t>(height_)) - 1;
+
+  for (auto command_index : tile_bins_[tile_index]) {
+    const auto &command = commands_[command_index];
+    const int32_t left = std::max(tile_x, command.min_x);
+    const int32_t top = std::max(tile_y, command.min_y);
+    const int32_t right = std::min(tile_right, command.max_x);
+    const int32_t bottom = std::min(tile_bottom, command.max_y);
+
+    if (command.is_clear) {
+      for (int32_t y = top; y <= bottom; ++y) {
+        auto row = pixels_.data() + y * width_;
+        std::fill(row + left, row + right + 1, command.clear_color);
+      }
+      continue;
+    }
+
+    ShadeTriangle(command, left, top, right, bottom);
+  }
+}
+
+static inline uint32_t ToByte(float value) {
+  return static_cast<uint32_t>(std::lrintf(std::min(1.0f, std::max(0.0f, value)) * 255.0f));
+}
+
+static inline uint32_t PackColor(const float *color) {
+  return (ToByte(color[3]) << 24) | (ToByte(color[0]) << 16) | (ToByte(color[1]) << 8) | ToByte(color[2]);
+}
+
+static inline void UnpackColor(uint32_t argb, float *color) {
+  color[0] = static_cast<float>((argb >> 16) & 0xFF) / 255.0f;
+  color[1] = static_cast<float>((argb >> 8) & 0xFF) / 255.0f;
+  color[2] = static_cast<float>(argb & 0xFF) / 255.0f;
+  color[3] = static_cast<float>(argb >> 24) / 255.0f;
+}
+
+static bool Compare(SoftwareRasterizer::CompareFunc func, uint32_t value, uint32_t reference) {
+  using CompareFunc = SoftwareRasterizer::CompareFunc;
+  switch (func) {
+    case CompareFunc::NEVER:
+      return false;
+    case CompareFunc::LESS:
+      return value < reference;
+    case CompareFunc::EQUAL:
+      return value == reference;
+    case CompareFunc::LEQUAL:
+      return value <= reference;
+    case CompareFunc::GREATER:
+      return value > reference;
+    case CompareFunc::NOTEQUAL:
+      return value != reference;
+    case CompareFunc::GEQUAL:
+      return value >= reference;
+    case CompareFunc::ALWAYS:
+      return true;
+  }
+  return true;
+}
+
+static float GetBlendFactor(SoftwareRasterizer::BlendFactor factor, int component, const float *src, const float *dst,
+                            const float *constant) {
+  using BlendFactor = SoftwareRasterizer::BlendFactor;
+  switch (factor) {
+    case BlendFactor::ZERO:
+      return 0.0f;
+    case BlendFactor::ONE:
+      return 1.0f;
+    case BlendFactor::SRC_COLOR:
+      return src[component];
+    case BlendFactor::ONE_MINUS_SRC_COLOR:
+      return 1.0f - src[component];
+    case BlendFactor::SRC_ALPHA:
+      return src[3];
+    case BlendFactor::ONE_MINUS_SRC_ALPHA:
+      return 1.0f - src[3];
+    case BlendFactor::DST_ALPHA:
+      return dst[3];
+    case BlendFactor::ONE_MINUS_DST_ALPHA:
+      return 1.0f - dst[3];
+    case BlendFactor::DST_COLOR:
+      return dst[component];
+    case BlendFactor::ONE_MINUS_DST_COLOR:
+      return 1.0f - dst[component];
+    case BlendFactor::SRC_ALPHA_SATURATE:
+      return component == 3 ? 1.0f : std::min(src[3], 1.0f - dst[3]);
+    case BlendFactor::CONSTANT_COLOR:
+      return constant[component];
+    case BlendFactor::ONE_MINUS_CONSTANT_COLOR:
+      return 1.0f - constant[component];
+    case BlendFactor::CONSTANT_ALPHA:
+      return constant[3];
+    case BlendFactor::ONE_MINUS_CONSTANT_ALPHA:
+      return 1.0f - constant[3];
+  }
+  return 1.0f;
+}
+
+//! Applies the alpha test and blend to a shaded RGBA fragment. Returns false if the fragment is discarded.
+static bool WriteFragment(const SoftwareRasterizer::FragmentState &state, const float *color, uint32_t &pixel) {
+  using BlendEquation = SoftwareRasterizer::BlendEquation;
+
+  // The combiners produce 8-bit components, so the fragment is quantized before it is tested and blended.
+  float src[4];
+  for (auto c = 0; c < 4; ++c) {
+    src[c] = static_cast<float>(ToByte(color[c])) / 255.0f;
+  }
+
+  if (state.alpha_test && !Compare(state.alpha_func, ToByte(src[3]), state.alpha_ref)) {
+    return false;
+  }
+
+  if (!state.blend) {
+    pixel = PackColor(src);
+    return true;
+  }
+
+  float dst[4];
+  float constant[4];
+  UnpackColor(pixel, dst);
+  UnpackColor(state.blend_color, constant);
+
+  float result[4];
+  for (auto c = 0; c < 4; ++c) {
+    const float source_term = src[c] * GetBlendFactor(state.src_factor, c, src, dst, constant);
+    const float dest_term = dst[c] * GetBlendFactor(state.dst_factor, c, src, dst, constant);
+    switch (state.equation) {
+      case BlendEquation::ADD:
+        result[c] = source_term + dest_term;
+        break;
+      case BlendEquation::SUBTRACT:
+        result[c] = source_term - dest_term;
+        break;
+      case BlendEquation::REVERSE_SUBTRACT:
+        result[c] = dest_term - source_term;
+        break;
+      case BlendEquation::MIN:
+        result[c] = std::min(src[c], dst[c]);
+        break;
+      case BlendEquation::MAX:
+        result[c] = std::max(src[c], dst[c]);
+        break;
+    }
+  }
+  pixel = PackColor(result);
+  return true;
+}
+
+void SoftwareRasterizer::ShadeTriangle(const Command &command, int32_t left, int32_t top, int32_t right,
+                                       int32_t bottom) {
+  // Edge i is opposite vertex i; E_i(p) is proportional to the barycentric weight of vertex i.
+  int64_t step_x[3];
+  int64_t step_y[3];
+  int64_t row_start[3];
+
+  const int32_t sample_x = left * kSubpixelScale + kSubpixelScale / 2;
+  const int32_t sample_y = top * kSubpixelScale + kSubpixelScale / 2;
+
+  for (auto i = 0; i < 3; ++i) {
+    const auto a = (i + 1) % 3;
+    const auto b = (i + 2) % 3;
+    const int64_t dx = command.x[b] - command.x[a];
+    const int64_t dy = command.y[b] - command.y[a];
+
+    // Top-left rule: samples exactly on an edge belong to the triangle only if the edge is a top edge (horizontal,
+    // with the interior below it) or a left edge. With y pointing down and positive area, those are the edges with
+    // dy < 0, or dy == 0 and dx > 0.
+    const bool top_left = dy < 0 || (dy == 0 && dx > 0);
+    const int64_t bias = top_left ? 0 : -1;
+
+    step_x[i] = -dy * kSubpixelScale;
+    step_y[i] = dx * kSubpixelScale;
+    row_start[i] = dx * (sample_y - command.y[a]) - dy * (sample_x - command.x[a]) + bias;
+  }
+
+  // Most passthrough tests draw flat colored geometry, which can skip interpolation entirely.
+  const bool flat = std::equal(std::begin(command.color[0]), std::end(command.color[0]), command.color[1]) &&
+                    std::equal(std::begin(command.color[0]), std::end(command.color[0]), command.color[2]);
+  const auto &state = command.fragment_state;
+  const bool replace = !state.alpha_test && !state.blend;
+  const uint32_t flat_color = PackColor(command.color[0]);
+
+  const float inv_area = 1.0f / static_cast<float>(command.area);
+  for (int32_t y = top; y <= bottom; ++y) {
+    int64_t e0 = row_start[0];
+    int64_t e1 = row_start[1];
+    int64_t e2 = row_start[2];
+    auto row = pixels_.data() + y * width_;
+
+    for (int32_t x = left; x <= right; ++x) {
+      if ((e0 | e1 | e2) >= 0) {
+        if (flat && replace) {
+          row[x] = flat_color;
+        } else if (flat) {
+          WriteFragment(state, command.color[0], row[x]);
+        } else {
+          // The fill rule bias is a single 1/256th pixel unit and is ignored for interpolation.
+          const float w0 = static_cast<float>(e0) * inv_area;
+          const float w1 = static_cast<float>(e1) * inv_area;
+          const float w2 = 1.0f - w0 - w1;
+          float color[4];
+          for (auto c = 0; c < 4; ++c) {
+            color[c] = command.color[0][c] * w0 + command.color[1][c] * w1 + command.color[2][c] * w2;
+          }
+          WriteFragment(state, color, row[x]);
+        }
+      }
+      e0 += step_x[0];
+      e1 += step_x[1];
+      e2 += step_x[2];
+    }
+
+    row_start[0] += step_y[0];
+    row_start[1] += step_y[1];
+    row_start[2] += step_y[2];
+  }
+}
@@ -0,0 +1,149 @@
+#ifndef NXDK_PGRAPH_TESTS_SOFTWARE_RASTERIZER_H
+#define NXDK_PGRAPH_TESTS_SOFTWARE_RASTERIZER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Minimal reference rasterizer for screen-space (passthrough shader) geometry.
+ *
+ * Vertices are snapped to the NV2A's 12.4 fixed point subpixel grid and sampled at pixel centers using a top-left fill
+ * rule. Fragments are Gouraud shaded diffuse color, equivalent to a combiner setup that routes the diffuse color
+ * directly to the final output, which is then passed through the alpha test and blend described by FragmentState.
+ * Depth, stencil, and texturing are not modeled.
+ *
+ * Commands are queued and then rasterized by Flush, which splits the framebuffer into tiles that are processed in
+ * parallel. Each tile applies the commands that overlap it in submission order, so the result is independent of the
+ * number of threads.
+ */
+class SoftwareRasterizer {
+ public:
+  //! Number of fractional bits in the subpixel grid.
+  static constexpr int32_t kSubpixelBits = 4;
+  static constexpr int32_t kSubpixelScale = 1 << kSubpixelBits;
+
+  struct Vertex {
+    //! Screen space position.
+    float x, y, z, w;
+    //! RGBA color, each component in the range [0, 1].
+    float color[4];
+  };
+
+  //! Comparison used by the alpha test, in the order of the GL enums accepted by NV097_SET_ALPHA_FUNC.
+  enum class CompareFunc : uint8_t { NEVER, LESS, EQUAL, LEQUAL, GREATER, NOTEQUAL, GEQUAL, ALWAYS };
+
+  enum class BlendFactor : uint8_t {
+    ZERO,
+    ONE,
+    SRC_COLOR,
+    ONE_MINUS_SRC_COLOR,
+    SRC_ALPHA,
+    ONE_MINUS_SRC_ALPHA,
+    DST_ALPHA,
+    ONE_MINUS_DST_ALPHA,
+    DST_COLOR,
+    ONE_MINUS_DST_COLOR,
+    SRC_ALPHA_SATURATE,
+    CONSTANT_COLOR,
+    ONE_MINUS_CONSTANT_COLOR,
+    CONSTANT_ALPHA,
+    ONE_MINUS_CONSTANT_ALPHA,
+  };
+
+  //! Unsigned blend equations. The NV2A's signed variants are not modeled.
+  enum class BlendEquation : uint8_t { ADD, SUBTRACT, REVERSE_SUBTRACT, MIN, MAX };
+
+  //! Per-fragment operations applied to triangles, captured when each triangle is queued.
+  struct FragmentState {
+    bool alpha_test{false};
+    CompareFunc alpha_func{CompareFunc::ALWAYS};
+    //! Reference value compared against the fragment's 8-bit alpha.
+    uint8_t alpha_ref{0};
+
+    bool blend{false};
+    BlendFactor src_factor{BlendFactor::ONE};
+    BlendFactor dst_factor{BlendFactor::ZERO};
+    BlendEquation equation{BlendEquation::ADD};
+    //! 0xAARRGGBB constant used by the CONSTANT_* blend factors.
+    uint32_t blend_color{0};
+  };
+
+ public:
+  //! Creates a rasterizer. `num_threads` of 0 selects std::thread::hardware_concurrency.
+  SoftwareRasterizer(uint32_t width, uint32_t height, uint32_t num_threads = 0, uint32_t tile_size = 64);
+  ~SoftwareRasterizer();
+
+  SoftwareRasterizer(const SoftwareRasterizer &) = delete;
+  SoftwareRasterizer &operator=(const SoftwareRasterizer &) = delete;
+
+  //! Queues a fill of the inclusive rectangle [left, right] x [top, bottom] with the given 0xAARRGGBB color.
+  void Clear(uint32_t argb, int32_t left, int32_t top, int32_t right, int32_t bottom);
+  void Clear(uint32_t argb) { Clear(argb, 0, 0, static_cast<int32_t>(width_) - 1, static_cast<int32_t>(height_) - 1); }
+
+  //! Sets the fragment operations used by subsequently queued triangles.
+  void SetFragmentState(const FragmentState &state) { fragment_state_ = state; }
+  [[nodiscard]] const FragmentState &GetFragmentState() const { return fragment_state_; }
+
+  //! Queues a triangle. Degenerate and fully offscreen triangles are discarded.
+  void DrawTriangle(const Vertex &a, const Vertex &b, const Vertex &c);
+
+  //! Rasterizes every queued command.
+  void Flush();
+
+  //! Returns the framebuffer as 0xAARRGGBB pixels, row major with no padding.
+  [[nodiscard]] const std::vector<uint32_t> &pixels() const { return pixels_; }
+  [[nodiscard]] uint32_t width() const { return width_; }
+  [[nodiscard]] uint32_t height() const { return height_; }
+
+  //! Converts a screen space coordinate to the 12.4 subpixel grid.
+  static int32_t SnapToSubpixel(float value);
+
+ private:
+  struct Command {
+    // Bounding box in whole pixels, inclusive.
+    int32_t min_x, min_y, max_x, max_y;
+
+    bool is_clear;
+    uint32_t clear_color;
+
+    // Triangle vertices in 12.4 fixed point, wound such that the edge functions are positive inside.
+    int32_t x[3], y[3];
+    int64_t area;
+    float color[3][4];
+    FragmentState fragment_state;
+  };
+
+  void RasterizeTile(uint32_t tile_index);
+  void ShadeTriangle(const Command &command, int32_t left, int32_t top, int32_t right, int32_t bottom);
+  void WorkerMain();
+
+ private:
+  uint32_t width_;
+  uint32_t height_;
+  uint32_t tile_size_;
+  uint32_t tiles_x_;
+  uint32_t tiles_y_;
+
+  std::vector<uint32_t> pixels_;
+  FragmentState fragment_state_;
+  std::vector<Command> commands_;
+  std::vector<std::vector<uint32_t>> tile_bins_;
+
+  // Worker pool state. Each Flush increments `generation_` to release the workers, which then claim tiles from
+  // `next_tile_` until none remain.
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_done_;
+  uint64_t generation_{0};
+  uint32_t active_workers_{0};
+  bool shutdown_{false};
+  std::atomic<uint32_t> next_tile_{0};
+};
+
+#endif  // NXDK_PGRAPH_TESTS_SOFTWARE_RASTERIZER_H
@@ -0,0 +1,700 @@
+#include "vertex_shader_interpreter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//! Number of vertices executed together. Sized so that the register file of a batch fits in L1.
+static constexpr uint32_t kBatchSize = 32;
+
+//! Inputs with fewer vertices than this are executed on the calling thread, as spawning workers would dominate.
+static constexpr uint32_t kMinParallelVertices = 16 * 1024;
+
+//! Number of batches claimed by a worker at a time.
+static constexpr uint32_t kBatchesPerClaim = 16;
+
+static constexpr float kRCCMin = 5.42101e-20f;
+static constexpr float kRCCMax = 1.884467e19f;
+
+//! R12 reads and writes oPos.
+static constexpr uint32_t kPositionAlias = 12;
+
+namespace {
+
+// Microcode fields as (word, bit offset, bit count).
+struct Field {
+  uint32_t word;
+  uint32_t shift;
+  uint32_t bits;
+};
+
+constexpr Field kILU{1, 25, 3};
+constexpr Field kMAC{1, 21, 4};
+constexpr Field kConstant{1, 13, 8};
+constexpr Field kInput{1, 9, 4};
+constexpr Field kANegate{1, 8, 1};
+constexpr Field kASwizzle{1, 0, 8};
+constexpr Field kATemporary{2, 28, 4};
+constexpr Field kAMux{2, 26, 2};
+constexpr Field kBNegate{2, 25, 1};
+constexpr Field kBSwizzle{2, 17, 8};
+constexpr Field kBTemporary{2, 13, 4};
+constexpr Field kBMux{2, 11, 2};
+constexpr Field kCNegate{2, 10, 1};
+constexpr Field kCSwizzle{2, 2, 8};
+constexpr Field kCTemporaryHigh{2, 0, 2};
+constexpr Field kCTemporaryLow{3, 30, 2};
+constexpr Field kCMux{3, 28, 2};
+constexpr Field kMACMask{3, 24, 4};
+constexpr Field kTemporary{3, 20, 4};
+constexpr Field kILUMask{3, 16, 4};
+constexpr Field kOutputMask{3, 12, 4};
+constexpr Field kOutputIsRegister{3, 11, 1};
+constexpr Field kOutputAddress{3, 3, 8};
+constexpr Field kOutputFromILU{3, 2, 1};
+constexpr Field kRelativeConstant{3, 1, 1};
+constexpr Field kFinal{3, 0, 1};
+
+uint32_t Get(const uint32_t *instruction, const Field &field) {
+  return (instruction[field.word] >> field.shift) & ((1U << field.bits) - 1);
+}
+
+//! Converts a microcode write mask (x in the most significant bit) to one indexed by component.
+uint8_t ComponentMask(uint32_t mask) {
+  return static_cast<uint8_t>(((mask >> 3) & 1) | ((mask >> 1) & 2) | ((mask << 1) & 4) | ((mask << 3) & 8));
+}
+
+struct alignas(16) Plane {
+  float v[kBatchSize];
+};
+
+using Vector = Plane[4];
+
+struct State {
+  Vector inputs[VertexShaderInterpreter::kNumInputs];
+  Vector temporaries[VertexShaderInterpreter::kNumTemporaries];
+  Vector outputs[VertexShaderInterpreter::kNumOutputs];
+  int32_t a0[kBatchSize];
+};
+
+void Fill(Plane &out, float value) { std::fill(std::begin(out.v), std::end(out.v), value); }
+
+template <bool kVectorized>
+void Negate(const Plane &in, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128 sign = _mm_set1_ps(-0.f);
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      _mm_store_ps(out.v + i, _mm_xor_ps(_mm_load_ps(in.v + i), sign));
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    out.v[i] = -in.v[i];
+  }
+}
+
+#ifdef __SSE2__
+//! Multiplies such that 0 times anything, including infinity and NaN, is 0.
+inline __m128 Multiply(__m128 a, __m128 b) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 nonzero = _mm_and_ps(_mm_cmpneq_ps(a, zero), _mm_cmpneq_ps(b, zero));
+  return _mm_and_ps(nonzero, _mm_mul_ps(a, b));
+}
+#endif
+
+inline float Multiply(float a, float b) { return (a != 0.f && b != 0.f) ? a * b : 0.f; }
+
+//! Computes a * b + c, where c may be null.
+template <bool kVectorized>
+void MultiplyAdd(const Plane &a, const Plane &b, const Plane *c, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      __m128 value = Multiply(_mm_load_ps(a.v + i), _mm_load_ps(b.v + i));
+      if (c) {
+        value = _mm_add_ps(value, _mm_load_ps(c->v + i));
+      }
+      _mm_store_ps(out.v + i, value);
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    out.v[i] = c ? Multiply(a.v[i], b.v[i]) + c->v[i] : Multiply(a.v[i], b.v[i]);
+  }
+}
+
+template <bool kVectorized>
+void Add(const Plane &a, const Plane &b, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      _mm_store_ps(out.v + i, _mm_add_ps(_mm_load_ps(a.v + i), _mm_load_ps(b.v + i)));
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    out.v[i] = a.v[i] + b.v[i];
+  }
+}
+
+enum class Compare {
+  MIN,
+  MAX,
+  LESS,
+  GREATER_EQUAL,
+};
+
+template <bool kVectorized>
+void Select(Compare compare, const Plane &a, const Plane &b, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128 one = _mm_set1_ps(1.f);
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      const __m128 a_value = _mm_load_ps(a.v + i);
+      const __m128 b_value = _mm_load_ps(b.v + i);
+      __m128 value = a_value;
+      switch (compare) {
+        case Compare::MIN:
+          value = _mm_min_ps(a_value, b_value);
+          break;
+        case Compare::MAX:
+          value = _mm_max_ps(a_value, b_value);
+          break;
+        case Compare::LESS:
+          value = _mm_and_ps(_mm_cmplt_ps(a_value, b_value), one);
+          break;
+        case Compare::GREATER_EQUAL:
+          value = _mm_and_ps(_mm_cmpge_ps(a_value, b_value), one);
+          break;
+      }
+      _mm_store_ps(out.v + i, value);
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    const float a_value = a.v[i];
+    const float b_value = b.v[i];
+    switch (compare) {
+      case Compare::MIN:
+        out.v[i] = a_value < b_value ? a_value : b_value;
+        break;
+      case Compare::MAX:
+        out.v[i] = a_value > b_value ? a_value : b_value;
+        break;
+      case Compare::LESS:
+        out.v[i] = a_value < b_value ? 1.f : 0.f;
+        break;
+      case Compare::GREATER_EQUAL:
+        out.v[i] = a_value >= b_value ? 1.f : 0.f;
+        break;
+    }
+  }
+}
+
+//! Computes 1 / x, or 1 / sqrt(|x|) if `square_root` is set.
+template <bool kVectorized>
+void Reciprocal(const Plane &in, bool square_root, Plane &out) {
+#ifdef __SSE2__
+  if constexpr (kVectorized) {
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    for (uint32_t i = 0; i < kBatchSize; i += 4) {
+      __m128 value = _mm_load_ps(in.v + i);
+      if (square_root) {
+        value = _mm_sqrt_ps(_mm_and_ps(value, abs_mask));
+      }
+      _mm_store_ps(out.v + i, _mm_div_ps(one, value));
+    }
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    out.v[i] = 1.f / (square_root ? std::sqrt(std::fabs(in.v[i])) : in.v[i]);
+  }
+}
+
+//! Evaluates the ILU operations that have no vectorized form, one vertex at a time.
+void EvaluateILUScalar(VertexShaderInterpreter::ILUOp op, const Plane *const *source, Vector &out) {
+  for (uint32_t i = 0; i < kBatchSize; ++i) {
+    const float x = source[0]->v[i];
+    float result[4];
+    switch (op) {
+      case VertexShaderInterpreter::ILU_RCC: {
+        const float magnitude = std::min(std::max(std::fabs(1.f / x), kRCCMin), kRCCMax);
+        const float value = std::isnan(x) ? x : magnitude;
+        std::fill(std::begin(result), std::end(result), std::copysign(value, x));
+      } break;
+
+      case VertexShaderInterpreter::ILU_EXP: {
+        const float floor = std::floor(x);
+        result[0] = std::exp2(floor);
+        result[1] = x - floor;
+        result[2] = std::exp2(x);
+        result[3] = 1.f;
+      } break;
+
+      case VertexShaderInterpreter::ILU_LOG: {
+        const float magnitude = std::fabs(x);
+        if (magnitude == 0.f) {
+          result[0] = -INFINITY;
+          result[1] = 1.f;
+          result[2] = -INFINITY;
+        } else if (std::isinf(magnitude)) {
+          result[0] = INFINITY;
+          result[1] = 1.f;
+          result[2] = INFINITY;
+        } else {
+          int exponent;
+          const float mantissa = std::frexp(magnitude, &exponent);
+          // frexp produces a mantissa in [0.5, 1), the hardware uses [1, 2).
+          result[0] = static_cast<float>(exponent - 1);
+          result[1] = mantissa * 2.f;
+          result[2] = std::log2(magnitude);
+        }
+        result[3] = 1.f;
+      } break;
+
+      case VertexShaderInterpreter::ILU_LIT: {
+        const float diffuse = source[0]->v[i];
+        const float specular = source[1]->v[i];
+        const float power = std::min(std::max(source[3]->v[i], -127.9961f), 127.9961f);
+        result[0] = 1.f;
+        result[1] = std::max(diffuse, 0.f);
+        result[2] = (diffuse > 0.f && specular > 0.f) ? std::pow(specular, power) : 0.f;
+        result[3] = 1.f;
+      } break;
+
+      default:
+        std::fill(std::begin(result), std::end(result), 0.f);
+        break;
+    }
+
+    for (uint32_t component = 0; component < 4; ++component) {
+      out[component].v[i] = result[component];
+    }
+  }
+}
+
+//! Returns whether the MAC operation reads the B and C operands.
+bool MACReadsB(VertexShaderInterpreter::MACOp op) {
+  return op != VertexShaderInterpreter::MAC_NOP && op != VertexShaderInterpreter::MAC_MOV &&
+         op != VertexShaderInterpreter::MAC_ADD && op != VertexShaderInterpreter::MAC_ARL;
+}
+
+bool MACReadsC(VertexShaderInterpreter::MACOp op) {
+  return op == VertexShaderInterpreter::MAC_ADD || op == VertexShaderInterpreter::MAC_MAD;
+}
+
+}  // namespace
+
+bool VertexShaderInterpreter::Load(const uint32_t *microcode, uint32_t num_words, std::string &error) {
+  program_.clear();
+  used_inputs_ = 0;
+  used_temporaries_ = 0;
+  written_outputs_ = 0;
+
+  if (num_words % 4) {
+    error = "Microcode size must be a multiple of 4 words";
+    return false;
+  }
+
+  for (uint32_t offset = 0; offset < num_words; offset += 4) {
+    const uint32_t *words = microcode + offset;
+    const uint32_t index = offset / 4;
+    if (index >= kMaxInstructions) {
+      error = "Program exceeds " + std::to_string(kMaxInstructions) + " instructions";
+      return false;
+    }
+
+    Instruction instruction;
+    instruction.ilu = static_cast<ILUOp>(Get(words, kILU));
+    const uint32_t mac = Get(words, kMAC);
+    if (mac > MAC_ARL) {
+      error = "Instruction " + std::to_string(index) + " has unknown MAC opcode " + std::to_string(mac);
+      return false;
+    }
+    instruction.mac = static_cast<MACOp>(mac);
+    instruction.constant = Get(words, kConstant);
+    instruction.input = Get(words, kInput);
+    instruction.relative_constant = Get(words, kRelativeConstant);
+
+    auto decode_operand = [&](Operand &operand, uint32_t mux, uint32_t temporary, uint32_t swizzle, uint32_t negate,
+                              const char *name) {
+      if (mux == 0 || (mux == SOURCE_TEMPORARY && temporary > kPositionAlias)) {
+        error = "Instruction " + std::to_string(index) + " has invalid operand " + name;
+        return false;
+      }
+      operand.source = static_cast<OperandSource>(mux);
+      operand.temporary = static_cast<uint8_t>(temporary);
+      for (uint32_t component = 0; component < 4; ++component) {
+        operand.swizzle[component] = static_cast<uint8_t>((swizzle >> (6 - component * 2)) & 3);
+      }
+      operand.negate = negate;
+      if (operand.source == SOURCE_INPUT) {
+        used_inputs_ |= 1 << instruction.input;
+      } else if (operand.source == SOURCE_TEMPORARY) {
+        used_temporaries_ |= 1 << operand.temporary;
+      }
+      return true;
+    };
+
+    // Operands are only decoded if read, as the fields of unused operands are arbitrary.
+    const bool reads_a = instruction.mac != MAC_NOP;
+    const bool reads_b = MACReadsB(instruction.mac);
+    const bool reads_c = MACReadsC(instruction.mac) || instruction.ilu != ILU_NOP;
+    if (reads_a && !decode_operand(instruction.a, Get(words, kAMux), Get(words, kATemporary), Get(words, kASwizzle),
+                                   Get(words, kANegate), "A")) {
+      return false;
+    }
+    if (reads_b && !decode_operand(instruction.b, Get(words, kBMux), Get(words, kBTemporary), Get(words, kBSwizzle),
+                                   Get(words, kBNegate), "B")) {
+      return false;
+    }
+    const uint32_t c_temporary = (Get(words, kCTemporaryHigh) << 2) | Get(words, kCTemporaryLow);
+    if (reads_c &&
+        !decode_operand(instruction.c, Get(words, kCMux), c_temporary, Get(words, kCSwizzle), Get(words, kCNegate),
+                        "C")) {
+      return false;
+    }
+
+    instruction.mac_mask = instruction.mac == MAC_NOP ? 0 : ComponentMask(Get(words, kMACMask));
+    instruction.ilu_mask = instruction.ilu == ILU_NOP ? 0 : ComponentMask(Get(words, kILUMask));
+    instruction.temporary = static_cast<uint8_t>(Get(words, kTemporary));
+    if ((instruction.mac_mask || instruction.ilu_mask) && instruction.temporary > kPositionAlias) {
+      error = "Instruction " + std::to_string(index) + " writes invalid temporary " +
+              std::to_string(instruction.temporary);
+      return false;
+    }
+
+    instruction.output = Get(words, kOutputAddress);
+    instruction.output_from_ilu = Get(words, kOutputFromILU);
+    // Neither an idle unit nor ARL produces a value that can be written to an output.
+    const bool has_result = instruction.output_from_ilu ? instruction.ilu != ILU_NOP
+                                                        : instruction.mac != MAC_NOP && instruction.mac != MAC_ARL;
+    instruction.output_mask = has_result ? ComponentMask(Get(words, kOutputMask)) : 0;
+    if (instruction.output_mask) {
+      if (!Get(words, kOutputIsRegister)) {
+        error = "Instruction " + std::to_string(index) + " writes to a constant register, which is not supported";
+        return false;
+      }
+      if (instruction.output >= kNumOutputs) {
+        error = "Instruction " + std::to_string(index) + " writes invalid output " + std::to_string(instruction.output);
+        return false;
+      }
+    }
+
+    if (instruction.mac_mask) {
+      used_temporaries_ |= 1 << instruction.temporary;
+    }
+    if (instruction.ilu_mask) {
+      used_temporaries_ |= 1 << (instruction.mac != MAC_NOP ? 1 : instruction.temporary);
+    }
+    if (instruction.output_mask) {
+      written_outputs_ |= 1 << instruction.output;
+    }
+
+    program_.push_back(instruction);
+    if (Get(words, kFinal)) {
+      break;
+    }
+  }
+
+  if (used_temporaries_ & (1 << kPositionAlias)) {
+    written_outputs_ |= 1 << OUT_POS;
+  }
+  return true;
+}
+
+void VertexShaderInterpreter::SetConstant(uint32_t index, float x, float y, float z, float w) {
+  constants_[index][0] = x;
+  constants_[index][1] = y;
+  constants_[index][2] = z;
+  constants_[index][3] = w;
+}
+
+template <bool kVectorized>
+void VertexShaderInterpreter::ExecuteRange(const InputVertex *inputs, OutputVertex *outputs, uint32_t count) const {
+  State state;
+
+  for (uint32_t offset = 0; offset < count; offset += kBatchSize) {
+    const uint32_t batch_count = std::min(kBatchSize, count - offset);
+
+    for (uint32_t reg = 0; reg < kNumInputs; ++reg) {
+      if (!(used_inputs_ & (1 << reg))) {
+        continue;
+      }
+      for (uint32_t component = 0; component < 4; ++component) {
+        auto &plane = state.inputs[reg][component];
+        for (uint32_t i = 0; i < batch_count; ++i) {
+          plane.v[i] = inputs[offset + i].v[reg][component];
+        }
+        std::fill(plane.v + batch_count, std::end(plane.v), 0.f);
+      }
+    }
+    // Registers that are never touched by the program are left uninitialized.
+    for (uint32_t reg = 0; reg < kNumTemporaries; ++reg) {
+      if (used_temporaries_ & (1 << reg)) {
+        memset(state.temporaries[reg], 0, sizeof(state.temporaries[reg]));
+      }
+    }
+    for (uint32_t reg = 0; reg < kNumOutputs; ++reg) {
+      if (written_outputs_ & (1 << reg)) {
+        memset(state.outputs[reg], 0, sizeof(state.outputs[reg]));
+      }
+    }
+    std::fill(std::begin(state.a0), std::end(state.a0), 0);
+
+    auto temporary = [&state](uint32_t index) -> Vector & {
+      return index == kPositionAlias ? state.outputs[OUT_POS] : state.temporaries[index];
+    };
+
+    // Resolves the planes read by an operand after swizzling and negation. Values that are not held in a register are
+    // built in `scratch`.
+    auto fetch = [&](const Instruction &instruction, const Operand &operand, Vector &scratch,
+                     const Plane *(&out)[4]) {
+      switch (operand.source) {
+        case SOURCE_TEMPORARY:
+        case SOURCE_INPUT: {
+          const Vector &reg =
+              operand.source == SOURCE_INPUT ? state.inputs[instruction.input] : temporary(operand.temporary);
+          for (uint32_t component = 0; component < 4; ++component) {
+            out[component] = &reg[operand.swizzle[component]];
+          }
+        } break;
+
+        case SOURCE_CONSTANT:
+          for (uint32_t component = 0; component < 4; ++component) {
+            const uint32_t swizzled = operand.swizzle[component];
+            if (instruction.relative_constant) {
+              for (uint32_t i = 0; i < kBatchSize; ++i) {
+                const int32_t index = static_cast<int32_t>(instruction.constant) + state.a0[i];
+                const bool valid = index >= 0 && index < static_cast<int32_t>(kNumConstants);
+                scratch[component].v[i] = valid ? constants_[index][swizzled] : 0.f;
+              }
+            } else {
+              Fill(scratch[component], constants_[instruction.constant][swizzled]);
+            }
+            out[component] = &scratch[component];
+          }
+          break;
+      }
+
+      if (operand.negate) {
+        for (uint32_t component = 0; component < 4; ++component) {
+          Negate<kVectorized>(*out[component], scratch[component]);
+          out[component] = &scratch[component];
+        }
+      }
+    };
+
+    for (const auto &instruction : program_) {
+      const Plane *a[4];
+      const Plane *b[4];
+      const Plane *c[4];
+      Vector a_scratch, b_scratch, c_scratch;
+
+      // Both units read the registers before either writes its result.
+      Vector mac;
+      if (instruction.mac != MAC_NOP) {
+        fetch(instruction, instruction.a, a_scratch, a);
+        if (MACReadsB(instruction.mac)) {
+          fetch(instruction, instruction.b, b_scratch, b);
+        }
+        if (MACReadsC(instruction.mac)) {
+          fetch(instruction, instruction.c, c_scratch, c);
+        }
+
+        switch (instruction.mac) {
+          case MAC_MOV:
+          case MAC_ARL:
+            for (uint32_t component = 0; component < 4; ++component) {
+              mac[component] = *a[component];
+            }
+            break;
+          case MAC_MUL:
+            for (uint32_t component = 0; component < 4; ++component) {
+              MultiplyAdd<kVectorized>(*a[component], *b[component], nullptr, mac[component]);
+            }
+            break;
+          case MAC_ADD:
+            for (uint32_t component = 0; component < 4; ++component) {
+              Add<kVectorized>(*a[component], *c[component], mac[component]);
+            }
+            break;
+          case MAC_MAD:
+            for (uint32_t component = 0; component < 4; ++component) {
+              MultiplyAdd<kVectorized>(*a[component], *b[component], c[component], mac[component]);
+            }
+            break;
+          case MAC_DP3:
+          case MAC_DPH:
+          case MAC_DP4: {
+            Plane &sum = mac[0];
+            MultiplyAdd<kVectorized>(*a[0], *b[0], nullptr, sum);
+            MultiplyAdd<kVectorized>(*a[1], *b[1], &sum, sum);
+            MultiplyAdd<kVectorized>(*a[2], *b[2], &sum, sum);
+            if (instruction.mac == MAC_DP4) {
+              MultiplyAdd<kVectorized>(*a[3], *b[3], &sum, sum);
+            } else if (instruction.mac == MAC_DPH) {
+              Add<kVectorized>(sum, *b[3], sum);
+            }
+            mac[1] = sum;
+            mac[2] = sum;
+            mac[3] = sum;
+          } break;
+          case MAC_DST:
+            Fill(mac[0], 1.f);
+            MultiplyAdd<kVectorized>(*a[1], *b[1], nullptr, mac[1]);
+            mac[2] = *a[2];
+            mac[3] = *b[3];
+            break;
+          case MAC_MIN:
+          case MAC_MAX:
+          case MAC_SLT:
+          case MAC_SGE: {
+            static constexpr Compare kCompare[] = {Compare::MIN, Compare::MAX, Compare::LESS, Compare::GREATER_EQUAL};
+            const Compare compare = kCompare[instruction.mac - MAC_MIN];
+            for (uint32_t component = 0; component < 4; ++component) {
+              Select<kVectorized>(compare, *a[component], *b[component], mac[component]);
+            }
+          } break;
+          case MAC_NOP:
+            break;
+        }
+      }
+
+      // The ILU operates on the first component of the swizzled C operand, other than LIT which uses x, y and w.
+      Vector ilu;
+      if (instruction.ilu != ILU_NOP) {
+        if (!MACReadsC(instruction.mac)) {
+          fetch(instruction, instruction.c, c_scratch, c);
+        }
+        switch (instruction.ilu) {
+          case ILU_MOV:
+            for (auto &plane : ilu) {
+              plane = *c[0];
+            }
+            break;
+          case ILU_RCP:
+          case ILU_RSQ:
+            Reciprocal<kVectorized>(*c[0], instruction.ilu == ILU_RSQ, ilu[0]);
+            ilu[1] = ilu[0];
+            ilu[2] = ilu[0];
+            ilu[3] = ilu[0];
+            break;
+          default:
+            EvaluateILUScalar(instruction.ilu, c, ilu);
+            break;
+        }
+      }
+
+      auto write = [](Vector &dst, uint8_t mask, const Vector &value) {
+        for (uint32_t component = 0; component < 4; ++component) {
+          if (mask & (1 << component)) {
+            dst[component] = value[component];
+          }
+        }
+      };
+
+      if (instruction.mac == MAC_ARL) {
+        for (uint32_t i = 0; i < kBatchSize; ++i) {
+          const float value = std::floor(mac[0].v[i]);
+          state.a0[i] = std::isfinite(value) ? static_cast<int32_t>(std::min(std::max(value, -1024.f), 1024.f)) : 0;
+        }
+      } else if (instruction.mac_mask) {
+        write(temporary(instruction.temporary), instruction.mac_mask, mac);
+      }
+      if (instruction.ilu_mask) {
+        // When paired with a MAC operation the ILU result goes to R1.
+        write(temporary(instruction.mac != MAC_NOP ? 1 : instruction.temporary), instruction.ilu_mask, ilu);
+      }
+      if (instruction.output_mask) {
+        write(state.outputs[instruction.output], instruction.output_mask, instruction.output_from_ilu ? ilu : mac);
+      }
+    }
+
+    for (uint32_t i = 0; i < batch_count; ++i) {
+      auto &output = outputs[offset + i];
+      memset(&output, 0, sizeof(output));
+      for (uint32_t reg = 0; reg < kNumOutputs; ++reg) {
+        if (!(written_outputs_ & (1 << reg))) {
+          continue;
+        }
+        for (uint32_t component = 0; component < 4; ++component) {
+          output.o[reg][component] = state.outputs[reg][component].v[i];
+        }
+      }
+    }
+  }
+}
+
+void VertexShaderInterpreter::Execute(const std::vector<InputVertex> &inputs, std::vector<OutputVertex> &outputs,
+                                      uint32_t num_threads) const {
+#ifdef __SSE2__
+  static constexpr bool kVectorized = true;
+#else
+  static constexpr bool kVectorized = false;
+#endif
+
+  const auto num_vertices = static_cast<uint32_t>(inputs.size());
+  outputs.resize(num_vertices);
+
+  static constexpr uint32_t kClaimSize = kBatchSize * kBatchesPerClaim;
+  const uint32_t num_claims = (num_vertices + kClaimSize - 1) / kClaimSize;
+
+  if (!num_threads) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  if (num_vertices < kMinParallelVertices) {
+    num_threads = 1;
+  }
+  num_threads = std::max(1U, std::min(num_threads, num_claims));
+
+  std::atomic<uint32_t> next_claim{0};
+  auto worker = [&]() {
+    for (uint32_t claim = next_claim++; claim < num_claims; claim = next_claim++) {
+      const uint32_t begin = claim * kClaimSize;
+      ExecuteRange<kVectorized>(inputs.data() + begin, outputs.data() + begin,
+                                std::min(kClaimSize, num_vertices - begin));
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+void VertexShaderInterpreter::ExecuteScalar(const std::vector<InputVertex> &inputs,
+                                            std::vector<OutputVertex> &outputs) const {
+  outputs.resize(inputs.size());
+  ExecuteRange<false>(inputs.data(), outputs.data(), static_cast<uint32_t>(inputs.size()));
+}
+
+const char *VertexShaderInterpreter::KernelName() {
+#ifdef __SSE2__
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
@@ -0,0 +1,157 @@
+#ifndef NXDK_PGRAPH_TESTS_VERTEX_SHADER_INTERPRETER_H
+#define NXDK_PGRAPH_TESTS_VERTEX_SHADER_INTERPRETER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Host side interpreter for assembled NV2A vertex shader microcode (the 4 word per instruction arrays produced from
+ * the .vsh sources and the kShader[] tables in the tests).
+ *
+ * Vertices are executed in batches, with every register held in structure-of-arrays form so that each instruction is
+ * applied to a whole batch at once. The MAC and ILU halves of an instruction both read the register state from before
+ * the instruction and the ILU writes to R1 when paired with a MAC operation. R12 is an alias for oPos.
+ *
+ * Exceptional values follow the hardware's D3D style rules: multiplication (including within MAD, DP3, DP4, DPH and
+ * DST) yields 0 if either operand is 0, even if the other is infinite or NaN. RCP and RSQ of 0 produce infinity and of
+ * infinity produce 0. RCC clamps the magnitude of the reciprocal to [5.42101e-20, 1.884467e19], preserving the sign of
+ * the input. MIN, MAX, SLT and SGE are defined by ordered comparisons, so a NaN in A selects B (MIN, MAX) or 0 (SLT,
+ * SGE).
+ */
+class VertexShaderInterpreter {
+ public:
+  static constexpr uint32_t kMaxInstructions = 136;
+  static constexpr uint32_t kNumConstants = 192;
+  //! The assembler numbers constants relative to this index, e.g., c0 is stored at 96.
+  static constexpr uint32_t kConstantBias = 96;
+  static constexpr uint32_t kNumInputs = 16;
+  static constexpr uint32_t kNumTemporaries = 12;
+  static constexpr uint32_t kNumOutputs = 13;
+
+  enum OutputRegister {
+    OUT_POS = 0,
+    OUT_DIFFUSE = 3,
+    OUT_SPECULAR = 4,
+    OUT_FOG = 5,
+    OUT_POINT_SIZE = 6,
+    OUT_BACK_DIFFUSE = 7,
+    OUT_BACK_SPECULAR = 8,
+    OUT_TEX0 = 9,
+    OUT_TEX1 = 10,
+    OUT_TEX2 = 11,
+    OUT_TEX3 = 12,
+  };
+
+  enum ILUOp {
+    ILU_NOP = 0,
+    ILU_MOV,
+    ILU_RCP,
+    ILU_RCC,
+    ILU_RSQ,
+    ILU_EXP,
+    ILU_LOG,
+    ILU_LIT,
+  };
+
+  enum MACOp {
+    MAC_NOP = 0,
+    MAC_MOV,
+    MAC_MUL,
+    MAC_ADD,
+    MAC_MAD,
+    MAC_DP3,
+    MAC_DPH,
+    MAC_DP4,
+    MAC_DST,
+    MAC_MIN,
+    MAC_MAX,
+    MAC_SLT,
+    MAC_SGE,
+    MAC_ARL,
+  };
+
+  struct InputVertex {
+    float v[kNumInputs][4];
+  };
+
+  struct OutputVertex {
+    //! Output registers indexed by OutputRegister. Registers that are not written by the program are zero.
+    float o[kNumOutputs][4];
+  };
+
+ public:
+  /**
+   * Decodes a program. Execution ends at the first instruction with the final flag set.
+   *
+   * Programs that write to constant registers are rejected, as are unknown opcodes.
+   */
+  bool Load(const uint32_t *microcode, uint32_t num_words, std::string &error);
+
+  [[nodiscard]] uint32_t num_instructions() const { return static_cast<uint32_t>(program_.size()); }
+
+  //! Sets constant register `index` (in the hardware numbering, see kConstantBias).
+  void SetConstant(uint32_t index, float x, float y, float z, float w);
+
+  /**
+   * Runs the program for every input vertex.
+   *
+   * Batches are split across `num_threads` threads (0 selects std::thread::hardware_concurrency). Small inputs are
+   * always executed on the calling thread.
+   */
+  void Execute(const std::vector<InputVertex> &inputs, std::vector<OutputVertex> &outputs,
+               uint32_t num_threads = 0) const;
+
+  //! Portable implementation of Execute, retained to validate the vectorized version.
+  void ExecuteScalar(const std::vector<InputVertex> &inputs, std::vector<OutputVertex> &outputs) const;
+
+  //! Returns the name of the kernel set used by Execute.
+  static const char *KernelName();
+
+ private:
+  enum OperandSource : uint8_t {
+    SOURCE_TEMPORARY = 1,
+    SOURCE_INPUT = 2,
+    SOURCE_CONSTANT = 3,
+  };
+
+  struct Operand {
+    OperandSource source{SOURCE_TEMPORARY};
+    uint8_t temporary{0};
+    uint8_t swizzle[4]{0, 1, 2, 3};
+    bool negate{false};
+  };
+
+  struct Instruction {
+    ILUOp ilu{ILU_NOP};
+    MACOp mac{MAC_NOP};
+    uint32_t constant{0};
+    uint32_t input{0};
+    //! Offsets `constant` by A0.x.
+    bool relative_constant{false};
+    Operand a;
+    Operand b;
+    Operand c;
+
+    uint8_t mac_mask{0};
+    uint8_t ilu_mask{0};
+    uint8_t temporary{0};
+    uint8_t output_mask{0};
+    uint32_t output{0};
+    bool output_from_ilu{false};
+  };
+
+  template <bool kVectorized>
+  void ExecuteRange(const InputVertex *inputs, OutputVertex *outputs, uint32_t count) const;
+
+  std::vector<Instruction> program_;
+  //! Bitmask of the input registers read by the program.
+  uint32_t used_inputs_{0};
+  //! Bitmask of the temporary registers read or written by the program.
+  uint32_t used_temporaries_{0};
+  //! Bitmask of the output registers written by the program, including oPos if R12 is written.
+  uint32_t written_outputs_{0};
+  float constants_[kNumConstants][4]{};
+};
+
+#endif  // NXDK_PGRAPH_TESTS_VERTEX_SHADER_INTERPRETER_H
@@ -1,4 +1,18 @@
 #ifndef NXDK_PGRAPH_TESTS_TESTS_HOST_STUBS_NXDK_EXT_H_
 #define NXDK_PGRAPH_TESTS_TESTS_HOST_STUBS_NXDK_EXT_H_
 
+#define NV2A_VERTEX_ATTR_POSITION 0
+#define NV2A_VERTEX_ATTR_WEIGHT 1
+#define NV2A_VERTEX_ATTR_NORMAL 2
+#define NV2A_VERTEX_ATTR_DIFFUSE 3
+#define NV2A_VERTEX_ATTR_SPECULAR 4
+#define NV2A_VERTEX_ATTR_FOG_COORD 5
+#define NV2A_VERTEX_ATTR_POINT_SIZE 6
+#define NV2A_VERTEX_ATTR_BACK_DIFFUSE 7
+#define NV2A_VERTEX_ATTR_BACK_SPECULAR 8
+#define NV2A_VERTEX_ATTR_TEXTURE0 9
+#define NV2A_VERTEX_ATTR_TEXTURE1 10
+#define NV2A_VERTEX_ATTR_TEXTURE2 11
+#define NV2A_VERTEX_ATTR_TEXTURE3 12
+
 #endif  // NXDK_PGRAPH_TESTS_TESTS_HOST_STUBS_NXDK_EXT_H_
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include "allocation_tracker.h"
+
+using Kind = AllocationTracker::Kind;
+
+TEST(AllocationTrackerTest, TracksLiveAndPeakBytes) {
+  AllocationTracker tracker;
+
+  tracker.RecordAllocation(Kind::CONTIGUOUS, 0x1000);
+  tracker.RecordAllocation(Kind::CONTIGUOUS, 0x2000);
+  tracker.RecordRelease(Kind::CONTIGUOUS, 0x2000);
+  tracker.RecordAllocation(Kind::HEAP, 16);
+
+  EXPECT_EQ(tracker.GetLiveBytes(Kind::CONTIGUOUS), 0x1000);
+  EXPECT_EQ(tracker.GetPeakBytes(Kind::CONTIGUOUS), 0x3000);
+  EXPECT_EQ(tracker.GetLiveBytes(Kind::HEAP), 16);
+}
+
+TEST(AllocationTrackerTest, OverReleaseDoesNotUnderflow) {
+  AllocationTracker tracker;
+
+  tracker.RecordAllocation(Kind::HEAP, 8);
+  tracker.RecordRelease(Kind::HEAP, 32);
+  EXPECT_EQ(tracker.GetLiveBytes(Kind::HEAP), 0);
+}
+
+TEST(AllocationTrackerTest, SuiteScopeReportsBalancedUsage) {
+  AllocationTracker tracker;
+  tracker.RecordAllocation(Kind::CONTIGUOUS, 0x100);
+
+  tracker.BeginSuite();
+  tracker.RecordAllocation(Kind::CONTIGUOUS, 0x4000);
+  tracker.RecordAllocation(Kind::HEAP, 64);
+  tracker.RecordRelease(Kind::HEAP, 64);
+  tracker.RecordRelease(Kind::CONTIGUOUS, 0x4000);
+  auto report = tracker.EndSuite();
+
+  // Memory allocated before the suite began is not attributed to it.
+  EXPECT_FALSE(report.HasOutstanding());
+  EXPECT_EQ(report.Get(Kind::CONTIGUOUS).live_bytes, 0);
+  EXPECT_EQ(report.Get(Kind::CONTIGUOUS).peak_bytes, 0x4000);
+  EXPECT_EQ(report.Get(Kind::CONTIGUOUS).num_allocations, 1);
+  EXPECT_EQ(report.Get(Kind::HEAP).peak_bytes, 64);
+  EXPECT_EQ(report.Get(Kind::HEAP).num_allocations, 1);
+}
+
+TEST(AllocationTrackerTest, SuiteScopeDetectsLeak) {
+  AllocationTracker tracker;
+
+  tracker.BeginSuite();
+  tracker.RecordAllocation(Kind::HEAP, 128);
+  auto report = tracker.EndSuite();
+
+  EXPECT_TRUE(report.HasOutstanding());
+  EXPECT_EQ(report.Get(Kind::HEAP).live_bytes, 128);
+  EXPECT_EQ(report.Describe(), "contiguous live 0 peak 0 allocs 0, heap live 128 peak 128 allocs 1");
+}
+
+TEST(AllocationTrackerTest, TestScopeNestsWithinSuite) {
+  AllocationTracker tracker;
+
+  tracker.BeginSuite();
+  tracker.RecordAllocation(Kind::CONTIGUOUS, 0x1000);
+
+  tracker.BeginTest();
+  tracker.RecordAllocation(Kind::CONTIGUOUS, 0x800);
+  tracker.RecordRelease(Kind::CONTIGUOUS, 0x800);
+  auto test_report = tracker.EndTest();
+  EXPECT_FALSE(test_report.HasOutstanding());
+  EXPECT_EQ(test_report.Get(Kind::CONTIGUOUS).peak_bytes, 0x800);
+  EXPECT_EQ(test_report.Get(Kind::CONTIGUOUS).num_allocations, 1);
+
+  // A test that releases suite memory reports a negative balance rather than a leak.
+  tracker.BeginTest();
+  tracker.RecordRelease(Kind::CONTIGUOUS, 0x1000);
+  test_report = tracker.EndTest();
+  EXPECT_FALSE(test_report.HasOutstanding());
+  EXPECT_EQ(test_report.Get(Kind::CONTIGUOUS).live_bytes, -0x1000);
+
+  auto suite_report = tracker.EndSuite();
+  EXPECT_EQ(suite_report.Get(Kind::CONTIGUOUS).peak_bytes, 0x1800);
+  EXPECT_EQ(suite_report.Get(Kind::CONTIGUOUS).num_allocations, 2);
+}
+
+TEST(AllocationTrackerTest, EndWithoutBeginReportsNothing) {
+  AllocationTracker tracker;
+  tracker.RecordAllocation(Kind::HEAP, 32);
+
+  auto report = tracker.EndSuite();
+  EXPECT_FALSE(report.HasOutstanding());
+  EXPECT_EQ(report.Get(Kind::HEAP).num_allocations, 0);
+}
@@ -0,0 +1,284 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "asset_compiler.h"
+#include "compiled_texture.h"
+#include "texture_swizzle.h"
+
+using namespace CompiledTexture;
+
+static AssetCompiler::Image RandomImage(uint32_t width, uint32_t height, uint32_t seed) {
+  std::mt19937 rng(seed);
+  AssetCompiler::Image ret;
+  ret.width = width;
+  ret.height = height;
+  ret.rgba.resize(width * height * 4);
+  for (auto &value : ret.rgba) {
+    value = static_cast<uint8_t>(rng());
+  }
+  return ret;
+}
+
+static AssetCompiler::AssetSpec Spec(const char *spec) {
+  AssetCompiler::AssetSpec ret;
+  std::string error;
+  EXPECT_TRUE(AssetCompiler::ParseSpec(spec, ret, error)) << error;
+  return ret;
+}
+
+static Header ReadHeader(const std::vector<uint8_t> &blob) {
+  Header ret;
+  memcpy(&ret, blob.data(), sizeof(ret));
+  return ret;
+}
+
+//! Builds a DDS file with the given FourCC whose level data is a byte counter.
+static std::vector<uint8_t> MakeDDS(const char *four_cc, uint32_t width, uint32_t height, uint32_t mip_count) {
+  std::vector<uint8_t> ret(128);
+  auto write32 = [&ret](uint32_t offset, uint32_t value) { memcpy(&ret[offset], &value, sizeof(value)); };
+  memcpy(ret.data(), "DDS ", 4);
+  write32(4, 124);
+  write32(12, height);
+  write32(16, width);
+  write32(28, mip_count);
+  memcpy(&ret[84], four_cc, 4);
+
+  uint32_t block_size = strcmp(four_cc, "DXT1") ? 16 : 8;
+  for (uint32_t level = 0; level < mip_count; ++level) {
+    uint32_t size = ((width + 3) / 4) * ((height + 3) / 4) * block_size;
+    for (uint32_t i = 0; i < size; ++i) {
+      ret.push_back(static_cast<uint8_t>(ret.size()));
+    }
+    width = std::max(1U, width >> 1);
+    height = std::max(1U, height >> 1);
+  }
+  return ret;
+}
+
+TEST(AssetCompiler, ParsesSpecs) {
+  auto spec = Spec("pixel_shader\\water_bump_map.png=SZ_R5G6B5,mipmap");
+  EXPECT_EQ(spec.name, "pixel_shader/water_bump_map.png");
+  EXPECT_EQ(spec.format, FORMAT_SZ_R5G6B5);
+  EXPECT_TRUE(spec.mipmap);
+
+  spec = Spec("image_blit/TestImage.png=LU_IMAGE_A8R8G8B8");
+  EXPECT_EQ(spec.format, FORMAT_LU_IMAGE_A8R8G8B8);
+  EXPECT_FALSE(spec.mipmap);
+
+  AssetCompiler::AssetSpec invalid;
+  std::string error;
+  EXPECT_FALSE(AssetCompiler::ParseSpec("image.png", invalid, error));
+  EXPECT_FALSE(AssetCompiler::ParseSpec("image.png=A8R8G8B8", invalid, error));
+  EXPECT_FALSE(AssetCompiler::ParseSpec("image.png=SZ_A8R8G8B8,lod", invalid, error));
+  EXPECT_FALSE(AssetCompiler::ParseSpec(std::string(AssetManifest::kMaxNameLength + 1, 'a') + "=SZ_A8R8G8B8", invalid,
+                                        error));
+}
+
+TEST(AssetCompiler, ConvertsTexels) {
+  const uint8_t rgba[] = {0xF8, 0x84, 0x1F, 0x80};
+  auto convert16 = [&rgba](uint32_t format) {
+    uint8_t out[2];
+    AssetCompiler::ConvertTexel(rgba, format, out);
+    return static_cast<uint32_t>(out[0] | (out[1] << 8));
+  };
+  auto convert32 = [&rgba](uint32_t format) {
+    uint32_t out;
+    AssetCompiler::ConvertTexel(rgba, format, reinterpret_cast<uint8_t *>(&out));
+    return out;
+  };
+
+  EXPECT_EQ(convert32(FORMAT_SZ_A8R8G8B8), 0x80F8841F);
+  EXPECT_EQ(convert32(FORMAT_LU_IMAGE_X8R8G8B8), 0xFFF8841F);
+  EXPECT_EQ(convert16(FORMAT_SZ_R5G6B5), (0x1F << 11) | (0x21 << 5) | 0x03);
+  EXPECT_EQ(convert16(FORMAT_SZ_A1R5G5B5), 0x8000 | (0x1F << 10) | (0x10 << 5) | 0x03);
+  EXPECT_EQ(convert16(FORMAT_SZ_X1R5G5B5), 0x8000 | (0x1F << 10) | (0x10 << 5) | 0x03);
+  EXPECT_EQ(convert16(FORMAT_LU_IMAGE_A4R4G4B4), 0x8F81);
+}
+
+TEST(AssetCompiler, LinearImageMatchesSource) {
+  auto image = RandomImage(20, 6, 1);
+  std::vector<uint8_t> blob;
+  std::string error;
+  ASSERT_TRUE(AssetCompiler::CompileImage(image, Spec("a.png=LU_IMAGE_A8R8G8B8"), blob, error)) << error;
+  ASSERT_TRUE(Validate(blob.data(), blob.size(), error)) << error;
+
+  auto header = ReadHeader(blob);
+  EXPECT_EQ(header.flags, 0);
+  EXPECT_EQ(header.num_levels, 1);
+  EXPECT_EQ(header.pitch, 20 * 4);
+  EXPECT_EQ(header.level_offsets[0] % kAlignment, 0);
+  const uint8_t *texels = blob.data() + header.level_offsets[0];
+  for (uint32_t i = 0; i < 20 * 6; ++i) {
+    const uint8_t *rgba = &image.rgba[i * 4];
+    const uint8_t expected[] = {rgba[2], rgba[1], rgba[0], rgba[3]};
+    ASSERT_EQ(0, memcmp(texels + i * 4, expected, 4)) << "texel " << i;
+  }
+}
+
+TEST(AssetCompiler, SwizzledMipChain) {
+  auto image = RandomImage(64, 16, 2);
+  std::vector<uint8_t> blob;
+  std::string error;
+  ASSERT_TRUE(AssetCompiler::CompileImage(image, Spec("a.png=SZ_R5G6B5,mipmap"), blob, error)) << error;
+  ASSERT_TRUE(Validate(blob.data(), blob.size(), error)) << error;
+
+  auto header = ReadHeader(blob);
+  EXPECT_EQ(header.flags, FLAG_SWIZZLED);
+  ASSERT_EQ(header.num_levels, 7);
+  EXPECT_EQ(header.blob_size, blob.size());
+
+  auto level_image = image;
+  for (uint32_t level = 0; level < header.num_levels; ++level) {
+    EXPECT_EQ(header.level_offsets[level] % kAlignment, 0) << "level " << level;
+    ASSERT_EQ(header.level_sizes[level], level_image.width * level_image.height * 2) << "level " << level;
+
+    std::vector<uint8_t> linear(header.level_sizes[level]);
+    for (uint32_t i = 0; i < level_image.width * level_image.height; ++i) {
+      AssetCompiler::ConvertTexel(&level_image.rgba[i * 4], FORMAT_SZ_R5G6B5, &linear[i * 2]);
+    }
+    std::vector<uint8_t> swizzled(linear.size());
+    TextureSwizzle::SwizzleRect(linear.data(), level_image.width, level_image.height, swizzled.data(),
+                                level_image.width * 2, 2);
+    EXPECT_EQ(0, memcmp(blob.data() + header.level_offsets[level], swizzled.data(), swizzled.size()))
+        << "level " << level;
+
+    level_image = AssetCompiler::Downsample(level_image);
+  }
+}
+
+TEST(AssetCompiler, DownsamplesWithBoxFilter) {
+  AssetCompiler::Image image;
+  image.width = 2;
+  image.height = 1;
+  image.rgba = {10, 20, 30, 255, 13, 40, 0, 0};
+  auto half = AssetCompiler::Downsample(image);
+  ASSERT_EQ(half.width, 1);
+  ASSERT_EQ(half.height, 1);
+  const uint8_t expected[] = {12, 30, 15, 128};
+  EXPECT_EQ(0, memcmp(half.rgba.data(), expected, 4));
+}
+
+TEST(AssetCompiler, RejectsUnsupportedImages) {
+  std::vector<uint8_t> blob;
+  std::string error;
+  EXPECT_FALSE(AssetCompiler::CompileImage(RandomImage(20, 16, 3), Spec("a.png=SZ_A8R8G8B8"), blob, error));
+  EXPECT_FALSE(
+      AssetCompiler::CompileImage(RandomImage(16, 16, 3), Spec("a.png=LU_IMAGE_A8R8G8B8,mipmap"), blob, error));
+  EXPECT_FALSE(AssetCompiler::CompileImage(RandomImage(16, 16, 3), Spec("a.png=L_DXT1_A1R5G5B5"), blob, error));
+}
+
+TEST(AssetCompiler, RepackagesDDSLevels) {
+  auto dds = MakeDDS("DXT5", 64, 8, 7);
+  std::vector<uint8_t> blob;
+  std::string error;
+  ASSERT_TRUE(AssetCompiler::CompileDDS(dds.data(), dds.size(), Spec("a.dds=L_DXT45_A8R8G8B8,mipmap"), blob, error))
+      << error;
+  ASSERT_TRUE(Validate(blob.data(), blob.size(), error)) << error;
+
+  auto header = ReadHeader(blob);
+  EXPECT_EQ(header.flags, FLAG_COMPRESSED);
+  EXPECT_EQ(header.pitch, 16 * 16);
+  ASSERT_EQ(header.num_levels, 7);
+  uint32_t source_offset = 128;
+  for (uint32_t level = 0; level < header.num_levels; ++level) {
+    EXPECT_EQ(0, memcmp(blob.data() + header.level_offsets[level], dds.data() + source_offset,
+                        header.level_sizes[level]))
+        << "level " << level;
+    source_offset += header.level_sizes[level];
+  }
+
+  ASSERT_TRUE(AssetCompiler::CompileDDS(dds.data(), dds.size(), Spec("a.dds=L_DXT45_A8R8G8B8"), blob, error));
+  EXPECT_EQ(ReadHeader(blob).num_levels, 1);
+
+  EXPECT_FALSE(AssetCompiler::CompileDDS(dds.data(), dds.size(), Spec("a.dds=L_DXT1_A1R5G5B5"), blob, error));
+  EXPECT_FALSE(
+      AssetCompiler::CompileDDS(dds.data(), dds.size() - 1, Spec("a.dds=L_DXT45_A8R8G8B8,mipmap"), blob, error));
+}
+
+TEST(AssetCompiler, ValidateRejectsMalformedBlobs) {
+  std::vector<uint8_t> valid;
+  std::string error;
+  ASSERT_TRUE(AssetCompiler::CompileImage(RandomImage(8, 8, 4), Spec("a.png=SZ_A8R8G8B8,mipmap"), valid, error));
+
+  auto mutate = [&valid](const std::function<void(Header &)> &callback) {
+    auto blob = valid;
+    auto header = ReadHeader(blob);
+    callback(header);
+    memcpy(blob.data(), &header, sizeof(header));
+    return blob;
+  };
+
+  const std::vector<uint8_t> cases[] = {
+      mutate([](Header &header) { header.magic = 0; }),
+      mutate([](Header &header) { header.version += 1; }),
+      mutate([](Header &header) { header.blob_size += 1; }),
+      mutate([](Header &header) { header.format = FORMAT_LU_IMAGE_A8R8G8B8; }),
+      mutate([](Header &header) { header.num_levels = kMaxLevels + 1; }),
+      mutate([](Header &header) { header.level_offsets[1] += 4; }),
+      mutate([](Header &header) { header.level_offsets[2] = header.level_offsets[1]; }),
+      mutate([](Header &header) { header.level_sizes[3] *= 2; }),
+  };
+  for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+    EXPECT_FALSE(Validate(cases[i].data(), cases[i].size(), error)) << "case " << i;
+  }
+  EXPECT_FALSE(Validate(valid.data(), sizeof(Header) - 1, error));
+}
+
+TEST(AssetCompiler, ManifestIsSortedAndSearchable) {
+  const char *names[] = {"pixel_shader/water_bump_map.png", "image_blit/TestImage.png", "dxt_images/plasma.dds"};
+  std::vector<AssetManifest::Entry> entries;
+  for (uint32_t i = 0; i < 3; ++i) {
+    AssetManifest::Entry entry{};
+    strcpy(entry.name, names[i]);
+    entry.blob_size = 100 + i;
+    entries.push_back(entry);
+  }
+
+  std::vector<uint8_t> serialized;
+  std::string error;
+  ASSERT_TRUE(AssetManifest::Build(entries, serialized, error)) << error;
+
+  AssetManifest manifest;
+  ASSERT_TRUE(manifest.Parse(serialized.data(), serialized.size(), error)) << error;
+  ASSERT_EQ(manifest.entries().size(), 3);
+  EXPECT_STREQ(manifest.entries()[0].name, "dxt_images/plasma.dds");
+  EXPECT_STREQ(manifest.entries()[2].name, "pixel_shader/water_bump_map.png");
+
+  for (uint32_t i = 0; i < 3; ++i) {
+    auto entry = manifest.Find(names[i]);
+    ASSERT_NE(entry, nullptr) << names[i];
+    EXPECT_EQ(entry->blob_size, 100 + i);
+  }
+  EXPECT_EQ(manifest.Find("image_blit"), nullptr);
+  EXPECT_EQ(manifest.Find("zzz"), nullptr);
+
+  entries.push_back(entries[0]);
+  EXPECT_FALSE(AssetManifest::Build(entries, serialized, error));
+
+  serialized.pop_back();
+  EXPECT_FALSE(manifest.Parse(serialized.data(), serialized.size(), error));
+}
+
+TEST(AssetCompiler, ParallelCompilationIsDeterministic) {
+  std::vector<AssetCompiler::Image> images;
+  for (uint32_t i = 0; i < 24; ++i) {
+    images.push_back(RandomImage(32 << (i % 3), 16 << (i % 2), 100 + i));
+  }
+  auto spec = Spec("a.png=SZ_A4R4G4B4,mipmap");
+
+  auto compile_all = [&](uint32_t num_threads) {
+    std::vector<std::vector<uint8_t>> blobs(images.size());
+    AssetCompiler::ForEachParallel(images.size(), num_threads, [&](uint32_t index) {
+      std::string error;
+      EXPECT_TRUE(AssetCompiler::CompileImage(images[index], spec, blobs[index], error)) << error;
+    });
+    return blobs;
+  };
+
+  auto serial = compile_all(1);
+  EXPECT_EQ(compile_all(4), serial);
+  EXPECT_EQ(compile_all(0), serial);
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "atlas_layout.h"
+
+static constexpr uint32_t kSurfaceWidth = 640;
+static constexpr uint32_t kSurfaceHeight = 480;
+
+TEST(AtlasLayoutTest, PacksGridWithSpacing) {
+  AtlasLayout layout(kSurfaceWidth, kSurfaceHeight, 128, 96);
+  ASSERT_TRUE(layout.IsValid());
+  EXPECT_EQ(layout.GetColumns(), 4);
+  EXPECT_EQ(layout.GetRows(), 4);
+  EXPECT_EQ(layout.GetCellsPerFrame(), 16);
+
+  // Cells are laid out in row-major order and never touch one another or the edge of the surface.
+  for (uint32_t slot = 0; slot < layout.GetCellsPerFrame(); ++slot) {
+    auto cell = layout.GetCell(slot);
+    EXPECT_EQ(cell.width, 128);
+    EXPECT_EQ(cell.height, 96);
+    EXPECT_GE(cell.left, AtlasLayout::kDefaultSpacing);
+    EXPECT_GE(cell.top, AtlasLayout::kDefaultSpacing);
+    EXPECT_LE(cell.Right() + AtlasLayout::kDefaultSpacing, kSurfaceWidth);
+    EXPECT_LE(cell.Bottom() + AtlasLayout::kDefaultSpacing, kSurfaceHeight);
+
+    if (slot % layout.GetColumns()) {
+      auto previous = layout.GetCell(slot - 1);
+      EXPECT_EQ(cell.top, previous.top);
+      EXPECT_EQ(cell.left, previous.Right() + AtlasLayout::kDefaultSpacing);
+    } else if (slot) {
+      auto above = layout.GetCell(slot - layout.GetColumns());
+      EXPECT_EQ(cell.left, above.left);
+      EXPECT_EQ(cell.top, above.Bottom() + AtlasLayout::kDefaultSpacing);
+    }
+  }
+}
+
+TEST(AtlasLayoutTest, CentersGrid) {
+  AtlasLayout layout(kSurfaceWidth, kSurfaceHeight, 200, 200, 10);
+  ASSERT_EQ(layout.GetColumns(), 3);
+  ASSERT_EQ(layout.GetRows(), 2);
+
+  auto first = layout.GetCell(0);
+  auto last = layout.GetCell(layout.GetCellsPerFrame() - 1);
+  EXPECT_EQ(first.left, kSurfaceWidth - last.Right());
+  EXPECT_EQ(first.top, kSurfaceHeight - last.Bottom());
+}
+
+TEST(AtlasLayoutTest, RejectsCellsThatDoNotFit) {
+  EXPECT_FALSE(AtlasLayout(kSurfaceWidth, kSurfaceHeight, 0, 32).IsValid());
+  EXPECT_FALSE(AtlasLayout(kSurfaceWidth, kSurfaceHeight, kSurfaceWidth, 32).IsValid());
+  EXPECT_FALSE(AtlasLayout(kSurfaceWidth, kSurfaceHeight, 32, kSurfaceHeight - 15).IsValid());
+  EXPECT_TRUE(AtlasLayout(kSurfaceWidth, kSurfaceHeight, 32, kSurfaceHeight - 16).IsValid());
+  EXPECT_EQ(AtlasLayout(kSurfaceWidth, kSurfaceHeight, 0, 32).GetNumFrames(10), 0);
+}
+
+TEST(AtlasLayoutTest, ComparesFramesPerRun) {
+  // A suite with 48 swatch-sized cases presents one frame per case without batching.
+  static constexpr uint32_t kNumCases = 48;
+  AtlasLayout layout(kSurfaceWidth, kSurfaceHeight, 128, 96);
+  EXPECT_EQ(layout.GetNumFrames(kNumCases), 3);
+  EXPECT_EQ(layout.GetNumFrames(16), 1);
+  EXPECT_EQ(layout.GetNumFrames(17), 2);
+  EXPECT_EQ(layout.GetNumFrames(0), 0);
+
+  // Full screen cells degrade to one frame per case, matching the unbatched behavior.
+  AtlasLayout full_screen(kSurfaceWidth, kSurfaceHeight, kSurfaceWidth - 16, kSurfaceHeight - 16);
+  EXPECT_EQ(full_screen.GetNumFrames(kNumCases), kNumCases);
+}
+
+TEST(AtlasLayoutTest, SplitsCaptureIntoCells) {
+  // Fill a surface so that every pixel records which cell (if any) it belongs to.
+  static constexpr uint32_t kWidth = 100;
+  static constexpr uint32_t kHeight = 60;
+  static constexpr uint32_t kPitch = kWidth * 4 + 16;
+  AtlasLayout layout(kWidth, kHeight, 20, 16, 4);
+  ASSERT_EQ(layout.GetCellsPerFrame(), 8);
+
+  std::vector<uint8_t> surface(kPitch * kHeight, 0);
+  auto pixel = [&](uint32_t x, uint32_t y) { return reinterpret_cast<uint32_t *>(&surface[y * kPitch + x * 4]); };
+  for (uint32_t y = 0; y < kHeight; ++y) {
+    for (uint32_t x = 0; x < kWidth; ++x) {
+      *pixel(x, y) = 0xDEADBEEF;
+    }
+  }
+  for (uint32_t slot = 0; slot < layout.GetCellsPerFrame(); ++slot) {
+    auto cell = layout.GetCell(slot);
+    for (uint32_t y = cell.top; y < cell.Bottom(); ++y) {
+      for (uint32_t x = cell.left; x < cell.Right(); ++x) {
+        *pixel(x, y) = (slot << 16) | ((y - cell.top) << 8) | (x - cell.left);
+      }
+    }
+  }
+
+  std::vector<uint32_t> extracted(20 * 16);
+  for (uint32_t slot = 0; slot < layout.GetCellsPerFrame(); ++slot) {
+    AtlasLayout::ExtractCell(surface.data(), kPitch, 4, layout.GetCell(slot),
+                             reinterpret_cast<uint8_t *>(extracted.data()));
+    for (uint32_t y = 0; y < 16; ++y) {
+      for (uint32_t x = 0; x < 20; ++x) {
+        ASSERT_EQ(extracted[y * 20 + x], (slot << 16) | (y << 8) | x) << "slot " << slot << " x " << x << " y " << y;
+      }
+    }
+  }
+}
@@ -0,0 +1,394 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "reference/combiner_model.h"
+
+using CM = CombinerModel;
+
+//! Evaluates `model` over a single pixel with the given inputs and returns the 0xAARRGGBB output.
+static uint32_t EvaluatePixel(const CombinerModel &model, uint32_t diffuse = 0, uint32_t specular = 0,
+                              uint32_t tex0 = 0) {
+  CombinerModel::Inputs inputs;
+  inputs.width = 1;
+  inputs.height = 1;
+  inputs.diffuse = &diffuse;
+  inputs.specular = &specular;
+  inputs.texture[0] = &tex0;
+
+  std::vector<uint32_t> output;
+  model.Evaluate(inputs, output);
+  return output[0];
+}
+
+//! Configures the final combiner to output R0 as an opaque color.
+static void ShowRegister(CombinerModel &model, CM::CombinerSource source) {
+  model.SetFinalCombiner0Just(source);
+  model.SetFinalCombiner1Just(CM::SRC_ZERO, true, true);
+}
+
+TEST(CombinerModel, DefaultPassesDiffuseThrough) {
+  CombinerModel model;
+  EXPECT_EQ(EvaluatePixel(model, 0x80FF4010), 0x80FF4010);
+}
+
+TEST(CombinerModel, InputMappings) {
+  struct Case {
+    CM::CombinerMapping mapping;
+    // Expected result for inputs of 0, 64/255 and 1 as a 9-bit signed value.
+    int32_t expected[3];
+  };
+  static constexpr Case kCases[] = {
+      {CM::MAP_UNSIGNED_IDENTITY, {0, 64, 255}},     {CM::MAP_UNSIGNED_INVERT, {255, 191, 0}},
+      {CM::MAP_EXPAND_NORMAL, {-255, -127, 255}},    {CM::MAP_EXPAND_NEGATE, {255, 127, -255}},
+      {CM::MAP_HALFBIAS_NORMAL, {-128, -64, 128}},   {CM::MAP_HALFBIAS_NEGATE, {128, 64, -128}},
+      {CM::MAP_SIGNED_IDENTITY, {0, 64, 255}},       {CM::MAP_SIGNED_NEGATE, {0, -64, -255}},
+  };
+  static constexpr uint32_t kInputs[] = {0x00, 0x40, 0xFF};
+
+  for (const auto &test : kCases) {
+    CombinerModel model;
+    model.SetCombinerControl(2);
+    model.SetInputColorCombiner(0, CM::ColorInput(CM::SRC_DIFFUSE, test.mapping), CM::OneInput());
+    model.SetOutputColorCombiner(0, CM::DST_R0);
+    // Split the result into its positive and negative parts, as the final combiner cannot output negative values.
+    model.SetInputColorCombiner(1, CM::ColorInput(CM::SRC_R0, CM::MAP_SIGNED_NEGATE), CM::OneInput());
+    model.SetOutputColorCombiner(1, CM::DST_R1);
+
+    for (uint32_t i = 0; i < 3; ++i) {
+      const uint32_t diffuse = 0xFF000000 + kInputs[i];
+
+      ShowRegister(model, CM::SRC_R0);
+      const auto positive = static_cast<int32_t>(EvaluatePixel(model, diffuse) & 0xFF);
+      ShowRegister(model, CM::SRC_R1);
+      const auto negative = static_cast<int32_t>(EvaluatePixel(model, diffuse) & 0xFF);
+
+      EXPECT_EQ(positive - negative, test.expected[i]) << "mapping " << test.mapping << " input " << kInputs[i];
+    }
+  }
+}
+
+TEST(CombinerModel, UnsignedMappingsClampNegativeValues) {
+  CombinerModel model;
+  model.SetCombinerControl(2);
+  model.SetInputColorCombiner(0, CM::NegativeOneInput(), CM::OneInput());
+  model.SetOutputColorCombiner(0, CM::DST_R0);
+  model.SetInputColorCombiner(1, CM::ColorInput(CM::SRC_R0, CM::MAP_UNSIGNED_INVERT), CM::OneInput());
+  model.SetOutputColorCombiner(1, CM::DST_R0);
+  ShowRegister(model, CM::SRC_R0);
+
+  EXPECT_EQ(EvaluatePixel(model), 0xFFFFFFFF);
+}
+
+TEST(CombinerModel, RegistersAreRoundedToNineBits) {
+  CombinerModel model;
+  model.SetCombinerControl(2);
+  // 96/255 * 96/255 is stored as 36/255, so scaling it by 4 yields 144 rather than the 145 of an unrounded
+  // intermediate.
+  model.SetCombinerFactorC0(0, 0x60606060);
+  model.SetInputColorCombiner(0, CM::ColorInput(CM::SRC_C0), CM::ColorInput(CM::SRC_C0));
+  model.SetOutputColorCombiner(0, CM::DST_R0);
+  model.SetInputColorCombiner(1, CM::ColorInput(CM::SRC_R0), CM::OneInput());
+  model.SetOutputColorCombiner(1, CM::DST_R0, CM::DST_DISCARD, CM::DST_DISCARD, false, false, CM::SM_SUM,
+                               CM::OP_SHIFT_LEFT_2);
+  ShowRegister(model, CM::SRC_R0);
+
+  EXPECT_EQ(EvaluatePixel(model), 0xFF909090);
+}
+
+TEST(CombinerModel, RegistersAreClamped) {
+  CombinerModel model;
+  model.SetCombinerControl(2);
+  // 1 * 1 + 1 * 1 saturates at 1, so biasing the stored result gives 0.5 rather than 1.5.
+  model.SetInputColorCombiner(0, CM::OneInput(), CM::OneInput(), CM::OneInput(), CM::OneInput());
+  model.SetOutputColorCombiner(0, CM::DST_DISCARD, CM::DST_DISCARD, CM::DST_R0);
+  model.SetInputColorCombiner(1, CM::ColorInput(CM::SRC_R0), CM::OneInput());
+  model.SetOutputColorCombiner(1, CM::DST_R0, CM::DST_DISCARD, CM::DST_DISCARD, false, false, CM::SM_SUM,
+                               CM::OP_BIAS);
+
+  // -1 * 1 + -1 * 1 saturates at -1.
+  model.SetInputAlphaCombiner(0, CM::NegativeOneInput(), CM::OneInput(), CM::NegativeOneInput(), CM::OneInput());
+  model.SetOutputAlphaCombiner(0, CM::DST_DISCARD, CM::DST_DISCARD, CM::DST_R1);
+  model.SetInputAlphaCombiner(1, CM::AlphaInput(CM::SRC_R1, CM::MAP_SIGNED_NEGATE), CM::OneInput());
+  model.SetOutputAlphaCombiner(1, CM::DST_R1);
+
+  model.SetFinalCombiner0Just(CM::SRC_R0);
+  model.SetFinalCombiner1Just(CM::SRC_R1, true);
+
+  EXPECT_EQ(EvaluatePixel(model), 0xFF808080);
+}
+
+TEST(CombinerModel, OutputOperations) {
+  struct Case {
+    CM::CombinerOutOp op;
+    uint32_t expected;
+  };
+  // Applied to 0.75 (191/255).
+  static constexpr Case kCases[] = {
+      {CM::OP_IDENTITY, 191},         {CM::OP_BIAS, 64},         {CM::OP_SHIFT_LEFT_1, 255},
+      {CM::OP_SHIFT_LEFT_1_BIAS, 127}, {CM::OP_SHIFT_LEFT_2, 255}, {CM::OP_SHIFT_RIGHT_1, 96},
+  };
+
+  for (const auto &test : kCases) {
+    CombinerModel model;
+    model.SetCombinerFactorC0(0, 0.75f, 0.75f, 0.75f, 0.75f);
+    model.SetInputColorCombiner(0, CM::ColorInput(CM::SRC_C0), CM::OneInput());
+    model.SetOutputColorCombiner(0, CM::DST_R0, CM::DST_DISCARD, CM::DST_DISCARD, false, false, CM::SM_SUM, test.op);
+    ShowRegister(model, CM::SRC_R0);
+
+    EXPECT_EQ(EvaluatePixel(model) & 0xFF, test.expected) << "op " << test.op;
+  }
+}
+
+TEST(CombinerModel, DotProductIsReplicated) {
+  CombinerModel model;
+  model.SetCombinerFactorC0(0, 1.f, 0.5f, 0.f, 0.f);
+  model.SetCombinerFactorC1(0, 0.25f, 0.5f, 1.f, 0.f);
+  model.SetInputColorCombiner(0, CM::ColorInput(CM::SRC_C0), CM::ColorInput(CM::SRC_C1));
+  model.SetOutputColorCombiner(0, CM::DST_R0, CM::DST_DISCARD, CM::DST_DISCARD, true);
+  ShowRegister(model, CM::SRC_R0);
+
+  // 1 * 0.25 + 0.5 * 0.5 + 0 * 1 = 0.5, with 0.5 stored as 128/255 in both factors.
+  EXPECT_EQ(EvaluatePixel(model), 0xFF808080);
+}
+
+//! Replays the configuration of CombinerTests::TestMux.
+TEST(CombinerModel, MuxSelectsOnR0Alpha) {
+  struct Case {
+    uint32_t c0;
+    bool msb;
+    uint32_t expected;
+  };
+  static constexpr uint32_t kRed = 0xFFFF0000;
+  static constexpr uint32_t kBlue = 0xFF0000FF;
+  static constexpr Case kCases[] = {
+      {0x82000000, false, kRed}, {0x82000000, true, kBlue}, {0x81000000, false, kBlue},
+      {0x81000000, true, kBlue}, {0x00000000, false, kRed}, {0x00000000, true, kRed},
+  };
+
+  for (const auto &test : kCases) {
+    CombinerModel model;
+    model.SetCombinerControl(2, false, false, test.msb);
+    model.SetInputColorCombiner(0, CM::OneInput(), CM::OneInput());
+    model.SetOutputColorCombiner(0, CM::DST_R0);
+    model.SetOutputAlphaCombiner(0, CM::DST_R0);
+    model.SetCombinerFactorC0(1, 1.0f, 0.0f, 0.0f, 1.0f);
+    model.SetCombinerFactorC1(1, 0.0f, 0.0f, 1.0f, 1.0f);
+    model.SetInputColorCombiner(1, CM::ColorInput(CM::SRC_C0), CM::OneInput(), CM::ColorInput(CM::SRC_C1),
+                                CM::OneInput());
+    model.SetOutputColorCombiner(1, CM::DST_DISCARD, CM::DST_DISCARD, CM::DST_DIFFUSE, false, false, CM::SM_MUX);
+    model.SetInputAlphaCombiner(1, CM::OneInput(), CM::OneInput());
+    model.SetOutputAlphaCombiner(1, CM::DST_DIFFUSE);
+    model.SetFinalCombiner0Just(CM::SRC_DIFFUSE);
+    model.SetFinalCombiner1Just(CM::SRC_DIFFUSE, true);
+
+    model.SetCombinerFactorC0(0, test.c0);
+    model.SetInputAlphaCombiner(0, CM::AlphaInput(CM::SRC_C0), CM::OneInput());
+
+    EXPECT_EQ(EvaluatePixel(model), test.expected) << std::hex << test.c0 << " msb " << test.msb;
+  }
+}
+
+//! Replays the configuration of CombinerTests::TestCombinerIndependence.
+TEST(CombinerModel, StagesReadRegistersBeforeWriting) {
+  CombinerModel model;
+  model.SetCombinerControl(2);
+  model.SetCombinerFactorC0(0, 0.0f, 1.0f, 0.0f, 1.0f);
+  model.SetInputColorCombiner(0, CM::ColorInput(CM::SRC_C0), CM::OneInput());
+  model.SetOutputColorCombiner(0, CM::DST_R0);
+  model.SetCombinerFactorC0(1, 1.0f, 0.0f, 0.0f, 1.0f);
+  model.SetInputColorCombiner(1, CM::ColorInput(CM::SRC_C0), CM::OneInput(), CM::ColorInput(CM::SRC_R0),
+                              CM::OneInput());
+  model.SetOutputColorCombiner(1, CM::DST_R0, CM::DST_R1);
+  ShowRegister(model, CM::SRC_R1);
+
+  EXPECT_EQ(EvaluatePixel(model), 0xFF00FF00);
+
+  model.SetCombinerControl(3);
+  model.SetCombinerFactorC0(0, 0.0f, 0.0f, 0.25f, 0.0f);
+  model.SetCombinerFactorC0(1, 0.0f, 0.0f, 0.75f, 0.0f);
+  model.SetOutputColorCombiner(1, CM::DST_R0, CM::DST_R1, CM::DST_DISCARD, false, false, CM::SM_SUM, CM::OP_IDENTITY,
+                               true, true);
+  model.SetInputColorCombiner(2, CM::AlphaInput(CM::SRC_R0), CM::OneInput(), CM::AlphaInput(CM::SRC_R1),
+                              CM::OneInput());
+  model.SetOutputColorCombiner(2, CM::DST_R0, CM::DST_R1);
+
+  EXPECT_EQ(EvaluatePixel(model), 0xFF404040);
+  ShowRegister(model, CM::SRC_R0);
+  EXPECT_EQ(EvaluatePixel(model), 0xFFBFBFBF);
+}
+
+TEST(CombinerModel, R0AlphaStartsAsTexture0Alpha) {
+  CombinerModel model;
+  model.SetFinalCombiner0Just(CM::SRC_R0, true);
+  model.SetFinalCombiner1Just(CM::SRC_ZERO, true, true);
+
+  EXPECT_EQ(EvaluatePixel(model, 0, 0, 0x7F123456), 0xFF7F7F7F);
+}
+
+//! Replays the configuration of CombinerTests::TestFlags.
+TEST(CombinerModel, FinalCombinerSpecularR0Sum) {
+  CombinerModel model;
+  model.SetInputColorCombiner(0, CM::OneInput(), CM::OneInput(), CM::OneInput(), CM::OneInput());
+  model.SetOutputColorCombiner(0, CM::DST_SPECULAR, CM::DST_R0);
+  model.SetFinalCombinerFactorC0(0.5f, 0.5f, 0.5f, 0.5f);
+  model.SetFinalCombiner0(CM::SRC_C0, false, false, CM::SRC_SPEC_R0_SUM, false, false);
+  model.SetFinalCombiner1(CM::SRC_ZERO, false, false, CM::SRC_ZERO, false, false, CM::SRC_ZERO, true, true);
+  EXPECT_EQ(EvaluatePixel(model), 0xFFFFFFFF) << "Uncapped";
+
+  model.SetFinalCombiner1(CM::SRC_ZERO, false, false, CM::SRC_ZERO, false, false, CM::SRC_ZERO, true, true, false,
+                          false, true);
+  EXPECT_EQ(EvaluatePixel(model), 0xFF808080) << "Capped";
+
+  model.SetCombinerFactorC0(0, 0.75f, 0.75f, 0.75f, 0.75f);
+  model.SetInputColorCombiner(0, CM::ZeroInput(), CM::ZeroInput(), CM::ColorInput(CM::SRC_C0), CM::OneInput());
+  model.SetFinalCombiner0(CM::SRC_ZERO, false, true, CM::SRC_SPEC_R0_SUM, false, false);
+  model.SetFinalCombiner1(CM::SRC_ZERO, false, false, CM::SRC_ZERO, false, false, CM::SRC_ZERO, true, true);
+  EXPECT_EQ(EvaluatePixel(model), 0xFFBFBFBF) << "Normal R0";
+
+  model.SetFinalCombiner1(CM::SRC_ZERO, false, false, CM::SRC_ZERO, false, false, CM::SRC_ZERO, true, true, true,
+                          false, false);
+  EXPECT_EQ(EvaluatePixel(model), 0xFF404040) << "1 - R0";
+}
+
+TEST(CombinerModel, FinalCombinerProduct) {
+  CombinerModel model;
+  model.SetFinalCombiner0Just(CM::SRC_EF_PROD);
+  model.SetFinalCombiner1(CM::SRC_DIFFUSE, false, false, CM::SRC_SPECULAR, false, true, CM::SRC_DIFFUSE, true);
+
+  // Diffuse * (1 - specular), with alpha from diffuse.
+  EXPECT_EQ(EvaluatePixel(model, 0x40FF8000, 0x00008000), 0x40FF4000);
+}
+
+//! Builds a random but valid configuration.
+static CombinerModel RandomModel(std::mt19937 &rng) {
+  auto pick = [&rng](uint32_t count) { return static_cast<uint32_t>(rng() % count); };
+  auto source = [&]() { return static_cast<CM::CombinerSource>(pick(CM::SRC_R1 + 1)); };
+  auto dest = [&]() {
+    static constexpr CM::CombinerDest kDests[] = {CM::DST_DISCARD, CM::DST_DIFFUSE, CM::DST_SPECULAR, CM::DST_TEX0,
+                                                  CM::DST_TEX3,    CM::DST_R0,      CM::DST_R1};
+    return kDests[pick(std::size(kDests))];
+  };
+  auto input = [&]() {
+    return CM::CombinerInput{source(), pick(2) == 0, static_cast<CM::CombinerMapping>(pick(8))};
+  };
+  auto op = [&]() {
+    static constexpr CM::CombinerOutOp kOps[] = {CM::OP_IDENTITY,       CM::OP_BIAS,          CM::OP_SHIFT_LEFT_1,
+                                                 CM::OP_SHIFT_LEFT_1_BIAS, CM::OP_SHIFT_LEFT_2, CM::OP_SHIFT_RIGHT_1};
+    return kOps[pick(std::size(kOps))];
+  };
+  auto factor = [&]() { return static_cast<uint32_t>(rng()); };
+
+  CombinerModel model;
+  const int num_combiners = static_cast<int>(1 + pick(CM::kMaxCombiners));
+  model.SetCombinerControl(num_combiners, pick(2), pick(2), pick(2));
+  for (int i = 0; i < num_combiners; ++i) {
+    model.SetCombinerFactorC0(i, factor());
+    model.SetCombinerFactorC1(i, factor());
+    model.SetInputColorCombiner(i, input(), input(), input(), input());
+    model.SetInputAlphaCombiner(i, input(), input(), input(), input());
+    model.SetOutputColorCombiner(i, dest(), dest(), dest(), pick(2), pick(2),
+                                 static_cast<CM::CombinerSumMuxMode>(pick(2)), op(), pick(2), pick(2));
+    model.SetOutputAlphaCombiner(i, dest(), dest(), dest(), false, false,
+                                 static_cast<CM::CombinerSumMuxMode>(pick(2)), op());
+  }
+
+  auto final_source = [&]() { return static_cast<CM::CombinerSource>(pick(CM::SRC_EF_PROD + 1)); };
+  model.SetFinalCombinerFactorC0(factor());
+  model.SetFinalCombinerFactorC1(factor());
+  model.SetFinalCombiner0(final_source(), pick(2), pick(2), final_source(), pick(2), pick(2), final_source(), pick(2),
+                          pick(2), final_source(), pick(2), pick(2));
+  model.SetFinalCombiner1(source(), pick(2), pick(2), source(), pick(2), pick(2), source(), pick(2), pick(2), pick(2),
+                          pick(2), pick(2));
+  return model;
+}
+
+struct RandomImages {
+  explicit RandomImages(uint32_t width, uint32_t height, uint32_t seed) {
+    std::mt19937 rng(seed);
+    for (auto &plane : planes) {
+      plane.resize(width * height);
+      for (auto &value : plane) {
+        value = rng();
+      }
+    }
+    inputs.width = width;
+    inputs.height = height;
+    inputs.diffuse = planes[0].data();
+    inputs.specular = planes[1].data();
+    inputs.fog = planes[2].data();
+    for (uint32_t i = 0; i < 4; ++i) {
+      inputs.texture[i] = planes[3 + i].data();
+    }
+  }
+
+  std::vector<uint32_t> planes[7];
+  CombinerModel::Inputs inputs;
+};
+
+TEST(CombinerModel, VectorizedMatchesScalar) {
+  // Odd dimensions leave a partial batch at the end of the image.
+  const RandomImages images(67, 31, 1);
+  std::mt19937 rng(2);
+  for (uint32_t i = 0; i < 200; ++i) {
+    const auto model = RandomModel(rng);
+    std::vector<uint32_t> expected;
+    std::vector<uint32_t> actual;
+    model.EvaluateScalar(images.inputs, expected);
+    model.Evaluate(images.inputs, actual, 1);
+    ASSERT_EQ(actual, expected) << "configuration " << i;
+  }
+}
+
+TEST(CombinerModel, ResultIsIndependentOfThreadCount) {
+  const RandomImages images(640, 480, 3);
+  std::mt19937 rng(4);
+  const auto model = RandomModel(rng);
+
+  std::vector<uint32_t> serial;
+  std::vector<uint32_t> parallel;
+  model.Evaluate(images.inputs, serial, 1);
+  model.Evaluate(images.inputs, parallel, 4);
+  EXPECT_EQ(parallel, serial);
+}
+
+TEST(CombinerModel, Benchmark) {
+  // Roughly the size of a suite: 40 full screen images through a four stage setup.
+  static constexpr uint32_t kImages = 40;
+  const RandomImages images(640, 480, 5);
+
+  CombinerModel model;
+  model.SetCombinerControl(4);
+  for (int i = 0; i < 4; ++i) {
+    model.SetCombinerFactorC0(i, 0x80402010 * (i + 1));
+    model.SetInputColorCombiner(i, CM::ColorInput(CM::SRC_TEX0, CM::MAP_EXPAND_NORMAL),
+                                CM::ColorInput(CM::SRC_DIFFUSE, CM::MAP_EXPAND_NORMAL), CM::ColorInput(CM::SRC_R0),
+                                CM::ColorInput(CM::SRC_C0));
+    model.SetOutputColorCombiner(i, CM::DST_R1, CM::DST_DISCARD, CM::DST_R0, i == 0, false, CM::SM_SUM,
+                                 CM::OP_SHIFT_LEFT_1_BIAS);
+    model.SetInputAlphaCombiner(i, CM::AlphaInput(CM::SRC_TEX1), CM::AlphaInput(CM::SRC_DIFFUSE));
+    model.SetOutputAlphaCombiner(i, CM::DST_R0);
+  }
+  model.SetFinalCombiner0(CM::SRC_FOG, true, false, CM::SRC_R0, false, false, CM::SRC_FOG);
+  model.SetFinalCombiner1Just(CM::SRC_R0, true);
+
+  std::vector<uint32_t> output;
+  auto measure = [&](uint32_t iterations, auto &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+      function();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  // The scalar path is only sampled, it exists to validate the vectorized one.
+  const double scalar = measure(4, [&]() { model.EvaluateScalar(images.inputs, output); }) * kImages / 4;
+  const double single = measure(kImages, [&]() { model.Evaluate(images.inputs, output, 1); });
+  const double parallel = measure(kImages, [&]() { model.Evaluate(images.inputs, output); });
+
+  printf("Kernel: %s\n", CombinerModel::KernelName());
+  printf("%u images: scalar %.3f s (estimated), vectorized %.3f s, vectorized (all threads) %.3f s\n", kImages,
+         scalar, single, parallel);
+}
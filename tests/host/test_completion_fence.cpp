@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <deque>
+
+#include "completion_fence.h"
+
+//! Simulates a GPU that retires signalled values in order, one per call to Retire.
+class SimulatedGPU : public CompletionFence::Device {
+ public:
+  void Signal(uint32_t value) override { pending_.push_back(value); }
+  [[nodiscard]] uint32_t Read() const override { return completed_; }
+
+  //! Completes the oldest outstanding signal, returning false if none are pending.
+  bool Retire() {
+    if (pending_.empty()) {
+      return false;
+    }
+    completed_ = pending_.front();
+    pending_.pop_front();
+    return true;
+  }
+
+  void RetireAll() {
+    while (Retire()) {
+    }
+  }
+
+  [[nodiscard]] size_t GetNumPending() const { return pending_.size(); }
+  void SetCompleted(uint32_t value) { completed_ = value; }
+
+ private:
+  std::deque<uint32_t> pending_;
+  uint32_t completed_{0};
+};
+
+TEST(CompletionFenceTest, InsertSignalsIncreasingValues) {
+  SimulatedGPU gpu;
+  CompletionFence fence(gpu);
+
+  auto first = fence.Insert();
+  auto second = fence.Insert();
+  EXPECT_NE(first, CompletionFence::kInvalidFence);
+  EXPECT_EQ(second, first + 1);
+  EXPECT_EQ(fence.GetLastInserted(), second);
+  EXPECT_EQ(gpu.GetNumPending(), 2);
+}
+
+TEST(CompletionFenceTest, CompletesInOrder) {
+  SimulatedGPU gpu;
+  CompletionFence fence(gpu);
+
+  auto first = fence.Insert();
+  auto second = fence.Insert();
+  EXPECT_FALSE(fence.IsComplete(first));
+
+  gpu.Retire();
+  EXPECT_TRUE(fence.IsComplete(first));
+  EXPECT_FALSE(fence.IsComplete(second));
+
+  gpu.Retire();
+  EXPECT_TRUE(fence.IsComplete(first));
+  EXPECT_TRUE(fence.IsComplete(second));
+  EXPECT_FALSE(fence.IsComplete(CompletionFence::kInvalidFence));
+}
+
+TEST(CompletionFenceTest, WaitPollsUntilComplete) {
+  SimulatedGPU gpu;
+  CompletionFence fence(gpu);
+
+  fence.Insert();
+  auto target = fence.Insert();
+
+  // The GPU retires one value each time the CPU yields.
+  uint32_t yields = 0;
+  EXPECT_TRUE(fence.Wait(target, 10, [&]() {
+    ++yields;
+    gpu.Retire();
+  }));
+  EXPECT_EQ(yields, 2);
+
+  const auto &stats = fence.GetStats();
+  EXPECT_EQ(stats.waits, 1);
+  EXPECT_EQ(stats.total_polls, 3);
+  EXPECT_EQ(stats.already_complete, 0);
+  EXPECT_EQ(stats.timeouts, 0);
+
+  EXPECT_TRUE(fence.Wait(target, 10));
+  EXPECT_EQ(stats.already_complete, 1);
+}
+
+TEST(CompletionFenceTest, WaitTimesOutIfGPUNeverCompletes) {
+  SimulatedGPU gpu;
+  CompletionFence fence(gpu);
+
+  auto target = fence.Insert();
+  uint32_t yields = 0;
+  EXPECT_FALSE(fence.Wait(target, 5, [&]() { ++yields; }));
+  EXPECT_EQ(yields, 5);
+  EXPECT_EQ(fence.GetStats().timeouts, 1);
+
+  EXPECT_FALSE(fence.Wait(CompletionFence::kInvalidFence, 5));
+  EXPECT_EQ(fence.GetStats().timeouts, 2);
+}
+
+TEST(CompletionFenceTest, HandlesWraparound) {
+  SimulatedGPU gpu;
+  gpu.SetCompleted(0xFFFFFFFE);
+  CompletionFence fence(gpu, 0xFFFFFFFE);
+
+  auto before_wrap = fence.Insert();
+  auto after_wrap = fence.Insert();
+  EXPECT_EQ(before_wrap, 0xFFFFFFFF);
+  // The invalid value is never handed out, as it matches the initial contents of the device buffer.
+  EXPECT_EQ(after_wrap, 1);
+  EXPECT_TRUE(fence.IsComplete(0xFFFFFFFE));
+  EXPECT_FALSE(fence.IsComplete(before_wrap));
+  EXPECT_FALSE(fence.IsComplete(after_wrap));
+
+  gpu.Retire();
+  EXPECT_TRUE(fence.IsComplete(before_wrap));
+  EXPECT_FALSE(fence.IsComplete(after_wrap));
+
+  gpu.Retire();
+  EXPECT_TRUE(fence.IsComplete(before_wrap));
+  EXPECT_TRUE(fence.IsComplete(after_wrap));
+}
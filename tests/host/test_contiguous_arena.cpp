@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "allocation_tracker.h"
+#include "contiguous_arena.h"
+
+static uintptr_t Address(const void *pointer) { return reinterpret_cast<uintptr_t>(pointer); }
+
+class ContiguousArenaTest : public ::testing::Test {
+ protected:
+  static constexpr uint32_t kCapacity = 0x10000;
+
+  void SetUp() override {
+    // Offset the region from a page boundary so that alignment must be computed on absolute addresses.
+    storage_.resize(kCapacity + 0x2000);
+    auto page = (Address(storage_.data()) + 0xFFF) & ~static_cast<uintptr_t>(0xFFF);
+    base_ = reinterpret_cast<uint8_t *>(page + 0x10);
+  }
+
+  std::vector<uint8_t> storage_;
+  uint8_t *base_{nullptr};
+};
+
+TEST_F(ContiguousArenaTest, AlignsAbsoluteAddresses) {
+  ContiguousArena arena(base_, kCapacity);
+
+  auto first = arena.Allocate(3, 1);
+  EXPECT_EQ(first, base_);
+
+  auto second = arena.Allocate(8, 16);
+  EXPECT_EQ(Address(second) % 16, 0);
+  EXPECT_EQ(second, base_ + 0x10);
+
+  auto page = arena.Allocate(32);
+  EXPECT_EQ(Address(page) % ContiguousArena::kDefaultAlignment, 0);
+  EXPECT_EQ(arena.GetUsed(), page + 32 - base_);
+
+  auto tiled = arena.Allocate(64, 0x4000);
+  EXPECT_EQ(Address(tiled) % 0x4000, 0);
+  EXPECT_TRUE(arena.Contains(tiled + 63));
+  EXPECT_EQ(arena.GetNumAllocations(), 4);
+}
+
+TEST_F(ContiguousArenaTest, RejectsInvalidRequests) {
+  ContiguousArena arena(base_, kCapacity);
+
+  EXPECT_EQ(arena.Allocate(0), nullptr);
+  EXPECT_EQ(arena.Allocate(16, 0), nullptr);
+  EXPECT_EQ(arena.Allocate(16, 24), nullptr);
+  EXPECT_EQ(arena.GetUsed(), 0);
+  EXPECT_EQ(arena.GetNumAllocations(), 0);
+}
+
+TEST_F(ContiguousArenaTest, FailsWhenExhausted) {
+  ContiguousArena arena(base_, kCapacity);
+
+  ASSERT_NE(arena.Allocate(kCapacity - 0x100, 1), nullptr);
+  EXPECT_EQ(arena.Allocate(0x101, 1), nullptr);
+  // The failed request must not consume space, and padding past the end is also rejected.
+  EXPECT_EQ(arena.Allocate(0x20, 0x1000), nullptr);
+  EXPECT_NE(arena.Allocate(0x100, 1), nullptr);
+  EXPECT_EQ(arena.GetUsed(), kCapacity);
+  EXPECT_EQ(arena.Allocate(1, 1), nullptr);
+}
+
+TEST_F(ContiguousArenaTest, ResetReleasesEverythingAndKeepsHighWaterMark) {
+  ContiguousArena arena(base_, kCapacity);
+
+  auto first = arena.Allocate(0x3000);
+  ASSERT_NE(arena.Allocate(0x2000), nullptr);
+  EXPECT_EQ(arena.GetHighWaterMark(), (first - base_) + 0x5000);
+
+  arena.Reset();
+  EXPECT_EQ(arena.GetUsed(), 0);
+  EXPECT_EQ(arena.GetNumAllocations(), 0);
+  EXPECT_EQ(arena.Allocate(0x3000), first);
+
+  // The high water mark spans resets so that the largest suite's footprint is visible at the end of a run.
+  auto high_water_mark = arena.GetHighWaterMark();
+  arena.Reset();
+  ASSERT_NE(arena.Allocate(0x100), nullptr);
+  EXPECT_EQ(arena.GetHighWaterMark(), high_water_mark);
+}
+
+TEST_F(ContiguousArenaTest, ScopeRewindsTemporaryAllocations) {
+  ContiguousArena arena(base_, kCapacity);
+
+  auto persistent = arena.Allocate(0x100);
+  auto used = arena.GetUsed();
+  uint8_t *temporary;
+  {
+    ContiguousArena::Scope scope(arena);
+    temporary = arena.Allocate(0x8000);
+    ASSERT_NE(temporary, nullptr);
+  }
+  EXPECT_EQ(arena.GetUsed(), used);
+  EXPECT_EQ(arena.Allocate(0x8000), temporary);
+  EXPECT_NE(persistent, temporary);
+
+  // Rewinding to a mark beyond the current position (e.g., after a Reset) must not resurrect space.
+  auto mark = arena.GetMark();
+  arena.Reset();
+  arena.Rewind(mark);
+  EXPECT_EQ(arena.GetUsed(), 0);
+}
+
+TEST_F(ContiguousArenaTest, ReportsConsumedBytesToTracker) {
+  AllocationTracker tracker;
+  ContiguousArena arena(base_, kCapacity, &tracker);
+
+  ASSERT_NE(arena.Allocate(0x10, 1), nullptr);
+  {
+    ContiguousArena::Scope scope(arena);
+    // Alignment padding is attributed to the allocation that required it.
+    ASSERT_NE(arena.Allocate(0x100), nullptr);
+    EXPECT_EQ(tracker.GetLiveBytes(AllocationTracker::Kind::CONTIGUOUS), arena.GetUsed());
+  }
+  EXPECT_EQ(tracker.GetLiveBytes(AllocationTracker::Kind::CONTIGUOUS), 0x10);
+
+  arena.Reset();
+  EXPECT_EQ(tracker.GetLiveBytes(AllocationTracker::Kind::CONTIGUOUS), 0);
+  EXPECT_EQ(tracker.GetPeakBytes(AllocationTracker::Kind::CONTIGUOUS), arena.GetHighWaterMark());
+}
@@ -0,0 +1,297 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "command_block.h"
+#include "default_state.h"
+
+static constexpr uint32_t kFramebufferWidth = 640;
+static constexpr uint32_t kFramebufferHeight = 480;
+
+//! Records each Push/PushF call individually, in the same way the imperative Pushbuffer calls would be issued.
+class RecordingEmitter {
+ public:
+  template <typename... Params>
+  void Push(uint32_t command, Params... params) {
+    methods.push_back({CommandBlock::kSubchannel3D, command, {static_cast<uint32_t>(params)...}});
+  }
+
+  template <typename... Params>
+  void PushF(uint32_t command, Params... params) {
+    methods.push_back({CommandBlock::kSubchannel3D, command, {FloatBits(static_cast<float>(params))...}});
+  }
+
+  std::vector<CommandBlock::Method> methods;
+
+ private:
+  static uint32_t FloatBits(float value) {
+    uint32_t ret;
+    memcpy(&ret, &value, sizeof(ret));
+    return ret;
+  }
+};
+
+//! Mimics the per-call cost of pb_pushN, writing each method into a staging buffer one call at a time.
+class PerCallEmitter {
+ public:
+  explicit PerCallEmitter(uint32_t *buffer) : cursor_(buffer) {}
+
+  template <typename... Params>
+  void Push(uint32_t command, Params... params) {
+    const uint32_t values[] = {static_cast<uint32_t>(params)...};
+    Write(command, values, sizeof...(params));
+  }
+
+  template <typename... Params>
+  void PushF(uint32_t command, Params... params) {
+    const float values[] = {static_cast<float>(params)...};
+    uint32_t raw[sizeof...(params)];
+    memcpy(raw, values, sizeof(raw));
+    Write(command, raw, sizeof...(params));
+  }
+
+ private:
+  __attribute__((noinline)) void Write(uint32_t command, const uint32_t *params, uint32_t count) {
+    *cursor_++ = CommandBlock::EncodeMethod(CommandBlock::kSubchannel3D, command, count);
+    for (uint32_t i = 0; i < count; ++i) {
+      *cursor_++ = params[i];
+    }
+  }
+
+  uint32_t *cursor_;
+};
+
+TEST(CommandBlock, EncodesMethodHeader) {
+  CommandBlock block;
+  block.Push(0x1234, 1, 2, 3);
+
+  ASSERT_EQ(block.SizeInDwords(), 4);
+  EXPECT_EQ(block.Words()[0], (3u << 18) | 0x1234);
+  EXPECT_EQ(block.Words()[1], 1);
+  EXPECT_EQ(block.Words()[2], 2);
+  EXPECT_EQ(block.Words()[3], 3);
+}
+
+TEST(CommandBlock, EncodesFloatParamsAsRawBits) {
+  CommandBlock block;
+  block.PushF(0x0100, 1.0f, -2.5f);
+
+  ASSERT_EQ(block.SizeInDwords(), 3);
+  EXPECT_EQ(block.Words()[1], 0x3F800000);
+  EXPECT_EQ(block.Words()[2], 0xC0200000);
+}
+
+TEST(CommandBlock, DecodeRoundTrips) {
+  CommandBlock block;
+  block.Push(0x0200, 0xDEADBEEF);
+  block.PushF(0x0300, 0.5f, 0.25f, 0.125f, 1.f);
+
+  auto methods = block.Decode();
+  ASSERT_EQ(methods.size(), 2);
+  EXPECT_EQ(methods[0].command, 0x0200);
+  EXPECT_THAT(methods[0].params, ::testing::ElementsAre(0xDEADBEEF));
+  EXPECT_EQ(methods[1].command, 0x0300);
+  EXPECT_EQ(methods[1].params.size(), 4);
+}
+
+TEST(CommandBlock, SubmissionBoundariesNeverSplitMethods) {
+  CommandBlock block;
+  for (auto i = 0; i < 100; ++i) {
+    block.Push(0x0400 + i * 4, i, i, i);
+  }
+
+  uint32_t chunk_start = 0;
+  auto boundaries = block.SubmissionBoundaries();
+  boundaries.push_back(block.SizeInDwords());
+  ASSERT_GT(boundaries.size(), 1);
+
+  for (auto boundary : boundaries) {
+    EXPECT_LE(boundary - chunk_start, CommandBlock::kMaxDwordsPerSubmission);
+    // Every method in this test is 4 dwords, so boundaries must fall on a multiple of 4.
+    EXPECT_EQ(boundary % 4, 0);
+    chunk_start = boundary;
+  }
+}
+
+static uint32_t F(float value) {
+  uint32_t ret;
+  memcpy(&ret, &value, sizeof(ret));
+  return ret;
+}
+
+static CommandBlock::Method M(uint32_t command, std::vector<uint32_t> params) {
+  return {CommandBlock::kSubchannel3D, command, std::move(params)};
+}
+
+// The expected sequences below are transcribed from the imperative Pushbuffer calls that TestSuite::Initialize issued
+// before the defaults were precompiled. They are deliberately independent of the DefaultState::Emit* templates so that
+// reordering or dropping a method there is detected.
+static std::vector<CommandBlock::Method> ExpectedSurfaceAndLighting(uint32_t framebuffer_width,
+                                                                    uint32_t framebuffer_height) {
+  const uint32_t pitch = framebuffer_width * 4;
+  return {
+      M(NV097_SET_EYE_POSITION, {F(0.f), F(0.f), F(0.f), F(1.f)}),
+      M(NV097_SET_ZMIN_MAX_CONTROL,
+        {NV097_SET_ZMIN_MAX_CONTROL_CULL_NEAR_FAR_EN_TRUE | NV097_SET_ZMIN_MAX_CONTROL_ZCLAMP_EN_CULL |
+         NV097_SET_ZMIN_MAX_CONTROL_CULL_IGNORE_W_FALSE}),
+      M(NV097_SET_SURFACE_PITCH,
+        {MASK(NV097_SET_SURFACE_PITCH_COLOR, pitch) | MASK(NV097_SET_SURFACE_PITCH_ZETA, pitch)}),
+      M(NV097_SET_SURFACE_CLIP_HORIZONTAL, {framebuffer_width << 16}),
+      M(NV097_SET_SURFACE_CLIP_VERTICAL, {framebuffer_height << 16}),
+      M(NV097_SET_LIGHTING_ENABLE, {0}),
+      M(NV097_SET_SPECULAR_ENABLE, {0}),
+      M(NV097_SET_LIGHT_CONTROL,
+        {NV097_SET_LIGHT_CONTROL_V_ALPHA_FROM_MATERIAL_SPECULAR | NV097_SET_LIGHT_CONTROL_V_SEPARATE_SPECULAR}),
+      M(NV097_SET_LIGHT_ENABLE_MASK, {NV097_SET_LIGHT_ENABLE_MASK_LIGHT0_OFF}),
+      M(NV097_SET_COLOR_MATERIAL, {NV097_SET_COLOR_MATERIAL_ALL_FROM_MATERIAL}),
+      M(NV097_SET_SCENE_AMBIENT_COLOR, {0, 0, 0}),
+      M(NV097_SET_MATERIAL_EMISSION, {0, 0, 0}),
+      M(NV097_SET_MATERIAL_ALPHA, {F(1.f)}),
+      M(NV097_SET_BACK_MATERIAL_ALPHA, {F(1.f)}),
+      M(NV097_SET_LIGHT_TWO_SIDE_ENABLE, {0}),
+      M(NV097_SET_FRONT_POLYGON_MODE, {NV097_SET_FRONT_POLYGON_MODE_V_FILL}),
+      M(NV097_SET_BACK_POLYGON_MODE, {NV097_SET_FRONT_POLYGON_MODE_V_FILL}),
+      M(NV097_SET_POINT_PARAMS_ENABLE, {0}),
+      M(NV097_SET_POINT_SMOOTH_ENABLE, {0}),
+      M(NV097_SET_POINT_SIZE, {8}),
+      M(NV097_SET_LINE_WIDTH, {8}),
+      M(NV097_SET_DOT_RGBMAPPING, {0}),
+      M(NV097_SET_SHADE_MODEL, {NV097_SET_SHADE_MODEL_SMOOTH}),
+      M(NV097_SET_FLAT_SHADE_OP, {NV097_SET_FLAT_SHADE_OP_VERTEX_LAST}),
+  };
+}
+
+static std::vector<CommandBlock::Method> ExpectedTextureAndRaster() {
+  return {
+      M(NV097_SET_TEXTURE_ADDRESS, {0x10101}),
+      M(NV097_SET_TEXTURE_CONTROL0, {0x3ffc0}),
+      M(NV097_SET_TEXTURE_FILTER, {0x1012000}),
+      M(NV097_SET_TEXTURE_ADDRESS + 0x40, {0x10101}),
+      M(NV097_SET_TEXTURE_CONTROL0 + 0x40, {0x3ffc0}),
+      M(NV097_SET_TEXTURE_FILTER + 0x40, {0x1012000}),
+      M(NV097_SET_TEXTURE_ADDRESS + 0x80, {0x10101}),
+      M(NV097_SET_TEXTURE_CONTROL0 + 0x80, {0x3ffc0}),
+      M(NV097_SET_TEXTURE_FILTER + 0x80, {0x1012000}),
+      M(NV097_SET_TEXTURE_ADDRESS + 0xC0, {0x10101}),
+      M(NV097_SET_TEXTURE_CONTROL0 + 0xC0, {0x3ffc0}),
+      M(NV097_SET_TEXTURE_FILTER + 0xC0, {0x1012000}),
+      M(NV097_SET_FOG_ENABLE, {0}),
+      M(NV097_SET_FOG_PLANE, {F(0.f), F(0.f), F(1.f), F(0.f)}),
+      M(NV097_SET_FOG_GEN_MODE, {NV097_SET_FOG_GEN_MODE_V_PLANAR}),
+      M(NV097_SET_FOG_MODE, {NV097_SET_FOG_MODE_V_LINEAR}),
+      M(NV097_SET_FOG_COLOR, {0xFFFFFFFF}),
+      M(NV097_SET_TEXTURE_MATRIX_ENABLE, {0, 0, 0, 0}),
+      M(NV097_SET_FRONT_FACE, {NV097_SET_FRONT_FACE_V_CW}),
+      M(NV097_SET_CULL_FACE, {NV097_SET_CULL_FACE_V_BACK}),
+      M(NV097_SET_CULL_FACE_ENABLE, {1}),
+      M(NV097_SET_COLOR_MASK, {NV097_SET_COLOR_MASK_BLUE_WRITE_ENABLE | NV097_SET_COLOR_MASK_GREEN_WRITE_ENABLE |
+                               NV097_SET_COLOR_MASK_RED_WRITE_ENABLE | NV097_SET_COLOR_MASK_ALPHA_WRITE_ENABLE}),
+      M(NV097_SET_DEPTH_TEST_ENABLE, {0}),
+      M(NV097_SET_DEPTH_MASK, {1}),
+      M(NV097_SET_DEPTH_FUNC, {NV097_SET_DEPTH_FUNC_V_LESS}),
+      M(NV097_SET_STENCIL_TEST_ENABLE, {0}),
+      M(NV097_SET_STENCIL_MASK, {0xFF}),
+      M(NV097_SET_STENCIL_OP_FAIL, {NV097_SET_STENCIL_OP_V_KEEP}),
+      M(NV097_SET_STENCIL_OP_ZFAIL, {NV097_SET_STENCIL_OP_V_KEEP}),
+      M(NV097_SET_STENCIL_OP_ZPASS, {NV097_SET_STENCIL_OP_V_KEEP}),
+      M(NV097_SET_STENCIL_FUNC_REF, {0x7F}),
+      M(NV097_SET_NORMALIZATION_ENABLE, {0}),
+      M(NV097_SET_WEIGHT4F, {F(0.f), F(0.f), F(0.f), F(0.f)}),
+      M(NV097_SET_NORMAL3F, {F(0.f), F(0.f), F(0.f)}),
+      M(NV097_SET_DIFFUSE_COLOR4I, {0}),
+      M(NV097_SET_SPECULAR_COLOR4I, {0}),
+      M(NV097_SET_TEXCOORD0_4F, {F(0.f), F(0.f), F(0.f), F(0.f)}),
+      M(NV097_SET_TEXCOORD1_4F, {F(0.f), F(0.f), F(0.f), F(0.f)}),
+      M(NV097_SET_TEXCOORD2_4F, {F(0.f), F(0.f), F(0.f), F(0.f)}),
+      M(NV097_SET_TEXCOORD3_4F, {F(0.f), F(0.f), F(0.f), F(0.f)}),
+      M(NV097_SET_VERTEX_DATA4UB + (4 * NV2A_VERTEX_ATTR_BACK_DIFFUSE), {0xFFFFFFFF}),
+      M(NV097_SET_VERTEX_DATA4UB + (4 * NV2A_VERTEX_ATTR_BACK_SPECULAR), {0}),
+      // Pow 16
+      M(NV097_SET_SPECULAR_PARAMS, {F(-0.803673f)}),
+      M(NV097_SET_SPECULAR_PARAMS_BACK, {F(0.f)}),
+      M(NV097_SET_SPECULAR_PARAMS + 4, {F(-2.7813f)}),
+      M(NV097_SET_SPECULAR_PARAMS_BACK + 4, {F(0.f)}),
+      M(NV097_SET_SPECULAR_PARAMS + 8, {F(2.97762f)}),
+      M(NV097_SET_SPECULAR_PARAMS_BACK + 8, {F(0.f)}),
+      M(NV097_SET_SPECULAR_PARAMS + 12, {F(-0.64766f)}),
+      M(NV097_SET_SPECULAR_PARAMS_BACK + 12, {F(0.f)}),
+      M(NV097_SET_SPECULAR_PARAMS + 16, {F(-2.36199f)}),
+      M(NV097_SET_SPECULAR_PARAMS_BACK + 16, {F(0.f)}),
+      M(NV097_SET_SPECULAR_PARAMS + 20, {F(2.71433f)}),
+      M(NV097_SET_SPECULAR_PARAMS_BACK + 20, {F(0.f)}),
+  };
+}
+
+TEST(DefaultState, SurfaceAndLightingBlockMatchesImperativeSequence) {
+  const auto expected = ExpectedSurfaceAndLighting(kFramebufferWidth, kFramebufferHeight);
+
+  RecordingEmitter imperative;
+  DefaultState::EmitSurfaceAndLighting(imperative, kFramebufferWidth, kFramebufferHeight);
+  EXPECT_EQ(imperative.methods, expected);
+
+  auto blocks = DefaultState::Build(kFramebufferWidth, kFramebufferHeight);
+  EXPECT_TRUE(blocks.surface_and_lighting.IsSealed());
+  EXPECT_EQ(blocks.surface_and_lighting.Decode(), expected);
+}
+
+TEST(DefaultState, TextureAndRasterBlockMatchesImperativeSequence) {
+  const auto expected = ExpectedTextureAndRaster();
+
+  RecordingEmitter imperative;
+  DefaultState::EmitTextureAndRaster(imperative);
+  EXPECT_EQ(imperative.methods, expected);
+
+  auto blocks = DefaultState::Build(kFramebufferWidth, kFramebufferHeight);
+  EXPECT_TRUE(blocks.texture_and_raster.IsSealed());
+  EXPECT_EQ(blocks.texture_and_raster.Decode(), expected);
+}
+
+TEST(DefaultState, BlocksAreCachedPerFramebufferSize) {
+  const auto &first = DefaultState::Get(kFramebufferWidth, kFramebufferHeight);
+  const auto &second = DefaultState::Get(kFramebufferWidth, kFramebufferHeight);
+  EXPECT_EQ(&first, &second);
+
+  const auto &resized = DefaultState::Get(kFramebufferWidth * 2, kFramebufferHeight * 2);
+  EXPECT_EQ(resized.framebuffer_width, kFramebufferWidth * 2);
+  EXPECT_NE(resized.surface_and_lighting.Words(),
+            DefaultState::Build(kFramebufferWidth, kFramebufferHeight).surface_and_lighting.Words());
+}
+
+TEST(DefaultState, Benchmark_PerCallVersusPrecompiled) {
+  static constexpr uint32_t kIterations = 20000;
+
+  const auto &blocks = DefaultState::Get(kFramebufferWidth, kFramebufferHeight);
+  const uint32_t total_dwords = blocks.surface_and_lighting.SizeInDwords() + blocks.texture_and_raster.SizeInDwords();
+  std::vector<uint32_t> staging(total_dwords);
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kIterations; ++i) {
+    PerCallEmitter emitter(staging.data());
+    DefaultState::EmitSurfaceAndLighting(emitter, kFramebufferWidth, kFramebufferHeight);
+    DefaultState::EmitTextureAndRaster(emitter);
+  }
+  auto per_call = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kIterations; ++i) {
+    auto dst = staging.data();
+    const auto &a = blocks.surface_and_lighting.Words();
+    const auto &b = blocks.texture_and_raster.Words();
+    memcpy(dst, a.data(), a.size() * sizeof(uint32_t));
+    memcpy(dst + a.size(), b.data(), b.size() * sizeof(uint32_t));
+  }
+  auto precompiled = std::chrono::steady_clock::now() - start;
+
+  auto to_ns = [](auto duration) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) / kIterations;
+  };
+  printf("Default state (%u dwords): per-call %.1f ns, precompiled %.1f ns\n", total_dwords, to_ns(per_call),
+         to_ns(precompiled));
+
+  EXPECT_EQ(staging[0], blocks.surface_and_lighting.Words()[0]);
+}
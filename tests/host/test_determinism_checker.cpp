@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "determinism_checker.h"
+
+static constexpr uint32_t kWidth = 100;
+static constexpr uint32_t kHeight = 70;
+static constexpr uint32_t kPitch = kWidth * 4 + 16;
+
+class DeterminismCheckerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    surface_.assign(kPitch * kHeight, 0);
+    for (uint32_t y = 0; y < kHeight; ++y) {
+      for (uint32_t x = 0; x < kWidth; ++x) {
+        *Pixel(x, y) = 0xFF000000 | (y << 8) | x;
+      }
+    }
+  }
+
+  uint32_t *Pixel(uint32_t x, uint32_t y) { return reinterpret_cast<uint32_t *>(&surface_[y * kPitch + x * 4]); }
+
+  DeterminismChecker::FrameSignature Signature() const {
+    return DeterminismChecker::ComputeSignature(surface_.data(), kPitch, kWidth, kHeight, 4);
+  }
+
+  std::vector<uint8_t> surface_;
+};
+
+TEST_F(DeterminismCheckerTest, SignatureIgnoresPadding) {
+  auto reference = Signature();
+  EXPECT_EQ(reference.GetTilesPerRow(), 4);
+  EXPECT_EQ(reference.tile_hashes.size(), 12);
+
+  // Bytes between the end of a row and the next row are not part of the image.
+  surface_[kWidth * 4] = 0xFF;
+  AtlasLayout::Cell region;
+  EXPECT_FALSE(reference.FindFirstDifference(Signature(), region));
+}
+
+TEST_F(DeterminismCheckerTest, LocatesFirstDifferingTile) {
+  auto reference = Signature();
+
+  // Change a pixel in a partial tile on the right edge and one further down the frame; the first in row-major tile
+  // order is reported.
+  *Pixel(99, 69) ^= 1;
+  *Pixel(97, 40) ^= 0x100;
+  AtlasLayout::Cell region;
+  ASSERT_TRUE(reference.FindFirstDifference(Signature(), region));
+  EXPECT_EQ(region.left, 96);
+  EXPECT_EQ(region.top, 32);
+  EXPECT_EQ(region.width, 4);
+  EXPECT_EQ(region.height, 32);
+
+  // Frames of different sizes are reported as differing everywhere.
+  auto smaller = DeterminismChecker::ComputeSignature(surface_.data(), kPitch, kWidth, kHeight - 1, 4);
+  ASSERT_TRUE(reference.FindFirstDifference(smaller, region));
+  EXPECT_EQ(region.left, 0);
+  EXPECT_EQ(region.top, 0);
+  EXPECT_EQ(region.width, kWidth);
+  EXPECT_EQ(region.height, kHeight);
+}
+
+TEST_F(DeterminismCheckerTest, StableTestHasNoDivergences) {
+  DeterminismChecker checker(3);
+  checker.BeginTest("Suite::Stable");
+  for (uint32_t i = 0; i < checker.GetIterations(); ++i) {
+    checker.BeginIteration();
+    checker.RecordFrame(Signature());
+    checker.RecordFrame(Signature());
+  }
+  EXPECT_TRUE(checker.EndTest().empty());
+  EXPECT_EQ(checker.GetNumTestsChecked(), 1);
+  EXPECT_TRUE(checker.GetUnstableTests().empty());
+}
+
+TEST_F(DeterminismCheckerTest, ReportsEachDivergentFrameOnce) {
+  DeterminismChecker checker(3);
+  checker.BeginTest("Suite::Flaky");
+
+  checker.BeginIteration();
+  checker.RecordFrame(Signature());
+  checker.RecordFrame(Signature());
+
+  auto original = *Pixel(40, 10);
+  checker.BeginIteration();
+  checker.RecordFrame(Signature());
+  *Pixel(40, 10) = 0;
+  checker.RecordFrame(Signature());
+
+  // The final frame continues to differ, but has already been reported.
+  checker.BeginIteration();
+  *Pixel(40, 10) = original;
+  checker.RecordFrame(Signature());
+  *Pixel(40, 10) = 0;
+  checker.RecordFrame(Signature());
+
+  const auto &divergences = checker.EndTest();
+  ASSERT_EQ(divergences.size(), 1);
+  EXPECT_EQ(divergences[0].test_name, "Suite::Flaky");
+  EXPECT_EQ(divergences[0].frame, 1);
+  EXPECT_EQ(divergences[0].iteration, 1);
+  EXPECT_FALSE(divergences[0].frame_count_mismatch);
+  EXPECT_EQ(divergences[0].region.left, 32);
+  EXPECT_EQ(divergences[0].region.top, 0);
+  EXPECT_EQ(divergences[0].Describe(), "Suite::Flaky frame 1 iteration 1 differs in 32x32 region at 32,0");
+}
+
+TEST_F(DeterminismCheckerTest, ReportsFrameCountMismatch) {
+  DeterminismChecker checker(2);
+  checker.BeginTest("Suite::Extra");
+  checker.BeginIteration();
+  checker.RecordFrame(Signature());
+  checker.BeginIteration();
+  checker.RecordFrame(Signature());
+  checker.RecordFrame(Signature());
+
+  const auto &divergences = checker.EndTest();
+  ASSERT_EQ(divergences.size(), 1);
+  EXPECT_TRUE(divergences[0].frame_count_mismatch);
+  EXPECT_EQ(divergences[0].Describe(), "Suite::Extra iteration 1 presented 2 frames instead of 1");
+}
+
+TEST_F(DeterminismCheckerTest, SummarizesUnstableTests) {
+  DeterminismChecker checker(2);
+  for (auto name : {"Suite::A", "Suite::B", "Suite::C"}) {
+    checker.BeginTest(name);
+    checker.BeginIteration();
+    checker.RecordFrame(Signature());
+    checker.BeginIteration();
+    if (std::string(name) == "Suite::B") {
+      *Pixel(0, 0) = 0;
+    }
+    checker.RecordFrame(Signature());
+    checker.EndTest();
+  }
+
+  // Frames recorded between tests are ignored.
+  checker.RecordFrame(Signature());
+
+  auto summary = checker.Summarize();
+  ASSERT_EQ(summary.size(), 2);
+  EXPECT_EQ(summary[0], "Determinism: 1 of 3 tests unstable across 2 iterations");
+  EXPECT_EQ(summary[1], "  UNSTABLE: Suite::B frame 0 iteration 1 differs in 32x32 region at 0,0");
+}
@@ -0,0 +1,273 @@
+#include <gtest/gtest.h>
+
+#ifdef HAVE_LIBPNG
+#include <png.h>
+#endif
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "reference/dxt_decoder.h"
+
+using DXTDecoder::Format;
+
+static std::vector<uint8_t> RandomBlocks(Format format, uint32_t num_blocks, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> ret(num_blocks * DXTDecoder::BlockSize(format));
+  for (auto &value : ret) {
+    value = static_cast<uint8_t>(rng());
+  }
+  return ret;
+}
+
+TEST(DXTDecoder, DecodesDXT1FourColorBlock) {
+  // Red (0xF800) and blue (0x001F) endpoints, c0 > c1 selects the 4 color palette. Each row uses indices 0, 1, 2, 3.
+  const uint8_t block[] = {0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4};
+  uint8_t rgba[64];
+  DXTDecoder::DecodeBlock(Format::DXT1, block, rgba);
+
+  const uint8_t expected_row[] = {255, 0, 0, 255, 0, 0, 255, 255, 170, 0, 85, 255, 85, 0, 170, 255};
+  for (uint32_t row = 0; row < 4; ++row) {
+    EXPECT_EQ(0, memcmp(rgba + row * 16, expected_row, sizeof(expected_row))) << "row " << row;
+  }
+}
+
+TEST(DXTDecoder, DecodesDXT1TransparentBlock) {
+  // c0 <= c1 selects the 3 color palette with transparent black at index 3.
+  const uint8_t block[] = {0x1F, 0x00, 0x00, 0xF8, 0xE4, 0xE4, 0xE4, 0xE4};
+  uint8_t rgba[64];
+  DXTDecoder::DecodeBlock(Format::DXT1, block, rgba);
+
+  const uint8_t expected_row[] = {0, 0, 255, 255, 255, 0, 0, 255, 127, 0, 127, 255, 0, 0, 0, 0};
+  EXPECT_EQ(0, memcmp(rgba, expected_row, sizeof(expected_row)));
+}
+
+TEST(DXTDecoder, DecodesDXT3ExplicitAlpha) {
+  uint8_t block[16] = {0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF};
+  uint8_t rgba[64];
+  DXTDecoder::DecodeBlock(Format::DXT3, block, rgba);
+  for (uint32_t i = 0; i < 16; ++i) {
+    EXPECT_EQ(rgba[i * 4 + 3], i * 17) << "texel " << i;
+    EXPECT_EQ(rgba[i * 4], 255);
+  }
+}
+
+TEST(DXTDecoder, DecodesDXT5InterpolatedAlpha) {
+  // Texel i uses alpha index i & 7.
+  uint8_t block[16] = {200, 60};
+  uint64_t indices = 0;
+  for (uint32_t i = 0; i < 16; ++i) {
+    indices |= static_cast<uint64_t>(i & 7) << (i * 3);
+  }
+  for (uint32_t i = 0; i < 6; ++i) {
+    block[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+  }
+
+  uint8_t rgba[64];
+  DXTDecoder::DecodeBlock(Format::DXT5, block, rgba);
+  const uint8_t expected[] = {200, 60, 180, 160, 140, 120, 100, 80};
+  for (uint32_t i = 0; i < 16; ++i) {
+    EXPECT_EQ(rgba[i * 4 + 3], expected[i & 7]) << "texel " << i;
+  }
+
+  // a0 <= a1 selects 6 interpolated values plus 0 and 255.
+  block[0] = 50;
+  block[1] = 100;
+  DXTDecoder::DecodeBlock(Format::DXT5, block, rgba);
+  const uint8_t expected_six[] = {50, 100, 60, 70, 80, 90, 0, 255};
+  for (uint32_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(rgba[i * 4 + 3], expected_six[i]) << "texel " << i;
+  }
+}
+
+TEST(DXTDecoder, VectorizedDecodeMatchesScalar) {
+  for (auto format : {Format::DXT1, Format::DXT3, Format::DXT5}) {
+    static constexpr uint32_t kNumBlocks = 20000;
+    const auto blocks = RandomBlocks(format, kNumBlocks, static_cast<uint32_t>(format) + 1);
+    const uint32_t block_size = DXTDecoder::BlockSize(format);
+
+    for (uint32_t i = 0; i < kNumBlocks; ++i) {
+      uint8_t expected[64];
+      uint8_t actual[64];
+      DXTDecoder::DecodeBlockScalar(format, blocks.data() + i * block_size, expected);
+      DXTDecoder::DecodeBlock(format, blocks.data() + i * block_size, actual);
+      ASSERT_EQ(0, memcmp(expected, actual, sizeof(expected))) << "block " << i;
+    }
+  }
+}
+
+TEST(DXTDecoder, ParallelDecodeMatchesSingleThreaded) {
+  static constexpr uint32_t kWidth = 1024;
+  static constexpr uint32_t kHeight = 512;
+  const auto blocks = RandomBlocks(Format::DXT5, DXTDecoder::ImageSize(Format::DXT5, kWidth, kHeight) / 16, 7);
+
+  std::vector<uint8_t> expected;
+  std::vector<uint8_t> actual;
+  DXTDecoder::DecodeImage(Format::DXT5, blocks.data(), kWidth, kHeight, expected, 1);
+  DXTDecoder::DecodeImage(Format::DXT5, blocks.data(), kWidth, kHeight, actual, 8);
+  EXPECT_EQ(actual, expected);
+}
+
+TEST(DXTDecoder, DecodesImagesSmallerThanABlock) {
+  const uint8_t block[] = {0x00, 0xF8, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00};
+  std::vector<uint8_t> rgba;
+  DXTDecoder::DecodeImage(Format::DXT1, block, 1, 2, rgba);
+  ASSERT_EQ(rgba.size(), 8);
+  const uint8_t expected[] = {255, 0, 0, 255, 255, 0, 0, 255};
+  EXPECT_EQ(0, memcmp(rgba.data(), expected, sizeof(expected)));
+}
+
+TEST(DXTDecoder, RejectsInvalidDDS) {
+  DXTDecoder::DDSFile file;
+  std::string error;
+  std::vector<uint8_t> data(128, 0);
+  EXPECT_FALSE(DXTDecoder::ParseDDS(data.data(), data.size(), file, error));
+  EXPECT_EQ(error, "Not a DDS file");
+}
+
+#ifdef HAVE_LIBPNG
+static bool LoadPNG(const std::string &path, uint32_t &width, uint32_t &height, std::vector<uint8_t> &rgba) {
+  png_image image{};
+  image.version = PNG_IMAGE_VERSION;
+  if (!png_image_begin_read_from_file(&image, path.c_str())) {
+    return false;
+  }
+  image.format = PNG_FORMAT_RGBA;
+  rgba.resize(PNG_IMAGE_SIZE(image));
+  width = image.width;
+  height = image.height;
+  return png_image_finish_read(&image, nullptr, rgba.data(), 0, nullptr) != 0;
+}
+
+//! Averages 2x2 texel groups to produce the next level of a mipmap chain.
+static std::vector<uint8_t> Downsample(const std::vector<uint8_t> &rgba, uint32_t width, uint32_t height) {
+  const uint32_t out_width = std::max(1U, width / 2);
+  const uint32_t out_height = std::max(1U, height / 2);
+  std::vector<uint8_t> ret(out_width * out_height * 4);
+  for (uint32_t y = 0; y < out_height; ++y) {
+    for (uint32_t x = 0; x < out_width; ++x) {
+      for (uint32_t c = 0; c < 4; ++c) {
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < 4; ++i) {
+          const uint32_t sx = std::min(width - 1, x * 2 + (i & 1));
+          const uint32_t sy = std::min(height - 1, y * 2 + (i >> 1));
+          sum += rgba[(sy * width + sx) * 4 + c];
+        }
+        ret[(y * out_width + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+      }
+    }
+  }
+  return ret;
+}
+
+//! Returns the peak signal to noise ratio in dB of the given channels, or 99 for identical images.
+static double PSNR(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b, uint32_t first_channel,
+                   uint32_t num_channels) {
+  double squared_error = 0.0;
+  for (size_t i = 0; i < a.size(); i += 4) {
+    for (uint32_t c = first_channel; c < first_channel + num_channels; ++c) {
+      const double delta = static_cast<double>(a[i + c]) - static_cast<double>(b[i + c]);
+      squared_error += delta * delta;
+    }
+  }
+  if (squared_error == 0.0) {
+    return 99.0;
+  }
+  const double mse = squared_error / (static_cast<double>(a.size() / 4) * num_channels);
+  return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+#endif  // HAVE_LIBPNG
+
+struct ReferenceCase {
+  const char *dds;
+  const char *png;
+  uint32_t num_mipmaps;
+  //! Minimum PSNR of the color channels of the base level.
+  double min_rgb_psnr;
+  //! Minimum PSNR of the alpha channel of the base level, or 0 to skip the check.
+  double min_alpha_psnr;
+};
+
+class DXTReferenceImages : public ::testing::TestWithParam<ReferenceCase> {};
+
+// The minimum PSNR values leave a few dB of margin below the measured quality of the stock encodes. The band image
+// has hard edges that do not fall on block boundaries and noisy bands, so it scores lower than the plasma images.
+// DXT1 alpha is a single bit and is not compared.
+static const ReferenceCase kReferenceCases[] = {
+    {"plasma_dxt1", "plasma_original", 6, 25.0, 0.0},
+    {"plasma_dxt3", "plasma_original", 6, 25.0, 40.0},
+    {"plasma_dxt5", "plasma_original", 6, 25.0, 40.0},
+    {"plasma_alpha_dxt1", "plasma_alpha", 6, 24.0, 0.0},
+    {"plasma_alpha_dxt3", "plasma_alpha", 6, 24.0, 30.0},
+    {"plasma_alpha_dxt5", "plasma_alpha", 6, 24.0, 40.0},
+    {"64x256_bands_dxt1", "64x256_bands", 9, 20.0, 0.0},
+    {"64x256_bands_dxt3", "64x256_bands", 9, 20.0, 40.0},
+    {"64x256_bands_dxt5", "64x256_bands", 9, 20.0, 40.0},
+};
+
+TEST_P(DXTReferenceImages, MatchesOriginal) {
+#ifndef HAVE_LIBPNG
+  GTEST_SKIP() << "Built without libpng, so the original images can not be loaded";
+#else
+  const auto &param = GetParam();
+  const std::string root = std::string(RESOURCES_DIR) + "/dxt_images/";
+
+  uint32_t width;
+  uint32_t height;
+  std::vector<uint8_t> original;
+  ASSERT_TRUE(LoadPNG(root + param.png + ".png", width, height, original));
+
+  DXTDecoder::DDSFile file;
+  std::string error;
+  ASSERT_TRUE(DXTDecoder::LoadDDS(root + param.dds + ".dds", file, error)) << error;
+  ASSERT_EQ(file.mipmaps.size(), param.num_mipmaps);
+
+  for (uint32_t level = 0; level < file.mipmaps.size(); ++level) {
+    const auto &mipmap = file.mipmaps[level];
+    ASSERT_EQ(mipmap.width, width) << "level " << level;
+    ASSERT_EQ(mipmap.height, height) << "level " << level;
+
+    // Lower levels were filtered by the encoder, so only check that they broadly resemble the box filtered original.
+    // Levels narrower than a block are dominated by filtering differences and are not compared.
+    if (!level) {
+      EXPECT_GE(PSNR(mipmap.rgba, original, 0, 3), param.min_rgb_psnr);
+    } else if (width >= 4 && height >= 4) {
+      EXPECT_GE(PSNR(mipmap.rgba, original, 0, 3), 16.0) << "level " << level;
+    }
+    if (!level && param.min_alpha_psnr > 0.0) {
+      EXPECT_GE(PSNR(mipmap.rgba, original, 3, 1), param.min_alpha_psnr);
+    }
+
+    original = Downsample(original, width, height);
+    width = std::max(1U, width / 2);
+    height = std::max(1U, height / 2);
+  }
+#endif  // HAVE_LIBPNG
+}
+
+INSTANTIATE_TEST_SUITE_P(DXTDecoder, DXTReferenceImages, ::testing::ValuesIn(kReferenceCases),
+                         [](const ::testing::TestParamInfo<ReferenceCase> &info) { return info.param.dds; });
+
+TEST(DXTDecoder, Benchmark) {
+  static constexpr uint32_t kWidth = 2048;
+  static constexpr uint32_t kHeight = 2048;
+  static constexpr uint32_t kIterations = 5;
+
+  for (auto format : {Format::DXT1, Format::DXT5}) {
+    const auto blocks = RandomBlocks(format, DXTDecoder::ImageSize(format, kWidth, kHeight) /
+                                                 DXTDecoder::BlockSize(format), 3);
+    std::vector<uint8_t> rgba;
+    DXTDecoder::DecodeImage(format, blocks.data(), kWidth, kHeight, rgba);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kIterations; ++i) {
+      DXTDecoder::DecodeImage(format, blocks.data(), kWidth, kHeight, rgba);
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("DXT%c: %.1f Mtexels/s\n", format == Format::DXT1 ? '1' : '5',
+           static_cast<double>(kWidth) * kHeight * kIterations / elapsed / 1e6);
+  }
+}
@@ -0,0 +1,398 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "reference/fog_model.h"
+
+using FM = FogModel;
+
+namespace {
+
+constexpr FM::FogMode kFogModes[] = {
+    FM::FOG_LINEAR, FM::FOG_EXP, FM::FOG_EXP2, FM::FOG_EXP_ABS, FM::FOG_EXP2_ABS, FM::FOG_LINEAR_ABS,
+};
+
+constexpr FM::FogGenMode kGenModes[] = {
+    FM::FOG_GEN_SPEC_ALPHA, FM::FOG_GEN_RADIAL, FM::FOG_GEN_PLANAR, FM::FOG_GEN_ABS_PLANAR, FM::FOG_GEN_FOG_X,
+};
+
+// Parameters shared by the fog suites.
+constexpr float kFogStart = 1.0f;
+constexpr float kFogEnd = 200.0f;
+constexpr float kFogDensity = 0.025f;
+constexpr float LN_256 = 5.5452f;
+constexpr float SQRT_LN_256 = 2.3548f;
+
+//! Configures `model` the way the fog suites' SetupFogParams does for the given mode.
+void SetSuiteParams(FogModel &model, FM::FogMode mode) {
+  model.SetFogMode(mode);
+  switch (mode) {
+    case FM::FOG_LINEAR:
+    case FM::FOG_LINEAR_ABS: {
+      const float multiplier = -1.0f / (kFogEnd - kFogStart);
+      model.SetFogParams(1.0f + -kFogEnd * multiplier, multiplier);
+    } break;
+    case FM::FOG_EXP:
+    case FM::FOG_EXP_ABS:
+      model.SetFogParams(1.5f, -kFogDensity / (2.0f * LN_256));
+      break;
+    case FM::FOG_EXP2:
+    case FM::FOG_EXP2_ABS:
+      model.SetFogParams(1.5f, -kFogDensity / (2.0f * SQRT_LN_256));
+      break;
+  }
+}
+
+//! Evaluates `model` with the given fog coordinates (FOG_X or oFog.x).
+std::vector<float> EvaluateCoords(const FogModel &model, const std::vector<float> &coords) {
+  FM::Inputs inputs;
+  inputs.count = coords.size();
+  inputs.fog_coord = coords.data();
+  std::vector<float> ret;
+  model.Evaluate(inputs, ret);
+  return ret;
+}
+
+float EvaluateCoord(const FogModel &model, float coord) { return EvaluateCoords(model, {coord})[0]; }
+
+float FromBits(uint32_t bits) {
+  float ret;
+  memcpy(&ret, &bits, sizeof(ret));
+  return ret;
+}
+
+// FogExceptionalValueTests::kFogValues.
+struct FogEntry {
+  const char *name;
+  uint32_t int_value;
+};
+constexpr FogEntry kFogValues[] = {
+    {"0", 0},
+    {"1", 0x3f800000},
+    {"10", 0x41200000},
+    {"100", 0x42c80000},
+    {"1000", 0x447a0000},
+    {"-1.24", 0xbf9eb852},
+    {"-10.75", 0xc12c0000},
+    {"Inf", 0x7F800000},
+    {"-Inf", 0xFF800000},
+    {"NanQ", 0x7FC00000},
+    {"-NanQ", 0xFFC00000},
+    {"NanS", 0x7F800001},
+    {"-NanS", 0xFF800001},
+    {"Max", 0x7F7FFFFF},
+    {"-Max", 0xFF7FFFFF},
+    {"MinNorm", 0x00800000},
+    {"-MinNorm", 0x80800000},
+    {"MaxSubn", 0x007FFFFF},
+    {"-MaxSubn", 0x807FFFFF},
+    {"MinSubn", 0x00000001},
+    {"-MinSubn", 0x80000001},
+};
+
+}  // namespace
+
+TEST(FogModel, LinearSpansStartToEnd) {
+  FogModel model;
+  model.SetFogGenMode(FM::FOG_GEN_FOG_X);
+  SetSuiteParams(model, FM::FOG_LINEAR);
+
+  EXPECT_NEAR(EvaluateCoord(model, kFogStart), 1.f, 1e-6f);
+  EXPECT_NEAR(EvaluateCoord(model, (kFogStart + kFogEnd) * 0.5f), 0.5f, 1e-6f);
+  EXPECT_NEAR(EvaluateCoord(model, kFogEnd), 0.f, 1e-6f);
+  // Clamped beyond the range.
+  EXPECT_EQ(EvaluateCoord(model, -50.f), 1.f);
+  EXPECT_EQ(EvaluateCoord(model, 500.f), 0.f);
+}
+
+TEST(FogModel, ExponentialModesMatchD3DFormulas) {
+  FogModel model;
+  model.SetFogGenMode(FM::FOG_GEN_FOG_X);
+
+  for (float distance : {0.f, 1.f, 10.f, 37.5f, 100.f, 199.f}) {
+    SetSuiteParams(model, FM::FOG_EXP);
+    EXPECT_NEAR(EvaluateCoord(model, distance), std::exp(-kFogDensity * distance), 2e-4f) << distance;
+
+    SetSuiteParams(model, FM::FOG_EXP2);
+    const float density_distance = kFogDensity * distance;
+    EXPECT_NEAR(EvaluateCoord(model, distance), std::exp(-density_distance * density_distance), 2e-4f) << distance;
+  }
+}
+
+TEST(FogModel, AbsoluteModes) {
+  FogModel model;
+  model.SetFogGenMode(FM::FOG_GEN_FOG_X);
+
+  // B + d * M - 1 = -0.25, which LINEAR clamps to 0 and LINEAR_ABS reflects.
+  model.SetFogParams(0.75f, 0.f);
+  model.SetFogMode(FM::FOG_LINEAR);
+  EXPECT_EQ(EvaluateCoord(model, 3.f), 0.f);
+  model.SetFogMode(FM::FOG_LINEAR_ABS);
+  EXPECT_EQ(EvaluateCoord(model, 3.f), 0.25f);
+
+  // B + 2^0 - 1.5 = -0.5.
+  model.SetFogParams(0.f, 0.f);
+  model.SetFogMode(FM::FOG_EXP_ABS);
+  EXPECT_EQ(EvaluateCoord(model, 3.f), 0.5f);
+  model.SetFogMode(FM::FOG_EXP2_ABS);
+  EXPECT_EQ(EvaluateCoord(model, 3.f), 0.5f);
+}
+
+TEST(FogModel, ZeroBiasRemovesFog) {
+  // FogParamTests' ZeroBias table, with the multiplier set to 0 so that the coordinate is irrelevant.
+  struct Case {
+    FM::FogMode mode;
+    float bias;
+  };
+  constexpr Case kCases[] = {
+      {FM::FOG_LINEAR, 2.f},    {FM::FOG_EXP, 1.51f},      {FM::FOG_EXP2, 1.5f},
+      {FM::FOG_EXP_ABS, 1.5075f}, {FM::FOG_EXP2_ABS, 1.5f}, {FM::FOG_LINEAR_ABS, 2.f},
+  };
+
+  FogModel model;
+  model.SetFogGenMode(FM::FOG_GEN_FOG_X);
+  for (const auto &test : kCases) {
+    model.SetFogMode(test.mode);
+    model.SetFogParams(test.bias, 0.f);
+    EXPECT_EQ(FM::ToFogAlpha(EvaluateCoord(model, 1.f)), 0xFF) << test.mode;
+  }
+}
+
+TEST(FogModel, GenerationModes) {
+  const float x[] = {3.f, -3.f, 0.f};
+  const float y[] = {4.f, 0.f, 0.f};
+  const float z[] = {0.f, -4.f, 0.25f};
+  const float specular_alpha[] = {0.25f, 2.f, -1.f};
+  const float fog_coord[] = {0.5f, 0.75f, 1.f};
+  FM::Inputs inputs;
+  inputs.count = 3;
+  inputs.eye_x = x;
+  inputs.eye_y = y;
+  inputs.eye_z = z;
+  inputs.specular_alpha = specular_alpha;
+  inputs.fog_coord = fog_coord;
+
+  // Linear with B = 1 and M = 1/8 exposes the distance as a factor of d / 8.
+  FogModel model;
+  model.SetFogMode(FM::FOG_LINEAR);
+  model.SetFogParams(1.f, 0.125f);
+  model.SetFogPlane(0.f, 0.f, 2.f, 0.f);
+
+  struct Case {
+    FM::FogGenMode mode;
+    float expected[3];
+  };
+  const Case kCases[] = {
+      {FM::FOG_GEN_SPEC_ALPHA, {0.25f / 8.f, 1.f / 8.f, 0.f}},
+      {FM::FOG_GEN_RADIAL, {5.f / 8.f, 5.f / 8.f, 0.25f / 8.f}},
+      {FM::FOG_GEN_PLANAR, {0.f, 0.f, 0.5f / 8.f}},
+      {FM::FOG_GEN_ABS_PLANAR, {0.f, 8.f / 8.f, 0.5f / 8.f}},
+      {FM::FOG_GEN_FOG_X, {0.5f / 8.f, 0.75f / 8.f, 1.f / 8.f}},
+  };
+  std::vector<float> factors;
+  for (const auto &test : kCases) {
+    model.SetFogGenMode(test.mode);
+    model.Evaluate(inputs, factors);
+    for (uint32_t i = 0; i < 3; ++i) {
+      EXPECT_FLOAT_EQ(factors[i], test.expected[i]) << "gen mode " << test.mode << " vertex " << i;
+    }
+  }
+
+  // A vertex program's oFog.x is used regardless of the generation mode.
+  model.SetVertexProgramActive(true);
+  model.SetFogGenMode(FM::FOG_GEN_RADIAL);
+  model.Evaluate(inputs, factors);
+  EXPECT_FLOAT_EQ(factors[0], 0.5f / 8.f);
+}
+
+TEST(FogModel, ExceptionalValues) {
+  FogModel model;
+  model.SetFogGenMode(FM::FOG_GEN_FOG_X);
+
+  for (auto mode : kFogModes) {
+    SetSuiteParams(model, mode);
+    const float zero = EvaluateCoord(model, 0.f);
+    for (const auto &entry : kFogValues) {
+      const float factor = EvaluateCoord(model, FromBits(entry.int_value));
+      EXPECT_TRUE(factor >= 0.f && factor <= 1.f) << entry.name << " mode " << mode;
+    }
+
+    // Subnormals are flushed.
+    for (uint32_t bits : {0x007FFFFFu, 0x807FFFFFu, 0x00000001u, 0x80000001u}) {
+      EXPECT_EQ(EvaluateCoord(model, FromBits(bits)), zero) << std::hex << bits << " mode " << mode;
+    }
+  }
+
+  // Infinite distances are treated as 0 by LINEAR, LINEAR_ABS and EXP.
+  for (auto mode : {FM::FOG_LINEAR, FM::FOG_LINEAR_ABS, FM::FOG_EXP}) {
+    SetSuiteParams(model, mode);
+    EXPECT_EQ(EvaluateCoord(model, INFINITY), EvaluateCoord(model, 0.f)) << mode;
+    EXPECT_EQ(EvaluateCoord(model, -INFINITY), EvaluateCoord(model, 0.f)) << mode;
+  }
+  // ...but not by the others, where a negative multiplier drives 2^(-inf) to 0.
+  SetSuiteParams(model, FM::FOG_EXP_ABS);
+  EXPECT_EQ(EvaluateCoord(model, INFINITY), 0.f);
+  SetSuiteParams(model, FM::FOG_EXP2);
+  EXPECT_EQ(EvaluateCoord(model, -INFINITY), 0.f);
+
+  // 0 * inf is 0, so a zero multiplier leaves B + 2^0 - 1.5.
+  model.SetFogMode(FM::FOG_EXP_ABS);
+  model.SetFogParams(1.25f, 0.f);
+  EXPECT_EQ(EvaluateCoord(model, INFINITY), 0.75f);
+
+  // NaN factors clamp to 0.
+  SetSuiteParams(model, FM::FOG_LINEAR);
+  EXPECT_EQ(EvaluateCoord(model, NAN), 0.f);
+  EXPECT_EQ(EvaluateCoord(model, -NAN), 0.f);
+}
+
+TEST(FogModel, ToFogAlpha) {
+  EXPECT_EQ(FM::ToFogAlpha(0.f), 0);
+  EXPECT_EQ(FM::ToFogAlpha(0.5f), 128);
+  EXPECT_EQ(FM::ToFogAlpha(1.f), 255);
+  EXPECT_EQ(FM::ToFogAlpha(2.f), 255);
+  EXPECT_EQ(FM::ToFogAlpha(-1.f), 0);
+}
+
+namespace {
+
+struct RandomVertices {
+  explicit RandomVertices(uint32_t count, uint32_t seed) {
+    static constexpr float kSpecial[] = {0.f, -0.f, INFINITY, -INFINITY, NAN, 1e-40f, FLT_MAX, -FLT_MAX};
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> value(-300.f, 300.f);
+    for (auto &array : arrays) {
+      array.resize(count);
+      for (auto &entry : array) {
+        entry = rng() % 8 ? value(rng) : kSpecial[rng() % 8];
+      }
+    }
+    inputs.count = count;
+    inputs.eye_x = arrays[0].data();
+    inputs.eye_y = arrays[1].data();
+    inputs.eye_z = arrays[2].data();
+    inputs.specular_alpha = arrays[3].data();
+    inputs.fog_coord = arrays[4].data();
+  }
+
+  std::vector<float> arrays[5];
+  FM::Inputs inputs;
+};
+
+}  // namespace
+
+TEST(FogModel, VectorizedMatchesScalar) {
+  // An odd count leaves a partial batch at the end.
+  const RandomVertices vertices(1001, 1);
+  std::mt19937 rng(2);
+  std::uniform_real_distribution<float> param(-2.f, 2.f);
+
+  for (uint32_t i = 0; i < 200; ++i) {
+    FogModel model;
+    model.SetFogMode(kFogModes[rng() % 6]);
+    model.SetFogGenMode(kGenModes[rng() % 5]);
+    model.SetFogParams(param(rng), rng() % 4 ? param(rng) * 0.1f : 0.f);
+    model.SetFogPlane(param(rng), param(rng), param(rng), param(rng));
+    model.SetVertexProgramActive(rng() % 4 == 0);
+
+    std::vector<float> expected;
+    std::vector<float> actual;
+    model.EvaluateScalar(vertices.inputs, expected);
+    model.Evaluate(vertices.inputs, actual);
+    ASSERT_EQ(0, memcmp(actual.data(), expected.data(), actual.size() * sizeof(float))) << "configuration " << i;
+  }
+}
+
+TEST(FogModel, SuiteTablesEndToEnd) {
+  // Every fog mode, generation mode and coordinate combination swept by FogExceptionalValueTests (including its INF-
+  // and NaN- bias/multiplier grids), FogParamTests and FogGenTests, evaluated for a quad's worth of vertices each.
+  struct NamedValue {
+    const char *name;
+    float value;
+  };
+  constexpr NamedValue kBiasValues[] = {{"-1", -1.f}, {"1", 1.f}, {"1.5", 1.5f}, {"1k", 1000.f}};
+  constexpr NamedValue kMultiplierValues[] = {
+      {"Lin", -1.0f / (kFogEnd - kFogStart)}, {"Exp", -kFogDensity / (2.0f * LN_256)},
+      {"Exp2", -kFogDensity / (2.0f * SQRT_LN_256)}, {"1", 1.f}, {"0", 0.f}, {"-1k", -1000.f},
+  };
+  constexpr float kParamTestValues[] = {1.f, 2.f, -1.f, -2.f, 0.5f, -0.5f, -0.25f, 0.25f};
+
+  // Eye space quads as drawn by the suites, 4 vertices each.
+  static constexpr float kQuadX[] = {-1.f, 1.f, 1.f, -1.f};
+  static constexpr float kQuadY[] = {1.f, 1.f, -1.f, -1.f};
+  static constexpr float kQuadZ[] = {7.f, 9.f, 9.f, 7.f};
+  static constexpr float kQuadSpecular[] = {0.f, 1.f, 0.75f, 0.25f};
+
+  FM::Inputs inputs;
+  inputs.count = 4;
+  inputs.eye_x = kQuadX;
+  inputs.eye_y = kQuadY;
+  inputs.eye_z = kQuadZ;
+  inputs.specular_alpha = kQuadSpecular;
+  float coords[4];
+  inputs.fog_coord = coords;
+
+  uint32_t evaluations = 0;
+  uint32_t fogged_vertices = 0;
+  std::vector<float> factors;
+  auto evaluate = [&](const FogModel &model, float coord) {
+    std::fill(std::begin(coords), std::end(coords), coord);
+    model.Evaluate(inputs, factors);
+    for (auto factor : factors) {
+      ASSERT_TRUE(factor >= 0.f && factor <= 1.f);
+      fogged_vertices += factor < 1.f;
+    }
+    ++evaluations;
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  for (auto gen_mode : kGenModes) {
+    for (auto mode : kFogModes) {
+      for (bool vertex_program : {false, true}) {
+        FogModel model;
+        model.SetFogGenMode(gen_mode);
+        model.SetFogPlane(0.f, 0.f, 2.f, 0.f);
+        model.SetVertexProgramActive(vertex_program);
+        SetSuiteParams(model, mode);
+
+        // FogExceptionalValueTests::Test
+        for (const auto &entry : kFogValues) {
+          evaluate(model, FromBits(entry.int_value));
+        }
+
+        // FogExceptionalValueTests::TestParams
+        for (uint32_t special : {0x7F800000u, 0x7FC00000u}) {
+          for (const auto &bias : kBiasValues) {
+            for (const auto &multiplier : kMultiplierValues) {
+              model.SetFogParams(bias.value, multiplier.value);
+              evaluate(model, FromBits(special));
+            }
+          }
+        }
+
+        // FogGenTests::Test
+        SetSuiteParams(model, mode);
+        for (float fog_x = 50.f; fog_x > -50.f; fog_x -= 0.2f) {
+          evaluate(model, fog_x);
+        }
+
+        // FogParamTests::Test
+        for (auto multiplier : kParamTestValues) {
+          model.SetFogParams(1.5f, multiplier);
+          for (float coord = -1.4f; coord < 1.4f; coord += 0.01f) {
+            evaluate(model, coord);
+          }
+        }
+      }
+    }
+  }
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  EXPECT_GT(fogged_vertices, 0);
+  printf("Kernel: %s\n", FM::KernelName());
+  printf("%u table entries (%u vertices) in %.2f ms\n", evaluations, evaluations * 4, elapsed * 1e3);
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "menu_state.h"
+
+using namespace std::chrono_literals;
+
+static const MenuClock::time_point kStart = MenuClock::time_point(10s);
+
+TEST(MenuCursor, WrapsAndClamps) {
+  EXPECT_EQ(MenuCursor::Previous(0, 5), 4);
+  EXPECT_EQ(MenuCursor::Previous(3, 5), 2);
+  EXPECT_EQ(MenuCursor::Next(4, 5), 0);
+  EXPECT_EQ(MenuCursor::Next(1, 5), 2);
+  EXPECT_EQ(MenuCursor::PageBack(4, 6), 0);
+  EXPECT_EQ(MenuCursor::PageBack(10, 6), 4);
+  EXPECT_EQ(MenuCursor::PageForward(1, 6, 20), 7);
+  EXPECT_EQ(MenuCursor::PageForward(17, 6, 20), 19);
+
+  // An empty menu keeps the cursor at the origin.
+  EXPECT_EQ(MenuCursor::Previous(0, 0), 0);
+  EXPECT_EQ(MenuCursor::Next(0, 0), 0);
+  EXPECT_EQ(MenuCursor::PageForward(0, 6, 0), 0);
+}
+
+TEST(MenuCursor, KeepsCursorCenteredOnPage) {
+  EXPECT_EQ(MenuCursor::GetFirstVisible(6, 30, 12), 0);
+  EXPECT_EQ(MenuCursor::GetFirstVisible(7, 30, 12), 1);
+  EXPECT_EQ(MenuCursor::GetFirstVisible(20, 30, 12), 14);
+  EXPECT_EQ(MenuCursor::GetFirstVisible(28, 30, 12), 18);
+  EXPECT_EQ(MenuCursor::GetFirstVisible(9, 10, 12), 0);
+}
+
+TEST(AutorunCountdown, UpdatesOncePerInterval) {
+  AutorunCountdown countdown(3000, 100);
+  EXPECT_FALSE(countdown.IsActive());
+  EXPECT_EQ(countdown.GetNextUpdate(kStart), kMenuNeverRedraw);
+  EXPECT_EQ(countdown.GetDisplayedMilliseconds(kStart), 3000);
+
+  countdown.Start(kStart);
+  // Restarting has no effect.
+  countdown.Start(kStart + 500ms);
+  EXPECT_TRUE(countdown.IsActive());
+  EXPECT_EQ(countdown.GetNextUpdate(kStart), kStart + 100ms);
+  EXPECT_EQ(countdown.GetDisplayedMilliseconds(kStart + 1ms), 3000);
+  EXPECT_EQ(countdown.GetDisplayedMilliseconds(kStart + 100ms), 2900);
+  EXPECT_EQ(countdown.GetNextUpdate(kStart + 150ms), kStart + 200ms);
+
+  EXPECT_FALSE(countdown.IsExpired(kStart + 2999ms));
+  EXPECT_EQ(countdown.GetDisplayedMilliseconds(kStart + 2950ms), 100);
+  EXPECT_EQ(countdown.GetNextUpdate(kStart + 2950ms), kStart + 3000ms);
+  EXPECT_TRUE(countdown.IsExpired(kStart + 3000ms));
+  EXPECT_EQ(countdown.GetDisplayedMilliseconds(kStart + 5000ms), 0);
+  EXPECT_EQ(countdown.GetNextUpdate(kStart + 5000ms), kStart + 3000ms);
+}
+
+TEST(AutorunCountdown, CancelStopsUpdates) {
+  AutorunCountdown countdown(3000);
+  countdown.Start(kStart);
+  countdown.Cancel();
+  EXPECT_TRUE(countdown.IsCancelled());
+  EXPECT_FALSE(countdown.IsActive());
+  EXPECT_FALSE(countdown.IsExpired(kStart + 10s));
+  EXPECT_EQ(countdown.GetNextUpdate(kStart + 10s), kMenuNeverRedraw);
+}
+
+TEST(TestViewState, OneShotRendersOncePerEntry) {
+  TestViewState state;
+  EXPECT_FALSE(state.Enter());
+  EXPECT_TRUE(state.ShouldRender(true));
+  state.OnRendered();
+  EXPECT_FALSE(state.ShouldRender(true));
+  EXPECT_TRUE(state.ShouldRender(false));
+
+  // Re-entering after a run requires the previous run to be torn down and renders again.
+  EXPECT_TRUE(state.Enter());
+  EXPECT_TRUE(state.ShouldRender(true));
+
+  state.OnRendered();
+  state.Leave();
+  EXPECT_FALSE(state.HasRunOnce());
+  EXPECT_FALSE(state.Enter());
+}
+
+TEST(MenuRedrawScheduler, ComputesWaitFromDeadlines) {
+  MenuRedrawScheduler scheduler(1000);
+  // The initial frame is always drawn without waiting.
+  EXPECT_EQ(scheduler.GetWaitMilliseconds(kStart), 0);
+  EXPECT_TRUE(scheduler.ConsumeRedraw(kStart));
+  EXPECT_FALSE(scheduler.ConsumeRedraw(kStart));
+
+  EXPECT_EQ(scheduler.GetWaitMilliseconds(kStart), 1000);
+  EXPECT_EQ(scheduler.GetWaitMilliseconds(kStart, kStart + 5s), 1000);
+  EXPECT_EQ(scheduler.GetWaitMilliseconds(kStart, kStart + 40ms), 40);
+  EXPECT_EQ(scheduler.GetWaitMilliseconds(kStart, kStart + 100us), 1);
+  EXPECT_EQ(scheduler.GetWaitMilliseconds(kStart, kStart - 1ms), 0);
+
+  scheduler.ScheduleRedraw(kStart + 30ms);
+  EXPECT_EQ(scheduler.GetWaitMilliseconds(kStart, kStart + 40ms), 30);
+  EXPECT_FALSE(scheduler.ConsumeRedraw(kStart + 29ms));
+  EXPECT_TRUE(scheduler.ConsumeRedraw(kStart + 30ms));
+  // The scheduled redraw is consumed along with the draw.
+  EXPECT_FALSE(scheduler.ConsumeRedraw(kStart + 31ms));
+
+  scheduler.Invalidate();
+  EXPECT_EQ(scheduler.GetWaitMilliseconds(kStart, kStart + 40ms), 0);
+  EXPECT_TRUE(scheduler.ConsumeRedraw(kStart));
+  EXPECT_FALSE(scheduler.IsDirty());
+  EXPECT_EQ(scheduler.GetNumRedraws(), 3);
+}
+
+/**
+ * Drives the root menu's redraw logic with synthetic input on a synthetic clock, mirroring TestDriver::Run: wait for
+ * the scheduled timeout or the next input, handle the input, then draw if the scheduler requests it.
+ */
+class SyntheticMenuLoop {
+ public:
+  explicit SyntheticMenuLoop(uint32_t autorun_milliseconds) : countdown_(autorun_milliseconds) {}
+
+  //! Runs the loop until `until`, delivering a button press at each of `inputs`. Returns the number of iterations.
+  uint32_t Run(MenuClock::time_point until, std::vector<MenuClock::time_point> inputs = {}) {
+    uint32_t iterations = 0;
+    auto next_input = inputs.begin();
+    while (now_ < until && !autorun_fired_) {
+      ++iterations;
+      auto wait = std::chrono::milliseconds(scheduler_.GetWaitMilliseconds(now_));
+      if (next_input != inputs.end() && *next_input <= now_ + wait) {
+        now_ = std::max(now_, *next_input++);
+        countdown_.Cancel();
+        scheduler_.Invalidate();
+      } else {
+        now_ += wait;
+      }
+
+      if (scheduler_.ConsumeRedraw(now_)) {
+        Draw();
+        scheduler_.ScheduleRedraw(countdown_.GetNextUpdate(now_));
+      }
+    }
+    return iterations;
+  }
+
+  [[nodiscard]] uint32_t GetNumDraws() const { return scheduler_.GetNumRedraws(); }
+  [[nodiscard]] bool AutorunFired() const { return autorun_fired_; }
+  [[nodiscard]] uint32_t GetLastDisplayed() const { return last_displayed_; }
+
+ private:
+  void Draw() {
+    countdown_.Start(now_);
+    if (countdown_.IsExpired(now_)) {
+      autorun_fired_ = true;
+      return;
+    }
+    last_displayed_ = countdown_.GetDisplayedMilliseconds(now_);
+  }
+
+  MenuClock::time_point now_{kStart};
+  AutorunCountdown countdown_;
+  MenuRedrawScheduler scheduler_{1000};
+  bool autorun_fired_{false};
+  uint32_t last_displayed_{0};
+};
+
+TEST(MenuRedrawScheduler, CountdownRedrawsOncePerStepThenFires) {
+  SyntheticMenuLoop loop(3000);
+  loop.Run(kStart + 60s);
+  EXPECT_TRUE(loop.AutorunFired());
+  // The initial frame, one per 100 ms step, and the final draw that triggers the autorun.
+  EXPECT_EQ(loop.GetNumDraws(), 31);
+  EXPECT_EQ(loop.GetLastDisplayed(), 100);
+}
+
+TEST(MenuRedrawScheduler, IdleMenuOnlyRedrawsOnInput) {
+  SyntheticMenuLoop loop(3000);
+  auto iterations = loop.Run(kStart + 60s, {kStart + 250ms, kStart + 20s, kStart + 20s + 150ms});
+  EXPECT_FALSE(loop.AutorunFired());
+  // The initial frame, the countdown steps before the first input, and one draw per input.
+  EXPECT_EQ(loop.GetNumDraws(), 1 + 2 + 3);
+
+  // The old loop drew every 10 ms regardless; idle periods now wake at most once per second.
+  EXPECT_LE(iterations, 70);
+  printf("60 s idle at the menu: %u draws over %u wakeups (was ~6000 of each)\n", loop.GetNumDraws(), iterations);
+}
@@ -0,0 +1,293 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "models/mesh_file.h"
+#include "resource_prefetcher.h"
+
+static uint32_t Align(uint32_t value) {
+  return (value + MeshFile::kBlockAlignment - 1) & ~(MeshFile::kBlockAlignment - 1);
+}
+
+//! Builds a container the same way collada_converter.py's pack_mesh_container does.
+static std::vector<uint8_t> BuildContainer(uint32_t num_vertices, const std::vector<float> &positions,
+                                           const std::vector<float> &normals, const std::vector<float> &texcoords,
+                                           bool interleaved = false) {
+  const std::vector<float> *attributes[MeshFile::ATTR_MAX] = {&positions, &normals, &texcoords};
+  const uint32_t components[MeshFile::ATTR_MAX] = {3, 3, 2};
+
+  MeshFile::Header header{};
+  header.magic = MeshFile::kMagic;
+  header.version = MeshFile::kVersion;
+  header.header_size = sizeof(header);
+  header.num_vertices = num_vertices;
+
+  std::vector<uint8_t> ret(sizeof(header));
+  auto append = [&ret](const float *values, uint32_t count) {
+    auto bytes = reinterpret_cast<const uint8_t *>(values);
+    ret.insert(ret.end(), bytes, bytes + count * sizeof(float));
+  };
+
+  for (uint32_t i = 0; i < MeshFile::ATTR_MAX; ++i) {
+    if (attributes[i]->empty()) {
+      continue;
+    }
+    ret.resize(Align(ret.size()));
+    header.attributes[i].offset = ret.size();
+    header.attributes[i].components = components[i];
+    append(attributes[i]->data(), attributes[i]->size());
+  }
+
+  if (interleaved) {
+    ret.resize(Align(ret.size()));
+    header.interleaved_offset = ret.size();
+    for (uint32_t vertex = 0; vertex < num_vertices; ++vertex) {
+      for (uint32_t i = 0; i < MeshFile::ATTR_MAX; ++i) {
+        if (!attributes[i]->empty()) {
+          append(attributes[i]->data() + vertex * components[i], components[i]);
+          header.interleaved_stride += vertex ? 0 : components[i] * sizeof(float);
+        }
+      }
+    }
+  }
+
+  header.file_size = ret.size();
+  memcpy(ret.data(), &header, sizeof(header));
+  return ret;
+}
+
+static bool Parse(MeshFile &mesh, const std::vector<uint8_t> &bytes, std::string &error) {
+  std::vector<uint32_t> image((bytes.size() + 3) / 4);
+  memcpy(image.data(), bytes.data(), bytes.size());
+  return mesh.Parse(std::move(image), bytes.size(), error);
+}
+
+static std::string WriteTempFile(const char *name, const std::vector<uint8_t> &bytes) {
+  std::string path = testing::TempDir() + name;
+  FILE *fp = fopen(path.c_str(), "wb");
+  EXPECT_NE(fp, nullptr);
+  if (fp) {
+    fwrite(bytes.data(), 1, bytes.size(), fp);
+    fclose(fp);
+  }
+  return path;
+}
+
+static std::vector<float> Sequence(uint32_t count, float start) {
+  std::vector<float> ret(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    ret[i] = start + static_cast<float>(i);
+  }
+  return ret;
+}
+
+TEST(MeshFile, ParsesPlanarBlocks) {
+  auto positions = Sequence(9, 0.f);
+  auto normals = Sequence(9, 100.f);
+  auto texcoords = Sequence(6, 200.f);
+
+  MeshFile mesh;
+  std::string error;
+  ASSERT_TRUE(Parse(mesh, BuildContainer(3, positions, normals, texcoords), error)) << error;
+
+  EXPECT_EQ(mesh.GetVertexCount(), 3);
+  EXPECT_EQ(mesh.GetComponents(MeshFile::ATTR_POSITION), 3);
+  EXPECT_EQ(mesh.GetComponents(MeshFile::ATTR_TEXCOORD), 2);
+  ASSERT_NE(mesh.GetPositions(), nullptr);
+  ASSERT_NE(mesh.GetNormals(), nullptr);
+  ASSERT_NE(mesh.GetTexcoords(), nullptr);
+  EXPECT_EQ(0, memcmp(mesh.GetPositions(), positions.data(), positions.size() * sizeof(float)));
+  EXPECT_EQ(0, memcmp(mesh.GetNormals(), normals.data(), normals.size() * sizeof(float)));
+  EXPECT_EQ(0, memcmp(mesh.GetTexcoords(), texcoords.data(), texcoords.size() * sizeof(float)));
+
+  auto base = reinterpret_cast<uintptr_t>(mesh.GetPositions());
+  EXPECT_EQ((reinterpret_cast<uintptr_t>(mesh.GetNormals()) - base) % MeshFile::kBlockAlignment, 0);
+  EXPECT_EQ((reinterpret_cast<uintptr_t>(mesh.GetTexcoords()) - base) % MeshFile::kBlockAlignment, 0);
+
+  uint32_t stride = 1;
+  EXPECT_EQ(mesh.GetInterleaved(stride), nullptr);
+  EXPECT_EQ(stride, 0);
+}
+
+TEST(MeshFile, OmitsAbsentAttributes) {
+  MeshFile mesh;
+  std::string error;
+  ASSERT_TRUE(Parse(mesh, BuildContainer(2, Sequence(6, 0.f), {}, {}), error)) << error;
+
+  EXPECT_NE(mesh.GetPositions(), nullptr);
+  EXPECT_EQ(mesh.GetNormals(), nullptr);
+  EXPECT_EQ(mesh.GetTexcoords(), nullptr);
+  EXPECT_EQ(mesh.GetComponents(MeshFile::ATTR_NORMAL), 0);
+}
+
+TEST(MeshFile, ParsesInterleavedBlock) {
+  auto positions = Sequence(12, 0.f);
+  auto normals = Sequence(12, 100.f);
+  auto texcoords = Sequence(8, 200.f);
+
+  MeshFile mesh;
+  std::string error;
+  ASSERT_TRUE(Parse(mesh, BuildContainer(4, positions, normals, texcoords, true), error)) << error;
+
+  uint32_t stride = 0;
+  auto interleaved = mesh.GetInterleaved(stride);
+  ASSERT_NE(interleaved, nullptr);
+  ASSERT_EQ(stride, 8 * sizeof(float));
+
+  for (uint32_t vertex = 0; vertex < 4; ++vertex) {
+    auto values = interleaved + vertex * stride / sizeof(float);
+    EXPECT_EQ(0, memcmp(values, &positions[vertex * 3], 3 * sizeof(float))) << "vertex " << vertex;
+    EXPECT_EQ(0, memcmp(values + 3, &normals[vertex * 3], 3 * sizeof(float))) << "vertex " << vertex;
+    EXPECT_EQ(0, memcmp(values + 6, &texcoords[vertex * 2], 2 * sizeof(float))) << "vertex " << vertex;
+  }
+}
+
+TEST(MeshFile, RejectsMalformedContainers) {
+  const auto valid = BuildContainer(3, Sequence(9, 0.f), Sequence(9, 0.f), {}, true);
+
+  struct Case {
+    const char *name;
+    std::function<void(MeshFile::Header &, std::vector<uint8_t> &)> mutate;
+  };
+  const Case cases[] = {
+      {"magic", [](MeshFile::Header &header, std::vector<uint8_t> &) { header.magic = 0x12345678; }},
+      {"version", [](MeshFile::Header &header, std::vector<uint8_t> &) { header.version = MeshFile::kVersion + 1; }},
+      {"header size", [](MeshFile::Header &header, std::vector<uint8_t> &) { header.header_size = 32; }},
+      {"truncated",
+       [](MeshFile::Header &, std::vector<uint8_t> &bytes) { bytes.resize(bytes.size() - sizeof(float)); }},
+      {"file size", [](MeshFile::Header &header, std::vector<uint8_t> &) { header.file_size += 16; }},
+      {"misaligned block", [](MeshFile::Header &header, std::vector<uint8_t> &) { header.attributes[1].offset += 4; }},
+      {"block inside header",
+       [](MeshFile::Header &header, std::vector<uint8_t> &) { header.attributes[0].offset = 16; }},
+      {"block past end",
+       [](MeshFile::Header &header, std::vector<uint8_t> &) { header.attributes[1].offset = header.file_size; }},
+      {"vertex count", [](MeshFile::Header &header, std::vector<uint8_t> &) { header.num_vertices = 0x40000000; }},
+      {"components", [](MeshFile::Header &header, std::vector<uint8_t> &) { header.attributes[0].components = 5; }},
+      {"missing components",
+       [](MeshFile::Header &header, std::vector<uint8_t> &) { header.attributes[0].components = 0; }},
+      {"interleaved stride", [](MeshFile::Header &header, std::vector<uint8_t> &) { header.interleaved_stride = 12; }},
+  };
+
+  for (const auto &test_case : cases) {
+    auto bytes = valid;
+    MeshFile::Header header;
+    memcpy(&header, bytes.data(), sizeof(header));
+    test_case.mutate(header, bytes);
+    memcpy(bytes.data(), &header, sizeof(header));
+
+    MeshFile mesh;
+    std::string error;
+    EXPECT_FALSE(Parse(mesh, bytes, error)) << test_case.name;
+    EXPECT_FALSE(error.empty()) << test_case.name;
+  }
+
+  MeshFile mesh;
+  std::string error;
+  EXPECT_FALSE(Parse(mesh, std::vector<uint8_t>(16), error));
+}
+
+TEST(MeshFile, LoadReadsFileAndCacheSharesInstances) {
+  auto positions = Sequence(9, 1.f);
+  auto path = WriteTempFile("mesh_file_test.mesh", BuildContainer(3, positions, Sequence(9, 0.f), {}));
+
+  std::string error;
+  auto loaded = MeshFile::Load(path, error);
+  ASSERT_NE(loaded, nullptr) << error;
+  EXPECT_EQ(loaded->GetVertexCount(), 3);
+  EXPECT_EQ(0, memcmp(loaded->GetPositions(), positions.data(), positions.size() * sizeof(float)));
+
+  auto first = MeshFile::LoadCached(path, error);
+  auto second = MeshFile::LoadCached(path, error);
+  ASSERT_NE(first, nullptr) << error;
+  EXPECT_EQ(first, second);
+  EXPECT_NE(first, loaded);
+
+  // Cached meshes outlive the file and the cache entry while referenced.
+  remove(path.c_str());
+  EXPECT_EQ(MeshFile::LoadCached(path, error), first);
+  MeshFile::ClearCache();
+  EXPECT_EQ(first->GetVertexCount(), 3);
+
+  error.clear();
+  EXPECT_EQ(MeshFile::LoadCached(path, error), nullptr);
+  EXPECT_NE(error.find(path), std::string::npos);
+}
+
+TEST(MeshFile, LoadsCheckedInResources) {
+  const char *names[] = {
+      "flat_mesh_grid.mesh",
+      "light_control_test_mesh_cone.mesh",
+      "light_control_test_mesh_cylinder.mesh",
+      "light_control_test_mesh_sphere.mesh",
+      "light_control_test_mesh_suzanne.mesh",
+      "light_control_test_mesh_torus.mesh",
+  };
+
+  for (auto name : names) {
+    std::string error;
+    auto mesh = MeshFile::Load(std::string(MESH_RESOURCE_DIR) + "/" + name, error);
+    ASSERT_NE(mesh, nullptr) << error;
+
+    EXPECT_GT(mesh->GetVertexCount(), 0) << name;
+    EXPECT_EQ(mesh->GetVertexCount() % 3, 0) << name;
+    ASSERT_EQ(mesh->GetComponents(MeshFile::ATTR_POSITION), 3) << name;
+    ASSERT_EQ(mesh->GetComponents(MeshFile::ATTR_NORMAL), 3) << name;
+
+    auto positions = mesh->GetPositions();
+    auto normals = mesh->GetNormals();
+    for (uint32_t i = 0; i < mesh->GetVertexCount() * 3; ++i) {
+      ASSERT_TRUE(std::isfinite(positions[i]) && std::isfinite(normals[i])) << name << " value " << i;
+    }
+  }
+}
+
+namespace {
+
+//! Serves a single in-memory file so that loads can only succeed via the prefetcher.
+class SingleFileSource : public ResourcePrefetcher::FileSource {
+ public:
+  SingleFileSource(std::string path, std::vector<uint8_t> contents)
+      : path_(std::move(path)), contents_(std::move(contents)) {}
+
+  bool GetSize(const std::string &path, uint32_t &size) override {
+    size = contents_.size();
+    return path == path_;
+  }
+
+  bool Read(const std::string &path, uint8_t *buffer, uint32_t size) override {
+    memcpy(buffer, contents_.data(), size);
+    return path == path_;
+  }
+
+ private:
+  std::string path_;
+  std::vector<uint8_t> contents_;
+};
+
+}  // namespace
+
+TEST(MeshFile, LoadAdoptsPrefetchedContents) {
+  const std::vector<float> positions = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f};
+  const char path[] = "prefetched/does_not_exist.mesh";
+  auto source = std::make_unique<SingleFileSource>(path, BuildContainer(3, positions, {}, {}));
+  ResourcePrefetcher prefetcher(1024, std::move(source));
+  prefetcher.Schedule({path});
+  while (!prefetcher.BytesHeld()) {
+    std::this_thread::yield();
+  }
+
+  ResourcePrefetcher::SetActive(&prefetcher);
+  std::string error;
+  auto mesh = MeshFile::Load(path, error);
+  ResourcePrefetcher::SetActive(nullptr);
+
+  ASSERT_NE(mesh, nullptr) << error;
+  EXPECT_EQ(0, memcmp(mesh->GetPositions(), positions.data(), positions.size() * sizeof(float)));
+  EXPECT_EQ(prefetcher.GetStats().hits, 1);
+  EXPECT_EQ(MeshFile::UncachedPaths({path}), std::vector<std::string>{path});
+}
@@ -0,0 +1,133 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "pgraph_register_bitmap.h"
+
+struct Snapshot {
+  alignas(16) uint8_t bytes[PGRAPH_REGISTER_ARRAY_SIZE];
+
+  uint32_t *Registers() { return reinterpret_cast<uint32_t *>(bytes); }
+};
+
+//! Fills a pair of identical snapshots with pseudo-random register values.
+static void MakeIdenticalSnapshots(Snapshot &a, Snapshot &b, uint32_t seed = 1) {
+  std::mt19937 rng(seed);
+  for (uint32_t i = 0; i < kPGRAPHRegisterCount; ++i) {
+    a.Registers()[i] = rng();
+  }
+  memcpy(b.bytes, a.bytes, sizeof(b.bytes));
+}
+
+static std::vector<uint32_t> SetIndices(const PGRAPHRegisterBitmap &bitmap) {
+  std::vector<uint32_t> ret;
+  bitmap.ForEach([&ret](uint32_t index) { ret.push_back(index); });
+  return ret;
+}
+
+TEST(PGRAPHRegisterBitmap, FromAddressesSetsExpectedBits) {
+  static constexpr uint32_t kAddresses[] = {PGRAPH_REGISTER_BASE, PGRAPH_REGISTER_BASE + 0x84, 0xFD401FFC};
+  constexpr auto bitmap = PGRAPHRegisterBitmap::FromAddresses(kAddresses);
+  static_assert(bitmap.Test(0), "FromAddresses must be usable in constant expressions");
+
+  EXPECT_THAT(SetIndices(bitmap), testing::ElementsAre(0, 0x21, kPGRAPHRegisterCount - 1));
+  EXPECT_EQ(bitmap.Count(), 3);
+}
+
+TEST(PGRAPHRegisterBitmap, BlacklistContainsKnownNoisyRegisters) {
+  EXPECT_TRUE(kPGRAPHDiffBlacklist.Test((0xFD400750 - PGRAPH_REGISTER_BASE) / 4));
+  EXPECT_TRUE(kPGRAPHDiffBlacklist.Test((0xFD4017FC - PGRAPH_REGISTER_BASE) / 4));
+  EXPECT_FALSE(kPGRAPHDiffBlacklist.Test((0xFD400754 - PGRAPH_REGISTER_BASE) / 4));
+}
+
+TEST(PGRAPHRegisterBitmap, IdenticalSnapshotsProduceEmptyBitmap) {
+  Snapshot a, b;
+  MakeIdenticalSnapshots(a, b);
+
+  PGRAPHRegisterBitmap changed;
+  changed.Set(5);
+  EXPECT_FALSE(pb_diff_registers(a.bytes, b.bytes, PGRAPHRegisterBitmap{}, changed));
+  EXPECT_TRUE(changed.Empty());
+}
+
+TEST(PGRAPHRegisterBitmap, ReportsEachChangedRegister) {
+  Snapshot a, b;
+  MakeIdenticalSnapshots(a, b);
+  b.Registers()[0] ^= 1;
+  b.Registers()[31] ^= 0x80000000;
+  b.Registers()[32] += 1;
+  b.Registers()[kPGRAPHRegisterCount - 1] = ~b.Registers()[kPGRAPHRegisterCount - 1];
+
+  PGRAPHRegisterBitmap changed;
+  EXPECT_TRUE(pb_diff_registers(a.bytes, b.bytes, PGRAPHRegisterBitmap{}, changed));
+  EXPECT_THAT(SetIndices(changed), testing::ElementsAre(0, 31, 32, kPGRAPHRegisterCount - 1));
+}
+
+TEST(PGRAPHRegisterBitmap, IgnoredRegistersAreFiltered) {
+  Snapshot a, b;
+  MakeIdenticalSnapshots(a, b);
+  const uint32_t noisy = (0xFD400750 - PGRAPH_REGISTER_BASE) / 4;
+  b.Registers()[noisy] += 1;
+
+  PGRAPHRegisterBitmap changed;
+  EXPECT_FALSE(pb_diff_registers(a.bytes, b.bytes, kPGRAPHDiffBlacklist, changed));
+
+  b.Registers()[10] += 1;
+  EXPECT_TRUE(pb_diff_registers(a.bytes, b.bytes, kPGRAPHDiffBlacklist, changed));
+  EXPECT_THAT(SetIndices(changed), testing::ElementsAre(10));
+}
+
+TEST(PGRAPHRegisterBitmap, MatchesScalarImplementation) {
+  std::mt19937 rng(1234);
+  for (uint32_t iteration = 0; iteration < 64; ++iteration) {
+    Snapshot a, b;
+    MakeIdenticalSnapshots(a, b, iteration);
+    for (uint32_t i = 0; i < iteration * 4; ++i) {
+      b.Registers()[rng() % kPGRAPHRegisterCount] ^= 1U << (rng() % 32);
+    }
+
+    PGRAPHRegisterBitmap simd;
+    PGRAPHRegisterBitmap scalar;
+    EXPECT_EQ(pb_diff_registers(a.bytes, b.bytes, kPGRAPHDiffBlacklist, simd),
+              pb_diff_registers_scalar(a.bytes, b.bytes, kPGRAPHDiffBlacklist, scalar));
+    EXPECT_EQ(SetIndices(simd), SetIndices(scalar));
+  }
+}
+
+TEST(PGRAPHRegisterBitmap, Benchmark_DiffPerCall) {
+  static constexpr uint32_t kIterations = 20000;
+
+  Snapshot a, b;
+  MakeIdenticalSnapshots(a, b);
+  b.Registers()[100] += 1;
+  b.Registers()[1500] += 1;
+
+  PGRAPHRegisterBitmap changed;
+  uint32_t total = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kIterations; ++i) {
+    total += pb_diff_registers(a.bytes, b.bytes, kPGRAPHDiffBlacklist, changed);
+  }
+  auto simd = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kIterations; ++i) {
+    total += pb_diff_registers_scalar(a.bytes, b.bytes, kPGRAPHDiffBlacklist, changed);
+  }
+  auto scalar = std::chrono::steady_clock::now() - start;
+
+  auto to_ns = [](auto duration) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) / kIterations;
+  };
+  printf("PGRAPH register diff (%u registers): pb_diff_registers %.1f ns, scalar %.1f ns\n", kPGRAPHRegisterCount,
+         to_ns(simd), to_ns(scalar));
+
+  EXPECT_EQ(total, kIterations * 2);
+  EXPECT_EQ(changed.Count(), 2);
+}
@@ -0,0 +1,163 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include "pgraph_snapshot_history.h"
+
+using testing::ElementsAre;
+
+static constexpr uint32_t kRegisterCount = PGRAPHHistoryWriter::kRegisterCount;
+
+struct Snapshot {
+  uint32_t registers[kRegisterCount]{};
+
+  [[nodiscard]] const uint8_t *Bytes() const { return reinterpret_cast<const uint8_t *>(registers); }
+};
+
+//! Encodes the given snapshots into an in-memory history file.
+static std::vector<uint8_t> Encode(const std::vector<std::pair<std::string, Snapshot>> &snapshots) {
+  PGRAPHHistoryWriter writer("");
+  auto ret = PGRAPHHistoryWriter::EncodeHeader();
+  for (const auto &snapshot : snapshots) {
+    auto record = writer.EncodeRecord(snapshot.first, snapshot.second.Bytes());
+    ret.insert(ret.end(), record.begin(), record.end());
+  }
+  return ret;
+}
+
+TEST(PGRAPHSnapshotHistory, RoundTripsRandomSnapshots) {
+  std::mt19937 rng(42);
+  std::vector<std::pair<std::string, Snapshot>> snapshots;
+  Snapshot current;
+  for (auto &value : current.registers) {
+    value = rng();
+  }
+
+  for (uint32_t i = 0; i < 50; ++i) {
+    for (uint32_t change = 0; change < i; ++change) {
+      current.registers[rng() % kRegisterCount] = rng();
+    }
+    snapshots.emplace_back("Suite::Test" + std::to_string(i), current);
+  }
+
+  auto encoded = Encode(snapshots);
+
+  PGRAPHHistoryIndex index;
+  std::vector<std::string> errors;
+  ASSERT_TRUE(index.Parse(encoded.data(), encoded.size(), errors));
+  ASSERT_EQ(index.NumRecords(), snapshots.size());
+
+  for (uint32_t record = 0; record < snapshots.size(); ++record) {
+    EXPECT_EQ(index.RecordName(record), snapshots[record].first);
+    for (uint32_t reg = 0; reg < kRegisterCount; ++reg) {
+      ASSERT_EQ(index.ValueAt(reg, record), snapshots[record].second.registers[reg])
+          << "record " << record << " register " << reg;
+    }
+  }
+}
+
+TEST(PGRAPHSnapshotHistory, UnchangedSnapshotsAreCompact) {
+  Snapshot snapshot;
+  snapshot.registers[7] = 0x12345678;
+
+  PGRAPHHistoryWriter writer("");
+  auto first = writer.EncodeRecord("A::a", snapshot.Bytes());
+  auto second = writer.EncodeRecord("A::b", snapshot.Bytes());
+
+  // Name length, name, zero change count.
+  EXPECT_EQ(second.size(), 1 + 4 + 1);
+  EXPECT_LT(first.size(), 16);
+}
+
+TEST(PGRAPHSnapshotHistory, QueriesTestsThatChangedRegister) {
+  Snapshot snapshot;
+  std::vector<std::pair<std::string, Snapshot>> snapshots;
+  snapshot.registers[3] = 1;
+  snapshots.emplace_back("A::first", snapshot);
+  snapshot.registers[10] = 5;
+  snapshots.emplace_back("A::second", snapshot);
+  snapshot.registers[3] = 2;
+  snapshots.emplace_back("B::third", snapshot);
+  snapshots.emplace_back("B::fourth", snapshot);
+
+  auto encoded = Encode(snapshots);
+  PGRAPHHistoryIndex index;
+  std::vector<std::string> errors;
+  ASSERT_TRUE(index.Parse(encoded.data(), encoded.size(), errors));
+
+  const auto &changes = index.Changes(3);
+  ASSERT_EQ(changes.size(), 2);
+  EXPECT_EQ(changes[0].record, 0);
+  EXPECT_EQ(changes[0].value, 1);
+  EXPECT_EQ(changes[1].record, 2);
+  EXPECT_EQ(changes[1].value, 2);
+
+  EXPECT_THAT(index.RegistersChangedBy(1), ElementsAre(10));
+  EXPECT_TRUE(index.RegistersChangedBy(3).empty());
+
+  uint32_t record;
+  ASSERT_TRUE(index.FindRecord("B::fourth", record));
+  EXPECT_EQ(record, 3);
+  EXPECT_EQ(index.ValueAt(3, record), 2);
+  EXPECT_EQ(index.ValueAt(10, 0), 0);
+  EXPECT_FALSE(index.FindRecord("C::missing", record));
+}
+
+TEST(PGRAPHSnapshotHistory, TruncatedTrailingRecordKeepsEarlierRecords) {
+  Snapshot snapshot;
+  std::vector<std::pair<std::string, Snapshot>> snapshots;
+  snapshot.registers[0] = 0xFFFFFFFF;
+  snapshots.emplace_back("A::a", snapshot);
+  snapshot.registers[1] = 0xFFFFFFFF;
+  snapshots.emplace_back("A::b", snapshot);
+
+  auto encoded = Encode(snapshots);
+  encoded.pop_back();
+
+  PGRAPHHistoryIndex index;
+  std::vector<std::string> errors;
+  EXPECT_FALSE(index.Parse(encoded.data(), encoded.size(), errors));
+  EXPECT_THAT(errors, ElementsAre("Record 1: truncated register delta"));
+  ASSERT_EQ(index.NumRecords(), 1);
+  EXPECT_EQ(index.ValueAt(0, 0), 0xFFFFFFFF);
+  EXPECT_TRUE(index.Changes(1).empty());
+}
+
+TEST(PGRAPHSnapshotHistory, RejectsBadHeader) {
+  const uint8_t garbage[] = {'N', 'O', 'P', 'E', 1, 0, 0, 0, 0, 8, 0, 0};
+  PGRAPHHistoryIndex index;
+  std::vector<std::string> errors;
+  EXPECT_FALSE(index.Parse(garbage, sizeof(garbage), errors));
+  EXPECT_EQ(index.NumRecords(), 0);
+}
+
+TEST(PGRAPHSnapshotHistory, WriterAppendsToFile) {
+  auto path = std::filesystem::temp_directory_path() / "test_pgraph_snapshot_history.bin";
+
+  Snapshot snapshot;
+  {
+    PGRAPHHistoryWriter writer(path.string());
+    snapshot.registers[100] = 0xCAFE;
+    ASSERT_TRUE(writer.Append("A::a", snapshot.Bytes()));
+    snapshot.registers[100] = 0xBEEF;
+    ASSERT_TRUE(writer.Append("A::b", snapshot.Bytes()));
+  }
+
+  PGRAPHHistoryIndex index;
+  std::vector<std::string> errors;
+  ASSERT_TRUE(index.Load(path.string(), errors));
+  ASSERT_EQ(index.NumRecords(), 2);
+  EXPECT_EQ(index.ValueAt(100, 0), 0xCAFE);
+  EXPECT_EQ(index.ValueAt(100, 1), 0xBEEF);
+
+  // Creating a new writer starts a fresh history.
+  { PGRAPHHistoryWriter writer(path.string()); }
+  ASSERT_TRUE(index.Load(path.string(), errors));
+  EXPECT_EQ(index.NumRecords(), 0);
+
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,150 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "recording/pushbuffer_trace.h"
+
+using PushbufferTrace::MethodWrite;
+
+static constexpr uint32_t kNonIncreasing = 0x40000000;
+
+static constexpr uint32_t Header(uint32_t subchannel, uint32_t method, uint32_t count) {
+  return (count << 18) | (subchannel << 13) | method;
+}
+
+TEST(PushbufferTrace, XXH64MatchesReferenceVectors) {
+  EXPECT_EQ(PushbufferTrace::XXH64("", 0), 0xEF46DB3751D8E999ULL);
+  EXPECT_EQ(PushbufferTrace::XXH64("a", 1), 0xD24EC4F1A98C6E5BULL);
+
+  // Inputs longer than a single 32-byte stripe must exercise the lane accumulators.
+  std::string long_input(100, 'x');
+  EXPECT_NE(PushbufferTrace::XXH64(long_input.data(), long_input.size()),
+            PushbufferTrace::XXH64(long_input.data(), long_input.size() - 1));
+}
+
+TEST(PushbufferTrace, NormalizeExpandsIncreasingMethods) {
+  std::vector<uint32_t> words = {Header(0, 0x0300, 3), 1, 2, 3};
+  auto writes = PushbufferTrace::Normalize(words);
+
+  EXPECT_THAT(writes, testing::ElementsAre(MethodWrite{0, 0x0300, 1}, MethodWrite{0, 0x0304, 2},
+                                           MethodWrite{0, 0x0308, 3}));
+}
+
+TEST(PushbufferTrace, NormalizeExpandsNonIncreasingMethods) {
+  std::vector<uint32_t> words = {Header(2, 0x1818, 2) | kNonIncreasing, 0xAA, 0xBB};
+  auto writes = PushbufferTrace::Normalize(words);
+
+  EXPECT_THAT(writes, testing::ElementsAre(MethodWrite{2, 0x1818, 0xAA}, MethodWrite{2, 0x1818, 0xBB}));
+}
+
+TEST(PushbufferTrace, NormalizeIgnoresHeaderBatching) {
+  std::vector<uint32_t> batched = {Header(0, 0x0300, 2), 5, 6};
+  std::vector<uint32_t> split = {Header(0, 0x0300, 1), 5, Header(0, 0x0304, 1), 6};
+
+  auto a = PushbufferTrace::Normalize(batched);
+  auto b = PushbufferTrace::Normalize(split);
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(PushbufferTrace::Hash(a), PushbufferTrace::Hash(b));
+}
+
+TEST(PushbufferTrace, NormalizePreservesInvalidWords) {
+  // A jump, then a method claiming more parameters than remain, leaving its lone parameter to be treated as a header.
+  std::vector<uint32_t> words = {0x20001000, Header(0, 0x0100, 4), 1};
+  auto writes = PushbufferTrace::Normalize(words);
+
+  EXPECT_THAT(writes, testing::ElementsAre(MethodWrite{PushbufferTrace::kInvalidSubchannel, 0, 0x20001000},
+                                           MethodWrite{PushbufferTrace::kInvalidSubchannel, 0, Header(0, 0x0100, 4)},
+                                           MethodWrite{PushbufferTrace::kInvalidSubchannel, 0, 1}));
+}
+
+TEST(PushbufferTrace, HashIsSensitiveToValueChanges) {
+  auto a = PushbufferTrace::Normalize({Header(0, 0x0300, 1), 1});
+  auto b = PushbufferTrace::Normalize({Header(0, 0x0300, 1), 2});
+  EXPECT_NE(PushbufferTrace::Hash(a), PushbufferTrace::Hash(b));
+}
+
+TEST(PushbufferTrace, DiffShowsOnlyChangedRegionWithContext) {
+  std::vector<MethodWrite> expected;
+  for (uint32_t i = 0; i < 10; ++i) {
+    expected.push_back({0, 0x0300 + i * 4, i});
+  }
+  auto actual = expected;
+  actual[5].value = 0xDEAD;
+
+  auto diff = PushbufferTrace::Diff(expected, actual, 1);
+  EXPECT_EQ(diff,
+            "@@ first difference at write 5 (expected 10 writes, actual 10 writes) @@\n"
+            "  [4] 0:0x0310 = 0x00000004\n"
+            "- [5] 0:0x0314 = 0x00000005\n"
+            "+ [5] 0:0x0314 = 0x0000DEAD\n"
+            "  [6] 0:0x0318 = 0x00000006\n");
+}
+
+TEST(PushbufferTrace, DiffOfIdenticalTracesIsEmpty) {
+  std::vector<MethodWrite> writes = {{0, 0x0100, 0}};
+  EXPECT_TRUE(PushbufferTrace::Diff(writes, writes).empty());
+}
+
+TEST(PushbufferTrace, DiffHandlesInsertion) {
+  std::vector<MethodWrite> expected = {{0, 0x0100, 1}, {0, 0x0200, 2}};
+  std::vector<MethodWrite> actual = {{0, 0x0100, 1}, {0, 0x0180, 9}, {0, 0x0200, 2}};
+
+  auto diff = PushbufferTrace::Diff(expected, actual, 0);
+  EXPECT_EQ(diff,
+            "@@ first difference at write 1 (expected 2 writes, actual 3 writes) @@\n"
+            "+ [1] 0:0x0180 = 0x00000009\n");
+}
+
+TEST(PushbufferTrace, DiffTruncatesLongOutput) {
+  std::vector<MethodWrite> expected(50, {0, 0x0100, 0});
+  std::vector<MethodWrite> actual(50, {0, 0x0100, 1});
+
+  auto diff = PushbufferTrace::Diff(expected, actual, 0, 10);
+  EXPECT_THAT(diff, testing::HasSubstr("... 90 more lines\n"));
+}
+
+TEST(PushbufferTrace, ManifestRoundTrips) {
+  PushbufferTrace::Manifest manifest;
+  manifest.Set("Suite_B/Test", {0x0123456789ABCDEFULL, 12});
+  manifest.Set("Suite_A/Other", {0xFEDCBA9876543210ULL, 0});
+
+  auto serialized = manifest.Serialize();
+
+  PushbufferTrace::Manifest parsed;
+  std::vector<std::string> errors;
+  ASSERT_TRUE(parsed.Parse(serialized, errors));
+  EXPECT_EQ(parsed.entries(), manifest.entries());
+
+  // Entries are sorted such that the committed file diffs cleanly.
+  EXPECT_LT(serialized.find("Suite_A/Other"), serialized.find("Suite_B/Test"));
+}
+
+TEST(PushbufferTrace, ManifestReportsMalformedLines) {
+  PushbufferTrace::Manifest manifest;
+  std::vector<std::string> errors;
+  EXPECT_FALSE(manifest.Parse("# comment\n\nSuite/Test zzz\n", errors));
+  ASSERT_EQ(errors.size(), 1);
+  EXPECT_THAT(errors[0], testing::HasSubstr("line 3"));
+}
+
+TEST(PushbufferTrace, LoadRejectsPartialWords) {
+  auto path = std::filesystem::temp_directory_path() / "test_pushbuffer_trace_partial.nv2a";
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write("\x01\x02\x03\x04\x05", 5);
+  }
+
+  std::vector<uint32_t> words;
+  EXPECT_FALSE(PushbufferTrace::Load(path.string(), words));
+
+  std::filesystem::resize_file(path, 4);
+  ASSERT_TRUE(PushbufferTrace::Load(path.string(), words));
+  EXPECT_THAT(words, testing::ElementsAre(0x04030201));
+
+  std::filesystem::remove(path);
+}
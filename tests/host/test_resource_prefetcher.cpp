@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "resource_prefetcher.h"
+
+namespace {
+
+//! In-memory FileSource whose reads can be held open to observe in-flight behavior.
+class FakeFileSource : public ResourcePrefetcher::FileSource {
+ public:
+  void AddFile(const std::string &path, uint32_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string contents(size, '\0');
+    for (uint32_t i = 0; i < size; ++i) {
+      contents[i] = static_cast<char>(path.size() + i);
+    }
+    files_[path] = contents;
+  }
+
+  //! Causes reads of `path` to block until Unblock is called.
+  void Block(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocked_.insert(path);
+  }
+
+  void Unblock(const std::string &path) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      blocked_.erase(path);
+    }
+    changed_.notify_all();
+  }
+
+  //! Waits until a read of `path` has started.
+  bool WaitForReadStart(const std::string &path) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return changed_.wait_for(lock, std::chrono::seconds(5), [this, &path]() { return reads_.count(path) > 0; });
+  }
+
+  uint32_t ReadCount(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = reads_.find(path);
+    return it == reads_.end() ? 0 : it->second;
+  }
+
+  std::string Contents(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return files_[path];
+  }
+
+  bool GetSize(const std::string &path, uint32_t &size) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(path);
+    if (it == files_.end()) {
+      return false;
+    }
+    size = it->second.size();
+    return true;
+  }
+
+  bool Read(const std::string &path, uint8_t *buffer, uint32_t size) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++reads_[path];
+    changed_.notify_all();
+    changed_.wait(lock, [this, &path]() { return !blocked_.count(path); });
+
+    auto it = files_.find(path);
+    if (it == files_.end() || it->second.size() != size) {
+      return false;
+    }
+    memcpy(buffer, it->second.data(), size);
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::map<std::string, std::string> files_;
+  std::map<std::string, uint32_t> reads_;
+  std::set<std::string> blocked_;
+};
+
+class ResourcePrefetcherTest : public ::testing::Test {
+ protected:
+  void Create(uint32_t budget) {
+    auto source = std::make_unique<FakeFileSource>();
+    source_ = source.get();
+    source_->AddFile("d:\\a", 40);
+    source_->AddFile("d:\\b", 40);
+    source_->AddFile("d:\\c", 40);
+    source_->AddFile("d:\\large", 4096);
+    prefetcher_ = std::make_unique<ResourcePrefetcher>(budget, std::move(source));
+  }
+
+  //! Polls until `condition` holds, as the worker runs asynchronously.
+  static bool WaitFor(const std::function<bool()> &condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  bool WaitForBytesHeld(uint32_t bytes) {
+    return WaitFor([this, bytes]() { return prefetcher_->BytesHeld() == bytes; });
+  }
+
+  std::string AsString(const ResourcePrefetcher::Resource &resource) {
+    return {reinterpret_cast<const char *>(resource.data()), resource.size};
+  }
+
+  FakeFileSource *source_{nullptr};
+  std::unique_ptr<ResourcePrefetcher> prefetcher_;
+};
+
+}  // namespace
+
+TEST_F(ResourcePrefetcherTest, HandsOffPrefetchedContents) {
+  Create(1024);
+  prefetcher_->Schedule({"d:\\a", "d:\\b"});
+  ASSERT_TRUE(WaitForBytesHeld(80));
+
+  ResourcePrefetcher::Resource resource;
+  ASSERT_TRUE(prefetcher_->Take("d:\\a", resource));
+  EXPECT_EQ(AsString(resource), source_->Contents("d:\\a"));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(resource.data()) % sizeof(uint32_t), 0);
+  EXPECT_EQ(prefetcher_->BytesHeld(), 40);
+
+  // Ownership was transferred, so a second claim must read the file itself.
+  EXPECT_FALSE(prefetcher_->Take("d:\\a", resource));
+  EXPECT_FALSE(prefetcher_->Take("d:\\unscheduled", resource));
+
+  auto stats = prefetcher_->GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.bytes_read, 80);
+  EXPECT_EQ(source_->ReadCount("d:\\a"), 1);
+}
+
+TEST_F(ResourcePrefetcherTest, HeldMemoryIsBoundedByBudget) {
+  Create(100);
+  prefetcher_->Schedule({"d:\\a", "d:\\b", "d:\\c"});
+  ASSERT_TRUE(WaitForBytesHeld(80));
+
+  // The third file does not fit until one of the first two is claimed.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(source_->ReadCount("d:\\c"), 0);
+
+  ResourcePrefetcher::Resource resource;
+  ASSERT_TRUE(prefetcher_->Take("d:\\b", resource));
+  ASSERT_TRUE(WaitForBytesHeld(80));
+  ASSERT_TRUE(prefetcher_->Take("d:\\c", resource));
+  EXPECT_EQ(AsString(resource), source_->Contents("d:\\c"));
+  EXPECT_LE(prefetcher_->GetStats().peak_bytes_held, 100);
+}
+
+TEST_F(ResourcePrefetcherTest, SkipsFilesThatCanNeverFit) {
+  Create(1024);
+  prefetcher_->Schedule({"d:\\large", "d:\\missing", "d:\\a"});
+  ASSERT_TRUE(WaitForBytesHeld(40));
+
+  ResourcePrefetcher::Resource resource;
+  EXPECT_FALSE(prefetcher_->Take("d:\\large", resource));
+  EXPECT_FALSE(prefetcher_->Take("d:\\missing", resource));
+  EXPECT_TRUE(prefetcher_->Take("d:\\a", resource));
+  EXPECT_EQ(source_->ReadCount("d:\\large"), 0);
+}
+
+TEST_F(ResourcePrefetcherTest, ScheduleDiscardsUnclaimedFiles) {
+  Create(1024);
+  prefetcher_->Schedule({"d:\\a", "d:\\b"});
+  ASSERT_TRUE(WaitForBytesHeld(80));
+
+  prefetcher_->Schedule({"d:\\c"});
+  ASSERT_TRUE(WaitForBytesHeld(40));
+
+  ResourcePrefetcher::Resource resource;
+  EXPECT_FALSE(prefetcher_->Take("d:\\a", resource));
+  EXPECT_TRUE(prefetcher_->Take("d:\\c", resource));
+  EXPECT_EQ(prefetcher_->GetStats().discarded, 2);
+  EXPECT_EQ(prefetcher_->BytesHeld(), 0);
+}
+
+TEST_F(ResourcePrefetcherTest, TakeWaitsForInFlightRead) {
+  Create(1024);
+  source_->Block("d:\\a");
+  prefetcher_->Schedule({"d:\\a"});
+  ASSERT_TRUE(source_->WaitForReadStart("d:\\a"));
+
+  std::thread unblocker([this]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    source_->Unblock("d:\\a");
+  });
+
+  ResourcePrefetcher::Resource resource;
+  EXPECT_TRUE(prefetcher_->Take("d:\\a", resource));
+  EXPECT_EQ(AsString(resource), source_->Contents("d:\\a"));
+  unblocker.join();
+}
+
+TEST_F(ResourcePrefetcherTest, TakeCancelsQueuedRead) {
+  Create(1024);
+  source_->Block("d:\\a");
+  prefetcher_->Schedule({"d:\\a", "d:\\b"});
+  ASSERT_TRUE(source_->WaitForReadStart("d:\\a"));
+
+  // The consumer must not wait behind an unrelated read, so it reads "b" itself.
+  ResourcePrefetcher::Resource resource;
+  EXPECT_FALSE(prefetcher_->Take("d:\\b", resource));
+
+  source_->Unblock("d:\\a");
+  ASSERT_TRUE(WaitForBytesHeld(40));
+  EXPECT_TRUE(prefetcher_->Take("d:\\a", resource));
+  EXPECT_EQ(source_->ReadCount("d:\\b"), 0);
+}
+
+TEST_F(ResourcePrefetcherTest, ReadInFlightDuringScheduleIsDiscarded) {
+  Create(1024);
+  source_->Block("d:\\a");
+  prefetcher_->Schedule({"d:\\a"});
+  ASSERT_TRUE(source_->WaitForReadStart("d:\\a"));
+
+  prefetcher_->Schedule({"d:\\b"});
+  source_->Unblock("d:\\a");
+  ASSERT_TRUE(WaitFor([this]() { return prefetcher_->GetStats().discarded == 1; }));
+  ASSERT_TRUE(WaitForBytesHeld(40));
+
+  ResourcePrefetcher::Resource resource;
+  EXPECT_FALSE(prefetcher_->Take("d:\\a", resource));
+  EXPECT_TRUE(prefetcher_->Take("d:\\b", resource));
+}
+
+TEST_F(ResourcePrefetcherTest, DestructionStopsWorkerWaitingForBudget) {
+  Create(60);
+  prefetcher_->Schedule({"d:\\a", "d:\\b"});
+  ASSERT_TRUE(WaitForBytesHeld(40));
+  prefetcher_.reset();
+}
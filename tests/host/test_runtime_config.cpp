@@ -1,6 +1,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstdio>
+
 #include "configure.h"
 #include "runtime_config.h"
 #include "test_host.h"
@@ -36,8 +39,11 @@ TEST(RuntimeConfig, DumpConfigBuffer_DefaultSettings) {
     "enable_shutdown_on_completion": false,
     "enable_pgraph_region_diff": false,
     "skip_tests_by_default": false,
+    "enable_capture_fence": true,
     "delay_milliseconds_between_tests": 0,
     "delay_milliseconds_before_exit": 4000,
+    "watchdog_budget_milliseconds": 120000,
+    "determinism_check_iterations": 0,
     "network": {
       "enable": false,
       "config_automatic": false,
@@ -90,6 +96,7 @@ TEST(RuntimeConfig, DumpConfigBuffer_ModifiedSettings) {
       "enable_shutdown_on_completion": true,
       "enable_pgraph_region_diff": true,
       "skip_tests_by_default": true,
+      "enable_capture_fence": false,
       "delay_milliseconds_between_tests": 10,
       "network": {
         "enable": true,
@@ -131,8 +138,11 @@ TEST(RuntimeConfig, DumpConfigBuffer_ModifiedSettings) {
     "enable_shutdown_on_completion": true,
     "enable_pgraph_region_diff": true,
     "skip_tests_by_default": true,
+    "enable_capture_fence": false,
     "delay_milliseconds_between_tests": 10,
     "delay_milliseconds_before_exit": 4000,
+    "watchdog_budget_milliseconds": 120000,
+    "determinism_check_iterations": 0,
     "network": {
       "enable": true,
       "config_automatic": true,
@@ -225,8 +235,11 @@ TEST(RuntimeConfig, DumpConfigBuffer_NetworkMode_Static) {
     "enable_shutdown_on_completion": true,
     "enable_pgraph_region_diff": true,
     "skip_tests_by_default": true,
+    "enable_capture_fence": true,
     "delay_milliseconds_between_tests": 10,
     "delay_milliseconds_before_exit": 4000,
+    "watchdog_budget_milliseconds": 120000,
+    "determinism_check_iterations": 0,
     "network": {
       "enable": true,
       "config_automatic": false,
@@ -311,8 +324,11 @@ TEST(RuntimeConfig, DumpConfigBuffer_NetworkMode_DHCP) {
     "enable_shutdown_on_completion": true,
     "enable_pgraph_region_diff": true,
     "skip_tests_by_default": true,
+    "enable_capture_fence": true,
     "delay_milliseconds_between_tests": 10,
     "delay_milliseconds_before_exit": 4000,
+    "watchdog_budget_milliseconds": 120000,
+    "determinism_check_iterations": 0,
     "network": {
       "enable": true,
       "config_automatic": false,
@@ -387,8 +403,11 @@ TEST(RuntimeConfig, DumpConfigBuffer_FilteredTests_SkipByDefaultEnabled) {
     "enable_shutdown_on_completion": true,
     "enable_pgraph_region_diff": true,
     "skip_tests_by_default": true,
+    "enable_capture_fence": true,
     "delay_milliseconds_between_tests": 10,
     "delay_milliseconds_before_exit": 4000,
+    "watchdog_budget_milliseconds": 120000,
+    "determinism_check_iterations": 0,
     "network": {
       "enable": false,
       "config_automatic": false,
@@ -476,8 +495,11 @@ TEST(RuntimeConfig, DumpConfigBuffer_FilteredTests_SkipByDefaultDisabled) {
     "enable_shutdown_on_completion": true,
     "enable_pgraph_region_diff": true,
     "skip_tests_by_default": false,
+    "enable_capture_fence": true,
     "delay_milliseconds_between_tests": 10,
     "delay_milliseconds_before_exit": 4000,
+    "watchdog_budget_milliseconds": 120000,
+    "determinism_check_iterations": 0,
     "network": {
       "enable": false,
       "config_automatic": false,
@@ -522,6 +544,51 @@ TEST(RuntimeConfig, DumpConfigBuffer_FilteredTests_SkipByDefaultDisabled) {
 )");
 }
 
+TEST(RuntimeConfig, DumpConfigBuffer_Patterns) {
+  RuntimeConfig config;
+  std::vector<std::string> errors;
+  PopulateConfig(config, R"({
+    "test_suites": {
+      "Suite_*::*_2": { "skipped": true },
+      "Suite_1": { "skipped": false },
+      "Suite_1::Test_?": { "skipped": false }
+    }
+  })");
+
+  std::stringstream output;
+  std::shared_ptr<FTPLogger> no_logger;
+  TestHost host(no_logger, 1024, 768, 32, 32);
+  auto test_suite_config = TestSuite::Config{false, false};
+  std::vector suites = {
+      std::make_shared<TestSuite>(host, "/dev/null", "Suite_1", test_suite_config),
+  };
+
+  EXPECT_TRUE(config.DumpConfigToStream(output, suites, errors));
+  EXPECT_TRUE(errors.empty());
+  auto dumped = output.str();
+  auto test_suites = dumped.find(R"(  "test_suites": {)");
+  ASSERT_NE(test_suites, std::string::npos);
+  EXPECT_STREQ(dumped.c_str() + test_suites, R"(  "test_suites": {
+    "Suite_1": {
+      "skipped": false,
+      "Test_1": {
+      },
+      "Test_2": {
+      },
+      "Test_3": {
+      }
+    },
+    "Suite_*::*_2": {
+      "skipped": true
+    },
+    "Suite_1::Test_?": {
+      "skipped": false
+    }
+  }
+}
+)");
+}
+
 #else  // ifdef DUMP_CONFIG_FILE
 
 static std::vector<std::string> FlattenEnabledTests(std::vector<std::shared_ptr<TestSuite> >& suites);
@@ -535,6 +602,17 @@ TEST(RuntimeConfig, LoadConfigBuffer_InvalidBuffer) {
   EXPECT_STREQ(errors.at(0).c_str(), "Failed to parse config file.");
 }
 
+TEST(RuntimeConfig, LoadConfigBuffer_NestedContainers) {
+  RuntimeConfig config;
+  std::vector<std::string> errors;
+
+  // Every node must fit within the parser's preallocated pool, including those of empty and deeply nested containers.
+  EXPECT_TRUE(config.LoadConfigBuffer(
+      R"({"settings":{"network":{}},"unused":[[],[1,[2,{}],{"a":[[[]]]}],"",{}],"test_suites":{"S":{"T":{}}}})",
+      errors));
+  EXPECT_TRUE(errors.empty());
+}
+
 TEST(RuntimeConfig, LoadConfigBuffer_NoSettings) {
   RuntimeConfig config;
   std::vector<std::string> errors;
@@ -566,6 +644,7 @@ TEST(RuntimeConfig, LoadConfigBuffer_SettingsEmpty) {
   EXPECT_EQ(config.enable_shutdown_on_completion(), DEFAULT_ENABLE_SHUTDOWN);
   EXPECT_EQ(config.enable_pgraph_region_diff(), DEFAULT_ENABLE_PGRAPH_REGION_DIFF);
   EXPECT_EQ(config.skip_tests_by_default(), DEFAULT_SKIP_TESTS_BY_DEFAULT);
+  EXPECT_EQ(config.enable_capture_fence(), DEFAULT_ENABLE_CAPTURE_FENCE);
   EXPECT_EQ(config.output_directory_path(), RuntimeConfig::SanitizePath(DEFAULT_OUTPUT_DIRECTORY_PATH));
 }
 
@@ -632,6 +711,15 @@ TEST(RuntimeConfig, LoadConfigBuffer_InvalidSkipTestsByDefault) {
   EXPECT_STREQ(errors.at(0).c_str(), "settings[skip_tests_by_default] must be a boolean");
 }
 
+TEST(RuntimeConfig, LoadConfigBuffer_InvalidEnableCaptureFence) {
+  RuntimeConfig config;
+  std::vector<std::string> errors;
+
+  EXPECT_FALSE(config.LoadConfigBuffer("{\"settings\": {\"enable_capture_fence\": 1}}", errors));
+  EXPECT_EQ(errors.size(), 1);
+  EXPECT_STREQ(errors.at(0).c_str(), "settings[enable_capture_fence] must be a boolean");
+}
+
 TEST(RuntimeConfig, LoadConfigBuffer_InvalidDelayMillisecondsBetweenTests_NonInteger) {
   RuntimeConfig config;
   std::vector<std::string> errors;
@@ -677,6 +765,24 @@ TEST(RuntimeConfig, LoadConfigBuffer_InvalidDelayMillisecondsBeforeExit_Negative
   EXPECT_STREQ(errors.at(0).c_str(), "settings[delay_milliseconds_before_exit] must be a non-negative integer");
 }
 
+TEST(RuntimeConfig, LoadConfigBuffer_InvalidWatchdogBudgetMilliseconds) {
+  RuntimeConfig config;
+  std::vector<std::string> errors;
+
+  EXPECT_FALSE(config.LoadConfigBuffer("{\"settings\": {\"watchdog_budget_milliseconds\": -1}}", errors));
+  EXPECT_EQ(errors.size(), 1);
+  EXPECT_STREQ(errors.at(0).c_str(), "settings[watchdog_budget_milliseconds] must be a non-negative integer");
+}
+
+TEST(RuntimeConfig, LoadConfigBuffer_InvalidDeterminismCheckIterations) {
+  RuntimeConfig config;
+  std::vector<std::string> errors;
+
+  EXPECT_FALSE(config.LoadConfigBuffer("{\"settings\": {\"determinism_check_iterations\": \"3\"}}", errors));
+  EXPECT_EQ(errors.size(), 1);
+  EXPECT_STREQ(errors.at(0).c_str(), "settings[determinism_check_iterations] must be a non-negative integer");
+}
+
 TEST(RuntimeConfig, LoadConfigBuffer_InvalidDelayMillisecondsBeforeExitTests) {
   RuntimeConfig config;
   std::vector<std::string> errors;
@@ -1102,6 +1208,93 @@ TEST(RuntimeConfig, ApplyConfig_TestCaseExplicitDisableWithinEnabledSuite_Defaul
   ASSERT_THAT(FlattenEnabledTests(suites), ElementsAre("Suite_2::Test_2", "Suite_2::Test_3"));
 }
 
+static std::vector<std::shared_ptr<TestSuite>> ApplyPatternConfig(const std::string& json) {
+  RuntimeConfig config;
+  PopulateConfig(config, json);
+  std::shared_ptr<FTPLogger> no_logger;
+  static TestHost host(no_logger, 1024, 768, 32, 32);
+  auto test_suite_config = TestSuite::Config{false, false};
+  std::vector<std::shared_ptr<TestSuite>> suites = {
+      std::make_shared<TestSuite>(host, "/dev/null", "Fog_1", test_suite_config),
+      std::make_shared<TestSuite>(host, "/dev/null", "Fog_2", test_suite_config),
+      std::make_shared<TestSuite>(host, "/dev/null", "Lighting", test_suite_config),
+  };
+  std::vector<std::string> errors;
+
+  EXPECT_TRUE(config.ApplyConfig(suites, errors));
+  EXPECT_TRUE(errors.empty());
+  return suites;
+}
+
+TEST(RuntimeConfig, ApplyConfig_PatternSkipsMatchingTests) {
+  auto suites = ApplyPatternConfig(R"({
+    "settings": {},
+    "test_suites": {
+      "Fog*::*_[12]": { "skipped": true },
+      "Lighting": { "skipped": true }
+    }
+  })");
+  ASSERT_THAT(FlattenEnabledTests(suites), ElementsAre("Fog_1::Test_3", "Fog_2::Test_3"));
+}
+
+TEST(RuntimeConfig, ApplyConfig_PatternUnskipsMatchingTests_DefaultSkipped) {
+  auto suites = ApplyPatternConfig(R"({
+    "settings": { "skip_tests_by_default": true },
+    "test_suites": {
+      "*::Test_2": { "skipped": false }
+    }
+  })");
+  ASSERT_THAT(FlattenEnabledTests(suites), ElementsAre("Fog_1::Test_2", "Fog_2::Test_2", "Lighting::Test_2"));
+}
+
+TEST(RuntimeConfig, ApplyConfig_LaterPatternTakesPrecedence) {
+  auto suites = ApplyPatternConfig(R"({
+    "settings": {},
+    "test_suites": {
+      "Fog*": { "skipped": true },
+      "Fog_2::*": { "skipped": false },
+      "*::Test_1": { "skipped": true }
+    }
+  })");
+  ASSERT_THAT(FlattenEnabledTests(suites), ElementsAre("Fog_2::Test_2", "Fog_2::Test_3", "Lighting::Test_2",
+                                                       "Lighting::Test_3"));
+}
+
+TEST(RuntimeConfig, ApplyConfig_PatternPrecedenceRelativeToExactNames) {
+  // Exact test case entries override patterns, which in turn override exact suite entries.
+  auto suites = ApplyPatternConfig(R"({
+    "settings": {},
+    "test_suites": {
+      "Fog_1": {
+        "skipped": true,
+        "Test_3": { "skipped": true }
+      },
+      "Fog_1::Test_[23]": { "skipped": false }
+    }
+  })");
+  ASSERT_THAT(FlattenEnabledTests(suites), ElementsAre("Fog_1::Test_2", "Fog_2::Test_1", "Fog_2::Test_2",
+                                                       "Fog_2::Test_3", "Lighting::Test_1", "Lighting::Test_2",
+                                                       "Lighting::Test_3"));
+}
+
+TEST(RuntimeConfig, LoadConfigBuffer_InvalidPattern) {
+  RuntimeConfig config;
+  std::vector<std::string> errors;
+
+  EXPECT_FALSE(config.LoadConfigBuffer(R"({"settings": {}, "test_suites": {"Fog[12": {"skipped": true}}})", errors));
+  EXPECT_EQ(errors.size(), 1);
+  EXPECT_STREQ(errors.at(0).c_str(), "test_suites[Fog[12] is not a valid pattern: unterminated character class");
+}
+
+TEST(RuntimeConfig, LoadConfigBuffer_InvalidPatternSkipped) {
+  RuntimeConfig config;
+  std::vector<std::string> errors;
+
+  EXPECT_FALSE(config.LoadConfigBuffer(R"({"settings": {}, "test_suites": {"Fog*": {"skipped": 1}}})", errors));
+  EXPECT_EQ(errors.size(), 1);
+  EXPECT_STREQ(errors.at(0).c_str(), "test_suites[Fog*][skipped] must be a boolean");
+}
+
 TEST(RuntimeConfig, LoadConfigBuffer_InvalidShardingNotObject) {
   RuntimeConfig config;
   std::vector<std::string> errors;
@@ -1186,6 +1379,63 @@ TEST(RuntimeConfig, LoadConfigBuffer_ValidShardConfig) {
   EXPECT_EQ(config.shard_count(), 3);
 }
 
+//! Suite with an arbitrary number of no-op tests named "T<index>".
+class GeneratedTestSuite : public TestSuite {
+ public:
+  GeneratedTestSuite(TestHost& host, const std::string& name, uint32_t num_tests)
+      : TestSuite(host, "/dev/null", name, Config{false, false}) {
+    tests_.clear();
+    for (uint32_t i = 0; i < num_tests; ++i) {
+      tests_["T" + std::to_string(i)] = []() {};
+    }
+  }
+};
+
+TEST(RuntimeConfig, Benchmark_LoadAndApply50K) {
+  static constexpr uint32_t kNumSuites = 50;
+  static constexpr uint32_t kTestsPerSuite = 1000;
+
+  // Every other test case is explicitly skipped.
+  std::string json = R"({"settings":{"skip_tests_by_default":false},"test_suites":{)";
+  for (uint32_t suite = 0; suite < kNumSuites; ++suite) {
+    json += (suite ? ",\"S" : "\"S") + std::to_string(suite) + "\":{";
+    for (uint32_t test = 0; test < kTestsPerSuite; ++test) {
+      json += (test ? ",\"T" : "\"T") + std::to_string(test);
+      json += test & 1 ? R"(":{"skipped":true})" : R"(":{"skipped":false})";
+    }
+    json += "}";
+  }
+  json += "}}";
+
+  std::shared_ptr<FTPLogger> no_logger;
+  TestHost host(no_logger, 1024, 768, 32, 32);
+  std::vector<std::shared_ptr<TestSuite>> suites;
+  for (uint32_t suite = 0; suite < kNumSuites; ++suite) {
+    suites.push_back(std::make_shared<GeneratedTestSuite>(host, "S" + std::to_string(suite), kTestsPerSuite));
+  }
+
+  RuntimeConfig config;
+  std::vector<std::string> errors;
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(config.LoadConfigBuffer(json, errors));
+  auto loaded = std::chrono::steady_clock::now();
+  ASSERT_TRUE(config.ApplyConfig(suites, errors));
+  auto applied = std::chrono::steady_clock::now();
+  EXPECT_TRUE(errors.empty());
+
+  size_t num_enabled = 0;
+  for (auto& suite : suites) {
+    num_enabled += suite->TestNames().size();
+  }
+  EXPECT_EQ(num_enabled, kNumSuites * kTestsPerSuite / 2);
+
+  auto to_ms = [](auto duration) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()) / 1000.0;
+  };
+  printf("Config with %u test cases (%u bytes): load %.1f ms, apply %.1f ms\n", kNumSuites * kTestsPerSuite,
+         static_cast<uint32_t>(json.size()), to_ms(loaded - start), to_ms(applied - loaded));
+}
+
 static std::vector<std::string> FlattenEnabledTests(std::vector<std::shared_ptr<TestSuite> >& suites) {
   std::vector<std::string> ret;
   for (auto& suite : suites) {
@@ -1211,6 +1461,8 @@ TestHost::TestHost(std::shared_ptr<FTPLogger> ftp_logger, uint32_t framebuffer_w
                    uint32_t max_texture_width, uint32_t max_texture_height, uint32_t max_texture_depth)
     : PBKitPlusPlus::NV2AState() {}
 
+TestHost::~TestHost() = default;
+
 static void NoOpTestBody() {}
 
 TestSuite::TestSuite(TestHost& host, std::string output_dir, std::string suite_name, const Config& config,
@@ -1248,4 +1500,4 @@ void TestSuite::SetupTest() {}
 void TestSuite::TearDownTest() {}
 
 PGRAPHDiffToken::PGRAPHDiffToken(bool initialize, bool enable_progress_log)
-    : registers{0}, enable_progress_log{enable_progress_log} {}
+    : registers{0}, fetched_registers{0}, enable_progress_log{enable_progress_log} {}
@@ -0,0 +1,420 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <pbkit/nv_regs.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "reference/draw_extractor.h"
+#include "reference/software_rasterizer.h"
+
+static constexpr uint32_t kRed = 0xFFFF0000;
+static constexpr uint32_t kBlack = 0xFF000000;
+
+static SoftwareRasterizer::Vertex MakeVertex(float x, float y, const float (&rgba)[4]) {
+  return {x, y, 0.0f, 1.0f, {rgba[0], rgba[1], rgba[2], rgba[3]}};
+}
+
+static void DrawQuad(SoftwareRasterizer &rasterizer, float left, float top, float right, float bottom,
+                     const float (&rgba)[4]) {
+  auto ul = MakeVertex(left, top, rgba);
+  auto ur = MakeVertex(right, top, rgba);
+  auto lr = MakeVertex(right, bottom, rgba);
+  auto ll = MakeVertex(left, bottom, rgba);
+  rasterizer.DrawTriangle(ul, ur, lr);
+  rasterizer.DrawTriangle(ul, lr, ll);
+}
+
+//! Returns the inclusive bounds of the pixels that do not match `background`, or false if there are none.
+static bool CoveredBounds(const SoftwareRasterizer &rasterizer, uint32_t background, int &left, int &top, int &right,
+                          int &bottom) {
+  left = top = INT32_MAX;
+  right = bottom = -1;
+  for (uint32_t y = 0; y < rasterizer.height(); ++y) {
+    for (uint32_t x = 0; x < rasterizer.width(); ++x) {
+      if (rasterizer.pixels()[y * rasterizer.width() + x] != background) {
+        left = std::min(left, static_cast<int>(x));
+        right = std::max(right, static_cast<int>(x));
+        top = std::min(top, static_cast<int>(y));
+        bottom = std::max(bottom, static_cast<int>(y));
+      }
+    }
+  }
+  return right >= 0;
+}
+
+TEST(SoftwareRasterizer, IntegerQuadCoversHalfOpenRange) {
+  static constexpr float kRedRGBA[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+  SoftwareRasterizer rasterizer(32, 32, 1);
+  rasterizer.Clear(kBlack);
+  DrawQuad(rasterizer, 0.0f, 0.0f, 10.0f, 10.0f, kRedRGBA);
+  rasterizer.Flush();
+
+  int left, top, right, bottom;
+  ASSERT_TRUE(CoveredBounds(rasterizer, kBlack, left, top, right, bottom));
+  EXPECT_EQ(left, 0);
+  EXPECT_EQ(top, 0);
+  EXPECT_EQ(right, 9);
+  EXPECT_EQ(bottom, 9);
+  EXPECT_EQ(rasterizer.pixels()[5 * 32 + 5], kRed);
+}
+
+TEST(SoftwareRasterizer, EdgesThroughPixelCentersFollowTopLeftRule) {
+  static constexpr float kRedRGBA[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+  SoftwareRasterizer rasterizer(32, 32, 1);
+  rasterizer.Clear(kBlack);
+  // Every edge passes exactly through a row or column of pixel centers. The left and top edges own those samples, the
+  // right and bottom edges do not.
+  DrawQuad(rasterizer, 2.5f, 3.5f, 12.5f, 13.5f, kRedRGBA);
+  rasterizer.Flush();
+
+  int left, top, right, bottom;
+  ASSERT_TRUE(CoveredBounds(rasterizer, kBlack, left, top, right, bottom));
+  EXPECT_EQ(left, 2);
+  EXPECT_EQ(top, 3);
+  EXPECT_EQ(right, 11);
+  EXPECT_EQ(bottom, 12);
+}
+
+TEST(SoftwareRasterizer, SnapsToSubpixelGrid) {
+  EXPECT_EQ(SoftwareRasterizer::SnapToSubpixel(1.0f), 16);
+  EXPECT_EQ(SoftwareRasterizer::SnapToSubpixel(1.03f), 16);
+  EXPECT_EQ(SoftwareRasterizer::SnapToSubpixel(1.04f), 17);
+  EXPECT_EQ(SoftwareRasterizer::SnapToSubpixel(-0.5f), -8);
+}
+
+TEST(SoftwareRasterizer, SharedEdgesAreCoveredExactlyOnce) {
+  // Rasterizes each triangle of a fan around an off-grid center separately and counts how many triangles cover each
+  // pixel. Pixels on shared edges must be claimed by exactly one of the neighbors.
+  static constexpr uint32_t kSize = 64;
+  static constexpr float kCenter[2] = {31.3f, 30.7f};
+  static constexpr uint32_t kSegments = 13;
+
+  std::vector<uint32_t> coverage(kSize * kSize, 0);
+  std::vector<std::pair<float, float>> ring;
+  for (uint32_t i = 0; i < kSegments; ++i) {
+    const float angle = static_cast<float>(i) * 2.0f * 3.14159265f / kSegments;
+    ring.emplace_back(kCenter[0] + 25.0f * std::cos(angle), kCenter[1] + 25.0f * std::sin(angle));
+  }
+
+  static constexpr float kWhite[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+  for (uint32_t i = 0; i < kSegments; ++i) {
+    SoftwareRasterizer rasterizer(kSize, kSize, 1);
+    rasterizer.Clear(kBlack);
+    const auto &a = ring[i];
+    const auto &b = ring[(i + 1) % kSegments];
+    rasterizer.DrawTriangle(MakeVertex(kCenter[0], kCenter[1], kWhite), MakeVertex(a.first, a.second, kWhite),
+                            MakeVertex(b.first, b.second, kWhite));
+    rasterizer.Flush();
+    for (uint32_t p = 0; p < coverage.size(); ++p) {
+      coverage[p] += rasterizer.pixels()[p] != kBlack;
+    }
+  }
+
+  uint32_t covered = 0;
+  for (auto count : coverage) {
+    ASSERT_LE(count, 1U);
+    covered += count;
+  }
+  EXPECT_GT(covered, 1000U);
+}
+
+TEST(SoftwareRasterizer, InterpolatesVertexColors) {
+  SoftwareRasterizer rasterizer(16, 16, 1);
+  static constexpr float kRedRGBA[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+  static constexpr float kBlue[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+  auto ul = MakeVertex(0.0f, 0.0f, kRedRGBA);
+  auto ur = MakeVertex(16.0f, 0.0f, kBlue);
+  auto lr = MakeVertex(16.0f, 16.0f, kBlue);
+  auto ll = MakeVertex(0.0f, 16.0f, kRedRGBA);
+  rasterizer.DrawTriangle(ul, ur, lr);
+  rasterizer.DrawTriangle(ul, lr, ll);
+  rasterizer.Flush();
+
+  // Pixel centers sit 1/32 of the way in from each edge, allowing for one unit of rounding error.
+  auto near = [](uint32_t actual, uint32_t expected) {
+    for (auto shift : {0, 8, 16, 24}) {
+      const int delta = static_cast<int>((actual >> shift) & 0xFF) - static_cast<int>((expected >> shift) & 0xFF);
+      if (delta < -1 || delta > 1) {
+        return false;
+      }
+    }
+    return true;
+  };
+  EXPECT_PRED2(near, rasterizer.pixels()[8 * 16 + 0], 0xFFF80008);
+  EXPECT_PRED2(near, rasterizer.pixels()[8 * 16 + 15], 0xFF0800F8);
+}
+
+TEST(SoftwareRasterizer, OutputIsIndependentOfThreadCount) {
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> center_x(-20.0f, 660.0f);
+  std::uniform_real_distribution<float> center_y(-20.0f, 500.0f);
+  std::uniform_real_distribution<float> offset(-40.0f, 40.0f);
+  std::uniform_real_distribution<float> channel(0.0f, 1.0f);
+
+  struct Triangle {
+    SoftwareRasterizer::Vertex v[3];
+  };
+  std::vector<Triangle> triangles(2000);
+  for (auto &triangle : triangles) {
+    const float x = center_x(rng);
+    const float y = center_y(rng);
+    for (auto &vertex : triangle.v) {
+      vertex = {x + offset(rng), y + offset(rng), 0.0f, 1.0f, {channel(rng), channel(rng), channel(rng), 1.0f}};
+    }
+  }
+
+  auto render = [&triangles](uint32_t num_threads, uint32_t tile_size) {
+    SoftwareRasterizer rasterizer(640, 480, num_threads, tile_size);
+    rasterizer.Clear(kBlack);
+    for (const auto &triangle : triangles) {
+      rasterizer.DrawTriangle(triangle.v[0], triangle.v[1], triangle.v[2]);
+    }
+    rasterizer.Clear(kRed, 100, 100, 119, 109);
+    rasterizer.Flush();
+    return rasterizer.pixels();
+  };
+
+  const auto expected = render(1, 640);
+  EXPECT_EQ(render(4, 64), expected);
+  EXPECT_EQ(render(8, 32), expected);
+}
+
+TEST(SoftwareRasterizer, Benchmark8KQuads) {
+  static constexpr uint32_t kNumQuads = 8192;
+  static constexpr float kColor[4] = {0.25f, 0.5f, 0.75f, 1.0f};
+  SoftwareRasterizer rasterizer(640, 480);
+
+  // A grid of 8x4 pixel quads tiles the entire framebuffer at roughly one quad per 38 pixels.
+  auto submit = [&rasterizer]() {
+    rasterizer.Clear(kBlack);
+    for (uint32_t i = 0; i < kNumQuads; ++i) {
+      const auto x = static_cast<float>((i % 80) * 8);
+      const auto y = static_cast<float>(((i / 80) * 4) % 480);
+      DrawQuad(rasterizer, x, y, x + 8.0f, y + 4.0f, kColor);
+    }
+  };
+
+  submit();
+  rasterizer.Flush();
+
+  static constexpr uint32_t kIterations = 20;
+  std::chrono::nanoseconds elapsed{0};
+  for (uint32_t i = 0; i < kIterations; ++i) {
+    submit();
+    const auto start = std::chrono::steady_clock::now();
+    rasterizer.Flush();
+    elapsed += std::chrono::steady_clock::now() - start;
+  }
+
+  const auto average_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / kIterations;
+  printf("Rasterized %u quads at 640x480 in %lld us\n", kNumQuads, static_cast<long long>(average_us));
+  EXPECT_NE(rasterizer.pixels()[240 * 640 + 320], kBlack);
+}
+
+static uint32_t FloatBits(float value) {
+  uint32_t ret;
+  memcpy(&ret, &value, sizeof(ret));
+  return ret;
+}
+
+TEST(DrawExtractor, ReplaysImmediateModeQuadsAndClears) {
+  SoftwareRasterizer rasterizer(32, 32, 1);
+  DrawExtractor extractor(rasterizer);
+
+  extractor.Process(NV097_SET_COLOR_CLEAR_VALUE, kBlack);
+  extractor.Process(NV097_SET_CLEAR_RECT_HORIZONTAL, (31 << 16) | 0);
+  extractor.Process(NV097_SET_CLEAR_RECT_VERTICAL, (31 << 16) | 0);
+  extractor.Process(NV097_CLEAR_SURFACE, NV097_CLEAR_SURFACE_COLOR);
+
+  extractor.Process(NV097_SET_BEGIN_END, NV097_SET_BEGIN_END_OP_QUADS);
+  // Diffuse components are (B, G, R, A).
+  const uint32_t diffuse = NV097_SET_VERTEX_DATA4F_M + DrawExtractor::kDiffuseAttribute * 16;
+  extractor.Process(diffuse + 0, FloatBits(0.0f));
+  extractor.Process(diffuse + 4, FloatBits(0.0f));
+  extractor.Process(diffuse + 8, FloatBits(1.0f));
+  extractor.Process(diffuse + 12, FloatBits(1.0f));
+  const float positions[4][2] = {{4.0f, 4.0f}, {8.0f, 4.0f}, {8.0f, 8.0f}, {4.0f, 8.0f}};
+  for (const auto &position : positions) {
+    extractor.Process(NV097_SET_VERTEX4F + 0, FloatBits(position[0]));
+    extractor.Process(NV097_SET_VERTEX4F + 4, FloatBits(position[1]));
+    extractor.Process(NV097_SET_VERTEX4F + 8, FloatBits(0.0f));
+    extractor.Process(NV097_SET_VERTEX4F + 12, FloatBits(1.0f));
+  }
+  extractor.Process(NV097_SET_BEGIN_END, NV097_SET_BEGIN_END_OP_END);
+  rasterizer.Flush();
+
+  EXPECT_EQ(extractor.num_triangles(), 2);
+  EXPECT_EQ(extractor.unsupported_draws(), 0);
+
+  int left, top, right, bottom;
+  ASSERT_TRUE(CoveredBounds(rasterizer, kBlack, left, top, right, bottom));
+  EXPECT_EQ(left, 4);
+  EXPECT_EQ(top, 4);
+  EXPECT_EQ(right, 7);
+  EXPECT_EQ(bottom, 7);
+  EXPECT_EQ(rasterizer.pixels()[5 * 32 + 5], kRed);
+}
+
+TEST(DrawExtractor, ReadsDrawArraysThroughMemoryReader) {
+  struct Vertex {
+    float position[3];
+    uint32_t diffuse;
+  };
+  // A single triangle strip forming an 8x8 quad, colored green via a D3D-ordered (B, G, R, A) diffuse.
+  const Vertex vertices[] = {
+      {{0.0f, 0.0f, 0.0f}, 0xFF00FF00},
+      {{8.0f, 0.0f, 0.0f}, 0xFF00FF00},
+      {{0.0f, 8.0f, 0.0f}, 0xFF00FF00},
+      {{8.0f, 8.0f, 0.0f}, 0xFF00FF00},
+  };
+  static constexpr uint32_t kVertexAddress = 0x1000;
+
+  SoftwareRasterizer rasterizer(16, 16, 1);
+  rasterizer.Clear(kBlack);
+  DrawExtractor extractor(rasterizer, [&vertices](uint32_t address, uint32_t size) -> const uint8_t * {
+    if (address < kVertexAddress || address + size > kVertexAddress + sizeof(vertices)) {
+      return nullptr;
+    }
+    return reinterpret_cast<const uint8_t *>(vertices) + (address - kVertexAddress);
+  });
+
+  auto format = [](uint32_t type, uint32_t size) { return type | (size << 4) | (sizeof(Vertex) << 8); };
+  extractor.Process(NV097_SET_VERTEX_DATA_ARRAY_FORMAT, format(DrawExtractor::TYPE_F, 3));
+  extractor.Process(NV097_SET_VERTEX_DATA_ARRAY_OFFSET, kVertexAddress);
+  extractor.Process(NV097_SET_VERTEX_DATA_ARRAY_FORMAT + DrawExtractor::kDiffuseAttribute * 4,
+                    format(DrawExtractor::TYPE_UB_D3D, 4));
+  extractor.Process(NV097_SET_VERTEX_DATA_ARRAY_OFFSET + DrawExtractor::kDiffuseAttribute * 4,
+                    kVertexAddress + offsetof(Vertex, diffuse));
+
+  extractor.Process(NV097_SET_BEGIN_END, NV097_SET_BEGIN_END_OP_TRIANGLE_STRIP);
+  extractor.Process(NV097_DRAW_ARRAYS, (3 << 24) | 0);
+  extractor.Process(NV097_SET_BEGIN_END, NV097_SET_BEGIN_END_OP_END);
+
+  // Points are not modeled and reading past the array fails; both are reported rather than drawn.
+  extractor.Process(NV097_SET_BEGIN_END, NV097_SET_BEGIN_END_OP_POINTS);
+  extractor.Process(NV097_DRAW_ARRAYS, 0);
+  extractor.Process(NV097_SET_BEGIN_END, NV097_SET_BEGIN_END_OP_END);
+  extractor.Process(NV097_SET_BEGIN_END, NV097_SET_BEGIN_END_OP_TRIANGLES);
+  extractor.Process(NV097_DRAW_ARRAYS, (2 << 24) | 2);
+  extractor.Process(NV097_SET_BEGIN_END, NV097_SET_BEGIN_END_OP_END);
+  rasterizer.Flush();
+
+  EXPECT_EQ(extractor.num_triangles(), 2);
+  EXPECT_EQ(extractor.unsupported_draws(), 2);
+
+  int left, top, right, bottom;
+  ASSERT_TRUE(CoveredBounds(rasterizer, kBlack, left, top, right, bottom));
+  EXPECT_EQ(left, 0);
+  EXPECT_EQ(top, 0);
+  EXPECT_EQ(right, 7);
+  EXPECT_EQ(bottom, 7);
+  EXPECT_EQ(rasterizer.pixels()[3 * 16 + 3], 0xFF00FF00);
+}
+
+TEST(SoftwareRasterizer, AlphaTestComparesQuantizedAlpha) {
+  static constexpr float kBelowRef[4] = {1.0f, 0.0f, 0.0f, 126.0f / 255.0f};
+  static constexpr float kAtRef[4] = {1.0f, 0.0f, 0.0f, 127.0f / 255.0f};
+
+  SoftwareRasterizer rasterizer(16, 16, 1);
+  rasterizer.Clear(kBlack);
+  SoftwareRasterizer::FragmentState state;
+  state.alpha_test = true;
+  state.alpha_func = SoftwareRasterizer::CompareFunc::GEQUAL;
+  state.alpha_ref = 0x7F;
+  rasterizer.SetFragmentState(state);
+  DrawQuad(rasterizer, 0.0f, 0.0f, 8.0f, 8.0f, kBelowRef);
+  DrawQuad(rasterizer, 8.0f, 0.0f, 16.0f, 8.0f, kAtRef);
+  rasterizer.Flush();
+
+  EXPECT_EQ(rasterizer.pixels()[4 * 16 + 4], kBlack);
+  EXPECT_EQ(rasterizer.pixels()[4 * 16 + 12], 0x7FFF0000);
+}
+
+TEST(SoftwareRasterizer, BlendsAgainstDestination) {
+  static constexpr float kHalfRed[4] = {1.0f, 0.0f, 0.0f, 0.5f};
+
+  SoftwareRasterizer rasterizer(16, 16, 1);
+  rasterizer.Clear(0xFF0000FF);
+  SoftwareRasterizer::FragmentState state;
+  state.blend = true;
+  state.src_factor = SoftwareRasterizer::BlendFactor::SRC_ALPHA;
+  state.dst_factor = SoftwareRasterizer::BlendFactor::ONE_MINUS_SRC_ALPHA;
+  rasterizer.SetFragmentState(state);
+  DrawQuad(rasterizer, 0.0f, 0.0f, 8.0f, 8.0f, kHalfRed);
+
+  state.equation = SoftwareRasterizer::BlendEquation::REVERSE_SUBTRACT;
+  state.src_factor = SoftwareRasterizer::BlendFactor::ONE;
+  state.dst_factor = SoftwareRasterizer::BlendFactor::ONE;
+  rasterizer.SetFragmentState(state);
+  DrawQuad(rasterizer, 8.0f, 0.0f, 16.0f, 8.0f, kHalfRed);
+  rasterizer.Flush();
+
+  // The source is quantized to 8 bits first, so its alpha is 0x80 / 255: 0x80 red over 0x7F blue, and alpha blends
+  // with the same factors to 0x80 * 0x80 / 255 + 0x7F.
+  EXPECT_EQ(rasterizer.pixels()[4 * 16 + 4], 0xBF80007F);
+  // Destination minus source, clamped at 0.
+  EXPECT_EQ(rasterizer.pixels()[4 * 16 + 12], 0x7F0000FF);
+  // Triangles queued before the state change keep the state they were queued with.
+  EXPECT_EQ(rasterizer.pixels()[12 * 16 + 4], 0xFF0000FF);
+}
+
+//! Draws an 8x8 quad at `left` whose alpha ramps from 0 to 1 across its width, as AlphaFuncTests does.
+static void DrawAlphaRamp(DrawExtractor &extractor, float left) {
+  const uint32_t diffuse = NV097_SET_VERTEX_DATA4F_M + DrawExtractor::kDiffuseAttribute * 16;
+  extractor.Process(NV097_SET_BEGIN_END, NV097_SET_BEGIN_END_OP_QUADS);
+  const float corners[4][3] = {{0.0f, 0.0f, 0.0f}, {8.0f, 0.0f, 1.0f}, {8.0f, 8.0f, 1.0f}, {0.0f, 8.0f, 0.0f}};
+  for (const auto &corner : corners) {
+    extractor.Process(diffuse + 0, FloatBits(1.0f));
+    extractor.Process(diffuse + 4, FloatBits(1.0f));
+    extractor.Process(diffuse + 8, FloatBits(1.0f));
+    extractor.Process(diffuse + 12, FloatBits(corner[2]));
+    extractor.Process(NV097_SET_VERTEX4F + 0, FloatBits(left + corner[0]));
+    extractor.Process(NV097_SET_VERTEX4F + 4, FloatBits(corner[1]));
+    extractor.Process(NV097_SET_VERTEX4F + 8, FloatBits(0.0f));
+    extractor.Process(NV097_SET_VERTEX4F + 12, FloatBits(1.0f));
+  }
+  extractor.Process(NV097_SET_BEGIN_END, NV097_SET_BEGIN_END_OP_END);
+}
+
+TEST(DrawExtractor, ModelsAlphaFuncAndRejectsUnmodeledState) {
+  SoftwareRasterizer rasterizer(32, 8, 1);
+  rasterizer.Clear(kBlack);
+  DrawExtractor extractor(rasterizer);
+
+  extractor.Process(NV097_SET_ALPHA_REF, 0x7F);
+  extractor.Process(NV097_SET_ALPHA_FUNC, NV097_SET_ALPHA_FUNC_V_GREATER);
+  extractor.Process(NV097_SET_ALPHA_TEST_ENABLE, true);
+  DrawAlphaRamp(extractor, 0.0f);
+
+  // An alpha func that is never enabled does not prevent drawing.
+  extractor.Process(NV097_SET_ALPHA_TEST_ENABLE, false);
+  extractor.Process(NV097_SET_ALPHA_FUNC, 0xFFFF);
+  DrawAlphaRamp(extractor, 8.0f);
+
+  extractor.Process(NV097_SET_DEPTH_TEST_ENABLE, true);
+  DrawAlphaRamp(extractor, 16.0f);
+  extractor.Process(NV097_SET_DEPTH_TEST_ENABLE, false);
+  extractor.Process(NV097_SET_TEXTURE_CONTROL0 + 0x40, NV097_SET_TEXTURE_CONTROL0_ENABLE);
+  DrawAlphaRamp(extractor, 16.0f);
+  extractor.Process(NV097_SET_TEXTURE_CONTROL0 + 0x40, 0);
+  extractor.Process(NV097_SET_ALPHA_TEST_ENABLE, true);
+  DrawAlphaRamp(extractor, 16.0f);
+  rasterizer.Flush();
+
+  EXPECT_EQ(extractor.num_triangles(), 4);
+  EXPECT_EQ(extractor.unsupported_draws(), 3);
+
+  // Only the right half of the ramp has alpha above the reference.
+  const auto &pixels = rasterizer.pixels();
+  EXPECT_EQ(pixels[4 * 32 + 3], kBlack);
+  EXPECT_NE(pixels[4 * 32 + 4], kBlack);
+  // Sampled at the pixel center: 7.5 / 8 * 255.
+  EXPECT_EQ(pixels[4 * 32 + 7] >> 24, 0xEF);
+  // Without the alpha test, the whole ramp is drawn.
+  EXPECT_EQ(pixels[4 * 32 + 8] & 0x00FFFFFF, 0x00FFFFFF);
+  EXPECT_EQ(pixels[4 * 32 + 20], kBlack);
+}
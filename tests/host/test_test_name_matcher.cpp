@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "test_name_matcher.h"
+
+static TestNameMatcher Compile(const std::vector<std::string> &patterns) {
+  TestNameMatcher ret;
+  for (const auto &pattern : patterns) {
+    std::string error;
+    EXPECT_TRUE(ret.AddPattern(pattern, error)) << pattern << ": " << error;
+  }
+  return ret;
+}
+
+TEST(TestNameMatcher, GlobMatch) {
+  EXPECT_TRUE(TestNameMatcher::GlobMatch("Fog*::*NaN*", "Fog infinite::W_NaN_in"));
+  EXPECT_FALSE(TestNameMatcher::GlobMatch("Fog*::*NaN*", "Fog infinite::W_inf"));
+  EXPECT_TRUE(TestNameMatcher::GlobMatch("*", ""));
+  EXPECT_TRUE(TestNameMatcher::GlobMatch("a*b*c", "aXbYbZc"));
+  EXPECT_FALSE(TestNameMatcher::GlobMatch("a*b*c", "aXbYbZ"));
+  EXPECT_TRUE(TestNameMatcher::GlobMatch("T?st", "Test"));
+  EXPECT_FALSE(TestNameMatcher::GlobMatch("T?st", "Tst"));
+  EXPECT_TRUE(TestNameMatcher::GlobMatch("Tex_[0-9][0-9]", "Tex_42"));
+  EXPECT_FALSE(TestNameMatcher::GlobMatch("Tex_[0-9][0-9]", "Tex_4a"));
+  EXPECT_TRUE(TestNameMatcher::GlobMatch("Tex_[!0-9]", "Tex_a"));
+  EXPECT_FALSE(TestNameMatcher::GlobMatch("Tex_[!0-9]", "Tex_1"));
+  EXPECT_TRUE(TestNameMatcher::GlobMatch("[]]", "]"));
+}
+
+TEST(TestNameMatcher, IsPattern) {
+  EXPECT_FALSE(TestNameMatcher::IsPattern("Fog carryover"));
+  EXPECT_TRUE(TestNameMatcher::IsPattern("Fog*"));
+  EXPECT_TRUE(TestNameMatcher::IsPattern("Fog carryover::Test_1"));
+  EXPECT_TRUE(TestNameMatcher::IsPattern("Tex_[0-9]"));
+}
+
+TEST(TestNameMatcher, RejectsMalformedPatterns) {
+  TestNameMatcher matcher;
+  std::string error;
+  EXPECT_FALSE(matcher.AddPattern("", error));
+  EXPECT_FALSE(matcher.AddPattern("Tex_[0-9", error));
+  EXPECT_EQ(error, "unterminated character class");
+  EXPECT_TRUE(matcher.IsEmpty());
+}
+
+TEST(TestNameMatcher, PatternWithoutSeparatorSelectsSuites) {
+  auto matcher = Compile({"Fog*"});
+  EXPECT_EQ(matcher.FindLastMatch("Fog carryover::Test_1"), 0);
+  EXPECT_EQ(matcher.FindLastMatch("Fog"), TestNameMatcher::kNoMatch);
+  EXPECT_EQ(matcher.FindLastMatch("Lighting::Fog"), TestNameMatcher::kNoMatch);
+  // The pattern is reported as given, without the implied "::*".
+  EXPECT_EQ(matcher.GetPattern(0), "Fog*");
+}
+
+TEST(TestNameMatcher, LastMatchingPatternWins) {
+  auto matcher = Compile({"*::*", "Fog*::*", "Fog*::*NaN*", "Fog carryover::W_NaN_exact", "Lighting::*"});
+
+  EXPECT_EQ(matcher.FindLastMatch("Fog carryover::W_NaN_exact"), 3);
+  EXPECT_EQ(matcher.FindLastMatch("Fog carryover::W_NaN_other"), 2);
+  EXPECT_EQ(matcher.FindLastMatch("Fog carryover::W_inf"), 1);
+  EXPECT_EQ(matcher.FindLastMatch("Lighting::Spot"), 4);
+  EXPECT_EQ(matcher.FindLastMatch("Zeta::Test"), 0);
+
+  // A broad pattern added later overrides the more specific ones that precede it.
+  std::string error;
+  ASSERT_TRUE(matcher.AddPattern("*NaN*", error));
+  EXPECT_EQ(matcher.FindLastMatch("Fog carryover::W_NaN_exact"), 3);
+  ASSERT_TRUE(matcher.AddPattern("*::*NaN*", error));
+  EXPECT_EQ(matcher.FindLastMatch("Fog carryover::W_NaN_exact"), 6);
+}
+
+TEST(TestNameMatcher, LiteralPatternsRequireExactMatch) {
+  auto matcher = Compile({"Suite::Test"});
+  EXPECT_EQ(matcher.FindLastMatch("Suite::Test"), 0);
+  EXPECT_EQ(matcher.FindLastMatch("Suite::Test2"), TestNameMatcher::kNoMatch);
+  EXPECT_EQ(matcher.FindLastMatch("Suite::Tes"), TestNameMatcher::kNoMatch);
+}
+
+TEST(TestNameMatcher, Benchmark_100PatternsBy10KNames) {
+  static constexpr uint32_t kNumSuites = 100;
+  static constexpr uint32_t kTestsPerSuite = 100;
+  static constexpr uint32_t kIterations = 10;
+
+  std::vector<std::string> names;
+  for (uint32_t suite = 0; suite < kNumSuites; ++suite) {
+    for (uint32_t test = 0; test < kTestsPerSuite; ++test) {
+      names.emplace_back("Suite_" + std::to_string(suite) + "::Test_" + std::to_string(test) +
+                         (test % 7 ? "_value" : "_NaN"));
+    }
+  }
+
+  // A mix of suite selections, prefix and infix globs, and exact names, as found in generated configs.
+  std::vector<std::string> patterns;
+  for (uint32_t i = 0; i < 100; ++i) {
+    auto suite = std::to_string(i);
+    switch (i % 4) {
+      case 0:
+        patterns.emplace_back("Suite_" + suite);
+        break;
+      case 1:
+        patterns.emplace_back("Suite_" + suite + "::Test_1*");
+        break;
+      case 2:
+        patterns.emplace_back("Suite_" + suite + "*::*NaN*");
+        break;
+      default:
+        patterns.emplace_back("Suite_" + suite + "::Test_" + std::to_string(i) + "_value");
+        break;
+    }
+  }
+  auto matcher = Compile(patterns);
+
+  auto naive_match = [&patterns](const std::string &name) {
+    for (auto i = static_cast<int32_t>(patterns.size()) - 1; i >= 0; --i) {
+      auto pattern = patterns[i].find("::") == std::string::npos ? patterns[i] + "::*" : patterns[i];
+      if (TestNameMatcher::GlobMatch(pattern.c_str(), name.c_str())) {
+        return i;
+      }
+    }
+    return TestNameMatcher::kNoMatch;
+  };
+
+  uint32_t num_matched = 0;
+  for (const auto &name : names) {
+    auto expected = naive_match(name);
+    ASSERT_EQ(matcher.FindLastMatch(name), expected) << name;
+    num_matched += expected != TestNameMatcher::kNoMatch;
+  }
+  EXPECT_GT(num_matched, 0);
+
+  auto measure = [&](auto &&match) {
+    int32_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t iteration = 0; iteration < kIterations; ++iteration) {
+      for (const auto &name : names) {
+        checksum += match(name);
+      }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_NE(checksum, 0);
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()) / kIterations /
+           1000.0;
+  };
+
+  auto naive_ms = measure(naive_match);
+  auto compiled_ms = measure([&matcher](const std::string &name) { return matcher.FindLastMatch(name); });
+  printf("%zu patterns x %zu names (%u matched): naive %.2f ms, compiled %.2f ms\n", patterns.size(), names.size(),
+         num_matched, naive_ms, compiled_ms);
+}
@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "texture_cache.h"
+
+class TextureCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::string pattern = testing::TempDir() + "texture_cache_XXXXXX";
+    std::vector<char> buffer(pattern.begin(), pattern.end());
+    buffer.push_back(0);
+    ASSERT_NE(mkdtemp(buffer.data()), nullptr);
+    directory_ = buffer.data();
+  }
+
+  void TearDown() override {
+    for (const auto &path : created_) {
+      remove(path.c_str());
+    }
+    rmdir(directory_.c_str());
+  }
+
+  std::string Track(const std::string &path) {
+    created_.push_back(path);
+    return path;
+  }
+
+  static TextureCache::Key MakeKey(const char *path = "D:\\pixel_shader\\water_bump_map.png") {
+    TextureCache::Key key;
+    key.source_path = path;
+    key.source_size = 1234;
+    key.source_write_time = 0x01D9000012345678ULL;
+    key.format = 42;
+    return key;
+  }
+
+  static std::vector<uint8_t> MakePixels(const TextureCache::Image &image) {
+    std::vector<uint8_t> ret(image.pitch * image.height);
+    for (uint32_t i = 0; i < ret.size(); ++i) {
+      ret[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+    return ret;
+  }
+
+  //! Loads `key` into `loaded`, returning false on a miss.
+  bool Load(const TextureCache &cache, const TextureCache::Key &key, TextureCache::Image &image,
+            std::vector<uint8_t> &loaded) {
+    uint8_t *data = nullptr;
+    return cache.Load(
+        key, image,
+        [&loaded](uint32_t size) {
+          loaded.resize(size);
+          return loaded.data();
+        },
+        data);
+  }
+
+  void WriteFile(const std::string &path, const std::vector<uint8_t> &contents) {
+    FILE *fp = fopen(path.c_str(), "wb");
+    ASSERT_NE(fp, nullptr);
+    fwrite(contents.data(), 1, contents.size(), fp);
+    fclose(fp);
+  }
+
+  std::vector<uint8_t> ReadFile(const std::string &path) {
+    std::vector<uint8_t> ret;
+    FILE *fp = fopen(path.c_str(), "rb");
+    EXPECT_NE(fp, nullptr);
+    if (!fp) {
+      return ret;
+    }
+    int c;
+    while ((c = fgetc(fp)) != EOF) {
+      ret.push_back(static_cast<uint8_t>(c));
+    }
+    fclose(fp);
+    return ret;
+  }
+
+  std::string directory_;
+  std::vector<std::string> created_;
+};
+
+static const TextureCache::Image kImage{16, 8, 64, 4};
+
+TEST_F(TextureCacheTest, RoundTripsEntry) {
+  TextureCache cache(directory_);
+  auto key = MakeKey();
+  auto pixels = MakePixels(kImage);
+  Track(cache.EntryPath(key));
+  ASSERT_TRUE(cache.Store(key, kImage, pixels.data()));
+
+  TextureCache::Image image;
+  std::vector<uint8_t> loaded;
+  ASSERT_TRUE(Load(cache, key, image, loaded));
+  EXPECT_EQ(image.width, kImage.width);
+  EXPECT_EQ(image.height, kImage.height);
+  EXPECT_EQ(image.pitch, kImage.pitch);
+  EXPECT_EQ(image.bytes_per_pixel, kImage.bytes_per_pixel);
+  EXPECT_EQ(loaded, pixels);
+
+  auto entry = ReadFile(cache.EntryPath(key));
+  EXPECT_EQ(entry.size(), sizeof(TextureCache::Header) + key.source_path.size() + pixels.size());
+}
+
+TEST_F(TextureCacheTest, MissesWithoutEntry) {
+  TextureCache cache(directory_);
+  TextureCache::Image image;
+  std::vector<uint8_t> loaded;
+  EXPECT_FALSE(Load(cache, MakeKey(), image, loaded));
+}
+
+TEST_F(TextureCacheTest, InvalidatesChangedSource) {
+  TextureCache cache(directory_);
+  auto key = MakeKey();
+  auto pixels = MakePixels(kImage);
+  Track(cache.EntryPath(key));
+  ASSERT_TRUE(cache.Store(key, kImage, pixels.data()));
+
+  TextureCache::Image image;
+  std::vector<uint8_t> loaded;
+
+  auto resized = key;
+  resized.source_size += 1;
+  EXPECT_EQ(cache.EntryPath(resized), cache.EntryPath(key));
+  EXPECT_FALSE(Load(cache, resized, image, loaded));
+
+  auto touched = key;
+  touched.source_write_time += 1;
+  EXPECT_FALSE(Load(cache, touched, image, loaded));
+
+  // Changing the target layout selects a different entry.
+  auto reformatted = key;
+  reformatted.format += 1;
+  EXPECT_NE(cache.EntryPath(reformatted), cache.EntryPath(key));
+  EXPECT_FALSE(Load(cache, reformatted, image, loaded));
+
+  auto swizzled = key;
+  swizzled.swizzled = true;
+  EXPECT_NE(cache.EntryPath(swizzled), cache.EntryPath(key));
+  EXPECT_FALSE(Load(cache, swizzled, image, loaded));
+
+  EXPECT_TRUE(loaded.empty());
+  ASSERT_TRUE(Load(cache, key, image, loaded));
+}
+
+TEST_F(TextureCacheTest, StoreReplacesStaleEntry) {
+  TextureCache cache(directory_);
+  auto key = MakeKey();
+  auto pixels = MakePixels(kImage);
+  Track(cache.EntryPath(key));
+  ASSERT_TRUE(cache.Store(key, kImage, pixels.data()));
+
+  auto updated = key;
+  updated.source_write_time += 100;
+  TextureCache::Image larger{32, 8, 128, 4};
+  auto updated_pixels = MakePixels(larger);
+  ASSERT_TRUE(cache.Store(updated, larger, updated_pixels.data()));
+
+  TextureCache::Image image;
+  std::vector<uint8_t> loaded;
+  EXPECT_FALSE(Load(cache, key, image, loaded));
+  ASSERT_TRUE(Load(cache, updated, image, loaded));
+  EXPECT_EQ(image.width, 32);
+  EXPECT_EQ(loaded, updated_pixels);
+}
+
+TEST_F(TextureCacheTest, RejectsCorruptEntries) {
+  TextureCache cache(directory_);
+  auto key = MakeKey();
+  auto entry_path = Track(cache.EntryPath(key));
+  auto pixels = MakePixels(kImage);
+  ASSERT_TRUE(cache.Store(key, kImage, pixels.data()));
+  const auto valid = ReadFile(entry_path);
+
+  auto expect_miss = [&](const char *name, const std::vector<uint8_t> &contents) {
+    WriteFile(entry_path, contents);
+    TextureCache::Image image;
+    std::vector<uint8_t> loaded;
+    bool allocated = false;
+    uint8_t *data = nullptr;
+    EXPECT_FALSE(cache.Load(
+        key, image,
+        [&](uint32_t size) {
+          allocated = true;
+          loaded.resize(size);
+          return loaded.data();
+        },
+        data))
+        << name;
+    EXPECT_FALSE(allocated) << name;
+  };
+
+  auto truncated = valid;
+  truncated.pop_back();
+  expect_miss("truncated data", truncated);
+
+  auto padded = valid;
+  padded.push_back(0);
+  expect_miss("trailing data", padded);
+
+  expect_miss("truncated header", std::vector<uint8_t>(valid.begin(), valid.begin() + 20));
+
+  auto bad_magic = valid;
+  bad_magic[0] ^= 0xFF;
+  expect_miss("magic", bad_magic);
+
+  auto bad_version = valid;
+  bad_version[offsetof(TextureCache::Header, version)] += 1;
+  expect_miss("version", bad_version);
+
+  auto bad_pitch = valid;
+  bad_pitch[offsetof(TextureCache::Header, pitch)] += 4;
+  expect_miss("pitch", bad_pitch);
+
+  // An entry written for a different source whose key hashes to the same file.
+  auto other_path = valid;
+  other_path[sizeof(TextureCache::Header)] ^= 0x20;
+  expect_miss("path", other_path);
+
+  WriteFile(entry_path, valid);
+  TextureCache::Image image;
+  uint8_t *data = nullptr;
+  EXPECT_FALSE(cache.Load(key, image, [](uint32_t) -> uint8_t * { return nullptr; }, data));
+}
+
+TEST_F(TextureCacheTest, BuildKeyTracksSourceFile) {
+  auto source = Track(directory_ + "/source.png");
+  WriteFile(source, std::vector<uint8_t>(100, 1));
+
+  TextureCache::Key key;
+  ASSERT_TRUE(TextureCache::BuildKey(source, 7, true, key));
+  EXPECT_EQ(key.source_path, source);
+  EXPECT_EQ(key.source_size, 100);
+  EXPECT_NE(key.source_write_time, 0);
+  EXPECT_EQ(key.format, 7);
+  EXPECT_TRUE(key.swizzled);
+
+  TextureCache cache(directory_);
+  Track(cache.EntryPath(key));
+  auto pixels = MakePixels(kImage);
+  ASSERT_TRUE(cache.Store(key, kImage, pixels.data()));
+
+  WriteFile(source, std::vector<uint8_t>(101, 1));
+  TextureCache::Key updated;
+  ASSERT_TRUE(TextureCache::BuildKey(source, 7, true, updated));
+  TextureCache::Image image;
+  std::vector<uint8_t> loaded;
+  EXPECT_FALSE(Load(cache, updated, image, loaded));
+
+  TextureCache::Key missing;
+  EXPECT_FALSE(TextureCache::BuildKey(directory_ + "/missing.png", 7, false, missing));
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "texture_swizzle.h"
+#include "xbox-swizzle/swizzle.h"
+
+// Rows (and slices) are padded so that pitch handling is exercised.
+static constexpr uint32_t kRowPadding = 12;
+static constexpr uint32_t kSlicePadding = 20;
+
+static std::vector<uint8_t> RandomBytes(size_t size, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> ret(size);
+  for (auto &value : ret) {
+    value = static_cast<uint8_t>(rng());
+  }
+  return ret;
+}
+
+//! Checks both directions of the given volume against xbox-swizzle. Rects are checked via the *Rect entry points.
+static void ExpectMatchesReference(uint32_t width, uint32_t height, uint32_t depth, uint32_t bytes_per_pixel) {
+  const uint32_t row_pitch = width * bytes_per_pixel + kRowPadding;
+  const uint32_t slice_pitch = row_pitch * height + kSlicePadding;
+  const uint32_t linear_size = slice_pitch * depth;
+  const uint32_t swizzled_size = width * height * depth * bytes_per_pixel;
+  const auto linear = RandomBytes(linear_size, width * 131 + height * 17 + depth * 7 + bytes_per_pixel);
+
+  std::vector<uint8_t> expected(swizzled_size, 0xCD);
+  std::vector<uint8_t> actual(swizzled_size, 0xCD);
+  if (depth == 1) {
+    swizzle_rect(linear.data(), width, height, expected.data(), row_pitch, bytes_per_pixel);
+    TextureSwizzle::SwizzleRect(linear.data(), width, height, actual.data(), row_pitch, bytes_per_pixel);
+  } else {
+    swizzle_box(linear.data(), width, height, depth, expected.data(), row_pitch, slice_pitch, bytes_per_pixel);
+    TextureSwizzle::SwizzleBox(linear.data(), width, height, depth, actual.data(), row_pitch, slice_pitch,
+                               bytes_per_pixel);
+  }
+  ASSERT_EQ(actual, expected) << "swizzle " << width << "x" << height << "x" << depth << " @ " << bytes_per_pixel;
+
+  // Padding bytes in the unswizzled output must be left untouched.
+  std::vector<uint8_t> expected_linear(linear_size, 0xCD);
+  std::vector<uint8_t> actual_linear(linear_size, 0xCD);
+  if (depth == 1) {
+    unswizzle_rect(expected.data(), width, height, expected_linear.data(), row_pitch, bytes_per_pixel);
+    TextureSwizzle::UnswizzleRect(expected.data(), width, height, actual_linear.data(), row_pitch, bytes_per_pixel);
+  } else {
+    unswizzle_box(expected.data(), width, height, depth, expected_linear.data(), row_pitch, slice_pitch,
+                  bytes_per_pixel);
+    TextureSwizzle::UnswizzleBox(expected.data(), width, height, depth, actual_linear.data(), row_pitch, slice_pitch,
+                                 bytes_per_pixel);
+  }
+  ASSERT_EQ(actual_linear, expected_linear)
+      << "unswizzle " << width << "x" << height << "x" << depth << " @ " << bytes_per_pixel;
+}
+
+TEST(TextureSwizzle, RectMatchesReferenceForAllPowerOfTwoSizes) {
+  for (auto bytes_per_pixel : {1U, 2U, 4U}) {
+    for (uint32_t width = 1; width <= 1024; width <<= 1) {
+      for (uint32_t height = 1; height <= 1024; height <<= 1) {
+        ASSERT_NO_FATAL_FAILURE(ExpectMatchesReference(width, height, 1, bytes_per_pixel));
+      }
+    }
+  }
+}
+
+TEST(TextureSwizzle, BoxMatchesReferenceForAllPowerOfTwoSizes) {
+  for (auto bytes_per_pixel : {1U, 2U, 4U}) {
+    for (uint32_t width = 1; width <= 128; width <<= 1) {
+      for (uint32_t height = 1; height <= 128; height <<= 1) {
+        for (uint32_t depth = 2; depth <= 64; depth <<= 1) {
+          ASSERT_NO_FATAL_FAILURE(ExpectMatchesReference(width, height, depth, bytes_per_pixel));
+        }
+      }
+    }
+  }
+}
+
+TEST(TextureSwizzle, UnspecializedPixelSizesMatchReference) {
+  for (auto bytes_per_pixel : {3U, 8U, 16U}) {
+    ASSERT_NO_FATAL_FAILURE(ExpectMatchesReference(64, 32, 1, bytes_per_pixel));
+    ASSERT_NO_FATAL_FAILURE(ExpectMatchesReference(16, 8, 4, bytes_per_pixel));
+  }
+}
+
+TEST(TextureSwizzle, Benchmark) {
+  struct Case {
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t bytes_per_pixel;
+  };
+  static constexpr Case kCases[] = {
+      {256, 256, 1, 4}, {1024, 1024, 1, 4}, {512, 512, 1, 2}, {512, 512, 1, 1}, {128, 128, 32, 4},
+  };
+  static constexpr uint32_t kIterations = 10;
+
+  printf("Kernel: %s\n", TextureSwizzle::KernelName());
+  for (const auto &test : kCases) {
+    const uint32_t row_pitch = test.width * test.bytes_per_pixel;
+    const uint32_t slice_pitch = row_pitch * test.height;
+    const uint32_t size = slice_pitch * test.depth;
+    const auto linear = RandomBytes(size, 1);
+    std::vector<uint8_t> swizzled(size);
+
+    auto measure = [&](auto &&function) {
+      function();
+      const auto start = std::chrono::steady_clock::now();
+      for (uint32_t i = 0; i < kIterations; ++i) {
+        function();
+      }
+      const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      return static_cast<double>(size) * kIterations / elapsed / (1024.0 * 1024.0);
+    };
+
+    const double reference = measure([&]() {
+      swizzle_box(linear.data(), test.width, test.height, test.depth, swizzled.data(), row_pitch, slice_pitch,
+                  test.bytes_per_pixel);
+    });
+    const double swizzle = measure([&]() {
+      TextureSwizzle::SwizzleBox(linear.data(), test.width, test.height, test.depth, swizzled.data(), row_pitch,
+                                 slice_pitch, test.bytes_per_pixel);
+    });
+    std::vector<uint8_t> unswizzled(size);
+    const double unswizzle = measure([&]() {
+      TextureSwizzle::UnswizzleBox(swizzled.data(), test.width, test.height, test.depth, unswizzled.data(), row_pitch,
+                                   slice_pitch, test.bytes_per_pixel);
+    });
+
+    printf("%4ux%4ux%2u @ %u: xbox-swizzle %7.0f MiB/s, swizzle %7.0f MiB/s, unswizzle %7.0f MiB/s\n", test.width,
+           test.height, test.depth, test.bytes_per_pixel, reference, swizzle, unswizzle);
+    EXPECT_EQ(unswizzled, linear);
+  }
+}
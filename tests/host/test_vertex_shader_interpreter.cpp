@@ -0,0 +1,537 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "reference/vertex_shader_interpreter.h"
+
+using VSI = VertexShaderInterpreter;
+
+namespace {
+
+enum Mux : uint32_t {
+  MUX_R = 1,
+  MUX_V = 2,
+  MUX_C = 3,
+};
+
+struct Source {
+  Mux mux{MUX_V};
+  uint32_t reg{0};
+  const char *swizzle{"xyzw"};
+  bool negate{false};
+};
+
+//! Fields of a single instruction, defaulting to the values the assembler emits for unused fields.
+struct Op {
+  static Op MAC(VSI::MACOp op) {
+    Op ret;
+    ret.mac = op;
+    return ret;
+  }
+  static Op ILU(VSI::ILUOp op) {
+    Op ret;
+    ret.ilu = op;
+    return ret;
+  }
+
+  Op &PairILU(VSI::ILUOp op) {
+    ilu = op;
+    return *this;
+  }
+  Op &A(Source source) {
+    a = source;
+    return *this;
+  }
+  Op &B(Source source) {
+    b = source;
+    return *this;
+  }
+  Op &C(Source source) {
+    c = source;
+    return *this;
+  }
+  //! Sets the constant read by MUX_C operands, relative to A0.x if `relative` is set.
+  Op &Constant(uint32_t index, bool relative = false) {
+    constant = index;
+    relative_constant = relative;
+    return *this;
+  }
+  //! Sets the input read by MUX_V operands.
+  Op &Input(uint32_t index) {
+    input = index;
+    return *this;
+  }
+  Op &Temporary(uint32_t index, const char *mac_write_mask, const char *ilu_write_mask = "") {
+    temporary = index;
+    mac_mask = mac_write_mask;
+    ilu_mask = ilu_write_mask;
+    return *this;
+  }
+  Op &Output(uint32_t address, const char *mask = "xyzw", bool from_ilu = false) {
+    output = address;
+    output_mask = mask;
+    output_from_ilu = from_ilu;
+    return *this;
+  }
+
+  VSI::ILUOp ilu{VSI::ILU_NOP};
+  VSI::MACOp mac{VSI::MAC_NOP};
+  uint32_t constant{0};
+  uint32_t input{0};
+  Source a;
+  Source b;
+  Source c;
+  const char *mac_mask{""};
+  uint32_t temporary{7};
+  const char *ilu_mask{""};
+  const char *output_mask{""};
+  uint32_t output{0};
+  bool output_from_ilu{false};
+  bool relative_constant{false};
+  bool final{false};
+};
+
+uint32_t EncodeSwizzle(const char *swizzle) {
+  uint32_t ret = 0;
+  for (uint32_t i = 0; i < 4; ++i) {
+    ret = (ret << 2) | static_cast<uint32_t>(strchr("xyzw", swizzle[i]) - "xyzw");
+  }
+  return ret;
+}
+
+uint32_t EncodeMask(const char *mask) {
+  uint32_t ret = 0;
+  for (const char *component = mask; *component; ++component) {
+    ret |= 8 >> (strchr("xyzw", *component) - "xyzw");
+  }
+  return ret;
+}
+
+std::array<uint32_t, 4> Encode(const Op &op) {
+  const uint32_t a_swizzle = EncodeSwizzle(op.a.swizzle);
+  const uint32_t b_swizzle = EncodeSwizzle(op.b.swizzle);
+  const uint32_t c_swizzle = EncodeSwizzle(op.c.swizzle);
+  std::array<uint32_t, 4> ret{};
+  ret[1] = (op.ilu << 25) | (op.mac << 21) | (op.constant << 13) | (op.input << 9) | (op.a.negate << 8) | a_swizzle;
+  ret[2] = (op.a.reg << 28) | (op.a.mux << 26) | (op.b.negate << 25) | (b_swizzle << 17) | (op.b.reg << 13) |
+           (op.b.mux << 11) | (op.c.negate << 10) | (c_swizzle << 2) | (op.c.reg >> 2);
+  ret[3] = ((op.c.reg & 3) << 30) | (op.c.mux << 28) | (EncodeMask(op.mac_mask) << 24) | (op.temporary << 20) |
+           (EncodeMask(op.ilu_mask) << 16) | (EncodeMask(op.output_mask) << 12) | (1 << 11) | (op.output << 3) |
+           (op.output_from_ilu << 2) | (op.relative_constant << 1) | op.final;
+  return ret;
+}
+
+std::vector<uint32_t> Assemble(std::vector<Op> ops) {
+  ops.back().final = true;
+  std::vector<uint32_t> ret;
+  for (const auto &op : ops) {
+    const auto words = Encode(op);
+    ret.insert(ret.end(), words.begin(), words.end());
+  }
+  return ret;
+}
+
+void Load(VSI &interpreter, const std::vector<uint32_t> &microcode) {
+  std::string error;
+  ASSERT_TRUE(interpreter.Load(microcode.data(), microcode.size(), error)) << error;
+}
+
+//! Runs `interpreter` on a single vertex whose v0 is `v0` and returns oD0.
+std::array<float, 4> RunVertex(const VSI &interpreter, std::array<float, 4> v0) {
+  std::vector<VSI::InputVertex> inputs(1);
+  memcpy(inputs[0].v[0], v0.data(), sizeof(inputs[0].v[0]));
+  std::vector<VSI::OutputVertex> outputs;
+  interpreter.Execute(inputs, outputs);
+  const float *result = outputs[0].o[VSI::OUT_DIFFUSE];
+  return {result[0], result[1], result[2], result[3]};
+}
+
+//! Returns a program that evaluates `op` with its result routed to oD0.
+std::vector<uint32_t> ToDiffuse(Op op) {
+  op.output = VSI::OUT_DIFFUSE;
+  op.output_mask = "xyzw";
+  op.output_from_ilu = op.ilu != VSI::ILU_NOP;
+  return Assemble({op});
+}
+
+constexpr float kInf = INFINITY;
+
+}  // namespace
+
+TEST(VertexShaderInterpreter, EncoderMatchesAssembler) {
+  // mov oPos, v0
+  const std::array<uint32_t, 4> expected{0x00000000, 0x0020001b, 0x0836106c, 0x2070f800};
+  EXPECT_EQ(Encode(Op::MAC(VSI::MAC_MOV).Output(VSI::OUT_POS)), expected);
+}
+
+TEST(VertexShaderInterpreter, PairedMACAndILUAreIndependent) {
+  // Replays VertexShaderIndependenceTests::TestMACILU.
+  static constexpr uint32_t kShader[] = {
+      0x00000000, 0x0020001b, 0x0836106c, 0x2070f800, 0x00000000, 0x0020061b, 0x0836106c, 0x2070f818,
+      0x00000000, 0x002c001b, 0x0c36106c, 0x2f000ff8, 0x00000000, 0x002c201b, 0x0c36106c, 0x2f100ff8,
+      0x00000000, 0x002c401b, 0x0c36106c, 0x2f800ff8, 0x00000000, 0x08A000DA, 0x85B50800, 0x18020000,
+      0x00000000, 0x0020001b, 0x0836106c, 0x2070f800, 0x00000000, 0x0020061b, 0x0836106c, 0x2070f818,
+      0x00000000, 0x002c401b, 0x0c36106c, 0x2f800ff8, 0x00000000, 0x0020001b, 0x1436106c, 0x2070f819};
+
+  VSI interpreter;
+  std::string error;
+  ASSERT_TRUE(interpreter.Load(kShader, sizeof(kShader) / sizeof(kShader[0]), error)) << error;
+  EXPECT_EQ(interpreter.num_instructions(), 10);
+  interpreter.SetConstant(VSI::kConstantBias + 0, 1.f, 0.f, 0.f, 0.f);
+  interpreter.SetConstant(VSI::kConstantBias + 1, 0.5f, 0.5f, 0.f, 1.f);
+  interpreter.SetConstant(VSI::kConstantBias + 2, 0.f, 0.f, 0.f, 8.f);
+
+  const auto result = RunVertex(interpreter, {1.f, 2.f, 3.f, 1.f});
+  EXPECT_EQ(result, (std::array<float, 4>{0.5f, 0.5f, 1.f, 1.f}));
+}
+
+TEST(VertexShaderInterpreter, SwizzleNegateAndMasks) {
+  VSI interpreter;
+  Load(interpreter, Assemble({
+                        // mov r0, -v0.wzyx
+                        Op::MAC(VSI::MAC_MOV).A({MUX_V, 0, "wzyx", true}).Temporary(0, "xyzw"),
+                        // mov r0.yw, v0.x
+                        Op::MAC(VSI::MAC_MOV).A({MUX_V, 0, "xxxx"}).Temporary(0, "yw"),
+                        // mov oD0, r0
+                        Op::MAC(VSI::MAC_MOV).A({MUX_R, 0}).Output(VSI::OUT_DIFFUSE),
+                        // mov oD0.z, -c[1].y
+                        Op::MAC(VSI::MAC_MOV)
+                            .Constant(VSI::kConstantBias + 1)
+                            .A({MUX_C, 0, "yyyy", true})
+                            .Output(VSI::OUT_DIFFUSE, "z"),
+                    }));
+  interpreter.SetConstant(VSI::kConstantBias + 1, 0.f, 7.f, 0.f, 0.f);
+
+  EXPECT_EQ(RunVertex(interpreter, {1.f, 2.f, 3.f, 4.f}), (std::array<float, 4>{-4.f, 1.f, -7.f, 1.f}));
+}
+
+TEST(VertexShaderInterpreter, R12AliasesPosition) {
+  VSI interpreter;
+  Load(interpreter, Assemble({
+                        Op::MAC(VSI::MAC_MOV).A({MUX_V, 0}).Temporary(12, "xyzw"),
+                        Op::MAC(VSI::MAC_ADD).A({MUX_R, 12}).C({MUX_R, 12}).Output(VSI::OUT_DIFFUSE),
+                    }));
+
+  std::vector<VSI::InputVertex> inputs(1);
+  inputs[0].v[0][0] = 1.f;
+  inputs[0].v[0][3] = 2.f;
+  std::vector<VSI::OutputVertex> outputs;
+  interpreter.Execute(inputs, outputs);
+  EXPECT_EQ(outputs[0].o[VSI::OUT_POS][0], 1.f);
+  EXPECT_EQ(outputs[0].o[VSI::OUT_POS][3], 2.f);
+  EXPECT_EQ(outputs[0].o[VSI::OUT_DIFFUSE][0], 2.f);
+  EXPECT_EQ(outputs[0].o[VSI::OUT_DIFFUSE][3], 4.f);
+}
+
+TEST(VertexShaderInterpreter, ZeroTimesAnythingIsZero) {
+  VSI interpreter;
+  interpreter.SetConstant(VSI::kConstantBias, kInf, 0.f, 0.f, 3.f);
+  const std::array<float, 4> v0{0.f, kInf, NAN, 2.f};
+
+  Load(interpreter, ToDiffuse(Op::MAC(VSI::MAC_MUL).Constant(VSI::kConstantBias).B({MUX_C})));
+  EXPECT_EQ(RunVertex(interpreter, v0), (std::array<float, 4>{0.f, 0.f, 0.f, 6.f}));
+
+  Load(interpreter, ToDiffuse(Op::MAC(VSI::MAC_DP4).Constant(VSI::kConstantBias).B({MUX_C})));
+  EXPECT_EQ(RunVertex(interpreter, v0)[0], 6.f);
+
+  Load(interpreter,
+       ToDiffuse(Op::MAC(VSI::MAC_MAD).Constant(VSI::kConstantBias).B({MUX_C}).C({MUX_C, 0, "wwww"})));
+  EXPECT_EQ(RunVertex(interpreter, v0), (std::array<float, 4>{3.f, 3.f, 3.f, 9.f}));
+}
+
+TEST(VertexShaderInterpreter, DotProductsAndDistance) {
+  VSI interpreter;
+  interpreter.SetConstant(VSI::kConstantBias, 2.f, 3.f, 4.f, 5.f);
+  const std::array<float, 4> v0{1.f, 10.f, 100.f, 1000.f};
+
+  Load(interpreter, ToDiffuse(Op::MAC(VSI::MAC_DP3).Constant(VSI::kConstantBias).B({MUX_C})));
+  EXPECT_EQ(RunVertex(interpreter, v0), (std::array<float, 4>{432.f, 432.f, 432.f, 432.f}));
+
+  Load(interpreter, ToDiffuse(Op::MAC(VSI::MAC_DPH).Constant(VSI::kConstantBias).B({MUX_C})));
+  EXPECT_EQ(RunVertex(interpreter, v0)[0], 437.f);
+
+  Load(interpreter, ToDiffuse(Op::MAC(VSI::MAC_DP4).Constant(VSI::kConstantBias).B({MUX_C})));
+  EXPECT_EQ(RunVertex(interpreter, v0)[0], 5432.f);
+
+  Load(interpreter, ToDiffuse(Op::MAC(VSI::MAC_DST).Constant(VSI::kConstantBias).B({MUX_C})));
+  EXPECT_EQ(RunVertex(interpreter, v0), (std::array<float, 4>{1.f, 30.f, 100.f, 5.f}));
+}
+
+TEST(VertexShaderInterpreter, ComparisonsWithNaN) {
+  VSI interpreter;
+  interpreter.SetConstant(VSI::kConstantBias, 1.f, 1.f, NAN, 1.f);
+  const std::array<float, 4> v0{0.f, 2.f, 1.f, NAN};
+
+  struct Case {
+    VSI::MACOp op;
+    std::array<float, 4> expected;
+  };
+  // A NaN in either operand makes the comparison false, selecting B for MIN and MAX.
+  const Case kCases[] = {
+      {VSI::MAC_MIN, {0.f, 1.f, NAN, 1.f}},
+      {VSI::MAC_MAX, {1.f, 2.f, NAN, 1.f}},
+      {VSI::MAC_SLT, {1.f, 0.f, 0.f, 0.f}},
+      {VSI::MAC_SGE, {0.f, 1.f, 0.f, 0.f}},
+  };
+  for (const auto &test : kCases) {
+    Load(interpreter, ToDiffuse(Op::MAC(test.op).Constant(VSI::kConstantBias).B({MUX_C})));
+    const auto result = RunVertex(interpreter, v0);
+    for (uint32_t i = 0; i < 4; ++i) {
+      if (std::isnan(test.expected[i])) {
+        EXPECT_TRUE(std::isnan(result[i])) << "op " << test.op << " component " << i;
+      } else {
+        EXPECT_EQ(result[i], test.expected[i]) << "op " << test.op << " component " << i;
+      }
+    }
+  }
+}
+
+TEST(VertexShaderInterpreter, ReciprocalSpecialCases) {
+  VSI interpreter;
+
+  Load(interpreter, ToDiffuse(Op::ILU(VSI::ILU_RCP).C({MUX_V, 0, "xxxx"})));
+  EXPECT_EQ(RunVertex(interpreter, {0.f})[0], kInf);
+  EXPECT_EQ(RunVertex(interpreter, {-0.f})[0], -kInf);
+  EXPECT_EQ(RunVertex(interpreter, {kInf})[0], 0.f);
+  EXPECT_EQ(RunVertex(interpreter, {4.f}), (std::array<float, 4>{0.25f, 0.25f, 0.25f, 0.25f}));
+
+  Load(interpreter, ToDiffuse(Op::ILU(VSI::ILU_RSQ).C({MUX_V, 0, "xxxx"})));
+  EXPECT_EQ(RunVertex(interpreter, {0.f})[0], kInf);
+  EXPECT_EQ(RunVertex(interpreter, {kInf})[0], 0.f);
+  // The absolute value is used.
+  EXPECT_EQ(RunVertex(interpreter, {-4.f})[0], 0.5f);
+
+  Load(interpreter, ToDiffuse(Op::ILU(VSI::ILU_RCC).C({MUX_V, 0, "xxxx"})));
+  EXPECT_EQ(RunVertex(interpreter, {0.f})[0], 1.884467e19f);
+  EXPECT_EQ(RunVertex(interpreter, {-0.f})[0], -1.884467e19f);
+  EXPECT_EQ(RunVertex(interpreter, {kInf})[0], 5.42101e-20f);
+  EXPECT_EQ(RunVertex(interpreter, {-kInf})[0], -5.42101e-20f);
+  EXPECT_EQ(RunVertex(interpreter, {-2.f})[0], -0.5f);
+  EXPECT_TRUE(std::isnan(RunVertex(interpreter, {NAN})[0]));
+}
+
+TEST(VertexShaderInterpreter, ExpLogLit) {
+  VSI interpreter;
+
+  Load(interpreter, ToDiffuse(Op::ILU(VSI::ILU_EXP).C({MUX_V, 0, "xxxx"})));
+  EXPECT_EQ(RunVertex(interpreter, {2.5f}), (std::array<float, 4>{4.f, 0.5f, std::exp2(2.5f), 1.f}));
+  EXPECT_EQ(RunVertex(interpreter, {-1.25f}), (std::array<float, 4>{0.25f, 0.75f, std::exp2(-1.25f), 1.f}));
+
+  Load(interpreter, ToDiffuse(Op::ILU(VSI::ILU_LOG).C({MUX_V, 0, "xxxx"})));
+  EXPECT_EQ(RunVertex(interpreter, {12.f}), (std::array<float, 4>{3.f, 1.5f, std::log2(12.f), 1.f}));
+  EXPECT_EQ(RunVertex(interpreter, {-0.25f}), (std::array<float, 4>{-2.f, 1.f, -2.f, 1.f}));
+  EXPECT_EQ(RunVertex(interpreter, {0.f}), (std::array<float, 4>{-kInf, 1.f, -kInf, 1.f}));
+  EXPECT_EQ(RunVertex(interpreter, {kInf}), (std::array<float, 4>{kInf, 1.f, kInf, 1.f}));
+
+  Load(interpreter, ToDiffuse(Op::ILU(VSI::ILU_LIT).C({MUX_V})));
+  EXPECT_EQ(RunVertex(interpreter, {0.5f, 2.f, 0.f, 3.f}), (std::array<float, 4>{1.f, 0.5f, 8.f, 1.f}));
+  EXPECT_EQ(RunVertex(interpreter, {-0.5f, 2.f, 0.f, 3.f}), (std::array<float, 4>{1.f, 0.f, 0.f, 1.f}));
+  EXPECT_EQ(RunVertex(interpreter, {0.5f, -2.f, 0.f, 3.f}), (std::array<float, 4>{1.f, 0.5f, 0.f, 1.f}));
+  // The specular power is clamped.
+  EXPECT_EQ(RunVertex(interpreter, {1.f, 0.5f, 0.f, 1000.f})[2], std::pow(0.5f, 127.9961f));
+}
+
+TEST(VertexShaderInterpreter, RelativeConstantAddressing) {
+  VSI interpreter;
+  for (uint32_t i = 0; i < 4; ++i) {
+    interpreter.SetConstant(VSI::kConstantBias + i, static_cast<float>(i), 0.f, 0.f, 1.f);
+  }
+  Load(interpreter, Assemble({
+                        // arl a0.x, v0.x
+                        Op::MAC(VSI::MAC_ARL).A({MUX_V, 0, "xxxx"}),
+                        // mov oD0, c[a0.x + 1]
+                        Op::MAC(VSI::MAC_MOV).Constant(VSI::kConstantBias + 1, true).A({MUX_C}).Output(
+                            VSI::OUT_DIFFUSE),
+                    }));
+
+  // Vertices index different constants within a batch. A0 is the floor of the source.
+  std::vector<VSI::InputVertex> inputs(4);
+  const float kIndices[] = {-1.f, 0.5f, 1.9f, -1000.f};
+  for (uint32_t i = 0; i < 4; ++i) {
+    inputs[i].v[0][0] = kIndices[i];
+  }
+  std::vector<VSI::OutputVertex> outputs;
+  interpreter.Execute(inputs, outputs);
+  EXPECT_EQ(outputs[0].o[VSI::OUT_DIFFUSE][0], 0.f);
+  EXPECT_EQ(outputs[1].o[VSI::OUT_DIFFUSE][0], 1.f);
+  EXPECT_EQ(outputs[2].o[VSI::OUT_DIFFUSE][0], 2.f);
+  // Out of range reads return 0.
+  EXPECT_EQ(outputs[3].o[VSI::OUT_DIFFUSE][3], 0.f);
+}
+
+TEST(VertexShaderInterpreter, RejectsInvalidPrograms) {
+  VSI interpreter;
+  std::string error;
+
+  const uint32_t kTruncated[] = {0, 0, 0};
+  EXPECT_FALSE(interpreter.Load(kTruncated, 3, error));
+
+  const auto mov = Op::MAC(VSI::MAC_MOV).Output(VSI::OUT_DIFFUSE);
+  auto microcode = Assemble({mov});
+  microcode[1] |= 0xF << 21;
+  EXPECT_FALSE(interpreter.Load(microcode.data(), microcode.size(), error));
+  EXPECT_NE(error.find("opcode"), std::string::npos) << error;
+
+  // Writes to constant registers are not modeled.
+  microcode = Assemble({mov});
+  microcode[3] &= ~(1 << 11);
+  EXPECT_FALSE(interpreter.Load(microcode.data(), microcode.size(), error));
+  EXPECT_NE(error.find("constant"), std::string::npos) << error;
+
+  microcode = Assemble({Op::MAC(VSI::MAC_MOV).A({MUX_R, 13}).Temporary(0, "x")});
+  EXPECT_FALSE(interpreter.Load(microcode.data(), microcode.size(), error));
+
+  microcode = Assemble(std::vector<Op>(VSI::kMaxInstructions + 1, Op::MAC(VSI::MAC_MOV).Temporary(0, "x")));
+  EXPECT_FALSE(interpreter.Load(microcode.data(), microcode.size(), error));
+}
+
+namespace {
+
+Source RandomSource(std::mt19937 &rng) {
+  static constexpr const char *kSwizzles[] = {"xyzw", "wzyx", "xxxx", "yzxw", "zwzw", "wwww"};
+  Source ret;
+  ret.mux = static_cast<Mux>(1 + rng() % 3);
+  ret.reg = rng() % 13;
+  ret.swizzle = kSwizzles[rng() % 6];
+  ret.negate = rng() & 1;
+  return ret;
+}
+
+VSI RandomInterpreter(std::mt19937 &rng) {
+  static constexpr const char *kMasks[] = {"", "x", "yw", "xyz", "xyzw", "zw"};
+  std::vector<Op> ops;
+  const uint32_t count = 4 + rng() % 20;
+  for (uint32_t i = 0; i < count; ++i) {
+    Op op = Op::MAC(static_cast<VSI::MACOp>(rng() % (VSI::MAC_ARL + 1)));
+    op.PairILU(static_cast<VSI::ILUOp>(rng() % (VSI::ILU_LIT + 1)));
+    // Straddles both ends of the constant range when offset by A0.
+    op.Constant(rng() % 2 ? rng() % 8 : VSI::kNumConstants - 1 - rng() % 8, rng() % 4 == 0);
+    op.Input(rng() % 4);
+    op.A(RandomSource(rng)).B(RandomSource(rng)).C(RandomSource(rng));
+    op.Temporary(rng() % 13, kMasks[rng() % 6], kMasks[rng() % 6]);
+    op.Output(rng() % VSI::kNumOutputs, kMasks[rng() % 6], rng() & 1);
+    ops.push_back(op);
+  }
+  const auto microcode = Assemble(ops);
+
+  VSI interpreter;
+  std::string error;
+  EXPECT_TRUE(interpreter.Load(microcode.data(), microcode.size(), error)) << error;
+  std::uniform_real_distribution<float> value(-4.f, 4.f);
+  for (uint32_t i = 0; i < VSI::kNumConstants; ++i) {
+    interpreter.SetConstant(i, value(rng), value(rng), value(rng), value(rng));
+  }
+  return interpreter;
+}
+
+std::vector<VSI::InputVertex> RandomInputs(uint32_t count, uint32_t seed) {
+  static constexpr float kSpecial[] = {0.f, -0.f, INFINITY, -INFINITY, NAN, 1.f};
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> value(-8.f, 8.f);
+  std::vector<VSI::InputVertex> ret(count);
+  for (auto &vertex : ret) {
+    for (auto &reg : vertex.v) {
+      for (auto &component : reg) {
+        component = rng() % 16 ? value(rng) : kSpecial[rng() % 6];
+      }
+    }
+  }
+  return ret;
+}
+
+//! Compares outputs bitwise so that NaNs and signed zeros must match.
+bool Identical(const std::vector<VSI::OutputVertex> &a, const std::vector<VSI::OutputVertex> &b) {
+  return a.size() == b.size() && !memcmp(a.data(), b.data(), a.size() * sizeof(a[0]));
+}
+
+}  // namespace
+
+TEST(VertexShaderInterpreter, VectorizedMatchesScalar) {
+  // An odd count leaves a partial batch at the end.
+  const auto inputs = RandomInputs(203, 1);
+  std::mt19937 rng(2);
+  for (uint32_t i = 0; i < 200; ++i) {
+    const auto interpreter = RandomInterpreter(rng);
+    std::vector<VSI::OutputVertex> expected;
+    std::vector<VSI::OutputVertex> actual;
+    interpreter.ExecuteScalar(inputs, expected);
+    interpreter.Execute(inputs, actual, 1);
+    ASSERT_TRUE(Identical(actual, expected)) << "program " << i;
+  }
+}
+
+TEST(VertexShaderInterpreter, ResultIsIndependentOfThreadCount) {
+  const auto inputs = RandomInputs(50000, 3);
+  std::mt19937 rng(4);
+  const auto interpreter = RandomInterpreter(rng);
+
+  std::vector<VSI::OutputVertex> serial;
+  std::vector<VSI::OutputVertex> parallel;
+  interpreter.Execute(inputs, serial, 1);
+  interpreter.Execute(inputs, parallel, 4);
+  EXPECT_TRUE(Identical(parallel, serial));
+}
+
+TEST(VertexShaderInterpreter, Benchmark) {
+  // A fixed function style transform and lighting program over a typical test mesh.
+  static constexpr uint32_t kVertices = 10000;
+  static constexpr uint32_t kIterations = 100;
+  static constexpr uint32_t c0 = VSI::kConstantBias;
+  const auto inputs = RandomInputs(kVertices, 5);
+
+  std::vector<Op> ops;
+  static constexpr const char *kComponents[] = {"x", "y", "z", "w"};
+  for (uint32_t i = 0; i < 4; ++i) {
+    // dp4 oPos.<i>, v0, c[i]
+    ops.push_back(Op::MAC(VSI::MAC_DP4).Constant(c0 + i).B({MUX_C}).Output(VSI::OUT_POS, kComponents[i]));
+  }
+  // dp3 r0.x, v2, v2 + rsq r1.x, r0.x
+  ops.push_back(Op::MAC(VSI::MAC_DP3)
+                    .PairILU(VSI::ILU_RSQ)
+                    .Input(2)
+                    .B({MUX_V})
+                    .C({MUX_R, 0, "xxxx"})
+                    .Temporary(0, "x", "x"));
+  // mul r2, v2, r1.x
+  ops.push_back(Op::MAC(VSI::MAC_MUL).Input(2).B({MUX_R, 1, "xxxx"}).Temporary(2, "xyzw"));
+  // dp3 r3.x, r2, c4 ; dp3 r3.y, r2, c5 ; mov r3.w, c6.w
+  ops.push_back(Op::MAC(VSI::MAC_DP3).Constant(c0 + 4).A({MUX_R, 2}).B({MUX_C}).Temporary(3, "x"));
+  ops.push_back(Op::MAC(VSI::MAC_DP3).Constant(c0 + 5).A({MUX_R, 2}).B({MUX_C}).Temporary(3, "y"));
+  ops.push_back(Op::MAC(VSI::MAC_MOV).Constant(c0 + 6).A({MUX_C, 0, "wwww"}).Temporary(3, "w"));
+  // lit r4, r3
+  ops.push_back(Op::ILU(VSI::ILU_LIT).C({MUX_R, 3}).Temporary(4, "", "xyzw"));
+  // mad oD0, r4.y, c7, c8 ; mul oD1, r4.z, c7
+  ops.push_back(
+      Op::MAC(VSI::MAC_MAD).Constant(c0 + 7).A({MUX_R, 4, "yyyy"}).B({MUX_C}).C({MUX_C}).Output(VSI::OUT_DIFFUSE));
+  ops.push_back(Op::MAC(VSI::MAC_MUL).Constant(c0 + 7).A({MUX_R, 4, "zzzz"}).B({MUX_C}).Output(VSI::OUT_SPECULAR));
+  // mov oT0, v9
+  ops.push_back(Op::MAC(VSI::MAC_MOV).Input(9).Output(VSI::OUT_TEX0));
+
+  VSI interpreter;
+  Load(interpreter, Assemble(ops));
+  for (uint32_t i = 0; i < 8; ++i) {
+    interpreter.SetConstant(c0 + i, 0.25f * i, 0.5f, -0.5f, 8.f);
+  }
+
+  std::vector<VSI::OutputVertex> output;
+  auto measure = [&](uint32_t iterations, auto &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+      function();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+  };
+
+  const double scalar = measure(kIterations, [&]() { interpreter.ExecuteScalar(inputs, output); });
+  const double single = measure(kIterations, [&]() { interpreter.Execute(inputs, output, 1); });
+  const double parallel = measure(kIterations, [&]() { interpreter.Execute(inputs, output); });
+
+  printf("Kernel: %s\n", VSI::KernelName());
+  printf("%u vertices x %u instructions: scalar %.1f us, vectorized %.1f us, vectorized (all threads) %.1f us\n",
+         kVertices, interpreter.num_instructions(), scalar * 1e6, single * 1e6, parallel * 1e6);
+}
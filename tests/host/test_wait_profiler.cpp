@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include "wait_profiler.h"
+
+using WaitPoint = WaitProfiler::WaitPoint;
+
+TEST(WaitProfilerHistogramTest, BucketsByPowerOfTwo) {
+  EXPECT_EQ(WaitProfiler::Histogram::BucketIndex(0), 0);
+  EXPECT_EQ(WaitProfiler::Histogram::BucketIndex(1), 0);
+  EXPECT_EQ(WaitProfiler::Histogram::BucketIndex(2), 1);
+  EXPECT_EQ(WaitProfiler::Histogram::BucketIndex(3), 1);
+  EXPECT_EQ(WaitProfiler::Histogram::BucketIndex(1024), 10);
+  EXPECT_EQ(WaitProfiler::Histogram::BucketIndex(2047), 10);
+  EXPECT_EQ(WaitProfiler::Histogram::BucketIndex(UINT32_MAX), WaitProfiler::kNumBuckets - 1);
+
+  WaitProfiler::Histogram histogram;
+  histogram.Add(9);
+  histogram.Add(15);
+  histogram.Add(1500);
+  EXPECT_EQ(histogram.Describe(), "[2^3]=2 [2^10]=1");
+}
+
+TEST(WaitProfilerTest, RecordsPerTestStatistics) {
+  WaitProfiler profiler;
+  profiler.BeginTest("Suite::Test");
+  profiler.Record(WaitPoint::PBKIT_BUSY_WAIT, 100, 1);
+  profiler.Record(WaitPoint::PBKIT_BUSY_WAIT, 300, 1);
+  profiler.Record(WaitPoint::FINISHED, 20, 5000);
+  const auto &profile = profiler.EndTest();
+
+  EXPECT_EQ(profile.name, "Suite::Test");
+  const auto &busy = profile.Get(WaitPoint::PBKIT_BUSY_WAIT);
+  EXPECT_EQ(busy.count, 2);
+  EXPECT_EQ(busy.total_microseconds, 400);
+  EXPECT_EQ(busy.max_microseconds, 300);
+  EXPECT_EQ(busy.microseconds.buckets[6], 1);
+  EXPECT_EQ(busy.microseconds.buckets[8], 1);
+  EXPECT_EQ(profile.Get(WaitPoint::FINISHED).total_iterations, 5000);
+  EXPECT_EQ(profile.Get(WaitPoint::FINISHED).iterations.buckets[12], 1);
+  EXPECT_EQ(profile.TotalMicroseconds(), 420);
+
+  // Only wait points that were hit are described.
+  auto lines = profile.Describe();
+  ASSERT_EQ(lines.size(), 2);
+  EXPECT_EQ(lines[0], "pbkit_busy_wait: 2 waits, 400us total, 300us max, 2 iterations; us [2^6]=1 [2^8]=1; "
+                      "iterations [2^0]=2");
+}
+
+TEST(WaitProfilerTest, AccumulatesRunTotals) {
+  WaitProfiler profiler;
+  profiler.Record(WaitPoint::SLEEP, 1000, 0);
+  profiler.BeginTest("A");
+  profiler.Record(WaitPoint::SLEEP, 2000, 0);
+  profiler.EndTest();
+  profiler.BeginTest("B");
+  profiler.Record(WaitPoint::SLEEP, 4000, 0);
+  profiler.EndTest();
+
+  const auto &sleep = profiler.GetTotals(WaitPoint::SLEEP);
+  EXPECT_EQ(sleep.count, 3);
+  EXPECT_EQ(sleep.total_microseconds, 7000);
+  EXPECT_EQ(sleep.max_microseconds, 4000);
+}
+
+TEST(WaitProfilerTest, SummaryListsWorstTestsFirst) {
+  WaitProfiler profiler;
+  const char *names[] = {"Fast", "Slowest", "Slow"};
+  const uint32_t waits[] = {1000, 50000, 20000};
+  for (auto i = 0; i < 3; ++i) {
+    profiler.BeginTest(names[i]);
+    profiler.Record(WaitPoint::VBLANK, waits[i], 1);
+    profiler.EndTest();
+  }
+
+  auto lines = profiler.Summarize(2);
+  // Title, column headings, two rows, then the vblank histogram.
+  ASSERT_EQ(lines.size(), 5);
+  EXPECT_NE(lines[2].find("Slowest"), std::string::npos);
+  EXPECT_NE(lines[2].find("50"), std::string::npos);
+  EXPECT_NE(lines[3].find("Slow"), std::string::npos);
+  EXPECT_EQ(lines[3].find("Slowest"), std::string::npos);
+  EXPECT_EQ(lines[4].rfind("vblank: 3 waits", 0), 0);
+}
+
+TEST(WaitProfilerTest, ScopedWaitRecordsIntoActiveProfiler) {
+  WaitProfiler profiler;
+  {
+    // Without an active profiler waits are ignored.
+    WaitProfiler::ScopedWait wait(WaitPoint::PGRAPH_IDLE);
+  }
+  EXPECT_EQ(profiler.GetTotals(WaitPoint::PGRAPH_IDLE).count, 0);
+
+  WaitProfiler::SetActive(&profiler);
+  profiler.BeginTest("Test");
+  {
+    WaitProfiler::ScopedWait wait(WaitPoint::PGRAPH_IDLE);
+    for (auto i = 0; i < 3; ++i) {
+      wait.Iterate();
+    }
+  }
+  const auto &profile = profiler.EndTest();
+  WaitProfiler::SetActive(nullptr);
+
+  EXPECT_EQ(profile.Get(WaitPoint::PGRAPH_IDLE).count, 1);
+  EXPECT_EQ(profile.Get(WaitPoint::PGRAPH_IDLE).total_iterations, 3);
+}
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "watchdog.h"
+
+class FakeClock : public TestWatchdog::Clock {
+ public:
+  [[nodiscard]] uint64_t NowMilliseconds() const override { return now_; }
+  void Advance(uint64_t milliseconds) { now_ += milliseconds; }
+
+ private:
+  uint64_t now_{1000};
+};
+
+class TestWatchdogTest : public ::testing::Test {
+ protected:
+  TestWatchdog::ExpiryHandler RecordExpiry() {
+    return [this](const std::string &test_name, uint32_t budget) {
+      expired_.push_back(test_name);
+      budgets_.push_back(budget);
+    };
+  }
+
+  FakeClock clock_;
+  std::vector<std::string> expired_;
+  std::vector<uint32_t> budgets_;
+};
+
+TEST_F(TestWatchdogTest, ExpiresOnceAfterBudget) {
+  TestWatchdog watchdog(clock_, 500, nullptr, RecordExpiry());
+  EXPECT_EQ(watchdog.GetState(), TestWatchdog::State::IDLE);
+  EXPECT_FALSE(watchdog.Poll());
+
+  watchdog.Arm("Suite::Hang");
+  EXPECT_EQ(watchdog.GetState(), TestWatchdog::State::ARMED);
+  clock_.Advance(499);
+  EXPECT_FALSE(watchdog.Poll());
+  EXPECT_TRUE(expired_.empty());
+
+  clock_.Advance(1);
+  EXPECT_TRUE(watchdog.Poll());
+  EXPECT_EQ(watchdog.GetState(), TestWatchdog::State::EXPIRED);
+  ASSERT_EQ(expired_.size(), 1);
+  EXPECT_EQ(expired_[0], "Suite::Hang");
+  EXPECT_EQ(budgets_[0], 500);
+
+  // Expiry is terminal: further polls and arms do not re-fire the handler.
+  clock_.Advance(10000);
+  EXPECT_TRUE(watchdog.Poll());
+  watchdog.Arm("Suite::Next");
+  EXPECT_TRUE(watchdog.Poll());
+  EXPECT_EQ(expired_.size(), 1);
+  EXPECT_EQ(watchdog.Disarm(), 0);
+}
+
+TEST_F(TestWatchdogTest, DisarmPreventsExpiry) {
+  TestWatchdog watchdog(clock_, 500, nullptr, RecordExpiry());
+
+  watchdog.Arm("Suite::Fast");
+  clock_.Advance(300);
+  EXPECT_EQ(watchdog.Disarm(), 300);
+  EXPECT_EQ(watchdog.GetState(), TestWatchdog::State::IDLE);
+
+  clock_.Advance(10000);
+  EXPECT_FALSE(watchdog.Poll());
+
+  // Rearming restarts the deadline.
+  watchdog.Arm("Suite::Second");
+  clock_.Advance(400);
+  EXPECT_FALSE(watchdog.Poll());
+  EXPECT_TRUE(expired_.empty());
+}
+
+TEST_F(TestWatchdogTest, ZeroBudgetDisables) {
+  TestWatchdog watchdog(clock_, 0, nullptr, RecordExpiry());
+  EXPECT_FALSE(watchdog.IsEnabled());
+
+  watchdog.Arm("Suite::Test");
+  EXPECT_EQ(watchdog.GetState(), TestWatchdog::State::IDLE);
+  clock_.Advance(UINT32_MAX);
+  EXPECT_FALSE(watchdog.Poll());
+}
+
+TEST_F(TestWatchdogTest, BudgetsFromTimingHistory) {
+  TimingHistory history("");
+  TestWatchdog watchdog(clock_, 60000, &history, RecordExpiry());
+  EXPECT_EQ(watchdog.GetBudget("Suite::Unknown"), 60000);
+
+  watchdog.Arm("Suite::Slow");
+  clock_.Advance(20000);
+  EXPECT_EQ(watchdog.Disarm(), 20000);
+  EXPECT_EQ(watchdog.GetBudget("Suite::Slow"), 20000 * TestWatchdog::kHistoryBudgetMultiplier);
+
+  history.Record("Suite::Fast", 5);
+  EXPECT_EQ(watchdog.GetBudget("Suite::Fast"), TestWatchdog::kMinimumHistoryBudgetMilliseconds);
+
+  watchdog.Arm("Suite::Fast");
+  clock_.Advance(TestWatchdog::kMinimumHistoryBudgetMilliseconds);
+  EXPECT_TRUE(watchdog.Poll());
+  ASSERT_EQ(expired_.size(), 1);
+  EXPECT_EQ(budgets_[0], TestWatchdog::kMinimumHistoryBudgetMilliseconds);
+}
+
+TEST_F(TestWatchdogTest, ThreadInvokesHandler) {
+  TestWatchdog watchdog(clock_, 100, nullptr, RecordExpiry());
+  watchdog.Arm("Suite::Hang");
+  watchdog.Start(1);
+
+  clock_.Advance(100);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (watchdog.GetState() != TestWatchdog::State::EXPIRED && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  watchdog.Stop();
+
+  ASSERT_EQ(expired_.size(), 1);
+  EXPECT_EQ(expired_[0], "Suite::Hang");
+}
+
+TEST(TimingHistoryTest, PersistsAndCompactsEntries) {
+  auto path = (std::filesystem::temp_directory_path() / "test_watchdog_timing_history.txt").string();
+  std::filesystem::remove(path);
+
+  {
+    TimingHistory history(path);
+    EXPECT_FALSE(history.Load());
+    ASSERT_TRUE(history.Record("A::one", 10));
+    ASSERT_TRUE(history.Record("A::two", 20));
+    ASSERT_TRUE(history.Record("A::one", 15));
+  }
+  {
+    std::ofstream out(path, std::ios_base::app);
+    out << "garbage line\n" << "A::three\tnot a number\n";
+  }
+
+  TimingHistory history(path);
+  ASSERT_TRUE(history.Load());
+  EXPECT_EQ(history.Size(), 2);
+  uint32_t milliseconds = 0;
+  ASSERT_TRUE(history.Find("A::one", milliseconds));
+  EXPECT_EQ(milliseconds, 15);
+  ASSERT_TRUE(history.Find("A::two", milliseconds));
+  EXPECT_EQ(milliseconds, 20);
+  EXPECT_FALSE(history.Find("A::three", milliseconds));
+
+  // Loading rewrites the file with a single line per test.
+  std::ifstream in(path);
+  std::string line;
+  uint32_t num_lines = 0;
+  while (std::getline(in, line)) {
+    ++num_lines;
+  }
+  EXPECT_EQ(num_lines, 2);
+  std::filesystem::remove(path);
+}
+
+TEST(WatchdogCheckpointTest, ResumesPastMostRecentHang) {
+  auto path = (std::filesystem::temp_directory_path() / "test_watchdog_checkpoint.txt").string();
+  std::filesystem::remove(path);
+
+  {
+    WatchdogCheckpoint checkpoint(path);
+    EXPECT_FALSE(checkpoint.Load());
+    ASSERT_TRUE(checkpoint.RecordHang("B::hang"));
+    ASSERT_TRUE(checkpoint.RecordHang("C::hang"));
+  }
+
+  WatchdogCheckpoint checkpoint(path);
+  ASSERT_TRUE(checkpoint.Load());
+  ASSERT_EQ(checkpoint.GetHungTests().size(), 2);
+
+  const std::vector<std::string> order = {"A::one", "B::hang", "B::two", "C::one", "C::hang", "C::two", "D::one"};
+  auto skipped = checkpoint.SelectSkippedTests(order);
+  EXPECT_EQ(skipped, std::set<std::string>({"A::one", "B::hang", "B::two", "C::one", "C::hang"}));
+
+  // If the resume point is no longer part of the run, only the hung tests themselves are skipped.
+  skipped = checkpoint.SelectSkippedTests({"A::one", "B::hang", "D::one"});
+  EXPECT_EQ(skipped, std::set<std::string>({"B::hang", "C::hang"}));
+
+  checkpoint.Clear();
+  EXPECT_FALSE(checkpoint.HasHangs());
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST_F(TestWatchdogTest, ResumesPastHungAtlasFrame) {
+  auto path = (std::filesystem::temp_directory_path() / "test_watchdog_atlas_checkpoint.txt").string();
+  std::filesystem::remove(path);
+
+  const std::vector<std::string> order = {"A::one", "Atlas::one", "Atlas::three", "Atlas::two", "B::one"};
+  {
+    WatchdogCheckpoint checkpoint(path);
+    TestWatchdog watchdog(clock_, 500, nullptr,
+                          [&checkpoint](const std::string &test_name, uint32_t) { checkpoint.RecordHang(test_name); });
+
+    // Mirrors TestSuite::RunAll: each batched test only records its draw, and the frame is captured once the last one
+    // has run, guarded under that test's name.
+    for (const auto &test_name : {"A::one", "Atlas::one", "Atlas::three", "Atlas::two"}) {
+      watchdog.Arm(test_name);
+      clock_.Advance(10);
+      watchdog.Disarm();
+    }
+    watchdog.Arm("Atlas::two");
+    clock_.Advance(500);
+    ASSERT_TRUE(watchdog.Poll());
+  }
+
+  WatchdogCheckpoint checkpoint(path);
+  ASSERT_TRUE(checkpoint.Load());
+  EXPECT_EQ(checkpoint.GetHungTests(), std::vector<std::string>({"Atlas::two"}));
+
+  // Every test in the frame has already run, so the resumed run continues with the test after the frame.
+  auto skipped = checkpoint.SelectSkippedTests(order);
+  EXPECT_EQ(skipped, std::set<std::string>({"A::one", "Atlas::one", "Atlas::three", "Atlas::two"}));
+
+  checkpoint.Clear();
+}
@@ -0,0 +1,107 @@
+// Answers questions about the PGRAPH register history written when `enable_pgraph_region_diff` is set.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "pgraph_snapshot_history.h"
+
+static void PrintUsage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s <pgraph_history.bin> <command> [args]\n"
+          "\n"
+          "Commands:\n"
+          "  tests                      List every recorded test\n"
+          "  changed <register>         List the tests that changed the register, with old and new values\n"
+          "  value <register> <test>    Print the register's value after the given test\n"
+          "  test <test>                List the registers changed by the given test\n"
+          "\n"
+          "<register> may be an absolute address (0xFD400xxx) or an offset into PGRAPH (0x0xxx).\n"
+          "<test> is either \"Suite::Test\" or a record index.\n",
+          program);
+}
+
+static bool ParseRegister(const char *arg, uint32_t &index) {
+  char *end;
+  auto value = static_cast<uint32_t>(strtoul(arg, &end, 0));
+  if (*end) {
+    return false;
+  }
+  if (value >= PGRAPH_REGISTER_BASE) {
+    value -= PGRAPH_REGISTER_BASE;
+  }
+  if (value >= PGRAPH_REGISTER_ARRAY_SIZE || value & 3) {
+    return false;
+  }
+  index = value / 4;
+  return true;
+}
+
+static bool ParseTest(const PGRAPHHistoryIndex &index, const char *arg, uint32_t &record) {
+  if (index.FindRecord(arg, record)) {
+    return true;
+  }
+
+  char *end;
+  record = static_cast<uint32_t>(strtoul(arg, &end, 10));
+  return !*end && *arg && record < index.NumRecords();
+}
+
+static uint32_t Address(uint32_t register_index) { return PGRAPH_REGISTER_BASE + register_index * 4; }
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  PGRAPHHistoryIndex index;
+  std::vector<std::string> errors;
+  if (!index.Load(argv[1], errors)) {
+    for (const auto &error : errors) {
+      fprintf(stderr, "%s\n", error.c_str());
+    }
+    // A partial history is still useful; only bail if nothing was recovered.
+    if (!index.NumRecords()) {
+      return 1;
+    }
+  }
+
+  const std::string command = argv[2];
+  uint32_t register_index;
+  uint32_t record;
+
+  if (command == "tests" && argc == 3) {
+    for (uint32_t i = 0; i < index.NumRecords(); ++i) {
+      printf("%u\t%s\n", i, index.RecordName(i).c_str());
+    }
+    return 0;
+  }
+
+  if (command == "changed" && argc == 4 && ParseRegister(argv[3], register_index)) {
+    for (const auto &change : index.Changes(register_index)) {
+      const uint32_t old_value = change.record ? index.ValueAt(register_index, change.record - 1) : 0;
+      printf("%u\t%s\t0x%08X => 0x%08X\n", change.record, index.RecordName(change.record).c_str(), old_value,
+             change.value);
+    }
+    return 0;
+  }
+
+  if (command == "value" && argc == 5 && ParseRegister(argv[3], register_index) && ParseTest(index, argv[4], record)) {
+    printf("0x%08X\n", index.ValueAt(register_index, record));
+    return 0;
+  }
+
+  if (command == "test" && argc == 4 && ParseTest(index, argv[3], record)) {
+    for (auto changed : index.RegistersChangedBy(record)) {
+      const uint32_t old_value = record ? index.ValueAt(changed, record - 1) : 0;
+      printf("0x%08X: 0x%08X => 0x%08X\n", Address(changed), old_value, index.ValueAt(changed, record));
+    }
+    return 0;
+  }
+
+  PrintUsage(argv[0]);
+  return 1;
+}
@@ -0,0 +1,339 @@
+#include "asset_compiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include "texture_swizzle.h"
+
+using namespace CompiledTexture;
+
+namespace AssetCompiler {
+
+struct FormatName {
+  const char *name;
+  Format format;
+};
+
+static constexpr FormatName kFormatNames[] = {
+    {"SZ_A1R5G5B5", FORMAT_SZ_A1R5G5B5},
+    {"SZ_X1R5G5B5", FORMAT_SZ_X1R5G5B5},
+    {"SZ_A4R4G4B4", FORMAT_SZ_A4R4G4B4},
+    {"SZ_R5G6B5", FORMAT_SZ_R5G6B5},
+    {"SZ_A8R8G8B8", FORMAT_SZ_A8R8G8B8},
+    {"SZ_X8R8G8B8", FORMAT_SZ_X8R8G8B8},
+    {"L_DXT1_A1R5G5B5", FORMAT_L_DXT1_A1R5G5B5},
+    {"L_DXT23_A8R8G8B8", FORMAT_L_DXT23_A8R8G8B8},
+    {"L_DXT45_A8R8G8B8", FORMAT_L_DXT45_A8R8G8B8},
+    {"LU_IMAGE_A1R5G5B5", FORMAT_LU_IMAGE_A1R5G5B5},
+    {"LU_IMAGE_R5G6B5", FORMAT_LU_IMAGE_R5G6B5},
+    {"LU_IMAGE_A8R8G8B8", FORMAT_LU_IMAGE_A8R8G8B8},
+    {"LU_IMAGE_A4R4G4B4", FORMAT_LU_IMAGE_A4R4G4B4},
+    {"LU_IMAGE_X8R8G8B8", FORMAT_LU_IMAGE_X8R8G8B8},
+};
+
+static uint32_t Align(uint32_t value) { return (value + kAlignment - 1) & ~(kAlignment - 1); }
+
+static bool IsPowerOfTwo(uint32_t value) { return value && !(value & (value - 1)); }
+
+//! Lays out the given levels after a header and returns the assembled blob.
+static void BuildBlob(uint32_t format, uint32_t width, uint32_t height, uint32_t pitch,
+                      const std::vector<std::vector<uint8_t>> &levels, std::vector<uint8_t> &blob) {
+  uint32_t bytes_per_pixel;
+  bool swizzled;
+  bool compressed;
+  GetFormatInfo(format, bytes_per_pixel, swizzled, compressed);
+
+  Header header{};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.header_size = sizeof(Header);
+  header.format = format;
+  header.flags = (swizzled ? FLAG_SWIZZLED : 0) | (compressed ? FLAG_COMPRESSED : 0);
+  header.width = width;
+  header.height = height;
+  header.pitch = pitch;
+  header.bytes_per_pixel = bytes_per_pixel;
+  header.num_levels = levels.size();
+
+  uint32_t end = sizeof(Header);
+  for (uint32_t level = 0; level < levels.size(); ++level) {
+    header.level_offsets[level] = Align(end);
+    header.level_sizes[level] = levels[level].size();
+    end = header.level_offsets[level] + header.level_sizes[level];
+  }
+  header.blob_size = end;
+
+  // Padding is zero filled so that the output is fully deterministic.
+  blob.assign(end, 0);
+  memcpy(blob.data(), &header, sizeof(header));
+  for (uint32_t level = 0; level < levels.size(); ++level) {
+    memcpy(blob.data() + header.level_offsets[level], levels[level].data(), levels[level].size());
+  }
+}
+
+bool ParseSpec(const std::string &spec, AssetSpec &asset, std::string &error) {
+  auto equals = spec.rfind('=');
+  if (equals == std::string::npos || !equals) {
+    error = "Invalid asset spec '" + spec + "', expected <source>=<FORMAT>[,mipmap]";
+    return false;
+  }
+
+  asset.name = spec.substr(0, equals);
+  std::replace(asset.name.begin(), asset.name.end(), '\\', '/');
+  if (asset.name.size() > AssetManifest::kMaxNameLength) {
+    error = "Asset name '" + asset.name + "' is too long";
+    return false;
+  }
+
+  auto format_name = spec.substr(equals + 1);
+  asset.mipmap = false;
+  auto comma = format_name.find(',');
+  if (comma != std::string::npos) {
+    auto option = format_name.substr(comma + 1);
+    format_name.resize(comma);
+    if (option != "mipmap") {
+      error = "Unknown option '" + option + "' in asset spec '" + spec + "'";
+      return false;
+    }
+    asset.mipmap = true;
+  }
+
+  for (auto &entry : kFormatNames) {
+    if (format_name == entry.name) {
+      asset.format = entry.format;
+      return true;
+    }
+  }
+
+  error = "Unknown format '" + format_name + "' in asset spec '" + spec + "'";
+  return false;
+}
+
+void ConvertTexel(const uint8_t *rgba, uint32_t format, uint8_t *dst) {
+  uint32_t r = rgba[0];
+  uint32_t g = rgba[1];
+  uint32_t b = rgba[2];
+  uint32_t a = rgba[3];
+
+  // Channels are truncated, matching the SDL_ConvertSurfaceFormat conversions previously done at runtime.
+  uint32_t value;
+  switch (format) {
+    case FORMAT_SZ_A8R8G8B8:
+    case FORMAT_LU_IMAGE_A8R8G8B8:
+      value = (a << 24) | (r << 16) | (g << 8) | b;
+      memcpy(dst, &value, 4);
+      return;
+
+    case FORMAT_SZ_X8R8G8B8:
+    case FORMAT_LU_IMAGE_X8R8G8B8:
+      value = 0xFF000000 | (r << 16) | (g << 8) | b;
+      memcpy(dst, &value, 4);
+      return;
+
+    case FORMAT_SZ_R5G6B5:
+    case FORMAT_LU_IMAGE_R5G6B5:
+      value = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+      break;
+
+    case FORMAT_SZ_A1R5G5B5:
+    case FORMAT_LU_IMAGE_A1R5G5B5:
+      value = ((a >> 7) << 15) | ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3);
+      break;
+
+    case FORMAT_SZ_X1R5G5B5:
+      value = 0x8000 | ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3);
+      break;
+
+    case FORMAT_SZ_A4R4G4B4:
+    case FORMAT_LU_IMAGE_A4R4G4B4:
+      value = ((a >> 4) << 12) | ((r >> 4) << 8) | ((g >> 4) << 4) | (b >> 4);
+      break;
+
+    default:
+      return;
+  }
+
+  dst[0] = static_cast<uint8_t>(value);
+  dst[1] = static_cast<uint8_t>(value >> 8);
+}
+
+Image Downsample(const Image &image) {
+  Image ret;
+  ret.width = std::max(1U, image.width >> 1);
+  ret.height = std::max(1U, image.height >> 1);
+  ret.rgba.resize(ret.width * ret.height * 4);
+
+  // Dimensions that are already 1 are sampled once and weighted twice.
+  uint32_t x_step = image.width > 1 ? 1 : 0;
+  uint32_t y_step = image.height > 1 ? 1 : 0;
+  for (uint32_t y = 0; y < ret.height; ++y) {
+    const uint8_t *row0 = &image.rgba[(y * 2) * image.width * 4];
+    const uint8_t *row1 = &image.rgba[(y * 2 + y_step) * image.width * 4];
+    uint8_t *dst = &ret.rgba[y * ret.width * 4];
+    for (uint32_t x = 0; x < ret.width; ++x) {
+      uint32_t left = x * 2 * 4;
+      uint32_t right = (x * 2 + x_step) * 4;
+      for (uint32_t c = 0; c < 4; ++c) {
+        uint32_t sum = row0[left + c] + row0[right + c] + row1[left + c] + row1[right + c];
+        dst[x * 4 + c] = static_cast<uint8_t>((sum + 2) >> 2);
+      }
+    }
+  }
+  return ret;
+}
+
+bool CompileImage(const Image &image, const AssetSpec &asset, std::vector<uint8_t> &blob, std::string &error) {
+  uint32_t bytes_per_pixel;
+  bool swizzled;
+  bool compressed;
+  if (!GetFormatInfo(asset.format, bytes_per_pixel, swizzled, compressed) || compressed) {
+    error = asset.name + ": images can only be compiled to uncompressed formats";
+    return false;
+  }
+  if (!image.width || !image.height || image.rgba.size() != image.width * image.height * 4) {
+    error = asset.name + ": invalid image";
+    return false;
+  }
+  if (swizzled && (!IsPowerOfTwo(image.width) || !IsPowerOfTwo(image.height))) {
+    error = asset.name + ": swizzled formats require power of two dimensions";
+    return false;
+  }
+  if (!swizzled && asset.mipmap) {
+    error = asset.name + ": linear formats cannot hold mip levels";
+    return false;
+  }
+
+  std::vector<std::vector<uint8_t>> levels;
+  std::vector<uint8_t> linear;
+  const Image *source = &image;
+  Image downsampled;
+  while (true) {
+    uint32_t num_texels = source->width * source->height;
+    linear.resize(num_texels * bytes_per_pixel);
+    for (uint32_t i = 0; i < num_texels; ++i) {
+      ConvertTexel(&source->rgba[i * 4], asset.format, &linear[i * bytes_per_pixel]);
+    }
+
+    if (swizzled) {
+      levels.emplace_back(linear.size());
+      TextureSwizzle::SwizzleRect(linear.data(), source->width, source->height, levels.back().data(),
+                                  source->width * bytes_per_pixel, bytes_per_pixel);
+    } else {
+      levels.push_back(linear);
+    }
+
+    if (!asset.mipmap || (source->width == 1 && source->height == 1) || levels.size() == kMaxLevels) {
+      break;
+    }
+    downsampled = Downsample(*source);
+    source = &downsampled;
+  }
+
+  BuildBlob(asset.format, image.width, image.height, image.width * bytes_per_pixel, levels, blob);
+  return true;
+}
+
+bool CompileDDS(const uint8_t *dds, uint32_t size, const AssetSpec &asset, std::vector<uint8_t> &blob,
+                std::string &error) {
+  // "DDS " followed by the 124 byte DDS_HEADER, which embeds the 32 byte DDS_PIXELFORMAT at offset 72.
+  static constexpr uint32_t kDataOffset = 128;
+  auto read32 = [dds](uint32_t offset) {
+    uint32_t value;
+    memcpy(&value, dds + offset, sizeof(value));
+    return value;
+  };
+
+  if (size < kDataOffset || memcmp(dds, "DDS ", 4) || read32(4) != 124) {
+    error = asset.name + ": not a DDS file";
+    return false;
+  }
+
+  uint32_t height = read32(12);
+  uint32_t width = read32(16);
+  uint32_t mip_count = std::max(1U, read32(28));
+  char four_cc[5] = {0};
+  memcpy(four_cc, dds + 84, 4);
+
+  uint32_t format;
+  if (!strcmp(four_cc, "DXT1")) {
+    format = FORMAT_L_DXT1_A1R5G5B5;
+  } else if (!strcmp(four_cc, "DXT2") || !strcmp(four_cc, "DXT3")) {
+    format = FORMAT_L_DXT23_A8R8G8B8;
+  } else if (!strcmp(four_cc, "DXT4") || !strcmp(four_cc, "DXT5")) {
+    format = FORMAT_L_DXT45_A8R8G8B8;
+  } else {
+    error = asset.name + ": unsupported DDS FourCC '" + four_cc + "'";
+    return false;
+  }
+  if (format != asset.format) {
+    error = asset.name + ": DDS FourCC '" + four_cc + "' does not match the requested format";
+    return false;
+  }
+  if (!width || !height) {
+    error = asset.name + ": invalid dimensions";
+    return false;
+  }
+
+  uint32_t num_levels = asset.mipmap ? std::min(mip_count, kMaxLevels) : 1;
+  std::vector<std::vector<uint8_t>> levels;
+  uint32_t offset = kDataOffset;
+  uint32_t level_width = width;
+  uint32_t level_height = height;
+  for (uint32_t level = 0; level < num_levels; ++level) {
+    uint32_t level_size = LevelSize(format, level_width, level_height);
+    if (level_size > size - offset) {
+      error = asset.name + ": DDS file is truncated";
+      return false;
+    }
+    levels.emplace_back(dds + offset, dds + offset + level_size);
+    offset += level_size;
+    level_width = std::max(1U, level_width >> 1);
+    level_height = std::max(1U, level_height >> 1);
+  }
+
+  uint32_t block_size = format == FORMAT_L_DXT1_A1R5G5B5 ? 8 : 16;
+  BuildBlob(format, width, height, ((width + 3) / 4) * block_size, levels, blob);
+  return true;
+}
+
+AssetManifest::Entry MakeManifestEntry(const AssetSpec &asset, const std::vector<uint8_t> &blob) {
+  Header header;
+  memcpy(&header, blob.data(), sizeof(header));
+
+  AssetManifest::Entry entry{};
+  strncpy(entry.name, asset.name.c_str(), AssetManifest::kMaxNameLength);
+  entry.blob_size = header.blob_size;
+  entry.format = header.format;
+  entry.width = header.width;
+  entry.height = header.height;
+  entry.num_levels = header.num_levels;
+  entry.flags = header.flags;
+  return entry;
+}
+
+void ForEachParallel(uint32_t count, uint32_t num_threads, const std::function<void(uint32_t)> &callback) {
+  if (!num_threads) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  num_threads = std::min(num_threads, count);
+
+  std::atomic<uint32_t> next{0};
+  auto worker = [&]() {
+    for (uint32_t index = next++; index < count; index = next++) {
+      callback(index);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace AssetCompiler
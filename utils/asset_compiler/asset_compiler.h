@@ -0,0 +1,62 @@
+#ifndef NXDK_PGRAPH_TESTS_ASSET_COMPILER_H
+#define NXDK_PGRAPH_TESTS_ASSET_COMPILER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "compiled_texture.h"
+
+/**
+ * Converts source images into the GPU-ready blobs described in compiled_texture.h.
+ *
+ * Output depends only on the input bytes and the requested format, so repeated builds produce identical files.
+ */
+namespace AssetCompiler {
+
+//! Describes a single asset to be compiled, parsed from "<source path>=<FORMAT>[,mipmap]".
+struct AssetSpec {
+  //! Path of the source relative to the resource root, using '/' separators. Also the name of the compiled asset.
+  std::string name;
+  //! One of CompiledTexture::Format.
+  uint32_t format{0};
+  //! Whether a full mip chain should be generated (images) or retained (DDS).
+  bool mipmap{false};
+};
+
+//! Decoded 8-bit RGBA image, rows tightly packed.
+struct Image {
+  uint32_t width{0};
+  uint32_t height{0};
+  std::vector<uint8_t> rgba;
+};
+
+//! Parses a spec of the form "<source path>=<FORMAT>[,mipmap]", where FORMAT omits the NV097 prefix (e.g. "SZ_R5G6B5").
+bool ParseSpec(const std::string &spec, AssetSpec &asset, std::string &error);
+
+//! Converts a decoded image into a blob of the requested format, generating mip levels and swizzling as needed.
+bool CompileImage(const Image &image, const AssetSpec &asset, std::vector<uint8_t> &blob, std::string &error);
+
+//! Repackages the DXT compressed levels of a DDS file, which must match the requested format.
+bool CompileDDS(const uint8_t *dds, uint32_t size, const AssetSpec &asset, std::vector<uint8_t> &blob,
+                std::string &error);
+
+//! Returns the manifest entry describing a compiled blob.
+AssetManifest::Entry MakeManifestEntry(const AssetSpec &asset, const std::vector<uint8_t> &blob);
+
+//! Converts a single RGBA texel to the given uncompressed format, writing `bytes_per_pixel` bytes to `dst`.
+void ConvertTexel(const uint8_t *rgba, uint32_t format, uint8_t *dst);
+
+//! Produces the next mip level of `image` with a 2x2 box filter.
+Image Downsample(const Image &image);
+
+/**
+ * Invokes `callback(index)` for every index in [0, count) across `num_threads` threads (0 selects the hardware
+ * concurrency). Each index is visited exactly once; the order of visits is unspecified.
+ */
+void ForEachParallel(uint32_t count, uint32_t num_threads, const std::function<void(uint32_t)> &callback);
+
+}  // namespace AssetCompiler
+
+#endif  // NXDK_PGRAPH_TESTS_ASSET_COMPILER_H
@@ -0,0 +1,168 @@
+// Compiles the listed resources into GPU-ready blobs and a manifest that can be loaded by AssetManifest.
+
+#include <png.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "asset_compiler.h"
+
+static void PrintUsage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s [-j <threads>] <resource_root> <output_dir> <spec>...\n"
+          "\n"
+          "Each <spec> is \"<source path>=<FORMAT>[,mipmap]\", where the source path is relative to <resource_root>\n"
+          "and FORMAT is an NV097_SET_TEXTURE_FORMAT_COLOR_* name without the prefix (e.g. SZ_A8R8G8B8).\n"
+          "PNG sources may target any uncompressed format, DDS sources must target the matching L_DXT format.\n",
+          program);
+}
+
+static bool ReadFile(const std::string &path, std::vector<uint8_t> &contents) {
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (!fp) {
+    return false;
+  }
+  bool ok = !fseek(fp, 0, SEEK_END);
+  long size = ok ? ftell(fp) : -1;
+  ok = size >= 0 && !fseek(fp, 0, SEEK_SET);
+  if (ok) {
+    contents.resize(size);
+    ok = !size || fread(contents.data(), size, 1, fp) == 1;
+  }
+  fclose(fp);
+  return ok;
+}
+
+//! Writes `contents` to `path` unless the file already holds exactly those bytes, so unchanged outputs keep their
+//! timestamps and do not trigger downstream resyncs.
+static bool WriteFileIfChanged(const std::string &path, const std::vector<uint8_t> &contents) {
+  std::vector<uint8_t> existing;
+  if (ReadFile(path, existing) && existing == contents) {
+    return true;
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+  FILE *fp = fopen(path.c_str(), "wb");
+  if (!fp) {
+    return false;
+  }
+  bool ok = contents.empty() || fwrite(contents.data(), contents.size(), 1, fp) == 1;
+  return !fclose(fp) && ok;
+}
+
+static bool DecodePNG(const std::vector<uint8_t> &contents, AssetCompiler::Image &image, std::string &error) {
+  png_image png{};
+  png.version = PNG_IMAGE_VERSION;
+  if (!png_image_begin_read_from_memory(&png, contents.data(), contents.size())) {
+    error = png.message;
+    return false;
+  }
+
+  png.format = PNG_FORMAT_RGBA;
+  image.width = png.width;
+  image.height = png.height;
+  image.rgba.resize(PNG_IMAGE_SIZE(png));
+  if (!png_image_finish_read(&png, nullptr, image.rgba.data(), 0, nullptr)) {
+    error = png.message;
+    png_image_free(&png);
+    return false;
+  }
+  return true;
+}
+
+static bool EndsWith(const std::string &value, const char *suffix) {
+  auto length = strlen(suffix);
+  return value.size() >= length && !strcasecmp(value.c_str() + value.size() - length, suffix);
+}
+
+int main(int argc, char **argv) {
+  uint32_t num_threads = 0;
+  int arg = 1;
+  if (arg + 1 < argc && !strcmp(argv[arg], "-j")) {
+    num_threads = static_cast<uint32_t>(strtoul(argv[arg + 1], nullptr, 10));
+    arg += 2;
+  }
+  if (argc - arg < 2) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  std::string resource_root = argv[arg++];
+  std::string output_dir = argv[arg++];
+
+  std::vector<AssetCompiler::AssetSpec> assets(argc - arg);
+  for (uint32_t i = 0; i < assets.size(); ++i) {
+    std::string error;
+    if (!AssetCompiler::ParseSpec(argv[arg + i], assets[i], error)) {
+      fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+    }
+  }
+
+  std::vector<AssetManifest::Entry> entries(assets.size());
+  std::vector<std::string> errors(assets.size());
+  AssetCompiler::ForEachParallel(assets.size(), num_threads, [&](uint32_t index) {
+    const auto &asset = assets[index];
+    auto &error = errors[index];
+
+    std::vector<uint8_t> contents;
+    auto source = resource_root + "/" + asset.name;
+    if (!ReadFile(source, contents)) {
+      error = "Failed to read " + source;
+      return;
+    }
+
+    std::vector<uint8_t> blob;
+    if (EndsWith(asset.name, ".dds")) {
+      if (!AssetCompiler::CompileDDS(contents.data(), contents.size(), asset, blob, error)) {
+        return;
+      }
+    } else {
+      AssetCompiler::Image image;
+      if (!DecodePNG(contents, image, error)) {
+        error = source + ": " + error;
+        return;
+      }
+      if (!AssetCompiler::CompileImage(image, asset, blob, error)) {
+        return;
+      }
+    }
+
+    auto output = AssetManifest::BlobPath(output_dir, asset.name);
+    if (!WriteFileIfChanged(output, blob)) {
+      error = "Failed to write " + output;
+      return;
+    }
+    entries[index] = AssetCompiler::MakeManifestEntry(asset, blob);
+  });
+
+  bool failed = false;
+  for (const auto &error : errors) {
+    if (!error.empty()) {
+      fprintf(stderr, "%s\n", error.c_str());
+      failed = true;
+    }
+  }
+  if (failed) {
+    return 1;
+  }
+
+  std::vector<uint8_t> manifest;
+  std::string error;
+  if (!AssetManifest::Build(entries, manifest, error)) {
+    fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+  auto manifest_path = AssetManifest::ManifestPath(output_dir);
+  if (!WriteFileIfChanged(manifest_path, manifest)) {
+    fprintf(stderr, "Failed to write %s\n", manifest_path.c_str());
+    return 1;
+  }
+  return 0;
+}
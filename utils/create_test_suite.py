@@ -85,13 +85,13 @@ def update_cmakelists(suite_name_snake):
     return True
 
 
-def update_main_cpp(suite_name_snake, suite_name_camel):
-    main_cpp_path = os.path.join("src", "main.cpp")
+def update_suite_registry(suite_name_snake, suite_name_camel):
+    registry_path = os.path.join("src", "test_suite_registry.cpp")
     paths = get_paths(suite_name_snake)
     header_name = os.path.basename(paths["h"])
     class_name = f"{suite_name_camel}Tests"
 
-    with open(main_cpp_path) as f:
+    with open(registry_path) as f:
         lines = f.readlines()
 
     # Find include block
@@ -102,7 +102,7 @@ def update_main_cpp(suite_name_snake, suite_name_camel):
             break
 
     if include_start_idx == -1:
-        print("Error: Could not find include block in main.cpp", file=sys.stderr)
+        print("Error: Could not find include block in test_suite_registry.cpp", file=sys.stderr)
         return False
 
     include_end_idx = -1
@@ -134,7 +134,7 @@ def update_main_cpp(suite_name_snake, suite_name_camel):
             break
 
     if reg_start_idx == -1 or reg_end_idx == -1:
-        print("Error: Could not find REG_TEST markers in main.cpp", file=sys.stderr)
+        print("Error: Could not find REG_TEST markers in test_suite_registry.cpp", file=sys.stderr)
         return False
 
     reg_tests = lines[reg_start_idx:reg_end_idx]
@@ -151,9 +151,9 @@ def update_main_cpp(suite_name_snake, suite_name_camel):
     new_lines.extend(reg_tests)
     new_lines.extend(lines[reg_end_idx:])
 
-    with open(main_cpp_path, "w") as f:
+    with open(registry_path, "w") as f:
         f.writelines(new_lines)
-    print(f"Updated {main_cpp_path}")
+    print(f"Updated {registry_path}")
     return True
 
 
@@ -176,7 +176,7 @@ def main():
 
     if not update_cmakelists(suite_name_snake):
         sys.exit(1)
-    if not update_main_cpp(suite_name_snake, suite_name_camel):
+    if not update_suite_registry(suite_name_snake, suite_name_camel):
         sys.exit(1)
 
 
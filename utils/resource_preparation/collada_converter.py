@@ -43,6 +43,75 @@ def transform(values: list[float], transform_matrix: list[float]) -> list[float]
     return ret
 
 
+def swap_yz(values: list[float]) -> list[float]:
+    ret: list[float] = []
+    for offset in range(0, len(values), 3):
+        ret.extend([values[offset], values[offset + 2], values[offset + 1]])
+    return ret
+
+
+# Mesh container layout, mirrored by MeshFile in src/models/mesh_file.h.
+MESH_MAGIC = 0x4853454D  # "MESH"
+MESH_VERSION = 1
+MESH_BLOCK_ALIGNMENT = 16
+# magic, version, header_size, num_vertices, file_size, 3 x (offset, components), interleaved_offset, interleaved_stride
+MESH_HEADER_FORMAT = "<IHHII6III"
+MESH_HEADER_SIZE = struct.calcsize(MESH_HEADER_FORMAT)
+
+
+def _align(value: int) -> int:
+    return (value + MESH_BLOCK_ALIGNMENT - 1) & ~(MESH_BLOCK_ALIGNMENT - 1)
+
+
+def pack_mesh_container(
+    num_vertices: int, attributes: list[tuple[list[float], int]], *, interleaved: bool = False
+) -> bytes:
+    """Builds a mesh container from [(values, components)] in position, normal, texcoord order.
+
+    Attributes with no values are omitted. If `interleaved` is set, a draw-ready block holding every attribute of each
+    vertex is appended after the planar blocks.
+    """
+    blocks = bytearray()
+    descriptors: list[int] = []
+    for values, components in attributes:
+        if not values:
+            descriptors.extend([0, 0])
+            continue
+        if len(values) != num_vertices * components:
+            msg = f"Attribute has {len(values)} values, expected {num_vertices * components}"
+            raise ValueError(msg)
+        offset = _align(MESH_HEADER_SIZE + len(blocks))
+        blocks.extend(bytes(offset - MESH_HEADER_SIZE - len(blocks)))
+        blocks.extend(struct.pack(f"<{len(values)}f", *values))
+        descriptors.extend([offset, components])
+
+    interleaved_offset = 0
+    interleaved_stride = 0
+    if interleaved:
+        present = [(values, components) for values, components in attributes if values]
+        interleaved_stride = sum(components for _, components in present) * 4
+        interleaved_offset = _align(MESH_HEADER_SIZE + len(blocks))
+        blocks.extend(bytes(interleaved_offset - MESH_HEADER_SIZE - len(blocks)))
+        for vertex in range(num_vertices):
+            for values, components in present:
+                start = vertex * components
+                blocks.extend(struct.pack(f"<{components}f", *values[start : start + components]))
+
+    file_size = MESH_HEADER_SIZE + len(blocks)
+    header = struct.pack(
+        MESH_HEADER_FORMAT,
+        MESH_MAGIC,
+        MESH_VERSION,
+        MESH_HEADER_SIZE,
+        num_vertices,
+        file_size,
+        *descriptors,
+        interleaved_offset,
+        interleaved_stride,
+    )
+    return header + bytes(blocks)
+
+
 class ColadaConverter:
     """Converts a Collada DAE file into a C header."""
 
@@ -54,6 +123,7 @@ class ColadaConverter:
         generate_inline: bool,
         mesh_resource_dir: str,
         use_posix_paths: str,
+        interleaved: bool = False,
     ):
         self._switch_winding_enabled = switch_winding
         self._transforms: dict[str, list[float]] = {}
@@ -61,6 +131,7 @@ class ColadaConverter:
         self._generate_inline = generate_inline
         self._mesh_resource_dir = mesh_resource_dir
         self._use_posix_paths = use_posix_paths
+        self._interleaved = interleaved
 
     def switch_winding(self, indices):
         if not self._switch_winding_enabled:
@@ -264,42 +335,23 @@ class ColadaConverter:
         transform_matrix: list[float],
         mesh: ElementTree.Element,
     ):
-        with open(self.build_mesh_resource_filename(mesh_name), "wb") as outfile:
-            triangles = mesh.find(f"{SCHEMA}triangles")
-            num_vertices = int(triangles.attrib["count"]) * 3
+        triangles = mesh.find(f"{SCHEMA}triangles")
+        num_vertices = int(triangles.attrib["count"]) * 3
+
+        position_values = swap_yz(transform(flattened_values.get("POSITION", []), transform_matrix))
+        if len(position_values) // 3 != num_vertices:
+            raise ValueError
+        normal_values = swap_yz(transform(flattened_values.get("NORMAL", []), transform_matrix))
+        texcoord_values = flattened_values.get("TEXCOORD", [])
 
-            # 4-byte vertex count
-            outfile.write(struct.pack("<i", num_vertices))
-
-            position_values = flattened_values.get("POSITION", [])
-            position_values = transform(position_values, transform_matrix)
-            # 4-byte position count
-            if len(position_values) // 3 != num_vertices:
-                raise ValueError
-            outfile.write(struct.pack("<i", len(position_values)))
-            for offset in range(0, len(position_values), 3):
-                vertex = [
-                    position_values[offset],
-                    position_values[offset + 2],
-                    position_values[offset + 1],
-                ]
-                outfile.write(struct.pack("<fff", *vertex))
-
-            normal_values = flattened_values.get("NORMAL", [])
-            normal_values = transform(normal_values, transform_matrix)
-            outfile.write(struct.pack("<i", len(normal_values)))
-            for offset in range(0, len(normal_values), 3):
-                vertex = [
-                    normal_values[offset],
-                    normal_values[offset + 2],
-                    normal_values[offset + 1],
-                ]
-                outfile.write(struct.pack("<fff", *vertex))
-
-            texcoord_values = flattened_values.get("TEXCOORD", [])
-            outfile.write(struct.pack("<i", len(texcoord_values)))
-            for value in texcoord_values:
-                outfile.write(struct.pack("<f", value))
+        with open(self.build_mesh_resource_filename(mesh_name), "wb") as outfile:
+            outfile.write(
+                pack_mesh_container(
+                    num_vertices,
+                    [(position_values, 3), (normal_values, 3), (texcoord_values, 2)],
+                    interleaved=self._interleaved,
+                )
+            )
 
     def _write_mesh_header(
         self,
@@ -379,39 +431,23 @@ class ColadaConverter:
                         "",
                         "  [[nodiscard]] uint32_t GetVertexCount() const override;",
                         "",
-                        " protected:",
-                        "  [[nodiscard]] const float *GetVertexPositions() override;",
-                        "  [[nodiscard]] const float *GetVertexNormals() override;",
                     ]
                 )
             )
 
             if not self._generate_inline:
-                outfile.write(
-                    "\n".join(
-                        [
-                            "  void ReleaseData() override {",
-                            "    if (vertices_) {",
-                            "      delete[] vertices_;",
-                            "      vertices_ = nullptr;",
-                            "    }",
-                            "    if (normals_) {",
-                            "      delete[] normals_;",
-                            "      normals_ = nullptr;",
-                            "    }",
-                            "    if (texcoords_) {",
-                            "      delete[] texcoords_;",
-                            "      texcoords_ = nullptr;",
-                            "    }",
-                            "  }",
-                            "",
-                            "  float *vertices_{nullptr};",
-                            "  float *normals_{nullptr};",
-                            "  float *texcoords_{nullptr};",
-                            "",
-                        ]
-                    )
+                outfile.write("\n  [[nodiscard]] static const char *GetMeshFilePath();\n")
+
+            outfile.write(
+                "\n".join(
+                    [
+                        "",
+                        " protected:",
+                        "  [[nodiscard]] const float *GetVertexPositions() override;",
+                        "  [[nodiscard]] const float *GetVertexNormals() override;",
+                    ]
                 )
+            )
 
             outfile.write(
                 "\n".join(
@@ -464,66 +500,28 @@ class ColadaConverter:
                 outfile.write(
                     "\n".join(
                         [
-                            "#include <stdio.h>",
-                            "",
                             '#include "debug_output.h"',
+                            '#include "models/mesh_file.h"',
                             "",
-                            "#define READ(target, size) \\",
-                            "    if (fread((target), (size), 1, fp) != 1) { \\",
-                            f'      ASSERT(!"Failed to read from {mesh_resource}"); \\',
-                            "    }",
-                            "",
-                            "#define READ_ARRAY(target, size, elements) \\",
-                            "    if (fread((target), (size), (elements), fp) != (elements)) { \\",
-                            f'      ASSERT(!"Failed to read from {mesh_resource}"); \\',
-                            "    }",
-                            "",
-                            "#define SKIP(size) \\",
-                            "    if (fseek(fp, (size), SEEK_CUR)) { \\",
-                            f'      ASSERT(!"Failed to seek in {mesh_resource}"); \\',
-                            "    }",
-                            "",
-                            f"uint32_t {class_name}::GetVertexCount() const {{",
-                            f'  FILE *fp = fopen("{mesh_resource}", "rb");',
-                            f'  ASSERT(fp && "Failed to open {mesh_resource}");',
-                            "  uint32_t num_vertices;",
-                            "  READ(&num_vertices, sizeof(num_vertices))",
-                            "  fclose(fp);",
-                            "  return num_vertices;",
-                            "}",
-                            "",
-                            f"const float* {class_name}::GetVertexPositions() {{",
-                            '  ASSERT(!vertices_ && "vertices_ already populated")',
-                            f'  FILE *fp = fopen("{mesh_resource}", "rb");',
-                            f'  ASSERT(fp && "Failed to open {mesh_resource}");',
-                            "  SKIP(sizeof(uint32_t))",
+                            f'static constexpr const char kMeshFile[] = "{mesh_resource}";',
                             "",
-                            "  uint32_t num_positions;",
-                            "  READ(&num_positions, sizeof(num_positions))",
-                            "",
-                            "  vertices_ = new float[num_positions];",
-                            "  READ_ARRAY(vertices_, sizeof(*vertices_), num_positions)",
-                            "  fclose(fp);",
-                            "  return vertices_;",
+                            "static std::shared_ptr<const MeshFile> GetMesh() {",
+                            "  std::string error;",
+                            "  auto ret = MeshFile::LoadCached(kMeshFile, error);",
+                            "  if (!ret) {",
+                            '    PrintMsg("%s\\n", error.c_str());',
+                            f'    ASSERT(!"Failed to load {mesh_resource}");',
+                            "  }",
+                            "  return ret;",
                             "}",
                             "",
-                            f"const float* {class_name}::GetVertexNormals() {{",
-                            '  ASSERT(!normals_ && "normals_ already populated")',
-                            f'  FILE *fp = fopen("{mesh_resource}", "rb");',
-                            f'  ASSERT(fp && "Failed to open {mesh_resource}");',
-                            "  SKIP(sizeof(uint32_t))",
+                            f"const char* {class_name}::GetMeshFilePath() {{ return kMeshFile; }}",
                             "",
-                            "  uint32_t num_positions;",
-                            "  READ(&num_positions, sizeof(num_positions))",
-                            "  SKIP(sizeof(float) * num_positions)",
+                            f"uint32_t {class_name}::GetVertexCount() const {{ return GetMesh()->GetVertexCount(); }}",
                             "",
-                            "  uint32_t num_normals;" "  READ(&num_normals, sizeof(num_normals))",
-                            "  normals_ = new float[num_normals];",
-                            "  READ_ARRAY(normals_, sizeof(*normals_), num_normals)",
-                            "  fclose(fp);",
+                            f"const float* {class_name}::GetVertexPositions() {{ return GetMesh()->GetPositions(); }}",
                             "",
-                            "  return normals_;",
-                            "}",
+                            f"const float* {class_name}::GetVertexNormals() {{ return GetMesh()->GetNormals(); }}",
                             "",
                         ]
                     )
@@ -544,6 +542,7 @@ def _main(args):
         generate_inline=args.inline,
         mesh_resource_dir=args.mesh_resource_dir,
         use_posix_paths=args.use_posix_paths,
+        interleaved=args.interleaved,
     )
 
     transforms = root.findall(f".//{SCHEMA}library_visual_scenes/{SCHEMA}visual_scene/{SCHEMA}node")
@@ -592,6 +591,12 @@ if __name__ == "__main__":
 
         parser.add_argument("--use-posix-paths", action="store_true", help="Use POSIX-style paths in generated code.")
 
+        parser.add_argument(
+            "--interleaved",
+            action="store_true",
+            help="Appends a draw-ready interleaved vertex block to generated mesh resources.",
+        )
+
         return parser.parse_args()
 
     sys.exit(_main(_parse_args()))